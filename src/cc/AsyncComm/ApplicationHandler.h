@@ -32,6 +32,7 @@
 #include "Clock.h"
 #include "Event.h"
 #include "ReactorRunner.h"
+#include "ResponseCallback.h"
 
 namespace Hypertable {
 
@@ -56,11 +57,13 @@ namespace Hypertable {
    *
    * <b>Urgency</b>
    *
-   * The ApplicationQueue supports two-level request prioritization.  Requests
-   * can be designated as <i>urgent</i> which will cause them to be executed
-   * before other non-urgent requests.  Urgent requests will also be executed
-   * even when the ApplicationQueue has been paused.  When initialized from a
-   * MESSAGE Event, the #m_urgent field will get set to <i>true</i> if the
+   * The ApplicationQueue supports three-level request prioritization.
+   * Requests can be designated as <i>urgent</i> which will cause them to be
+   * executed before other non-urgent requests, or as <i>low priority</i> (see
+   * set_low_priority()) which will cause them to be executed after other
+   * requests.  Urgent requests will also be executed even when the
+   * ApplicationQueue has been paused.  When initialized from a MESSAGE Event,
+   * the #m_urgent field will get set to <i>true</i> if the
    * CommHeader::FLAGS_BIT_URGENT is set in the CommHeader#flags field of the
    * message header.
    */
@@ -102,11 +105,32 @@ namespace Hypertable {
       return (m_event) ?  m_event->group_id : 0;
     }
 
+    /** Returns trace ID of request.
+     * @return Trace ID carried in the message header of the event (see
+     * RequestTrace), or 0 if the request is not traced
+     */
+    uint64_t get_trace_id() {
+      return (m_event) ? m_event->header.trace_id : 0;
+    }
+
     /** Returns <i>true</i> if request is urgent.
      * @return <i>true</i> if urgent
      */
     bool is_urgent() { return m_urgent; }
 
+    /** Returns <i>true</i> if request is of low priority.
+     * Low priority requests are carried out by an ApplicationQueue after
+     * other non-urgent requests.  Has no effect on urgent requests.
+     * @return <i>true</i> if low priority
+     */
+    bool is_low_priority() { return m_low_priority; }
+
+    /** Sets low priority flag.
+     * Must be called before the handler is added to an ApplicationQueue.
+     * @param low_priority New value of low priority flag
+     */
+    void set_low_priority(bool low_priority) { m_low_priority = low_priority; }
+
     /** Returns <i>true</i> if request has expired.
      * @return <i>true</i> if request has expired.
      */
@@ -136,9 +160,34 @@ namespace Hypertable {
       return false;
     }
 
+    /** Verifies the payload checksum of the request.
+     * Called by an ApplicationQueue worker thread before run(), so that
+     * request payload checksums are verified off the reactor thread.  If the
+     * checksum does not match, an error response with
+     * Error::COMM_PAYLOAD_CHECKSUM_MISMATCH is sent back and the request is
+     * dropped.  Responses are verified by the reactor thread before they
+     * are delivered (see Event::verify_response_payload_checksum).
+     * @return <i>false</i> if handler should not be run, <i>true</i>
+     * otherwise
+     */
+    bool verify_payload_checksum() {
+      if (!m_event ||
+          (m_event->header.flags & CommHeader::FLAGS_BIT_REQUEST) == 0)
+        return true;
+      int error = m_event->verify_payload_checksum();
+      if (error == Error::OK)
+        return true;
+      if ((m_event->header.flags & CommHeader::FLAGS_BIT_IGNORE_RESPONSE) == 0) {
+        ResponseCallback cb(Comm::instance(), m_event);
+        cb.error(error, "Request payload checksum mismatch");
+      }
+      return false;
+    }
+
   protected:
     EventPtr m_event; //!< MESSAGE Event from which handler was initialized
     bool m_urgent;    //!< Flag indicating if handler is urgent
+    bool m_low_priority {}; //!< Flag indicating if handler is low priority
   };
   /** @}*/
 } // namespace Hypertable
@@ -20,93 +20,293 @@
  */
 
 /** @file
- * Definitions for CommAddress.
- * This file contains method definitions for CommAddress, an abstraction class
- * for holding an arbitrary address type.
+ * Definitions for ApplicationQueue.
+ * This file contains method definitions for ApplicationQueue, a work-stealing
+ * queue of application request handlers.
  */
 
 #include "Common/Compat.h"
 
 #include "ApplicationQueue.h"
 
+#include "Common/RequestTrace.h"
+
+#include <algorithm>
+#include <thread>
+
 using namespace Hypertable;
+using namespace std;
+
+void ApplicationQueue::ApplicationQueueState::push(RequestRec *rec,
+                                                   size_t worker) {
+  WorkerQueue &wq = *queues[worker];
+  // rec may be taken and deleted as soon as the deque lock is released
+  Lane lane = rec->lane;
+  {
+    lock_guard<std::mutex> lock(wq.mutex);
+    // Counts are updated with the deque locked so that a worker seeing a
+    // pending request finds it on some deque
+    wq.queues[lane].push_back(rec);
+    wq.sizes[lane]++;
+    pending[lane]++;
+  }
+  // Pairs with the increment of sleeping in Worker::operator()(): either
+  // the worker sees the pending count or we see the sleeping worker.  A
+  // worker is only signalled if the ones already signalled have not taken
+  // up all sleeping workers.
+  if (sleeping > wakeups) {
+    lock_guard<std::mutex> lock(mutex);
+    if (sleeping > wakeups) {
+      wakeups++;
+      cond.notify_one();
+    }
+  }
+}
+
+void ApplicationQueue::Worker::operator()() {
+
+  while (true) {
+
+    if (m_state.shutdown)
+      return;
+
+    RequestRec *rec = take();
+
+    // Yield a few times before going to sleep, requests often arrive in
+    // bursts and waking up a sleeping worker is expensive
+    for (int i=0; rec == nullptr && i<SPIN_COUNT; i++) {
+      this_thread::yield();
+      rec = take();
+    }
+
+    if (rec == nullptr) {
+      if (m_one_shot)
+        return;
+      unique_lock<std::mutex> lock(m_state.mutex);
+      if (m_state.shutdown)
+        return;
+      m_state.threads_available++;
+      m_state.sleeping++;
+      if (!m_state.runnable()) {
+        if (m_state.threads_available == m_state.threads_total)
+          m_state.quiesce_cond.notify_all();
+        m_state.cond.wait(lock);
+        if (m_state.wakeups > 0)
+          m_state.wakeups--;
+      }
+      m_state.sleeping--;
+      m_state.threads_available--;
+      continue;
+    }
+
+    m_state.backlog--;
+    ClockT::time_point now = ClockT::now();
+    int64_t wait_us = std::max((int64_t)chrono::duration_cast<chrono::microseconds>(now - rec->added).count(), (int64_t)0);
+    m_state.wait[rec->lane].record(wait_us);
+
+    if (rec->handler) {
+      uint64_t trace_id = rec->handler->get_trace_id();
+      RequestTrace::record(trace_id, RequestTrace::QUEUE_WAIT,
+                           rec->added.time_since_epoch().count(),
+                           now.time_since_epoch().count());
+      if (rec->handler->verify_payload_checksum()) {
+        RequestTrace::Scope trace_scope(trace_id);
+        RequestTrace::Span span(RequestTrace::HANDLER);
+        rec->handler->run();
+      }
+    }
+    remove(rec);
+
+    if (m_one_shot)
+      return;
+  }
+}
+
+ApplicationQueue::RequestRec *ApplicationQueue::Worker::take() {
+  size_t count = m_state.queues.size();
+  size_t start = (m_index == NO_QUEUE) ? 0 : m_index;
+  bool low_first = (++m_take_count % LOW_PRIORITY_INTERVAL) == 0;
+  Lane order[LANE_COUNT] = { URGENT, NORMAL, LOW };
+  if (low_first)
+    std::swap(order[1], order[2]);
+  for (Lane lane : order) {
+    if (m_state.pending[lane] == 0 || (lane != URGENT && m_state.paused))
+      continue;
+    // Own deque first, then steal from the others
+    for (size_t i=0; i<count; i++) {
+      RequestRec *rec = take(*m_state.queues[(start + i) % count], lane);
+      if (rec)
+        return rec;
+    }
+  }
+  return nullptr;
+}
+
+ApplicationQueue::RequestRec *
+ApplicationQueue::Worker::take(WorkerQueue &wq, Lane lane) {
+  RequestQueue &queue = wq.queues[lane];
+  RequestRec *rec;
+  if (wq.sizes[lane] == 0)
+    return nullptr;
+  {
+    lock_guard<std::mutex> lock(wq.mutex);
+    if (queue.empty())
+      return nullptr;
+    rec = queue.front();
+    queue.pop_front();
+    wq.sizes[lane]--;
+    m_state.pending[lane]--;
+  }
+  return rec;
+}
+
+void ApplicationQueue::Worker::remove(RequestRec *rec) {
+  GroupState *group_state = rec->group_state;
+  vector<RequestRec *> expired;
+
+  if (group_state) {
+    GroupShard &shard = m_state.group_shard(group_state->group_id);
+    lock_guard<std::mutex> lock(shard.mutex);
+    RequestRec *next = nullptr;
+    while (next == nullptr &&
+           !(group_state->urgent.empty() && group_state->normal.empty())) {
+      list<RequestRec *> &waiting = group_state->urgent.empty() ?
+        group_state->normal : group_state->urgent;
+      next = waiting.front();
+      waiting.pop_front();
+      if (!next->handler || next->handler->is_expired()) {
+        expired.push_back(next);
+        next = nullptr;
+      }
+    }
+    if (next)
+      m_state.push(next, group_state->worker);
+    else {
+      shard.group_state_map.erase(group_state->group_id);
+      delete group_state;
+    }
+  }
+
+  m_state.backlog -= expired.size();
+  for (auto expired_rec : expired)
+    delete expired_rec;
+  delete rec;
+}
 
 ApplicationQueue::ApplicationQueue(int worker_count, bool dynamic_threads)
-	: joined(false), m_dynamic_threads(dynamic_threads) {
-	m_state.threads_total = worker_count;
-	Worker Worker(m_state);
-	assert(worker_count > 0);
-	for (int i = 0; i<worker_count; ++i) {
-		m_thread_ids.push_back(m_threads.create_thread(Worker)->get_id());
-	}
-	//threads
+  : joined(false), m_dynamic_threads(dynamic_threads) {
+  assert(worker_count > 0);
+  m_state.threads_total = worker_count;
+  for (int i=0; i<worker_count; ++i)
+    m_state.queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+  for (int i=0; i<worker_count; ++i) {
+    Worker worker(m_state, i);
+    m_thread_ids.push_back(m_threads.create_thread(worker)->get_id());
+  }
 }
 
 ApplicationQueue::~ApplicationQueue() {
-	if (!joined) {
-		shutdown();
-		join();
-	}
+  if (!joined) {
+    shutdown();
+    join();
+  }
+  for (auto &wq : m_state.queues) {
+    for (auto &queue : wq->queues)
+      for (auto rec : queue)
+        delete rec;
+  }
+  for (auto &shard : m_state.group_shards) {
+    for (auto &entry : shard.group_state_map) {
+      for (auto rec : entry.second->urgent)
+        delete rec;
+      for (auto rec : entry.second->normal)
+        delete rec;
+      delete entry.second;
+    }
+  }
 }
 
 bool ApplicationQueue::wait_for_idle(const std::chrono::time_point<std::chrono::steady_clock>& deadline,
-	int reserve_threads) {
-	std::unique_lock<std::mutex> lock(m_state.mutex);
-	return m_state.quiesce_cond.wait_until(lock, deadline,
-		[this, reserve_threads]() { return m_state.threads_available >= (m_state.threads_total - reserve_threads); });
+                                     int reserve_threads) {
+  unique_lock<std::mutex> lock(m_state.mutex);
+  return m_state.quiesce_cond.wait_until(lock, deadline,
+    [this, reserve_threads]() { return m_state.threads_available >= (m_state.threads_total - reserve_threads); });
 }
 
 void ApplicationQueue::join() {
-	if (!joined) {
-		m_threads.join_all();
-		joined = true;
-	}
+  if (!joined) {
+    m_threads.join_all();
+    joined = true;
+  }
 }
 
 void ApplicationQueue::start() {
-	std::lock_guard<std::mutex> lock(m_state.mutex);
-	m_state.paused = false;
-	m_state.cond.notify_all();
+  lock_guard<std::mutex> lock(m_state.mutex);
+  m_state.paused = false;
+  m_state.cond.notify_all();
 }
 
 void ApplicationQueue::stop() {
-	std::lock_guard<std::mutex> lock(m_state.mutex);
-	m_state.paused = true;
+  lock_guard<std::mutex> lock(m_state.mutex);
+  m_state.paused = true;
 }
 
 void ApplicationQueue::add(ApplicationHandler *app_handler) {
-	GroupStateMap::iterator uiter;
-	uint64_t group_id = app_handler->get_group_id();
-	RequestRec *rec = new RequestRec(app_handler);
-	rec->group_state = 0;
-
-	HT_ASSERT(app_handler);
-
-	if (group_id != 0) {
-		std::lock_guard<std::mutex> ulock(m_state.mutex);
-		if ((uiter = m_state.group_state_map.find(group_id))
-			!= m_state.group_state_map.end()) {
-			rec->group_state = (*uiter).second;
-			rec->group_state->outstanding++;
-		}
-		else {
-			rec->group_state = new GroupState();
-			rec->group_state->group_id = group_id;
-			m_state.group_state_map[group_id] = rec->group_state;
-		}
-	}
-
-	{
-		std::lock_guard<std::mutex> lock(m_state.mutex);
-		if (app_handler->is_urgent()) {
-			m_state.urgent_queue.push_back(rec);
-			if (m_dynamic_threads && m_state.threads_available == 0) {
-				Worker worker(m_state, true);
-				Thread t(worker);
-			}
-		}
-		else
-			m_state.queue.push_back(rec);
-		m_state.cond.notify_one();
-	}
+  HT_ASSERT(app_handler);
+
+  uint64_t group_id = app_handler->get_group_id();
+  bool urgent = app_handler->is_urgent();
+  RequestRec *rec = new RequestRec(app_handler);
+  if (urgent)
+    rec->lane = URGENT;
+  else if (app_handler->is_low_priority())
+    rec->lane = LOW;
+  rec->added = ClockT::now();
+  m_state.backlog++;
+
+  if (group_id != 0) {
+    GroupShard &shard = m_state.group_shard(group_id);
+    lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.group_state_map.find(group_id);
+    if (iter != shard.group_state_map.end()) {
+      rec->group_state = iter->second;
+      if (urgent)
+        rec->group_state->urgent.push_back(rec);
+      else
+        rec->group_state->normal.push_back(rec);
+      return;
+    }
+    rec->group_state = new GroupState();
+    rec->group_state->group_id = group_id;
+    rec->group_state->worker =
+      ApplicationQueueState::group_hash(group_id) % m_state.queues.size();
+    shard.group_state_map[group_id] = rec->group_state;
+    m_state.push(rec, rec->group_state->worker);
+  }
+  else
+    m_state.push(rec, m_state.next_queue++ % m_state.queues.size());
+
+  if (urgent && m_dynamic_threads && m_state.threads_available == 0) {
+    Worker worker(m_state, Worker::NO_QUEUE, true);
+    Thread t(worker);
+  }
+}
+
+namespace {
+  inline double to_ms(int64_t us) {
+    return (double)us / 1000.0;
+  }
+}
+
+void ApplicationQueue::publish_queue_wait(MetricsCollector *collector,
+                                          const std::string &prefix) {
+  const char *suffix[LANE_COUNT] = { ".urgent", "", ".low" };
+  for (int lane=0; lane<LANE_COUNT; lane++) {
+    LatencyHistogram::Snapshot snapshot;
+    m_state.wait[lane].collect(snapshot);
+    string name = prefix + suffix[lane];
+    collector->update(name + ".p50", to_ms(snapshot.percentile(50)));
+    collector->update(name + ".p99", to_ms(snapshot.percentile(99)));
+    collector->update(name + ".max", to_ms(snapshot.max));
+  }
 }
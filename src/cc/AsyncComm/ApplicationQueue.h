@@ -31,17 +31,22 @@
 #include <AsyncComm/ApplicationQueueInterface.h>
 #include <AsyncComm/ApplicationHandler.h>
 
+#include <Common/LatencyHistogram.h>
 #include <Common/Logger.h>
+#include <Common/MetricsCollector.h>
 #include <Common/StringExt.h>
 #include <Common/Thread.h>
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <list>
-#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -59,6 +64,16 @@ namespace Hypertable {
    * threads pull handlers (requests) off the queue and carry them out.  The
    * following features are supported:
    *
+   * <b>Work stealing</b>
+   *
+   * Each worker thread has its own request deques, one per Lane, protected
+   * by its own mutex.  Requests are pushed onto the deque
+   * of one worker and a worker takes requests from its own deques first and
+   * steals from the deques of the other workers when its own are empty, so
+   * adding and taking requests does not serialize on a single queue lock.
+   * Idle workers sleep on a condition variable that is only signalled when
+   * a worker is known to be idle.
+   *
    * <b>Groups</b>
    *
    * Because a set of worker threads pull requests from the queue and carry
@@ -73,70 +88,131 @@ namespace Hypertable {
    * same group ID will get executed in series, in the order in which they
    * arrived in the application queue.  Requests with group ID 0 don't belong to
    * any group and will get executed independently with no serialization
-   * order.
+   * order.  At most one request of a group is on a worker deque at any time;
+   * the others wait in the group's GroupState and the next one is pushed
+   * when the previous one completes.  A group is pushed onto the deque of
+   * the worker its ID hashes to, so that its requests tend to run on the
+   * same thread.  Group state is kept in #GROUP_SHARD_COUNT shards, each
+   * with its own mutex.
    *
    * <b>Prioritization</b>
    *
-   * The ApplicationQueue supports two-level request prioritization.  Requests
+   * The ApplicationQueue supports three-level request prioritization.  Requests
    * can be designated as <i>urgent</i> which will cause them to be executed
    * before other non-urgent requests.  Urgent requests will also be executed
    * even when the ApplicationQueue has been paused.  In Hypertable, METADATA
    * scans and updates are marked urgent which allows them procede and prevent
    * deadlocks when the application queue gets paused due to low memory
    * condition in the RangeServer.  The ApplicationHandler#is_urgent
-   * method is used to signal if a request is urgent.
+   * method is used to signal if a request is urgent.  Waiting urgent
+   * requests of a group are pushed before waiting non-urgent ones.
+   * Requests for which ApplicationHandler#is_low_priority returns
+   * <i>true</i> are executed after normal requests, except that every
+   * #LOW_PRIORITY_INTERVAL th request a worker takes is taken from the low
+   * priority lane first so that they are not starved.
+   *
+   * <b>Queue wait</b>
+   *
+   * The time between a request being added and a worker starting it is
+   * recorded in histograms, one per Lane, which are published with
+   * #publish_queue_wait.
    */
   class ApplicationQueue : public ApplicationQueueInterface {
 
+    class RequestRec;
+
+    /// Request lane, in order in which lanes are served
+    enum Lane {
+      URGENT = 0,  //!< Urgent requests
+      NORMAL,      //!< Normal requests
+      LOW,         //!< Low priority requests
+      LANE_COUNT   //!< Number of lanes
+    };
+
+    /// Every how many requests a worker serves the LOW lane first
+    static const int LOW_PRIORITY_INTERVAL = 8;
+
     /** Tracks group execution state.
      * A GroupState object is created for each unique group ID to track the
      * queue execution state of requests in the group.
      */
     class GroupState {
     public:
-      GroupState() : group_id(0), running(false), outstanding(1) { return; }
-      uint64_t group_id;    //!< Group ID
-      /** <i>true</i> if a request from this group is being executed */
-      bool     running;
-      /** Number of outstanding (uncompleted) requests in queue for this group*/
-      int      outstanding;
+      uint64_t group_id {};    //!< Group ID
+      /** <i>true</i> if a request from this group is on a worker deque or
+       * being executed */
+      bool running {};
+      /// Index of worker deque to which requests of group are pushed
+      size_t worker {};
+      /// Urgent requests waiting for the running request to complete
+      std::list<RequestRec *> urgent;
+      /// Normal and low priority requests waiting for the running request
+      /// to complete
+      std::list<RequestRec *> normal;
     };
 
     /** Hash map of thread group ID to GroupState
      */ 
     typedef std::unordered_map<uint64_t, GroupState *> GroupStateMap;
 
+    /** Shard of group state map.
+     */
+    class GroupShard {
+    public:
+      std::mutex mutex;              //!< %Mutex protecting shard
+      GroupStateMap group_state_map; //!< Group ID to group state map
+    };
+
+    /// Number of group state shards
+    static const size_t GROUP_SHARD_COUNT = 64;
+
     /** Request record.
      */
     class RequestRec {
     public:
-      RequestRec(ApplicationHandler *arh) : handler(arh), group_state(0) { return; }
+      RequestRec(ApplicationHandler *arh) : handler(arh) { return; }
       ~RequestRec() { delete handler; }
       ApplicationHandler *handler; //!< Pointer to ApplicationHandler
-      GroupState *group_state;     //!< Pointer to GroupState to which request belongs
+      GroupState *group_state {};  //!< Pointer to GroupState to which request belongs
+      Lane lane {NORMAL};          //!< Lane of request
+      ClockT::time_point added;    //!< Time request was added to queue
     };
 
     /** Individual request queue
      */
-    typedef std::list<RequestRec *> RequestQueue;
+    typedef std::deque<RequestRec *> RequestQueue;
+
+    /** Request deques of a worker thread.
+     */
+    class WorkerQueue {
+    public:
+      std::mutex mutex;                          //!< %Mutex protecting deques
+      std::array<RequestQueue, LANE_COUNT> queues; //!< Deque of each lane
+      /// Sizes of #queues, read by thieves without #mutex locked
+      std::array<std::atomic<size_t>, LANE_COUNT> sizes {};
+    };
 
     /** Application queue state shared among worker threads.
      */
     class ApplicationQueueState {
     public:
-      ApplicationQueueState() : threads_available(0), shutdown(false),
-                                paused(false) { }
 
-      /// Normal request queue
-      RequestQueue queue;
+      /// Request deques, one per worker thread
+      std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+      /// Group state shards
+      std::array<GroupShard, GROUP_SHARD_COUNT> group_shards;
 
-      /// Urgent request queue
-      RequestQueue urgent_queue;
+      /// Worker deque to which next ungrouped request is pushed
+      std::atomic<size_t> next_queue {};
 
-      /// Group ID to group state map
-      GroupStateMap group_state_map;
+      /// Number of requests on worker deques of each lane
+      std::array<std::atomic<size_t>, LANE_COUNT> pending {};
 
-      /// %Mutex for serializing concurrent access
+      /// Number of requests added and not yet started or dropped
+      std::atomic<size_t> backlog {};
+
+      /// %Mutex for idle, pause and shutdown state
       std::mutex mutex;
 
       /// Condition variable to signal pending handlers
@@ -146,16 +222,58 @@ namespace Hypertable {
       std::condition_variable quiesce_cond;
 
       /// Idle thread count
-      size_t threads_available;
+      std::atomic<size_t> threads_available {};
+
+      /// Number of threads waiting on #cond or about to
+      std::atomic<size_t> sleeping {};
+
+      /// Number of signals sent on #cond not yet consumed by a worker
+      std::atomic<size_t> wakeups {};
       
       /// Total initial threads
-      size_t threads_total;
+      size_t threads_total {};
 
       /// Flag indicating if shutdown is in progress
-      bool shutdown;
+      std::atomic<bool> shutdown {};
 
       /// Flag indicating if queue has been paused
-      bool paused;
+      std::atomic<bool> paused {};
+
+      /// Wait times of requests of each lane
+      std::array<LatencyHistogram, LANE_COUNT> wait;
+
+      /** Checks if a worker would find a request to run.
+       * @return <i>true</i> if an urgent request is pending or the queue is
+       * not paused and a normal or low priority request is pending
+       */
+      bool runnable() {
+        return pending[URGENT] > 0 ||
+          (!paused && (pending[NORMAL] > 0 || pending[LOW] > 0));
+      }
+
+      /** Pushes request onto worker deque and wakes up an idle worker.
+       * @param rec Request to push
+       * @param worker Index of worker deque
+       */
+      void push(RequestRec *rec, size_t worker);
+
+      /** Returns group state shard of group.
+       * @param group_id Group ID
+       * @return Shard holding state of <code>group_id</code>
+       */
+      GroupShard &group_shard(uint64_t group_id) {
+        return group_shards[group_hash(group_id) % GROUP_SHARD_COUNT];
+      }
+
+      /** Hashes group ID.
+       * Group IDs are made of a socket descriptor and a small CommHeader#gid,
+       * so they are mixed before being used as an index.
+       * @param group_id Group ID
+       * @return Hash value
+       */
+      static size_t group_hash(uint64_t group_id) {
+        return (size_t)((group_id * 0x9E3779B97F4A7C15ULL) >> 32);
+      }
     };
 
     /** Application queue worker thread function (functor)
@@ -163,148 +281,58 @@ namespace Hypertable {
     class Worker {
 
     public:
-      Worker(ApplicationQueueState &qstate, bool one_shot=false) 
-      : m_state(qstate), m_one_shot(one_shot) { return; }
+
+      /// Worker index of temporary threads, which have no deques
+      static const size_t NO_QUEUE = (size_t)-1;
+
+      /// Number of times an idle worker looks for requests before sleeping
+      static const int SPIN_COUNT = 4;
+
+      Worker(ApplicationQueueState &qstate, size_t index, bool one_shot=false) 
+        : m_state(qstate), m_index(index), m_one_shot(one_shot) { return; }
 
       /** Thread run method
        */
-      void operator()() {
-        RequestRec *rec = 0;
-        RequestQueue::iterator iter;
-
-        while (true) {
-          {
-            std::unique_lock<std::mutex> lock(m_state.mutex);
-
-            m_state.threads_available++;
-            while ((m_state.paused || m_state.queue.empty()) &&
-                   m_state.urgent_queue.empty()) {
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-              if (m_state.threads_available == m_state.threads_total)
-                m_state.quiesce_cond.notify_all();
-              m_state.cond.wait(lock);
-            }
-
-            if (m_state.shutdown) {
-              m_state.threads_available--;
-              return;
-            }
-
-            rec = 0;
-
-            iter = m_state.urgent_queue.begin();
-            while (iter != m_state.urgent_queue.end()) {
-              rec = (*iter);
-              if (rec->group_state == 0 || !rec->group_state->running) {
-                if (rec->group_state)
-                  rec->group_state->running = true;
-                m_state.urgent_queue.erase(iter);
-                break;
-              }
-              if (!rec->handler || rec->handler->is_expired()) {
-                iter = m_state.urgent_queue.erase(iter);
-                remove_expired(rec);
-              }
-              rec = 0;
-              iter++;
-            }
-
-            if (rec == 0 && !m_state.paused) {
-              iter = m_state.queue.begin();
-              while (iter != m_state.queue.end()) {
-                rec = (*iter);
-                if (rec->group_state == 0 || !rec->group_state->running) {
-                  if (rec->group_state)
-                    rec->group_state->running = true;
-                  m_state.queue.erase(iter);
-                  break;
-                }
-                if (!rec->handler || rec->handler->is_expired()) {
-                  iter = m_state.queue.erase(iter);
-                  remove_expired(rec);
-                }
-                rec = 0;
-                iter++;
-              }
-            }
-
-            if (rec == 0 && !m_one_shot) {
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-              m_state.cond.wait(lock);
-              if (m_state.shutdown) {
-                m_state.threads_available--;
-                return;
-              }
-            }
-
-            m_state.threads_available--;
-          }
-
-          if (rec) {
-            if (rec->handler)
-              rec->handler->run();
-            remove(rec);
-            if (m_one_shot)
-              return;
-          }
-          else if (m_one_shot)
-            return;
-        }
-
-        HT_INFO("thread exit");
-      }
+      void operator()();
 
     private:
 
-      /** Removes and deletes a request.  This method updates the group
-       * state associated with <code>rec</code> by setting the running flag to
-       * <i>false</i> and decrementing the outstanding count.  If the
-       * outstanding count for the group drops to 0, the group state record
-       * is removed from ApplicationQueueState::group_state_map and is deleted.
-       * @param rec Request record to remove
+      /** Takes next request to run.
+       * Takes the first urgent request from the worker's own deque or, if
+       * there is none, steals one from another worker.  If there is no urgent
+       * request and the queue is not paused, does the same for normal
+       * requests and then for low priority requests, or for low priority
+       * requests first every #LOW_PRIORITY_INTERVAL th call.
+       * @return Request, or nullptr if none found
        */
-      void remove(RequestRec *rec) {
-        if (rec->group_state) {
-          std::lock_guard<std::mutex> ulock(m_state.mutex);
-          rec->group_state->running = false;
-          rec->group_state->outstanding--;
-          if (rec->group_state->outstanding == 0) {
-            m_state.group_state_map.erase(rec->group_state->group_id);
-            delete rec->group_state;
-          }
-        }
-        delete rec;
-      }
+      RequestRec *take();
 
-      /** Removes and deletes an expired request.  This method updates the group
-       * state associated with <code>rec</code> by decrementing the outstanding
-       * count.  If the outstanding count for the group drops to 0, the group
-       * state record is removed from ApplicationQueueState::group_state_map and
-       * is deleted.
+      /** Takes first request from a deque.
+       * @param wq Worker deques
+       * @param lane Lane of deque to take from
+       * @return Request, or nullptr if deque is empty
+       */
+      RequestRec *take(WorkerQueue &wq, Lane lane);
+
+      /** Completes a request.
+       * If the request belongs to a group, pushes the next waiting request of
+       * the group, dropping expired ones, or removes the group state if no
+       * request is waiting.  Deletes <code>rec</code>.
        * @param rec Request record to remove
        */
-      void remove_expired(RequestRec *rec) {
-        if (rec->group_state) {
-          rec->group_state->outstanding--;
-          if (rec->group_state->outstanding == 0) {
-            m_state.group_state_map.erase(rec->group_state->group_id);
-            delete rec->group_state;
-          }
-        }
-        delete rec;
-      }
+      void remove(RequestRec *rec);
 
       /// Shared application queue state object
       ApplicationQueueState &m_state;
 
+      /// Index of worker's deques in ApplicationQueueState::queues
+      size_t m_index;
+
       /// Set to <i>true</i> if thread should exit after executing request
       bool m_one_shot;
+
+      /// Number of calls to take()
+      uint32_t m_take_count {};
     };
 
     /// Application queue state object
@@ -353,8 +381,8 @@ namespace Hypertable {
     }
 
     /**
-     * Shuts down the application queue.  All outstanding requests are carried
-     * out and then all threads exit.  #join can be called to wait for
+     * Shuts down the application queue.  Requests being executed are
+     * carried out and then all threads exit.  #join can be called to wait for
      * completion of the shutdown.
      */
     void shutdown() {
@@ -410,14 +438,25 @@ namespace Hypertable {
       add(app_handler);
     }
 
-    /// Returns the request backlog
     /// Returns the request backlog, which is the number of requests waiting on
     /// the request queues for a thread to become available
     /// @return Request backlog
     size_t backlog() {
-      std::lock_guard<std::mutex> lock(m_state.mutex);
-      return m_state.queue.size() + m_state.urgent_queue.size();
+      return m_state.backlog;
     }
+
+    /** Publishes and resets queue wait histograms.
+     * Publishes the metrics <code><i>prefix</i>.p50</code>,
+     * <code>.p99</code> and <code>.max</code> for normal requests,
+     * <code><i>prefix</i>.urgent.p50</code>, <code>.p99</code> and
+     * <code>.max</code> for urgent requests, and
+     * <code><i>prefix</i>.low.p50</code>, <code>.p99</code> and
+     * <code>.max</code> for low priority requests, in milliseconds.
+     * @param collector Metrics collector
+     * @param prefix Metric name prefix
+     */
+    void publish_queue_wait(MetricsCollector *collector,
+                            const std::string &prefix);
   };
 
   /// Shared smart pointer to ApplicationQueue object
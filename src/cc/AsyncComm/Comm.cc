@@ -448,6 +448,8 @@ int Comm::send_request(IOHandlerData *data_handler, uint32_t timeout_ms,
                        CommBufPtr &cbuf, DispatchHandler *resp_handler) {
 
   cbuf->header.flags |= CommHeader::FLAGS_BIT_REQUEST;
+  if (data_handler->payload_checksum())
+    cbuf->header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM;
   if (resp_handler == 0) {
     cbuf->header.flags |= CommHeader::FLAGS_BIT_IGNORE_RESPONSE;
     cbuf->header.id = 0;
@@ -483,6 +485,12 @@ int Comm::send_response(const CommAddress &addr, CommBufPtr &cbuf) {
 
   cbuf->header.flags &= CommHeader::FLAGS_MASK_REQUEST;
 
+  // Peers without payload checksum support echo the checksum flag of the
+  // request without filling in the checksum, so tell the requester that
+  // this one is real
+  if (cbuf->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM)
+    cbuf->header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE;
+
   cbuf->write_header_and_reset();
 
   error = data_handler->send_message(cbuf);
@@ -32,6 +32,7 @@
 #include "CommHeader.h"
 
 #include <Common/ByteString.h>
+#include <Common/Checksum.h>
 #include <Common/InetAddr.h>
 #include <Common/Logger.h>
 #include <Common/Serialization.h>
@@ -141,11 +142,25 @@ namespace Hypertable {
      * This method resets the primary and extended data pointers to point to the
      * beginning of their respective buffers.  The AsyncComm layer
      * uses these pointers to track how much data has been sent and
-     * what is remaining to be sent.
+     * what is remaining to be sent.  If CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM
+     * is set in the header flags, the CRC-32C checksum of the payload (the
+     * primary buffer following the header and the extended buffer) is
+     * computed and stored in the <code>payload_checksum</code> header field.
+     * The checksum is computed here rather than while the buffers are being
+     * written to the socket because the header, which carries it, is sent
+     * first.
      */
     void write_header_and_reset() {
       uint8_t *buf = data.base;
       HT_ASSERT((data_ptr-data.base) == (int)data.size || data_ptr == data.base);
+      if (header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM) {
+        size_t header_len = header.encoded_length();
+        header.payload_checksum =
+          crc32c(data.base + header_len, data.size - header_len);
+        if (ext.base && ext.size)
+          header.payload_checksum =
+            crc32c_extend(header.payload_checksum, ext.base, ext.size);
+      }
       header.encode(&buf);
       data_ptr = data.base;
       ext_ptr = ext.base;
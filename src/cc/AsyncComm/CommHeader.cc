@@ -38,6 +38,7 @@ using namespace Hypertable;
 
 void CommHeader::encode(uint8_t **bufp) {
   uint8_t *base = *bufp;
+  header_len = encoded_length();
   Serialization::encode_i8(bufp, version);
   Serialization::encode_i8(bufp, header_len);
   Serialization::encode_i16(bufp, alignment);
@@ -53,6 +54,8 @@ void CommHeader::encode(uint8_t **bufp) {
   header_checksum = fletcher32(base, (*bufp)-base);
   base += 6;
   Serialization::encode_i32(&base, header_checksum);
+  if (flags & FLAGS_BIT_TRACE)
+    Serialization::encode_i64(bufp, trace_id);
 }
 
 void CommHeader::decode(const uint8_t **bufp, size_t *remainp) {
@@ -78,4 +81,8 @@ void CommHeader::decode(const uint8_t **bufp, size_t *remainp) {
   if (checksum != header_checksum)
     HT_THROWF(Error::COMM_HEADER_CHECKSUM_MISMATCH, "%u != %u", checksum,
               header_checksum);
+  trace_id = 0;
+  if ((flags & FLAGS_BIT_TRACE) && header_len >= FIXED_LENGTH + 8)
+    HT_TRY("decoding comm header trace ID",
+           trace_id = Serialization::decode_i64(bufp, remainp));
 }
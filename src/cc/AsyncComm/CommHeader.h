@@ -52,6 +52,8 @@ namespace Hypertable {
       FLAGS_BIT_IGNORE_RESPONSE  = 0x0002, //!< Response should be ignored
       FLAGS_BIT_URGENT           = 0x0004, //!< Request is urgent
       FLAGS_BIT_PROFILE          = 0x0008, //!< Request should be profiled
+      FLAGS_BIT_TRACE            = 0x0010, //!< Header carries trace ID
+      FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE = 0x2000, //!< Responder filled in payload checksum
       FLAGS_BIT_PROXY_MAP_UPDATE = 0x4000, //!< ProxyMap update message
       FLAGS_BIT_PAYLOAD_CHECKSUM = 0x8000  //!< Payload checksumming is enabled
     };
@@ -63,6 +65,8 @@ namespace Hypertable {
       FLAGS_MASK_IGNORE_RESPONSE  = 0xFFFD, //!< Response should be ignored bit
       FLAGS_MASK_URGENT           = 0xFFFB, //!< Request is urgent bit
       FLAGS_MASK_PROFILE          = 0xFFF7, //!< Request should be profiled
+      FLAGS_MASK_TRACE            = 0xFFEF, //!< Header carries trace ID bit
+      FLAGS_MASK_PAYLOAD_CHECKSUM_RESPONSE = 0xDFFF, //!< Responder filled in payload checksum bit
       FLAGS_MASK_PROXY_MAP_UPDATE = 0xBFFF, //!< ProxyMap update message bit
       FLAGS_MASK_PAYLOAD_CHECKSUM = 0x7FFF  //!< Payload checksumming is enabled bit
     };
@@ -90,13 +94,33 @@ namespace Hypertable {
     size_t fixed_length() const { return FIXED_LENGTH; }
 
     /** Returns encoded length of header.
+     * If #FLAGS_BIT_TRACE is set, the header is followed by the 8-byte trace
+     * ID extension.
      * @return Encoded length of header
      */
-    size_t encoded_length() const { return FIXED_LENGTH; }
+    size_t encoded_length() const {
+      return (flags & FLAGS_BIT_TRACE) ? FIXED_LENGTH + 8 : FIXED_LENGTH;
+    }
+
+    /** Sets trace ID.
+     * Sets #trace_id and sets or clears #FLAGS_BIT_TRACE accordingly.  Since
+     * this changes the encoded length of the header, it must be called
+     * before a CommBuf is constructed from the header.
+     * @param id Trace ID (see RequestTrace), 0 if request not traced
+     */
+    void set_trace_id(uint64_t id) {
+      trace_id = id;
+      if (id)
+        flags |= FLAGS_BIT_TRACE;
+      else
+        flags &= FLAGS_MASK_TRACE;
+    }
 
     /** Encode header to memory pointed to by <code>*bufp</code>.
      * The <code>bufp</code> pointer is advanced to address immediately
-     * following the encoded header.
+     * following the encoded header.  The header checksum covers the fixed
+     * part of the header only, so that receivers not knowing about the
+     * trace ID extension skip it.
      * @param bufp Address of memory pointer to where header is to be encoded.
      */
     void encode(uint8_t **bufp);
@@ -130,6 +154,7 @@ namespace Hypertable {
       id = req_header.id;
       gid = req_header.gid;
       command = req_header.command;
+      trace_id = req_header.trace_id;
       total_len = 0;
     }
 
@@ -142,8 +167,9 @@ namespace Hypertable {
     uint32_t gid;        //!< Group ID (see ApplicationQueue)
     uint32_t total_len;  //!< Total length of message including header
     uint32_t timeout_ms; //!< Request timeout
-    uint32_t payload_checksum; //!< Payload checksum (currently unused)
+    uint32_t payload_checksum; //!< CRC-32C of payload, if checksum flag set
     uint64_t command;    //!< Request command number
+    uint64_t trace_id {}; //!< Trace ID, if #FLAGS_BIT_TRACE set
   };
   /** @}*/
 }
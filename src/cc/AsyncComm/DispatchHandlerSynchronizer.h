@@ -92,7 +92,9 @@ namespace Hypertable {
      * wait for the response (or timeout event).  This method
      * just blocks on the condition variable until the event
      * queue is non-empty and then removes and returns the head of the
-     * queue.
+     * queue.  A response whose payload checksum did not match arrives as an
+     * ERROR event with Error::COMM_PAYLOAD_CHECKSUM_MISMATCH (see
+     * Event::verify_response_payload_checksum).
      *
      * @param event Smart pointer to event object
      * @return true if next returned event is type MESSAGE and contains
@@ -37,6 +37,7 @@ extern "C" {
 #include <arpa/inet.h>
 }
 
+#include "Common/Checksum.h"
 #include "Common/Error.h"
 #include "Common/StringExt.h"
 
@@ -84,5 +85,32 @@ String Event::to_str() const {
   return dstr;
 }
 
+int Event::verify_payload_checksum() const {
+  if (type != MESSAGE ||
+      (header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM) == 0)
+    return Error::OK;
+  uint32_t checksum = crc32c(payload, payload_len);
+  if (checksum != header.payload_checksum) {
+    HT_WARNF("Payload checksum mismatch (%u != %u) in message from %s",
+             (unsigned)checksum, (unsigned)header.payload_checksum,
+             addr.format().c_str());
+    return Error::COMM_PAYLOAD_CHECKSUM_MISMATCH;
+  }
+  return Error::OK;
+}
 
-
+int Event::verify_response_payload_checksum() {
+  if (type != MESSAGE || (header.flags & CommHeader::FLAGS_BIT_REQUEST) ||
+      (header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM) == 0)
+    return Error::OK;
+  if ((header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE) == 0) {
+    header.flags &= CommHeader::FLAGS_MASK_PAYLOAD_CHECKSUM;
+    return Error::OK;
+  }
+  int err = verify_payload_checksum();
+  if (err != Error::OK) {
+    type = ERROR;
+    error = err;
+  }
+  return err;
+}
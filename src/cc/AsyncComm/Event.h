@@ -159,6 +159,32 @@ namespace Hypertable {
       return arrival_time + std::chrono::milliseconds(header.timeout_ms);
     }
 
+    /** Verifies payload checksum of MESSAGE event.
+     * If CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM is set in the header flags,
+     * computes the CRC-32C checksum of the payload and compares it with the
+     * <code>payload_checksum</code> header field.  The reactor thread does
+     * not verify payloads, this method is called by the thread that consumes
+     * the event.
+     * @return Error::OK if payload is not checksummed or checksum matches,
+     * Error::COMM_PAYLOAD_CHECKSUM_MISMATCH otherwise
+     */
+    int verify_payload_checksum() const;
+
+    /** Verifies payload checksum of response MESSAGE event.
+     * Called by the reactor thread before a response is delivered, so that
+     * every response handler receives verified payloads.  A response is
+     * verified only if CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE is
+     * set, which the responder sets when it has filled in the checksum.
+     * Peers without payload checksum support echo
+     * CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM of the request without it, so
+     * for their responses the checksum flag is cleared and the payload is
+     * not verified.  On mismatch, the event is turned into an ERROR event
+     * with Error::COMM_PAYLOAD_CHECKSUM_MISMATCH.
+     * @return Error::OK if event is not a checksummed response or checksum
+     * matches, Error::COMM_PAYLOAD_CHECKSUM_MISMATCH otherwise
+     */
+    int verify_response_payload_checksum();
+
     /** Type of event.  Can take one of values CONNECTION_ESTABLISHED,
      * DISCONNECT, MESSAGE, ERROR, or TIMER
      */
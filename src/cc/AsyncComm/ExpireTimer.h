@@ -44,19 +44,6 @@ namespace Hypertable {
     DispatchHandlerPtr handler; //!< Dispatch handler to receive TIMER event
   };
 
-  /** Comparison function (functor) for timer heap.
-   */
-  struct LtTimerHeap {
-    /** Parenthesis operator with two ExpireTimer parameters.
-     * Provides "largest first" comparison.
-     * @param t1 Lefthand side of comparison
-     * @param t2 Righthand side of comparison
-     * @return true if <code>t1</code> is greater than <code>t2</code>
-     */
-    bool operator()(const ExpireTimer &t1, const ExpireTimer &t2) const {
-      return CHRONO_OPERATOR>(t1.expire_time, t2.expire_time);
-    }
-  };
   /** @}*/
 }
 
@@ -45,9 +45,10 @@ void HandlerMap::insert_handler(IOHandlerAccept *handler) {
 
 void HandlerMap::insert_handler(IOHandlerData *handler, bool checkout) {
   lock_guard<recursive_mutex> lock(m_mutex);
-  HT_ASSERT(m_data_handler_map.find(handler->get_address())
-            == m_data_handler_map.end());
-  m_data_handler_map[handler->get_address()] = handler;
+  DataShard &shard = data_shard(handler->get_address());
+  lock_guard<mutex> shard_lock(shard.mutex);
+  HT_ASSERT(shard.map.find(handler->get_address()) == shard.map.end());
+  shard.map[handler->get_address()] = handler;
   if (checkout)
 #ifndef _WIN32
     handler->increment_reference_count();
@@ -92,15 +93,21 @@ int HandlerMap::checkout_handler(const CommAddress &addr,
 
 int HandlerMap::checkout_handler(const CommAddress &addr,
                                  IOHandlerData **handler) {
-  lock_guard<recursive_mutex> lock(m_mutex);
   InetAddr inet_addr;
   int error;
 
   if ((error = translate_address(addr, &inet_addr)) != Error::OK)
     return error;
 
-  if ((*handler = lookup_data_handler(inet_addr)) == 0)
+  // Handlers are removed from their shard before being decomissioned, so
+  // taking the reference with the shard locked is enough
+  DataShard &shard = data_shard(inet_addr);
+  lock_guard<mutex> lock(shard.mutex);
+
+  auto iter = shard.map.find(inet_addr);
+  if (iter == shard.map.end())
     return Error::COMM_NOT_CONNECTED;
+  *handler = iter->second;
 
   HT_ASSERT(!(*handler)->is_decomissioned());
 
@@ -150,7 +157,7 @@ int HandlerMap::checkout_handler(const CommAddress &addr,
 }
 
 void HandlerMap::decrement_reference_count(IOHandler *handler) {
-  lock_guard<recursive_mutex> lock(m_mutex);
+  lock_guard<mutex> lock(reference_mutex(handler));
   handler->decrement_reference_count();
 }
 
@@ -164,7 +171,6 @@ void HandlerMap::increment_reference_count(IOHandler *handler) {
 #endif
 
 int HandlerMap::contains_data_handler(const CommAddress &addr) {
-  lock_guard<recursive_mutex> lock(m_mutex);
   IOHandlerData *handler;
   InetAddr inet_addr;
   int error;
@@ -180,23 +186,24 @@ int HandlerMap::contains_data_handler(const CommAddress &addr) {
 
 int HandlerMap::set_alias(const InetAddr &addr, const InetAddr &alias) {
   lock_guard<recursive_mutex> lock(m_mutex);
-  SockAddrMap<IOHandlerData *>::iterator iter;
+  IOHandlerData *handler;
 
-  if (m_data_handler_map.find(alias) != m_data_handler_map.end())
+  if (lookup_data_handler(alias))
     return Error::COMM_CONFLICTING_ADDRESS;
 
-  if ((iter = m_data_handler_map.find(addr)) == m_data_handler_map.end())
+  if ((handler = lookup_data_handler(addr)) == 0)
     return Error::COMM_NOT_CONNECTED;
 
-  (*iter).second->set_alias(alias);
-  m_data_handler_map[alias] = (*iter).second;
+  handler->set_alias(alias);
+  DataShard &shard = data_shard(alias);
+  lock_guard<mutex> shard_lock(shard.mutex);
+  shard.map[alias] = handler;
 
   return Error::OK;
 }
 
 int HandlerMap::remove_handler_unlocked(IOHandler *handler) {
   SockAddrMap<IOHandlerAccept *>::iterator aiter;
-  SockAddrMap<IOHandlerData *>::iterator diter;
   SockAddrMap<IOHandlerDatagram *>::iterator dgiter;
   SockAddrMap<IOHandlerRaw *>::iterator riter;
   InetAddr local_addr = handler->get_local_address();
@@ -205,15 +212,9 @@ int HandlerMap::remove_handler_unlocked(IOHandler *handler) {
 
   if ((error = translate_address(handler->get_address(), &remote_addr)) != Error::OK)
     return error;
-  if ((diter = m_data_handler_map.find(remote_addr)) != m_data_handler_map.end()) {
-    HT_ASSERT(handler == diter->second);
-    m_data_handler_map.erase(diter);
+  if (erase_data_handler(remote_addr, handler)) {
     // Remove alias
-    remote_addr = handler->get_alias();
-    if ((diter = m_data_handler_map.find(remote_addr)) != m_data_handler_map.end()) {
-      HT_ASSERT(handler == diter->second);
-      m_data_handler_map.erase(diter);
-    }
+    erase_data_handler(handler->get_alias(), handler);
   }
   else if ((dgiter = m_datagram_handler_map.find(local_addr))
            != m_datagram_handler_map.end()) {
@@ -246,28 +247,34 @@ void HandlerMap::decomission_handler_unlocked(IOHandler *handler) {
     return;
   }
   m_decomissioned_handlers.insert(handler);
-  handler->decomission();
+  mark_decomissioned(handler);
 }
 
 void HandlerMap::decomission_all() {
   lock_guard<recursive_mutex> lock(m_mutex);
   SockAddrMap<IOHandlerAccept *>::iterator aiter;
-  SockAddrMap<IOHandlerData *>::iterator diter;
   SockAddrMap<IOHandlerDatagram *>::iterator dgiter;
   SockAddrMap<IOHandlerRaw *>::iterator riter;
 
-  // IOHandlerData 
-  for (diter = m_data_handler_map.begin(); diter != m_data_handler_map.end(); ++diter) {
-    m_decomissioned_handlers.insert(diter->second);
-    diter->second->decomission();
+  // IOHandlerData (cleared first so that checkout_handler() never returns a
+  // decomissioned handler)
+  std::set<IOHandlerData *> data_handlers;
+  for (auto &shard : m_data_shards) {
+    lock_guard<mutex> shard_lock(shard.mutex);
+    for (auto &entry : shard.map)
+      data_handlers.insert(entry.second);
+    shard.map.clear();
+  }
+  for (auto handler : data_handlers) {
+    m_decomissioned_handlers.insert(handler);
+    mark_decomissioned(handler);
   }
-  m_data_handler_map.clear();
 
   // IOHandlerDatagram
   for (dgiter = m_datagram_handler_map.begin();
        dgiter != m_datagram_handler_map.end(); ++dgiter) {
     m_decomissioned_handlers.insert(dgiter->second);
-    dgiter->second->decomission();
+    mark_decomissioned(dgiter->second);
   }
   m_datagram_handler_map.clear();
 
@@ -275,7 +282,7 @@ void HandlerMap::decomission_all() {
   for (aiter = m_accept_handler_map.begin();
        aiter != m_accept_handler_map.end(); ++aiter) {
     m_decomissioned_handlers.insert(aiter->second);
-    aiter->second->decomission();
+    mark_decomissioned(aiter->second);
   }
   m_accept_handler_map.clear();
 
@@ -283,7 +290,7 @@ void HandlerMap::decomission_all() {
   for (riter = m_raw_handler_map.begin();
        riter != m_raw_handler_map.end(); ++riter) {
     m_decomissioned_handlers.insert(riter->second);
-    riter->second->decomission();
+    mark_decomissioned(riter->second);
   }
   m_raw_handler_map.clear();
 
@@ -291,6 +298,7 @@ void HandlerMap::decomission_all() {
 
 bool HandlerMap::destroy_ok(IOHandler *handler) {
   lock_guard<recursive_mutex> lock(m_mutex);
+  lock_guard<mutex> reference_lock(reference_mutex(handler));
   bool is_decomissioned = m_decomissioned_handlers.count(handler) > 0;
   HT_ASSERT(!is_decomissioned || handler->is_decomissioned());
   return is_decomissioned && handler->reference_count() == 0;
@@ -434,7 +442,6 @@ int HandlerMap::propagate_proxy_map(ProxyMapT &mappings) {
   if (mappings.empty())
     return Error::OK;
 
-  SockAddrMap<IOHandlerData *>::iterator iter;
   String mapping;
 
   for (const auto &v : mappings)
@@ -446,19 +453,22 @@ int HandlerMap::propagate_proxy_map(ProxyMapT &mappings) {
   CommHeader header;
   header.flags |= CommHeader::FLAGS_BIT_PROXY_MAP_UPDATE;
   std::vector<IOHandler *> decomission;
-  for (iter = m_data_handler_map.begin(); iter != m_data_handler_map.end(); ++iter) {
-    IOHandlerData *handler = iter->second;
-    if (handler) {
-      CommBufPtr comm_buf = make_shared<CommBuf>(header, 0, payload, mapping.length()+1);
-      comm_buf->write_header_and_reset();
-      int error = handler->send_message(comm_buf);
-      if (error != Error::OK) {
-        decomission.push_back(handler);
-        HT_ERRORF("Unable to propagate proxy mappings to %s - %s",
-                  InetAddr(handler->get_address()).format().c_str(),
-                  Error::get_text(error));
-        last_error = error;
-      }
+  // Writers hold m_mutex, so the shards can be walked without their mutexes,
+  // which must not be held across send_message()
+  std::set<IOHandlerData *> handlers;
+  for (auto &shard : m_data_shards)
+    for (auto &entry : shard.map)
+      handlers.insert(entry.second);
+  for (auto handler : handlers) {
+    CommBufPtr comm_buf = make_shared<CommBuf>(header, 0, payload, mapping.length()+1);
+    comm_buf->write_header_and_reset();
+    int error = handler->send_message(comm_buf);
+    if (error != Error::OK) {
+      decomission.push_back(handler);
+      HT_ERRORF("Unable to propagate proxy mappings to %s - %s",
+                InetAddr(handler->get_address()).format().c_str(),
+                Error::get_text(error));
+      last_error = error;
     }
   }
 
@@ -492,12 +502,26 @@ IOHandlerAccept *HandlerMap::lookup_accept_handler(const InetAddr &addr) {
 }
 
 IOHandlerData *HandlerMap::lookup_data_handler(const InetAddr &addr) {
-  SockAddrMap<IOHandlerData *>::iterator iter = m_data_handler_map.find(addr);
-  if (iter != m_data_handler_map.end())
+  DataShard &shard = data_shard(addr);
+  lock_guard<mutex> lock(shard.mutex);
+  auto iter = shard.map.find(addr);
+  if (iter != shard.map.end())
     return iter->second;
   return 0;
 }
 
+bool HandlerMap::erase_data_handler(const InetAddr &addr,
+                                    IOHandler *handler) {
+  DataShard &shard = data_shard(addr);
+  lock_guard<mutex> lock(shard.mutex);
+  auto iter = shard.map.find(addr);
+  if (iter == shard.map.end())
+    return false;
+  HT_ASSERT(handler == iter->second);
+  shard.map.erase(iter);
+  return true;
+}
+
 IOHandlerDatagram *HandlerMap::lookup_datagram_handler(const InetAddr &addr) {
   SockAddrMap<IOHandlerDatagram *>::iterator iter = m_datagram_handler_map.find(addr);
   if (iter != m_datagram_handler_map.end())
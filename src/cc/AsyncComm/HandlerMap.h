@@ -44,6 +44,7 @@
 #include <Common/Time.h>
 #include <Common/Timer.h>
 
+#include <array>
 #include <condition_variable>
 #include <cassert>
 #include <memory>
@@ -160,8 +161,9 @@ namespace Hypertable {
 
     /** Decrements the reference count of <code>handler</code>.
      * The decrementing of a handler's reference count is done by this method
-     * with #m_mutex locked which avoids a race condition between checking
-     * out handlers and purging them.
+     * with the handler's reference mutex (see #reference_mutex) locked, which
+     * avoids a race condition between checking out handlers and purging them
+     * without serializing every send on #m_mutex.
      * @param handler Pointer to I/O handler for which to decrement reference
      * count
      */
@@ -393,14 +395,22 @@ namespace Hypertable {
     IOHandlerAccept *lookup_accept_handler(const InetAddr &addr);
 
     /** Finds <i>data (TCP)</i> I/O handler associated with <code>addr</code>.
-     * This method looks up <code>addr</code> in #m_data_handler_map and
-     * returns the handler, if found.
+     * This method looks up <code>addr</code> in its #m_data_shards shard, with
+     * the shard mutex locked, and returns the handler, if found.
      * @param addr Address of data handler to locate
      * @return Pointer to IOHandlerData object associated with
      * <code>addr</code>, or 0 if not found.
      */
     IOHandlerData *lookup_data_handler(const InetAddr &addr);
 
+    /** Removes <i>data (TCP)</i> map entry for <code>addr</code>.
+     * @param addr Address under which <code>handler</code> is registered
+     * @param handler Data handler expected at <code>addr</code>
+     * @return <i>true</i> if an entry was removed, <i>false</i> if
+     * <code>addr</code> is not in the map
+     */
+    bool erase_data_handler(const InetAddr &addr, IOHandler *handler);
+
     /** Finds <i>datagram</i> I/O handler associated with <code>addr</code>.
      * This method looks up <code>addr</code> in #m_datagram_handler_map and
      * returns the handler, if found.
@@ -419,6 +429,55 @@ namespace Hypertable {
      */
     IOHandlerRaw *lookup_raw_handler(const InetAddr &addr);
 
+    /// Number of data (TCP) map shards
+    static const size_t DATA_SHARD_COUNT = 32;
+
+    /// Number of reference count mutexes
+    static const size_t REFERENCE_MUTEX_COUNT = 32;
+
+    /** Shard of the data (TCP) map.
+     * Entries are modified with both #m_mutex and the shard mutex locked and
+     * may be read with either one locked.  This lets checkout_handler()
+     * look up connections without contending on #m_mutex.
+     */
+    class DataShard {
+    public:
+      /// %Mutex protecting #map
+      std::mutex mutex;
+      /// Data (TCP) map (InetAddr-to-IOHandlerData)
+      SockAddrMap<IOHandlerData *> map;
+    };
+
+    /** Returns data (TCP) map shard holding <code>addr</code>.
+     * @param addr Connection address
+     * @return Shard of #m_data_shards
+     */
+    DataShard &data_shard(const InetAddr &addr) {
+      uint64_t hash = (uint64_t)SockAddrHash()(addr) * 0x9E3779B97F4A7C15ULL;
+      return m_data_shards[(hash >> 32) % DATA_SHARD_COUNT];
+    }
+
+    /** Returns mutex serializing reference count changes of
+     * <code>handler</code>.
+     * The last decrement of a handler's reference count, its decomissioning
+     * and the destroy_ok() check are done with this mutex locked so that a
+     * handler is scheduled for removal exactly once and is not purged while
+     * a decrement is still in progress.
+     * @param handler I/O handler
+     * @return %Mutex in #m_reference_mutexes
+     */
+    std::mutex &reference_mutex(IOHandler *handler) {
+      return m_reference_mutexes[((uintptr_t)handler >> 6) % REFERENCE_MUTEX_COUNT];
+    }
+
+    /** Decomissions <code>handler</code> with its reference mutex locked.
+     * @param handler I/O handler to decomission
+     */
+    void mark_decomissioned(IOHandler *handler) {
+      std::lock_guard<std::mutex> lock(reference_mutex(handler));
+      handler->decomission();
+    }
+
     /// %Mutex for serializing concurrent access
     std::recursive_mutex m_mutex;
 
@@ -431,8 +490,11 @@ namespace Hypertable {
     /// Accept map (InetAddr-to-IOHandlerAccept)
     SockAddrMap<IOHandlerAccept *> m_accept_handler_map;
 
-    /// Data (TCP) map (InetAddr-to-IOHandlerData)
-    SockAddrMap<IOHandlerData *> m_data_handler_map;
+    /// Data (TCP) map shards
+    std::array<DataShard, DATA_SHARD_COUNT> m_data_shards;
+
+    /// Reference count mutexes
+    std::array<std::mutex, REFERENCE_MUTEX_COUNT> m_reference_mutexes;
 
     /// Datagram (UDP) map (InetAddr-to-IOHandlerDatagram)
     SockAddrMap<IOHandlerDatagram *> m_datagram_handler_map;
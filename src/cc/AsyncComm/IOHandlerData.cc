@@ -632,6 +632,16 @@ void IOHandlerData::handle_message_body() {
     m_event->payload_len = m_event->header.total_len
                            - m_event->header.header_len;
     m_event->payload_aligned = m_message_aligned;
+    // Request payloads are verified by the ApplicationQueue worker that
+    // runs the request, to keep the reactor thread free.  Response payloads
+    // are verified here, since responses reach many different dispatch
+    // handlers
+    if (m_event->header.flags & CommHeader::FLAGS_BIT_REQUEST) {
+      if (m_event->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM)
+        m_peer_payload_checksum = true;
+    }
+    else
+      m_event->verify_response_payload_checksum();
     {
       lock_guard<mutex> lock(m_mutex);
       m_event->set_proxy(m_proxy);
@@ -1047,7 +1057,10 @@ bool IOHandlerData::handle_event(IOOP *ioop, ClockT::time_point arrival_time) {
         else {
           m_message_header_ptr += nread;
           handle_message_header(arrival_time);
-          if (m_message_remaining != 0)
+          // Variable length header (e.g. trace context) still to be read
+          if (!m_got_header)
+            async_recv(m_message_header_ptr, m_message_header_remaining);
+          else if (m_message_remaining != 0)
             async_recv(m_message_ptr, m_message_remaining);
           else {
             handle_message_body();
@@ -33,6 +33,7 @@
 
 #include <Common/Error.h>
 
+#include <atomic>
 #include <list>
 
 extern "C" {
@@ -106,6 +107,19 @@ namespace Hypertable {
       m_message = 0;
     }
 
+    /** Checks if outgoing requests should carry a payload checksum.
+     * Payload checksums are enabled for a connection if
+     * <code>Comm.PayloadChecksum</code> is set locally or once the peer has
+     * sent a request with CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM set.
+     * Responses are verified if the peer marks them with
+     * CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE (see
+     * Event::verify_response_payload_checksum).
+     * @return <i>true</i> if payload checksums are enabled
+     */
+    bool payload_checksum() {
+      return ReactorFactory::payload_checksum || m_peer_payload_checksum;
+    }
+
     /** Sends message pointed to by <code>cbp</code> over socket associated
      * with this I/O handler.  If the message being sent is a request
      * message (has the CommHeader::FLAGS_BIT_REQUEST set) and
@@ -342,6 +356,9 @@ namespace Hypertable {
 
     /// Send queue
     std::list<CommBufPtr> m_send_queue;
+
+    /// Set once the peer has sent a checksummed request
+    std::atomic<bool> m_peer_payload_checksum {false};
   };
   /** @}*/
 }
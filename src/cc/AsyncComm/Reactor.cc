@@ -64,8 +64,8 @@ using namespace std;
 
 std::mutex Reactor::m_mutex;
 RequestCache Reactor::m_request_cache;
-Reactor::TimerHeap Reactor::m_timer_heap;
-ClockT::time_point Reactor::m_next_wakeup;
+TimerWheel Reactor::m_timer_wheel;
+std::atomic<ClockT::time_point> Reactor::m_next_wakeup;
 std::set<IOHandler *> Reactor::m_removed_handlers;
 
 Reactor::Reactor() {
@@ -183,52 +183,44 @@ Reactor::Reactor() {
 #endif
 
 void Reactor::handle_timeouts(PollTimeout &next_timeout) {
+  vector<RequestCache::TimedOutRequest> timed_out;
+  vector<TimerWheelNode *> expired_nodes;
   vector<ExpireTimer> expired_timers;
   EventPtr event;
-  ClockT::time_point now, next_req_timeout;
-  ExpireTimer timer;
+  ClockT::time_point now, next_req_timeout, next_wakeup;
 
   while(!ReactorRunner::shutdown) {
-    {
-      lock_guard<mutex> lock(m_mutex);
-      IOHandler *handler;
-      DispatchHandler *dh;
 
-      now = ClockT::now();
+    now = ClockT::now();
 
-      while (m_request_cache.get_next_timeout(now, handler, dh,
-                                              &next_req_timeout)) {
-        event = make_shared<Event>(Event::ERROR, ((IOHandlerData *)handler)->get_address(), Error::REQUEST_TIMEOUT);
-        event->set_proxy(((IOHandlerData *)handler)->get_proxy());
-        handler->deliver_event(event, dh);
-      }
+    // Clear the wakeup before scanning the request cache so that a request
+    // added behind the scan sees either this or the final wakeup and
+    // interrupts the poll loop if it expires earlier
+    m_next_wakeup = ClockT::time_point();
 
-      if (next_req_timeout != ClockT::time_point()) {
-        next_timeout.set(now, next_req_timeout);
-        m_next_wakeup = next_req_timeout;
-      }
-      else {
-        next_timeout.set_indefinite();
-        m_next_wakeup = ClockT::time_point();
-      }
+    /**
+     * Deliver request timeouts
+     */
+    timed_out.clear();
+    m_request_cache.get_timeouts(now, timed_out, &next_req_timeout);
+    for (auto &request : timed_out) {
+      IOHandlerData *handler = (IOHandlerData *)request.handler;
+      event = make_shared<Event>(Event::ERROR, handler->get_address(), Error::REQUEST_TIMEOUT);
+      event->set_proxy(handler->get_proxy());
+      handler->deliver_event(event, request.dh);
+    }
 
-      if (!m_timer_heap.empty()) {
+    {
+      lock_guard<mutex> lock(m_mutex);
+      expired_nodes.clear();
+      m_timer_wheel.advance(now, expired_nodes);
+      for (auto node : expired_nodes) {
+        TimerNode *timer_node = static_cast<TimerNode *>(node);
         ExpireTimer timer;
-
-        while (!m_timer_heap.empty()) {
-          timer = m_timer_heap.top();
-          if (timer.expire_time > now) {
-            if (next_req_timeout == ClockT::time_point() ||
-                timer.expire_time < next_req_timeout) {
-              next_timeout.set(now, timer.expire_time);
-              m_next_wakeup = timer.expire_time;
-            }
-            break;
-          }
-          expired_timers.push_back(timer);
-          m_timer_heap.pop();
-        }
-
+        timer.expire_time = timer_node->expire;
+        timer.handler = timer_node->handler;
+        expired_timers.push_back(timer);
+        delete timer_node;
       }
     }
 
@@ -241,22 +233,27 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
         expired_timers[i].handler->handle(event);
       }
     }
+    expired_timers.clear();
 
     {
       lock_guard<mutex> lock(m_mutex);
 
-      if (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
+      next_wakeup = m_timer_wheel.next_wakeup();
+      if (next_wakeup == ClockT::time_point() ||
+          (next_req_timeout != ClockT::time_point() &&
+           next_req_timeout < next_wakeup))
+        next_wakeup = next_req_timeout;
 
-        if (now > timer.expire_time)
+      if (next_wakeup != ClockT::time_point()) {
+        now = ClockT::now();
+        // Timers added while delivering may already be due
+        if (next_wakeup <= now)
           continue;
-
-        if (next_req_timeout == ClockT::time_point()
-            || timer.expire_time < next_req_timeout) {
-          next_timeout.set(now, timer.expire_time);
-          m_next_wakeup = timer.expire_time;
-        }
+        next_timeout.set(now, next_wakeup);
       }
+      else
+        next_timeout.set_indefinite();
+      m_next_wakeup = next_wakeup;
 
       poll_loop_continue();
     }
@@ -266,6 +263,18 @@ void Reactor::handle_timeouts(PollTimeout &next_timeout) {
 
 }
 
+void Reactor::clear_timers() {
+  lock_guard<mutex> lock(m_mutex);
+  vector<TimerWheelNode *> timers;
+  m_timer_wheel.for_each([&timers](TimerWheelNode *node) {
+      timers.push_back(node);
+    });
+  for (auto node : timers) {
+    m_timer_wheel.remove(node);
+    delete static_cast<TimerNode *>(node);
+  }
+}
+
 #ifndef _WIN32
 
 int Reactor::poll_loop_interrupt() {
@@ -342,9 +351,8 @@ int Reactor::poll_loop_interrupt() {
 #else
 
 void Reactor::destroy() {
+  clear_timers();
   lock_guard<mutex> lock(m_mutex);
-  while (!m_timer_heap.empty())
-    m_timer_heap.pop();
   m_removed_handlers.clear();
 }
 
@@ -32,12 +32,13 @@
 #include "PollTimeout.h"
 #include "RequestCache.h"
 #include "ExpireTimer.h"
+#include "TimerWheel.h"
 
 #include <boost/thread/thread.hpp>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <set>
 #include <vector>
 
@@ -95,9 +96,14 @@ namespace Hypertable {
      */
     ~Reactor() {
       poll_loop_interrupt();
+#ifndef _WIN32
+      clear_timers();
+#endif
     }
 
     /** Adds a request to request cache and adjusts poll timeout if necessary.
+     * The request cache does its own locking, so #m_mutex is only taken when
+     * the poll loop has to be interrupted to pick up an earlier timeout.
      * @param id Request ID
      * @param handler I/O handler with which request is associated
      * @param dh Application dispatch handler for response MESSAGE events
@@ -105,10 +111,13 @@ namespace Hypertable {
      */
     void add_request(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                      ClockT::time_point expire) {
-      std::lock_guard<std::mutex> lock(m_mutex);
       m_request_cache.insert(id, handler, dh, expire);
-      if (m_next_wakeup == ClockT::time_point() || expire < m_next_wakeup)
+      // Must be read after the insert, see handle_timeouts()
+      ClockT::time_point next_wakeup = m_next_wakeup.load();
+      if (next_wakeup == ClockT::time_point() || expire < next_wakeup) {
+        std::lock_guard<std::mutex> lock(m_mutex);
         poll_loop_interrupt();
+      }
     }
 
     /** Removes request associated with <code>id</code>
@@ -117,7 +126,6 @@ namespace Hypertable {
      * @return <i>true</i> if request removed, <i>false</i> otherwise
      */
     bool remove_request(uint32_t id, DispatchHandler *&handler) {
-      std::lock_guard<std::mutex> lock(m_mutex);
       return m_request_cache.remove(id, handler);
     }
 
@@ -127,19 +135,21 @@ namespace Hypertable {
      * @param error Error code to deliver with ERROR events
      */
     void cancel_requests(IOHandler *handler, int32_t error=Error::COMM_BROKEN_CONNECTION) {
-      std::lock_guard<std::mutex> lock(m_mutex);
       m_request_cache.purge_requests(handler, error);
     }
 
     /** Adds a timer.
-     * Pushes timer onto #m_timer_heap and interrupts the polling loop so that
-     * the poll timeout can be adjusted if necessary.
+     * Inserts timer into #m_timer_wheel and, if it expires before the next
+     * poll loop wakeup, interrupts the polling loop so that the poll timeout
+     * can be adjusted.
      * @param timer Reference to ExpireTimer object
      */
     void add_timer(ExpireTimer &timer) {
       std::lock_guard<std::mutex> lock(m_mutex);
-      m_timer_heap.push(timer);
-      poll_loop_interrupt();
+      insert_timer(timer.expire_time, timer.handler);
+      ClockT::time_point next_wakeup = m_next_wakeup.load();
+      if (next_wakeup == ClockT::time_point() || timer.expire_time < next_wakeup)
+        poll_loop_interrupt();
     }
 
     /** Cancels timers associated with <code>handler</code>.
@@ -148,18 +158,15 @@ namespace Hypertable {
      */
     void cancel_timer(const DispatchHandlerPtr &handler) {
       std::lock_guard<std::mutex> lock(m_mutex);
-      typedef TimerHeap::container_type container_t;
-      container_t container;
-      container.reserve(m_timer_heap.size());
-      ExpireTimer timer;
-      while (!m_timer_heap.empty()) {
-        timer = m_timer_heap.top();
-        if (timer.handler.get() != handler.get())
-          container.push_back(timer);
-        m_timer_heap.pop();
+      std::vector<TimerWheelNode *> cancelled;
+      m_timer_wheel.for_each([&handler, &cancelled](TimerWheelNode *node) {
+          if (static_cast<TimerNode *>(node)->handler.get() == handler.get())
+            cancelled.push_back(node);
+        });
+      for (auto node : cancelled) {
+        m_timer_wheel.remove(node);
+        delete static_cast<TimerNode *>(node);
       }
-      for (const auto &t : container)
-        m_timer_heap.push(t);
     }
 
     /** Schedules <code>handler</code> for removal.
@@ -176,10 +183,8 @@ namespace Hypertable {
       std::lock_guard<std::mutex> lock(m_mutex);
       m_removed_handlers.insert(handler);
 #ifndef _WIN32
-      ExpireTimer timer;
-      timer.expire_time = ClockT::now() + std::chrono::milliseconds(200);
-      timer.handler = 0;
-      m_timer_heap.push(timer);
+      insert_timer(ClockT::now() + std::chrono::milliseconds(200),
+                   DispatchHandlerPtr());
 #endif
       poll_loop_interrupt();
     }
@@ -199,7 +204,7 @@ namespace Hypertable {
      * This method removes timed out requests from the request cache, delivering
      * ERROR events (with error == Error::REQUEST_TIMEOUT) via each request's
      * dispatch handler.  It also processes expired timers by removing them from
-     * #m_timer_heap and delivering a TIMEOUT event via the timer handler if
+     * #m_timer_wheel and delivering a TIMEOUT event via the timer handler if
      * it exsists.
      * @param next_timeout Set to next earliest timeout of active requests and
      * timers
@@ -284,17 +289,37 @@ namespace Hypertable {
 
   private:
 
-    /** Priority queue for timers.
+    /** Timer entry of #m_timer_wheel.
      */
-    typedef std::priority_queue<ExpireTimer,
-      std::vector<ExpireTimer>, LtTimerHeap> TimerHeap;
-      
+    class TimerNode : public TimerWheelNode {
+    public:
+      /// Dispatch handler to receive TIMER event, null for wakeup timers
+      DispatchHandlerPtr handler;
+    };
+
+    /** Inserts timer into #m_timer_wheel.
+     * Caller must hold #m_mutex.
+     * @param expire Absolute expiration time
+     * @param handler Dispatch handler to receive TIMER event
+     */
+    void insert_timer(ClockT::time_point expire,
+                      const DispatchHandlerPtr &handler) {
+      TimerNode *node = new TimerNode();
+      node->expire = expire;
+      node->handler = handler;
+      m_timer_wheel.insert(node);
+    }
+
+    /** Removes and deletes all timers.
+     */
+    void clear_timers();
+
 #ifndef _WIN32
 
     std::mutex m_mutex;           //!< Mutex to protect members
     std::mutex m_polldata_mutex;  //!< Mutex to protect #m_polldata member
     RequestCache m_request_cache; //!< Request cache
-    TimerHeap m_timer_heap;       //!< ExpireTimer heap
+    TimerWheel m_timer_wheel;     //!< Timers
     int m_interrupt_sd;           //!< Interrupt socket
 
     /// Set to <i>true</i> if poll loop interrupt in progress
@@ -304,8 +329,9 @@ namespace Hypertable {
     /// <code>poll()</code>.
     std::vector<PollDescriptorT> m_polldata;
 
-    /// Next polling interface wait timeout (absolute)
-    ClockT::time_point m_next_wakeup;
+    /// Next polling interface wait timeout (absolute), read by add_request()
+    /// without #m_mutex locked
+    std::atomic<ClockT::time_point> m_next_wakeup;
 
     /// Set of IOHandler objects scheduled for removal
     std::set<IOHandler *> m_removed_handlers;
@@ -314,8 +340,8 @@ namespace Hypertable {
 
     static std::mutex m_mutex;
     static RequestCache m_request_cache;
-    static TimerHeap m_timer_heap;
-    static ClockT::time_point m_next_wakeup;
+    static TimerWheel m_timer_wheel;
+    static std::atomic<ClockT::time_point> m_next_wakeup;
     static std::set<IOHandler *> m_removed_handlers;
 
 #endif
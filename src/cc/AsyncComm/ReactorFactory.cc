@@ -50,6 +50,7 @@ HANDLE       ReactorFactory::hIOCP = 0;
 #endif
 bool ReactorFactory::proxy_master = false;
 bool ReactorFactory::verbose {};
+bool ReactorFactory::payload_checksum {};
 
 void ReactorFactory::initialize(uint16_t reactor_count) {
   lock_guard<mutex> lock(ms_mutex);
@@ -97,6 +98,9 @@ void ReactorFactory::initialize(uint16_t reactor_count) {
     use_poll = true;
 #endif
 
+  if (Config::properties && Config::properties->has("Comm.PayloadChecksum"))
+    payload_checksum = Config::properties->get_bool("Comm.PayloadChecksum");
+
   ms_reactors.reserve(reactor_count+2);
   for (uint16_t i=0; i<reactor_count+2; i++) {
     reactor = make_shared<Reactor>();
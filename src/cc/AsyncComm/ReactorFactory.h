@@ -122,6 +122,9 @@ namespace Hypertable {
     /// Verbose mode
     static bool verbose;
 
+    /// Checksum payloads of outgoing requests (<code>Comm.PayloadChecksum</code>)
+    static bool payload_checksum;
+
   private:
 
     /// Mutex to serialize calls to #initialize
@@ -39,31 +39,30 @@
 using namespace Hypertable;
 using namespace std;
 
+RequestCache::~RequestCache() {
+  for (auto &shard : m_shards)
+    for (auto &entry : shard.id_map)
+      delete entry.second;
+}
+
 void
 RequestCache::insert(uint32_t id, IOHandler *handler, DispatchHandler *dh,
                      ClockT::time_point &expire) {
 
   HT_DEBUGF("Adding id %d", id);
 
-  IdHandlerMap::iterator iter = m_id_map.find(id);
-
-  HT_ASSERT(iter == m_id_map.end());
-
+  Shard &s = shard(id);
   CacheNode *node = new CacheNode(id, handler, dh);
   node->expire = expire;
 
-  if (m_head == 0) {
-    node->next = node->prev = 0;
-    m_head = m_tail = node;
-  }
-  else {
-    node->next = m_tail;
-    node->next->prev = node;
-    node->prev = 0;
-    m_tail = node;
-  }
+  lock_guard<mutex> lock(s.mutex);
+
+  IdHandlerMap::iterator iter = s.id_map.find(id);
+
+  HT_ASSERT(iter == s.id_map.end());
 
-  m_id_map[id] = node;
+  s.wheel.insert(node);
+  s.id_map[id] = node;
 }
 
 
@@ -71,26 +70,23 @@ bool RequestCache::remove(uint32_t id, DispatchHandler *&handler) {
 
   HT_DEBUGF("Removing id %d", id);
 
-  IdHandlerMap::iterator iter = m_id_map.find(id);
+  Shard &s = shard(id);
+  CacheNode *node;
 
-  if (iter == m_id_map.end()) {
-    HT_DEBUGF("ID %d not found in request cache", id);
-    return false;
-  }
-
-  CacheNode *node = (*iter).second;
+  {
+    lock_guard<mutex> lock(s.mutex);
 
-  if (node->prev == 0)
-    m_tail = node->next;
-  else
-    node->prev->next = node->next;
+    IdHandlerMap::iterator iter = s.id_map.find(id);
 
-  if (node->next == 0)
-    m_head = node->prev;
-  else
-    node->next->prev = node->prev;
+    if (iter == s.id_map.end()) {
+      HT_DEBUGF("ID %d not found in request cache", id);
+      return false;
+    }
 
-  m_id_map.erase(iter);
+    node = (*iter).second;
+    s.wheel.remove(node);
+    s.id_map.erase(iter);
+  }
 
   handler = node->dh;
   delete node;
@@ -98,58 +94,66 @@ bool RequestCache::remove(uint32_t id, DispatchHandler *&handler) {
 }
 
 
-
-
-bool RequestCache::get_next_timeout(ClockT::time_point &now, IOHandler *&handlerp,
-                                    DispatchHandler *&dh,
-                                    ClockT::time_point *next_timeout) {
-
-  bool handler_removed = false;
-  while (m_head && !handler_removed && m_head->expire <= now) {
-
-    IdHandlerMap::iterator iter = m_id_map.find(m_head->id);
-    assert (iter != m_id_map.end());
-    CacheNode *node = m_head;
-    if (m_head->prev) {
-      m_head = m_head->prev;
-      m_head->next = 0;
+void RequestCache::get_timeouts(ClockT::time_point now,
+                                vector<TimedOutRequest> &timed_out,
+                                ClockT::time_point *next_timeout) {
+  vector<TimerWheelNode *> expired;
+  TimedOutRequest request;
+
+  *next_timeout = ClockT::time_point();
+
+  for (auto &s : m_shards) {
+    expired.clear();
+    {
+      lock_guard<mutex> lock(s.mutex);
+      s.wheel.advance(now, expired);
+      for (auto wheel_node : expired)
+        s.id_map.erase(static_cast<CacheNode *>(wheel_node)->id);
+      ClockT::time_point next = s.wheel.next_wakeup();
+      if (next != ClockT::time_point() &&
+          (*next_timeout == ClockT::time_point() || next < *next_timeout))
+        *next_timeout = next;
     }
-    else
-      m_head = m_tail = 0;
-
-    m_id_map.erase(iter);
-
-    if (node->handler != 0) {
-      handlerp = node->handler;
-      dh = node->dh;
-      handler_removed = true;
+    for (auto wheel_node : expired) {
+      CacheNode *node = static_cast<CacheNode *>(wheel_node);
+      request.handler = node->handler;
+      request.dh = node->dh;
+      timed_out.push_back(request);
+      delete node;
     }
-    delete node;
   }
-
-  if (m_head)
-    *next_timeout = m_head->expire;
-  else
-    *next_timeout = ClockT::time_point();
-
-  return handler_removed;
 }
 
 
-
 void RequestCache::purge_requests(IOHandler *handler, int32_t error) {
-  for (CacheNode *node = m_tail; node != 0; node = node->next) {
-    if (node->handler == handler) {
-      String proxy = handler->get_proxy();
-      EventPtr event;
-      HT_DEBUGF("Purging request id %d", node->id);
-      if (proxy.empty())
-        event = make_shared<Event>(Event::ERROR, handler->get_address(), error);
-      else
-        event = make_shared<Event>(Event::ERROR, handler->get_address(), proxy, error);
-      handler->deliver_event(event, node->dh);
-      node->handler = 0;  // mark for deletion
+  vector<CacheNode *> purged;
+
+  for (auto &s : m_shards) {
+    lock_guard<mutex> lock(s.mutex);
+    size_t first = purged.size();
+    s.wheel.for_each([handler, &purged](TimerWheelNode *wheel_node) {
+        CacheNode *node = static_cast<CacheNode *>(wheel_node);
+        if (node->handler == handler)
+          purged.push_back(node);
+      });
+    for (size_t i=first; i<purged.size(); i++) {
+      HT_DEBUGF("Purging request id %d", purged[i]->id);
+      s.wheel.remove(purged[i]);
+      s.id_map.erase(purged[i]->id);
     }
   }
-}
 
+  if (purged.empty())
+    return;
+
+  String proxy = handler->get_proxy();
+  for (auto node : purged) {
+    EventPtr event;
+    if (proxy.empty())
+      event = make_shared<Event>(Event::ERROR, handler->get_address(), error);
+    else
+      event = make_shared<Event>(Event::ERROR, handler->get_address(), proxy, error);
+    handler->deliver_event(event, node->dh);
+    delete node;
+  }
+}
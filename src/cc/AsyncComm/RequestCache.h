@@ -30,8 +30,12 @@
 
 #include <AsyncComm/Clock.h>
 #include <AsyncComm/DispatchHandler.h>
+#include <AsyncComm/TimerWheel.h>
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
+#include <vector>
 
 namespace Hypertable {
 
@@ -46,17 +50,19 @@ namespace Hypertable {
    * an entry, which includes the response handler, is inserted into the
    * RequestCache.  When the corresponding response is receive, the response
    * handler is obtained by looking up the corresponding request ID in this cache.
+   * Requests are spread by ID over #SHARD_COUNT shards, each with its own
+   * mutex, map and TimerWheel of expiration times, so that threads sending
+   * requests and the reactor thread receiving responses rarely contend with
+   * each other.  All methods are thread safe.
    */
   class RequestCache {
 
     /** Internal cache node structure.
      */
-    class CacheNode {
+    class CacheNode : public TimerWheelNode {
     public:
       CacheNode(uint32_t id, IOHandler *handler, DispatchHandler *dh)
         : id(id), handler(handler), dh(dh) {}
-      CacheNode  *prev, *next;    //!< Doubly-linked list pointers
-      ClockT::time_point expire;  //!< Absolute expiration time
       uint32_t           id;      //!< Request ID
       IOHandler         *handler; //!< IOHandler associated with this request
       /// Callback handler to which MESSAGE, TIMEOUT, ERROR, and DISCONNECT
@@ -67,11 +73,34 @@ namespace Hypertable {
     /// RequestID-to-CacheNode map
     typedef std::unordered_map<uint32_t, CacheNode *> IdHandlerMap;
 
+    /// Cache shard.
+    class Shard {
+    public:
+      std::mutex mutex;      //!< %Mutex protecting shard
+      IdHandlerMap id_map;   //!< RequestID-to-CacheNode map
+      TimerWheel wheel;      //!< Expiration times of requests
+    };
+
+    /// Number of shards
+    static const size_t SHARD_COUNT = 8;
+
   public:
 
+    /// Timed out request.
+    class TimedOutRequest {
+    public:
+      /// IOHandler associated with request
+      IOHandler *handler;
+      /// Dispatch handler to which the timeout is delivered
+      DispatchHandler *dh;
+    };
+
     /// Constructor.
     RequestCache() { }
 
+    /// Destructor.
+    ~RequestCache();
+
     /** Inserts pending request callback handler into cache.
      * @param id Request ID
      * @param handler IOHandler associated with 
@@ -89,38 +118,39 @@ namespace Hypertable {
      */
     bool remove(uint32_t id, DispatchHandler *&handler);
 
-    /** Removes next request that has timed out.  This method finds the first
-     * request starting from the head of the list and removes it and returns
-     * it's associated handler information if it has timed out.  During the
-     * search, it physically removes any cache nodes corresponding to requests
-     * that have been purged.
+    /** Removes requests that have timed out.
+     * Advances the TimerWheel of each shard to <code>now</code> and removes
+     * the requests that expired, which are returned in order of expiration
+     * time within each shard.
      * @param now Current time
-     * @param handlerp Return parameter to hold pointer to associated IOHandler
-     *                 of timed out request
-     * @param dh Removed dispatch handler
-     * @param next_timeout Pointer to variable to hold expiration time
-     * of next request <b>after</b> timed out request, set to 0 if cache is empty
-     * @return <i>true</i> if pointer to timed out dispatch handler was removed,
-     * <i>false</i> otherwise
+     * @param timed_out Receives timed out requests
+     * @param next_timeout Pointer to variable to hold time at which this
+     * method should be called next, set to 0 if cache is empty
      */
-    bool get_next_timeout(ClockT::time_point &now, IOHandler *&handlerp,
-                          DispatchHandler *&dh,
-                          ClockT::time_point *next_timeout);
+    void get_timeouts(ClockT::time_point now,
+                      std::vector<TimedOutRequest> &timed_out,
+                      ClockT::time_point *next_timeout);
 
     /** Purges all requests assocated with <code>handler</code>.  This
-     * method walks the entire cache and purges all requests whose
+     * method walks the entire cache and removes all requests whose
      * handler is equal to <code>handler</code>.  For each purged
      * request, an ERROR event with error code <code>error</code> is
-     * delivered via the request's dispatch handler.
+     * delivered via the request's dispatch handler, with no shard locked.
      * @param handler IOHandler of requests to purge
      * @param error Error code to be delivered with ERROR event
      */
     void purge_requests(IOHandler *handler, int32_t error);
 
   private:
-    IdHandlerMap m_id_map; //!< RequestID-to-CacheNode map
-    CacheNode *m_head {};  //!< Head of doubly-linked list
-    CacheNode *m_tail {};  //!< Tail of doubly-linked list
+
+    /** Returns shard holding request <code>id</code>.
+     * @param id Request ID
+     * @return Shard of #m_shards
+     */
+    Shard &shard(uint32_t id) { return m_shards[id % SHARD_COUNT]; }
+
+    /// Cache shards
+    std::array<Shard, SHARD_COUNT> m_shards;
   };
 }
 
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for TimerWheel.
+/// This file contains method definitions for TimerWheel, a hierarchical timing
+/// wheel used to track timer and request expiration times.
+
+#include <Common/Compat.h>
+
+#include "TimerWheel.h"
+
+#include <Common/Logger.h>
+
+#include <algorithm>
+#include <limits>
+
+using namespace Hypertable;
+using namespace std;
+
+TimerWheel::TimerWheel(ClockT::duration tick)
+  : m_tick(tick), m_start(ClockT::now()) {
+  HT_ASSERT(m_tick.count() > 0);
+}
+
+void TimerWheel::insert(TimerWheelNode *node) {
+  HT_ASSERT(node->slot == nullptr);
+  link(node, to_tick(node->expire));
+  m_size++;
+}
+
+void TimerWheel::remove(TimerWheelNode *node) {
+  if (node->slot == nullptr)
+    return;
+  if (node->prev)
+    node->prev->next = node->next;
+  else
+    *node->slot = node->next;
+  if (node->next)
+    node->next->prev = node->prev;
+  node->prev = node->next = nullptr;
+  node->slot = nullptr;
+  m_size--;
+}
+
+void TimerWheel::advance(ClockT::time_point now,
+                         vector<TimerWheelNode *> &expired) {
+  if (now < m_start)
+    return;
+
+  uint64_t target = (now - m_start) / m_tick;
+
+  if (m_size == 0) {
+    // Nothing to expire or cascade, skip idle ticks
+    if (target >= m_current)
+      m_current = target + 1;
+    return;
+  }
+
+  size_t first = expired.size();
+
+  while (m_current <= target && m_size > 0) {
+    TimerWheelNode **slot = &m_slots[0][m_current & (SLOTS-1)];
+    while (*slot) {
+      TimerWheelNode *node = *slot;
+      remove(node);
+      expired.push_back(node);
+    }
+    m_current++;
+    // Cascade higher levels first so that their entries can land in lower
+    // level slots that are cascaded next
+    for (int level=LEVELS-1; level>0; level--) {
+      int shift = SLOT_BITS * level;
+      if ((m_current & ((1ULL << shift) - 1)) == 0)
+        cascade(level, (m_current >> shift) & (SLOTS-1));
+    }
+  }
+
+  if (m_current <= target)
+    m_current = target + 1;
+
+  stable_sort(expired.begin() + first, expired.end(),
+              [](const TimerWheelNode *lhs, const TimerWheelNode *rhs) {
+                return lhs->expire < rhs->expire; });
+}
+
+ClockT::time_point TimerWheel::next_wakeup() const {
+  if (m_size == 0)
+    return ClockT::time_point();
+
+  uint64_t next = numeric_limits<uint64_t>::max();
+
+  for (int i=0; i<SLOTS; i++) {
+    if (m_slots[0][(m_current + i) & (SLOTS-1)]) {
+      next = m_current + i;
+      break;
+    }
+  }
+
+  for (int level=1; level<LEVELS; level++) {
+    int shift = SLOT_BITS * level;
+    uint64_t span = m_current >> shift;
+    for (int i=1; i<=SLOTS; i++) {
+      if (m_slots[level][(span + i) & (SLOTS-1)]) {
+        next = std::min(next, (span + i) << shift);
+        break;
+      }
+    }
+  }
+
+  return to_time(next);
+}
+
+uint64_t TimerWheel::to_tick(ClockT::time_point t) const {
+  if (t <= m_start)
+    return 0;
+  return ((t - m_start) + m_tick - ClockT::duration(1)) / m_tick;
+}
+
+ClockT::time_point TimerWheel::to_time(uint64_t tick) const {
+  return m_start + m_tick * (ClockT::duration::rep)tick;
+}
+
+void TimerWheel::link(TimerWheelNode *node, uint64_t tick) {
+  if (tick < m_current)
+    tick = m_current;
+
+  uint64_t delta = tick - m_current;
+  int level = 0;
+  while (level < LEVELS-1 && delta >= (1ULL << (SLOT_BITS * (level+1))))
+    level++;
+
+  // Beyond the range of the wheel, park in the farthest slot; the entry is
+  // linked again from its real expiration time when that slot cascades
+  if (delta >= (1ULL << (SLOT_BITS * LEVELS)))
+    tick = m_current + (1ULL << (SLOT_BITS * LEVELS)) - 1;
+
+  TimerWheelNode **slot =
+    &m_slots[level][(tick >> (SLOT_BITS * level)) & (SLOTS-1)];
+  node->slot = slot;
+  node->prev = nullptr;
+  node->next = *slot;
+  if (*slot)
+    (*slot)->prev = node;
+  *slot = node;
+}
+
+void TimerWheel::cascade(int level, int index) {
+  TimerWheelNode *node = m_slots[level][index];
+  m_slots[level][index] = nullptr;
+  while (node) {
+    TimerWheelNode *next = node->next;
+    link(node, to_tick(node->expire));
+    node = next;
+  }
+}
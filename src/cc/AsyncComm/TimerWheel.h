@@ -0,0 +1,177 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for TimerWheel.
+/// This file contains type declarations for TimerWheel, a hierarchical timing
+/// wheel used to track timer and request expiration times.
+
+#ifndef AsyncComm_TimerWheel_h
+#define AsyncComm_TimerWheel_h
+
+#include "Clock.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup AsyncComm
+  /// @{
+
+  /** Entry of a TimerWheel.
+   * Objects tracked by a TimerWheel derive from this class, which holds the
+   * expiration time and the links of the slot list the entry is on, so that
+   * insertion and removal do not allocate.
+   */
+  class TimerWheelNode {
+  public:
+    ClockT::time_point expire;  //!< Absolute expiration time
+    TimerWheelNode *prev {};    //!< Previous entry in slot
+    TimerWheelNode *next {};    //!< Next entry in slot
+    TimerWheelNode **slot {};   //!< Head of slot holding entry, or nullptr
+  };
+
+  /** Hierarchical timing wheel.
+   * Time is divided into ticks of fixed length.  The wheel has #LEVELS
+   * levels of #SLOTS slots each; a slot of level <i>n</i> spans
+   * <code>SLOTS</code><sup><i>n</i></sup> ticks.  An entry is put in the
+   * lowest level whose range covers its expiration tick, and entries of a
+   * higher level slot are moved down a level (cascaded) when the current
+   * tick enters the slot's span.  Insertion and removal are O(1) and
+   * advancing the wheel costs O(1) per tick plus O(1) per entry per level.
+   *
+   * Entries expire at the first tick boundary at or after their expiration
+   * time, so all entries expiring within the same tick are returned
+   * together by advance().  The class does no locking.
+   */
+  class TimerWheel {
+  public:
+
+    /// Number of levels
+    static const int LEVELS = 4;
+
+    /// Number of bits of tick number indexing a level
+    static const int SLOT_BITS = 8;
+
+    /// Number of slots per level
+    static const int SLOTS = 1 << SLOT_BITS;
+
+    /** Constructor.
+     * The default tick of 10 milliseconds is below the resolution any
+     * AsyncComm timer or request timeout is specified with, and coarse
+     * enough that bursts of expirations are handled in one batch.
+     * @param tick Tick length
+     */
+    TimerWheel(ClockT::duration tick = std::chrono::milliseconds(10));
+
+    /** Inserts an entry.
+     * <code>node->expire</code> must be set.  An expiration time in the past
+     * makes the entry expire on the next call to advance().
+     * @param node Entry to insert, not already in a wheel
+     */
+    void insert(TimerWheelNode *node);
+
+    /** Removes an entry.
+     * @param node Entry to remove, may have been removed already
+     */
+    void remove(TimerWheelNode *node);
+
+    /** Removes expired entries.
+     * Processes every tick up to <code>now</code> and appends the entries
+     * expiring in them to <code>expired</code>, in order of expiration time.
+     * @param now Current time
+     * @param expired Receives expired entries
+     */
+    void advance(ClockT::time_point now, std::vector<TimerWheelNode *> &expired);
+
+    /** Returns time at which advance() should next be called.
+     * The returned time is the earliest tick boundary holding an entry or,
+     * for entries of higher levels, the start of the earliest slot span that
+     * needs cascading, so it never lies after the next expiration.
+     * @return Next wakeup time, or ClockT::time_point() if wheel is empty
+     */
+    ClockT::time_point next_wakeup() const;
+
+    /** Calls a function on every entry.
+     * The function must not insert or remove entries.
+     * @param fn Function called with each entry
+     */
+    template <typename FunctionT>
+    void for_each(FunctionT fn) const {
+      for (int level=0; level<LEVELS; level++)
+        for (int i=0; i<SLOTS; i++)
+          for (TimerWheelNode *node = m_slots[level][i]; node; node = node->next)
+            fn(node);
+    }
+
+    /// Returns number of entries.
+    size_t size() const { return m_size; }
+
+    /// Returns <i>true</i> if wheel has no entries.
+    bool empty() const { return m_size == 0; }
+
+  private:
+
+    /** Converts time to tick number, rounding up.
+     * @param t Time to convert
+     * @return First tick whose boundary is not before <code>t</code>
+     */
+    uint64_t to_tick(ClockT::time_point t) const;
+
+    /** Converts tick number to time.
+     * @param tick Tick number
+     * @return Boundary of <code>tick</code>, at which its entries expire
+     */
+    ClockT::time_point to_time(uint64_t tick) const;
+
+    /** Links entry into the slot for tick <code>tick</code>.
+     * @param node Entry to link
+     * @param tick Expiration tick of entry
+     */
+    void link(TimerWheelNode *node, uint64_t tick);
+
+    /** Moves entries of a higher level slot down.
+     * @param level Level of slot
+     * @param index Index of slot
+     */
+    void cascade(int level, int index);
+
+    /// Tick length
+    ClockT::duration m_tick;
+
+    /// Boundary of tick 0
+    ClockT::time_point m_start;
+
+    /// Next tick to process
+    uint64_t m_current {};
+
+    /// Number of entries
+    size_t m_size {};
+
+    /// Slot list heads
+    TimerWheelNode *m_slots[LEVELS][SLOTS] {};
+  };
+
+  /// @}
+}
+
+#endif // AsyncComm_TimerWheel_h
@@ -113,6 +113,7 @@ void CommTestThreadFunction::operator()() {
       if (infile.fail())
         break;
 
+      header.set_trace_id(m_traced ? (uint64_t)nsent + 1 : 0);
       CommBufPtr cbp( new CommBuf(header, encoded_length_str16(line)) );
       cbp->append_str16(line);
       int retries = 0;
@@ -137,6 +138,8 @@ void CommTestThreadFunction::operator()() {
         if (!resp_handler->get_response(event_ptr))
           break;
         try {
+          if (m_traced && event_ptr->header.trace_id == 0)
+            HT_THROW(Error::PROTOCOL_ERROR, "Response without trace ID");
           decode_ptr = event_ptr->payload;
           decode_remain = event_ptr->payload_len;
           str = decode_str16(&decode_ptr, &decode_remain);
@@ -165,6 +168,8 @@ void CommTestThreadFunction::operator()() {
 
   while (outstanding > 0 && resp_handler->get_response(event_ptr)) {
     try {
+      if (m_traced && event_ptr->header.trace_id == 0)
+        HT_THROW(Error::PROTOCOL_ERROR, "Response without trace ID");
       decode_ptr = event_ptr->payload;
       decode_remain = event_ptr->payload_len;
       str = decode_str16(&decode_ptr, &decode_remain);
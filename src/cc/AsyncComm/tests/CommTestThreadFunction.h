@@ -39,6 +39,15 @@ class CommTestThreadFunction {
   void set_output_file(const char *output) {
     m_output_file = output;
   }
+  /** Sets whether requests carry a trace ID.
+   * Traced requests and their responses have the trace ID extension after
+   * the fixed header, which exercises reading of the variable length
+   * header.
+   * @param traced <i>true</i> to send traced requests
+   */
+  void set_traced(bool traced) {
+    m_traced = traced;
+  }
   void operator()();
 
  private:
@@ -46,5 +55,6 @@ class CommTestThreadFunction {
   struct sockaddr_in m_addr;
   const char *m_input_file;
   const char *m_output_file;
+  bool m_traced {};
 };
 
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include <Common/Compat.h>
+
+#include <AsyncComm/ApplicationQueue.h>
+
+#include <Common/Logger.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const int GROUP_COUNT = 1000;
+  const int GROUP_REQUESTS = 100;
+
+  /// Per-group execution state checked by GroupHandler
+  class GroupCheck {
+  public:
+    atomic<int> next {};
+    atomic<bool> running {};
+  };
+
+  /// Handler checking that requests of a group run one at a time, in order
+  class GroupHandler : public ApplicationHandler {
+  public:
+    GroupHandler(EventPtr &event, GroupCheck &check, int seq,
+                 atomic<int> &done)
+      : ApplicationHandler(event), m_check(check), m_seq(seq), m_done(done) { }
+    void run() override {
+      HT_ASSERT(!m_check.running.exchange(true));
+      HT_ASSERT(m_check.next == m_seq);
+      m_check.next++;
+      m_check.running = false;
+      m_done++;
+    }
+  private:
+    GroupCheck &m_check;
+    int m_seq;
+    atomic<int> &m_done;
+  };
+
+  /// Handler counting executions
+  class CountHandler : public ApplicationHandler {
+  public:
+    CountHandler(atomic<int> &done, bool urgent=false)
+      : ApplicationHandler(urgent), m_done(done) { }
+    void run() override { m_done++; }
+  private:
+    atomic<int> &m_done;
+  };
+
+  void wait_for(atomic<int> &counter, int value) {
+    while (counter < value)
+      this_thread::sleep_for(chrono::milliseconds(1));
+  }
+
+  void test_groups(ApplicationQueue &queue) {
+    vector<GroupCheck> checks(GROUP_COUNT);
+    atomic<int> done {};
+    vector<thread> producers;
+    for (int p=0; p<4; p++) {
+      producers.push_back(thread([&queue, &checks, &done, p]() {
+            for (int seq=0; seq<GROUP_REQUESTS; seq++) {
+              for (int g=p; g<GROUP_COUNT; g+=4) {
+                EventPtr event = make_shared<Event>(Event::MESSAGE);
+                event->group_id = g + 1;
+                queue.add(new GroupHandler(event, checks[g], seq, done));
+              }
+            }
+          }));
+    }
+    for (auto &producer : producers)
+      producer.join();
+    wait_for(done, GROUP_COUNT * GROUP_REQUESTS);
+    for (auto &check : checks)
+      HT_ASSERT(check.next == GROUP_REQUESTS);
+  }
+
+  void test_pause(ApplicationQueue &queue) {
+    atomic<int> normal {};
+    atomic<int> urgent {};
+    queue.stop();
+    queue.add(new CountHandler(normal));
+    queue.add(new CountHandler(urgent, true));
+    wait_for(urgent, 1);
+    this_thread::sleep_for(chrono::milliseconds(50));
+    HT_ASSERT(normal == 0);
+    queue.start();
+    wait_for(normal, 1);
+  }
+
+  /// Handler recording its position in execution order
+  class OrderHandler : public ApplicationHandler {
+  public:
+    OrderHandler(atomic<int> &done, int &position)
+      : m_done(done), m_position(position) { }
+    void run() override { m_position = m_done++; }
+  private:
+    atomic<int> &m_done;
+    int &m_position;
+  };
+
+  void test_low_priority() {
+    ApplicationQueue queue(1);
+    atomic<int> done {};
+    vector<int> positions(21);
+    queue.stop();
+    OrderHandler *low = new OrderHandler(done, positions[0]);
+    low->set_low_priority(true);
+    queue.add(low);
+    for (int i=1; i<21; i++)
+      queue.add(new OrderHandler(done, positions[i]));
+    queue.start();
+    wait_for(done, 21);
+    // Normal requests run in order and the low priority request is not
+    // starved behind all of them
+    for (int i=2; i<21; i++)
+      HT_ASSERT(positions[i] > positions[i-1]);
+    HT_ASSERT(positions[0] < 20);
+    queue.shutdown();
+    queue.join();
+  }
+
+  void test_throughput(ApplicationQueue &queue, int producer_count) {
+    const int count = 1000000;
+    atomic<int> done {};
+    auto start = chrono::steady_clock::now();
+    vector<thread> producers;
+    for (int p=0; p<producer_count; p++) {
+      producers.push_back(thread([&queue, &done, producer_count]() {
+            for (int i=0; i<count/producer_count; i++)
+              queue.add(new CountHandler(done));
+          }));
+    }
+    for (auto &producer : producers)
+      producer.join();
+    wait_for(done, (count/producer_count) * producer_count);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << producer_count << " producers: "
+         << (int64_t)(done / elapsed.count()) << " requests/s" << endl;
+  }
+
+}
+
+int main(int argc, char **argv) {
+  ApplicationQueue queue(8);
+
+  test_groups(queue);
+  test_pause(queue);
+  test_low_priority();
+  for (int producer_count = 1; producer_count <= 8; producer_count *= 2)
+    test_throughput(queue, producer_count);
+
+  HT_ASSERT(queue.wait_for_idle(chrono::steady_clock::now() +
+                                chrono::seconds(10)));
+  HT_ASSERT(queue.backlog() == 0);
+
+  queue.shutdown();
+  queue.join();
+  return 0;
+}
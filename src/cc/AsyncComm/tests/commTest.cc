@@ -41,7 +41,9 @@
 
 #include <chrono>
 #include <cstdlib>
+#include <iostream>
 #include <thread>
+#include <vector>
 
 extern "C" {
 #include <signal.h>
@@ -140,7 +142,7 @@ namespace {
 
 
 int main(int argc, char **argv) {
-  boost::thread  *thread1, *thread2;
+  boost::thread  *thread1, *thread2, *thread3;
   struct sockaddr_in addr;
   ServerLauncher slauncher;
   Comm *comm;
@@ -177,6 +179,13 @@ int main(int argc, char **argv) {
   thread1->join();
   thread2->join();
 
+  // Traced requests carry a variable length header extension
+  thread_func.set_traced(true);
+  thread_func.set_output_file("commTest.output.3");
+  thread3 = new boost::thread(thread_func);
+  thread3->join();
+  thread_func.set_traced(false);
+
 #ifndef _WIN32
   String tmp_file = (String)"/tmp/commTest" + (int)getpid();
   String cmd_str = (String)"head -" + (int)MAX_MESSAGES + " ./words > "
@@ -191,17 +200,46 @@ int main(int argc, char **argv) {
 
   if (system("diff commTest.output.1 commTest.output.2"))
     return 1;
+
+  if (system("diff commTest.output.1 commTest.output.3"))
+    return 1;
+
+  // Request throughput by number of sending threads, without and with
+  // payload checksums
+  thread_func.set_output_file("/dev/null");
+  for (bool checksum : { false, true }) {
+    ReactorFactory::payload_checksum = checksum;
+    for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+      vector<boost::thread *> threads;
+      auto start = chrono::steady_clock::now();
+      for (int i=0; i<thread_count; i++)
+        threads.push_back(new boost::thread(thread_func));
+      for (auto thread : threads) {
+        thread->join();
+        delete thread;
+      }
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      cout << thread_count << " threads, payload checksum "
+           << (checksum ? "on" : "off") << ": "
+           << (int64_t)(thread_count * MAX_MESSAGES / elapsed.count())
+           << " requests/s" << endl;
+    }
+  }
+  ReactorFactory::payload_checksum = false;
 #else 
   if (system("fc commTest.output.1 commTest.golden"))
     return 1;
   if (system("fc commTest.output.1 commTest.output.2"))
     return 1;
+  if (system("fc commTest.output.1 commTest.output.3"))
+    return 1;
 #endif
 
   ReactorFactory::destroy();
 
   delete thread1;
   delete thread2;
+  delete thread3;
 
   return 0;
 }
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <AsyncComm/CommBuf.h>
+#include <AsyncComm/CommHeader.h>
+#include <AsyncComm/Event.h>
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/StaticBuffer.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace Hypertable;
+using namespace Hypertable::Serialization;
+using namespace std;
+
+namespace {
+
+  const char *VALUE = "All work and no play makes jack a dull boy.";
+
+  /// Builds a response as sent by Comm::send_response() and loads it into a
+  /// MESSAGE event as received by the reactor.
+  /// @param flags Header flags of response
+  /// @param with_ext Append an extended buffer to the payload
+  /// @param corrupt_offset Offset of payload byte to flip, -1 for none
+  /// @return Received event
+  EventPtr receive_response(uint16_t flags, bool with_ext,
+                            int corrupt_offset) {
+    CommHeader header(0x1234);
+    header.flags = flags;
+    CommBufPtr cbuf;
+    if (with_ext) {
+      StaticBuffer ext(strlen(VALUE));
+      memcpy(ext.base, VALUE, ext.size);
+      cbuf = make_shared<CommBuf>(header, encoded_length_str16(VALUE), ext);
+    }
+    else
+      cbuf = make_shared<CommBuf>(header, encoded_length_str16(VALUE));
+    cbuf->append_str16(VALUE);
+    cbuf->write_header_and_reset();
+
+    EventPtr event = make_shared<Event>(Event::MESSAGE);
+    event->load_message_header(cbuf->data.base, header.encoded_length());
+    size_t header_len = event->header.header_len;
+    size_t data_len = cbuf->data.size - header_len;
+    size_t payload_len = data_len + cbuf->ext.size;
+    HT_ASSERT(event->header.total_len == header_len + payload_len);
+    uint8_t *payload = new uint8_t [payload_len];
+    memcpy(payload, cbuf->data.base + header_len, data_len);
+    if (cbuf->ext.size)
+      memcpy(payload + data_len, cbuf->ext.base, cbuf->ext.size);
+    if (corrupt_offset >= 0)
+      payload[corrupt_offset] ^= 0x01;
+    event->payload = payload;
+    event->payload_len = payload_len;
+    return event;
+  }
+
+  const uint16_t CHECKSUMMED = CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM |
+    CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM_RESPONSE;
+
+}
+
+
+int main(int argc, char **argv) {
+
+  // Intact response is delivered as MESSAGE
+  EventPtr event = receive_response(CHECKSUMMED, false, -1);
+  HT_ASSERT(event->verify_response_payload_checksum() == Error::OK);
+  HT_ASSERT(event->type == Event::MESSAGE);
+
+  event = receive_response(CHECKSUMMED, true, -1);
+  HT_ASSERT(event->verify_response_payload_checksum() == Error::OK);
+  HT_ASSERT(event->type == Event::MESSAGE);
+
+  // Corrupted response is delivered as ERROR
+  event = receive_response(CHECKSUMMED, false, 5);
+  HT_ASSERT(event->verify_response_payload_checksum() ==
+            Error::COMM_PAYLOAD_CHECKSUM_MISMATCH);
+  HT_ASSERT(event->type == Event::ERROR);
+  HT_ASSERT(event->error == Error::COMM_PAYLOAD_CHECKSUM_MISMATCH);
+
+  // Corruption in the extended buffer is detected too
+  event = receive_response(CHECKSUMMED, true, 2 + strlen(VALUE) + 10);
+  HT_ASSERT(event->verify_response_payload_checksum() ==
+            Error::COMM_PAYLOAD_CHECKSUM_MISMATCH);
+  HT_ASSERT(event->type == Event::ERROR);
+
+  // Response of a peer without checksum support echoes the request flag
+  // without a checksum and is delivered unverified
+  event = receive_response(0, false, -1);
+  event->header.flags |= CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM;
+  HT_ASSERT(event->verify_response_payload_checksum() == Error::OK);
+  HT_ASSERT(event->type == Event::MESSAGE);
+  HT_ASSERT((event->header.flags & CommHeader::FLAGS_BIT_PAYLOAD_CHECKSUM) == 0);
+
+  // Requests are left to the consumer of the event
+  event = receive_response(CHECKSUMMED | CommHeader::FLAGS_BIT_REQUEST,
+                           false, 5);
+  HT_ASSERT(event->verify_response_payload_checksum() == Error::OK);
+  HT_ASSERT(event->type == Event::MESSAGE);
+  HT_ASSERT(event->verify_payload_checksum() ==
+            Error::COMM_PAYLOAD_CHECKSUM_MISMATCH);
+
+  return 0;
+}
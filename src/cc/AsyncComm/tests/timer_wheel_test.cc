@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <AsyncComm/TimerWheel.h>
+
+#include <Common/Logger.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const chrono::milliseconds TICK(10);
+
+  class TestNode : public TimerWheelNode {
+  public:
+    bool expired {};
+  };
+
+  /// Checks that entries spread over all levels of the wheel expire in the
+  /// tick holding their expiration time, in order, and that removed entries
+  /// do not expire.
+  void test_expiration(ClockT::time_point start, int count) {
+    TimerWheel wheel(TICK);
+    vector<unique_ptr<TestNode>> nodes;
+    vector<TimerWheelNode *> expired;
+
+    for (int i=0; i<count; i++) {
+      nodes.push_back(unique_ptr<TestNode>(new TestNode()));
+      // Mostly short timeouts, some spanning higher levels
+      int64_t millis = (i % 10) ? random() % 30000 : random() % 100000000;
+      nodes.back()->expire = start + chrono::milliseconds(millis);
+      wheel.insert(nodes.back().get());
+    }
+    for (int i=0; i<count; i+=7)
+      wheel.remove(nodes[i].get());
+    HT_ASSERT(wheel.size() == (size_t)(count - (count + 6) / 7));
+
+    ClockT::time_point now = start;
+    ClockT::time_point last;
+    while (!wheel.empty()) {
+      ClockT::time_point wakeup = wheel.next_wakeup();
+      HT_ASSERT(wakeup > now);
+      now = wakeup;
+      expired.clear();
+      wheel.advance(now, expired);
+      for (auto node : expired) {
+        TestNode *test_node = static_cast<TestNode *>(node);
+        HT_ASSERT(!test_node->expired);
+        HT_ASSERT(test_node->expire <= now);
+        HT_ASSERT(test_node->expire > now - TICK);
+        HT_ASSERT(last <= test_node->expire);
+        last = test_node->expire;
+        test_node->expired = true;
+      }
+    }
+
+    for (int i=0; i<count; i++)
+      HT_ASSERT(nodes[i]->expired == (i % 7 != 0));
+  }
+
+}
+
+int main(int argc, char **argv) {
+  srandom(1234);
+
+  ClockT::time_point start = ClockT::now();
+  test_expiration(start, 100000);
+
+  // Entries in the past expire on the next advance
+  TimerWheel wheel(TICK);
+  TestNode node;
+  node.expire = start - chrono::seconds(1);
+  wheel.insert(&node);
+  vector<TimerWheelNode *> expired;
+  wheel.advance(ClockT::now(), expired);
+  HT_ASSERT(expired.size() == 1 && expired[0] == &node && wheel.empty());
+
+  // Insert/remove throughput
+  vector<unique_ptr<TestNode>> nodes;
+  for (int i=0; i<1000000; i++) {
+    nodes.push_back(unique_ptr<TestNode>(new TestNode()));
+    nodes.back()->expire = start + chrono::milliseconds(random() % 60000);
+  }
+  auto begin = chrono::steady_clock::now();
+  for (auto &n : nodes)
+    wheel.insert(n.get());
+  for (auto &n : nodes)
+    wheel.remove(n.get());
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+  HT_ASSERT(wheel.empty());
+  cout << (int64_t)(nodes.size() / elapsed.count())
+       << " insert/remove pairs per second" << endl;
+
+  return 0;
+}
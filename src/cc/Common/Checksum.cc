@@ -19,7 +19,7 @@
 
 /** @file
  * Implementation of checksum routines.
- * This file implements the fletcher32 checksum algorithm.
+ * This file implements the fletcher32 and CRC-32C checksum algorithms.
  */
 
 #include "Common/Compat.h"
@@ -27,6 +27,19 @@
 #include <zlib.h>
 #include "Checksum.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define HT_CRC32C_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <nmmintrin.h>
+#define HT_CRC32C_TARGET
+#else
+#include <cpuid.h>
+#include <nmmintrin.h>
+#define HT_CRC32C_TARGET __attribute__((target("sse4.2")))
+#endif
+#endif
+
 namespace Hypertable {
 
 #define HT_F32_DO1(buf,i) \
@@ -83,6 +96,131 @@ fletcher32(const void *data8, size_t len8) {
   return (sum2 << 16) | sum1;
 }
 
+namespace {
+
+  /* Reflected Castagnoli polynomial */
+  const uint32_t CRC32C_POLY = 0x82f63b78;
+
+  struct Crc32cTables {
+    Crc32cTables() {
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++)
+          crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+        table[0][i] = crc;
+      }
+      for (uint32_t i = 0; i < 256; i++)
+        for (int k = 1; k < 8; k++)
+          table[k][i] = (table[k-1][i] >> 8) ^ table[0][table[k-1][i] & 0xff];
+    }
+    uint32_t table[8][256];
+  };
+
+  const Crc32cTables crc32c_tables;
+
+  uint32_t crc32c_sw(uint32_t crc, const uint8_t *data, size_t len) {
+    const uint32_t (*t)[256] = crc32c_tables.table;
+
+    while (len && ((uintptr_t)data & 7)) {
+      crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+      len--;
+    }
+
+    while (len >= 8) {
+      /* assemble little-endian words byte-wise to stay endian neutral */
+      uint32_t lo = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+                           ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+      uint32_t hi = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+                    ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+      crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+            t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+            t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^
+            t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+      data += 8;
+      len -= 8;
+    }
+
+    while (len--)
+      crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+
+    return crc;
+  }
+
+#if defined(HT_CRC32C_X86)
+
+  bool detect_sse42() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 20)) != 0;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+      return false;
+    return (ecx & bit_SSE4_2) != 0;
+#endif
+  }
+
+  HT_CRC32C_TARGET
+  uint32_t crc32c_hw(uint32_t crc, const uint8_t *data, size_t len) {
+
+    while (len && ((uintptr_t)data & 7)) {
+      crc = _mm_crc32_u8(crc, *data++);
+      len--;
+    }
+
+#if defined(_M_X64) || defined(__x86_64__)
+    uint64_t crc64 = crc;
+    while (len >= 8) {
+      crc64 = _mm_crc32_u64(crc64, *(const uint64_t *)data);
+      data += 8;
+      len -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+
+    while (len >= 4) {
+      crc = _mm_crc32_u32(crc, *(const uint32_t *)data);
+      data += 4;
+      len -= 4;
+    }
+
+    while (len--)
+      crc = _mm_crc32_u8(crc, *data++);
+
+    return crc;
+  }
+
+  const bool crc32c_hw_available = detect_sse42();
+
+#else
+
+  const bool crc32c_hw_available = false;
+
+#endif
+
+}
+
+uint32_t crc32c(const void *data, size_t len) {
+  return crc32c_extend(0, data, len);
+}
+
+uint32_t crc32c_extend(uint32_t crc, const void *data, size_t len) {
+#if defined(HT_CRC32C_X86)
+  if (crc32c_hw_available)
+    return ~crc32c_hw(~crc, (const uint8_t *)data, len);
+#endif
+  return ~crc32c_sw(~crc, (const uint8_t *)data, len);
+}
+
+uint32_t crc32c_software(const void *data, size_t len) {
+  return ~crc32c_sw(0xffffffff, (const uint8_t *)data, len);
+}
+
+bool crc32c_hardware_available() {
+  return crc32c_hw_available;
+}
+
 } // namespace Hypertable
 
 /* vim: et sw=2
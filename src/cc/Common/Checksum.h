@@ -19,7 +19,7 @@
 
 /** @file
  * Implementation of checksum routines.
- * This file implements the fletcher32 checksum algorithm.
+ * This file implements the fletcher32 and CRC-32C checksum algorithms.
  */
 
 #ifndef HYPERTABLE_CHECKSUM_H
@@ -41,6 +41,47 @@ namespace Hypertable {
    */
   extern uint32_t fletcher32(const void *data, size_t len);
 
+  /** Compute CRC-32C (Castagnoli) checksum for arbitrary data.
+   * Uses the SSE4.2 <code>crc32</code> instruction when the processor
+   * supports it (detected once at runtime) and falls back to a
+   * slicing-by-8 table driven implementation otherwise.  Both produce
+   * identical results.
+   *
+   * @param data Pointer to the input data
+   * @param len Input data length in bytes
+   * @return The calculated checksum
+   */
+  extern uint32_t crc32c(const void *data, size_t len);
+
+  /** Extend CRC-32C checksum with more data.
+   * Computes the checksum of the concatenation of the data checksummed by
+   * <code>crc</code> and <code>data</code>, so that
+   * <code>crc32c_extend(crc32c(a, n), b, m)</code> equals the crc32c() of
+   * the <code>n</code> bytes at <code>a</code> followed by the
+   * <code>m</code> bytes at <code>b</code>.
+   *
+   * @param crc Checksum of preceding data, 0 for none
+   * @param data Pointer to the input data
+   * @param len Input data length in bytes
+   * @return The calculated checksum
+   */
+  extern uint32_t crc32c_extend(uint32_t crc, const void *data, size_t len);
+
+  /** Compute CRC-32C checksum using the portable implementation only.
+   * This function is exposed for testing and benchmarking.
+   *
+   * @param data Pointer to the input data
+   * @param len Input data length in bytes
+   * @return The calculated checksum
+   */
+  extern uint32_t crc32c_software(const void *data, size_t len);
+
+  /** Checks if CRC-32C is computed in hardware.
+   * @return <i>true</i> if crc32c() uses the SSE4.2 instruction,
+   * <i>false</i> otherwise
+   */
+  extern bool crc32c_hardware_available();
+
   /** @}*/
 
 } // namespace Hypertable
@@ -220,6 +220,11 @@ void DefaultPolicy::init_options() {
     ("Comm.DispatchDelay", i32()->default_value(0), "[TESTING ONLY] "
         "Delay dispatching of read requests by this number of milliseconds")
     ("Comm.UsePoll", boo()->default_value(false), "Use POSIX poll() interface")
+    ("Comm.PayloadChecksum", boo()->default_value(false), "Checksum request "
+        "payloads with CRC-32C and have peers verify them; responses, and "
+        "requests from peers on the same connection, are checksummed too "
+        "(responses are only verified if the peer marks its checksum as "
+        "filled in, since older peers echo the flag without a checksum)")
     ("Hypertable.Cluster.Name", str(),
      "Name of cluster used in Monitoring UI and admin notification messages")
     ("Hypertable.Verbose", boo()->default_value(false),
@@ -244,10 +249,23 @@ void DefaultPolicy::init_options() {
         "Disable publishing of metrics to Ganglia")
     ("Hypertable.Metrics.Ganglia.Port", i16()->default_value(15860),
         "UDP Port on which Hypertable gmond python extension module listens for metrics")
+    ("Hypertable.Metrics.File.Directory", str()->default_value(""),
+        "Directory into which each server writes its metrics, as "
+        "ht.<component>.metrics.json or .txt, whenever it publishes them, so "
+        "that they can be scraped locally without Ganglia (empty to disable)")
+    ("Hypertable.Metrics.File.Format", str()->default_value("json"),
+        "Format of metrics file, json (same object as sent to Ganglia) or "
+        "text (one \"<name> <value>\" line per metric)")
     ("Hypertable.LoadMetrics.Interval", i32()->default_value(3600), "Period of "
         "time, in seconds, between writing metrics to sys/RS_METRICS")
     ("Hypertable.Request.Timeout", i32()->default_value(600000), "Length of "
         "time, in milliseconds, before timing out requests (system wide)")
+    ("Hypertable.Request.Trace.Sampling", i32()->default_value(0), "Trace one "
+        "in every this many client requests, recording the time spent in each "
+        "stage of processing (0 disables tracing)")
+    ("Hypertable.MetaLog.CompactionChunkSize", i32()->default_value(1*M),
+        "Number of bytes of live MetaLog entities copied into the compacted "
+        "log with each group commit while a compaction is in progress")
     ("Hypertable.MetaLog.HistorySize", i32()->default_value(30), "Number "
         "of old MetaLog files to retain for historical purposes")
     ("Hypertable.MetaLog.MaxFileSize", i64()->default_value(100*M), "Maximum "
@@ -351,6 +369,10 @@ void DefaultPolicy::init_options() {
         "log files after this much time")
     ("Hyperspace.LogGc.MaxUnusedLogs", i32()->default_value(200), "Number of unused BerkeleyDB "
         "to keep around in case of lagging replicas")
+    ("Hyperspace.StateDb.Backend", str()->default_value("bdb"), "Store for "
+        "transient session, handle and lock state: 'bdb' (BerkeleyDB, "
+        "replicated) or 'memory' (in-memory, ignored when replicas are "
+        "configured)")
     ("Hyperspace.Replica.Host", strs(), "Hostname of Hyperspace replica")
     ("Hyperspace.Replica.Port", i16()->default_value(15861),
         "Port number on which Hyperspace is or should be listening for requests")
@@ -392,8 +414,22 @@ void DefaultPolicy::init_options() {
     ("Hypertable.LoadBalancer.LoadavgThreshold", f64()->default_value(0.25),
         "Servers with loadavg above this much above the mean will be considered by the "
         "load balancer to be overloaded")
+    ("Hypertable.LoadBalancer.RangeLoad.BytesPerOp", i32()->default_value(64*KiB),
+        "Bytes of read or write traffic counted as one operation when the "
+        "range_load balancer computes range load")
+    ("Hypertable.LoadBalancer.RangeLoad.Threshold", f64()->default_value(0.1),
+        "The range_load balancer stops once the peak server load is within this "
+        "fraction of the mean server load")
+    ("Hypertable.LoadBalancer.RangeLoad.MaxMoves", i32()->default_value(100),
+        "Maximum number of range moves in a range_load balance plan (0 for no limit)")
     ("Hypertable.HqlInterpreter.Mutator.NoLogSync", boo()->default_value(false),
         "Suspends CommitLog sync operation on updates until command completion")
+    ("Hypertable.HqlInterpreter.LoadData.Threads", i32()->default_value(1),
+        "Number of mutator threads LOAD DATA INFILE ... INTO TABLE fans "
+        "cells out to, grouped by destination range.  Uncompressed local "
+        "files are also split at line boundaries and parsed by this many "
+        "threads, so cells of a row that are far apart in such a file may be "
+        "applied out of order (1 parses and applies cells on one thread)")
     ("Hypertable.RangeLocator.MetadataReadaheadCount", i32()->default_value(10),
         "Number of rows that the RangeLocator fetches from the METADATA")
     ("Hypertable.RangeLocator.MaxErrorQueueLength", i32()->default_value(4),
@@ -410,8 +446,24 @@ void DefaultPolicy::init_options() {
     ("Hypertable.Mutator.ScatterBuffer.FlushLimit.Aggregate",
      i64()->default_value(50*M), "Amount of updates (bytes) accumulated for "
         "all servers to trigger a scatter buffer flush")
+    ("Hypertable.Index.Async", boo()->default_value(false),
+        "Maintain secondary indexes asynchronously in the RangeServers "
+        "instead of synchronously in the client mutators (must be set the "
+        "same on all clients and RangeServers)")
     ("Hypertable.Scanner.QueueSize",
      i32()->default_value(5), "Size of Scanner ScanBlock queue")
+    ("Hypertable.Scanner.Planner.CostBased", boo()->default_value(false),
+        "Choose between a secondary index and a filtered table scan by "
+        "estimated cost (if false, an applicable index is always used)")
+    ("Hypertable.Scanner.Planner.IndexLookupCost", i32()->default_value(64*KiB),
+        "Estimated bytes read by the primary table lookup for one matching "
+        "index entry")
+    ("Hypertable.Scanner.Planner.MaxProbeCells", i32()->default_value(100000),
+        "Maximum number of index entries counted when estimating the cost of "
+        "an index scan")
+    ("Hypertable.Scanner.Planner.EstimateTTL", i32()->default_value(300000),
+        "Time in milliseconds a plan chosen from cost estimates is reused by "
+        "scanners created for the same query")
     ("Hypertable.LocationCache.MaxEntries", i64()->default_value(1*M),
         "Size of range location cache in number of entries")
     ("Hypertable.Master.Host", str(),
@@ -424,6 +476,17 @@ void DefaultPolicy::init_options() {
         "Number of Hypertable Master communication reactor threads created")
     ("Hypertable.Master.Gc.Interval", i32()->default_value(300000),
         "Garbage collection interval in milliseconds by Master")
+    ("Hypertable.Master.Gc.FullScanInterval", i32()->default_value(12),
+        "Number of incremental garbage collection passes between full scans "
+        "of the METADATA Files column")
+    ("Hypertable.Master.Gc.TimestampMargin", i32()->default_value(300000),
+        "Incremental garbage collection passes rescan METADATA rows changed "
+        "since this many milliseconds before the previous pass started")
+    ("Hypertable.Master.Gc.DeleteThreads", i32()->default_value(8),
+        "Number of threads removing obsolete CellStore files in parallel")
+    ("Hypertable.Master.Gc.MaxDeletesPerSecond", i32()->default_value(1000),
+        "Maximum rate at which obsolete CellStore files are removed "
+        "(0 for no limit)")
     ("Hypertable.Master.Locations.IncludeMasterHash", boo()->default_value(false),
         "Includes master hash (host:port) in RangeServer location id")
     ("Hypertable.Master.Split.SoftLimitEnabled", boo()->default_value(true),
@@ -493,12 +556,34 @@ void DefaultPolicy::init_options() {
         str()->default_value("snappy"), "Default compressor for cell stores")
     ("Hypertable.RangeServer.CellStore.DefaultBloomFilter",
         str()->default_value("rows"), "Default bloom filter for cell stores")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.SampleSize",
+        i32()->default_value(4*KiB), "Number of leading bytes of a block "
+        "to trial compress when the previous block was incompressible (0 "
+        "disables sampling)")
+    ("Hypertable.RangeServer.CellStore.AdaptiveCompression.Threshold",
+        f64()->default_value(0.9), "Blocks whose sample compresses to more "
+        "than this fraction of its size are stored uncompressed")
+    ("Hypertable.RangeServer.CellStore.Dictionary.TrainingSize",
+        i32()->default_value(2*M), "Amount of data a major compaction "
+        "buffers to train a compression dictionary for codecs given "
+        "--dictionary-size")
+    ("Hypertable.RangeServer.CellStore.WriteBehind.QueueDepth",
+        i32()->default_value(4), "Maximum number of filled blocks queued "
+        "for background compression and append while a cell store is being "
+        "written (0 compresses and appends on the writing thread)")
+    ("Hypertable.RangeServer.CellStore.WriteBehind.MaxOutstandingAppends",
+        i32()->default_value(8), "Maximum number of cell store block appends "
+        "in flight to the filesystem broker")
     ("Hypertable.RangeServer.CellStore.SkipBad",
         boo()->default_value(false), "Skip over cell stores that are corrupt")
     ("Hypertable.RangeServer.CellStore.SkipNotFound",
         boo()->default_value(false), "Skip over cell stores that are non-existent")
     ("Hypertable.RangeServer.IgnoreClockSkewErrors",
         boo()->default_value(false), "Ignore clock skew errors")
+    ("Hypertable.RangeServer.BlockChecksum.CRC32C",
+        boo()->default_value(false), "Checksum newly written CellStore and "
+        "commit log blocks with CRC-32C (hardware accelerated when available) "
+        "instead of fletcher32.  Enable only once all servers understand it")
     ("Hypertable.RangeServer.CommitInterval", i32()->default_value(50),
      "Default minimum group commit interval in milliseconds")
     ("Hypertable.RangeServer.BlockCache.Compressed", boo()->default_value(true),
@@ -511,6 +596,16 @@ void DefaultPolicy::init_options() {
      boo()->default_value(true), "Enable query cache mutex statistics")
     ("Hypertable.RangeServer.QueryCache.MaxMemory", i64()->default_value(50*M),
         "Maximum size of query cache")
+    ("Hypertable.RangeServer.Index.Async.FlushSize", i64()->default_value(4*M),
+        "Amount of buffered asynchronous index updates (bytes) that triggers "
+        "a flush")
+    ("Hypertable.RangeServer.Index.Async.FlushInterval",
+     i32()->default_value(1000), "Maximum time (milliseconds) asynchronous "
+        "index updates stay buffered")
+    ("Hypertable.RangeServer.Index.Async.MaxMemory", i64()->default_value(64*M),
+        "Amount of buffered asynchronous index updates (bytes) above which "
+        "updates to indexed tables are rejected as RANGESERVER_OVERLOADED "
+        "and retried by the client")
     ("Hypertable.RangeServer.Range.RowSize.Unlimited", boo()->default_value(false),
      "Marks range active and unsplittable upon encountering row overflow condition. "
      "Can cause ranges to grow extremely large.  Use with caution!")
@@ -525,6 +620,12 @@ void DefaultPolicy::init_options() {
         "range in bytes before splitting (for testing)")
     ("Hypertable.RangeServer.Range.SplitOff", str()->default_value("high"),
         "Portion of range to split off (high or low)")
+    ("Hypertable.RangeServer.Range.HotSplit.Rate", i32()->default_value(0),
+        "Split a range, at the median of its sampled row accesses, once its "
+        "update plus scan rate (per second) reaches this value (0 disables)")
+    ("Hypertable.RangeServer.Range.HotSplit.MinimumSize",
+        i64()->default_value(64*MiB), "Minimum size of range in bytes before "
+        "it is split because of its access rate")
     ("Hypertable.RangeServer.ClockSkew.Max", i32()->default_value(3*M),
         "Maximum amount of clock skew (microseconds) the system will tolerate")
     ("Hypertable.RangeServer.CommitLog.DfsBroker.Host", str(),
@@ -552,7 +653,8 @@ void DefaultPolicy::init_options() {
         "Roll commit log after this many bytes")
     ("Hypertable.RangeServer.CommitLog.Compressor",
         str()->default_value("quicklz"),
-       "Commit log compressor to use (zlib, lzo, quicklz, snappy, bmz, none)")
+       "Commit log compressor to use (zlib, lzo, quicklz, snappy, zstd, bmz, "
+       "none)")
     ("Hypertable.RangeServer.Testing.MaintenanceNeeded.PauseInterval", i32()->default_value(0),
         "TESTING:  After update, if range needs maintenance, pause for this number of milliseconds")
     ("Hypertable.RangeServer.UpdateCoalesceLimit", i64()->default_value(5*M),
@@ -570,13 +672,17 @@ void DefaultPolicy::init_options() {
     ("Hypertable.CommitLog.RollLimit", i64()->default_value(100*M),
         "Roll commit log after this many bytes")
     ("Hypertable.CommitLog.Compressor", str()->default_value("quicklz"),
-        "Commit log compressor to use (zlib, lzo, quicklz, snappy, bmz, none)")
+        "Commit log compressor to use (zlib, lzo, quicklz, snappy, zstd, bmz, "
+       "none)")
     ("Hypertable.CommitLog.SkipErrors", boo()->default_value(false),
         "Skip over any corruption encountered in the commit log")
     ("Hypertable.RangeServer.Scanner.Ttl", i32()->default_value(1800*K),
         "Number of milliseconds of inactivity before destroying scanners")
     ("Hypertable.RangeServer.Scanner.BufferSize", i64()->default_value(1*M),
         "Size of transfer buffer for scan results")
+    ("Hypertable.RangeServer.Scanner.PrefetchBlocks", i32()->default_value(1),
+        "Number of scan result blocks filled ahead of the client's next fetch "
+        "request (0 disables prefetching)")
     ("Hypertable.RangeServer.Timer.Interval", i32()->default_value(20000),
         "Timer interval in milliseconds (reaping scanners, purging commit logs, etc.)")
     ("Hypertable.RangeServer.Maintenance.Interval", i32()->default_value(30000),
@@ -597,6 +703,22 @@ void DefaultPolicy::init_options() {
         "Comma-separated list of directory mount points of disk volumes to monitor")
     ("Hypertable.RangeServer.Workers", i32()->default_value(50),
         "Number of Range Server worker threads created")
+    ("Hypertable.RangeServer.Admission.Enable", boo()->default_value(true),
+        "Reject requests with RANGESERVER_OVERLOADED when the admission limits "
+        "of their class are reached")
+    ("Hypertable.RangeServer.Admission.MaxRequests.Read", i32()->default_value(1000),
+        "Maximum number of queued or running create scanner requests on "
+        "non-system tables (0 for no limit)")
+    ("Hypertable.RangeServer.Admission.MaxRequests.Update", i32()->default_value(1000),
+        "Maximum number of queued or running update requests on non-system "
+        "tables (0 for no limit)")
+    ("Hypertable.RangeServer.Admission.MaxBytes.Update", i64()->default_value(256*M),
+        "Maximum payload bytes of update requests on non-system tables that "
+        "are queued, running or waiting to be committed (0 for no limit)")
+    ("Hypertable.RangeServer.Profile.Enable", boo()->default_value(false),
+        "Run the CPU sampling profiler from startup")
+    ("Hypertable.RangeServer.Profile.Frequency", i32()->default_value(99),
+        "CPU profiler samples per second of CPU time (at most 1000)")
     ("Hypertable.RangeServer.Reactors", i32(),
         "Number of Range Server communication reactor threads created")
     ("Hypertable.RangeServer.MaintenanceThreads", i32(),
@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for CpuProfiler.
+/// This file contains definitions for CpuProfiler, an in-process sampling
+/// CPU profiler that writes folded stacks for flame graphs.
+
+#include <Common/Compat.h>
+
+#include "CpuProfiler.h"
+
+#include <Common/Error.h>
+
+#include <ostream>
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+}
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Number of sample slots of a buffer, holds one second of samples of
+  /// eight threads at the maximum frequency
+  const size_t BUFFER_SAMPLES = 8 * CpuProfiler::MAX_FREQUENCY;
+
+  /// Frames captured in signal handler belonging to handler and signal
+  /// trampoline
+  const int SKIP_FRAMES = 2;
+
+  /// Captured stack
+  struct Sample {
+    /// Set once stack is written, cleared once counted
+    atomic<bool> ready {};
+    /// Number of frames in <code>pcs</code>
+    int depth {};
+    /// Program counters, innermost frame first
+    void *pcs[CpuProfiler::MAX_DEPTH + SKIP_FRAMES];
+  };
+
+  /// Sample buffer
+  struct Buffer {
+    /// Index of next free slot
+    atomic<size_t> next {};
+    /// Number of samples dropped because buffer was full
+    atomic<uint64_t> dropped {};
+    Sample samples[BUFFER_SAMPLES];
+  };
+
+  /// Hash function of stacks
+  struct StackHash {
+    size_t operator()(const vector<void *> &stack) const {
+      size_t h = 0;
+      for (void *pc : stack)
+        h = (h ^ (size_t)pc) * 0x100000001b3ULL;
+      return h;
+    }
+  };
+
+  typedef unordered_map<vector<void *>, uint64_t, StackHash> StackCountMap;
+
+  /// Profiler state.  Allocated on the heap and never freed since a signal
+  /// may still be delivered while the process exits.
+  struct State {
+    /// Serializes start(), stop() and write()
+    std::mutex control_mutex;
+    /// Protects stacks, samples, dropped and stop_drain
+    std::mutex mutex;
+    condition_variable cond;
+    /// Double buffer, signal handler writes into active one
+    Buffer *buffers[2] {};
+    atomic<Buffer *> active {};
+    /// Number of signal handlers writing into a buffer
+    atomic<int> writers {};
+    atomic<bool> running {};
+    bool stop_drain {};
+    thread drain_thread;
+    StackCountMap stacks;
+    uint64_t samples {};
+    uint64_t dropped {};
+  };
+
+  State *state() {
+    static State *state = new State();
+    return state;
+  }
+
+  void prof_handler(int, siginfo_t *, void *) {
+    int saved_errno = errno;
+    State *st = state();
+    st->writers.fetch_add(1);
+    Buffer *buffer = st->active.load();
+    if (buffer) {
+      size_t index = buffer->next.fetch_add(1, memory_order_relaxed);
+      if (index < BUFFER_SAMPLES) {
+        Sample &sample = buffer->samples[index];
+        sample.depth = backtrace(sample.pcs,
+                                 CpuProfiler::MAX_DEPTH + SKIP_FRAMES);
+        sample.ready.store(true, memory_order_release);
+      }
+      else
+        buffer->dropped.fetch_add(1, memory_order_relaxed);
+    }
+    st->writers.fetch_sub(1);
+    errno = saved_errno;
+  }
+
+  /// Counts stacks of a buffer no signal handler writes into.  Must be
+  /// called with <code>st->mutex</code> locked.
+  void count_samples(State *st, Buffer *buffer) {
+    size_t count = std::min(buffer->next.load(), BUFFER_SAMPLES);
+    vector<void *> stack;
+    for (size_t i=0; i<count; i++) {
+      Sample &sample = buffer->samples[i];
+      if (!sample.ready.load(memory_order_acquire))
+        continue;
+      stack.clear();
+      for (int j=SKIP_FRAMES; j<sample.depth; j++)
+        stack.push_back(sample.pcs[j]);
+      sample.ready.store(false, memory_order_relaxed);
+      // Stacks beyond the limit are counted as the empty stack
+      if (st->stacks.size() >= CpuProfiler::MAX_STACKS &&
+          st->stacks.count(stack) == 0)
+        stack.clear();
+      st->stacks[stack]++;
+      st->samples++;
+    }
+    st->dropped += buffer->dropped.exchange(0);
+    buffer->next = 0;
+  }
+
+  /// Switches signal handler to other buffer and counts stacks of the
+  /// previously active one.  Must be called with <code>st->mutex</code>
+  /// locked.
+  void drain(State *st) {
+    Buffer *buffer = st->active.load();
+    if (buffer == nullptr)
+      return;
+    st->active = (buffer == st->buffers[0]) ? st->buffers[1] : st->buffers[0];
+    // Handlers increment writers before loading the active buffer, so once
+    // writers drops to 0 none is left writing into the old one
+    while (st->writers.load() > 0)
+      this_thread::yield();
+    count_samples(st, buffer);
+  }
+
+  void drain_loop(State *st) {
+    unique_lock<std::mutex> lock(st->mutex);
+    while (!st->stop_drain) {
+      st->cond.wait_for(lock, chrono::seconds(1));
+      drain(st);
+    }
+  }
+
+  /// Returns folded stack frame name of program counter
+  string frame_name(void *pc) {
+    Dl_info info;
+    char buf[64];
+    if (dladdr(pc, &info) == 0 || info.dli_fname == nullptr) {
+      snprintf(buf, sizeof(buf), "%p", pc);
+      return buf;
+    }
+    if (info.dli_sname) {
+      int status = 0;
+      char *demangled = abi::__cxa_demangle(info.dli_sname, 0, 0, &status);
+      string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+      free(demangled);
+      // Semicolons separate frames in folded stacks
+      for (auto &c : name)
+        if (c == ';')
+          c = ':';
+      return name;
+    }
+    const char *module = strrchr(info.dli_fname, '/');
+    module = module ? module + 1 : info.dli_fname;
+    snprintf(buf, sizeof(buf), "+0x%lx",
+             (unsigned long)((char *)pc - (char *)info.dli_fbase));
+    return string(module) + buf;
+  }
+
+  void set_timer(int frequency) {
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    if (frequency) {
+      timer.it_interval.tv_usec = 1000000 / frequency;
+      if (timer.it_interval.tv_usec == 1000000) {
+        timer.it_interval.tv_sec = 1;
+        timer.it_interval.tv_usec = 0;
+      }
+      timer.it_value = timer.it_interval;
+    }
+    setitimer(ITIMER_PROF, &timer, 0);
+  }
+
+}
+
+void CpuProfiler::start(int frequency) {
+  State *st = state();
+  lock_guard<std::mutex> control_lock(st->control_mutex);
+
+  if (st->running)
+    HT_THROW(Error::INVALID_OPERATION, "CPU profiler already running");
+
+  if (frequency < 1 || frequency > MAX_FREQUENCY)
+    HT_THROWF(Error::INVALID_ARGUMENT, "Invalid CPU profiler frequency %d, "
+              "must be between 1 and %d", frequency, MAX_FREQUENCY);
+
+  if (st->buffers[0] == nullptr) {
+    st->buffers[0] = new Buffer();
+    st->buffers[1] = new Buffer();
+  }
+
+  // The first call of backtrace() loads the unwinder, which is not safe in
+  // a signal handler
+  void *pcs[4];
+  backtrace(pcs, 4);
+
+  {
+    lock_guard<std::mutex> lock(st->mutex);
+    st->stacks.clear();
+    st->samples = 0;
+    st->dropped = 0;
+    st->stop_drain = false;
+    st->active = st->buffers[0];
+  }
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_sigaction = prof_handler;
+  action.sa_flags = SA_RESTART | SA_SIGINFO;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, 0) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "sigaction(SIGPROF) failed - %s",
+              strerror(errno));
+
+  st->drain_thread = thread(drain_loop, st);
+  st->running = true;
+  set_timer(frequency);
+}
+
+void CpuProfiler::stop() {
+  State *st = state();
+  lock_guard<std::mutex> control_lock(st->control_mutex);
+
+  if (!st->running)
+    return;
+
+  set_timer(0);
+  {
+    lock_guard<std::mutex> lock(st->mutex);
+    st->stop_drain = true;
+    st->cond.notify_all();
+  }
+  st->drain_thread.join();
+
+  {
+    lock_guard<std::mutex> lock(st->mutex);
+    // Signals still pending are taken without a buffer to write into
+    st->active = nullptr;
+    while (st->writers.load() > 0)
+      this_thread::yield();
+    count_samples(st, st->buffers[0]);
+    count_samples(st, st->buffers[1]);
+  }
+
+  // The handler stays installed: a SIGPROF generated before the timer was
+  // disarmed may still be delivered, and the default action would
+  // terminate the process.  Without an active buffer the handler does
+  // nothing.
+  st->running = false;
+}
+
+bool CpuProfiler::running() {
+  return state()->running;
+}
+
+void CpuProfiler::write(ostream &out) {
+  State *st = state();
+  lock_guard<std::mutex> control_lock(st->control_mutex);
+  StackCountMap stacks;
+  {
+    lock_guard<std::mutex> lock(st->mutex);
+    drain(st);
+    stacks = st->stacks;
+  }
+  // Stacks differing only in program counters within the same functions
+  // fold into the same line
+  unordered_map<void *, string> names;
+  unordered_map<string, uint64_t> folded;
+  string line;
+  for (auto &entry : stacks) {
+    line.clear();
+    if (entry.first.empty())
+      line = "[other]";
+    // Outermost frame first
+    for (auto iter = entry.first.rbegin(); iter != entry.first.rend(); ++iter) {
+      if (!line.empty())
+        line += ";";
+      // Return addresses point past the call, look up the call instead
+      void *pc = *iter;
+      if (iter + 1 != entry.first.rend())
+        pc = (char *)pc - 1;
+      auto name_iter = names.find(pc);
+      if (name_iter == names.end())
+        name_iter = names.insert(make_pair(pc, frame_name(pc))).first;
+      line += name_iter->second;
+    }
+    folded[line] += entry.second;
+  }
+  for (auto &entry : folded)
+    out << entry.first << " " << entry.second << "\n";
+  out.flush();
+}
+
+void CpuProfiler::get_counts(uint64_t *samples, uint64_t *dropped) {
+  State *st = state();
+  lock_guard<std::mutex> lock(st->mutex);
+  *samples = st->samples;
+  *dropped = st->dropped;
+}
+
+#else
+
+using namespace Hypertable;
+
+void CpuProfiler::start(int frequency) {
+  HT_THROW(Error::NOT_IMPLEMENTED, "CPU profiler not supported on this "
+           "platform");
+}
+
+void CpuProfiler::stop() { }
+
+bool CpuProfiler::running() { return false; }
+
+void CpuProfiler::write(std::ostream &out) { }
+
+void CpuProfiler::get_counts(uint64_t *samples, uint64_t *dropped) {
+  *samples = *dropped = 0;
+}
+
+#endif
@@ -0,0 +1,114 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for CpuProfiler.
+/// This file contains declarations for CpuProfiler, an in-process sampling
+/// CPU profiler that writes folded stacks for flame graphs.
+
+#ifndef Common_CpuProfiler_h
+#define Common_CpuProfiler_h
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /// In-process sampling CPU profiler.
+  /// While running, the process receives <code>SIGPROF</code> from an
+  /// <code>ITIMER_PROF</code> interval timer, which counts CPU time of all
+  /// threads, so samples are taken from threads in proportion to the CPU they
+  /// consume and idle threads cost nothing.  The signal handler captures the
+  /// stack of the interrupted thread into a preallocated sample buffer,
+  /// claiming a slot with an atomic increment, so it neither locks nor
+  /// allocates.  A background thread drains the buffer once a second and
+  /// counts distinct stacks, so the profiler can be left running.  Overhead
+  /// is bounded: the sampling frequency is capped at #MAX_FREQUENCY per
+  /// second of CPU time, stacks are cut at #MAX_DEPTH frames, and samples
+  /// arriving while the buffer is full are dropped and counted.  The kernel
+  /// may round the timer interval up to its clock tick, which lowers the
+  /// effective frequency.
+  ///
+  /// write() symbolizes the stacks counted so far and writes them in the
+  /// folded format read by flame graph tools, one line per distinct stack:
+  /// <pre>
+  /// main;Worker::run;FillScanBlock;MergeScanner::forward 42
+  /// </pre>
+  /// Frames that have no dynamic symbol, such as static functions of
+  /// executables not linked with <code>-rdynamic</code>, are written as
+  /// <code>&lt;module&gt;+0x&lt;offset&gt;</code>, for symbolization with
+  /// <code>addr2line</code>.  Only supported on Linux.
+  class CpuProfiler {
+  public:
+
+    /// Default sampling frequency, off the common timer frequencies
+    static const int DEFAULT_FREQUENCY = 99;
+
+    /// Maximum sampling frequency
+    static const int MAX_FREQUENCY = 1000;
+
+    /// Maximum number of frames of a stack
+    static const size_t MAX_DEPTH = 64;
+
+    /// Maximum number of distinct stacks counted, samples of further stacks
+    /// are written as one <code>[other]</code> stack
+    static const size_t MAX_STACKS = 100000;
+
+    /// Starts profiling.
+    /// Clears stacks counted by a previous run.
+    /// @param frequency Samples per second of CPU time, between 1 and
+    /// #MAX_FREQUENCY
+    /// @throws Exception with code set to Error::INVALID_OPERATION if the
+    /// profiler is already running, Error::INVALID_ARGUMENT if
+    /// <code>frequency</code> is out of range, or Error::NOT_IMPLEMENTED if
+    /// the platform is not supported
+    static void start(int frequency=DEFAULT_FREQUENCY);
+
+    /// Stops profiling.
+    /// Stacks counted remain available to write() until the next start().
+    /// Does nothing if the profiler is not running.
+    static void stop();
+
+    /// Checks if profiler is running.
+    /// @return <i>true</i> if profiler is running, <i>false</i> otherwise
+    static bool running();
+
+    /// Writes folded stacks.
+    /// Writes the stacks counted since start(), including samples still in
+    /// the sample buffer.
+    /// @param out Output stream
+    static void write(std::ostream &out);
+
+    /// Returns sample counts.
+    /// @param samples Address of variable to hold number of samples counted
+    /// @param dropped Address of variable to hold number of samples dropped
+    static void get_counts(uint64_t *samples, uint64_t *dropped);
+  };
+
+  /// @}
+
+}
+
+#endif // Common_CpuProfiler_h
@@ -290,6 +290,8 @@ namespace {
       "RANGE SERVER server in readonly mode"},
     { Error::RANGESERVER_RANGE_NOT_YET_RELINQUISHED,
       "RANGE SERVER range not yet relinquished"},
+    { Error::RANGESERVER_OVERLOADED,
+      "RANGE SERVER overloaded, request not admitted"},
     { Error::HQL_BAD_LOAD_FILE_FORMAT,         "HQL bad load file format" },
     { Error::HQL_BAD_COMMAND, "HQL bad command" },
     { Error::METALOG_VERSION_MISMATCH, "METALOG version mismatch" },
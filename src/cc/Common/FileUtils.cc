@@ -42,6 +42,7 @@ extern "C" {
 #include <sys/uio.h>
 }
 
+#include <boost/filesystem.hpp>
 #include <boost/shared_array.hpp>
 #include <boost/shared_ptr.hpp>
 
@@ -781,3 +782,13 @@ bool FileUtils::expand_tilde(String&) {
 
 #endif
 
+bool FileUtils::rmdirs(const String &dirname) {
+  boost::system::error_code ec;
+  boost::filesystem::remove_all(dirname, ec);
+  if (ec) {
+    HT_ERRORF("Problem removing directory '%s' - %s", dirname.c_str(),
+              ec.message().c_str());
+    return false;
+  }
+  return true;
+}
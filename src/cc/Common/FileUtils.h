@@ -237,6 +237,13 @@ namespace Hypertable {
      */
     static bool unlink(const String &fname);
 
+    /** Removes a directory and all of its contents
+     *
+     * @param dirname The directory name
+     * @return true on success, otherwise false
+     */
+    static bool rmdirs(const String &dirname);
+
     /** Renames a file or directory
      *
      * @param oldpath The path of the file (or directory) to rename
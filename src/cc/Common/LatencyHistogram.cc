@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for LatencyHistogram.
+/// This file contains definitions for LatencyHistogram, a lock-free
+/// histogram of latency samples with bounded relative error.
+
+#include <Common/Compat.h>
+
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Next shard to assign to a thread
+  atomic<size_t> next_shard;
+
+  /// Shard of calling thread, SHARDS if not yet assigned
+  thread_local size_t thread_shard = LatencyHistogram::SHARDS;
+
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot &other) {
+  for (size_t i=0; i<BUCKETS; i++)
+    counts[i] += other.counts[i];
+  count += other.count;
+  sum += other.sum;
+  max = std::max(max, other.max);
+}
+
+int64_t LatencyHistogram::Snapshot::percentile(double percentile) const {
+  if (count == 0)
+    return 0;
+  uint64_t rank = (uint64_t)ceil((percentile / 100.0) * count);
+  if (rank == 0)
+    rank = 1;
+  uint64_t seen = 0;
+  for (size_t i=0; i<BUCKETS; i++) {
+    seen += counts[i];
+    if (seen >= rank)
+      return std::min(bucket_upper_bound(i), max);
+  }
+  return max;
+}
+
+void LatencyHistogram::collect(Snapshot &snapshot, bool reset) {
+  for (auto &shard : m_shards) {
+    for (size_t i=0; i<BUCKETS; i++) {
+      uint64_t count = reset ? shard.counts[i].exchange(0) : shard.counts[i].load();
+      snapshot.counts[i] += count;
+      snapshot.count += count;
+    }
+    snapshot.sum += reset ? shard.sum.exchange(0) : shard.sum.load();
+    snapshot.max = std::max(snapshot.max,
+                            reset ? shard.max.exchange(0) : shard.max.load());
+  }
+}
+
+int64_t LatencyHistogram::bucket_upper_bound(size_t bucket) {
+  if (bucket < (1 << SUB_BUCKET_BITS))
+    return (int64_t)bucket;
+  size_t offset = bucket - (1 << SUB_BUCKET_BITS);
+  int shift = (int)(offset / (1 << (SUB_BUCKET_BITS - 1))) + 1;
+  int64_t sub_bucket = (int64_t)(offset % (1 << (SUB_BUCKET_BITS - 1))) +
+    (1 << (SUB_BUCKET_BITS - 1));
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+size_t LatencyHistogram::shard_index() {
+  if (thread_shard == SHARDS)
+    thread_shard = next_shard.fetch_add(1, memory_order_relaxed) % SHARDS;
+  return thread_shard;
+}
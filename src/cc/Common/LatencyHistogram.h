@@ -0,0 +1,176 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for LatencyHistogram.
+/// This file contains declarations for LatencyHistogram, a lock-free
+/// histogram of latency samples with bounded relative error.
+
+#ifndef Common_LatencyHistogram_h
+#define Common_LatencyHistogram_h
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /// Histogram of latency samples.
+  /// Samples are counted in log-linear buckets, as in an HDR histogram: the
+  /// values below 2<sup>#SUB_BUCKET_BITS</sup> have a bucket each, and every
+  /// power-of-two range above that is split into
+  /// 2<sup>#SUB_BUCKET_BITS-1</sup> equal buckets, so a percentile is
+  /// reported with a relative error below
+  /// 1/2<sup>#SUB_BUCKET_BITS-1</sup>.  Recording a sample takes no lock:
+  /// the histogram is split into #SHARDS shards of atomic counters and each
+  /// thread records into the shard it was assigned on first use, so threads
+  /// rarely share a cache line.  The shards are merged into a Snapshot when
+  /// the histogram is collected.
+  class LatencyHistogram {
+  public:
+
+    /// Number of bits of precision of buckets
+    static const int SUB_BUCKET_BITS = 4;
+
+    /// Number of bits of largest sample, larger samples are clamped
+    static const int VALUE_BITS = 40;
+
+    /// Largest sample
+    static const int64_t MAX_VALUE = ((int64_t)1 << VALUE_BITS) - 1;
+
+    /// Number of buckets
+    static const size_t BUCKETS = (1 << SUB_BUCKET_BITS) +
+      (VALUE_BITS - SUB_BUCKET_BITS) * (1 << (SUB_BUCKET_BITS - 1));
+
+    /// Number of shards
+    static const size_t SHARDS = 8;
+
+    /// Merged bucket counts.
+    class Snapshot {
+    public:
+
+      /// Adds counts of another snapshot.
+      /// @param other Snapshot to add
+      void merge(const Snapshot &other);
+
+      /// Returns approximate percentile of samples.
+      /// @param percentile Percentile, between 0 and 100
+      /// @return Upper bound of bucket containing <code>percentile</code>,
+      /// at most #max, 0 if there are no samples
+      int64_t percentile(double percentile) const;
+
+      /// Returns mean of samples.
+      /// @return Mean of samples, 0 if there are no samples
+      double mean() const { return count ? (double)sum / count : 0.0; }
+
+      /// Bucket counts
+      std::array<uint64_t, BUCKETS> counts {};
+
+      /// Number of samples
+      uint64_t count {};
+
+      /// Sum of samples
+      int64_t sum {};
+
+      /// Largest sample
+      int64_t max {};
+    };
+
+    /// Adds a sample.
+    /// @param value Sample, negative samples are counted as 0
+    void record(int64_t value) {
+      Shard &shard = m_shards[shard_index()];
+      if (value < 0)
+        value = 0;
+      else if (value > MAX_VALUE)
+        value = MAX_VALUE;
+      shard.counts[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+      shard.sum.fetch_add(value, std::memory_order_relaxed);
+      int64_t old_max = shard.max.load(std::memory_order_relaxed);
+      while (value > old_max &&
+             !shard.max.compare_exchange_weak(old_max, value,
+                                              std::memory_order_relaxed))
+        ;
+    }
+
+    /// Merges shards into a snapshot.
+    /// Samples recorded while collecting may or may not be included, but are
+    /// not lost when the histogram is reset.
+    /// @param snapshot Snapshot to which shard counts are added
+    /// @param reset If <i>true</i>, clears the histogram
+    void collect(Snapshot &snapshot, bool reset=true);
+
+    /// Returns bucket of a sample.
+    /// @param value Sample between 0 and #MAX_VALUE
+    /// @return Bucket index
+    static size_t bucket(int64_t value) {
+      if (value < (1 << SUB_BUCKET_BITS))
+        return (size_t)value;
+      int shift = msb(value) - (SUB_BUCKET_BITS - 1);
+      return (1 << SUB_BUCKET_BITS) +
+        (shift - 1) * (1 << (SUB_BUCKET_BITS - 1)) +
+        (size_t)((value >> shift) - (1 << (SUB_BUCKET_BITS - 1)));
+    }
+
+    /// Returns largest sample counted in a bucket.
+    /// @param bucket Bucket index
+    /// @return Upper bound of <code>bucket</code>
+    static int64_t bucket_upper_bound(size_t bucket);
+
+  private:
+
+    /// Returns index of most significant bit.
+    static int msb(int64_t value) {
+#if defined(__GNUC__)
+      return 63 - __builtin_clzll((unsigned long long)value);
+#else
+      int bit = 0;
+      while (value >>= 1)
+        bit++;
+      return bit;
+#endif
+    }
+
+    /// Returns shard of calling thread.
+    static size_t shard_index();
+
+    /// Counters of a shard.  The padding keeps the hot counters of adjacent
+    /// shards off the same cache line.
+    struct Shard {
+      std::array<std::atomic<uint64_t>, BUCKETS> counts {};
+      std::atomic<int64_t> sum {};
+      std::atomic<int64_t> max {};
+      char padding[64];
+    };
+
+    /// Shards
+    std::array<Shard, SHARDS> m_shards;
+  };
+
+  /// @}
+
+}
+
+#endif // Common_LatencyHistogram_h
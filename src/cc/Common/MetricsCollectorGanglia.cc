@@ -47,7 +47,11 @@ extern "C" {
 #include <arpa/inet.h>
 }
 
+#include <algorithm>
 #include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <vector>
 
 using namespace Hypertable;
 using namespace std;
@@ -62,6 +66,19 @@ MetricsCollectorGanglia::MetricsCollectorGanglia(const string &component,
 
   m_prefix = "ht." + component + ".";
 
+  string dir = props->get_str("Hypertable.Metrics.File.Directory");
+  if (!dir.empty()) {
+    string format = props->get_str("Hypertable.Metrics.File.Format");
+    if (format == "text")
+      m_file_text = true;
+    else if (format != "json")
+      HT_THROWF(Error::CONFIG_BAD_VALUE,
+                "Invalid value for Hypertable.Metrics.File.Format: %s",
+                format.c_str());
+    m_file = dir + "/ht." + component + ".metrics" +
+      (m_file_text ? ".txt" : ".json");
+  }
+
   if ((m_sd = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
     HT_FATALF("socket(AF_INET, SOCK_DGRAM, 0) failure - %s", strerror(errno));
 
@@ -115,12 +132,9 @@ void MetricsCollectorGanglia::update(const std::string &name, double value) {
 void MetricsCollectorGanglia::publish() {
   lock_guard<mutex> lock(m_mutex);
 
-  if (m_disabled)
+  if (m_disabled && m_file.empty())
     return;
 
-  if (!m_connected)
-    this->connect();
-
   bool first = true;
   char cbuf[64];
 
@@ -168,11 +182,51 @@ void MetricsCollectorGanglia::publish() {
 
   m_message.append(" }");
 
+  if (!m_file.empty())
+    write_file();
+
+  if (m_disabled)
+    return;
+
+  if (!m_connected)
+    this->connect();
+
   if (::send(m_sd, m_message.c_str(), m_message.length(), 0) < 0)
     HT_THROW(Error::COMM_SEND_ERROR, strerror(errno));
 
 }
 
+void MetricsCollectorGanglia::write_file() {
+  string tmp_file = m_file + ".tmp";
+  {
+    ofstream out(tmp_file, ios::trunc);
+    if (m_file_text) {
+      char cbuf[64];
+      vector<string> lines;
+      for (auto & entry : m_values_string)
+        lines.push_back(entry.first + " " + entry.second);
+      for (auto & entry : m_values_int) {
+        sprintf(cbuf, " %d", entry.second);
+        lines.push_back(entry.first + cbuf);
+      }
+      for (auto & entry : m_values_double) {
+        sprintf(cbuf, " %f", entry.second);
+        lines.push_back(entry.first + cbuf);
+      }
+      sort(lines.begin(), lines.end());
+      for (auto & line : lines)
+        out << line << "\n";
+    }
+    else
+      out << m_message << "\n";
+    if (!out)
+      HT_THROWF(Error::LOCAL_IO_ERROR, "Problem writing %s", tmp_file.c_str());
+  }
+  if (rename(tmp_file.c_str(), m_file.c_str()) < 0)
+    HT_THROWF(Error::LOCAL_IO_ERROR, "rename(%s, %s) failure - %s",
+              tmp_file.c_str(), m_file.c_str(), strerror(errno));
+}
+
 void MetricsCollectorGanglia::connect() {
   InetAddr addr("localhost", m_port);
   if (::connect(m_sd, (struct sockaddr *) &addr, sizeof(sockaddr_in)) < 0) {
@@ -23,7 +23,7 @@
 /// Declarations for MetricsCollectorGanglia.
 /// This file contains type declarations for MetricsCollectorGanglia, a simple class for
 /// aggregating metrics and sending them to the Ganglia gmond process running on
-/// localhost.
+/// localhost and, optionally, writing them to a local file.
 
 #ifndef Common_MetricsCollectorGanglia_h
 #define Common_MetricsCollectorGanglia_h
@@ -42,13 +42,21 @@ namespace Hypertable {
   /// @{
 
   /// Ganglia metrics collector.
+  /// If <code>Hypertable.Metrics.File.Directory</code> is set, published
+  /// metrics are also written to a file in that directory, which is replaced
+  /// atomically on each publish() so that a scraper never reads a partial
+  /// file.  The file is written even if publishing to Ganglia is disabled.
   class MetricsCollectorGanglia : public MetricsCollector {
   public:
 
     /// Constructor.
     /// Creates a datagram send socket and binds it to an arbitrary interface
     /// and ephemeral port.  Initializes #m_prefix to
-    /// "ht." + <code>component</code> + ".".
+    /// "ht." + <code>component</code> + ".".  If metrics are written to a
+    /// file, initializes #m_file to
+    /// <code>Hypertable.Metrics.File.Directory</code> + "/ht." +
+    /// <code>component</code> + ".metrics.json" (or ".txt" for the text
+    /// format).
     /// @param component Hypertable component ("fsbroker", "hyperspace, "master",
     /// "rangeserver", or "thriftbroker")
     /// @param props Properties object
@@ -98,7 +106,7 @@ namespace Hypertable {
     /// constructed from the #m_values_string, #m_values_int, and
     /// #m_values_double maps.  The JSON string is sent to the the Ganglia
     /// hyperspace extension by sending it in the form of a datagram packet over
-    /// #m_sd.
+    /// #m_sd.  Also writes the metrics to #m_file, if set.
     void publish() override;
 
   private:
@@ -109,6 +117,13 @@ namespace Hypertable {
     /// @throws Exception with code set to Error::COMM_CONNECT_ERROR
     void connect();
 
+    /// Writes metrics to #m_file.
+    /// Writes the JSON object in #m_message, or one "<name> <value>" line per
+    /// metric in the text format, to a temporary file that is then renamed
+    /// to #m_file.
+    /// @throws Exception with code set to Error::LOCAL_IO_ERROR
+    void write_file();
+
     /// %Mutex for serializing access to members
     std::mutex m_mutex;
 
@@ -138,6 +153,12 @@ namespace Hypertable {
 
     /// Flag indicating if publishing is disabled
     bool m_disabled {};
+
+    /// Metrics file, empty if metrics not written to a file
+    std::string m_file;
+
+    /// Flag indicating if metrics file is in text format instead of JSON
+    bool m_file_text {};
   };
 
   /// Smart pointer to MetricsCollectorGanglia
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for RequestTrace.
+/// This file contains definitions for RequestTrace, a class for recording
+/// the time sampled requests spend in each stage of their processing.
+
+#include <Common/Compat.h>
+
+#include "RequestTrace.h"
+
+#include <array>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+std::atomic<uint32_t> RequestTrace::ms_sampling {};
+thread_local uint64_t RequestTrace::ms_current {};
+
+namespace {
+
+  const char *stage_names[RequestTrace::STAGE_COUNT] = {
+    "CLIENT_BUFFER",
+    "CLIENT_RPC",
+    "QUEUE_WAIT",
+    "HANDLER",
+    "UPDATE_QUALIFY",
+    "UPDATE_COMMIT",
+    "UPDATE_SYNC",
+    "UPDATE_RESPOND",
+    "SCAN",
+    "BLOCK_READ"
+  };
+
+  /// Recorded span
+  struct SpanRecord {
+    uint64_t trace_id;
+    int64_t start;
+    int64_t end;
+    RequestTrace::Stage stage;
+  };
+
+  /// Ring buffer of spans of one thread
+  struct Ring {
+    array<SpanRecord, RequestTrace::RING_SIZE> spans;
+    /// Number of spans recorded, written by owning thread only
+    atomic<uint64_t> count {};
+    /// Index in registry, printed as thread number
+    size_t index {};
+    /// Set while owned by a thread
+    bool in_use {};
+  };
+
+  /// Registry of ring buffers.  Ring buffers of exited threads are kept, so
+  /// that their spans are dumped, and handed to new threads.  Allocated on
+  /// the heap and never freed so that threads exiting during process
+  /// shutdown do not use it after destruction.
+  struct Registry {
+    std::mutex mutex;
+    vector<unique_ptr<Ring>> rings;
+  };
+
+  Registry *registry() {
+    static Registry *registry = new Registry();
+    return registry;
+  }
+
+  /// Owner of the ring buffer of a thread
+  class RingHolder {
+  public:
+    ~RingHolder() {
+      if (ring) {
+        lock_guard<mutex> lock(registry()->mutex);
+        ring->in_use = false;
+      }
+    }
+    Ring *get() {
+      if (ring == nullptr) {
+        Registry *reg = registry();
+        lock_guard<mutex> lock(reg->mutex);
+        for (auto &r : reg->rings) {
+          if (!r->in_use) {
+            ring = r.get();
+            break;
+          }
+        }
+        if (ring == nullptr) {
+          reg->rings.push_back(unique_ptr<Ring>(new Ring()));
+          ring = reg->rings.back().get();
+          ring->index = reg->rings.size() - 1;
+        }
+        ring->in_use = true;
+      }
+      return ring;
+    }
+  private:
+    Ring *ring {};
+  };
+
+  thread_local RingHolder ring_holder;
+
+  /// Number of requests seen by sample_slow() on this thread
+  thread_local uint32_t sample_count;
+
+  /// Random base of trace IDs of this process
+  atomic<uint64_t> id_base;
+
+  /// Trace ID sequence number
+  atomic<uint64_t> id_sequence;
+
+  /// SplitMix64 finalizer, spreads sequence numbers over the ID space
+  uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+}
+
+const char *RequestTrace::stage_name(Stage stage) {
+  return (stage < STAGE_COUNT) ? stage_names[stage] : "UNKNOWN";
+}
+
+void RequestTrace::set_sampling(uint32_t interval) {
+  if (interval && id_base == 0) {
+    random_device rd;
+    id_base = ((uint64_t)rd() << 32) | rd();
+  }
+  ms_sampling = interval;
+}
+
+uint64_t RequestTrace::sample_slow() {
+  uint32_t interval = ms_sampling.load(memory_order_relaxed);
+  if (interval == 0 || ++sample_count % interval)
+    return 0;
+  uint64_t trace_id = mix(id_base + id_sequence.fetch_add(1));
+  return trace_id ? trace_id : 1;
+}
+
+void RequestTrace::record_slow(uint64_t trace_id, Stage stage,
+                               int64_t start_us, int64_t end_us) {
+  Ring *ring = ring_holder.get();
+  uint64_t count = ring->count.load(memory_order_relaxed);
+  SpanRecord &span = ring->spans[count % RING_SIZE];
+  span.trace_id = trace_id;
+  span.start = start_us;
+  span.end = end_us;
+  span.stage = stage;
+  ring->count.store(count + 1, memory_order_release);
+}
+
+void RequestTrace::dump(ostream &out) {
+  Registry *reg = registry();
+  lock_guard<mutex> lock(reg->mutex);
+  char buf[128];
+  for (auto &ring : reg->rings) {
+    // Spans being overwritten while dumping may come out garbled, which is
+    // acceptable for a diagnostic
+    uint64_t count = ring->count.load(memory_order_acquire);
+    uint64_t first = (count > RING_SIZE) ? count - RING_SIZE : 0;
+    for (uint64_t i=first; i<count; i++) {
+      SpanRecord span = ring->spans[i % RING_SIZE];
+      if (span.trace_id == 0 || span.end < span.start)
+        continue;
+      snprintf(buf, sizeof(buf), "TRACE %016" PRIx64 " %s %" PRId64 " %" PRId64
+               " %u\n", span.trace_id, stage_name(span.stage), span.start,
+               span.end, (unsigned)ring->index);
+      out << buf;
+    }
+  }
+}
@@ -0,0 +1,177 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for RequestTrace.
+/// This file contains declarations for RequestTrace, a class for recording
+/// the time sampled requests spend in each stage of their processing.
+
+#ifndef Common_RequestTrace_h
+#define Common_RequestTrace_h
+
+#include <Common/fast_clock.h>
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+
+namespace Hypertable {
+
+  /// @addtogroup Common
+  /// @{
+
+  /// Request latency tracing.
+  /// A client samples one in every <code>Hypertable.Request.Trace.Sampling</code>
+  /// requests and gives each sampled request a random, non-zero trace ID,
+  /// which AsyncComm carries in the message header (see
+  /// CommHeader::FLAGS_BIT_TRACE) to the server.  While a traced request is
+  /// being processed, the time spent in each of its stages is recorded as a
+  /// <i>span</i> in a ring buffer owned by the recording thread, so recording
+  /// takes no lock.  Code that records spans does not take a trace ID
+  /// argument, it uses the trace ID of the request the thread is currently
+  /// working on, which is set with a Scope object.  When the current trace ID
+  /// is 0, which is the case for all requests when sampling is off, recording
+  /// a span costs one thread-local load and branch.
+  ///
+  /// The spans of all threads are written out with dump(), one per line as
+  /// <pre>
+  /// TRACE &lt;trace-id&gt; &lt;stage&gt; &lt;start-us&gt; &lt;end-us&gt; &lt;thread&gt;
+  /// </pre>
+  /// where start and end times are microseconds since the epoch.  The
+  /// <code>ht_trace_path</code> tool merges the dumps of a client and of the
+  /// servers into the critical path of each request.  Ring buffers hold the
+  /// last #RING_SIZE spans of each thread, older spans are overwritten.
+  class RequestTrace {
+  public:
+
+    /// Request processing stage.
+    enum Stage {
+      CLIENT_BUFFER = 0, //!< Buffered in client before being sent
+      CLIENT_RPC,        //!< From send to receipt of response, on client
+      QUEUE_WAIT,        //!< Waiting in server's application queue
+      HANDLER,           //!< Request handler, on server
+      UPDATE_QUALIFY,    //!< Update pipeline qualify and transform stage
+      UPDATE_COMMIT,     //!< Update pipeline commit log write
+      UPDATE_SYNC,       //!< Update pipeline commit log sync
+      UPDATE_RESPOND,    //!< Update pipeline add to cell cache and respond
+      SCAN,              //!< Creating scanner or filling scan block
+      BLOCK_READ,        //!< CellStore block read on block cache miss
+      STAGE_COUNT        //!< Number of stages
+    };
+
+    /// Number of spans held by the ring buffer of a thread
+    static const size_t RING_SIZE = 4096;
+
+    /// Returns name of stage.
+    /// @param stage Stage
+    /// @return Name of <code>stage</code>
+    static const char *stage_name(Stage stage);
+
+    /// Sets sampling interval.
+    /// @param interval Trace one in every <code>interval</code> requests, 0
+    /// to disable sampling
+    static void set_sampling(uint32_t interval);
+
+    /// Decides whether to trace a new request.
+    /// @return New trace ID if request is sampled, 0 otherwise
+    static uint64_t sample() {
+      if (ms_sampling.load(std::memory_order_relaxed) == 0)
+        return 0;
+      return sample_slow();
+    }
+
+    /// Returns trace ID of request the calling thread is working on.
+    /// @return Current trace ID, 0 if request not traced
+    static uint64_t current() { return ms_current; }
+
+    /// Returns current time in microseconds since the epoch.
+    static int64_t now() {
+      return std::chrono::fast_clock::now().time_since_epoch().count();
+    }
+
+    /// Records a span.
+    /// @param trace_id Trace ID of request, span not recorded if 0
+    /// @param stage Stage
+    /// @param start_us Start time (microseconds since the epoch)
+    /// @param end_us End time (microseconds since the epoch)
+    static void record(uint64_t trace_id, Stage stage, int64_t start_us,
+                       int64_t end_us) {
+      if (trace_id)
+        record_slow(trace_id, stage, start_us, end_us);
+    }
+
+    /// Writes spans of all threads.
+    /// @param out Output stream
+    static void dump(std::ostream &out);
+
+    /// Sets current trace ID of calling thread for lifetime of object.
+    class Scope {
+    public:
+      /// Constructor.
+      /// @param trace_id Trace ID of request the thread works on
+      Scope(uint64_t trace_id) : m_saved(ms_current) { ms_current = trace_id; }
+      /// Destructor, restores previous trace ID.
+      ~Scope() { ms_current = m_saved; }
+    private:
+      uint64_t m_saved;
+    };
+
+    /// Records a span of the current request for lifetime of object.
+    class Span {
+    public:
+      /// Constructor.
+      /// @param stage Stage
+      Span(Stage stage) : m_trace_id(ms_current), m_stage(stage) {
+        if (m_trace_id)
+          m_start = now();
+      }
+      /// Destructor, records span.
+      ~Span() {
+        if (m_trace_id)
+          record_slow(m_trace_id, m_stage, m_start, now());
+      }
+    private:
+      uint64_t m_trace_id;
+      Stage m_stage;
+      int64_t m_start {};
+    };
+
+  private:
+
+    /// Sampling path of sample().
+    static uint64_t sample_slow();
+
+    /// Recording path of record().
+    static void record_slow(uint64_t trace_id, Stage stage, int64_t start_us,
+                            int64_t end_us);
+
+    /// Sampling interval, 0 if sampling disabled
+    static std::atomic<uint32_t> ms_sampling;
+
+    /// Trace ID of request calling thread is working on
+    static thread_local uint64_t ms_current;
+  };
+
+  /// @}
+
+}
+
+#endif // Common_RequestTrace_h
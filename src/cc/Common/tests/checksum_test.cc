@@ -0,0 +1,77 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/Checksum.h>
+#include <Common/Logger.h>
+#include <Common/Stopwatch.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Measures throughput of <code>_func_</code> over a buffer in GB/s
+#define MEASURE(_label_, _func_, _buf_, _len_, _repeats_) do { \
+    uint32_t sum = 0; \
+    Stopwatch w; \
+    for (int r = 0; r < (_repeats_); r++) \
+      sum += _func_(_buf_, _len_); \
+    w.stop(); \
+    cout << _label_ << ": " \
+         << ((double)(_len_) * (_repeats_)) / (w.elapsed() * 1e9) \
+         << " GB/s (" << hex << sum << dec << ")" << endl; \
+  } while (0)
+
+}
+
+int main(int argc, char **argv) {
+  size_t len = (argc > 1) ? (size_t)atoi(argv[1]) : 64*1024;
+  int repeats = (argc > 2) ? atoi(argv[2]) : 4096;
+
+  // Check value from RFC 3720 / iSCSI
+  HT_ASSERT(crc32c("123456789", 9) == 0xe3069283);
+  HT_ASSERT(crc32c_software("123456789", 9) == 0xe3069283);
+
+  vector<uint8_t> buf(len + 8);
+  srand(42);
+  for (auto &b : buf)
+    b = (uint8_t)rand();
+
+  // Hardware and software paths must agree for all lengths and alignments
+  for (size_t offset = 0; offset < 8; offset++)
+    for (size_t n = 0; n < 300 && offset + n <= buf.size(); n++)
+      HT_ASSERT(crc32c(&buf[offset], n) == crc32c_software(&buf[offset], n));
+
+  cout << "block size " << len << " bytes, " << repeats << " repeats, "
+       << "SSE4.2 crc32 " << (crc32c_hardware_available() ? "on" : "off")
+       << endl;
+
+  MEASURE("fletcher32     ", fletcher32, buf.data(), len, repeats);
+  MEASURE("crc32c software", crc32c_software, buf.data(), len, repeats);
+  MEASURE("crc32c         ", crc32c, buf.data(), len, repeats);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/CpuProfiler.h>
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Burns CPU for the given duration
+  double spin(chrono::milliseconds duration) {
+    auto deadline = chrono::steady_clock::now() + duration;
+    double x = 0.0;
+    while (chrono::steady_clock::now() < deadline) {
+      for (int i=1; i<1000; i++)
+        x += sqrt((double)i);
+    }
+    return x;
+  }
+
+}
+
+int main(int argc, char **argv) {
+
+  try {
+    CpuProfiler::start(0);
+    HT_ASSERT(!"invalid frequency accepted");
+  }
+  catch (Exception &e) {
+    HT_ASSERT(e.code() == Error::INVALID_ARGUMENT);
+  }
+
+  CpuProfiler::start(CpuProfiler::MAX_FREQUENCY);
+  HT_ASSERT(CpuProfiler::running());
+
+  try {
+    CpuProfiler::start();
+    HT_ASSERT(!"second start accepted");
+  }
+  catch (Exception &e) {
+    HT_ASSERT(e.code() == Error::INVALID_OPERATION);
+  }
+
+  vector<thread> threads;
+  for (int t=0; t<2; t++)
+    threads.push_back(thread([]() { spin(chrono::milliseconds(500)); }));
+  for (auto &t : threads)
+    t.join();
+
+  CpuProfiler::stop();
+  HT_ASSERT(!CpuProfiler::running());
+
+  uint64_t samples, dropped;
+  CpuProfiler::get_counts(&samples, &dropped);
+  HT_ASSERT(samples > 0);
+
+  // Every line is a stack followed by its count, counts add up to the number
+  // of samples
+  ostringstream out;
+  CpuProfiler::write(out);
+  istringstream in(out.str());
+  string line;
+  uint64_t total = 0;
+  while (getline(in, line)) {
+    size_t space = line.rfind(' ');
+    HT_ASSERT(space != string::npos && space > 0);
+    total += strtoull(line.c_str() + space + 1, 0, 10);
+  }
+  HT_ASSERT(total == samples);
+
+  // A SIGPROF still pending after stop() is ignored and not counted
+  raise(SIGPROF);
+  CpuProfiler::get_counts(&samples, &dropped);
+  HT_ASSERT(samples == total);
+
+  cout << samples << " samples, " << dropped << " dropped" << endl;
+
+  return 0;
+}
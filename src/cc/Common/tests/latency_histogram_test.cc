@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/LatencyHistogram.h>
+#include <Common/Logger.h>
+#include <Common/Stopwatch.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+int main(int argc, char **argv) {
+
+  // Every sample falls in a bucket whose upper bound is within the
+  // relative error of the sample
+  for (int64_t value=0; value<(1<<20); value++) {
+    size_t bucket = LatencyHistogram::bucket(value);
+    HT_ASSERT(bucket < LatencyHistogram::BUCKETS);
+    HT_ASSERT(LatencyHistogram::bucket_upper_bound(bucket) >= value);
+    HT_ASSERT(bucket == 0 ||
+              LatencyHistogram::bucket_upper_bound(bucket - 1) < value);
+    HT_ASSERT(LatencyHistogram::bucket_upper_bound(bucket) - value <=
+              value / (1 << (LatencyHistogram::SUB_BUCKET_BITS - 1)));
+  }
+  HT_ASSERT(LatencyHistogram::bucket(LatencyHistogram::MAX_VALUE) ==
+            LatencyHistogram::BUCKETS - 1);
+
+  // Percentiles of 1..10000 recorded by several threads
+  LatencyHistogram histogram;
+  vector<thread> threads;
+  for (int t=0; t<4; t++)
+    threads.push_back(thread([&histogram, t]() {
+          for (int64_t value=t+1; value<=10000; value+=4)
+            histogram.record(value);
+        }));
+  for (auto &t : threads)
+    t.join();
+  LatencyHistogram::Snapshot snapshot;
+  histogram.collect(snapshot);
+  HT_ASSERT(snapshot.count == 10000);
+  HT_ASSERT(snapshot.max == 10000);
+  HT_ASSERT(snapshot.sum == (int64_t)10000 * 10001 / 2);
+  for (double p : { 50.0, 90.0, 99.0, 99.9 }) {
+    int64_t expected = (int64_t)(p * 100);
+    int64_t value = snapshot.percentile(p);
+    HT_ASSERT(value >= expected && value <= expected + expected / 8);
+  }
+  HT_ASSERT(snapshot.percentile(100) == 10000);
+
+  // Collecting resets, out of range samples are clamped
+  LatencyHistogram::Snapshot empty;
+  histogram.collect(empty);
+  HT_ASSERT(empty.count == 0 && empty.percentile(99) == 0);
+  histogram.record(-5);
+  histogram.record(LatencyHistogram::MAX_VALUE + 1);
+  LatencyHistogram::Snapshot clamped;
+  histogram.collect(clamped);
+  HT_ASSERT(clamped.counts[0] == 1 && clamped.max == LatencyHistogram::MAX_VALUE);
+
+  // Merged snapshots
+  snapshot.merge(clamped);
+  HT_ASSERT(snapshot.count == 10002 && snapshot.max == LatencyHistogram::MAX_VALUE);
+
+  // Cost of recording
+  int repeats = (argc > 1) ? atoi(argv[1]) : 10000000;
+  mt19937 rng(1);
+  vector<int64_t> values(1024);
+  for (auto &value : values)
+    value = rng() % 100000;
+  Stopwatch w;
+  for (int i=0; i<repeats; i++)
+    histogram.record(values[i % values.size()]);
+  w.stop();
+  cout << "record: " << (w.elapsed() * 1e9) / repeats << " ns" << endl;
+
+  return 0;
+}
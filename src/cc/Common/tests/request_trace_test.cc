@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/Logger.h>
+#include <Common/RequestTrace.h>
+#include <Common/Stopwatch.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Returns number of dumped spans of <code>trace_id</code> and
+  /// <code>stage</code>
+  size_t count_spans(uint64_t trace_id, RequestTrace::Stage stage) {
+    ostringstream out;
+    RequestTrace::dump(out);
+    istringstream in(out.str());
+    string line;
+    size_t count {};
+    while (getline(in, line)) {
+      char stage_name[32];
+      uint64_t id;
+      int64_t start, end;
+      unsigned thread;
+      HT_ASSERT(sscanf(line.c_str(), "TRACE %" SCNx64 " %31s %" SCNd64 " %"
+                       SCNd64 " %u", &id, stage_name, &start, &end,
+                       &thread) == 5);
+      HT_ASSERT(start <= end);
+      if (id == trace_id && !strcmp(stage_name, RequestTrace::stage_name(stage)))
+        count++;
+    }
+    return count;
+  }
+
+}
+
+int main(int argc, char **argv) {
+
+  // Sampling off, nothing is traced
+  RequestTrace::set_sampling(0);
+  for (int i=0; i<1000; i++)
+    HT_ASSERT(RequestTrace::sample() == 0);
+  HT_ASSERT(RequestTrace::current() == 0);
+
+  // One in four requests sampled, with distinct IDs
+  RequestTrace::set_sampling(4);
+  uint64_t ids[2] {};
+  size_t sampled {};
+  for (int i=0; i<8; i++) {
+    uint64_t id = RequestTrace::sample();
+    if (id)
+      ids[sampled++] = id;
+  }
+  HT_ASSERT(sampled == 2 && ids[0] != ids[1]);
+  RequestTrace::set_sampling(0);
+
+  // Spans recorded within a scope, on this and another thread
+  {
+    RequestTrace::Scope scope(ids[0]);
+    HT_ASSERT(RequestTrace::current() == ids[0]);
+    RequestTrace::Span span(RequestTrace::HANDLER);
+  }
+  HT_ASSERT(RequestTrace::current() == 0);
+  thread t([&ids]() {
+      RequestTrace::Scope scope(ids[0]);
+      RequestTrace::Span span(RequestTrace::SCAN);
+    });
+  t.join();
+  RequestTrace::record(ids[1], RequestTrace::QUEUE_WAIT, 10, 20);
+  RequestTrace::record(0, RequestTrace::QUEUE_WAIT, 10, 20);
+  {
+    RequestTrace::Span span(RequestTrace::HANDLER);
+  }
+  HT_ASSERT(count_spans(ids[0], RequestTrace::HANDLER) == 1);
+  HT_ASSERT(count_spans(ids[0], RequestTrace::SCAN) == 1);
+  HT_ASSERT(count_spans(ids[1], RequestTrace::QUEUE_WAIT) == 1);
+  HT_ASSERT(count_spans(0, RequestTrace::QUEUE_WAIT) == 0);
+
+  // Ring buffer keeps the last RING_SIZE spans
+  for (size_t i=0; i<RequestTrace::RING_SIZE; i++)
+    RequestTrace::record(ids[1], RequestTrace::BLOCK_READ, i, i);
+  HT_ASSERT(count_spans(ids[0], RequestTrace::HANDLER) == 0);
+  HT_ASSERT(count_spans(ids[1], RequestTrace::BLOCK_READ) ==
+            RequestTrace::RING_SIZE);
+
+  // Cost of a span of an untraced request
+  int repeats = (argc > 1) ? atoi(argv[1]) : 10000000;
+  Stopwatch w;
+  for (int i=0; i<repeats; i++) {
+    RequestTrace::Span span(RequestTrace::HANDLER);
+  }
+  w.stop();
+  cout << "untraced span: " << (w.elapsed() * 1e9) / repeats << " ns" << endl;
+
+  return 0;
+}
@@ -18,6 +18,8 @@
  */
 #include "Common/Compat.h"
 
+#include "../ThriftBroker/ColumnarCellsReader.h"
+#include "../ThriftBroker/ColumnarCellsWriter.h"
 #include "../ThriftBroker/SerializedCellsReader.h"
 #include "../ThriftBroker/SerializedCellsWriter.h"
 
@@ -42,6 +44,136 @@ static PyObject *convert(const SerializedCellsWriter &scw) {
   return boost::python::incref(obj.ptr());
 }
 
+/// Columnar batch holding its own copy of the encoded buffer, so that the
+/// arrays handed out to Python never outlive the memory they describe
+class ColumnarCells {
+public:
+  ColumnarCells(const std::string &buf)
+    : m_buf(buf), m_reader(m_buf.data(), m_buf.size()) { }
+
+  ColumnarCellsReader &reader() { return m_reader; }
+
+private:
+  std::string m_buf;
+  ColumnarCellsReader m_reader;
+};
+
+static object array_copy(const uint8_t *data, size_t len) {
+  return object(handle<>(PyString_FromStringAndSize((const char *)data, len)));
+}
+
+static uint32_t cc_len(ColumnarCells &cc) {
+  return cc.reader().cell_count();
+}
+
+static std::string cc_row(ColumnarCells &cc, uint32_t i) {
+  return cc.reader().row(i);
+}
+
+static std::string cc_column_family(ColumnarCells &cc, uint32_t i) {
+  return cc.reader().column_family(i);
+}
+
+static std::string cc_column_qualifier(ColumnarCells &cc, uint32_t i) {
+  return cc.reader().column_qualifier(i);
+}
+
+static int64_t cc_timestamp(ColumnarCells &cc, uint32_t i) {
+  return cc.reader().timestamp(i);
+}
+
+static object cc_value(ColumnarCells &cc, uint32_t i) {
+  return array_copy((const uint8_t *)cc.reader().value(i),
+                    cc.reader().value_len(i));
+}
+
+static int cc_cell_flag(ColumnarCells &cc, uint32_t i) {
+  return cc.reader().cell_flag(i);
+}
+
+static bool cc_eos(ColumnarCells &cc) {
+  return cc.reader().eos();
+}
+
+static list cc_rows(ColumnarCells &cc) {
+  list result;
+  for (uint32_t i=0; i<cc.reader().row_count(); i++)
+    result.append(std::string(cc.reader().row_entry(i)));
+  return result;
+}
+
+static list cc_column_families(ColumnarCells &cc) {
+  list result;
+  for (uint32_t i=0; i<cc.reader().family_count(); i++)
+    result.append(std::string(cc.reader().family_entry(i)));
+  return result;
+}
+
+static list cc_column_qualifiers(ColumnarCells &cc) {
+  list result;
+  for (uint32_t i=0; i<cc.reader().qualifier_count(); i++)
+    result.append(std::string(cc.reader().qualifier_entry(i)));
+  return result;
+}
+
+// Raw streams, suitable for numpy.frombuffer()
+
+static object cc_row_ids(ColumnarCells &cc) {
+  return array_copy(cc.reader().row_ids(), 4 * cc.reader().cell_count());
+}
+
+static object cc_family_ids(ColumnarCells &cc) {
+  return array_copy(cc.reader().family_ids(), 4 * cc.reader().cell_count());
+}
+
+static object cc_qualifier_ids(ColumnarCells &cc) {
+  return array_copy(cc.reader().qualifier_ids(), 4 * cc.reader().cell_count());
+}
+
+static object cc_timestamp_deltas(ColumnarCells &cc) {
+  return array_copy(cc.reader().timestamp_deltas(),
+                    8 * cc.reader().cell_count());
+}
+
+static object cc_cell_flags(ColumnarCells &cc) {
+  return array_copy(cc.reader().cell_flags(), cc.reader().cell_count());
+}
+
+static object cc_value_offsets(ColumnarCells &cc) {
+  return array_copy(cc.reader().value_offsets(),
+                    4 * ((size_t)cc.reader().cell_count() + 1));
+}
+
+static object cc_values(ColumnarCells &cc) {
+  return array_copy(cc.reader().values(), cc.reader().values_length());
+}
+
+/// Converts a SerializedCellsWriter buffer into a columnar batch
+static object to_columnar(const std::string &serialized) {
+  ColumnarCellsWriter writer;
+  writer.add_serialized((const uint8_t *)serialized.data(), serialized.size());
+  writer.finalize();
+  return array_copy(writer.get_buffer(), writer.get_buffer_length());
+}
+
+static object columnar_convert(ColumnarCellsWriter &ccw) {
+  return array_copy(ccw.get_buffer(), ccw.get_buffer_length());
+}
+
+static void columnar_add(ColumnarCellsWriter &ccw, const char *row,
+                         const char *column_family,
+                         const char *column_qualifier, int64_t timestamp,
+                         const std::string &value, int cell_flag) {
+  ccw.add(row, column_family, column_qualifier, timestamp, value.data(),
+          value.size(), (uint8_t)cell_flag);
+}
+
+static size_t columnar_add_serialized(ColumnarCellsWriter &ccw,
+                                      const std::string &serialized) {
+  return ccw.add_serialized((const uint8_t *)serialized.data(),
+                            serialized.size());
+}
+
 BOOST_PYTHON_MODULE(libHyperPython)
 {
 
@@ -88,4 +220,38 @@ BOOST_PYTHON_MODULE(libHyperPython)
     .def("__len__", lenfn)
     .def("get", &convert)
   ;
+
+  class_<ColumnarCellsWriter, boost::noncopyable>("ColumnarCellsWriter")
+    .def("add", &columnar_add)
+    .def("add_serialized", &columnar_add_serialized)
+    .def("finalize", &ColumnarCellsWriter::finalize)
+    .def("empty", &ColumnarCellsWriter::empty)
+    .def("clear", &ColumnarCellsWriter::clear)
+    .def("__len__", &ColumnarCellsWriter::cell_count)
+    .def("get", &columnar_convert)
+  ;
+
+  class_<ColumnarCells, boost::noncopyable>("ColumnarCells",
+          init<const std::string &>())
+    .def("__len__", &cc_len)
+    .def("row", &cc_row)
+    .def("column_family", &cc_column_family)
+    .def("column_qualifier", &cc_column_qualifier)
+    .def("timestamp", &cc_timestamp)
+    .def("value", &cc_value)
+    .def("cell_flag", &cc_cell_flag)
+    .def("eos", &cc_eos)
+    .def("rows", &cc_rows)
+    .def("column_families", &cc_column_families)
+    .def("column_qualifiers", &cc_column_qualifiers)
+    .def("row_ids", &cc_row_ids)
+    .def("family_ids", &cc_family_ids)
+    .def("qualifier_ids", &cc_qualifier_ids)
+    .def("timestamp_deltas", &cc_timestamp_deltas)
+    .def("cell_flags", &cc_cell_flags)
+    .def("value_offsets", &cc_value_offsets)
+    .def("values", &cc_values)
+  ;
+
+  def("to_columnar", &to_columnar);
 }
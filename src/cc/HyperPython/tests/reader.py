@@ -46,6 +46,19 @@ try:
         s += scr.value()[i]
       print s
 
+  client.scanner_close(scanner)
+
+  # read as columnar batches
+  print "ColumnarCells example"
+  scanner = client.scanner_open(namespace, "thrift_test",   \
+          ScanSpec(None, None, None, 1));
+  while True:
+    cc = libHyperPython.ColumnarCells(client.next_cells_columnar(scanner))
+    for i in range(len(cc)):
+      print cc.row(i), cc.column_family(i), cc.value(i)
+    if cc.eos():
+      break
+
   client.scanner_close(scanner)
   client.namespace_close(namespace)
 except:
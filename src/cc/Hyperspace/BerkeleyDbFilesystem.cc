@@ -67,6 +67,11 @@ void close_db_cursor(Dbc **cursor) {
   }
 }
 
+void close_state_db_cursor(StateDbCursor **cursor) {
+  delete *cursor;
+  *cursor = 0;
+}
+
 const char* BerkeleyDbFilesystem::ms_name_namespace_db = "namespace.db";
 const char* BerkeleyDbFilesystem::ms_name_state_db = "state.db";
 
@@ -229,6 +234,22 @@ BerkeleyDbFilesystem::BerkeleyDbFilesystem(PropertiesPtr &props,
       m_replication_info.do_replication = false;
     }
 
+    String backend = props->get_str("Hyperspace.StateDb.Backend", "bdb");
+    if (backend == "memory" && m_replication_info.do_replication) {
+      HT_WARN("Hyperspace.StateDb.Backend=memory is not replicated, "
+              "using bdb");
+      backend = "bdb";
+    }
+    if (backend == "memory")
+      m_state_db.reset(new StateDbMemory());
+    else if (backend == "bdb")
+      m_state_db.reset(new StateDbBerkeley());
+    else
+      HT_THROWF(Error::CONFIG_BAD_VALUE,
+                "Invalid value for Hyperspace.StateDb.Backend: %s",
+                backend.c_str());
+    HT_INFOF("Hyperspace state store: %s", backend.c_str());
+
 
     // only master can initiate writes
     if (is_master()) {
@@ -590,6 +611,10 @@ void BerkeleyDbFilesystem::start_transaction(BDbTxn &txn) {
     txn.handle_namespace_db = db_handles->handle_namespace_db;
     txn.handle_state_db = db_handles->handle_state_db;
 
+    // acquire state store before any BerkeleyDB locks are taken
+    txn.state_db = m_state_db.get();
+    txn.state_db->begin(txn);
+
     // open txn
     m_env.txn_begin(NULL, &txn.db_txn, 0);
   }
@@ -1440,8 +1465,8 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
   DbtManaged keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"create_event txn="<< txn <<" event type='"<< type <<"' id="
       << id << " mask=" << mask << HT_END;
@@ -1455,7 +1480,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     sprintf(numbuf, "%llu", (Llu)id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
 
@@ -1465,7 +1490,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     sprintf(numbuf, "%lu", (Lu)type);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
     // Store event mask
     key_str = get_event_key(id, EVENT_MASK);
@@ -1473,7 +1498,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     sprintf(numbuf, "%lu", (Lu)mask);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -1496,8 +1521,8 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
   int ret;
   String key_str;
   DbtManaged keym, datam;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   try {
     create_event(txn, type, id, mask);
@@ -1505,7 +1530,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     key_str = get_event_key(id, EVENT_NAME);
     keym.set_str(key_str);
     datam.set_str(name);
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -1537,7 +1562,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     sprintf(numbuf, "%lu", (Lu)mode);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -1570,7 +1595,7 @@ BerkeleyDbFilesystem::create_event(BDbTxn &txn, uint32_t type, uint64_t id,
     sprintf(numbuf, "%llu", (Llu)generation);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -1614,7 +1639,7 @@ BerkeleyDbFilesystem::set_event_notification_handles(BDbTxn &txn, uint64_t id,
     key_str = get_event_key(id, EVENT_NOTIFICATION_HANDLES);
     keym.set_str(key_str);
     // Write only if this key doesnt exist in the db
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &data, DB_NOOVERWRITE);
+    ret = txn.state_db->put(txn, &keym, &data, DB_NOOVERWRITE);
     HT_ASSERT(ret == 0);
 
   }
@@ -1638,8 +1663,8 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
   DbtManaged keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"delete_event txn="<< txn <<" event id="<< id << HT_END;
   try {
@@ -1652,7 +1677,7 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
     sprintf(numbuf, "%llu", (Llu)id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     cursorp->get(&keym, &datam, DB_GET_BOTH);
     cursorp->del(0);
 
@@ -1660,21 +1685,21 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
     key_str = get_event_key(id, EVENT_TYPE);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete event mask
     key_str = get_event_key(id, EVENT_MASK);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete event name
     key_str = get_event_key(id, EVENT_NAME);
     keym.set_str(key_str);
 
-    if ((ret = txn.handle_state_db->del(txn.db_txn, &keym, 0)) == DB_NOTFOUND)
+    if ((ret = txn.state_db->del(txn, &keym, 0)) == DB_NOTFOUND)
       HT_DEBUG_OUT <<"txn="<< txn <<" event key " << keym.get_str()
                    << "not found in DB"  << HT_END;
 
@@ -1682,7 +1707,7 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
     key_str = get_event_key(id, EVENT_MODE);
     keym.set_str(key_str);
 
-    if ((ret = txn.handle_state_db->del(txn.db_txn, &keym, 0)) == DB_NOTFOUND)
+    if ((ret = txn.state_db->del(txn, &keym, 0)) == DB_NOTFOUND)
       HT_DEBUG_OUT <<"txn="<< txn <<" event key " << keym.get_str()
                    << " not found in DB"  << HT_END;
 
@@ -1690,7 +1715,7 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
     key_str = get_event_key(id, EVENT_GENERATION);
     keym.set_str(key_str);
 
-    if ((ret = txn.handle_state_db->del(txn.db_txn, &keym, 0)) == DB_NOTFOUND)
+    if ((ret = txn.state_db->del(txn, &keym, 0)) == DB_NOTFOUND)
       HT_DEBUG_OUT <<"txn="<< txn <<" event key " << keym.get_str()
                    << " not found in DB"  << HT_END;
 
@@ -1698,7 +1723,7 @@ BerkeleyDbFilesystem::delete_event(BDbTxn &txn, uint64_t id)
     key_str = get_event_key(id, EVENT_NOTIFICATION_HANDLES);
     keym.set_str(key_str);
 
-    if ((ret = txn.handle_state_db->del(txn.db_txn, &keym, 0)) == DB_NOTFOUND)
+    if ((ret = txn.state_db->del(txn, &keym, 0)) == DB_NOTFOUND)
       HT_DEBUG_OUT <<"txn="<< txn <<" event key " << keym.get_str()
                    << " not found in DB"  << HT_END;
   }
@@ -1719,15 +1744,15 @@ bool
 BerkeleyDbFilesystem::event_exists(BDbTxn &txn, uint64_t id)
 {
   DbtManaged keym, datam;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool exists = true;
   char numbuf[16];
 
   HT_DEBUG_OUT <<"event_exists txn="<< txn << "event id=" << id << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Check for id under "/EVENTS/"
     String events_dir = EVENTS_STR;
@@ -1766,8 +1791,8 @@ BerkeleyDbFilesystem::create_session(BDbTxn &txn, uint64_t id, const String& add
   String key_str;
   String expbuf;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"create_session txn="<< txn <<" create session addr='"<< addr
               << " id="<< id << HT_END;
@@ -1780,7 +1805,7 @@ BerkeleyDbFilesystem::create_session(BDbTxn &txn, uint64_t id, const String& add
     sprintf(numbuf, "%llu", (Llu)id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
 
@@ -1789,7 +1814,7 @@ BerkeleyDbFilesystem::create_session(BDbTxn &txn, uint64_t id, const String& add
     keym.set_str(key_str);
     datam.set_str(addr);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store session expired status
@@ -1797,7 +1822,7 @@ BerkeleyDbFilesystem::create_session(BDbTxn &txn, uint64_t id, const String& add
     keym.set_str(key_str);
     datam.set_str((String)"0");
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -1824,8 +1849,8 @@ BerkeleyDbFilesystem::delete_session(BDbTxn &txn, uint64_t id)
   DbtManaged keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"delete_session txn="<< txn <<" session id="<< id << HT_END;
   try {
@@ -1834,13 +1859,13 @@ BerkeleyDbFilesystem::delete_session(BDbTxn &txn, uint64_t id)
     key_str = get_session_key(id, SESSION_EXPIRED);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret==0);
 
     // Delete session handles
     String session_handles_dir = get_session_key(id, SESSION_HANDLES);
     keym.set_str(session_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     ret = cursorp->get(&keym, &datam, DB_SET);
     while(ret != DB_NOTFOUND) {
@@ -1862,7 +1887,7 @@ BerkeleyDbFilesystem::delete_session(BDbTxn &txn, uint64_t id)
     key_str = get_session_key(id, SESSION_ADDR);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret==0);
 
     // Delete id under "/SESSIONS/"
@@ -1895,13 +1920,13 @@ BerkeleyDbFilesystem::expire_session(BDbTxn &txn, uint64_t id)
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"expire_session txn="<< txn <<" session id="<< id << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     // Set session expired status
     key_str = get_session_key(id, SESSION_EXPIRED);
     keym.set_str(key_str);
@@ -1936,8 +1961,8 @@ BerkeleyDbFilesystem::add_session_handle(BDbTxn &txn, uint64_t id, uint64_t hand
   DbtManaged  keym, datam;
   String key_str;
   char numbuf[17];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT << "add_session_handle txn="<< txn <<" session id="<< id
                << " handle id=" << handle_id << HT_END;
@@ -1949,7 +1974,7 @@ BerkeleyDbFilesystem::add_session_handle(BDbTxn &txn, uint64_t id, uint64_t hand
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
   }
@@ -1974,8 +1999,8 @@ BerkeleyDbFilesystem::get_session_handles(BDbTxn &txn, uint64_t id, std::vector<
   int ret;
   DbtManaged  keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"get_session_handles txn="<< txn <<" session id="<< id << HT_END;
 
@@ -1984,7 +2009,7 @@ BerkeleyDbFilesystem::get_session_handles(BDbTxn &txn, uint64_t id, std::vector<
 
     String session_handles_dir = get_session_key(id, SESSION_HANDLES);
     keym.set_str(session_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     ret = cursorp->get(&keym, &datam, DB_SET);
     while(ret != DB_NOTFOUND) {
@@ -2015,8 +2040,8 @@ BerkeleyDbFilesystem::delete_session_handle(BDbTxn &txn, uint64_t id, uint64_t h
   String key_str;
   char numbuf[17];
   bool deleted = false;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"delete_session_handle txn="<< txn <<" session id="<< id
                << " handle_id=" << handle_id << HT_END;
@@ -2028,7 +2053,7 @@ BerkeleyDbFilesystem::delete_session_handle(BDbTxn &txn, uint64_t id, uint64_t h
     keym.set_str(session_handles_dir);
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
 
     HT_EXPECT(ret == 0 || ret == DB_NOTFOUND, HYPERSPACE_STATEDB_ERROR);
@@ -2060,15 +2085,15 @@ bool
 BerkeleyDbFilesystem::session_exists(BDbTxn &txn, uint64_t id)
 {
   DbtManaged keym, datam;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool exists = true;
   char numbuf[16];
 
   HT_DEBUG_OUT <<"session_exists txn="<< txn << " session id=" << id << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Check for id under "/SESSIONS/"
     String sessions_dir = SESSIONS_STR;
@@ -2105,20 +2130,20 @@ BerkeleyDbFilesystem::set_session_name(BDbTxn &txn, uint64_t id, const String &n
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"set_session_name txn="<< txn <<" name='"<< name << "' id="<< id << HT_END;
   try {
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     // Store session name/replace if exists
     key_str = get_session_key(id, SESSION_NAME);
     keym.set_str(key_str);
     ret = cursorp->get(&keym, &datam, DB_SET);
     datam.set_str(name);
     if (ret == DB_NOTFOUND)
-      ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+      ret = txn.state_db->put(txn, &keym, &datam, 0);
     else
       ret = cursorp->put(&keym, &datam, DB_CURRENT);
 
@@ -2145,8 +2170,8 @@ BerkeleyDbFilesystem::get_session_name(BDbTxn &txn, uint64_t id)
   int ret;
   DbtManaged  keym, datam;
   String key_str, name;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"get_session_name txn="<< txn <<" session id="<< id << HT_END;
 
@@ -2155,7 +2180,7 @@ BerkeleyDbFilesystem::get_session_name(BDbTxn &txn, uint64_t id)
     HT_EXPECT(session_exists(txn, id), HYPERSPACE_STATEDB_SESSION_NOT_EXISTS);
 
     keym.set_str(get_session_key(id, SESSION_NAME));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     ret = cursorp->get(&keym, &datam, DB_SET);
 
@@ -2193,8 +2218,8 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
   String key_str;
   char numbuf[17];
   String buf;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"create_handle txn="<< txn <<" id="<< id << " node='"<< node_name
                << "' open_flags=" << open_flags << " event_mask="<< event_mask
@@ -2209,7 +2234,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     sprintf(numbuf, "%llu", (Llu)id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
 
@@ -2218,7 +2243,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     keym.set_str(key_str);
     datam.set_str(node_name);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store handle open_flags
@@ -2227,7 +2252,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     sprintf(numbuf, "%lu", (Lu)open_flags);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store handle deletion state
@@ -2236,7 +2261,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     sprintf(numbuf, "%lu", (Lu)del_state);
     datam.set_str(numbuf);
 
-    ret =  txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret =  txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store handle notification event_mask
@@ -2245,7 +2270,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     sprintf(numbuf, "%lu", (Lu)event_mask);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store handle session id
@@ -2254,7 +2279,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
     sprintf(numbuf, "%llu", (Llu)session_id);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store handle locked bool
@@ -2266,7 +2291,7 @@ BerkeleyDbFilesystem::create_handle(BDbTxn &txn, uint64_t id, String node_name,
       buf = "0";
     datam.set_str(buf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -2294,8 +2319,8 @@ BerkeleyDbFilesystem::delete_handle(BDbTxn &txn, uint64_t id)
   DbtManaged keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"delete_handle txn="<< txn <<" handle id="<< id << HT_END;
   try {
@@ -2305,42 +2330,42 @@ BerkeleyDbFilesystem::delete_handle(BDbTxn &txn, uint64_t id)
     key_str = get_handle_key(id, HANDLE_LOCKED);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete handle session id
     key_str = get_handle_key(id, HANDLE_SESSION_ID);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete handle notification event_mask
     key_str = get_handle_key(id, HANDLE_EVENT_MASK);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete handle open_flags
     key_str = get_handle_key(id, HANDLE_OPEN_FLAGS);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete handle deletion state
     key_str = get_handle_key(id, HANDLE_DEL_STATE);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete handle node name
     key_str = get_handle_key(id, HANDLE_NODE_NAME);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete id under "/HANDLES/"
@@ -2349,7 +2374,7 @@ BerkeleyDbFilesystem::delete_handle(BDbTxn &txn, uint64_t id)
     sprintf(numbuf, "%llu", (Llu)id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
     HT_ASSERT(ret==0);
     ret = cursorp->del(0);
@@ -2378,15 +2403,15 @@ BerkeleyDbFilesystem::set_handle_del_state(BDbTxn &txn, uint64_t id, uint32_t de
   DbtManaged keym, datam;
   char numbuf[17];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_handle_del_state txn="<< txn <<" handle id="
                << id << " del_state=" << del_state << HT_END;
   try {
     HT_ASSERT(handle_exists(txn, id));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing open flag
     key_str = get_handle_key(id, HANDLE_DEL_STATE);
@@ -2426,15 +2451,15 @@ BerkeleyDbFilesystem::set_handle_open_flags(BDbTxn &txn, uint64_t id, uint32_t o
   DbtManaged keym, datam;
   char numbuf[17];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_handle_open_flags txn="<< txn <<" handle id="
                << id << " open_flags=" << open_flags << HT_END;
   try {
     HT_EXPECT(handle_exists(txn, id), HYPERSPACE_STATEDB_HANDLE_NOT_EXISTS);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing open flag
     key_str = get_handle_key(id, HANDLE_OPEN_FLAGS);
@@ -2472,15 +2497,15 @@ BerkeleyDbFilesystem::set_handle_event_mask(BDbTxn &txn, uint64_t id, uint32_t e
   DbtManaged keym, datam;
   char numbuf[17];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_handle_event_mask txn="<< txn <<" handle id="
                << id << " event_mask=" << event_mask << HT_END;
   try {
     HT_EXPECT(handle_exists(txn, id), HYPERSPACE_STATEDB_HANDLE_NOT_EXISTS);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing event_mask
     key_str = get_handle_key(id, HANDLE_EVENT_MASK);
@@ -2517,15 +2542,15 @@ BerkeleyDbFilesystem::get_handle_event_mask(BDbTxn &txn, uint64_t id)
 {
   DbtManaged keym, datam;
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
   uint32_t event_mask;
 
   HT_DEBUG_OUT <<"get_handle_event_mask txn="<< txn <<" handle id=" << id << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing event_mask
     key_str = get_handle_key(id, HANDLE_EVENT_MASK);
@@ -2559,15 +2584,15 @@ BerkeleyDbFilesystem::set_handle_locked(BDbTxn &txn, uint64_t id, bool locked)
   DbtManaged keym, datam;
   int ret;
   String buf;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_handle_locked txn="<< txn <<" handle id=" << id
                << " locked=" << locked << HT_END;
   try {
     HT_ASSERT(handle_exists(txn, id));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing lockedness
     key_str = get_handle_key(id, HANDLE_LOCKED);
@@ -2602,15 +2627,15 @@ bool
 BerkeleyDbFilesystem::handle_exists(BDbTxn &txn, uint64_t id)
 {
   DbtManaged keym, datam;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool exists = true;
   char numbuf[17];
 
   HT_DEBUG_OUT <<"handle_exists txn="<< txn << " handle id=" << id << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Check for id under "/HANDLES/"
     String handles_dir = HANDLES_STR;
@@ -2657,7 +2682,7 @@ BerkeleyDbFilesystem::handle_is_locked(BDbTxn &txn, uint64_t id)
     // Get locked-ness
     key_str = get_handle_key(id, HANDLE_LOCKED);
     keym.set_str(key_str);
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     buf = datam.get_str();
@@ -2704,7 +2729,7 @@ BerkeleyDbFilesystem::get_handle_node(BDbTxn &txn, uint64_t id, String &node_nam
     key_str = get_handle_key(id, HANDLE_NODE_NAME);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
     node_name = datam.get_str();
 
@@ -2742,7 +2767,7 @@ BerkeleyDbFilesystem::get_handle_del_state(BDbTxn &txn, uint64_t id)
     key_str = get_handle_key(id, HANDLE_DEL_STATE);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     del_state = (uint32_t)strtoul(datam.get_str(), 0, 0);
@@ -2783,7 +2808,7 @@ BerkeleyDbFilesystem::get_handle_open_flags(BDbTxn &txn, uint64_t id)
     key_str = get_handle_key(id, HANDLE_OPEN_FLAGS);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     open_flags = (uint32_t)strtoul(datam.get_str(), 0, 0);
@@ -2824,7 +2849,7 @@ BerkeleyDbFilesystem::get_handle_session(BDbTxn &txn, uint64_t id)
     key_str = get_handle_key(id, HANDLE_SESSION_ID);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     session_id = (uint64_t)strtoull(datam.get_str(), 0, 0);
@@ -2856,8 +2881,8 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String buf;
   char numbuf[17];
 
@@ -2873,7 +2898,7 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
     keym.set_str(nodes_dir);
     datam.set_str(name);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
 
@@ -2885,7 +2910,7 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
     else
       buf = "0";
     datam.set_str(buf);
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
 
@@ -2895,7 +2920,7 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
     sprintf(numbuf, "%lu", (Lu)cur_lock_mode);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store node lock generation
@@ -2904,7 +2929,7 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
     sprintf(numbuf, "%llu", (Llu)lock_generation);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
     // Store node exclusive_handle
@@ -2913,7 +2938,7 @@ BerkeleyDbFilesystem::create_node(BDbTxn &txn, const String &name,
     sprintf(numbuf, "%llu", (Llu)exclusive_handle);
     datam.set_str(numbuf);
 
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
 
   }
@@ -2943,8 +2968,8 @@ BerkeleyDbFilesystem::set_node_lock_generation(BDbTxn &txn, const String &name,
   DbtManaged keym, datam;
   char numbuf[17];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   String key_str;
 
@@ -2952,7 +2977,7 @@ BerkeleyDbFilesystem::set_node_lock_generation(BDbTxn &txn, const String &name,
                <<" lock_generation=" << lock_generation << HT_END;
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing lock_generation
     key_str = get_node_key(name, NODE_LOCK_GENERATION);
@@ -2990,8 +3015,8 @@ BerkeleyDbFilesystem::incr_node_lock_generation(BDbTxn &txn, const String &name)
   char numbuf[17];
   int ret;
   uint64_t lock_generation=0;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   String key_str;
 
@@ -2999,7 +3024,7 @@ BerkeleyDbFilesystem::incr_node_lock_generation(BDbTxn &txn, const String &name)
 
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing lock_generation
     key_str = get_node_key(name, NODE_LOCK_GENERATION);
@@ -3041,15 +3066,15 @@ BerkeleyDbFilesystem::set_node_ephemeral(BDbTxn &txn, const String &name,
   DbtManaged keym, datam;
   int ret;
   String buf;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_node_ephemeral txn="<< txn <<" node_name=" << name
                <<" ephemeral=" << ephemeral << HT_END;
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing node_name
     key_str = get_node_key(name, NODE_EPHEMERAL);
@@ -3098,7 +3123,7 @@ BerkeleyDbFilesystem::node_is_ephemeral(BDbTxn &txn, const String &name)
     // Replace existing node_name
     key_str = get_node_key(name, NODE_EPHEMERAL);
     keym.set_str(key_str);
-    ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->get(txn, &keym, &datam, 0);
 
     HT_ASSERT(ret == 0);
 
@@ -3133,15 +3158,15 @@ BerkeleyDbFilesystem::set_node_cur_lock_mode(BDbTxn &txn, const String &name,
   DbtManaged keym, datam;
   char numbuf[16];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_node_cur_lock_mode txn="<< txn <<" node=" << name
                <<" lock_mode=" << lock_mode << HT_END;
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing lock_mode
     key_str = get_node_key(name, NODE_LOCK_MODE);
@@ -3177,8 +3202,8 @@ BerkeleyDbFilesystem::get_node_cur_lock_mode(BDbTxn &txn, const String &name)
 {
   DbtManaged keym, datam;
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
   uint32_t lock_mode;
 
@@ -3186,7 +3211,7 @@ BerkeleyDbFilesystem::get_node_cur_lock_mode(BDbTxn &txn, const String &name)
 
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Get existing lock_mode
     key_str = get_node_key(name, NODE_LOCK_MODE);
@@ -3220,15 +3245,15 @@ BerkeleyDbFilesystem::set_node_exclusive_lock_handle(BDbTxn &txn,
   DbtManaged keym, datam;
   char numbuf[17];
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
 
   HT_DEBUG_OUT <<"set_node_exclusive_lock_handle  txn="<< txn <<" node=" << name
                <<" exclusive_lock_handle=" << exclusive_lock_handle << HT_END;
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing exclusive lock handle
     key_str = get_node_key(name, NODE_EXCLUSIVE_LOCK_HANDLE);
@@ -3263,8 +3288,8 @@ BerkeleyDbFilesystem::get_node_exclusive_lock_handle(BDbTxn &txn, const String &
 {
   DbtManaged keym, datam;
   int ret;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   String key_str;
   uint64_t exclusive_lock_handle=0;
 
@@ -3272,7 +3297,7 @@ BerkeleyDbFilesystem::get_node_exclusive_lock_handle(BDbTxn &txn, const String &
 
   try {
     HT_ASSERT(node_exists(txn, name));
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Replace existing exclusive lock handle
     key_str = get_node_key(name, NODE_EXCLUSIVE_LOCK_HANDLE);
@@ -3308,8 +3333,8 @@ BerkeleyDbFilesystem::add_node_handle(BDbTxn &txn, const String &name,
   DbtManaged  keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"add_node_handle txn="<< txn <<" node="<< name << " handle id=" << handle_id
                << HT_END;
@@ -3322,7 +3347,7 @@ BerkeleyDbFilesystem::add_node_handle(BDbTxn &txn, const String &name,
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
   }
@@ -3350,8 +3375,8 @@ BerkeleyDbFilesystem::get_node_event_notification_map(BDbTxn &txn, const String
   String key_str;
   uint64_t handle, session;
   uint32_t mask;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool has_notifications = false;
 
   HT_DEBUG_OUT <<"get_node_event_notification_map txn="<< txn <<" node="<< name << HT_END;
@@ -3361,7 +3386,7 @@ BerkeleyDbFilesystem::get_node_event_notification_map(BDbTxn &txn, const String
 
     String node_handles_dir = get_node_key(name, NODE_HANDLE_MAP);
     keym.set_str(node_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
 
     // iterate through all handles
@@ -3402,8 +3427,8 @@ BerkeleyDbFilesystem::delete_node_handle(BDbTxn &txn, const String &name,
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp=0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp=0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   char numbuf[17];
 
   HT_DEBUG_OUT <<"delete_node_handle txn="<< txn <<" node="<< name
@@ -3416,7 +3441,7 @@ BerkeleyDbFilesystem::delete_node_handle(BDbTxn &txn, const String &name,
     keym.set_str(node_handles_dir);
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
     HT_ASSERT(ret ==0 );
 
@@ -3448,8 +3473,8 @@ BerkeleyDbFilesystem::add_node_pending_lock_request(BDbTxn &txn,
   DbtManaged keym, datam;
   String key_str;
   char numbuf[17];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"add_node_pending_lock_request txn="<< txn <<" node=" << name
                << " handle id=" << request.handle << " mode=" << request.mode << HT_END;
@@ -3461,7 +3486,7 @@ BerkeleyDbFilesystem::add_node_pending_lock_request(BDbTxn &txn,
     sprintf(numbuf, "%llu", (Llu)request.handle);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
 
@@ -3469,7 +3494,7 @@ BerkeleyDbFilesystem::add_node_pending_lock_request(BDbTxn &txn,
     keym.set_str(key_str);
     sprintf(numbuf, "%lu", (Lu)request.mode);
     datam.set_str(numbuf);
-    ret = txn.handle_state_db->put(txn.db_txn, &keym, &datam, 0);
+    ret = txn.state_db->put(txn, &keym, &datam, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -3496,8 +3521,8 @@ BerkeleyDbFilesystem::node_has_pending_lock_request(BDbTxn &txn, const String &n
   DbtManaged keym, datam;
   String key_str;
   bool has_pending_lock_request = false;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   uint64_t handle_id;
 
   HT_DEBUG_OUT << "node_has_pending_lock_request txn=" << txn << " node=" << name << HT_END;
@@ -3508,7 +3533,7 @@ BerkeleyDbFilesystem::node_has_pending_lock_request(BDbTxn &txn, const String &n
     // get top pending handle id of lock request (if any)
     String node_pending_locks_dir = get_node_key(name, NODE_PENDING_LOCK_REQUESTS);
     keym.set_str(node_pending_locks_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
 
     HT_ASSERT(ret == 0 || ret == DB_NOTFOUND);
@@ -3518,7 +3543,7 @@ BerkeleyDbFilesystem::node_has_pending_lock_request(BDbTxn &txn, const String &n
       handle_id = (uint64_t) strtoull(datam.get_str(), 0, 0);
       key_str = get_node_pending_lock_request_key(name, handle_id);
       keym.set_str(key_str);
-      ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+      ret = txn.state_db->get(txn, &keym, &datam, 0);
       HT_ASSERT(ret == 0);
       has_pending_lock_request = true;
     }
@@ -3550,8 +3575,8 @@ BerkeleyDbFilesystem::get_node_pending_lock_request(BDbTxn &txn, const String &n
   DbtManaged keym, datam;
   String key_str;
   bool has_pending_lock_request = false;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   uint64_t handle_id;
 
   HT_DEBUG_OUT << "get_node_pending_lock_request txn=" << txn << " node=" << name << HT_END;
@@ -3562,7 +3587,7 @@ BerkeleyDbFilesystem::get_node_pending_lock_request(BDbTxn &txn, const String &n
     // get top pending handle id of lock request (if any)
     String node_pending_locks_dir = get_node_key(name, NODE_PENDING_LOCK_REQUESTS);
     keym.set_str(node_pending_locks_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
     HT_ASSERT(ret == 0 || ret == DB_NOTFOUND);
 
@@ -3572,7 +3597,7 @@ BerkeleyDbFilesystem::get_node_pending_lock_request(BDbTxn &txn, const String &n
       handle_id = (uint64_t) strtoull(datam.get_str(), 0, 0);
       key_str = get_node_pending_lock_request_key(name, handle_id);
       keym.set_str(key_str);
-      ret = txn.handle_state_db->get(txn.db_txn, &keym, &datam, 0);
+      ret = txn.state_db->get(txn, &keym, &datam, 0);
       HT_ASSERT(ret == 0);
 
       front_req.handle = handle_id;
@@ -3604,8 +3629,8 @@ BerkeleyDbFilesystem::delete_node_pending_lock_request(BDbTxn &txn,
   DbtManaged keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"remove_node_pending_lock_request txn="<< txn <<" node=" << name
                <<" handle id=" << handle_id << HT_END;
@@ -3618,7 +3643,7 @@ BerkeleyDbFilesystem::delete_node_pending_lock_request(BDbTxn &txn,
     keym.set_str(node_pending_locks_dir);
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
     HT_ASSERT(ret ==0);
 
@@ -3627,7 +3652,7 @@ BerkeleyDbFilesystem::delete_node_pending_lock_request(BDbTxn &txn,
     //Delete pending lock request
     key_str = get_node_pending_lock_request_key(name, handle_id);
     keym.set_str(key_str);
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret==0);
   }
   catch (DbException &e) {
@@ -3654,8 +3679,8 @@ BerkeleyDbFilesystem::add_node_shared_lock_handle(BDbTxn &txn, const String &nam
   DbtManaged  keym, datam;
   String key_str;
   char numbuf[16];
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"add_node_shared_lock_handle txn="<< txn <<" node="<< name
       << " handle id=" << handle_id << HT_END;
@@ -3668,7 +3693,7 @@ BerkeleyDbFilesystem::add_node_shared_lock_handle(BDbTxn &txn, const String &nam
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->put(&keym, &datam, DB_KEYLAST);
     HT_ASSERT(ret == 0);
   }
@@ -3693,8 +3718,8 @@ BerkeleyDbFilesystem::node_has_shared_lock_handles(BDbTxn &txn, const String &na
   int ret;
   DbtManaged  keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool has_shared_lock_handles=false;
 
   HT_DEBUG_OUT <<"node_has_shared_lock_handles txn="<< txn <<" node="<< name << HT_END;
@@ -3704,7 +3729,7 @@ BerkeleyDbFilesystem::node_has_shared_lock_handles(BDbTxn &txn, const String &na
 
     String node_shared_handles_dir = get_node_key(name, NODE_SHARED_LOCK_HANDLES);
     keym.set_str(node_shared_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
     HT_ASSERT(ret == 0 || ret == DB_NOTFOUND);
 
@@ -3735,8 +3760,8 @@ BerkeleyDbFilesystem::delete_node_shared_lock_handle(BDbTxn &txn, const String &
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp=0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp=0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   char numbuf[17];
 
   HT_DEBUG_OUT <<"remove_node_shared_lock_handle txn="<< txn <<" node="<< name
@@ -3749,7 +3774,7 @@ BerkeleyDbFilesystem::delete_node_shared_lock_handle(BDbTxn &txn, const String &
     keym.set_str(node_shared_handles_dir);
     sprintf(numbuf, "%llu", (Llu)handle_id);
     datam.set_str(numbuf);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
     HT_ASSERT(ret ==0);
 
@@ -3777,8 +3802,8 @@ BerkeleyDbFilesystem::delete_node(BDbTxn &txn, const String &name)
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT <<"delete_node txn="<< txn <<" node ="<< name << HT_END;
   try {
@@ -3789,7 +3814,7 @@ BerkeleyDbFilesystem::delete_node(BDbTxn &txn, const String &name)
     keym.set_str(nodes_dir);
     datam.set_str(name);
 
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_GET_BOTH);
     HT_ASSERT(ret==0);
     ret = cursorp->del(0);
@@ -3799,28 +3824,28 @@ BerkeleyDbFilesystem::delete_node(BDbTxn &txn, const String &name)
     key_str = get_node_key(name, NODE_EPHEMERAL);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete node cur_lock_mode
     key_str = get_node_key(name, NODE_LOCK_MODE);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete node lock_generation
     key_str = get_node_key(name, NODE_LOCK_GENERATION);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
 
     // Delete node exclusive_lock_handle
     key_str = get_node_key(name, NODE_EXCLUSIVE_LOCK_HANDLE);
     keym.set_str(key_str);
 
-    ret = txn.handle_state_db->del(txn.db_txn, &keym, 0);
+    ret = txn.state_db->del(txn, &keym, 0);
     HT_ASSERT(ret == 0);
   }
   catch (DbException &e) {
@@ -3844,15 +3869,15 @@ bool
 BerkeleyDbFilesystem::node_exists(BDbTxn &txn, const String &name)
 {
   DbtManaged keym, datam;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool exists = true;
 
   HT_DEBUG_OUT <<"node_exists txn="<< txn << " node name="
       << name << HT_END;
 
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Check for id under "/NODES/"
     String nodes_dir = NODES_STR;
@@ -3887,8 +3912,8 @@ BerkeleyDbFilesystem::get_node_handles(BDbTxn &txn, const String &name,
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
 
   HT_DEBUG_OUT << "get_node_handles txn=" << txn << " node=" << name << HT_END;
 
@@ -3898,7 +3923,7 @@ BerkeleyDbFilesystem::get_node_handles(BDbTxn &txn, const String &name,
     // Iterate through all handles
     String node_handles_dir = get_node_key(name, NODE_HANDLE_MAP);
     keym.set_str(node_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
 
     while (ret != DB_NOTFOUND) {
@@ -3928,8 +3953,8 @@ BerkeleyDbFilesystem::node_has_open_handles(BDbTxn &txn, const String &name)
   int ret;
   DbtManaged keym, datam;
   String key_str;
-  Dbc *cursorp=0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp=0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   bool has_open_handles = false;
   uint64_t open_handle;
 
@@ -3941,7 +3966,7 @@ BerkeleyDbFilesystem::node_has_open_handles(BDbTxn &txn, const String &name)
     // Check to see if there is even one handle open to this node
     String node_handles_dir = get_node_key(name, NODE_HANDLE_MAP);
     keym.set_str(node_handles_dir);
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
     ret = cursorp->get(&keym, &datam, DB_SET);
 
     HT_ASSERT(ret == 0 || ret == DB_NOTFOUND);
@@ -3975,14 +4000,14 @@ BerkeleyDbFilesystem::get_next_id_i64(BDbTxn &txn, IdentifierType id_type, bool
   DbtManaged keym, datam;
   int ret;
   uint64_t retval=0;
-  Dbc *cursorp = 0;
-  HT_ON_SCOPE_EXIT(&close_db_cursor, &cursorp);
+  StateDbCursor *cursorp = 0;
+  HT_ON_SCOPE_EXIT(&close_state_db_cursor, &cursorp);
   char numbuf[17];
 
   HT_DEBUG_OUT <<"get_next_id_i64 txn="<< txn << " id_type=" << id_type << " increment="
                << increment << HT_END;
   try {
-    txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+    cursorp = txn.state_db->cursor(txn);
 
     // Get next id
     switch (id_type) {
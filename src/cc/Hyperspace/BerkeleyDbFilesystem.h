@@ -32,6 +32,7 @@
 
 #include <Hyperspace/DirEntry.h>
 #include <Hyperspace/DirEntryAttr.h>
+#include <Hyperspace/StateDb.h>
 #include <Hyperspace/StateDbKeys.h>
 
 #include <Common/DynamicBuffer.h>
@@ -192,12 +193,27 @@ namespace Hyperspace {
   class BDbTxn {
   public:
     /** Constructor. */
-    BDbTxn(): handle_namespace_db(0), handle_state_db(0), db_txn(0) {}
+    BDbTxn(): handle_namespace_db(0), handle_state_db(0), db_txn(0),
+              state_db(0) {}
+
+    BDbTxn(const BDbTxn &) = delete;
+    BDbTxn &operator=(const BDbTxn &) = delete;
+
+    /** Destructor.
+     * Rolls back state changes of a transaction that was neither committed
+     * nor aborted, releasing any lock held in #state_db.
+     */
+    ~BDbTxn() {
+      if (state_db && state_txn.locked)
+        state_db->abort(*this);
+    }
 
     /** Commit transaction.
      * @param flag BerkeleyDB commit flags
      */
     void commit(int flag=0) {
+      if (state_db)
+        state_db->commit(*this);
       db_txn->commit(flag);
       db_txn = 0;
     }
@@ -206,6 +222,8 @@ namespace Hyperspace {
     void abort() {
       db_txn->abort();
       db_txn = 0;
+      if (state_db)
+        state_db->abort(*this);
     }
 
     /// Filesystem namespace database handle
@@ -216,6 +234,12 @@ namespace Hyperspace {
 
     /// BerkeleyDB transaction object
     DbTxn *db_txn;
+
+    /// Transient state store
+    StateDb *state_db;
+
+    /// Transaction state kept by #state_db
+    StateDbTxnState state_txn;
   };
 
   /** Writes human-readable version of <code>txn</code> to an ostream.
@@ -823,6 +847,9 @@ namespace Hyperspace {
     uint32_t m_max_unused_logs;
     std::chrono::steady_clock::duration m_log_gc_interval;
     std::chrono::steady_clock::time_point m_last_log_gc_time;
+
+    /// Transient state store (from <code>Hyperspace.StateDb.Backend</code>)
+    std::unique_ptr<StateDb> m_state_db;
   };
 
   /** @} */
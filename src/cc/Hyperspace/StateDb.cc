@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Definitions for StateDb.
+ * This file contains definitions for StateDb, an interface to the store
+ * that holds transient Hyperspace state (sessions, handles, locks and
+ * events), and its BerkeleyDB and in-memory implementations.
+ */
+
+#include <Common/Compat.h>
+
+#include "StateDb.h"
+
+#include <Hyperspace/BerkeleyDbFilesystem.h>
+#include <Hyperspace/StateDbKeys.h>
+
+#include <Common/Logger.h>
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace Hyperspace;
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Returns the contents of a Dbt as a string.
+  inline String dbt_str(const Dbt *dbt) {
+    return String((const char *)dbt->get_data(), dbt->get_size());
+  }
+
+  /// Cursor over a BerkeleyDB database.
+  class StateDbBerkeleyCursor : public StateDbCursor {
+  public:
+    StateDbBerkeleyCursor(Dbc *cursor) : m_cursor(cursor) { }
+    virtual ~StateDbBerkeleyCursor() {
+      m_cursor->close();
+    }
+    int get(Dbt *key, Dbt *data, u_int32_t flags) override {
+      return m_cursor->get(key, data, flags);
+    }
+    int put(Dbt *key, Dbt *data, u_int32_t flags) override {
+      return m_cursor->put(key, data, flags);
+    }
+    int del(u_int32_t flags) override {
+      return m_cursor->del(flags);
+    }
+  private:
+    Dbc *m_cursor;
+  };
+
+}
+
+int StateDbBerkeley::get(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) {
+  return txn.handle_state_db->get(txn.db_txn, key, data, flags);
+}
+
+int StateDbBerkeley::put(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) {
+  return txn.handle_state_db->put(txn.db_txn, key, data, flags);
+}
+
+int StateDbBerkeley::del(BDbTxn &txn, Dbt *key, u_int32_t flags) {
+  return txn.handle_state_db->del(txn.db_txn, key, flags);
+}
+
+StateDbCursor *StateDbBerkeley::cursor(BDbTxn &txn) {
+  Dbc *cursorp = 0;
+  txn.handle_state_db->cursor(txn.db_txn, &cursorp, 0);
+  return new StateDbBerkeleyCursor(cursorp);
+}
+
+
+namespace Hyperspace {
+
+  /// Cursor over a StateDbMemory.
+  /// Positioned on a key and an index into its duplicate list.  Deleting
+  /// the current value leaves the cursor on the slot of the deleted value,
+  /// so that the next <code>DB_NEXT_DUP</code> returns the value that
+  /// followed it, as with BerkeleyDB.
+  class StateDbMemoryCursor : public StateDbCursor {
+  public:
+    StateDbMemoryCursor(StateDbMemory *db, BDbTxn &txn)
+      : m_db(db), m_txn(txn) { }
+
+    int get(Dbt *key, Dbt *data, u_int32_t flags) override {
+      if (flags == DB_NEXT_DUP) {
+        if (!m_positioned)
+          return DB_NOTFOUND;
+        auto iter = m_db->m_values.find(m_key);
+        size_t next = m_deleted ? m_index : m_index + 1;
+        if (iter == m_db->m_values.end() || next >= iter->second.size())
+          return DB_NOTFOUND;
+        m_index = next;
+        m_deleted = false;
+        StateDbMemory::copy_out(iter->second[m_index], data);
+        return 0;
+      }
+
+      String key_str = dbt_str(key);
+      auto iter = m_db->m_values.find(key_str);
+      if (iter == m_db->m_values.end())
+        return DB_NOTFOUND;
+
+      size_t index = 0;
+      if (flags == DB_GET_BOTH) {
+        String data_str = dbt_str(data);
+        for (index = 0; index < iter->second.size(); ++index)
+          if (iter->second[index] == data_str)
+            break;
+        if (index == iter->second.size())
+          return DB_NOTFOUND;
+      }
+      else
+        HT_ASSERT(flags == DB_SET);
+
+      m_key = key_str;
+      m_index = index;
+      m_positioned = true;
+      m_deleted = false;
+      if (flags == DB_SET)
+        StateDbMemory::copy_out(iter->second[m_index], data);
+      return 0;
+    }
+
+    int put(Dbt *key, Dbt *data, u_int32_t flags) override {
+      if (flags == DB_KEYLAST) {
+        String key_str = dbt_str(key);
+        m_db->save_undo(m_txn, key_str);
+        vector<String> &values = m_db->m_values[key_str];
+        values.push_back(dbt_str(data));
+        m_key = key_str;
+        m_index = values.size() - 1;
+        m_positioned = true;
+        m_deleted = false;
+        return 0;
+      }
+      HT_ASSERT(flags == DB_CURRENT);
+      if (!m_positioned || m_deleted)
+        return DB_KEYEMPTY;
+      m_db->save_undo(m_txn, m_key);
+      m_db->m_values[m_key][m_index] = dbt_str(data);
+      return 0;
+    }
+
+    int del(u_int32_t flags) override {
+      if (!m_positioned || m_deleted)
+        return DB_KEYEMPTY;
+      auto iter = m_db->m_values.find(m_key);
+      HT_ASSERT(iter != m_db->m_values.end() && m_index < iter->second.size());
+      m_db->save_undo(m_txn, m_key);
+      iter->second.erase(iter->second.begin() + m_index);
+      if (iter->second.empty())
+        m_db->m_values.erase(iter);
+      m_deleted = true;
+      return 0;
+    }
+
+  private:
+    StateDbMemory *m_db;
+    BDbTxn &m_txn;
+    String m_key;
+    size_t m_index {};
+    bool m_positioned {};
+    bool m_deleted {};
+  };
+
+}
+
+
+StateDbMemory::StateDbMemory() {
+  using namespace StateDbKeys;
+  m_values[String("/", 2)].push_back(String());
+  String one("1", 2);
+  m_values[NEXT_SESSION_ID + '\0'].push_back(one);
+  m_values[NEXT_HANDLE_ID + '\0'].push_back(one);
+  m_values[NEXT_EVENT_ID + '\0'].push_back(one);
+}
+
+void StateDbMemory::begin(BDbTxn &txn) {
+  m_mutex.lock();
+  txn.state_txn.locked = true;
+}
+
+void StateDbMemory::commit(BDbTxn &txn) {
+  txn.state_txn.undo.clear();
+  unlock(txn);
+}
+
+void StateDbMemory::abort(BDbTxn &txn) {
+  for (auto &entry : txn.state_txn.undo) {
+    if (entry.second.first)
+      m_values[entry.first].swap(entry.second.second);
+    else
+      m_values.erase(entry.first);
+  }
+  txn.state_txn.undo.clear();
+  unlock(txn);
+}
+
+int StateDbMemory::get(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) {
+  auto iter = m_values.find(dbt_str(key));
+  if (iter == m_values.end())
+    return DB_NOTFOUND;
+  copy_out(iter->second.front(), data);
+  return 0;
+}
+
+int StateDbMemory::put(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) {
+  String key_str = dbt_str(key);
+  if (flags == DB_NOOVERWRITE && m_values.count(key_str))
+    return DB_KEYEXIST;
+  save_undo(txn, key_str);
+  m_values[key_str].push_back(dbt_str(data));
+  return 0;
+}
+
+int StateDbMemory::del(BDbTxn &txn, Dbt *key, u_int32_t flags) {
+  String key_str = dbt_str(key);
+  auto iter = m_values.find(key_str);
+  if (iter == m_values.end())
+    return DB_NOTFOUND;
+  save_undo(txn, key_str);
+  m_values.erase(iter);
+  return 0;
+}
+
+StateDbCursor *StateDbMemory::cursor(BDbTxn &txn) {
+  return new StateDbMemoryCursor(this, txn);
+}
+
+void StateDbMemory::save_undo(BDbTxn &txn, const String &key) {
+  HT_ASSERT(txn.state_txn.locked);
+  if (txn.state_txn.undo.count(key))
+    return;
+  auto iter = m_values.find(key);
+  if (iter == m_values.end())
+    txn.state_txn.undo[key] = make_pair(false, vector<String>());
+  else
+    txn.state_txn.undo[key] = make_pair(true, iter->second);
+}
+
+void StateDbMemory::copy_out(const String &value, Dbt *data) {
+  if (data->get_flags() & DB_DBT_REALLOC) {
+    void *buf = realloc(data->get_data(), value.length() ? value.length() : 1);
+    HT_ASSERT(buf);
+    memcpy(buf, value.data(), value.length());
+    data->set_data(buf);
+  }
+  else
+    data->set_data((void *)value.data());
+  data->set_size(value.length());
+}
+
+void StateDbMemory::unlock(BDbTxn &txn) {
+  if (txn.state_txn.locked) {
+    txn.state_txn.locked = false;
+    m_mutex.unlock();
+  }
+}
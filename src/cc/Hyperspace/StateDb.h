@@ -0,0 +1,260 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/** @file
+ * Declarations for StateDb.
+ * This file contains declarations for StateDb, an interface to the store
+ * that holds transient Hyperspace state (sessions, handles, locks and
+ * events), and its BerkeleyDB and in-memory implementations.
+ */
+
+#ifndef Hyperspace_StateDb_h
+#define Hyperspace_StateDb_h
+
+#include <Common/String.h>
+
+#ifdef _MSC_VER
+#pragma warning( push )
+#pragma warning( disable : 4005 ) // 'off_t' : macro redefinition
+#endif
+
+#include <db_cxx.h>
+
+#ifdef _MSC_VER
+#pragma warning( pop )
+#endif
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Hyperspace {
+
+  using namespace Hypertable;
+
+  class BDbTxn;
+
+  /** @addtogroup Hyperspace
+   * @{
+   */
+
+  /// Per-transaction state kept by a StateDb implementation.
+  class StateDbTxnState {
+  public:
+
+    /// Map from key to its value list before the transaction first
+    /// modified it, with a flag indicating whether the key existed
+    typedef std::map<String, std::pair<bool, std::vector<String>>> UndoMap;
+
+    /// <i>true</i> if the transaction holds the store lock
+    bool locked {};
+
+    /// Undo log
+    UndoMap undo;
+  };
+
+  /** Cursor over a StateDb.
+   * Supports the subset of BerkeleyDB cursor operations used by
+   * BerkeleyDbFilesystem, with the same arguments and return codes.  The
+   * destructor closes the cursor.
+   */
+  class StateDbCursor {
+  public:
+
+    /// Destructor.
+    virtual ~StateDbCursor() { }
+
+    /** Positions cursor and fetches data.
+     * @param key Key
+     * @param data Data, input for <code>DB_GET_BOTH</code>
+     * @param flags One of <code>DB_SET</code>, <code>DB_GET_BOTH</code> or
+     * <code>DB_NEXT_DUP</code>
+     * @return 0 on success, <code>DB_NOTFOUND</code> otherwise
+     */
+    virtual int get(Dbt *key, Dbt *data, u_int32_t flags) = 0;
+
+    /** Stores data.
+     * @param key Key
+     * @param data Data
+     * @param flags <code>DB_CURRENT</code> to replace the data at the cursor
+     * position or <code>DB_KEYLAST</code> to append a duplicate for
+     * <code>key</code>
+     * @return 0 on success
+     */
+    virtual int put(Dbt *key, Dbt *data, u_int32_t flags) = 0;
+
+    /** Deletes the key/data pair at the cursor position.
+     * @param flags Must be 0
+     * @return 0 on success
+     */
+    virtual int del(u_int32_t flags) = 0;
+  };
+
+  /** Transient state store.
+   * Holds the keys defined in StateDbKeys, each of which may have an
+   * ordered list of duplicate values (BerkeleyDB <code>DB_DUP</code>
+   * semantics).  All operations run within the transaction of a BDbTxn,
+   * which calls begin() from BerkeleyDbFilesystem::start_transaction() and
+   * commit() or abort() when the transaction ends.
+   */
+  class StateDb {
+  public:
+
+    /// Destructor.
+    virtual ~StateDb() { }
+
+    /** Begins transaction.
+     * @param txn Transaction
+     */
+    virtual void begin(BDbTxn &txn) { }
+
+    /** Makes changes of transaction visible.
+     * Called before the BerkeleyDB transaction is committed.
+     * @param txn Transaction
+     */
+    virtual void commit(BDbTxn &txn) { }
+
+    /** Rolls back changes of transaction.
+     * Called after the BerkeleyDB transaction is aborted.
+     * @param txn Transaction
+     */
+    virtual void abort(BDbTxn &txn) { }
+
+    /** Fetches first value of key.
+     * @param txn Transaction
+     * @param key Key
+     * @param data Receives value
+     * @param flags Must be 0
+     * @return 0 on success, <code>DB_NOTFOUND</code> otherwise
+     */
+    virtual int get(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) = 0;
+
+    /** Stores value.
+     * @param txn Transaction
+     * @param key Key
+     * @param data Value appended as duplicate
+     * @param flags 0 or <code>DB_NOOVERWRITE</code>
+     * @return 0 on success, <code>DB_KEYEXIST</code> if
+     * <code>DB_NOOVERWRITE</code> is given and key exists
+     */
+    virtual int put(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) = 0;
+
+    /** Deletes key and all of its values.
+     * @param txn Transaction
+     * @param key Key
+     * @param flags Must be 0
+     * @return 0 on success, <code>DB_NOTFOUND</code> otherwise
+     */
+    virtual int del(BDbTxn &txn, Dbt *key, u_int32_t flags) = 0;
+
+    /** Opens cursor.
+     * @param txn Transaction
+     * @return Newly allocated cursor, to be deleted by caller before the
+     * transaction ends
+     */
+    virtual StateDbCursor *cursor(BDbTxn &txn) = 0;
+  };
+
+  /** %StateDb stored in the BerkeleyDB <code>state.db</code> database.
+   * Forwards every operation to <code>txn.handle_state_db</code>, so state
+   * is logged and replicated along with the namespace.
+   */
+  class StateDbBerkeley : public StateDb {
+  public:
+    int get(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) override;
+    int put(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) override;
+    int del(BDbTxn &txn, Dbt *key, u_int32_t flags) override;
+    StateDbCursor *cursor(BDbTxn &txn) override;
+  };
+
+  /** In-memory %StateDb.
+   * State is kept in an ordered map from key to duplicate list and never
+   * written to the BerkeleyDB log, which removes the page latching, lock
+   * table traffic and log writes of <code>state.db</code> from session,
+   * handle and lock operations.  This is safe because state is not
+   * recovered after a restart (the Master removes <code>state.db</code> at
+   * startup), but it is not replicated either, so the memory store is only
+   * used when Hyperspace runs without replicas.
+   *
+   * Transactions are serialized with a recursive mutex that begin()
+   * acquires before any BerkeleyDB lock is taken, so the store lock cannot
+   * take part in a deadlock cycle with the namespace database.  The first
+   * modification of each key saves its old values in the transaction's
+   * undo log, which abort() restores.  commit() releases the lock before
+   * the BerkeleyDB commit so that namespace log flushes of concurrent
+   * transactions can still be group committed.  Because the lock is held
+   * for the whole transaction, including its namespace database work,
+   * transactions run one at a time even when they touch unrelated
+   * sessions and nodes; <code>statedb_test</code> reports throughput with
+   * several threads next to the single-threaded figure.
+   */
+  class StateDbMemory : public StateDb {
+  public:
+
+    /** Constructor.
+     * Initializes the root key and the session, handle and event ID
+     * counters, as BerkeleyDbFilesystem does for <code>state.db</code>.
+     */
+    StateDbMemory();
+
+    void begin(BDbTxn &txn) override;
+    void commit(BDbTxn &txn) override;
+    void abort(BDbTxn &txn) override;
+    int get(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) override;
+    int put(BDbTxn &txn, Dbt *key, Dbt *data, u_int32_t flags) override;
+    int del(BDbTxn &txn, Dbt *key, u_int32_t flags) override;
+    StateDbCursor *cursor(BDbTxn &txn) override;
+
+  private:
+    friend class StateDbMemoryCursor;
+
+    /// Map from key to duplicate values in insertion order
+    typedef std::map<String, std::vector<String>> ValueMap;
+
+    /** Saves old values of key in undo log of transaction.
+     * Does nothing if the transaction has already modified the key.
+     * @param txn Transaction
+     * @param key Key about to be modified
+     */
+    void save_undo(BDbTxn &txn, const String &key);
+
+    /** Copies value into a Dbt.
+     * @param value Value
+     * @param data Destination
+     */
+    static void copy_out(const String &value, Dbt *data);
+
+    /// Releases store lock held by transaction.
+    void unlock(BDbTxn &txn);
+
+    /// Store contents
+    ValueMap m_values;
+
+    /// Store lock, held from begin() until commit() or abort()
+    std::recursive_mutex m_mutex;
+  };
+
+  /** @}*/
+
+}
+
+#endif // Hyperspace_StateDb_h
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hyperspace/BerkeleyDbFilesystem.h>
+
+#include <Common/Error.h>
+#include <Common/FileUtils.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+#include <Common/Properties.h>
+#include <Common/Random.h>
+#include <Common/String.h>
+#include <Common/System.h>
+#include <Common/Thread.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace Hyperspace;
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  const int NUM_SESSIONS = 2000;
+  const int NUM_THREADS = 8;
+  const String LOCK_NODE = "/lockfile";
+
+  /// Runs <code>func</code> in a transaction, retrying it after a
+  /// BerkeleyDB deadlock as the Master does.
+  template <typename Func>
+  void run_transaction(BerkeleyDbFilesystem *bdb_fs, Func func) {
+    while (true) {
+      BDbTxn txn;
+      bdb_fs->start_transaction(txn);
+      try {
+        func(txn);
+        txn.commit(0);
+        return;
+      }
+      catch (Exception &e) {
+        if (e.code() != Error::HYPERSPACE_BERKELEYDB_DEADLOCK)
+          throw;
+        txn.abort();
+        this_thread::sleep_for(Random::duration_millis(10));
+      }
+    }
+  }
+
+  /// Opens a session, opens a handle on <code>node</code>, and acquires and
+  /// releases an exclusive lock, each step in its own transaction as the
+  /// Master does.  Every other handle is closed again.
+  void lock_cycle(BerkeleyDbFilesystem *bdb_fs, const String &node, int i) {
+    uint64_t session_id, handle_id;
+    run_transaction(bdb_fs, [&](BDbTxn &txn) {
+        session_id = bdb_fs->get_next_id_i64(txn, SESSION, true);
+        bdb_fs->create_session(txn, session_id, "127.0.0.1:38040");
+      });
+    run_transaction(bdb_fs, [&](BDbTxn &txn) {
+        handle_id = bdb_fs->get_next_id_i64(txn, HANDLE, true);
+        bdb_fs->create_handle(txn, handle_id, node, 0, 0, session_id,
+                              false, 0);
+        bdb_fs->add_session_handle(txn, session_id, handle_id);
+        bdb_fs->add_node_handle(txn, node, handle_id);
+      });
+    run_transaction(bdb_fs, [&](BDbTxn &txn) {
+        bdb_fs->set_node_cur_lock_mode(txn, node, 2);
+        bdb_fs->set_node_exclusive_lock_handle(txn, node, handle_id);
+        bdb_fs->incr_node_lock_generation(txn, node);
+        bdb_fs->set_handle_locked(txn, handle_id, true);
+      });
+    run_transaction(bdb_fs, [&](BDbTxn &txn) {
+        bdb_fs->set_handle_locked(txn, handle_id, false);
+        bdb_fs->set_node_cur_lock_mode(txn, node, 0);
+        bdb_fs->set_node_exclusive_lock_handle(txn, node, 0);
+        if (i % 2) {
+          bdb_fs->delete_node_handle(txn, node, handle_id);
+          bdb_fs->delete_session_handle(txn, session_id, handle_id);
+          bdb_fs->delete_handle(txn, handle_id);
+        }
+      });
+  }
+
+  /// Runs #NUM_SESSIONS lock cycles on #LOCK_NODE from a single thread.
+  /// Returns a summary of the resulting state.
+  String run_workload(BerkeleyDbFilesystem *bdb_fs, double *ops_per_sec) {
+    ostringstream out;
+
+    run_transaction(bdb_fs, [&](BDbTxn &txn) {
+        bdb_fs->create_node(txn, LOCK_NODE);
+      });
+
+    auto start = chrono::steady_clock::now();
+    for (int i=0; i<NUM_SESSIONS; i++)
+      lock_cycle(bdb_fs, LOCK_NODE, i);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    *ops_per_sec = (4 * NUM_SESSIONS) / elapsed.count();
+
+    // Aborted changes must not be visible
+    {
+      BDbTxn txn;
+      bdb_fs->start_transaction(txn);
+      bdb_fs->incr_node_lock_generation(txn, LOCK_NODE);
+      bdb_fs->delete_session(txn, 1);
+      txn.abort();
+    }
+
+    BDbTxn txn;
+    bdb_fs->start_transaction(txn);
+    vector<uint64_t> handles;
+    bdb_fs->get_node_handles(txn, LOCK_NODE, handles);
+    out << "node handles: " << handles.size() << "\n";
+    out << "lock generation: "
+        << bdb_fs->incr_node_lock_generation(txn, LOCK_NODE) << "\n";
+    out << "lock mode: " << bdb_fs->get_node_cur_lock_mode(txn, LOCK_NODE)
+        << "\n";
+    out << "session 1 exists: " << bdb_fs->session_exists(txn, 1) << "\n";
+    handles.clear();
+    bdb_fs->get_session_handles(txn, 1, handles);
+    out << "session 1 handles: " << handles.size() << "\n";
+    out << "handle 2 exists: " << bdb_fs->handle_exists(txn, 2) << "\n";
+    out << "next session id: "
+        << bdb_fs->get_next_id_i64(txn, SESSION) << "\n";
+    out << "next handle id: " << bdb_fs->get_next_id_i64(txn, HANDLE) << "\n";
+    txn.commit(0);
+    return out.str();
+  }
+
+  /// Lock cycle benchmark run from several threads.
+  /// The threads are created first, so that their IDs can be passed to the
+  /// BerkeleyDbFilesystem constructor, and wait until run() is called.
+  class ConcurrentWorkload {
+  public:
+    ConcurrentWorkload() : m_bdb_fs(m_start.get_future().share()) {
+      for (int t=0; t<NUM_THREADS; t++)
+        m_thread_ids.push_back(m_threads.create_thread([this, t]() {
+              worker(t); })->get_id());
+    }
+
+    ~ConcurrentWorkload() {
+      if (!m_started)
+        m_start.set_value(nullptr);
+      m_threads.join_all();
+    }
+
+    const vector<Thread::id> &thread_ids() { return m_thread_ids; }
+
+    /// Runs #NUM_SESSIONS lock cycles split across #NUM_THREADS threads,
+    /// each on its own node.  Returns a summary of the resulting state.
+    String run(BerkeleyDbFilesystem *bdb_fs, double *ops_per_sec) {
+      ostringstream out;
+
+      for (int t=0; t<NUM_THREADS; t++)
+        run_transaction(bdb_fs, [&](BDbTxn &txn) {
+            bdb_fs->create_node(txn, node_name(t));
+          });
+
+      auto start = chrono::steady_clock::now();
+      m_started = true;
+      m_start.set_value(bdb_fs);
+      m_threads.join_all();
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      *ops_per_sec = (4 * NUM_SESSIONS) / elapsed.count();
+      if (m_failed)
+        HT_THROW(Error::FAILED_EXPECTATION, "Concurrent workload failed");
+
+      BDbTxn txn;
+      bdb_fs->start_transaction(txn);
+      for (int t=0; t<NUM_THREADS; t++) {
+        String node = node_name(t);
+        vector<uint64_t> handles;
+        bdb_fs->get_node_handles(txn, node, handles);
+        out << node << " handles: " << handles.size()
+            << ", lock generation: "
+            << bdb_fs->incr_node_lock_generation(txn, node) << "\n";
+      }
+      out << "next session id: "
+          << bdb_fs->get_next_id_i64(txn, SESSION) << "\n";
+      out << "next handle id: " << bdb_fs->get_next_id_i64(txn, HANDLE)
+          << "\n";
+      txn.commit(0);
+      return out.str();
+    }
+
+  private:
+
+    static String node_name(int t) {
+      return format("%s%d", LOCK_NODE.c_str(), t);
+    }
+
+    void worker(int t) {
+      BerkeleyDbFilesystem *bdb_fs = m_bdb_fs.get();
+      if (!bdb_fs)
+        return;
+      try {
+        for (int i=0; i<NUM_SESSIONS/NUM_THREADS; i++)
+          lock_cycle(bdb_fs, node_name(t), i);
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << "Thread " << t << ": " << e << HT_END;
+        m_failed = true;
+      }
+    }
+
+    promise<BerkeleyDbFilesystem *> m_start;
+    shared_future<BerkeleyDbFilesystem *> m_bdb_fs;
+    ThreadGroup m_threads;
+    vector<Thread::id> m_thread_ids;
+    bool m_started {};
+    atomic<bool> m_failed {false};
+  };
+
+}
+
+int main(int argc, char **argv) {
+  int ret = 0;
+  init_with_policy<DefaultPolicy>(argc, argv);
+
+  System::initialize(System::locate_install_dir(argv[0]));
+
+  vector<String> results;
+
+  for (const char *backend : { "bdb", "memory" }) {
+#ifndef _WIN32
+    String dir = format("/tmp/statedb_test%d_%s", (int)System::get_pid(),
+                        backend);
+#else
+    String dir = format("./tmp/statedb_test%d_%s", (int)System::get_pid(),
+                        backend);
+#endif
+    FileUtils::mkdirs(dir);
+
+    PropertiesPtr props = make_shared<Properties>();
+    props->set("Hyperspace.Checkpoint.Size", 1000000);
+    props->set("Hyperspace.LogGc.Interval", 3600000);
+    props->set("Hyperspace.LogGc.MaxUnusedLogs", 200);
+    props->set("Hyperspace.StateDb.Backend", String(backend));
+
+    try {
+      ConcurrentWorkload concurrent;
+      vector<Thread::id> thread_ids = concurrent.thread_ids();
+      thread_ids.push_back(ThisThread::get_id());
+
+      BerkeleyDbFilesystem *bdb_fs =
+        new BerkeleyDbFilesystem(props, dir, thread_ids);
+      double ops_per_sec, concurrent_ops_per_sec;
+      String result = run_workload(bdb_fs, &ops_per_sec);
+      result += concurrent.run(bdb_fs, &concurrent_ops_per_sec);
+      results.push_back(result);
+      cout << backend << ": " << (int64_t)ops_per_sec
+           << " session/handle/lock transactions per second, "
+           << (int64_t)concurrent_ops_per_sec << " with " << NUM_THREADS
+           << " threads" << endl;
+      delete bdb_fs;
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << backend << ": " << e << HT_END;
+      ret = 1;
+    }
+
+    HT_ASSERT(FileUtils::rmdirs(dir));
+  }
+
+  if (ret == 0) {
+    if (results[0] != results[1]) {
+      cout << "State mismatch\nbdb:\n" << results[0] << "memory:\n"
+           << results[1] << flush;
+      ret = 1;
+    }
+    else
+      cout << results[0] << flush;
+  }
+
+  return ret;
+}
@@ -111,8 +111,10 @@ namespace Hypertable {
     ///   bmz [--fp-len &lt;int&gt;] [--offset &lt;int&gt;]
     ///   lzo
     ///   quicklz
-    ///   zlib [--best|--9|--normal]
+    ///   zlib [--best|--9|--normal|--fast|--level &lt;int&gt;]
     ///   snappy
+    ///   zstd [--best|--normal|--fast|--level &lt;int&gt;]
+    ///        [--dictionary-size &lt;int&gt;]
     ///   none
     /// </pre>
     /// @param compressor Compressor specification
@@ -56,12 +56,16 @@ namespace Hypertable {
       LZO=3,      ///< LZO compression
       QUICKLZ=4,  ///< QuickLZ 1.5 compession
       SNAPPY=5,   ///< Snappy compression
-      COMPRESSION_TYPE_LIMIT=6  ///< Limit of compression types
+      ZSTD=6,     ///< Zstandard compression
+      COMPRESSION_TYPE_LIMIT=7  ///< Limit of compression types
     };
 
     /// Compression codec argument vector.
     typedef std::vector<String> Args;
 
+    /// Smart pointer to an immutable compression dictionary.
+    typedef std::shared_ptr<const String> DictionaryPtr;
+
     /// Returns string mnemonic for compression type.
     /// @param algo Compression type (see BlockCompressionCodec::Type)
     /// @return %String mnemonic representing name of compression algorithm
@@ -97,6 +101,37 @@ namespace Hypertable {
                   arg.c_str());
     }
 
+    /// Returns size of dictionary the codec would like trained.
+    /// Codecs that can make use of a shared compression dictionary return the
+    /// target dictionary size requested through their arguments, in which case
+    /// the writer is expected to call train_dictionary() with a sample of the
+    /// data and hand the result to set_dictionary().  This default
+    /// implementation returns 0 (no dictionary support).
+    /// @return Requested dictionary size in bytes, or 0
+    virtual size_t get_dictionary_size() { return 0; }
+
+    /// Trains a compression dictionary.
+    /// @param samples Concatenated sample buffers
+    /// @param sizes Sizes of the individual samples in <code>samples</code>
+    /// @return Trained dictionary, or an empty pointer if the codec does not
+    /// support dictionaries or training failed
+    virtual DictionaryPtr train_dictionary(const uint8_t *samples,
+                                           const std::vector<size_t> &sizes) {
+      return DictionaryPtr();
+    }
+
+    /// Sets dictionary to use for subsequent deflate() and inflate() calls.
+    /// A block compressed with a dictionary can only be inflated by a codec
+    /// given the same dictionary.  This default implementation accepts an
+    /// empty dictionary and throws for anything else.
+    /// @param dictionary Dictionary returned by train_dictionary()
+    /// @throws Exception Code set to Error::BLOCK_COMPRESSOR_INVALID_ARG
+    virtual void set_dictionary(DictionaryPtr dictionary) {
+      if (dictionary && !dictionary->empty())
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "%s codec does not "
+                  "support dictionaries", get_compressor_name(get_type()));
+    }
+
     /// Returns compression type enum.
     /// Returns the enum value that represents the compressoion type
     /// @see BlockCompressionCodec::Type
@@ -45,8 +45,9 @@ BlockCompressionCodecNone::deflate(const DynamicBuffer &input,
   memcpy(output.base+header.encoded_length(), input.base, input.fill());
   header.set_data_length(input.fill());
   header.set_data_zlength(input.fill());
-  header.set_data_checksum(fletcher32(output.base + header.encoded_length(),
-                           header.get_data_zlength()));
+  header.set_data_checksum(
+      header.compute_data_checksum(output.base + header.encoded_length(),
+                                   header.get_data_zlength()));
 
   output.ptr = output.base;
   header.encode(&output.ptr);
@@ -68,7 +69,8 @@ BlockCompressionCodecNone::inflate(const DynamicBuffer &input,
               "header zlength = %lu, actual = %lu",
               (Lu)header.get_data_zlength(), (Lu)remaining);
 
-  uint32_t checksum = fletcher32(msg_ptr, header.get_data_zlength());
+  uint32_t checksum =
+    header.compute_data_checksum(msg_ptr, header.get_data_zlength());
   if (checksum != header.get_data_checksum())
     HT_THROWF(Error::BLOCK_COMPRESSOR_CHECKSUM_MISMATCH, "Compressed block "
               "checksum mismatch header=%lx, computed=%lx",
@@ -48,24 +48,29 @@ void BlockCompressionCodecZlib::set_args(const Args &args) {
   Args::const_iterator it = args.begin(), arg_end = args.end();
 
   for (; it != arg_end; ++it) {
-    if (*it == "--best" || *it == "-9") {
-      m_level = Z_BEST_COMPRESSION;
-      if (m_deflate_initialized) {
-        deflateEnd(&m_stream_deflate);
-        m_deflate_initialized = false;
-      }
-    }
-    else if (*it == "--normal") {
-      m_level = Z_DEFAULT_COMPRESSION;
-      if (m_deflate_initialized) {
-        deflateEnd(&m_stream_deflate);
-        m_deflate_initialized = false;
-      }
-    }
+    int level;
+    if (*it == "--best" || *it == "-9")
+      level = Z_BEST_COMPRESSION;
+    else if (*it == "--fast")
+      level = Z_BEST_SPEED;
+    else if (*it == "--normal")
+      level = Z_DEFAULT_COMPRESSION;
+    else if (it->size() == 2 && (*it)[0] == '-' &&
+             (*it)[1] >= '1' && (*it)[1] <= '9')
+      level = (*it)[1] - '0';
+    else if (*it == "--level" && it + 1 != arg_end &&
+             (it + 1)->size() == 1 && (*(it + 1))[0] >= '1' &&
+             (*(it + 1))[0] <= '9')
+      level = (*++it)[0] - '0';
     else {
       HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unrecognized argument "
                 "to Zlib codec: '%s'", (*it).c_str());
     }
+    m_level = level;
+    if (m_deflate_initialized) {
+      deflateEnd(&m_stream_deflate);
+      m_deflate_initialized = false;
+    }
   }
 }
 
@@ -114,8 +119,9 @@ BlockCompressionCodecZlib::deflate(const DynamicBuffer &input,
     header.set_data_zlength(zlen);
   }
 
-  header.set_data_checksum(fletcher32(output.base + header.encoded_length(),
-                           header.get_data_zlength()));
+  header.set_data_checksum(
+      header.compute_data_checksum(output.base + header.encoded_length(),
+                                   header.get_data_zlength()));
 
   deflateReset(&m_stream_deflate);
 
@@ -155,7 +161,8 @@ BlockCompressionCodecZlib::inflate(const DynamicBuffer &input,
               "header zlength = %lu, actual = %lu",
               (Lu)header.get_data_zlength(), (Lu)remaining);
 
-  uint32_t checksum = fletcher32(msg_ptr, header.get_data_zlength());
+  uint32_t checksum =
+    header.compute_data_checksum(msg_ptr, header.get_data_zlength());
 
   if (checksum != header.get_data_checksum())
     HT_THROWF(Error::BLOCK_COMPRESSOR_CHECKSUM_MISMATCH, "Compressed block "
@@ -57,12 +57,20 @@ namespace Hypertable {
     /// <th>Argument</th><th>Description</th>
     /// </tr>
     /// <tr>
-    /// <td><code>--best</code> or <code>--9</code> </td><td>Best compression
+    /// <td><code>--best</code> or <code>-9</code> </td><td>Best compression
     /// ratio</td>
     /// </tr>
     /// <tr>
     /// <td><code>--normal</code> </td><td>Normal compression ratio</td>
     /// </tr>
+    /// <tr>
+    /// <td><code>--fast</code> or <code>-1</code> </td><td>Fastest
+    /// compression (default)</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>-2</code> ... <code>-8</code> or <code>--level N</code>
+    /// </td><td>Explicit compression level, trading speed for ratio</td>
+    /// </tr>
     /// </table>
     /// @param args Vector of arguments
     virtual void set_args(const Args &args);
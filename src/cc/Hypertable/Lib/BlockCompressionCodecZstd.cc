@@ -0,0 +1,264 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for BlockCompressionCodecZstd.
+/// This file contains definitions for BlockCompressionCodecZstd, a class for
+/// compressing blocks using the Zstandard compression algorithm.
+
+#include <Common/Compat.h>
+
+#include "BlockCompressionCodecZstd.h"
+
+#include <Common/DynamicBuffer.h>
+#include <Common/Logger.h>
+
+#include <zdict.h>
+
+#include <cerrno>
+#include <cstdlib>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Parses an integer codec argument.
+  long parse_number(const String &arg, const char *str, long min, long max) {
+    char *end;
+    errno = 0;
+    long value = strtol(str, &end, 10);
+    if (*str == 0 || *end != 0 || errno != 0 || value < min || value > max)
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Invalid argument "
+                "to zstd codec: '%s'", arg.c_str());
+    return value;
+  }
+
+}
+
+
+BlockCompressionCodecZstd::BlockCompressionCodecZstd(const Args &args) {
+  set_args(args);
+}
+
+
+BlockCompressionCodecZstd::~BlockCompressionCodecZstd() {
+  free_cdict();
+  if (m_ddict)
+    ZSTD_freeDDict(m_ddict);
+  if (m_cctx)
+    ZSTD_freeCCtx(m_cctx);
+  if (m_dctx)
+    ZSTD_freeDCtx(m_dctx);
+}
+
+
+void BlockCompressionCodecZstd::set_args(const Args &args) {
+  long max_level = ZSTD_maxCLevel();
+
+  for (auto it = args.begin(); it != args.end(); ++it) {
+    int level = m_level;
+    if (*it == "--fast")
+      level = 1;
+    else if (*it == "--normal")
+      level = ZSTD_CLEVEL_DEFAULT;
+    else if (*it == "--best")
+      level = 19;
+    else if (*it == "--level" || *it == "--dictionary-size") {
+      if (it + 1 == args.end())
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Missing value for "
+                  "zstd codec argument '%s'", it->c_str());
+      const String &name = *it++;
+      if (name == "--level")
+        level = (int)parse_number(*it, it->c_str(), 1, max_level);
+      else
+        m_dictionary_size =
+          (size_t)parse_number(*it, it->c_str(), 0, 16*1024*1024);
+    }
+    else if (it->size() >= 2 && (*it)[0] == '-' && isdigit((*it)[1]))
+      level = (int)parse_number(*it, it->c_str() + 1, 1, max_level);
+    else
+      HT_THROWF(Error::BLOCK_COMPRESSOR_INVALID_ARG, "Unrecognized argument "
+                "to zstd codec: '%s'", it->c_str());
+
+    if (level != m_level) {
+      m_level = level;
+      free_cdict();
+    }
+  }
+}
+
+
+void
+BlockCompressionCodecZstd::deflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header, size_t reserve) {
+  size_t bound = ZSTD_compressBound(input.fill());
+
+  if (m_cctx == 0 && (m_cctx = ZSTD_createCCtx()) == 0)
+    HT_THROW(Error::BLOCK_COMPRESSOR_INIT_ERROR, "ZSTD_createCCtx() failed");
+
+  if (m_dictionary && m_cdict == 0) {
+    m_cdict = ZSTD_createCDict(m_dictionary->data(), m_dictionary->size(),
+                               m_level);
+    if (m_cdict == 0)
+      HT_THROW(Error::BLOCK_COMPRESSOR_INIT_ERROR, "ZSTD_createCDict() failed");
+  }
+
+  output.clear();
+  output.reserve(header.encoded_length() + bound + reserve);
+
+  uint8_t *dst = output.base + header.encoded_length();
+  size_t zlen;
+  if (m_cdict)
+    zlen = ZSTD_compress_usingCDict(m_cctx, dst, bound, input.base,
+                                    input.fill(), m_cdict);
+  else
+    zlen = ZSTD_compressCCtx(m_cctx, dst, bound, input.base, input.fill(),
+                             m_level);
+
+  if (ZSTD_isError(zlen))
+    HT_THROWF(Error::BLOCK_COMPRESSOR_DEFLATE_ERROR, "Compressed block "
+              "deflate error - %s", ZSTD_getErrorName(zlen));
+
+  /* check for an incompressible block */
+  if (zlen >= input.fill()) {
+    header.set_compression_type(NONE);
+    memcpy(dst, input.base, input.fill());
+    header.set_data_length(input.fill());
+    header.set_data_zlength(input.fill());
+  }
+  else {
+    header.set_compression_type(ZSTD);
+    header.set_data_length(input.fill());
+    header.set_data_zlength(zlen);
+  }
+
+  header.set_data_checksum(
+      header.compute_data_checksum(dst, header.get_data_zlength()));
+
+  output.ptr = output.base;
+  header.encode(&output.ptr);
+  output.ptr += header.get_data_zlength();
+}
+
+
+void
+BlockCompressionCodecZstd::inflate(const DynamicBuffer &input,
+    DynamicBuffer &output, BlockHeader &header) {
+  const uint8_t *msg_ptr = input.base;
+  size_t remaining = input.fill();
+
+  header.decode(&msg_ptr, &remaining);
+
+  if (header.get_data_zlength() > remaining)
+    HT_THROWF(Error::BLOCK_COMPRESSOR_BAD_HEADER, "Block decompression error, "
+              "header zlength = %lu, actual = %lu",
+              (Lu)header.get_data_zlength(), (Lu)remaining);
+
+  uint32_t checksum =
+    header.compute_data_checksum(msg_ptr, header.get_data_zlength());
+
+  if (checksum != header.get_data_checksum())
+    HT_THROWF(Error::BLOCK_COMPRESSOR_CHECKSUM_MISMATCH, "Compressed block "
+              "checksum mismatch header=%lx, computed=%lx",
+              (Lu)header.get_data_checksum(), (Lu)checksum);
+
+  try {
+    output.reserve(header.get_data_length());
+
+    // check compress bit
+    if (header.get_compression_type() == NONE)
+      memcpy(output.base, msg_ptr, header.get_data_length());
+    else {
+      if (m_dctx == 0 && (m_dctx = ZSTD_createDCtx()) == 0)
+        HT_THROW(Error::BLOCK_COMPRESSOR_INIT_ERROR,
+                 "ZSTD_createDCtx() failed");
+      size_t len;
+      if (m_ddict)
+        len = ZSTD_decompress_usingDDict(m_dctx, output.base,
+                                         header.get_data_length(), msg_ptr,
+                                         header.get_data_zlength(), m_ddict);
+      else
+        len = ZSTD_decompressDCtx(m_dctx, output.base,
+                                  header.get_data_length(), msg_ptr,
+                                  header.get_data_zlength());
+      if (ZSTD_isError(len))
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                  "inflate error - %s", ZSTD_getErrorName(len));
+      if (len != header.get_data_length())
+        HT_THROWF(Error::BLOCK_COMPRESSOR_INFLATE_ERROR, "Compressed block "
+                  "inflate error, expected %lu but only inflated to %lu bytes",
+                  (Lu)header.get_data_length(), (Lu)len);
+    }
+
+    output.ptr = output.base + header.get_data_length();
+  }
+  catch (Exception &) {
+    output.free();
+    throw;
+  }
+}
+
+
+BlockCompressionCodec::DictionaryPtr
+BlockCompressionCodecZstd::train_dictionary(const uint8_t *samples,
+                                            const vector<size_t> &sizes) {
+  if (m_dictionary_size == 0 || sizes.empty())
+    return DictionaryPtr();
+
+  String dictionary(m_dictionary_size, '\0');
+  size_t len = ZDICT_trainFromBuffer(&dictionary[0], dictionary.size(),
+                                     samples, sizes.data(),
+                                     (unsigned)sizes.size());
+  if (ZDICT_isError(len)) {
+    HT_INFOF("Unable to train zstd dictionary from %u samples - %s",
+             (unsigned)sizes.size(), ZDICT_getErrorName(len));
+    return DictionaryPtr();
+  }
+  dictionary.resize(len);
+  return make_shared<const String>(move(dictionary));
+}
+
+
+void BlockCompressionCodecZstd::set_dictionary(DictionaryPtr dictionary) {
+  free_cdict();
+  if (m_ddict) {
+    ZSTD_freeDDict(m_ddict);
+    m_ddict = 0;
+  }
+  m_dictionary.reset();
+
+  if (!dictionary || dictionary->empty())
+    return;
+
+  m_ddict = ZSTD_createDDict(dictionary->data(), dictionary->size());
+  if (m_ddict == 0)
+    HT_THROW(Error::BLOCK_COMPRESSOR_INIT_ERROR, "ZSTD_createDDict() failed");
+  m_dictionary = dictionary;
+}
+
+
+void BlockCompressionCodecZstd::free_cdict() {
+  if (m_cdict) {
+    ZSTD_freeCDict(m_cdict);
+    m_cdict = 0;
+  }
+}
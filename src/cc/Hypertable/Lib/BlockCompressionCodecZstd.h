@@ -0,0 +1,177 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for BlockCompressionCodecZstd.
+/// This file contains declarations for BlockCompressionCodecZstd, a class for
+/// compressing blocks using the Zstandard compression algorithm.
+
+#ifndef Hypertable_Lib_BlockCompressionCodecZstd_h
+#define Hypertable_Lib_BlockCompressionCodecZstd_h
+
+#include <Hypertable/Lib/BlockCompressionCodec.h>
+
+#include <zstd.h>
+
+namespace Hypertable {
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  /// Block compressor that uses the Zstandard algorithm.
+  /// This class provides a way to compress and decompress blocks of data using
+  /// the <i>zstd</i> algorithm, which at its low levels compresses at speeds
+  /// close to snappy while achieving ratios closer to zlib.  Small, repetitive
+  /// blocks compress considerably better when a dictionary trained on
+  /// representative data is installed with set_dictionary().
+  class BlockCompressionCodecZstd : public BlockCompressionCodec {
+
+  public:
+
+    /// Constructor.
+    /// @param args Arguments to control compression behavior
+    /// @throws Exception Code set to Error::BLOCK_COMPRESSOR_INVALID_ARG
+    BlockCompressionCodecZstd(const Args &args);
+
+    /// Destructor.
+    /// Frees the compression and decompression contexts and dictionaries.
+    virtual ~BlockCompressionCodecZstd();
+
+    /// Sets arguments to control compression behavior.
+    /// The arguments accepted by this method are described in the following
+    /// table.
+    /// <table>
+    /// <tr>
+    /// <th>Argument</th><th>Description</th>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--fast</code> </td><td>Fastest compression (level 1)</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--normal</code> </td><td>Normal compression (level 3,
+    /// default)</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--best</code> </td><td>Best compression ratio (level
+    /// 19)</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>-1</code> ... <code>-22</code> or <code>--level N</code>
+    /// </td><td>Explicit compression level</td>
+    /// </tr>
+    /// <tr>
+    /// <td><code>--dictionary-size N</code> </td><td>Size of dictionary to
+    /// train for each CellStore written by a major compaction (0 disables,
+    /// default)</td>
+    /// </tr>
+    /// </table>
+    /// @param args Vector of arguments
+    /// @throws Exception Code set to Error::BLOCK_COMPRESSOR_INVALID_ARG
+    virtual void set_args(const Args &args);
+
+    /// Compresses a buffer using the zstd algorithm.
+    /// If a dictionary has been installed, it is used to compress the block.
+    /// If the resulting compressed buffer is larger than the input buffer,
+    /// then the input buffer is copied directly to the output buffer and the
+    /// compression type is set to BlockCompressionCodec::NONE.  The output
+    /// buffer is formatted as follows:
+    /// <table>
+    /// <tr>
+    /// <td>header</td><td>compressed data</td><td>reserve</td>
+    /// </tr>
+    /// </table>
+    /// @param input Input buffer
+    /// @param output Output buffer
+    /// @param header Block header populated by function
+    /// @param reserve Additional space to reserve at end of <code>output</code>
+    ///   buffer
+    /// @throws Exception Code set to Error::BLOCK_COMPRESSOR_DEFLATE_ERROR
+    virtual void deflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockHeader &header, size_t reserve=0);
+
+    /// Decompresses a buffer compressed with the zstd algorithm.
+    /// Blocks compressed with a dictionary require the same dictionary to
+    /// have been installed with set_dictionary().
+    /// @see deflate() for description of input buffer %format
+    /// @param input Input buffer
+    /// @param output Output buffer
+    /// @param header Block header
+    virtual void inflate(const DynamicBuffer &input, DynamicBuffer &output,
+                         BlockHeader &header);
+
+    /// Returns size of dictionary requested with <code>--dictionary-size</code>.
+    /// @return Requested dictionary size in bytes, or 0
+    virtual size_t get_dictionary_size() { return m_dictionary_size; }
+
+    /// Trains a dictionary of get_dictionary_size() bytes.
+    /// Training fails (and an empty pointer is returned) if the samples do
+    /// not contain enough data or are too uniform to produce a dictionary.
+    /// @param samples Concatenated sample buffers
+    /// @param sizes Sizes of the individual samples in <code>samples</code>
+    /// @return Trained dictionary, or an empty pointer
+    virtual DictionaryPtr train_dictionary(const uint8_t *samples,
+                                           const std::vector<size_t> &sizes);
+
+    /// Installs dictionary for subsequent deflate() and inflate() calls.
+    /// Passing an empty pointer removes the current dictionary.
+    /// @param dictionary Dictionary to install
+    /// @throws Exception Code set to Error::BLOCK_COMPRESSOR_INIT_ERROR if the
+    /// dictionary cannot be loaded
+    virtual void set_dictionary(DictionaryPtr dictionary);
+
+    /// Returns enum value representing compression type ZSTD.
+    /// Returns the enum value ZSTD
+    /// @see BlockCompressionCodec::ZSTD
+    /// @return Compression type (ZSTD)
+    virtual int get_type() { return ZSTD; }
+
+  private:
+
+    /// Frees compression dictionary
+    void free_cdict();
+
+    /// Compression context
+    ZSTD_CCtx *m_cctx {};
+
+    /// Decompression context
+    ZSTD_DCtx *m_dctx {};
+
+    /// Compression dictionary digested for #m_level
+    ZSTD_CDict *m_cdict {};
+
+    /// Decompression dictionary
+    ZSTD_DDict *m_ddict {};
+
+    /// Installed dictionary
+    DictionaryPtr m_dictionary;
+
+    /// Compression level
+    int m_level {3};
+
+    /// Requested dictionary size
+    size_t m_dictionary_size {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_Lib_BlockCompressionCodecZstd_h
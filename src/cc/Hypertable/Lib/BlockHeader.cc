@@ -45,6 +45,8 @@ namespace {
   const size_t VersionLengths[BlockHeader::LatestVersion+1] = { 26, 28 };
 }
 
+bool BlockHeader::use_crc32c = false;
+
 BlockHeader::BlockHeader(uint16_t version, const char *magic) :
   m_flags(0), m_data_length(0), m_data_zlength(0), m_data_checksum(0),
   m_compression_type((uint16_t)-1), m_version(version) {
@@ -53,6 +55,15 @@ BlockHeader::BlockHeader(uint16_t version, const char *magic) :
     memcpy(m_magic, magic, 10);
   else
     memset(m_magic, 0, 10);
+  if (m_version != 0 && use_crc32c)
+    m_flags |= FLAG_CRC32C;
+}
+
+
+uint32_t BlockHeader::compute_data_checksum(const void *data, size_t len) {
+  if (m_version != 0 && (m_flags & FLAG_CRC32C))
+    return crc32c(data, len);
+  return fletcher32(data, len);
 }
 
 
@@ -51,6 +51,20 @@ namespace Hypertable {
 
     enum { LatestVersion = 1 };
 
+    /// Header flag bits (version 1 and above)
+    enum Flags {
+      /// Data checksum is CRC-32C instead of fletcher32
+      FLAG_CRC32C = 0x0001
+    };
+
+    /** Selects the data checksum algorithm for new blocks.
+     * When set to <i>true</i>, newly constructed headers of version 1 or
+     * above get the #FLAG_CRC32C flag set so that blocks are written with a
+     * CRC-32C data checksum.  Headers read from disk carry their own flag,
+     * so blocks written with fletcher32 remain verifiable either way.
+     */
+    static bool use_crc32c;
+
     /** Constructor.
      * Initializes #m_version to <code>version</code>, #m_magic with the first
      * ten bytes of <code>magic</code>, and initializes all other members to
@@ -106,7 +120,8 @@ namespace Hypertable {
     uint32_t get_data_zlength() { return m_data_zlength; }
 
     /** Sets the checksum field.
-     * The checksum field stores the fletcher32 checksum of the compressed data
+     * The checksum field stores the checksum of the compressed data computed
+     * with compute_data_checksum()
      * @param checksum Checksum of compressed data
      */
     void
@@ -117,6 +132,17 @@ namespace Hypertable {
      */
     uint32_t get_data_checksum() { return m_data_checksum; }
 
+    /** Computes checksum of block data.
+     * Computes the checksum of <code>data</code> with the algorithm selected
+     * by the #FLAG_CRC32C flag, which is crc32c() if the flag is set and
+     * fletcher32() otherwise (always for version 0 headers).  Codecs use this
+     * method to compute and verify the data checksum field.
+     * @param data Pointer to (possibly compressed) block data
+     * @param len Length of block data
+     * @return Checksum of <code>data</code>
+     */
+    uint32_t compute_data_checksum(const void *data, size_t len);
+
     /** Sets the compression type field.
      * @param type Compression type (see BlockCompressionCodec::Type)
      */
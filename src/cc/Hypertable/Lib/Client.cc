@@ -39,6 +39,7 @@
 #include <Common/Error.h>
 #include <Common/InetAddr.h>
 #include <Common/Logger.h>
+#include <Common/RequestTrace.h>
 #include <Common/ScopeGuard.h>
 #include <Common/System.h>
 #include <Common/Timer.h>
@@ -240,6 +241,8 @@ void Client::initialize_with_hyperspace() {
   if (m_timeout_ms == 0)
     m_timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
 
+  RequestTrace::set_sampling(m_props->get_i32("Hypertable.Request.Trace.Sampling"));
+
   if (m_connection_timeout_ms == 0)
     m_connection_timeout_ms = m_timeout_ms;
 
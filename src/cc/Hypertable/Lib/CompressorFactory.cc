@@ -31,6 +31,7 @@
 #include <Hypertable/Lib/BlockCompressionCodecLzo.h>
 #include <Hypertable/Lib/BlockCompressionCodecQuicklz.h>
 #include <Hypertable/Lib/BlockCompressionCodecSnappy.h>
+#include <Hypertable/Lib/BlockCompressionCodecZstd.h>
 
 #include <boost/algorithm/string.hpp>
 
@@ -43,7 +44,10 @@ CompressorFactory::parse_block_codec_spec(const std::string &spec,
                                           BlockCompressionCodec::Args &args) {
   string name;
 
-  split(args, spec, is_any_of(" \t"), token_compress_on);
+  args.clear();
+  string trimmed = trim_copy_if(spec, is_any_of(" \t"));
+  if (!trimmed.empty())
+    split(args, trimmed, is_any_of(" \t"), token_compress_on);
 
   if (!args.empty()) {
     name = args.front();
@@ -68,6 +72,9 @@ CompressorFactory::parse_block_codec_spec(const std::string &spec,
   if (name == "snappy")
     return BlockCompressionCodec::SNAPPY;
 
+  if (name == "zstd")
+    return BlockCompressionCodec::ZSTD;
+
   HT_ERRORF("unknown codec type: %s", name.c_str());
   return BlockCompressionCodec::UNKNOWN;
 }
@@ -88,6 +95,8 @@ CompressorFactory::create_block_codec(BlockCompressionCodec::Type type,
     return new BlockCompressionCodecQuicklz(args);
   case BlockCompressionCodec::SNAPPY:
     return new BlockCompressionCodecSnappy(args);
+  case BlockCompressionCodec::ZSTD:
+    return new BlockCompressionCodecZstd(args);
   default:
     HT_THROWF(Error::BLOCK_COMPRESSOR_UNSUPPORTED_TYPE, "Invalid compression "
               "type: '%d'", (int)type);
@@ -41,10 +41,16 @@ public:
                      const BlockCompressionCodec::Args &args =
                      BlockCompressionCodec::Args());
 
+  /**
+   * Creates a codec from a spec string such as "zlib --best".  Leading and
+   * trailing whitespace is ignored and a bare codec name creates the codec
+   * with its default arguments.
+   */
   static BlockCompressionCodec *
   create_block_codec(const std::string& spec) {
     BlockCompressionCodec::Args args;
-    return create_block_codec(parse_block_codec_spec(spec, args));
+    BlockCompressionCodec::Type type = parse_block_codec_spec(spec, args);
+    return create_block_codec(type, args);
   }
 };
 
@@ -49,6 +49,7 @@ namespace {
   struct CommandCallback : HqlInterpreter::Callback {
     CommandInterpreter &commander;
     int command {};
+    bool into_table {};
     unique_ptr<boost::progress_display> progress;
     Stopwatch stopwatch;
     bool m_profile {};
@@ -68,7 +69,10 @@ namespace {
         fclose(output);
     }
 
-    void on_parsed(ParserState &state) override { command = state.command; }
+    void on_parsed(ParserState &state) override {
+      command = state.command;
+      into_table = !state.table_name.empty();
+    }
 
     void on_return(const string &str) override { cout << str << endl; }
 
@@ -129,9 +133,18 @@ namespace {
           fprintf(stderr, "    Throughput:  %.2f cells/s\n",
                  total_cells / elapsed);
         }
-        if (mutator)
-          fprintf(stderr, "       Resends:  %llu\n",
-                  (Llu)mutator->get_resend_count());
+        if (total_rows) {
+          fprintf(stderr, "    Total rows:  %llu\n", (Llu)total_rows);
+          fprintf(stderr, "    Throughput:  %.2f rows/s\n",
+                 total_rows / elapsed);
+        }
+        if (command == COMMAND_LOAD_DATA && file_size)
+          fprintf(stderr, "    Throughput:  %.2f MB/s\n",
+                  (double)file_size / (1048576.0 * elapsed));
+        // LOAD DATA with a pipeline reports resends through total_resends
+        if (mutator || (command == COMMAND_LOAD_DATA && into_table))
+          fprintf(stderr, "       Resends:  %llu\n", (Llu)(total_resends +
+                  (mutator ? mutator->get_resend_count() : 0)));
 
         fflush(stderr);
       }
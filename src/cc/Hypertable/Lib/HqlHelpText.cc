@@ -52,6 +52,7 @@ namespace {
     "DROP TABLE ......... Removes a table",
     "RENAME TABLE ....... Renames a table",
     "DUMP TABLE ......... Create efficient backup file",
+    "EXPLAIN ............ Shows how a SELECT statement would be executed",
     "ALTER TABLE ........ Add/remove column family from existing table",
     "REBUILD INDICES .... Rebuilds a table's indices",
     "INSERT ............. Inserts data into a table",
@@ -78,6 +79,7 @@ namespace {
     "DROP RANGE ............ Drop a range",
     "FETCH SCANBLOCK ....... Fetch the next block results of a scan",
     "LOAD RANGE ............ Load a range",
+    "PROFILE ............... Controls the CPU profiler",
     "REPLAY START .......... Start replay",
     "REPLAY LOG ............ Replay a commit log",
     "REPLAY COMMIT ......... Commit replay",
@@ -142,6 +144,26 @@ namespace {
     0
   };
 
+  const char *help_text_profile[] = {
+    "",
+    "PROFILE START [frequency]",
+    "PROFILE STOP",
+    "PROFILE DUMP 'file'",
+    "",
+    "This command controls the CPU sampling profiler of the RangeServer.",
+    "PROFILE START starts the profiler, sampling the stacks of running",
+    "threads frequency times per second of CPU time (at most 1000).  The",
+    "default frequency is given by the following property:",
+    "",
+    "  Hypertable.RangeServer.Profile.Frequency",
+    "",
+    "PROFILE STOP stops the profiler.  PROFILE DUMP writes the stacks",
+    "sampled since the profiler was last started to the given file on the",
+    "RangeServer host, in the folded format read by flame graph tools.",
+    "",
+    0
+  };
+
   const char *help_text_create_scanner[] = {
     "",
     "CREATE SCANNER ON range_spec",
@@ -370,6 +392,7 @@ namespace {
     "      | quicklz",
     "      | snappy",
     "      | zlib [ zlib_options ]",
+    "      | zstd [ zstd_options ]",
     "      | none",
     "",
     "    bmz_options:",
@@ -380,6 +403,15 @@ namespace {
     "      -9",
     "      | --best",
     "      | --normal",
+    "      | --fast",
+    "      | --level int",
+    "",
+    "    zstd_options:",
+    "      --best",
+    "      | --normal",
+    "      | --fast",
+    "      | --level int",
+    "      | --dictionary-size int",
     "",
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
@@ -540,6 +572,7 @@ namespace {
     "      | quicklz",
     "      | snappy",
     "      | zlib [ zlib_options ]",
+    "      | zstd [ zstd_options ]",
     "      | none",
     "",
     "    bmz_options:",
@@ -550,6 +583,15 @@ namespace {
     "      -9",
     "      | --best",
     "      | --normal",
+    "      | --fast",
+    "      | --level int",
+    "",
+    "    zstd_options:",
+    "      --best",
+    "      | --normal",
+    "      | --fast",
+    "      | --level int",
+    "      | --dictionary-size int",
     "",
     "    bloom_filter_spec:",
     "      rows [ bloom_filter_options ]",
@@ -850,6 +892,7 @@ namespace {
     "  * quicklz",
     "  * zlib",
     "  * snappy",
+    "  * zstd",
     "  * none",
     "",
     "The default code is snappy for cell store blocks.  The following list ",
@@ -859,6 +902,13 @@ namespace {
     "  bmz --offset arg    Starting fingerprint offset (default = 0)",
     "  zlib -9 [ --best ]  Highest compression ratio (at the cost of speed)",
     "  zlib --normal       Normal compression ratio",
+    "  zlib --level arg    Explicit compression level (1-9)",
+    "  zstd --fast         Fastest compression (level 1)",
+    "  zstd --best         High compression ratio (level 19)",
+    "  zstd --level arg    Explicit compression level (1-22, default = 3)",
+    "  zstd --dictionary-size arg",
+    "                      Train a dictionary of this many bytes for each cell",
+    "                      store written by a major compaction (default = 0)",
     "",
     "Table Options",
     "-------------",
@@ -2129,6 +2179,64 @@ namespace {
     0
   };
 
+  const char *help_text_explain[] = {
+    "",
+    "EXPLAIN",
+    "=======",
+    "",
+    "    EXPLAIN select_statement",
+    "",
+    "Description",
+    "-----------",
+    "",
+    "The EXPLAIN command shows whether a SELECT statement would read a",
+    "secondary index table or do a filtered scan of the table, without",
+    "running the query.  When an index applies to the WHERE clause, the",
+    "choice is made by comparing estimated costs in bytes read:",
+    "",
+    "  - The filtered scan reads every range of the table that overlaps the",
+    "    query's row intervals (Hypertable.RangeServer.Range.SplitSize / 2",
+    "    bytes per range).",
+    "  - The index scan looks up one primary row per matching index entry",
+    "    (Hypertable.Scanner.Planner.IndexLookupCost bytes per lookup).  The",
+    "    matching entries are counted by a bounded probe of the index table.",
+    "",
+    "The index is always used if the query selects columns that are not",
+    "referenced in the WHERE clause, since a filtered scan cannot return",
+    "them, or if Hypertable.Scanner.Planner.CostBased is false (the",
+    "default).",
+    "",
+    "Gathering the estimates blocks, so scanners never do it themselves.",
+    "EXPLAIN and SELECT cache the chosen plan for",
+    "Hypertable.Scanner.Planner.EstimateTTL milliseconds, and scanners",
+    "created for the same query in that time follow it.  Scanners for which",
+    "no plan is cached use the index.",
+    "",
+    "The output fields are:",
+    "",
+    "  Plan ................ FULL_SCAN, INDEX_SCAN or QUALIFIER_INDEX_SCAN",
+    "  Table ............... Table scanned first",
+    "  IndexMatches ........ Matching index entries (\"+\" means at least)",
+    "  PrimaryRanges ....... Ranges read by a filtered scan",
+    "  EstimatedScanBytes .. Estimated cost of filtered scan",
+    "  EstimatedIndexBytes . Estimated cost of index scan",
+    "  Reason .............. Why the plan was chosen",
+    "",
+    "Example",
+    "-------",
+    "",
+    "  hypertable> EXPLAIN SELECT section FROM products WHERE section = 'books';",
+    "  Plan: FULL_SCAN",
+    "  Table: products",
+    "  IndexMatches: 4097+",
+    "  PrimaryRanges: 1",
+    "  EstimatedScanBytes: 268435456",
+    "  EstimatedIndexBytes: 268500992+",
+    "  Reason: predicate not selective enough for index",
+    "",
+    0
+  };
+
   typedef std::unordered_map<std::string, const char **>  HelpTextMap;
 
   HelpTextMap &build_help_text_map() {
@@ -2168,6 +2276,7 @@ namespace {
     (*map)["rebuild indices"] = help_text_rebuild_indices;
     (*map)["set"] = help_text_set;
     (*map)["status"] = help_text_status;
+    (*map)["explain"] = help_text_explain;
     return *map;
   }
 
@@ -2201,6 +2310,7 @@ void HqlHelpText::install_range_server_client_text() {
   text_map["fetch scanblock"] = help_text_fetch_scanblock;
   text_map["load"] = help_text_load_range;
   text_map["load range"] = help_text_load_range;
+  text_map["profile"] = help_text_profile;
   text_map["update"] = help_text_update;
   text_map["shutdown"] = help_text_shutdown_rangeserver;
 }
@@ -29,11 +29,14 @@
 #include <Hypertable/Lib/Key.h>
 #include <Hypertable/Lib/LoadDataEscape.h>
 #include <Hypertable/Lib/LoadDataFlags.h>
+#include <Hypertable/Lib/LoadDataPipeline.h>
 #include <Hypertable/Lib/LoadDataSource.h>
 #include <Hypertable/Lib/LoadDataSourceFactory.h>
 #include <Hypertable/Lib/Namespace.h>
+#include <Hypertable/Lib/ScanPlanner.h>
 #include <Hypertable/Lib/ScanSpec.h>
 #include <Hypertable/Lib/Schema.h>
+#include <Hypertable/Lib/TableScannerAsync.h>
 #include <Hypertable/Lib/TableSplit.h>
 
 #include <FsBroker/Lib/FileDevice.h>
@@ -52,11 +55,16 @@
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/device/null.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <functional>
 #include <sstream>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 using namespace std;
 using namespace Hypertable;
@@ -240,6 +248,16 @@ cmd_select(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
   char fs = state.field_separator ? state.field_separator : '\t';
 
   table = ns->open_table(state.table_name);
+
+  // choose and cache the scan plan here, since the scanner won't block to
+  // gather statistics
+  if (table->get_scan_planner()->cost_based()) {
+    ScanPlan plan;
+    TableScannerAsync::explain(table.get(), state.scan.builder.get(),
+                   Config::properties->get_i32("Hypertable.Request.Timeout"),
+                   plan);
+  }
+
   TableScannerPtr scanner( table->create_scanner(state.scan.builder.get(), 0, true) );
 
   // whether it's select into file
@@ -398,6 +416,21 @@ cmd_select(NamespacePtr &ns, ConnectionManagerPtr &conn_manager,
 }
 
 
+int
+cmd_explain(NamespacePtr &ns, ParserState &state, HqlInterpreter::Callback &cb) {
+  if (!ns)
+    HT_THROW(Error::BAD_NAMESPACE, "Null namespace");
+  TablePtr table = ns->open_table(state.table_name);
+  ScanPlan plan;
+  TableScannerAsync::explain(table.get(), state.scan.builder.get(),
+                 Config::properties->get_i32("Hypertable.Request.Timeout"),
+                 plan);
+  cb.on_return(plan.to_str());
+  cb.on_finish();
+  return 0;
+}
+
+
 int
 cmd_dump_table(NamespacePtr &ns,
                ConnectionManagerPtr &conn_manager, FsBroker::Lib::ClientPtr &fs_client,
@@ -519,6 +552,95 @@ cmd_dump_table(NamespacePtr &ns,
   return 0;
 }
 
+/// Parses chunks of a LOAD DATA INFILE input concurrently.
+/// Runs one thread per chunk that adds the parsed cells to
+/// <code>pipeline</code> as producer number of the chunk, while this thread
+/// reports the input consumed by all chunks to <code>progress</code>.
+/// @param chunks Sources returned by LoadDataSource::split()
+/// @param pipeline Pipeline created for <code>chunks.size()</code> producers
+/// @param cb Callback whose cell, row and size totals are updated
+/// @param progress Function called with the number of input bytes consumed
+/// @throws Exception of the first chunk that failed
+void
+parse_chunks(std::vector<LoadDataSourcePtr> &chunks,
+             LoadDataPipeline &pipeline, HqlInterpreter::Callback &cb,
+             std::function<void(::uint64_t)> progress) {
+
+  struct ChunkState {
+    ::uint64_t cells {};
+    ::uint64_t rows {};
+    ::uint64_t keys_size {};
+    ::uint64_t values_size {};
+    int error {Error::OK};
+    std::string error_msg;
+    int64_t lineno {};
+  };
+  std::vector<ChunkState> states(chunks.size());
+  std::vector<std::thread> threads;
+  std::atomic<::uint64_t> consumed_total(0);
+  std::atomic<size_t> finished(0);
+  std::atomic<bool> failed(false);
+
+  for (size_t i=0; i<chunks.size(); i++) {
+    threads.emplace_back([&, i]() {
+        LoadDataSource *lds = chunks[i].get();
+        ChunkState &state = states[i];
+        KeySpec key;
+        ::uint8_t *value;
+        ::uint32_t value_len;
+        ::uint32_t consumed = 0;
+        bool is_delete;
+        std::string last_row;
+        try {
+          while (!failed &&
+                 lds->next(&key, &value, &value_len, &is_delete, &consumed)) {
+            ++state.cells;
+            state.values_size += value_len;
+            state.keys_size += key.row_len;
+            if (key.row_len != last_row.length() ||
+                memcmp(key.row, last_row.data(), key.row_len)) {
+              ++state.rows;
+              last_row.assign((const char *)key.row, key.row_len);
+            }
+            pipeline.add(i, key, value, value_len, is_delete);
+            consumed_total += consumed;
+          }
+        }
+        catch (Exception &e) {
+          state.error = e.code();
+          state.error_msg = e.what();
+          state.lineno = lds->get_current_lineno();
+          failed = true;
+        }
+        ++finished;
+      });
+  }
+
+  ::uint64_t reported = 0;
+  while (finished < threads.size()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ::uint64_t consumed = consumed_total;
+    if (consumed > reported) {
+      progress(consumed - reported);
+      reported = consumed;
+    }
+  }
+  for (auto &thread : threads)
+    thread.join();
+  if (consumed_total > reported)
+    progress(consumed_total - reported);
+
+  for (size_t i=0; i<states.size(); i++) {
+    if (states[i].error != Error::OK)
+      HT_THROWF(states[i].error, "%s (line %lld of input chunk %d)",
+                states[i].error_msg.c_str(), (Lld)states[i].lineno, (int)i);
+    cb.total_cells += states[i].cells;
+    cb.total_rows += states[i].rows;
+    cb.total_keys_size += states[i].keys_size;
+    cb.total_values_size += states[i].values_size;
+  }
+}
+
 int
 cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
               ConnectionManagerPtr &conn_manager, 
@@ -528,6 +650,7 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
     HT_THROW(Error::BAD_NAMESPACE, "Null namespace");
   TablePtr table;
   TableMutatorPtr mutator;
+  std::unique_ptr<LoadDataPipeline> pipeline;
   bool into_table = true;
   bool display_timestamps = false;
   boost::iostreams::filtering_ostream fout;
@@ -538,6 +661,7 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   ::uint64_t consume_threshold = 0;
   bool ignore_unknown_columns = false;
   char fs = state.field_separator ? state.field_separator : '\t';
+  int32_t load_threads = 1;
 
   if (LoadDataFlags::ignore_unknown_cfs(state.load_flags))
     ignore_unknown_columns = true;
@@ -563,7 +687,10 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
     else
       fout.push(boost::iostreams::null_sink());
     table = ns->open_table(state.table_name);
-    mutator.reset(table->create_mutator(0, mutator_flags));
+    load_threads = Config::properties->get_i32("Hypertable."
+        "HqlInterpreter.LoadData.Threads");
+    if (load_threads <= 1)
+      mutator.reset(table->create_mutator(0, mutator_flags));
   }
 
   HT_ON_SCOPE_EXIT(&close_file, out_fd);
@@ -590,6 +717,34 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   else
     cb.on_update(cb.file_size);
 
+  auto report_progress = [&](::uint64_t consumed) {
+    if (!cb.normal_mode || state.input_file_src == STDIN)
+      return;
+    if (largefile_mode == true) {
+      running_total += consumed;
+      if (running_total >= consume_threshold) {
+        ::uint32_t megabytes = 1 + (unsigned long)((running_total -
+                                                    consume_threshold)
+                                                   / 1048576LL);
+        consume_threshold += (::uint64_t)megabytes * 1048576LL;
+        cb.on_progress(megabytes);
+      }
+    }
+    else
+      cb.on_progress(consumed);
+  };
+
+  // Uncompressed local files are split at line boundaries and parsed by
+  // load_threads threads; other inputs are parsed on this thread
+  std::vector<LoadDataSourcePtr> chunks;
+  if (load_threads > 1) {
+    chunks = lds->split(load_threads);
+    pipeline = std::make_unique<LoadDataPipeline>(table, mutator_flags,
+        load_threads, std::max((size_t)1, chunks.size()), state.escape, fs,
+        ignore_unknown_columns,
+        Config::properties->get_i32("Hypertable.Request.Timeout"));
+  }
+
   if (!into_table) {
     display_timestamps = lds->has_timestamps();
     if (display_timestamps)
@@ -607,6 +762,7 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
   LoadDataEscape value_escaper;
   const char *escaped_buf;
   size_t escaped_len;
+  std::string last_row;
 
   if (fs != '\t') {
     row_escaper.set_field_separator(fs);
@@ -614,15 +770,25 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
     value_escaper.set_field_separator(fs);
   }
 
+  if (!chunks.empty())
+    parse_chunks(chunks, *pipeline, cb, report_progress);
+
   try {
 
-    while (lds->next(&key, &value, &value_len, &is_delete, &consumed)) {
+    while (chunks.empty() &&
+           lds->next(&key, &value, &value_len, &is_delete, &consumed)) {
 
       ++cb.total_cells;
       cb.total_values_size += value_len;
       cb.total_keys_size += key.row_len;
+      if (key.row_len != last_row.length() ||
+          memcmp(key.row, last_row.data(), key.row_len)) {
+        ++cb.total_rows;
+        last_row.assign((const char *)key.row, key.row_len);
+      }
 
-      if (state.escape) {
+      // With a pipeline, unescaping happens on the pipeline threads
+      if (state.escape && !pipeline) {
         row_escaper.unescape((const char *)key.row, (size_t)key.row_len,
             &escaped_buf, &escaped_len);
         key.row = escaped_buf;
@@ -639,7 +805,9 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
         escaped_len = (size_t)value_len;
       }
 
-      if (into_table) {
+      if (pipeline)
+        pipeline->add(0, key, value, value_len, is_delete);
+      else if (into_table) {
         try {
           bool skip = false;
           if (ignore_unknown_columns) {
@@ -669,25 +837,18 @@ cmd_load_data(NamespacePtr &ns, ::uint32_t mutator_flags,
                << escaped_buf << "\n";
       }
 
-      if (cb.normal_mode && state.input_file_src != STDIN) {
-        if (largefile_mode == true) {
-          running_total += consumed;
-          if (running_total >= consume_threshold) {
-            consumed = 1 + (unsigned long)((running_total - consume_threshold) 
-                    / 1048576LL);
-            consume_threshold += (::uint64_t)consumed * 1048576LL;
-            cb.on_progress(consumed);
-          }
-        }
-        else
-          cb.on_progress(consumed);
-      }
+      report_progress(consumed);
     }
   }
   catch (Exception &e) {
     HT_THROW2F(e.code(), e, "line number %lld", (Lld)lds->get_current_lineno());
   }
 
+  if (pipeline) {
+    pipeline->finish();
+    cb.total_resends += pipeline->get_resend_count();
+  }
+
   fout.strict_sync();
 
   cb.on_finish(mutator);
@@ -992,6 +1153,8 @@ int HqlInterpreter::execute(const string &line, Callback &cb) {
     case COMMAND_SELECT:
       return cmd_select(m_namespace, m_conn_manager, m_fs_client,
                         state, cb);
+    case COMMAND_EXPLAIN:
+      return cmd_explain(m_namespace, state, cb);
     case COMMAND_LOAD_DATA:
       return cmd_load_data(m_namespace, m_mutator_flags,
                            m_conn_manager, m_fs_client, state, cb);
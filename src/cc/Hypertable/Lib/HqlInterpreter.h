@@ -53,13 +53,16 @@ namespace Hypertable {
       bool format_ts_in_nanos;  // default false
       // mutator stats
       uint64_t total_cells,
+               total_rows,
                total_keys_size,
                total_values_size,
-               file_size;
+               file_size,
+               total_resends;   // resends by mutators not passed to on_finish
 
       Callback(bool normal = true) : output(0), normal_mode(normal),
-          format_ts_in_nanos(false), total_cells(0), total_keys_size(0),
-          total_values_size(0), file_size(0) { }
+          format_ts_in_nanos(false), total_cells(0), total_rows(0),
+          total_keys_size(0), total_values_size(0), file_size(0),
+          total_resends(0) { }
       virtual ~Callback() { }
 
       /** Called when the hql string is parsed successfully */
@@ -40,6 +40,7 @@
 #include <Hypertable/Lib/LoadDataFlags.h>
 #include <Hypertable/Lib/LoadDataSource.h>
 #include <Hypertable/Lib/RangeServer/Protocol.h>
+#include <Hypertable/Lib/RangeServer/Request/Parameters/Profile.h>
 #include <Hypertable/Lib/ScanSpec.h>
 #include <Hypertable/Lib/Schema.h>
 #include <Hypertable/Lib/SystemVariable.h>
@@ -124,6 +125,8 @@ namespace Hypertable {
       COMMAND_SET,
       COMMAND_REBUILD_INDICES,
       COMMAND_STATUS,
+      COMMAND_EXPLAIN,
+      COMMAND_PROFILE,
       COMMAND_MAX
     };
 
@@ -358,6 +361,8 @@ namespace Hypertable {
       std::string range_end_row;
       ::int32_t scanner_id {-1};
       ::int32_t row_uniquify_chars {};
+      ::int32_t profile_action {};
+      ::int32_t profile_frequency {};
       bool escape {true};
       bool nokeys {};
       std::string current_rename_column_old_name;
@@ -2411,6 +2416,33 @@ namespace Hypertable {
       ParserState &state;
     };
 
+    struct set_profile_action {
+      set_profile_action(ParserState &state) : state(state) { }
+      void operator()(char const *str, char const *end) const {
+        typedef Lib::RangeServer::Request::Parameters::Profile Profile;
+        std::string action_str = String(str, end-str);
+        to_lower(action_str);
+        if (action_str == "start")
+          state.profile_action = Profile::START;
+        else if (action_str == "stop")
+          state.profile_action = Profile::STOP;
+        else if (action_str == "dump")
+          state.profile_action = Profile::DUMP;
+        else
+          HT_THROW(Error::HQL_PARSE_ERROR,
+                   format("Invalid profile action:  %s", action_str.c_str()));
+      }
+      ParserState &state;
+    };
+
+    struct set_profile_frequency {
+      set_profile_frequency(ParserState &state) : state(state) { }
+      void operator()(int frequency) const {
+        state.profile_frequency = frequency;
+      }
+      ParserState &state;
+    };
+
 
     struct set_variable_name {
       set_variable_name(ParserState &state) : state(state) { }
@@ -2630,6 +2662,7 @@ namespace Hypertable {
           Token FOR          = as_lower_d["for"];
           Token MAINTENANCE  = as_lower_d["maintenance"];
           Token HEAPCHECK    = as_lower_d["heapcheck"];
+          Token PROFILE      = as_lower_d["profile"];
           Token ALGORITHM    = as_lower_d["algorithm"];
           Token COMPACT      = as_lower_d["compact"];
           Token ALL          = as_lower_d["all"];
@@ -2647,6 +2680,7 @@ namespace Hypertable {
           Token REBUILD      = as_lower_d["rebuild"];
           Token INDICES      = as_lower_d["indices"];
           Token STATUS       = as_lower_d["status"];
+          Token EXPLAIN      = as_lower_d["explain"];
 
           /**
            * Start grammar definition
@@ -2739,10 +2773,12 @@ namespace Hypertable {
             | wait_for_maintenance_statement[set_command(self.state, COMMAND_WAIT_FOR_MAINTENANCE)]
             | balance_statement[set_command(self.state, COMMAND_BALANCE)]
             | heapcheck_statement[set_command(self.state, COMMAND_HEAPCHECK)]
+            | profile_statement[set_command(self.state, COMMAND_PROFILE)]
             | compact_statement[set_command(self.state, COMMAND_COMPACT)]
             | stop_statement[set_command(self.state, COMMAND_STOP)]
             | set_statement[set_command(self.state, COMMAND_SET)]
             | rebuild_indices_statement[set_command(self.state, COMMAND_REBUILD_INDICES)]
+            | explain_statement[set_command(self.state, COMMAND_EXPLAIN)]
             ;
 
           rebuild_indices_statement
@@ -2800,6 +2836,14 @@ namespace Hypertable {
             = HEAPCHECK >> *(string_literal[set_output_file(self.state)])
             ;
 
+          profile_statement
+            = PROFILE >> (START[set_profile_action(self.state)]
+                          >> !(uint_p[set_profile_frequency(self.state)])
+                          | STOP[set_profile_action(self.state)]
+                          | DUMP[set_profile_action(self.state)]
+                          >> string_literal[set_output_file(self.state)])
+            ;
+
           balance_statement
             = BALANCE >> !(ALGORITHM >> EQUAL >> user_identifier[set_balance_algorithm(self.state)])
               >> *(range_move_spec_list)
@@ -2859,6 +2903,10 @@ namespace Hypertable {
             = STATUS
             ;
 
+          explain_statement
+            = EXPLAIN >> select_statement
+            ;
+
           fetch_scanblock_statement
             = FETCH >> SCANBLOCK >> !(lexeme_d[(+digit_p)[
                 set_scanner_id(self.state)]])
@@ -3496,6 +3544,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(shutdown_statement);
           BOOST_SPIRIT_DEBUG_RULE(shutdown_master_statement);
           BOOST_SPIRIT_DEBUG_RULE(status_statement);
+          BOOST_SPIRIT_DEBUG_RULE(explain_statement);
           BOOST_SPIRIT_DEBUG_RULE(drop_range_statement);
           BOOST_SPIRIT_DEBUG_RULE(replay_start_statement);
           BOOST_SPIRIT_DEBUG_RULE(replay_log_statement);
@@ -3505,6 +3554,7 @@ namespace Hypertable {
           BOOST_SPIRIT_DEBUG_RULE(range_move_spec_list);
           BOOST_SPIRIT_DEBUG_RULE(range_move_spec);
           BOOST_SPIRIT_DEBUG_RULE(heapcheck_statement);
+          BOOST_SPIRIT_DEBUG_RULE(profile_statement);
           BOOST_SPIRIT_DEBUG_RULE(compact_statement);
           BOOST_SPIRIT_DEBUG_RULE(compact_type_option);
           BOOST_SPIRIT_DEBUG_RULE(compaction_type);
@@ -3560,12 +3610,14 @@ namespace Hypertable {
           replay_commit_statement, cell_interval, cell_predicate,
           cell_spec, wait_for_maintenance_statement, move_range_statement,
           balance_statement, range_move_spec_list, range_move_spec,
-          balance_option_spec, heapcheck_statement, compact_statement,
+          balance_option_spec, heapcheck_statement, profile_statement,
+          compact_statement,
           compact_type_option, compaction_type,
           metadata_sync_statement, metadata_sync_option_spec, stop_statement,
           range_type, table_identifier, pseudo_table_reference,
           dump_pseudo_table_statement, set_statement, set_variable_spec,
-          rebuild_indices_statement, index_type_spec, status_statement;
+          rebuild_indices_statement, index_type_spec, status_statement,
+          explain_statement;
       };
 
       ParserState &state;
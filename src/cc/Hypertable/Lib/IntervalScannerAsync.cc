@@ -27,8 +27,10 @@
 #include <Hypertable/Lib/Table.h>
 
 #include <Common/Error.h>
+#include <Common/RequestTrace.h>
 #include <Common/String.h>
 
+#include <algorithm>
 #include <cassert>
 #include <vector>
 
@@ -262,6 +264,10 @@ void IntervalScannerAsync::find_range_and_start_scan(const char *row_key, bool h
       HT_ASSERT(!m_create_outstanding && !m_create_event_saved && !m_eos);
       // create scanner asynchronously
       m_create_outstanding = true;
+      m_create_trace_id = RequestTrace::sample();
+      if (m_create_trace_id)
+        m_create_send_time = RequestTrace::now();
+      RequestTrace::Scope trace_scope(m_create_trace_id);
       m_range_server.create_scanner(m_next_range_info.addr, m_table_identifier, range,
                                     m_scan_spec_builder.get(), &m_create_handler, m_create_timer);
       HT_ASSERT(m_next_range_info.addr.is_proxy());
@@ -306,12 +312,22 @@ void IntervalScannerAsync::reset_outstanding_status(bool is_create, bool reset_t
     m_create_outstanding = false;
     if (reset_timer)
       m_create_timer.reset();
+    if (m_create_trace_id) {
+      RequestTrace::record(m_create_trace_id, RequestTrace::CLIENT_RPC,
+                           m_create_send_time, RequestTrace::now());
+      m_create_trace_id = 0;
+    }
   }
   else {
     HT_ASSERT(m_fetch_outstanding && (m_current || m_invalid_scanner_id_ok));
     m_fetch_outstanding = false;
     if (reset_timer)
       m_fetch_timer.reset();
+    if (m_fetch_trace_id) {
+      RequestTrace::record(m_fetch_trace_id, RequestTrace::CLIENT_RPC,
+                           m_fetch_send_time, RequestTrace::now());
+      m_fetch_trace_id = 0;
+    }
   }
 }
 
@@ -400,6 +416,9 @@ bool IntervalScannerAsync::retry_or_abort(bool refresh, bool hard, bool is_creat
                   m_create_scanner_row.c_str(), &m_next_range_info, 
                   m_create_timer, false))
         poll(0, 0, wait_time);
+    // the range server shed the request, back off before resending it
+    if (last_error == Error::RANGESERVER_OVERLOADED)
+      poll(0, 0, std::min(wait_time, m_create_timer.remaining()));
     find_range_and_start_scan(m_create_scanner_row.c_str(), hard);
   }
   catch (Exception &e) {
@@ -637,12 +656,17 @@ void IntervalScannerAsync::readahead() {
     try {
       m_fetch_timer.start();
       m_fetch_outstanding = true;
+      m_fetch_trace_id = RequestTrace::sample();
+      if (m_fetch_trace_id)
+        m_fetch_send_time = RequestTrace::now();
+      RequestTrace::Scope trace_scope(m_fetch_trace_id);
       m_range_server.fetch_scanblock(m_range_info.addr, m_cur_scanner_id,
                                      &m_fetch_handler, m_fetch_timer);
     }
     catch (Exception &e) {
       m_fetch_outstanding = false;
       m_fetch_timer.reset();
+      m_fetch_trace_id = 0;
       if (e.code() == Error::COMM_NOT_CONNECTED ||
           e.code() == Error::COMM_BROKEN_CONNECTION ||
           e.code() == Error::COMM_INVALID_PROXY) {
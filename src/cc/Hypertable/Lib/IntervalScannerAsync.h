@@ -127,6 +127,14 @@ namespace Hypertable {
     bool                m_create_event_saved;
     bool                m_invalid_scanner_id_ok;
     bool m_defer_readahead {};
+    /// Trace ID of outstanding create scanner request (see RequestTrace)
+    uint64_t m_create_trace_id {};
+    /// Trace ID of outstanding fetch scanblock request
+    uint64_t m_fetch_trace_id {};
+    /// Send time of outstanding create scanner request, if traced
+    int64_t m_create_send_time {};
+    /// Send time of outstanding fetch scanblock request, if traced
+    int64_t m_fetch_send_time {};
   };
 
   /// Smart pointer to IntervalScannerAsync
@@ -0,0 +1,372 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for LoadDataPipeline.
+/// This file contains method definitions for LoadDataPipeline, a class that
+/// fans LOAD DATA INFILE cells out to several mutator threads.
+
+#include <Common/Compat.h>
+
+#include "LoadDataPipeline.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+#include <Common/Timer.h>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Batch size at which a batch is handed to its worker
+  const size_t BATCH_SIZE = 1024 * 1024;
+
+  /// Maximum number of batches queued per worker
+  const size_t MAX_QUEUED_BATCHES = 4;
+
+  /// Encoded length of a null string
+  const uint32_t NULL_STRING = (uint32_t)-1;
+
+  void encode_string(uint8_t **bufp, const char *str, uint32_t len) {
+    if (str == 0) {
+      Serialization::encode_i32(bufp, NULL_STRING);
+      return;
+    }
+    Serialization::encode_i32(bufp, len);
+    memcpy(*bufp, str, len);
+    *bufp += len;
+    *(*bufp)++ = 0;
+  }
+
+  const char *decode_string(const uint8_t **bufp, size_t *remainp,
+                            uint32_t *lenp) {
+    *lenp = Serialization::decode_i32(bufp, remainp);
+    if (*lenp == NULL_STRING) {
+      *lenp = 0;
+      return 0;
+    }
+    if (*remainp < (size_t)*lenp + 1)
+      HT_THROW_INPUT_OVERRUN(*remainp, *lenp + 1);
+    const char *str = (const char *)*bufp;
+    *bufp += *lenp + 1;
+    *remainp -= *lenp + 1;
+    return str;
+  }
+
+}
+
+
+LoadDataPipeline::LoadDataPipeline(TablePtr &table, uint32_t mutator_flags,
+                                   size_t threads, size_t producers,
+                                   bool escape, char field_separator,
+                                   bool ignore_unknown_columns,
+                                   uint32_t timeout_ms)
+  : m_table(table), m_timeout_ms(timeout_ms), m_escape(escape),
+    m_ignore_unknown_columns(ignore_unknown_columns) {
+
+  if (threads == 0)
+    threads = 1;
+  if (producers == 0)
+    producers = 1;
+
+  TableIdentifier table_id;
+  m_table->get_identifier(&table_id);
+  m_table_id = table_id;
+  m_range_locator = m_table->get_range_locator();
+
+  for (size_t i=0; i<threads; i++) {
+    unique_ptr<Worker> worker(new Worker());
+    worker->mutator.reset(m_table->create_mutator(0, mutator_flags));
+    if (field_separator != '\t') {
+      worker->row_escaper.set_field_separator(field_separator);
+      worker->qualifier_escaper.set_field_separator(field_separator);
+      worker->value_escaper.set_field_separator(field_separator);
+    }
+    m_workers.push_back(std::move(worker));
+  }
+
+  m_producers.resize(producers);
+  for (auto &producer : m_producers) {
+    for (size_t i=0; i<threads; i++)
+      producer.batches.emplace_back(
+          new DynamicBuffer(BATCH_SIZE + BATCH_SIZE/4));
+  }
+
+  for (auto &worker : m_workers)
+    worker->thread = std::thread(&LoadDataPipeline::worker_loop, this,
+                                 worker.get());
+}
+
+
+LoadDataPipeline::~LoadDataPipeline() {
+  stop();
+}
+
+
+void LoadDataPipeline::add(size_t producer, const KeySpec &key,
+                           const uint8_t *value, uint32_t value_len,
+                           bool is_delete) {
+  Producer &state = m_producers[producer];
+  size_t worker = route(state, (const char *)key.row, key.row_len);
+  uint32_t cf_len = key.column_family ? strlen(key.column_family) : 0;
+
+  DynamicBuffer &batch = *state.batches[worker];
+  batch.ensure(2 + 8 + 8 + 4*4 + key.row_len + 1 + cf_len + 1 +
+               key.column_qualifier_len + 1 + value_len);
+
+  *batch.ptr++ = is_delete ? 1 : 0;
+  *batch.ptr++ = key.flag;
+  Serialization::encode_i64(&batch.ptr, key.timestamp);
+  Serialization::encode_i64(&batch.ptr, key.revision);
+  encode_string(&batch.ptr, (const char *)key.row, key.row_len);
+  encode_string(&batch.ptr, key.column_family, cf_len);
+  encode_string(&batch.ptr, (const char *)key.column_qualifier,
+                key.column_qualifier_len);
+  Serialization::encode_i32(&batch.ptr, value_len);
+  if (value_len) {
+    memcpy(batch.ptr, value, value_len);
+    batch.ptr += value_len;
+  }
+
+  if (batch.fill() >= BATCH_SIZE)
+    submit(worker, state.batches[worker]);
+}
+
+
+void LoadDataPipeline::finish() {
+  for (auto &producer : m_producers) {
+    for (size_t i=0; i<producer.batches.size(); i++) {
+      if (!producer.batches[i]->empty())
+        submit(i, producer.batches[i]);
+    }
+  }
+
+  {
+    unique_lock<mutex> lock(m_mutex);
+    m_cond.wait(lock, [this]() {
+        if (m_error)
+          return true;
+        for (auto &worker : m_workers)
+          if (worker->busy || !worker->queue.empty())
+            return false;
+        return true;
+      });
+    if (m_error)
+      HT_THROW(m_error, m_error_msg);
+  }
+
+  stop();
+
+  for (auto &worker : m_workers) {
+    try {
+      worker->mutator->flush();
+    }
+    catch (Exception &e) {
+      worker->mutator->show_failed(e);
+      throw;
+    }
+  }
+}
+
+
+uint64_t LoadDataPipeline::get_resend_count() {
+  uint64_t count = 0;
+  for (auto &worker : m_workers)
+    count += worker->mutator->get_resend_count();
+  return count;
+}
+
+
+size_t LoadDataPipeline::route(Producer &producer, const char *row,
+                               size_t row_len) {
+
+  // Cells of a row and rows of a range usually arrive together
+  if (producer.have_route &&
+      producer.last_route.start_row.compare(0, string::npos, row, row_len) < 0 &&
+      producer.last_route.end_row.compare(0, string::npos, row, row_len) >= 0)
+    return producer.last_route.worker;
+
+  string row_str(row, row_len);
+
+  {
+    lock_guard<mutex> lock(m_route_mutex);
+    auto iter = m_routes.lower_bound(row_str);
+    if (iter == m_routes.end() || iter->second.start_row >= row_str) {
+      RangeLocationInfo range_info;
+      Timer timer(m_timeout_ms, true);
+      m_range_locator->find_loop(&m_table_id, row_str.c_str(), &range_info,
+                                 timer, false);
+      Route route;
+      route.start_row = range_info.start_row;
+      route.end_row = range_info.end_row;
+      route.worker = m_next_worker++ % m_workers.size();
+      // Ranges only ever split, so a range located now cannot overlap a
+      // range located earlier unless it was split from it, in which case
+      // the earlier (covering) route would have matched above
+      iter = m_routes.emplace(route.end_row, route).first;
+    }
+    producer.last_route = iter->second;
+  }
+  producer.have_route = true;
+  return producer.last_route.worker;
+}
+
+
+void LoadDataPipeline::submit(size_t worker_index,
+                              unique_ptr<DynamicBuffer> &batch) {
+  Worker &worker = *m_workers[worker_index];
+  unique_lock<mutex> lock(m_mutex);
+
+  // Backpressure: wait for the worker to drain its queue
+  m_cond.wait(lock, [this, &worker]() {
+      return worker.queue.size() < MAX_QUEUED_BATCHES || m_error; });
+
+  if (m_error)
+    HT_THROW(m_error, m_error_msg);
+
+  worker.queue.push_back(std::move(batch));
+  if (m_free_list.empty())
+    batch.reset(new DynamicBuffer(BATCH_SIZE + BATCH_SIZE/4));
+  else {
+    batch = std::move(m_free_list.back());
+    m_free_list.pop_back();
+  }
+  m_cond.notify_all();
+}
+
+
+void LoadDataPipeline::worker_loop(Worker *worker) {
+  unique_lock<mutex> lock(m_mutex);
+
+  while (true) {
+    m_cond.wait(lock, [this, worker]() {
+        return !worker->queue.empty() || m_shutdown; });
+
+    if (m_shutdown)
+      break;
+
+    unique_ptr<DynamicBuffer> batch = std::move(worker->queue.front());
+    worker->queue.pop_front();
+    worker->busy = true;
+    lock.unlock();
+
+    int error = Error::OK;
+    string error_msg;
+    try {
+      apply(worker, *batch);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
+      error = e.code();
+      error_msg = e.what();
+    }
+    batch->clear();
+
+    lock.lock();
+    worker->busy = false;
+    m_free_list.push_back(std::move(batch));
+    if (error != Error::OK && m_error == Error::OK) {
+      m_error = error;
+      m_error_msg = error_msg;
+    }
+    m_cond.notify_all();
+  }
+}
+
+
+void LoadDataPipeline::apply(Worker *worker, DynamicBuffer &batch) {
+  const uint8_t *ptr = batch.base;
+  size_t remaining = batch.fill();
+  KeySpec key;
+  const char *escaped_buf;
+  size_t escaped_len;
+  uint32_t len;
+  SchemaPtr schema;
+
+  if (m_ignore_unknown_columns)
+    schema = m_table->schema();
+
+  while (remaining) {
+    bool is_delete = Serialization::decode_i8(&ptr, &remaining) != 0;
+    key.flag = Serialization::decode_i8(&ptr, &remaining);
+    key.timestamp = Serialization::decode_i64(&ptr, &remaining);
+    key.revision = Serialization::decode_i64(&ptr, &remaining);
+    key.row = decode_string(&ptr, &remaining, &len);
+    key.row_len = len;
+    key.column_family = decode_string(&ptr, &remaining, &len);
+    key.column_qualifier = decode_string(&ptr, &remaining, &len);
+    key.column_qualifier_len = len;
+    uint32_t value_len = Serialization::decode_i32(&ptr, &remaining);
+    if (remaining < value_len)
+      HT_THROW_INPUT_OVERRUN(remaining, value_len);
+    const uint8_t *value = ptr;
+    ptr += value_len;
+    remaining -= value_len;
+
+    if (m_escape) {
+      worker->row_escaper.unescape((const char *)key.row,
+          (size_t)key.row_len, &escaped_buf, &escaped_len);
+      key.row = escaped_buf;
+      key.row_len = escaped_len;
+      worker->qualifier_escaper.unescape(key.column_qualifier,
+          (size_t)key.column_qualifier_len, &escaped_buf, &escaped_len);
+      key.column_qualifier = escaped_buf;
+      key.column_qualifier_len = escaped_len;
+      worker->value_escaper.unescape((const char *)value,
+          (size_t)value_len, &escaped_buf, &escaped_len);
+    }
+    else {
+      escaped_buf = (const char *)value;
+      escaped_len = (size_t)value_len;
+    }
+
+    if (schema && key.column_family &&
+        !schema->get_column_family(key.column_family))
+      continue;
+
+    try {
+      if (is_delete)
+        worker->mutator->set_delete(key);
+      else
+        worker->mutator->set(key, escaped_buf, escaped_len);
+    }
+    catch (Exception &e) {
+      do {
+        worker->mutator->show_failed(e);
+      } while (!worker->mutator->retry());
+    }
+  }
+}
+
+
+void LoadDataPipeline::stop() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_shutdown = true;
+    m_cond.notify_all();
+  }
+  for (auto &worker : m_workers) {
+    if (worker->thread.joinable())
+      worker->thread.join();
+  }
+}
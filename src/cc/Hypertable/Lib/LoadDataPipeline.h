@@ -0,0 +1,223 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for LoadDataPipeline.
+/// This file contains type declarations for LoadDataPipeline, a class that
+/// fans LOAD DATA INFILE cells out to several mutator threads.
+
+#ifndef Hypertable_Lib_LoadDataPipeline_h
+#define Hypertable_Lib_LoadDataPipeline_h
+
+#include <Hypertable/Lib/KeySpec.h>
+#include <Hypertable/Lib/LoadDataEscape.h>
+#include <Hypertable/Lib/RangeLocator.h>
+#include <Hypertable/Lib/Table.h>
+#include <Hypertable/Lib/TableIdentifier.h>
+#include <Hypertable/Lib/TableMutator.h>
+
+#include <Common/DynamicBuffer.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  /// Fans cells parsed by LoadDataSource out to parallel mutators.
+  /// Cells are grouped by destination range: the first time a cell falls
+  /// into a range that has not been seen before, the range is looked up
+  /// with the table's RangeLocator and assigned to the next worker thread
+  /// round-robin.  All later cells of that range go to the same worker, so
+  /// each TableMutator buffers updates for a subset of the ranges and all
+  /// cells of a row, including deletes that follow inserts, are applied in
+  /// the order they were added by one producer.  The assignment is never
+  /// revised during a load; ranges that split meanwhile keep routing to the
+  /// worker of the range they were split from.
+  ///
+  /// Cells are copied into batches owned by the producer (parser thread)
+  /// that added them.  Every worker owns a bounded queue of batches and
+  /// add() blocks when the destination queue is full, which throttles the
+  /// parsers to the rate at which the mutators drain.  Workers perform the
+  /// unescaping and column family filtering that the single threaded loader
+  /// does inline, followed by TableMutator::set().
+  class LoadDataPipeline {
+  public:
+
+    /// Constructor.
+    /// Creates one mutator per worker and starts the worker threads.
+    /// @param table Destination table
+    /// @param mutator_flags Flags passed to Table::create_mutator()
+    /// @param threads Number of worker threads (and mutators)
+    /// @param producers Number of threads that call add() concurrently
+    /// @param escape Unescape row, qualifier and value
+    /// @param field_separator Field separator for unescaping
+    /// @param ignore_unknown_columns Silently drop cells of unknown families
+    /// @param timeout_ms Timeout for range lookups in milliseconds
+    LoadDataPipeline(TablePtr &table, uint32_t mutator_flags, size_t threads,
+                     size_t producers, bool escape, char field_separator,
+                     bool ignore_unknown_columns, uint32_t timeout_ms);
+
+    /// Destructor.
+    /// Stops the worker threads, discarding any cells not yet applied.
+    ~LoadDataPipeline();
+
+    /// Queues a cell.
+    /// The cell is copied, so the key and value buffers may be reused as
+    /// soon as this method returns.  Concurrent calls must pass different
+    /// <code>producer</code> numbers.
+    /// @param producer Number of calling producer (0 to
+    /// <code>producers</code>-1)
+    /// @param key %Key of cell
+    /// @param value Cell value
+    /// @param value_len Length of value
+    /// @param is_delete <i>true</i> if cell is a delete
+    /// @throws Exception if a worker has failed or the range lookup failed
+    void add(size_t producer, const KeySpec &key, const uint8_t *value,
+             uint32_t value_len, bool is_delete);
+
+    /// Applies all queued cells and flushes the mutators.
+    /// Must not be called while producers are still adding cells.
+    /// @throws Exception if a worker failed or a flush failed
+    void finish();
+
+    /// Returns total number of resends performed by the mutators
+    uint64_t get_resend_count();
+
+  private:
+
+    /// %Range assigned to a worker
+    struct Route {
+      /// Start row (exclusive)
+      std::string start_row;
+      /// End row (inclusive)
+      std::string end_row;
+      /// Index of worker in #m_workers
+      size_t worker {};
+    };
+
+    /// Per-producer state
+    struct Producer {
+      /// Batch being filled for each worker
+      std::vector<std::unique_ptr<DynamicBuffer>> batches;
+      /// Route of the previous cell
+      Route last_route;
+      /// <i>true</i> if #last_route is valid
+      bool have_route {};
+    };
+
+    /// Per-thread state
+    struct Worker {
+      TableMutatorPtr mutator;
+      std::deque<std::unique_ptr<DynamicBuffer>> queue;
+      std::thread thread;
+      LoadDataEscape row_escaper;
+      LoadDataEscape qualifier_escaper;
+      LoadDataEscape value_escaper;
+      bool busy {};
+    };
+
+    /// Returns the worker of the range containing a row.
+    /// Checks the route of the producer's previous cell, then #m_routes,
+    /// and finally looks the range up with #m_range_locator.
+    /// @param producer Producer state
+    /// @param row Row key
+    /// @param row_len Length of row key
+    /// @return Index of worker in #m_workers
+    size_t route(Producer &producer, const char *row, size_t row_len);
+
+    /// Hands a producer batch to a worker's queue and replaces it with an
+    /// empty batch
+    void submit(size_t worker, std::unique_ptr<DynamicBuffer> &batch);
+
+    /// Worker thread function
+    void worker_loop(Worker *worker);
+
+    /// Applies all cells of a batch to a worker's mutator
+    void apply(Worker *worker, DynamicBuffer &batch);
+
+    /// Stops and joins the worker threads
+    void stop();
+
+    /// Destination table
+    TablePtr m_table;
+
+    /// Identifier of destination table
+    TableIdentifierManaged m_table_id;
+
+    /// Range locator of destination table
+    RangeLocatorPtr m_range_locator;
+
+    /// Timeout for range lookups
+    uint32_t m_timeout_ms {};
+
+    /// Producer state
+    std::vector<Producer> m_producers;
+
+    /// Worker state
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    /// %Mutex protecting #m_routes and #m_next_worker
+    std::mutex m_route_mutex;
+
+    /// Routes of ranges seen so far, keyed by end row
+    std::map<std::string, Route> m_routes;
+
+    /// Worker to assign the next new range to
+    size_t m_next_worker {};
+
+    /// %Mutex protecting queues, free list, flags and error state
+    std::mutex m_mutex;
+
+    /// Signals queue and busy state changes
+    std::condition_variable m_cond;
+
+    /// Applied batches available for reuse
+    std::vector<std::unique_ptr<DynamicBuffer>> m_free_list;
+
+    /// Unescape row, qualifier and value
+    bool m_escape {};
+
+    /// Drop cells of unknown column families
+    bool m_ignore_unknown_columns {};
+
+    /// Set to stop worker threads
+    bool m_shutdown {};
+
+    /// First error encountered by a worker
+    int m_error {};
+
+    /// Message for #m_error
+    std::string m_error_msg;
+  };
+
+  /// @}
+}
+
+#endif // Hypertable_Lib_LoadDataPipeline_h
@@ -144,10 +144,13 @@ void
 LoadDataSource::init(const std::vector<String> &key_columns,
                      const string &timestamp_column,
                      char field_separator) {
-  string header;
   m_field_separator = field_separator;
+  m_key_columns = key_columns;
+  m_timestamp_column = timestamp_column;
   init_src();
-  header = get_header();
+  m_header = get_header();
+  // parse_header() modifies the string it is given
+  string header = m_header;
   parse_header(header, key_columns, timestamp_column);
 }
 
@@ -67,6 +67,20 @@ namespace Hypertable {
                       const std::string &timestamp_column,
                       char field_separator);
 
+    /** Splits the input into sources that can be read concurrently.
+     * Divides the input that has not been read yet into up to
+     * <code>count</code> consecutive parts at line boundaries and returns an
+     * initialized source for each part, reading the header of this source.
+     * Must be called after init() and before next().  This source must not
+     * be read afterwards.  The default implementation returns an empty
+     * vector, which means that the input cannot be split.
+     * @param count Maximum number of sources to return
+     * @return Sources covering the input in order, or an empty vector
+     */
+    virtual std::vector<std::shared_ptr<LoadDataSource>> split(size_t count) {
+      return std::vector<std::shared_ptr<LoadDataSource>>();
+    }
+
     int64_t get_current_lineno() { return m_cur_line; }
     unsigned long get_source_size() const { return m_source_size; }
 
@@ -154,6 +168,9 @@ namespace Hypertable {
     unsigned long m_source_size;
     bool m_first_line_cached;
     char m_field_separator;
+    std::string m_header;
+    std::vector<String> m_key_columns;
+    std::string m_timestamp_column;
   };
 
   /// Smart pointer to LoadDataSource
@@ -30,6 +30,7 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/restrict.hpp>
 #include <boost/shared_array.hpp>
 
 extern "C" {
@@ -50,6 +51,38 @@ using namespace boost::iostreams;
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+
+  /// Minimum size of a chunk returned by LoadDataSourceFileLocal::split()
+  const uint64_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+  /** Returns offset of the line following the one containing an offset.
+   * @param in Input file
+   * @param offset Offset in file
+   * @param file_size Size of file
+   * @return Offset of the first byte after the first newline at or after
+   * <code>offset</code>, or <code>file_size</code> if there is none
+   */
+  uint64_t next_line_offset(std::ifstream &in, uint64_t offset,
+                            uint64_t file_size) {
+    char buf[4096];
+    in.clear();
+    in.seekg((std::streamoff)offset);
+    while (offset < file_size) {
+      in.read(buf, sizeof(buf));
+      std::streamsize nread = in.gcount();
+      if (nread <= 0)
+        break;
+      const char *nl = (const char *)memchr(buf, '\n', (size_t)nread);
+      if (nl)
+        return offset + (nl - buf) + 1;
+      offset += nread;
+    }
+    return file_size;
+  }
+
+}
+
 /**
  *
  */
@@ -69,9 +102,83 @@ LoadDataSourceFileLocal::LoadDataSourceFileLocal(const string &fname,
   return;
 }
 
+LoadDataSourceFileLocal::LoadDataSourceFileLocal(const string &fname,
+  const string &header, uint64_t offset, uint64_t length,
+  int row_uniquify_chars, int load_flags)
+  : LoadDataSource("", row_uniquify_chars, load_flags),
+    m_source(fname, BOOST_IOS::in|BOOST_IOS::binary), m_fname(fname),
+    m_chunk(true), m_chunk_offset(offset), m_chunk_length(length) {
+  m_header = header;
+}
+
+void
+LoadDataSourceFileLocal::init(const std::vector<String> &key_columns,
+                              const string &timestamp_column,
+                              char field_separator) {
+  if (!m_chunk) {
+    LoadDataSource::init(key_columns, timestamp_column, field_separator);
+    return;
+  }
+  // The header line was read by the source that was split
+  m_field_separator = field_separator;
+  m_key_columns = key_columns;
+  m_timestamp_column = timestamp_column;
+  init_src();
+  // parse_header() modifies the string it is given
+  string header = m_header;
+  parse_header(header, key_columns, timestamp_column);
+}
+
+std::vector<LoadDataSourcePtr>
+LoadDataSourceFileLocal::split(size_t count) {
+  std::vector<LoadDataSourcePtr> chunks;
+
+  if (m_zipped || m_chunk || count < 2)
+    return chunks;
+
+  uint64_t file_size = m_source_size;
+  std::ifstream in(m_fname.c_str(), std::ios::in|std::ios::binary);
+  if (!in)
+    HT_THROWF(Error::FILE_NOT_FOUND, "Unable to open '%s'", m_fname.c_str());
+
+  // Skip the header line unless get_header() kept it as a data line
+  uint64_t data_offset = 0;
+  if (m_header_fname.empty() && !m_first_line_cached)
+    data_offset = next_line_offset(in, 0, file_size);
+
+  if (data_offset >= file_size)
+    return chunks;
+
+  uint64_t data_size = file_size - data_offset;
+  count = std::min((uint64_t)count, data_size / MIN_CHUNK_SIZE);
+  if (count < 2)
+    return chunks;
+
+  uint64_t start = data_offset;
+  for (size_t i=1; i<=count && start < file_size; i++) {
+    uint64_t end = (i == count) ? file_size :
+      next_line_offset(in, data_offset + (data_size / count) * i, file_size);
+    if (end <= start)
+      continue;
+    LoadDataSourcePtr chunk(new LoadDataSourceFileLocal(m_fname, m_header,
+        start, end - start, m_row_uniquify_chars, m_load_flags));
+    chunk->init(m_key_columns, m_timestamp_column, m_field_separator);
+    chunks.push_back(chunk);
+    start = end;
+  }
+  return chunks;
+}
+
 void
 LoadDataSourceFileLocal::init_src()
 {
+  if (m_chunk) {
+    m_fin.push(boost::iostreams::restrict(m_source,
+        (boost::iostreams::stream_offset)m_chunk_offset,
+        (boost::iostreams::stream_offset)m_chunk_length));
+    m_source_size = m_chunk_length;
+    return;
+  }
   m_fin.push(m_source);
   m_source_size = FileUtils::size(m_fname.c_str());
 }
@@ -88,4 +195,3 @@ LoadDataSourceFileLocal::incr_consumed()
   m_offset = new_offset;
   return consumed;
 }
-
@@ -49,13 +49,47 @@ namespace Hypertable {
 
     ~LoadDataSourceFileLocal() { };
 
+    void init(const std::vector<String> &key_columns,
+              const std::string &timestamp_column,
+              char field_separator) override;
+
+    /** Splits an uncompressed file into chunks.
+     * Divides the data lines of the file into up to <code>count</code>
+     * chunks of about the same size that start and end at line boundaries
+     * and are at least 1MB long.  Each chunk is read by its own source that
+     * is initialized with the header of this source.  Compressed files
+     * cannot be split because gzip streams can only be read sequentially.
+     * @param count Maximum number of chunks
+     * @return Chunk sources in file order, or an empty vector if the file is
+     * compressed or too small to be split
+     */
+    std::vector<std::shared_ptr<LoadDataSource>> split(size_t count) override;
+
     uint64_t incr_consumed();
 
   protected:
+
+    /** Constructor for a chunk of a file.
+     * @param fname Name of file
+     * @param header Header line of file
+     * @param offset Offset of first line of chunk
+     * @param length Length of chunk
+     * @param row_uniquify_chars Number of random characters to append to rows
+     * @param load_flags Load flags
+     */
+    LoadDataSourceFileLocal(const std::string &fname, const std::string &header,
+                            uint64_t offset, uint64_t length,
+                            int row_uniquify_chars, int load_flags);
+
     void init_src();
     boost::iostreams::file_source m_source;
     std::string m_fname;
-    std::string m_header_fname;
+    /// <i>true</i> if this source reads a chunk of #m_fname
+    bool m_chunk {};
+    /// Offset of chunk
+    uint64_t m_chunk_offset {};
+    /// Length of chunk
+    uint64_t m_chunk_length {};
   };
 
 } // namespace Hypertable
@@ -72,6 +72,10 @@ void MetaLog::scan_log_directory(FilesystemPtr &fs, const string &path,
     if (*ptr == 0 || (ptr > listing[i].name.c_str() && !strcmp(ptr, ".bad")))
       id = atoi(listing[i].name.c_str());
   
+    // Skip compaction file left behind by a crash
+    if (*ptr != 0 && ptr > listing[i].name.c_str() && !strcmp(ptr, ".tmp"))
+      continue;
+
     if (*ptr != 0) {
       HT_WARNF("Invalid META LOG file name encountered '%s', skipping...",
                listing[i].name.c_str());
@@ -163,6 +163,10 @@ namespace Hypertable {
 
       /// %Entity header
       EntityHeader header;
+
+      /// Highest Writer serialization sequence number queued for write
+      /// (protected by Writer's mutex)
+      uint64_t m_queued_sequence {};
     };
 
     /// Smart pointer to Entity
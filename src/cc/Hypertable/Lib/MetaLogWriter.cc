@@ -38,8 +38,11 @@
 #include <boost/algorithm/string.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cerrno>
 #include <chrono>
+#include <cstring>
 #include <memory>
 #include <thread>
 
@@ -56,6 +59,8 @@ using namespace std;
 namespace {
   const int32_t FS_BUFFER_SIZE = -1;
   const int64_t FS_BLOCK_SIZE = -1;
+  /// Process-wide entity serialization sequence number
+  atomic<uint64_t> g_serialization_sequence {};
 }
 
 bool Writer::skip_recover_entry = false;
@@ -90,6 +95,9 @@ Writer::Writer(FilesystemPtr &fs, DefinitionPtr &definition, const string &path,
 
   m_max_file_size = Config::properties->get_i64("Hypertable.MetaLog.MaxFileSize");
 
+  m_compaction_chunk_size =
+    Config::properties->get_i32("Hypertable.MetaLog.CompactionChunkSize");
+
   // get replication
   m_replication = Config::properties->get_i32("Hypertable.Metadata.Replication");
 
@@ -108,6 +116,11 @@ Writer::Writer(FilesystemPtr &fs, DefinitionPtr &definition, const string &path,
 
   m_file_ids.push_front(next_id);
 
+  // Remove compaction file left behind by a crash during compaction
+  m_fs->remove(m_filename + ".tmp");
+  if (FileUtils::exists(m_backup_filename + ".tmp"))
+    FileUtils::unlink(m_backup_filename + ".tmp");
+
   purge_old_log_files();
 
   write_header();
@@ -129,7 +142,9 @@ Writer::~Writer() {
 }
 
 void Writer::close() {
-  lock_guard<mutex> lock(m_mutex);
+  unique_lock<mutex> lock(m_mutex);
+  m_cond.wait(lock, [this](){ return !m_writing; });
+  abandon_compaction();
   try {
     if (m_fd != -1) {
       m_fs->close(m_fd);
@@ -170,91 +185,266 @@ void Writer::purge_old_log_files() {
 
 }
 
-void Writer::roll() {
+void Writer::start_compaction() {
 
-  // Close descriptors
-  if (m_fd != -1) {
-    m_fs->close(m_fd);
-    m_fd = -1;
-    ::close(m_backup_fd);
-    m_backup_fd = -1;
+  m_compaction_id = m_file_ids.front() + 1;
+  m_compaction_filename = m_path + "/" + m_compaction_id + ".tmp";
+  m_compaction_backup_filename = m_backup_path + "/" + m_compaction_id + ".tmp";
+
+  try {
+    m_compaction_fd = m_fs->create(m_compaction_filename,
+                                   Filesystem::OPEN_FLAG_OVERWRITE,
+                                   FS_BUFFER_SIZE, m_replication, FS_BLOCK_SIZE);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << "Problem starting compaction of metalog " << m_filename
+                 << " - " << e << HT_END;
+    return;
   }
 
-  int32_t next_id = m_file_ids.front() + 1;
+  m_compaction_backup_fd = ::open(m_compaction_backup_filename.c_str(),
+                                  O_CREAT|O_TRUNC|O_WRONLY, 0644);
+  if (m_compaction_backup_fd == -1) {
+    HT_ERRORF("Problem starting compaction of metalog %s - unable to open "
+              "%s - %s", m_filename.c_str(), m_compaction_backup_filename.c_str(),
+              strerror(errno));
+    abandon_compaction();
+    return;
+  }
 
-  // Open next brokered FS file
-  m_filename = m_path + "/" + next_id;
-  m_fd = m_fs->create(m_filename, 0, FS_BUFFER_SIZE, m_replication, FS_BLOCK_SIZE);
+  m_compaction_offset = 0;
+  m_compaction_pending.clear();
+  m_compaction_pending.reserve(m_entity_map.size());
+  for (auto &entry : m_entity_map)
+    m_compaction_pending.push_back(entry.first);
 
-  // Open next backup file
-  m_backup_filename = m_backup_path + "/" + next_id;
-  m_backup_fd = ::open(m_backup_filename.c_str(), O_CREAT|O_TRUNC|O_WRONLY, 0644);
+  HT_INFOF("Compacting metalog %s (%lld bytes, %u live entities) into %s",
+           m_filename.c_str(), (Lld)m_offset,
+           (unsigned)m_compaction_pending.size(),
+           m_compaction_filename.c_str());
+}
 
-  m_file_ids.push_front(next_id);
 
-  purge_old_log_files();
+bool Writer::next_compaction_chunk(vector<SerializedEntityT> &chunk) {
+  int64_t length {};
+  while (!m_compaction_pending.empty() && length < m_compaction_chunk_size) {
+    auto iter = m_entity_map.find(m_compaction_pending.back());
+    m_compaction_pending.pop_back();
+    // Entities removed since compaction started are skipped
+    if (iter != m_entity_map.end()) {
+      chunk.push_back(iter->second);
+      length += iter->second.first;
+    }
+  }
+  return m_compaction_pending.empty();
+}
 
-  m_offset = 0;
 
-  write_header();
+size_t Writer::write_compaction(vector<SerializedEntityT> &chunk,
+                                vector<SerializedEntityT> &batch, bool last) {
 
-  // Compute total length
-  uint32_t total_length {};
-  for (auto &entry : m_entity_map)
-    total_length += entry.second.first;
-  total_length += EntityHeader::LENGTH;  // For Recover entity
+  size_t length = (m_compaction_offset == 0) ? Header::LENGTH : 0;
+  for (auto &entry : chunk)
+    length += entry.first;
+  for (auto &entry : batch)
+    length += entry.first;
+  if (last)
+    length += EntityHeader::LENGTH;  // For Recover entity
 
-  // Create initial file contents
-  StaticBuffer buf (new uint8_t [total_length], total_length);
+  StaticBuffer buf(length);
   uint8_t *ptr = buf.base;
-  for (auto &entry : m_entity_map) {
-    memcpy(ptr, entry.second.second.get(), entry.second.first);
-    ptr += entry.second.first;
+  if (m_compaction_offset == 0)
+    encode_header(&ptr);
+  for (auto &entry : chunk) {
+    memcpy(ptr, entry.second.get(), entry.first);
+    ptr += entry.first;
+  }
+  for (auto &entry : batch) {
+    memcpy(ptr, entry.second.get(), entry.first);
+    ptr += entry.first;
+  }
+  if (last) {
+    EntityRecover er;
+    er.encode_entry(&ptr);
   }
-  EntityRecover er;
-  er.encode_entry(&ptr);
   HT_ASSERT((ptr-buf.base) == (ptrdiff_t)buf.size);
 
-  m_offset += buf.size;
+  // Only the last step needs to be durable, the file isn't live before then
+  FileUtils::write(m_compaction_backup_fd, buf.base, buf.size);
+  m_fs->append(m_compaction_fd, buf,
+               last ? m_flush_method : Filesystem::Flags::NONE);
 
-  // Write contents to file(s)
-  FileUtils::write(m_backup_fd, buf.base, buf.size);
-  m_fs->append(m_fd, buf, m_flush_method);
-  
+  return length;
 }
 
-void Writer::service_write_queue() {
 
-  if (!m_write_ready)
+void Writer::finish_compaction() {
+  string filename = m_path + "/" + m_compaction_id;
+  string backup_filename = m_backup_path + "/" + m_compaction_id;
+  int backup_fd;
+
+  // The backup is renamed first since the reader only verifies backups of
+  // files that exist in the FS
+  ::close(m_compaction_backup_fd);
+  m_compaction_backup_fd = -1;
+  if (!FileUtils::rename(m_compaction_backup_filename, backup_filename)) {
+    HT_ERRORF("Problem renaming metalog backup %s to %s",
+              m_compaction_backup_filename.c_str(), backup_filename.c_str());
+    abandon_compaction();
     return;
+  }
+  m_compaction_backup_filename = backup_filename;
+
+  try {
+    m_fs->rename(m_compaction_filename, filename);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << "Problem renaming metalog " << m_compaction_filename
+                 << " to " << filename << " - " << e << HT_END;
+    abandon_compaction();
+    return;
+  }
+
+  backup_fd = ::open(backup_filename.c_str(), O_WRONLY|O_APPEND);
+  if (backup_fd == -1)
+    HT_FATALF("Unable to reopen metalog backup %s - %s",
+              backup_filename.c_str(), strerror(errno));
+
+  // Switch over to compacted file
+  try {
+    m_fs->close(m_fd);
+  }
+  catch (Exception &e) {
+    HT_WARN_OUT << "Problem closing metalog " << m_filename << " - " << e
+                << HT_END;
+  }
+  ::close(m_backup_fd);
+
+  HT_INFOF("Compacted metalog %s (%lld bytes) into %s (%lld bytes)",
+           m_filename.c_str(), (Lld)m_offset, filename.c_str(),
+           (Lld)m_compaction_offset);
+
+  m_fd = m_compaction_fd;
+  m_backup_fd = backup_fd;
+  m_filename = filename;
+  m_backup_filename = backup_filename;
+  m_offset = m_compaction_offset;
+  m_file_ids.push_front(m_compaction_id);
+
+  m_compaction_fd = -1;
+  m_compaction_filename.clear();
+  m_compaction_backup_filename.clear();
+  m_compaction_offset = 0;
+  m_compaction_pending.clear();
+
+  purge_old_log_files();
+}
+
+
+void Writer::abandon_compaction() {
+  if (m_compaction_fd != -1) {
+    try {
+      m_fs->close(m_compaction_fd);
+      m_fs->remove(m_compaction_filename);
+    }
+    catch (Exception &e) {
+      HT_WARN_OUT << "Problem removing metalog compaction file "
+                  << m_compaction_filename << " - " << e << HT_END;
+    }
+    m_compaction_fd = -1;
+  }
+  if (m_compaction_backup_fd != -1) {
+    ::close(m_compaction_backup_fd);
+    m_compaction_backup_fd = -1;
+  }
+  if (!m_compaction_backup_filename.empty() &&
+      FileUtils::exists(m_compaction_backup_filename))
+    FileUtils::unlink(m_compaction_backup_filename);
+  m_compaction_filename.clear();
+  m_compaction_backup_filename.clear();
+  m_compaction_offset = 0;
+  m_compaction_pending.clear();
+}
+
+void Writer::service_write_queue(unique_lock<mutex> &lock) {
 
   m_write_ready = false;
 
-  if (!m_write_queue.empty()) {
-    size_t total {};
-    for (auto & sb : m_write_queue)
-      total += sb->size;
+  if (m_write_queue.empty())
+    return;
+
+  vector<SerializedEntityT> batch;
+  batch.swap(m_write_queue);
+  uint64_t sequence = m_queued_sequence;
+
+  size_t total {};
+  for (auto &entry : batch)
+    total += entry.first;
+
+  // Next chunk of live entities to copy into the compaction file
+  vector<SerializedEntityT> chunk;
+  bool compacting = m_compaction_fd != -1;
+  bool last_chunk {};
+  if (compacting)
+    last_chunk = next_compaction_chunk(chunk);
 
+  m_writing = true;
+  lock.unlock();
+
+  try {
     StaticBuffer buf(total);
     uint8_t *ptr = buf.base;
-
-    for (auto & sb : m_write_queue) {
-      memcpy(ptr, sb->base, sb->size);
-      ptr += sb->size;
+    for (auto &entry : batch) {
+      memcpy(ptr, entry.second.get(), entry.first);
+      ptr += entry.first;
     }
     HT_ASSERT((ptr-buf.base) == (ptrdiff_t)buf.size);
 
-    m_offset += buf.size;
-
     FileUtils::write(m_backup_fd, buf.base, buf.size);
     m_fs->append(m_fd, buf, m_flush_method);
+  }
+  catch (Exception &e) {
+    lock.lock();
+    m_writing = false;
+    m_write_queue.insert(m_write_queue.begin(), batch.begin(), batch.end());
+    if (compacting)
+      abandon_compaction();
+    m_write_scheduler->schedule();
+    m_cond.notify_all();
+    HT_THROW2F(e.code(), e, "Error writing metalog: %s", m_filename.c_str());
+  }
 
-    m_write_queue.clear();
+  size_t compaction_length {};
+  if (compacting) {
+    try {
+      compaction_length = write_compaction(chunk, batch, last_chunk);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << "Problem writing metalog compaction file "
+                   << m_compaction_filename << " - " << e << HT_END;
+      compacting = false;
+    }
+  }
+
+  lock.lock();
 
-    if (m_offset > m_max_file_size)
-      roll();
+  m_writing = false;
+  m_offset += total;
+  m_persisted_sequence = sequence;
+
+  if (m_compaction_fd != -1) {
+    if (!compacting)
+      abandon_compaction();
+    else {
+      m_compaction_offset += compaction_length;
+      if (last_chunk)
+        finish_compaction();
+    }
   }
+  else if (m_offset > m_max_file_size)
+    start_compaction();
 
+  m_cond.notify_all();
 }
 
 
@@ -295,9 +485,7 @@ void Writer::WriteScheduler::handle(EventPtr &event) {
 }
 
 
-void Writer::write_header() {
-  StaticBuffer buf(Header::LENGTH);
-  uint8_t backup_buf[Header::LENGTH];
+void Writer::encode_header(uint8_t **bufp) {
   Header header;
 
   assert(strlen(m_definition->name()) < sizeof(header.name));
@@ -306,9 +494,17 @@ void Writer::write_header() {
   memset(header.name, 0, sizeof(header.name));
   strcpy(header.name, m_definition->name());
 
+  header.encode(bufp);
+}
+
+
+void Writer::write_header() {
+  StaticBuffer buf(Header::LENGTH);
+  uint8_t backup_buf[Header::LENGTH];
+
   uint8_t *ptr = buf.base;
 
-  header.encode(&ptr);
+  encode_header(&ptr);
 
   assert((ptr-buf.base) == Header::LENGTH);
   memcpy(backup_buf, buf.base, Header::LENGTH);
@@ -323,164 +519,136 @@ void Writer::write_header() {
 }
 
 
-void Writer::record_state(EntityPtr entity) {
-  unique_lock<mutex> lock(m_mutex);
-  size_t length;
-  StaticBufferPtr buf;
+uint64_t Writer::serialize(Entity *entity, SerializedEntityT &serialized) {
+  size_t length = EntityHeader::LENGTH +
+    (entity->marked_for_removal() ? 0 : entity->encoded_length());
+  shared_ptr<uint8_t> buf(new uint8_t [length], default_delete<uint8_t[]>());
+  uint8_t *ptr = buf.get();
 
-  if (m_fd == -1)
-    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
+  if (entity->marked_for_removal())
+    entity->header.encode( &ptr );
+  else
+    entity->encode_entry( &ptr );
 
-  {
-    lock_guard<Entity> lock(*entity);
-    length = EntityHeader::LENGTH + (entity->marked_for_removal() ? 0 : entity->encoded_length());
-    buf = make_shared<StaticBuffer>(length);
-    uint8_t *ptr = buf->base;
+  HT_ASSERT((size_t)(ptr-buf.get()) == length);
 
-    if (entity->marked_for_removal())
-      entity->header.encode( &ptr );
-    else
-      entity->encode_entry( &ptr );
+  serialized = SerializedEntityT(length, buf);
+  return ++g_serialization_sequence;
+}
 
-    HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
-  }
 
-  shared_ptr<uint8_t> backup_buf(new uint8_t [length], default_delete<uint8_t[]>());
-  memcpy(backup_buf.get(), buf->base, buf->size);
+void Writer::enqueue(Entity *entity, uint64_t sequence,
+                     SerializedEntityT &serialized) {
 
-  // Add to entity map
-  if (dynamic_cast<EntityRecover *>(entity.get()) == nullptr) {
+  // Drop if a more recent serialization has already been queued
+  if (sequence <= entity->m_queued_sequence)
+    return;
+  entity->m_queued_sequence = sequence;
+
+  // Update entity map
+  if (dynamic_cast<EntityRecover *>(entity) == nullptr) {
     m_entity_map.erase(entity->header.id);
     if (!entity->marked_for_removal())
-      m_entity_map[entity->header.id] = SerializedEntityT(length, backup_buf);
+      m_entity_map[entity->header.id] = serialized;
   }
 
-  m_write_queue.push_back(buf);
-
-  m_write_scheduler->schedule();
-
-  m_cond.wait(lock);
-
-  service_write_queue();
+  m_write_queue.push_back(serialized);
+  m_queued_sequence++;
 }
 
-void Writer::record_state(std::vector<EntityPtr> &entities) {
-  unique_lock<mutex> lock(m_mutex);
-  shared_ptr<StaticBuffer> buffers( new StaticBuffer[entities.size()], default_delete<StaticBuffer[]>() );
-  uint8_t *ptr;
-  size_t length = 0;
-  size_t total_length = 0;
 
-  if (entities.empty())
+void Writer::wait_for_write(unique_lock<mutex> &lock) {
+  uint64_t sequence = m_queued_sequence;
+
+  if (m_persisted_sequence >= sequence)
     return;
 
-  if (m_fd == -1)
-    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
+  m_write_scheduler->schedule();
 
-  size_t i=0;
-  for (auto & entity : entities) {
-    lock_guard<Entity> lock(*entity);
-    length = EntityHeader::LENGTH + (entity->marked_for_removal() ? 0 : entity->encoded_length());
-    buffers.get()[i].set(new uint8_t [length], length);
-    ptr = buffers.get()[i].base;
-    if (entity->marked_for_removal())
-      entity->header.encode( &ptr );
+  while (m_persisted_sequence < sequence) {
+    if (m_write_ready && !m_writing)
+      service_write_queue(lock);
     else
-      entity->encode_entry( &ptr );
+      m_cond.wait(lock);
+  }
+}
 
-    // Add to entity map
-    HT_ASSERT(dynamic_cast<EntityRecover *>(entity.get()) == nullptr);
-    m_entity_map.erase(entity->header.id);
-    if (!entity->marked_for_removal()) {
-      shared_ptr<uint8_t> backup_buf(new uint8_t [length], default_delete<uint8_t[]>());
-      memcpy(backup_buf.get(), buffers.get()[i].base, length);
-      m_entity_map[entity->header.id] = SerializedEntityT(length, backup_buf);
-    }
 
-    HT_ASSERT((ptr-buffers.get()[i].base) == (ptrdiff_t)buffers.get()[i].size);
-    total_length += length;
-    i++;
-  }
+void Writer::record_state(EntityPtr entity) {
+  SerializedEntityT serialized;
+  uint64_t sequence;
 
-  StaticBufferPtr buf = make_shared<StaticBuffer>(total_length);
-  ptr = buf->base;
-  for (i=0; i<entities.size(); i++) {
-    memcpy(ptr, buffers.get()[i].base, buffers.get()[i].size);
-    ptr += buffers.get()[i].size;
+  {
+    lock_guard<Entity> entity_lock(*entity);
+    sequence = serialize(entity.get(), serialized);
   }
-  HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
-
-  m_write_queue.push_back(buf);
 
-  m_write_scheduler->schedule();
+  unique_lock<mutex> lock(m_mutex);
 
-  m_cond.wait(lock);
+  if (m_fd == -1)
+    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
 
-  service_write_queue();
+  enqueue(entity.get(), sequence, serialized);
 
+  wait_for_write(lock);
 }
 
-void Writer::record_removal(EntityPtr entity) {
-  unique_lock<mutex> lock(m_mutex);
-  StaticBufferPtr buf = make_shared<StaticBuffer>(EntityHeader::LENGTH);
-  uint8_t *ptr = buf->base;
-
-  if (m_fd == -1)
-    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
+void Writer::record_state(std::vector<EntityPtr> &entities) {
 
-  entity->header.flags |= EntityHeader::FLAG_REMOVE;
-  entity->header.length = 0;
-  entity->header.checksum = 0;
+  if (entities.empty())
+    return;
 
-  entity->header.encode( &ptr );
+  vector<SerializedEntityT> serialized(entities.size());
+  vector<uint64_t> sequence(entities.size());
 
-  HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
+  for (size_t i=0; i<entities.size(); i++) {
+    HT_ASSERT(dynamic_cast<EntityRecover *>(entities[i].get()) == nullptr);
+    lock_guard<Entity> entity_lock(*entities[i]);
+    sequence[i] = serialize(entities[i].get(), serialized[i]);
+  }
 
-  // Remove from entity map
-  m_entity_map.erase(entity->header.id);
+  unique_lock<mutex> lock(m_mutex);
 
-  m_write_queue.push_back(buf);
+  if (m_fd == -1)
+    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
 
-  m_write_scheduler->schedule();
+  for (size_t i=0; i<entities.size(); i++)
+    enqueue(entities[i].get(), sequence[i], serialized[i]);
 
-  m_cond.wait(lock);
+  wait_for_write(lock);
+}
 
-  service_write_queue();
+void Writer::record_removal(EntityPtr entity) {
+  vector<EntityPtr> entities;
+  entities.push_back(entity);
+  record_removal(entities);
 }
 
 
 void Writer::record_removal(std::vector<EntityPtr> &entities) {
-  unique_lock<mutex> lock(m_mutex);
 
   if (entities.empty())
     return;
 
-  if (m_fd == -1)
-    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
-
-  size_t length = entities.size() * EntityHeader::LENGTH;
-  StaticBufferPtr buf = make_shared<StaticBuffer>(length);
-  uint8_t *ptr = buf->base;
+  vector<SerializedEntityT> serialized(entities.size());
+  vector<uint64_t> sequence(entities.size());
 
-  for (auto &entity : entities) {
-    entity->header.flags |= EntityHeader::FLAG_REMOVE;
-    entity->header.length = 0;
-    entity->header.checksum = 0;
-    entity->header.encode( &ptr );
-    // Remove from entity map
-    m_entity_map.erase(entity->header.id);
+  for (size_t i=0; i<entities.size(); i++) {
+    entities[i]->header.flags |= EntityHeader::FLAG_REMOVE;
+    entities[i]->header.length = 0;
+    entities[i]->header.checksum = 0;
+    sequence[i] = serialize(entities[i].get(), serialized[i]);
   }
 
-  HT_ASSERT((ptr-buf->base) == (ptrdiff_t)buf->size);
-
-  m_write_queue.push_back(buf);
-
-  m_write_scheduler->schedule();
+  unique_lock<mutex> lock(m_mutex);
 
-  m_cond.wait(lock);
+  if (m_fd == -1)
+    HT_THROWF(Error::CLOSED, "MetaLog '%s' has been closed", m_path.c_str());
 
-  service_write_queue();
+  for (size_t i=0; i<entities.size(); i++)
+    enqueue(entities[i].get(), sequence[i], serialized[i]);
 
+  wait_for_write(lock);
 }
 
 
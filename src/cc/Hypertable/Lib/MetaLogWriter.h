@@ -186,11 +186,57 @@ namespace Hypertable {
 
       typedef std::shared_ptr<WriteScheduler> WriteSchedulerPtr;
 
+      // Serialized entity (length and smart pointer to buffer)
+      typedef std::pair<size_t, std::shared_ptr<uint8_t>> SerializedEntityT;
+
+      /** Serializes an entity.
+       * Encodes <code>entity</code> into a newly allocated buffer (just the
+       * header if the entity is marked for removal).  The caller is expected
+       * to hold the entity's lock.  This method is called <i>before</i>
+       * acquiring #m_mutex so that entities being recorded by concurrent
+       * threads are encoded in parallel.
+       * @param entity %Entity to serialize
+       * @param serialized Output parameter to hold serialized entity
+       * @return Serialization sequence number assigned to <code>entity</code>
+       */
+      uint64_t serialize(Entity *entity, SerializedEntityT &serialized);
+
+      /** Adds a serialized entity to the write queue.
+       * If a more recent serialization of <code>entity</code> has already
+       * been queued (i.e. a concurrent thread serialized it later but queued
+       * it first), the stale serialization is dropped.  Otherwise the entity
+       * map is updated (unless <code>entity</code> is a RecoverEntity) and
+       * the serialized entity is appended to #m_write_queue.  The caller must
+       * hold #m_mutex.
+       * @param entity %Entity that was serialized
+       * @param sequence Serialization sequence number returned by serialize()
+       * @param serialized Serialized entity
+       */
+      void enqueue(Entity *entity, uint64_t sequence,
+                   SerializedEntityT &serialized);
+
+      /** Waits for queued writes to be persisted (group commit).
+       * Schedules a deferred write and then waits until all writes queued so
+       * far have been persisted.  The first waiting thread to observe the
+       * write scheduler signal while no write is in progress becomes the
+       * leader and writes the whole queue on behalf of all waiters with a
+       * call to service_write_queue().
+       * @param lock Lock on #m_mutex
+       */
+      void wait_for_write(std::unique_lock<std::mutex> &lock);
+
+      /** Encodes %MetaLog file header.
+       * This method initializes a MetaLog::Header object with the name and
+       * version obtained by calling the methods Definition::name() and
+       * Definition::version() of #m_definition and encodes it at
+       * <code>*bufp</code>, advancing it by Header::LENGTH.
+       * @param bufp Address of destination buffer pointer
+       */
+      void encode_header(uint8_t **bufp);
+
       /** Writes %MetaLog file header.
-       * This method writes a %MetaLog file header to the open %MetaLog file
-       * by initializing a MetaLog::Header object with the name and version
-       * obtained by calling the methods Definition::name() and
-       * Definition::version() of #m_definition.  First the file header is
+       * This method writes a %MetaLog file header, encoded with
+       * encode_header(), to the open %MetaLog file.  First the file header is
        * appended to the local backup file and then to the log file in the FS.
        * #m_offset is incremented by the length of the serialized file header
        * (Header::LENGTH).
@@ -207,9 +253,72 @@ namespace Hypertable {
        */
       void purge_old_log_files();
 
-      void roll();
+      /** Starts an incremental compaction of the log.
+       * Called after a group commit leaves #m_offset larger than
+       * #m_max_file_size.  Creates the next log file under a temporary name
+       * (<code>&lt;id&gt;.tmp</code>, in both the FS and the backup
+       * directory) and records the IDs of all live entities in
+       * #m_compaction_pending.  The live entities are then copied into the
+       * new file a chunk at a time by subsequent group commits (see
+       * next_compaction_chunk()), so no single write has to rewrite the
+       * whole entity map.  The caller must hold #m_mutex.
+       */
+      void start_compaction();
+
+      /** Gathers the next chunk of live entities to compact.
+       * Pops entity IDs off #m_compaction_pending and adds the current
+       * serialization of each entity still present in #m_entity_map to
+       * <code>chunk</code>, until at least
+       * <code>Hypertable.MetaLog.CompactionChunkSize</code> bytes have been
+       * gathered.  The caller must hold #m_mutex.
+       * @param chunk Output vector of serialized entities
+       * @return <i>true</i> if this is the last chunk, <i>false</i> otherwise
+       */
+      bool next_compaction_chunk(std::vector<SerializedEntityT> &chunk);
+
+      /** Appends a compaction step to the compaction file.
+       * Writes <code>chunk</code> followed by <code>batch</code> (the group
+       * commit being written to the current log) to the compaction file, so
+       * that updates made after compaction started are reflected in the new
+       * file.  The file header precedes the first step and a RecoverEntity
+       * follows the last one.  Called with #m_mutex released.
+       * @param chunk Chunk of live entities from next_compaction_chunk()
+       * @param batch Group commit batch
+       * @param last <i>true</i> if <code>chunk</code> is the last chunk
+       * @return Number of bytes written
+       */
+      size_t write_compaction(std::vector<SerializedEntityT> &chunk,
+                              std::vector<SerializedEntityT> &batch, bool last);
+
+      /** Switches the log over to the compaction file.
+       * Renames the compaction file and its backup to their final numeric
+       * names, makes them the current log (#m_fd and #m_backup_fd), closes
+       * the previous log and purges old log files.  A crash before the
+       * rename leaves the previous, complete log as the most recent one.  If
+       * the switch fails, the compaction is abandoned and logging continues
+       * to the previous log.  The caller must hold #m_mutex.
+       */
+      void finish_compaction();
 
-      void service_write_queue();
+      /** Abandons an in-progress compaction.
+       * Closes and removes the compaction file and its backup.  The caller
+       * must hold #m_mutex.
+       */
+      void abandon_compaction();
+
+      /** Writes queued entities to the log.
+       * Combines all buffers in #m_write_queue into a single append that is
+       * issued with #m_mutex released, so that threads may continue queueing
+       * entities for the next group commit while the write is in progress.
+       * If a compaction is in progress, the batch and the next chunk of
+       * live entities are also appended to the compaction file.
+       * Upon completion #m_persisted_sequence is advanced and waiters are
+       * notified.  If the write fails, the batch is put back at the front of
+       * the queue and another write is scheduled before the exception is
+       * rethrown.
+       * @param lock Lock on #m_mutex
+       */
+      void service_write_queue(std::unique_lock<std::mutex> &lock);
 
       /// %Mutex for serializing access to members
       std::mutex m_mutex;
@@ -259,21 +368,51 @@ namespace Hypertable {
       /// Log flush method (FLUSH or SYNC)
       Filesystem::Flags m_flush_method {};
 
-      // Serialized entity (length and smart pointer to buffer)
-      typedef std::pair<size_t, std::shared_ptr<uint8_t>> SerializedEntityT;
-
       /// Map of current serialized entity data
       std::map<int64_t, SerializedEntityT> m_entity_map;
 
-      /// Flag indicating that 
+      /// Flag indicating that write scheduler interval has elapsed
       bool m_write_ready {};
 
-      /// Vector of pending writes
-      std::vector<StaticBufferPtr> m_write_queue;
+      /// Flag indicating that a group commit write is in progress
+      bool m_writing {};
+
+      /// Vector of pending writes (buffers shared with #m_entity_map)
+      std::vector<SerializedEntityT> m_write_queue;
+
+      /// Sequence number of last write added to #m_write_queue
+      uint64_t m_queued_sequence {};
+
+      /// Sequence number of last write persisted to the log
+      uint64_t m_persisted_sequence {};
 
       /// Write scheduler
       WriteSchedulerPtr m_write_scheduler;
 
+      /// Number of bytes of live entities to copy per compaction step
+      int64_t m_compaction_chunk_size {};
+
+      /// File name ID of compaction file (valid if #m_compaction_fd != -1)
+      int32_t m_compaction_id {};
+
+      /// Temporary pathname of compaction file in FS
+      std::string m_compaction_filename;
+
+      /// Temporary pathname of compaction backup file
+      std::string m_compaction_backup_filename;
+
+      /// File descriptor of compaction file in FS (-1 if not compacting)
+      int m_compaction_fd {-1};
+
+      /// File descriptor of compaction backup file in local filesystem
+      int m_compaction_backup_fd {-1};
+
+      /// Number of bytes written to compaction file
+      int32_t m_compaction_offset {};
+
+      /// IDs of live entities not yet copied into compaction file
+      std::vector<int64_t> m_compaction_pending;
+
     };
 
     /// Smart pointer to Writer
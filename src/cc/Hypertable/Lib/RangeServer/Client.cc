@@ -30,6 +30,7 @@
 #include "Client.h"
 #include "Protocol.h"
 #include "Request/Parameters/AcknowledgeLoad.h"
+#include "Request/Parameters/AttachCellStores.h"
 #include "Request/Parameters/CommitLogSync.h"
 #include "Request/Parameters/Compact.h"
 #include "Request/Parameters/CreateScanner.h"
@@ -46,6 +47,7 @@
 #include "Request/Parameters/PhantomLoad.h"
 #include "Request/Parameters/PhantomPrepareRanges.h"
 #include "Request/Parameters/PhantomUpdate.h"
+#include "Request/Parameters/Profile.h"
 #include "Request/Parameters/RelinquishRange.h"
 #include "Request/Parameters/ReplayFragments.h"
 #include "Request/Parameters/SetState.h"
@@ -65,6 +67,7 @@
 
 #include <Common/Config.h>
 #include <Common/Error.h>
+#include <Common/RequestTrace.h>
 #include <Common/StringExt.h>
 #include <Common/Serialization.h>
 
@@ -205,6 +208,7 @@ void Lib::RangeServer::Client::update(const CommAddress &addr, uint64_t cluster_
                     DispatchHandler *handler) {
 
   CommHeader header(Protocol::COMMAND_UPDATE);
+  header.set_trace_id(RequestTrace::current());
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
   Request::Parameters::Update params(cluster_id, table, count, flags);
@@ -218,6 +222,7 @@ Lib::RangeServer::Client::create_scanner(const CommAddress &addr,
     const TableIdentifier &table, const RangeSpec &range,
     const ScanSpec &scan_spec, DispatchHandler *handler) {
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
@@ -233,6 +238,7 @@ Lib::RangeServer::Client::create_scanner(const CommAddress &addr,
     const ScanSpec &scan_spec, DispatchHandler *handler,
     Timer &timer) {
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
@@ -267,6 +273,7 @@ Lib::RangeServer::Client::do_create_scanner(const CommAddress &addr,
   DispatchHandlerSynchronizer sync_handler;
   EventPtr event;
   CommHeader header(Protocol::COMMAND_CREATE_SCANNER);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   if (table.is_system())
     header.flags |= CommHeader::FLAGS_BIT_URGENT;
@@ -344,6 +351,7 @@ void
 Lib::RangeServer::Client::fetch_scanblock(const CommAddress &addr, int32_t scanner_id,
                         DispatchHandler *handler) {
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
@@ -356,6 +364,7 @@ void
 Lib::RangeServer::Client::fetch_scanblock(const CommAddress &addr, int32_t scanner_id,
                         DispatchHandler *handler, Timer &timer) {
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
@@ -382,6 +391,7 @@ Lib::RangeServer::Client::do_fetch_scanblock(const CommAddress &addr, int32_t sc
                            ScanBlock &scan_block, int32_t timeout_ms) {
   DispatchHandlerSynchronizer sync_handler;
   CommHeader header(Protocol::COMMAND_FETCH_SCANBLOCK);
+  header.set_trace_id(RequestTrace::current());
   header.flags |= CommHeader::FLAGS_BIT_PROFILE;
   header.gid = scanner_id;
   Request::Parameters::FetchScanblock params(scanner_id);
@@ -712,6 +722,23 @@ void Lib::RangeServer::Client::heapcheck(const CommAddress &addr, String &outfil
              + Hypertable::Protocol::string_format_message(event));
 }
 
+void Lib::RangeServer::Client::profile(const CommAddress &addr, int32_t action,
+                                       int32_t frequency,
+                                       const String &outfile) {
+  DispatchHandlerSynchronizer sync_handler;
+  CommHeader header(Protocol::COMMAND_PROFILE);
+  Request::Parameters::Profile params(action, frequency, outfile);
+  CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
+  params.encode(cbuf->get_data_ptr_address());
+  send_message(addr, cbuf, &sync_handler, m_default_timeout_ms);
+
+  EventPtr event;
+  if (!sync_handler.wait_for_reply(event))
+    HT_THROW(Hypertable::Protocol::response_code(event),
+             String("RangeServer profile() failure : ")
+             + Hypertable::Protocol::string_format_message(event));
+}
+
 void Lib::RangeServer::Client::replay_fragments(const CommAddress &addr, int64_t op_id,
     const String &recover_location, int plan_generation, int32_t type,
     const vector<int32_t> &fragments, const Lib::RangeServerRecovery::ReceiverPlan &plan,
@@ -844,6 +871,28 @@ void Lib::RangeServer::Client::table_maintenance_disable(const CommAddress &addr
   send_message(addr, cbuf, handler, m_default_timeout_ms);
 }
 
+void
+Lib::RangeServer::Client::attach_cellstores(const CommAddress &addr,
+                                            const TableIdentifier &table,
+                                            const RangeSpec &range_spec,
+                                            const vector<String> &access_groups,
+                                            const vector<String> &files) {
+  DispatchHandlerSynchronizer sync_handler;
+  EventPtr event;
+  CommHeader header(Protocol::COMMAND_ATTACH_CELLSTORES);
+  Request::Parameters::AttachCellStores params(table, range_spec,
+                                               access_groups, files);
+  CommBufPtr cbuf(new CommBuf(header, params.encoded_length()));
+  params.encode(cbuf->get_data_ptr_address());
+
+  send_message(addr, cbuf, &sync_handler, m_default_timeout_ms);
+
+  if (!sync_handler.wait_for_reply(event))
+    HT_THROW(Hypertable::Protocol::response_code(event),
+             String("RangeServer attach_cellstores() failure : ")
+             + Hypertable::Protocol::string_format_message(event));
+}
+
 
 void Lib::RangeServer::Client::send_message(const CommAddress &addr, CommBufPtr &cbuf,
                           DispatchHandler *handler, int32_t timeout_ms) {
@@ -465,6 +465,17 @@ namespace RangeServer {
      */
     void heapcheck(const CommAddress &addr, String &outfile);
 
+    /** Issues a "profile" request to control the CPU profiler.  This call
+     * blocks until it receives a response from the server.
+     * @param addr address of RangeServer
+     * @param action profiler action
+     * (Request::Parameters::Profile::Action)
+     * @param frequency sampling frequency for START, 0 for server default
+     * @param outfile output file to write folded stacks to for DUMP
+     */
+    void profile(const CommAddress &addr, int32_t action, int32_t frequency,
+                 const String &outfile);
+
     /** Issues a synchronous "replay_fragments" request.
      * @param addr Address of RangeServer
      * @param op_id ID of the calling recovery operation
@@ -561,6 +572,21 @@ namespace RangeServer {
                                    const TableIdentifier &table,
                                    DispatchHandler *handler);
 
+    /// Issues a synchronous RangeServer::attach_cellstores() request.
+    /// Asks the %RangeServer to move the staged CellStore files into the
+    /// range's access group directories and add them to the range.  The
+    /// <code>i</code>th element of <code>access_groups</code> names the
+    /// access group of the <code>i</code>th element of <code>files</code>.
+    /// @param addr Address of RangeServer
+    /// @param table %Table identifier
+    /// @param range_spec %Range specification
+    /// @param access_groups Access group names
+    /// @param files Pathnames of staged CellStore files
+    void attach_cellstores(const CommAddress &addr, const TableIdentifier &table,
+                           const RangeSpec &range_spec,
+                           const std::vector<String> &access_groups,
+                           const std::vector<String> &files);
+
   private:
     void do_load_range(const CommAddress &addr, const TableIdentifier &table,
                        const RangeSpec &range_spec, const RangeState &range_state,
@@ -85,6 +85,8 @@ namespace RangeServer {
       COMMAND_SET_STATE,
       COMMAND_TABLE_MAINTENANCE_ENABLE,
       COMMAND_TABLE_MAINTENANCE_DISABLE,
+      COMMAND_ATTACH_CELLSTORES,
+      COMMAND_PROFILE,
       COMMAND_MAX
     };
 
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for AttachCellStores request parameters.
+/// This file contains definitions for AttachCellStores, a class for encoding
+/// and decoding paramters to the <i>attach cellstores</i> %RangeServer
+/// function.
+
+#include <Common/Compat.h>
+
+#include "AttachCellStores.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib::RangeServer::Request::Parameters;
+
+uint8_t AttachCellStores::encoding_version() const {
+  return 1;
+}
+
+size_t AttachCellStores::encoded_length_internal() const {
+  size_t length = m_table.encoded_length() + m_range_spec.encoded_length() + 4;
+  for (size_t i=0; i<m_files.size(); i++)
+    length += Serialization::encoded_length_vstr(m_access_groups[i]) +
+      Serialization::encoded_length_vstr(m_files[i]);
+  return length;
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr>
+/// <th>Encoding</th>
+/// <th>Description</th>
+/// </tr>
+/// <tr>
+/// <td>TableIdentifier</td>
+/// <td>%Table identifier</td>
+/// </tr>
+/// <tr>
+/// <td>RangeSpec</td>
+/// <td>%Range specification</td>
+/// </tr>
+/// <tr>
+/// <td>i32</td>
+/// <td>Number of CellStore files</td>
+/// </tr>
+/// <tr>
+/// <td>For each file ...</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Access group name</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Staged CellStore pathname</td>
+/// </tr>
+/// </table>
+void AttachCellStores::encode_internal(uint8_t **bufp) const {
+  HT_ASSERT(m_access_groups.size() == m_files.size());
+  m_table.encode(bufp);
+  m_range_spec.encode(bufp);
+  Serialization::encode_i32(bufp, m_files.size());
+  for (size_t i=0; i<m_files.size(); i++) {
+    Serialization::encode_vstr(bufp, m_access_groups[i]);
+    Serialization::encode_vstr(bufp, m_files[i]);
+  }
+}
+
+void AttachCellStores::decode_internal(uint8_t version, const uint8_t **bufp,
+                                       size_t *remainp) {
+  m_table.decode(bufp, remainp);
+  m_range_spec.decode(bufp, remainp);
+  int32_t count = Serialization::decode_i32(bufp, remainp);
+  m_access_groups.clear();
+  m_files.clear();
+  for (int32_t i=0; i<count; i++) {
+    m_access_groups.push_back(Serialization::decode_vstr(bufp, remainp));
+    m_files.push_back(Serialization::decode_vstr(bufp, remainp));
+  }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for Profile request parameters.
+/// This file contains definitions for Profile, a class for encoding and
+/// decoding paramters to the <i>profile</i> %RangeServer function.
+
+#include <Common/Compat.h>
+
+#include "Profile.h"
+
+#include <Common/Logger.h>
+#include <Common/Serialization.h>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib::RangeServer::Request::Parameters;
+
+uint8_t Profile::encoding_version() const {
+  return 1;
+}
+
+size_t Profile::encoded_length_internal() const {
+  return 8 + Serialization::encoded_length_vstr(m_fname);
+}
+
+/// @details
+/// Encoding is as follows:
+/// <table>
+/// <tr>
+/// <th>Encoding</th>
+/// <th>Description</th>
+/// </tr>
+/// <tr>
+/// <td>i32</td>
+/// <td>Profiler action</td>
+/// </tr>
+/// <tr>
+/// <td>i32</td>
+/// <td>Sampling frequency</td>
+/// </tr>
+/// <tr>
+/// <td>vstr</td>
+/// <td>Output file name</td>
+/// </tr>
+/// </table>
+void Profile::encode_internal(uint8_t **bufp) const {
+  Serialization::encode_i32(bufp, m_action);
+  Serialization::encode_i32(bufp, m_frequency);
+  Serialization::encode_vstr(bufp, m_fname);
+}
+
+void Profile::decode_internal(uint8_t version, const uint8_t **bufp,
+			     size_t *remainp) {
+  m_action = Serialization::decode_i32(bufp, remainp);
+  m_frequency = Serialization::decode_i32(bufp, remainp);
+  m_fname = Serialization::decode_vstr(bufp, remainp);
+}
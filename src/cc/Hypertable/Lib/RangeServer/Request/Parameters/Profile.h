@@ -0,0 +1,117 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for Profile request parameters.
+/// This file contains declarations for Profile, a class for encoding and
+/// decoding paramters to the <i>profile</i> %RangeServer function.
+
+#ifndef Hypertable_Lib_RangeServer_Request_Parameters_Profile_h
+#define Hypertable_Lib_RangeServer_Request_Parameters_Profile_h
+
+#include <Common/Serializable.h>
+
+#include <string>
+
+namespace Hypertable {
+namespace Lib {
+namespace RangeServer {
+namespace Request {
+namespace Parameters {
+
+  /// @addtogroup libHypertableRangeServerRequestParameters
+  /// @{
+
+  /// %Request parameters for <i>profile</i> function.
+  class Profile : public Serializable {
+  public:
+
+    /// CPU profiler action
+    enum Action {
+      START = 1, //!< Start profiler
+      STOP = 2,  //!< Stop profiler
+      DUMP = 3   //!< Write folded stacks to output file
+    };
+
+    /// Constructor.
+    /// Empty initialization for decoding.
+    Profile() {}
+
+    /// Constructor.
+    /// Initializes with parameters for encoding.
+    /// @param action Profiler action
+    /// @param frequency Sampling frequency for START, 0 for server default
+    /// @param fname Output file name for DUMP
+    Profile(int32_t action, int32_t frequency, const std::string &fname)
+      : m_action(action), m_frequency(frequency), m_fname(fname) { }
+
+    /// Gets profiler action
+    /// @return Profiler action
+    int32_t action() { return m_action; }
+
+    /// Gets sampling frequency
+    /// @return Sampling frequency, 0 for server default
+    int32_t frequency() { return m_frequency; }
+
+    /// Gets output file name
+    /// @return Output file name
+    const char *fname() { return m_fname.c_str(); }
+
+  private:
+
+    /// Returns encoding version.
+    /// @return Encoding version
+    uint8_t encoding_version() const override;
+
+    /// Returns internal serialized length.
+    /// @return Internal serialized length
+    /// @see encode_internal() for encoding format
+    size_t encoded_length_internal() const override;
+
+    /// Writes serialized representation of object to a buffer.
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    void encode_internal(uint8_t **bufp) const override;
+
+    /// Reads serialized representation of object from a buffer.
+    /// @param version Encoding version
+    /// @param bufp Address of destination buffer pointer (advanced by call)
+    /// @param remainp Address of integer holding amount of serialized object
+    /// remaining
+    /// @see encode_internal() for encoding format
+    void decode_internal(uint8_t version, const uint8_t **bufp,
+			 size_t *remainp) override;
+
+    /// Profiler action
+    int32_t m_action {};
+
+    /// Sampling frequency
+    int32_t m_frequency {};
+
+    /// Output file name
+    std::string m_fname;
+
+  };
+
+  /// @}
+
+}}}}}
+
+#endif // Hypertable_Lib_RangeServer_Request_Parameters_Profile_h
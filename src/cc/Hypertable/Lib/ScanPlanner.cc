@@ -0,0 +1,301 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for ScanPlanner.
+/// This file contains type definitions for ScanPlanner, a class that decides
+/// whether a query with indexed predicates is answered through the secondary
+/// index or with a filtered scan of the primary table.
+
+#include <Common/Compat.h>
+
+#include "ScanPlanner.h"
+
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/RangeLocationInfo.h>
+#include <Hypertable/Lib/RangeLocator.h>
+#include <Hypertable/Lib/Table.h>
+#include <Hypertable/Lib/TableScanner.h>
+
+#include <Common/String.h>
+#include <Common/StringExt.h>
+#include <Common/Timer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *type_to_str(ScanPlan::Type type) {
+    switch (type) {
+    case ScanPlan::INDEX_SCAN:
+      return "INDEX_SCAN";
+    case ScanPlan::QUALIFIER_INDEX_SCAN:
+      return "QUALIFIER_INDEX_SCAN";
+    default:
+      break;
+    }
+    return "FULL_SCAN";
+  }
+
+}
+
+
+std::string ScanPlan::to_str() const {
+  ostringstream out;
+  out << "Plan: " << type_to_str(type) << "\n";
+  out << "Table: " << table_name << "\n";
+  if (cost_based) {
+    out << "IndexMatches: " << index_matches
+        << (index_matches_truncated ? "+" : "") << "\n";
+    out << "PrimaryRanges: " << primary_ranges << "\n";
+    out << "EstimatedScanBytes: " << scan_cost << "\n";
+    out << "EstimatedIndexBytes: " << index_cost
+        << (index_matches_truncated ? "+" : "") << "\n";
+  }
+  out << "Reason: " << reason << "\n";
+  return out.str();
+}
+
+
+bool ScanPlanner::full_scan_equivalent(const ScanSpec &spec) {
+  if (spec.columns.empty())
+    return false;
+  CstrSet predicate_columns;
+  for (const auto &cp : spec.column_predicates)
+    predicate_columns.insert(cp.column_family);
+  string family;
+  for (auto column : spec.columns) {
+    const char *colon = strchr(column, ':');
+    if (colon)
+      family.assign(column, colon - column);
+    else
+      family.assign(column);
+    if (predicate_columns.count(family.c_str()) == 0)
+      return false;
+  }
+  return true;
+}
+
+
+ScanPlanner::ScanPlanner(PropertiesPtr &props) {
+  m_cost_based = props->get_bool("Hypertable.Scanner.Planner.CostBased");
+  m_range_scan_cost =
+    std::max((int64_t)1,
+             props->get_i64("Hypertable.RangeServer.Range.SplitSize") / 2);
+  m_lookup_cost =
+    std::max(1, props->get_i32("Hypertable.Scanner.Planner.IndexLookupCost"));
+  m_max_probe_cells =
+    std::max(1, props->get_i32("Hypertable.Scanner.Planner.MaxProbeCells"));
+  m_estimate_ttl = std::chrono::milliseconds(
+    props->get_i32("Hypertable.Scanner.Planner.EstimateTTL"));
+}
+
+
+void ScanPlanner::choose(Table *table, const ScanSpec &primary_spec,
+                         const ScanSpec &index_spec, bool use_qualifier,
+                         uint32_t timeout_ms, ScanPlan &plan) {
+
+  if (lookup(table, primary_spec, use_qualifier, plan))
+    return;
+
+  Table *index_table = use_qualifier ?
+    table->get_qualifier_index_table().get() : table->get_index_table().get();
+
+  plan.primary_ranges = count_ranges(table, primary_spec, max_ranges(),
+                                     timeout_ms);
+  plan.index_matches = count_matches(index_table, index_spec,
+                                     probe_limit(plan.primary_ranges),
+                                     timeout_ms);
+  evaluate(table->get_name(), plan);
+
+  string key = cache_key(table, primary_spec, use_qualifier);
+  auto now = std::chrono::steady_clock::now();
+  lock_guard<mutex> lock(m_mutex);
+  if (m_plans.size() >= MAX_CACHED_PLANS) {
+    for (auto iter = m_plans.begin(); iter != m_plans.end(); ) {
+      if (iter->second.expire_time <= now)
+        iter = m_plans.erase(iter);
+      else
+        ++iter;
+    }
+    if (m_plans.size() >= MAX_CACHED_PLANS)
+      m_plans.clear();
+  }
+  CachedPlan &cached = m_plans[key];
+  cached.plan = plan;
+  cached.expire_time = now + m_estimate_ttl;
+}
+
+
+bool ScanPlanner::lookup(Table *table, const ScanSpec &primary_spec,
+                         bool use_qualifier, ScanPlan &plan) {
+
+  if (plan_without_statistics(table, primary_spec, use_qualifier, plan))
+    return true;
+
+  string key = cache_key(table, primary_spec, use_qualifier);
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_plans.find(key);
+  if (iter == m_plans.end())
+    return false;
+  if (iter->second.expire_time <= std::chrono::steady_clock::now()) {
+    m_plans.erase(iter);
+    return false;
+  }
+  plan = iter->second.plan;
+  return true;
+}
+
+
+void ScanPlanner::evaluate(const std::string &table_name,
+                           ScanPlan &plan) const {
+  plan.cost_based = true;
+  plan.scan_cost = plan.primary_ranges * m_range_scan_cost;
+
+  // Probing stopped as soon as the index plan could no longer win
+  int64_t cost_limit = plan.scan_cost / m_lookup_cost + 1;
+  int64_t limit = probe_limit(plan.primary_ranges);
+  plan.index_matches_truncated = plan.index_matches >= limit;
+  plan.index_cost = plan.index_matches * m_lookup_cost;
+
+  if (!plan.index_matches_truncated) {
+    plan.reason = "index lookups cheaper than scan";
+    return;
+  }
+
+  if (limit == cost_limit) {
+    plan.type = ScanPlan::FULL_SCAN;
+    plan.table_name = table_name;
+    plan.reason = "predicate not selective enough for index";
+    return;
+  }
+
+  plan.reason = format("index probe stopped after %lld matches",
+                       (Lld)plan.index_matches);
+}
+
+
+int64_t ScanPlanner::max_ranges() const {
+  return (m_max_probe_cells * m_lookup_cost) / m_range_scan_cost + 1;
+}
+
+
+int64_t ScanPlanner::probe_limit(int64_t primary_ranges) const {
+  int64_t cost_limit = (primary_ranges * m_range_scan_cost) / m_lookup_cost + 1;
+  return std::min(cost_limit, m_max_probe_cells);
+}
+
+
+bool ScanPlanner::plan_without_statistics(Table *table,
+                                          const ScanSpec &primary_spec,
+                                          bool use_qualifier, ScanPlan &plan) {
+  Table *index_table = use_qualifier ?
+    table->get_qualifier_index_table().get() : table->get_index_table().get();
+
+  plan.type = use_qualifier ? ScanPlan::QUALIFIER_INDEX_SCAN : ScanPlan::INDEX_SCAN;
+  plan.table_name = index_table->get_name();
+  plan.cost_based = false;
+
+  if (!m_cost_based) {
+    plan.reason = "cost-based planning disabled";
+    return true;
+  }
+
+  if (!full_scan_equivalent(primary_spec)) {
+    plan.reason = "selected columns not all referenced by predicates";
+    return true;
+  }
+
+  return false;
+}
+
+
+std::string ScanPlanner::cache_key(Table *table, const ScanSpec &primary_spec,
+                                   bool use_qualifier) {
+  ostringstream key;
+  key << table->get_name() << (use_qualifier ? " qualifier " : " value ")
+      << primary_spec;
+  return key.str();
+}
+
+
+int64_t ScanPlanner::count_ranges(Table *table, const ScanSpec &primary_spec,
+                                  int64_t limit, uint32_t timeout_ms) {
+  vector<pair<string, string>> intervals;
+
+  for (const auto &ri : primary_spec.row_intervals)
+    intervals.push_back(make_pair(ri.start ? ri.start : "",
+                                  (ri.end && *ri.end) ? ri.end : Key::END_ROW_MARKER));
+  for (const auto &ci : primary_spec.cell_intervals)
+    intervals.push_back(make_pair(ci.start_row ? ci.start_row : "",
+                                  (ci.end_row && *ci.end_row) ? ci.end_row : Key::END_ROW_MARKER));
+  if (intervals.empty())
+    intervals.push_back(make_pair(string(), string(Key::END_ROW_MARKER)));
+
+  TableIdentifier table_id;
+  table->get_identifier(&table_id);
+  RangeLocatorPtr range_locator = table->get_range_locator();
+  RangeLocationInfo range_info;
+  Timer timer(timeout_ms, true);
+  int64_t count = 0;
+  string row;
+
+  // Walk the ranges of each interval through the location cache, which the
+  // locator fills from sys/METADATA several ranges at a time
+  for (const auto &interval : intervals) {
+    row = interval.first;
+    while (count < limit) {
+      range_locator->find_loop(&table_id, row.c_str(), &range_info, timer,
+                               false);
+      count++;
+      if (range_info.end_row >= interval.second ||
+          range_info.end_row == Key::END_ROW_MARKER)
+        break;
+      // smallest row key that sorts after end_row
+      row = range_info.end_row;
+      row.append(1, (char)1);
+    }
+  }
+  return count;
+}
+
+
+int64_t ScanPlanner::count_matches(Table *index_table,
+                                   const ScanSpec &index_spec,
+                                   int64_t limit, uint32_t timeout_ms) {
+  ScanSpecBuilder ssb(index_spec);
+  ssb.set_keys_only(true);
+  ssb.set_row_limit(limit);
+
+  unique_ptr<TableScanner> scanner(index_table->create_scanner(ssb.get(),
+                                                               timeout_ms));
+  Cell cell;
+  int64_t count = 0;
+  while (count < limit && scanner->next(cell))
+    count++;
+  return count;
+}
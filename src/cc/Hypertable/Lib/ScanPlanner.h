@@ -0,0 +1,265 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for ScanPlanner.
+/// This file contains type declarations for ScanPlanner, a class that decides
+/// whether a query with indexed predicates is answered through the secondary
+/// index or with a filtered scan of the primary table.
+
+#ifndef Hypertable_Lib_ScanPlanner_h
+#define Hypertable_Lib_ScanPlanner_h
+
+#include <Hypertable/Lib/ScanSpec.h>
+
+#include <Common/Properties.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Hypertable {
+
+  class Table;
+
+  /// @addtogroup libHypertable
+  /// @{
+
+  /// Access path chosen for a scan.
+  class ScanPlan {
+  public:
+
+    /// Access path
+    enum Type {
+      /// Filtered scan of the primary table
+      FULL_SCAN,
+      /// Scan of the value index table followed by primary row lookups
+      INDEX_SCAN,
+      /// Scan of the qualifier index table followed by primary row lookups
+      QUALIFIER_INDEX_SCAN
+    };
+
+    /// Returns a string representation of the plan.
+    /// Used for the output of the HQL <code>EXPLAIN</code> command.
+    /// @return Multi-line description of the plan
+    std::string to_str() const;
+
+    /// Chosen access path
+    Type type {FULL_SCAN};
+
+    /// Name of the table scanned first
+    std::string table_name;
+
+    /// <i>true</i> if #type was chosen by comparing costs
+    bool cost_based {};
+
+    /// Number of index entries matching the predicates
+    int64_t index_matches {};
+
+    /// <i>true</i> if the probe stopped before counting all index entries,
+    /// in which case #index_matches is a lower bound
+    bool index_matches_truncated {};
+
+    /// Number of primary table ranges the filtered scan would read
+    int64_t primary_ranges {};
+
+    /// Estimated bytes read by filtered scan
+    int64_t scan_cost {};
+
+    /// Estimated bytes read by index scan and primary row lookups
+    int64_t index_cost {};
+
+    /// Reason for choice
+    std::string reason;
+  };
+
+  /// Chooses between an index scan and a filtered full scan.
+  /// An index scan costs one primary row lookup per matching index entry,
+  /// which is much slower per row than streaming a range, so an index is only
+  /// worth using for selective predicates.  The planner estimates both costs
+  /// in bytes read:
+  ///   - The filtered scan reads every range overlapping the query's row
+  ///     intervals, each half of <code>Hypertable.RangeServer.Range.SplitSize</code>
+  ///     on average.  The ranges are counted with the RangeLocator, which
+  ///     reads them from <code>sys/METADATA</code>.
+  ///   - The index scan costs <code>Hypertable.Scanner.Planner.IndexLookupCost</code>
+  ///     per matching index entry.  The matches are counted with a keys-only
+  ///     probe of the index table using the query's index scan spec, which is
+  ///     stopped as soon as the index plan can no longer win (and after at most
+  ///     <code>Hypertable.Scanner.Planner.MaxProbeCells</code> entries).
+  ///     Reading the index entries themselves is not counted.
+  ///
+  /// Gathering these statistics blocks, so scanners never call choose().
+  /// Instead, choose() caches each plan for
+  /// <code>Hypertable.Scanner.Planner.EstimateTTL</code> milliseconds and
+  /// scanners consult the cache with the non-blocking lookup(), using the
+  /// index whenever no fresh plan is cached.  Plans are computed by the HQL
+  /// <code>EXPLAIN</code> and <code>SELECT</code> commands.
+  class ScanPlanner {
+  public:
+
+    /// Constructor.
+    /// @param props Configuration properties
+    ScanPlanner(PropertiesPtr &props);
+
+    /// Checks if plans are chosen by comparing costs.
+    /// @return Value of <code>Hypertable.Scanner.Planner.CostBased</code>
+    bool cost_based() const { return m_cost_based; }
+
+    /// Chooses access path for a query on an indexed table.
+    /// Called once an index scan spec has been built for the query.
+    /// If lookup() finds a plan, it is returned, otherwise range and index
+    /// statistics are gathered, evaluated with evaluate(), and the resulting
+    /// plan is cached.  This method blocks while gathering statistics.
+    /// @param table Primary table
+    /// @param primary_spec Scan spec of the query
+    /// @param index_spec Scan spec for the index table
+    /// @param use_qualifier <i>true</i> if <code>index_spec</code> targets
+    /// the qualifier index table
+    /// @param timeout_ms Timeout for the statistics scans
+    /// @param plan Populated with chosen plan and cost estimates
+    void choose(Table *table, const Lib::ScanSpec &primary_spec,
+                const Lib::ScanSpec &index_spec, bool use_qualifier,
+                uint32_t timeout_ms, ScanPlan &plan);
+
+    /// Looks up access path for a query without blocking.
+    /// Plans that need no statistics (cost-based planning disabled, or a
+    /// query whose selected columns are not all referenced by predicates)
+    /// are always found; others are found only if choose() cached one for
+    /// the same query within the last
+    /// <code>Hypertable.Scanner.Planner.EstimateTTL</code> milliseconds.
+    /// @param table Primary table
+    /// @param primary_spec Scan spec of the query
+    /// @param use_qualifier <i>true</i> if the qualifier index table applies
+    /// @param plan Populated with plan, if found
+    /// @return <i>true</i> if plan was found, <i>false</i> otherwise
+    bool lookup(Table *table, const Lib::ScanSpec &primary_spec,
+                bool use_qualifier, ScanPlan &plan);
+
+    /// Chooses access path from gathered statistics.
+    /// Reads <code>plan.primary_ranges</code> and
+    /// <code>plan.index_matches</code>, which must have been counted with
+    /// limits of at most max_ranges() and probe_limit(), and fills in the
+    /// cost estimates, plan type and reason.  <code>plan.type</code> and
+    /// <code>plan.table_name</code> are expected to describe the index scan
+    /// and are only changed if a filtered scan is chosen.
+    /// @param table_name Name of primary table
+    /// @param plan Plan to populate
+    void evaluate(const std::string &table_name, ScanPlan &plan) const;
+
+    /// Gets number of ranges at which counting can stop.
+    /// Past this many ranges the filtered scan loses even against the
+    /// largest index cost the probe can measure.
+    /// @return Maximum number of primary ranges worth counting
+    int64_t max_ranges() const;
+
+    /// Gets number of index entries at which probing can stop.
+    /// @param primary_ranges Number of ranges the filtered scan would read
+    /// @return Maximum number of index entries worth counting
+    int64_t probe_limit(int64_t primary_ranges) const;
+
+    /// Checks if a filtered scan returns the same cells as an index scan.
+    /// An index scan returns the selected columns of every matching row,
+    /// whereas a filtered scan can only select columns referenced by a
+    /// predicate (see TableScannerAsync::transform_primary_scan_spec()), so
+    /// the two agree only if every selected column has a predicate.
+    /// @param spec Scan spec of the query
+    /// @return <i>true</i> if a filtered scan can answer <code>spec</code>
+    static bool full_scan_equivalent(const Lib::ScanSpec &spec);
+
+  private:
+
+    /// Cached plan
+    struct CachedPlan {
+      /// Plan chosen by choose()
+      ScanPlan plan;
+      /// Time after which #plan is no longer used
+      std::chrono::steady_clock::time_point expire_time;
+    };
+
+    /// Maximum number of cached plans
+    static const size_t MAX_CACHED_PLANS = 1024;
+
+    /// Builds plan for queries that need no statistics.
+    /// @param table Primary table
+    /// @param primary_spec Scan spec of the query
+    /// @param use_qualifier <i>true</i> if the qualifier index table applies
+    /// @param plan Populated with plan
+    /// @return <i>true</i> if <code>plan</code> is final, <i>false</i> if
+    /// statistics are needed
+    bool plan_without_statistics(Table *table, const Lib::ScanSpec &primary_spec,
+                                 bool use_qualifier, ScanPlan &plan);
+
+    /// Builds plan cache key for a query.
+    /// @param table Primary table
+    /// @param primary_spec Scan spec of the query
+    /// @param use_qualifier <i>true</i> if the qualifier index table applies
+    /// @return Cache key
+    std::string cache_key(Table *table, const Lib::ScanSpec &primary_spec,
+                          bool use_qualifier);
+
+    /// Counts ranges a filtered scan of <code>primary_spec</code> would read.
+    /// @param table Primary table
+    /// @param primary_spec Scan spec of the query
+    /// @param limit Number of ranges at which to stop counting
+    /// @param timeout_ms Timeout for the range lookups
+    /// @return Number of ranges, at most <code>limit</code>
+    int64_t count_ranges(Table *table, const Lib::ScanSpec &primary_spec,
+                         int64_t limit, uint32_t timeout_ms);
+
+    /// Counts index entries matching <code>index_spec</code>.
+    /// @param index_table Index table
+    /// @param index_spec Scan spec for the index table
+    /// @param limit Number of entries at which to stop counting
+    /// @param timeout_ms Timeout for the index scan
+    /// @return Number of matching entries, at most <code>limit</code>
+    int64_t count_matches(Table *index_table, const Lib::ScanSpec &index_spec,
+                          int64_t limit, uint32_t timeout_ms);
+
+    /// %Mutex serializing access to #m_plans
+    std::mutex m_mutex;
+
+    /// Cached plans, keyed by cache_key()
+    std::map<std::string, CachedPlan> m_plans;
+
+    /// Compare costs (from <code>Hypertable.Scanner.Planner.CostBased</code>)
+    bool m_cost_based {};
+
+    /// Bytes read by a filtered scan of one range
+    int64_t m_range_scan_cost {};
+
+    /// Bytes read per primary row lookup
+    int64_t m_lookup_cost {};
+
+    /// Maximum number of index entries probed
+    int64_t m_max_probe_cells {};
+
+    /// Time a cached plan is used
+    std::chrono::milliseconds m_estimate_ttl;
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_Lib_ScanPlanner_h
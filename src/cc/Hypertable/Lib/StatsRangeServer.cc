@@ -38,16 +38,20 @@ using namespace std;
 
 namespace {
   enum Group {
-    PRIMARY_GROUP = 0
+    PRIMARY_GROUP = 0,
+    LATENCY_GROUP = 1,
+    MEMORY_GROUP = 2
   };
 }
 
-StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer() : StatsSerializable(RANGE_SERVER, 3), timestamp(TIMESTAMP_MIN) {
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = LATENCY_GROUP;
+  group_ids[2] = MEMORY_GROUP;
 }
 
 
-StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 1), timestamp(TIMESTAMP_MIN) {
+StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RANGE_SERVER, 3), timestamp(TIMESTAMP_MIN) {
   const char *base, *ptr;
   string datadirs = props->get_str("Hypertable.RangeServer.Monitoring.DataDirectories");
 
@@ -83,6 +87,8 @@ StatsRangeServer::StatsRangeServer(PropertiesPtr &props) : StatsSerializable(RAN
                         StatsSystem::DISK|StatsSystem::SWAP|StatsSystem::NET|
                         StatsSystem::PROC | StatsSystem::FS, dirs);
   group_ids[0] = PRIMARY_GROUP;
+  group_ids[1] = LATENCY_GROUP;
+  group_ids[2] = MEMORY_GROUP;
 }
 
 StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSerializable(other.id, other.group_count) {
@@ -114,6 +120,8 @@ StatsRangeServer::StatsRangeServer(const StatsRangeServer &other) : StatsSeriali
   live = other.live;
   system = other.system;
   tables = other.tables;
+  latencies = other.latencies;
+  memory = other.memory;
 }
 
 bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
@@ -142,7 +150,9 @@ bool StatsRangeServer::operator==(const StatsRangeServer &other) const {
       !Serialization::equal(cpu_user, other.cpu_user) ||
       !Serialization::equal(cpu_sys, other.cpu_sys) ||
       live != other.live ||
-      system != other.system)
+      system != other.system ||
+      latencies != other.latencies ||
+      memory != other.memory)
     return false;
   if (tables.size() != other.tables.size())
     return false;
@@ -166,6 +176,24 @@ size_t StatsRangeServer::encoded_length_group(int group) const {
       len += tables[i].encoded_length();
     return len;
   }
+  else if (group == LATENCY_GROUP) {
+    size_t len = Serialization::encoded_length_vi32(latencies.size());
+    for (auto &latency : latencies)
+      len += Serialization::encoded_length_vstr(latency.name) +
+        Serialization::encoded_length_vi64(latency.count) +
+        Serialization::encoded_length_vi64(latency.p50) +
+        Serialization::encoded_length_vi64(latency.p90) +
+        Serialization::encoded_length_vi64(latency.p99) +
+        Serialization::encoded_length_vi64(latency.p999) +
+        Serialization::encoded_length_vi64(latency.max);
+    return len;
+  }
+  else if (group == MEMORY_GROUP) {
+    size_t len = Serialization::encoded_length_vi32(memory.size());
+    for (auto &entry : memory)
+      len += Serialization::encoded_length_vstr(entry.name) + 8;
+    return len;
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
   return 0;
@@ -203,6 +231,25 @@ void StatsRangeServer::encode_group(int group, uint8_t **bufp) const {
     for (size_t i=0; i<tables.size(); i++)
       tables[i].encode(bufp);
   }
+  else if (group == LATENCY_GROUP) {
+    Serialization::encode_vi32(bufp, latencies.size());
+    for (auto &latency : latencies) {
+      Serialization::encode_vstr(bufp, latency.name);
+      Serialization::encode_vi64(bufp, latency.count);
+      Serialization::encode_vi64(bufp, latency.p50);
+      Serialization::encode_vi64(bufp, latency.p90);
+      Serialization::encode_vi64(bufp, latency.p99);
+      Serialization::encode_vi64(bufp, latency.p999);
+      Serialization::encode_vi64(bufp, latency.max);
+    }
+  }
+  else if (group == MEMORY_GROUP) {
+    Serialization::encode_vi32(bufp, memory.size());
+    for (auto &entry : memory) {
+      Serialization::encode_vstr(bufp, entry.name);
+      Serialization::encode_i64(bufp, entry.bytes);
+    }
+  }
   else
     HT_FATALF("Invalid group number (%d)", group);
 }
@@ -243,6 +290,33 @@ void StatsRangeServer::decode_group(int group, uint16_t len, const uint8_t **buf
       tables.push_back(table);
     }
   }
+  else if (group == LATENCY_GROUP) {
+    size_t latency_count = Serialization::decode_vi32(bufp, remainp);
+    latencies.clear();
+    latencies.reserve(latency_count);
+    for (size_t i=0; i<latency_count; i++) {
+      StatsLatency latency;
+      latency.name = Serialization::decode_vstr(bufp, remainp);
+      latency.count = Serialization::decode_vi64(bufp, remainp);
+      latency.p50 = Serialization::decode_vi64(bufp, remainp);
+      latency.p90 = Serialization::decode_vi64(bufp, remainp);
+      latency.p99 = Serialization::decode_vi64(bufp, remainp);
+      latency.p999 = Serialization::decode_vi64(bufp, remainp);
+      latency.max = Serialization::decode_vi64(bufp, remainp);
+      latencies.push_back(latency);
+    }
+  }
+  else if (group == MEMORY_GROUP) {
+    size_t memory_count = Serialization::decode_vi32(bufp, remainp);
+    memory.clear();
+    memory.reserve(memory_count);
+    for (size_t i=0; i<memory_count; i++) {
+      StatsMemory entry;
+      entry.name = Serialization::decode_vstr(bufp, remainp);
+      entry.bytes = Serialization::decode_i64(bufp, remainp);
+      memory.push_back(entry);
+    }
+  }
   else {
     HT_WARNF("Unrecognized StatsRangeServer group %d, skipping...", group);
     (*bufp) += len;
@@ -39,6 +39,38 @@ namespace Hypertable {
 
   typedef std::map<const char*, StatsTable *, LtCstr> StatsTableMap;
 
+  /// Latency percentiles of one metric, in microseconds, over the statistics
+  /// gathering interval.
+  struct StatsLatency {
+    bool operator==(const StatsLatency &other) const {
+      return name == other.name && count == other.count && p50 == other.p50 &&
+        p90 == other.p90 && p99 == other.p99 && p999 == other.p999 &&
+        max == other.max;
+    }
+    bool operator!=(const StatsLatency &other) const {
+      return !(*this == other);
+    }
+    std::string name;
+    uint64_t count {};
+    int64_t p50 {};
+    int64_t p90 {};
+    int64_t p99 {};
+    int64_t p999 {};
+    int64_t max {};
+  };
+
+  /// Memory used by one range server subsystem.
+  struct StatsMemory {
+    bool operator==(const StatsMemory &other) const {
+      return name == other.name && bytes == other.bytes;
+    }
+    bool operator!=(const StatsMemory &other) const {
+      return !(*this == other);
+    }
+    std::string name;
+    int64_t bytes {};
+  };
+
   class StatsRangeServer : public StatsSerializable {
     
   public:
@@ -91,6 +123,8 @@ namespace Hypertable {
     StatsSystem system;
     std::vector<StatsTable> tables;
     StatsTableMap table_map;
+    std::vector<StatsLatency> latencies;
+    std::vector<StatsMemory> memory;
 
   protected:
     virtual size_t encoded_length_group(int group) const;
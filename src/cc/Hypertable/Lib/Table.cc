@@ -59,6 +59,8 @@ Table::Table(PropertiesPtr &props, RangeLocatorPtr &range_locator,
   if (!m_timeout_ms)
     m_timeout_ms = m_props->get_i32("Hypertable.Request.Timeout");
 
+  m_scan_planner.reset(new ScanPlanner(m_props));
+
   initialize();
 }
 
@@ -27,11 +27,13 @@
 #include <Hypertable/Lib/ScanSpec.h>
 #include <Hypertable/Lib/Schema.h>
 #include <Hypertable/Lib/RangeLocator.h>
+#include <Hypertable/Lib/ScanPlanner.h>
 #include <Hypertable/Lib/TableIdentifier.h>
 #include <Hypertable/Lib/RangeServer/Protocol.h>
 
 #include <AsyncComm/ApplicationQueueInterface.h>
 
+#include <memory>
 #include <mutex>
 
 namespace Hyperspace {
@@ -250,6 +252,10 @@ namespace Hypertable {
 
     RangeLocatorPtr get_range_locator() { return m_range_locator; }
 
+    /// Gets the planner that chooses between index and filtered scans.
+    /// @return Pointer to scan planner
+    ScanPlanner *get_scan_planner() { return m_scan_planner.get(); }
+
   private:
     void initialize();
     void refresh_if_required();
@@ -274,6 +280,7 @@ namespace Hypertable {
     TablePtr               m_index_table;
     TablePtr               m_qualifier_index_table;
     Namespace             *m_namespace;
+    std::unique_ptr<ScanPlanner> m_scan_planner;
   };
 
 }
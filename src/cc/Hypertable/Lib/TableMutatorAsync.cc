@@ -131,6 +131,12 @@ void TableMutatorAsync::initialize_indices(PropertiesPtr &props)
     return;
   }
 
+  // index tables are maintained by the RangeServers
+  if (props->get_bool("Hypertable.Index.Async", false)) {
+    m_use_index = false;
+    return;
+  }
+
   m_use_index = true;
 
   m_imc = make_shared<IndexMutatorCallback>(this, m_cb, m_max_memory);
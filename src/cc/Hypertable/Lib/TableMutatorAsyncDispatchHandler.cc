@@ -28,6 +28,7 @@
 
 #include <Common/Error.h>
 #include <Common/Logger.h>
+#include <Common/RequestTrace.h>
 
 using namespace Hypertable;
 using namespace Serialization;
@@ -43,6 +44,10 @@ TableMutatorAsyncDispatchHandler::TableMutatorAsyncDispatchHandler(
 void TableMutatorAsyncDispatchHandler::handle(EventPtr &event_ptr) {
   int32_t error;
 
+  if (m_send_buffer->trace_id)
+    RequestTrace::record(m_send_buffer->trace_id, RequestTrace::CLIENT_RPC,
+                         m_send_buffer->send_time, RequestTrace::now());
+
   if (event_ptr->type == Event::MESSAGE) {
     error = Protocol::response_code(event_ptr);
     if (error != Error::OK) {
@@ -50,6 +55,8 @@ void TableMutatorAsyncDispatchHandler::handle(EventPtr &event_ptr) {
           (error == Error::RANGESERVER_GENERATION_MISMATCH ||
            error == Error::TABLE_NOT_FOUND))
         m_send_buffer->add_retries_all(true, error);
+      else if (error == Error::RANGESERVER_OVERLOADED)
+        m_send_buffer->add_overload_retries();
       else
         m_send_buffer->add_errors_all(error);
     }
@@ -30,6 +30,7 @@
 
 #include <Common/Config.h>
 #include <Common/Random.h>
+#include <Common/RequestTrace.h>
 #include <Common/Timer.h>
 
 #include <Hypertable/Lib/ClusterId.h>
@@ -56,7 +57,7 @@ TableMutatorAsyncScatterBuffer::TableMutatorAsyncScatterBuffer(Comm *comm,
     m_range_server(comm, timeout_ms), m_table_identifier(*table_identifier),
     m_auto_refresh(auto_refresh), m_timeout_ms(timeout_ms),
     m_counter_value(9), m_timer(timeout_ms), m_id(id),
-    m_wait_time(ms_init_redo_wait_time) {
+    m_wait_time(ms_init_redo_wait_time), m_created(RequestTrace::now()) {
 
   HT_ASSERT(Config::properties);
 
@@ -305,7 +306,15 @@ void TableMutatorAsyncScatterBuffer::send(uint32_t flags) {
     /**
      * Send update
      */
+    send_buffer->trace_id = RequestTrace::sample();
+    if (send_buffer->trace_id) {
+      send_buffer->send_time = RequestTrace::now();
+      RequestTrace::record(send_buffer->trace_id, RequestTrace::CLIENT_BUFFER,
+                           m_created, send_buffer->send_time);
+    }
+
     try {
+      RequestTrace::Scope trace_scope(send_buffer->trace_id);
       m_send_flags = flags;
       send_buffer->pending_updates.own = false;
       m_range_server.update(send_buffer->addr, ClusterId::get(),
@@ -135,6 +135,8 @@ namespace Hypertable {
     uint32_t             m_send_flags {};
     uint32_t             m_wait_time;
     const static uint32_t ms_init_redo_wait_time=1000;
+    /// Creation time, start of RequestTrace::CLIENT_BUFFER spans
+    int64_t              m_created;
     bool dead {};
   };
 
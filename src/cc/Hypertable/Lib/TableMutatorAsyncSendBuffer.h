@@ -71,6 +71,15 @@ namespace Hypertable {
       }
     }
 
+    /// Retries all updates rejected by an overloaded range server.  The
+    /// range location is still valid, so unlike add_retries_all() it is not
+    /// invalidated.  The updates are resent after the redo back-off.
+    void add_overload_retries() {
+      accum.add(pending_updates.base, pending_updates.size);
+      counterp->set_retries();
+      retry_count = send_count;
+    }
+
     void add_errors(int error, uint32_t count, uint32_t offset, uint32_t len) {
       FailedRegionAsync failed;
       (void)count;
@@ -115,6 +124,10 @@ namespace Hypertable {
     std::vector<FailedRegionAsync> failed_regions;
     uint32_t send_count;
     uint32_t retry_count;
+    /// Trace ID of last update sent, 0 if not traced (see RequestTrace)
+    uint64_t trace_id {};
+    /// Time last update was sent, if traced
+    int64_t send_time {};
 
   private:
     const TableIdentifier *m_table_identifier;
@@ -57,11 +57,26 @@ TableScannerAsync::TableScannerAsync(Comm *comm,
   HT_ASSERT(timeout_ms);
 
   // can we optimize this query with an index?
-  if (!(flags & Table::SCANNER_FLAG_IGNORE_INDEX)
-      && use_index(table, scan_spec, index_spec,
-                   cell_predicates,
-                   &use_qualifier,
-                   &row_intervals_applied)) {
+  bool indexed = !(flags & Table::SCANNER_FLAG_IGNORE_INDEX)
+    && use_index(table, scan_spec, index_spec,
+                 cell_predicates,
+                 &use_qualifier,
+                 &row_intervals_applied);
+
+  // is the index cheaper than a filtered scan?  only plans that are already
+  // cached are considered, since gathering statistics would block
+  if (indexed) {
+    ScanPlan plan;
+    if (table->get_scan_planner()->lookup(table, scan_spec, use_qualifier,
+                                          plan) &&
+        plan.type == ScanPlan::FULL_SCAN) {
+      HT_DEBUGF("Scanning %s without index - %s", table->get_name().c_str(),
+                plan.reason.c_str());
+      indexed = false;
+    }
+  }
+
+  if (indexed) {
 
     first_pass_spec = &index_spec.get();
 
@@ -94,6 +109,27 @@ TableScannerAsync::TableScannerAsync(Comm *comm,
 }
 
 
+void TableScannerAsync::explain(Table *table, const ScanSpec &scan_spec,
+                                uint32_t timeout_ms, ScanPlan &plan) {
+  ScanSpecBuilder index_spec;
+  std::vector<CellPredicate> cell_predicates;
+  bool use_qualifier = false;
+  bool row_intervals_applied = false;
+
+  if (!use_index(table, scan_spec, index_spec, cell_predicates,
+                 &use_qualifier, &row_intervals_applied)) {
+    plan.type = ScanPlan::FULL_SCAN;
+    plan.table_name = table->get_name();
+    plan.cost_based = false;
+    plan.reason = "no index applies to predicates";
+    return;
+  }
+
+  table->get_scan_planner()->choose(table, scan_spec, index_spec.get(),
+                                    use_qualifier, timeout_ms, plan);
+}
+
+
 bool TableScannerAsync::use_index(Table *table, const ScanSpec &primary_spec, 
                                   ScanSpecBuilder &index_spec,
                                   std::vector<CellPredicate> &cell_predicates,
@@ -566,6 +602,16 @@ void TableScannerAsync::handle_error(int scanner_id, int error, const string &er
         abort = !(m_interval_scanners[scanner_id]->is_destroyed_scanner(is_create));
         next = !m_interval_scanners[scanner_id]->has_outstanding_requests();
         break;
+      case(Error::RANGESERVER_OVERLOADED):
+        // only scanner creation is subject to admission control
+        if (is_create)
+          abort = !(m_interval_scanners[scanner_id]->retry_or_abort(false, false,
+                      is_create, &next, error));
+        else {
+          next = m_interval_scanners[scanner_id]->abort(is_create);
+          abort = true;
+        }
+        break;
       case(Error::RANGESERVER_RANGE_NOT_FOUND):
       case(Error::COMM_NOT_CONNECTED):
       case(Error::COMM_BROKEN_CONNECTION):
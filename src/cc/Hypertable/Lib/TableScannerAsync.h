@@ -29,6 +29,7 @@
 #include <Hypertable/Lib/RangeLocator.h>
 #include <Hypertable/Lib/IntervalScannerAsync.h>
 #include <Hypertable/Lib/ScanBlock.h>
+#include <Hypertable/Lib/ScanPlanner.h>
 #include <Hypertable/Lib/Schema.h>
 #include <Hypertable/Lib/ResultCallback.h>
 #include <Hypertable/Lib/Table.h>
@@ -137,6 +138,19 @@ namespace Hypertable {
       profile_data = m_profile_data;
     }
 
+    /// Describes how a scan would be executed.
+    /// Builds the index scan spec for <code>scan_spec</code>, as the
+    /// constructor does, and asks the table's ScanPlanner to choose between
+    /// the index and a filtered scan.  This method blocks while the planner
+    /// gathers statistics, and the resulting plan is cached for use by
+    /// scanners subsequently created for the same query.
+    /// @param table %Table to scan
+    /// @param scan_spec Scan specification
+    /// @param timeout_ms Timeout for the planner's statistics scans
+    /// @param plan Populated with chosen plan
+    static void explain(Table *table, const ScanSpec &scan_spec,
+                        uint32_t timeout_ms, ScanPlan &plan);
+
   private:
     friend class IndexScannerCallback;
 
@@ -148,12 +162,12 @@ namespace Hypertable {
     void maybe_callback_error(int scanner_id, bool next);
     void wait_for_completion();
     void move_to_next_interval_scanner(int current_scanner);
-    bool use_index(Table *table, const ScanSpec &primary_spec, 
-                   ScanSpecBuilder &index_spec,
-                   std::vector<CellPredicate> &cell_predicates,
-                   bool *use_qualifier, bool *row_intervals_applied);
+    static bool use_index(Table *table, const ScanSpec &primary_spec, 
+                          ScanSpecBuilder &index_spec,
+                          std::vector<CellPredicate> &cell_predicates,
+                          bool *use_qualifier, bool *row_intervals_applied);
     void transform_primary_scan_spec(ScanSpecBuilder &primary_spec);
-    void add_index_row(ScanSpecBuilder &ssb, const char *row);
+    static void add_index_row(ScanSpecBuilder &ssb, const char *row);
 
     std::vector<IntervalScannerAsyncPtr>  m_interval_scanners;
     uint32_t            m_timeout_ms;
@@ -20,6 +20,7 @@
  */
 
 #include <Common/Compat.h>
+#include <Common/Checksum.h>
 #include <Common/Logger.h>
 
 #include <Hypertable/Lib/BlockCompressionCodec.h>
@@ -137,5 +138,41 @@ int main(int argc, char **argv) {
     HT_ASSERT(before == after);
   }
 
+  //
+  // Data checksum selection
+  //
+
+  {
+    const char *data = "123456789";
+    BlockHeaderCellStore before;
+    BlockHeaderCellStore after;
+
+    BlockHeader::use_crc32c = true;
+
+    // Version 0 headers have no flags field and always use fletcher32
+    before = BlockHeaderCellStore(0);
+    HT_ASSERT(before.compute_data_checksum(data, 9) == fletcher32(data, 9));
+
+    encode_ptr = buffer;
+    before = BlockHeaderCellStore(1, "CELLSTORE-");
+    HT_ASSERT(before.get_flags() & BlockHeader::FLAG_CRC32C);
+    before.set_compression_type(BlockCompressionCodec::NONE);
+    before.set_data_length(9);
+    before.set_data_zlength(9);
+    before.set_data_checksum(before.compute_data_checksum(data, 9));
+    HT_ASSERT(before.get_data_checksum() == 0xe3069283);
+    before.encode(&encode_ptr);
+
+    // Reader picks up the algorithm from the header, not the global setting
+    BlockHeader::use_crc32c = false;
+    remain = encode_ptr-buffer;
+    decode_ptr = buffer;
+    after = BlockHeaderCellStore(1);
+    HT_ASSERT((after.get_flags() & BlockHeader::FLAG_CRC32C) == 0);
+    after.decode(&decode_ptr, &remain);
+    HT_ASSERT(before == after);
+    HT_ASSERT(after.compute_data_checksum(data, 9) == after.get_data_checksum());
+  }
+
   return 0;
 }
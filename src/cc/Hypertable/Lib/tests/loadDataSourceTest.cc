@@ -20,6 +20,7 @@
  */
 
 #include "Common/Compat.h"
+#include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <vector>
@@ -39,6 +40,65 @@ extern "C" {
 using namespace Hypertable;
 using namespace std;
 
+namespace {
+
+  String read_cells(LoadDataSource *lds) {
+    KeySpec key;
+    uint8_t *value;
+    uint32_t value_len;
+    bool is_delete;
+    String cells;
+    while (lds->next(&key, &value, &value_len, &is_delete, 0)) {
+      cells.append((const char *)key.row, key.row_len);
+      cells += "\t";
+      cells += key.column_family ? key.column_family : "";
+      if (key.column_qualifier_len) {
+        cells += ":";
+        cells.append((const char *)key.column_qualifier,
+                     key.column_qualifier_len);
+      }
+      cells += "\t";
+      cells.append((const char *)value, value_len);
+      cells += "\n";
+    }
+    return cells;
+  }
+
+  /// Checks that the chunks returned by LoadDataSource::split() yield the
+  /// same cells as reading the file in one piece
+  bool test_split(const String &fname, bool header) {
+    FsBroker::Lib::ClientPtr null_dfs_client;
+    std::vector<String> key_columns;
+    FILE *fp = fopen(fname.c_str(), "w");
+    if (header)
+      fprintf(fp, "#row\tcolumn\tvalue\n");
+    for (int i=0; i<100000; i++)
+      fprintf(fp, "row%07d\tcf:q%d\tvalue of cell number %d\n", i, i%7, i);
+    fclose(fp);
+
+    LoadDataSourcePtr lds(LoadDataSourceFactory::create(null_dfs_client,
+        fname, LOCAL_FILE, "", LOCAL_FILE, key_columns, "", '\t', 0, 0));
+    String expected = read_cells(lds.get());
+
+    lds.reset(LoadDataSourceFactory::create(null_dfs_client,
+        fname, LOCAL_FILE, "", LOCAL_FILE, key_columns, "", '\t', 0, 0));
+    std::vector<LoadDataSourcePtr> chunks = lds->split(3);
+    if (chunks.size() != 3) {
+      cout << fname << ": expected 3 chunks, got " << chunks.size() << endl;
+      return false;
+    }
+    String cells;
+    for (auto &chunk : chunks)
+      cells += read_cells(chunk.get());
+    if (cells != expected) {
+      cout << fname << ": cells read from chunks differ" << endl;
+      return false;
+    }
+    return true;
+  }
+
+}
+
 int main(int argc, char **argv) {
   LoadDataSourcePtr lds;
   KeySpec key;
@@ -100,5 +160,9 @@ int main(int argc, char **argv) {
       return 1;
   }
 
+  if (!test_split("loadDataSourceTest-split.dat", false) ||
+      !test_split("loadDataSourceTest-split-header.dat", true))
+    return 1;
+
   return 0;
 }
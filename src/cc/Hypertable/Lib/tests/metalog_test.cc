@@ -22,6 +22,7 @@
 #include <Common/Compat.h>
 
 #include <Hypertable/Lib/Config.h>
+#include <Hypertable/Lib/MetaLog.h>
 #include <Hypertable/Lib/MetaLogDefinition.h>
 #include <Hypertable/Lib/MetaLogEntity.h>
 #include <Hypertable/Lib/MetaLogReader.h>
@@ -39,12 +40,15 @@
 #include <Common/Init.h>
 #include <Common/Random.h>
 #include <Common/Serialization.h>
+#include <Common/Stopwatch.h>
 #include <Common/StringExt.h>
 
 #include <cstdlib>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <thread>
 
 using namespace Hypertable;
 using namespace Config;
@@ -121,6 +125,10 @@ namespace {
     static void init_options() {
       cmdline_desc().add_options()
         ("save,s", "Don't delete generated the log files")
+        ("move-ranges", i32()->default_value(0), "Benchmark group commit by "
+         "recording the state transitions of moving this many ranges")
+        ("move-threads", i32()->default_value(32), "Number of concurrent "
+         "threads used by the --move-ranges benchmark")
         ;
     }
   };
@@ -158,6 +166,41 @@ namespace {
     writer->record_state(g_entities);
   }
 
+  /** Simulates a burst of range moves.
+   * Creates <code>count</code> entities and records three state transitions
+   * (e.g. SPLIT_LOG_INSTALLED, RELINQUISH_COMPACTED, removal) for each one,
+   * spread over <code>thread_count</code> concurrent threads.  Prints the
+   * achieved number of entity writes per second.
+   */
+  void move_ranges_benchmark(MetaLog::WriterPtr &writer, int count,
+                             int thread_count) {
+    vector<MetaLog::EntityPtr> entities;
+    for (int i=0; i<count; i++)
+      entities.push_back( make_shared<MetaLog::EntityGeneric>(65536+i) );
+
+    Stopwatch stopwatch;
+    vector<thread> threads;
+    for (int t=0; t<thread_count; t++) {
+      threads.push_back(thread([&writer, &entities, t, thread_count]() {
+            for (size_t i=t; i<entities.size(); i+=thread_count) {
+              auto entity = dynamic_pointer_cast<MetaLog::EntityGeneric>(entities[i]);
+              writer->record_state(entity);
+              entity->increment();
+              writer->record_state(entity);
+              writer->record_removal(entities[i]);
+            }
+          }));
+    }
+    for (auto &t : threads)
+      t.join();
+    stopwatch.stop();
+
+    cout << "Moved " << count << " ranges with " << thread_count
+         << " threads in " << stopwatch.elapsed() << " seconds ("
+         << (int64_t)((3*count) / stopwatch.elapsed()) << " writes/s)"
+         << endl;
+  }
+
   void display_entities(ofstream &out) {
     for (size_t i=0; i<g_entities.size(); i++) {
       if (g_entities[i])
@@ -256,6 +299,13 @@ main(int ac, char *av[]) {
      *  Log file rollover test
      */
     Config::properties->set("Hypertable.MetaLog.MaxFileSize", (int64_t)50000);
+    Config::properties->set("Hypertable.MetaLog.CompactionChunkSize", (int32_t)8192);
+
+    deque<int32_t> file_ids;
+    MetaLog::scan_log_directory(fs, testdir + "/" + g_test_definition->name(),
+                                file_ids);
+    size_t initial_file_count = file_ids.size();
+
     writer = make_shared<MetaLog::Writer>(fs, g_test_definition,
                                           testdir + "/" + g_test_definition->name(),
                                           g_entities);
@@ -266,7 +316,21 @@ main(int ac, char *av[]) {
       randomly_set_values(writer);
       randomly_set_values(writer);
       randomly_set_values(writer);
+      // Drive incremental compaction to completion without changing state
+      for (size_t i=0; i<8; i++)
+        writer->record_state(g_entities[i % g_entities.size()]);
       writer.reset();
+
+      // Verify compacted log was installed and no compaction file remains
+      file_ids.clear();
+      MetaLog::scan_log_directory(fs, testdir + "/" + g_test_definition->name(),
+                                  file_ids);
+      HT_ASSERT(file_ids.size() >= initial_file_count + 2);
+      vector<Filesystem::Dirent> listing;
+      fs->readdir(testdir + "/" + g_test_definition->name(), listing);
+      for (auto &dirent : listing)
+        HT_ASSERT(dirent.name.find(".tmp") == string::npos);
+
       reader = make_shared<MetaLog::Reader>(fs, g_test_definition,
                                             testdir + "/" + g_test_definition->name());
       g_entities.clear();
@@ -302,6 +366,20 @@ main(int ac, char *av[]) {
       HT_ERROR_OUT << e << HT_END;
     }
 
+    /**
+     *  Group commit benchmark
+     */
+
+    if (get_i32("move-ranges") > 0) {
+      MetaLog::Writer::skip_recover_entry = false;
+      g_entities.clear();
+      writer = make_shared<MetaLog::Writer>(fs, g_test_definition,
+                                            testdir + "/bench", g_entities);
+      move_ranges_benchmark(writer, get_i32("move-ranges"),
+                            get_i32("move-threads"));
+      writer.reset();
+    }
+
     if (!has("save"))
       fs->rmdir(testdir);
   }
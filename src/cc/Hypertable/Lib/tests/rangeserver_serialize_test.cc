@@ -86,6 +86,25 @@ int main(int argc, char *argv[]) {
 
     stats1->tables.push_back(table_stat);
   }
+
+  for (const char *name : { "request.update", "commitLogSync" }) {
+    StatsLatency latency;
+    latency.name = name;
+    latency.count = Random::number64();
+    latency.p50 = Random::number32();
+    latency.p90 = Random::number32();
+    latency.p99 = Random::number32();
+    latency.p999 = Random::number32();
+    latency.max = Random::number64() >> 1;
+    stats1->latencies.push_back(latency);
+  }
+
+  for (const char *name : { "cellCache", "scanner", "rpc" }) {
+    StatsMemory memory;
+    memory.name = name;
+    memory.bytes = Random::number64() >> 1;
+    stats1->memory.push_back(memory);
+  }
   
   
   size_t len = stats1->encoded_length();
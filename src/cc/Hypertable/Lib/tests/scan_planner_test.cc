@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Lib/ColumnPredicate.h>
+#include <Hypertable/Lib/ScanPlanner.h>
+#include <Hypertable/Lib/ScanSpec.h>
+
+#include <Common/Logger.h>
+#include <Common/Properties.h>
+#include <Common/Usage.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+using namespace Hypertable;
+using namespace Hypertable::Lib;
+
+namespace {
+  const char *usage[] = {
+    "usage: scan_planner_test",
+    "",
+    "Runs basic tests of the ScanPlanner class and the EXPLAIN output.",
+    0
+  };
+
+  void check_output(const ScanPlan &plan, const string &expected) {
+    string output = plan.to_str();
+    if (output != expected) {
+      cout << "Expected:\n" << expected << "Got:\n" << output << flush;
+      quick_exit(EXIT_FAILURE);
+    }
+  }
+
+  PropertiesPtr make_properties(bool cost_based) {
+    PropertiesPtr props = make_shared<Properties>();
+    props->set("Hypertable.Scanner.Planner.CostBased", cost_based);
+    // 1MiB per range scanned
+    props->set("Hypertable.RangeServer.Range.SplitSize", (int64_t)2*1024*1024);
+    props->set("Hypertable.Scanner.Planner.IndexLookupCost", (int32_t)64*1024);
+    props->set("Hypertable.Scanner.Planner.MaxProbeCells", (int32_t)1000);
+    props->set("Hypertable.Scanner.Planner.EstimateTTL", (int32_t)60000);
+    return props;
+  }
+
+  ScanPlan index_plan() {
+    ScanPlan plan;
+    plan.type = ScanPlan::INDEX_SCAN;
+    plan.table_name = "^products";
+    return plan;
+  }
+
+  void test_full_scan_equivalent() {
+    {
+      ScanSpecBuilder ssb;
+      HT_ASSERT(!ScanPlanner::full_scan_equivalent(ssb.get()));
+    }
+    {
+      ScanSpecBuilder ssb;
+      ssb.add_column("section");
+      ssb.add_column_predicate("section", "", ColumnPredicate::EXACT_MATCH,
+                               "books");
+      HT_ASSERT(ScanPlanner::full_scan_equivalent(ssb.get()));
+    }
+    {
+      ScanSpecBuilder ssb;
+      ssb.add_column("section:new");
+      ssb.add_column_predicate("section", "", ColumnPredicate::EXACT_MATCH,
+                               "books");
+      HT_ASSERT(ScanPlanner::full_scan_equivalent(ssb.get()));
+    }
+    {
+      ScanSpecBuilder ssb;
+      ssb.add_column("section");
+      ssb.add_column("title");
+      ssb.add_column_predicate("section", "", ColumnPredicate::EXACT_MATCH,
+                               "books");
+      HT_ASSERT(!ScanPlanner::full_scan_equivalent(ssb.get()));
+    }
+  }
+
+  void test_limits() {
+    PropertiesPtr props = make_properties(true);
+    ScanPlanner planner(props);
+    HT_ASSERT(planner.cost_based());
+    // 1000 lookups of 64KiB equal 62.5 ranges of 1MiB
+    HT_ASSERT(planner.max_ranges() == 63);
+    HT_ASSERT(planner.probe_limit(1) == 17);
+    HT_ASSERT(planner.probe_limit(100) == 1000);
+
+    props = make_properties(false);
+    ScanPlanner disabled(props);
+    HT_ASSERT(!disabled.cost_based());
+  }
+
+  void test_evaluate() {
+    PropertiesPtr props = make_properties(true);
+    ScanPlanner planner(props);
+
+    // selective predicate: index
+    ScanPlan plan = index_plan();
+    plan.primary_ranges = 1;
+    plan.index_matches = 5;
+    planner.evaluate("products", plan);
+    HT_ASSERT(plan.type == ScanPlan::INDEX_SCAN);
+    check_output(plan,
+                 "Plan: INDEX_SCAN\n"
+                 "Table: ^products\n"
+                 "IndexMatches: 5\n"
+                 "PrimaryRanges: 1\n"
+                 "EstimatedScanBytes: 1048576\n"
+                 "EstimatedIndexBytes: 327680\n"
+                 "Reason: index lookups cheaper than scan\n");
+
+    // probe reached the point where the index can no longer win: scan
+    plan = index_plan();
+    plan.primary_ranges = 1;
+    plan.index_matches = planner.probe_limit(1);
+    planner.evaluate("products", plan);
+    HT_ASSERT(plan.type == ScanPlan::FULL_SCAN);
+    check_output(plan,
+                 "Plan: FULL_SCAN\n"
+                 "Table: products\n"
+                 "IndexMatches: 17+\n"
+                 "PrimaryRanges: 1\n"
+                 "EstimatedScanBytes: 1048576\n"
+                 "EstimatedIndexBytes: 1114112+\n"
+                 "Reason: predicate not selective enough for index\n");
+
+    // probe stopped at MaxProbeCells before the index could lose: index
+    plan = index_plan();
+    plan.primary_ranges = 100;
+    plan.index_matches = planner.probe_limit(100);
+    planner.evaluate("products", plan);
+    HT_ASSERT(plan.type == ScanPlan::INDEX_SCAN);
+    check_output(plan,
+                 "Plan: INDEX_SCAN\n"
+                 "Table: ^products\n"
+                 "IndexMatches: 1000+\n"
+                 "PrimaryRanges: 100\n"
+                 "EstimatedScanBytes: 104857600\n"
+                 "EstimatedIndexBytes: 65536000+\n"
+                 "Reason: index probe stopped after 1000 matches\n");
+  }
+
+  void test_output_without_costs() {
+    ScanPlan plan = index_plan();
+    plan.type = ScanPlan::QUALIFIER_INDEX_SCAN;
+    plan.table_name = "^^products";
+    plan.reason = "cost-based planning disabled";
+    check_output(plan,
+                 "Plan: QUALIFIER_INDEX_SCAN\n"
+                 "Table: ^^products\n"
+                 "Reason: cost-based planning disabled\n");
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  if (argc != 1)
+    Usage::dump_and_exit(usage);
+
+  test_full_scan_equivalent();
+  test_limits();
+  test_evaluate();
+  test_output_without_costs();
+
+  quick_exit(EXIT_SUCCESS);
+}
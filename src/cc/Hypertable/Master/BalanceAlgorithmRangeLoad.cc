@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for BalanceAlgorithmRangeLoad.
+/// This file contains definitions for BalanceAlgorithmRangeLoad, a balance
+/// algorithm that moves ranges according to their measured read/write rates.
+
+#include <Common/Compat.h>
+
+#include "BalanceAlgorithmRangeLoad.h"
+
+#include <Hypertable/Lib/RS_METRICS/ReaderTable.h>
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+using namespace Hypertable;
+using namespace Hypertable::Lib;
+using namespace Hypertable::Lib::RS_METRICS;
+using namespace std;
+
+BalanceAlgorithmRangeLoad::BalanceAlgorithmRangeLoad(ContextPtr &context,
+                              std::vector<RangeServerStatistics> &statistics)
+  : m_context(context) {
+  m_bytes_per_op =
+    (double)m_context->props->get_i32("Hypertable.LoadBalancer.RangeLoad.BytesPerOp");
+  if (m_bytes_per_op <= 0)
+    m_bytes_per_op = 1.0;
+  m_threshold =
+    m_context->props->get_f64("Hypertable.LoadBalancer.RangeLoad.Threshold");
+  m_max_moves =
+    m_context->props->get_i32("Hypertable.LoadBalancer.RangeLoad.MaxMoves");
+  for (auto &rs : statistics)
+    m_rsstats[rs.location] = rs;
+}
+
+
+void BalanceAlgorithmRangeLoad::compute_plan(BalancePlanPtr &plan,
+                              std::vector<RangeServerConnectionPtr> &balanced) {
+  vector<ServerMetrics> server_metrics;
+  RS_METRICS::ReaderTable rs_metrics(m_context->rs_metrics_table);
+  rs_metrics.get_server_metrics(server_metrics);
+
+  map<string, vector<RangeLoad>> candidates;
+  map<string, double> load;
+  set<string> disk_full;
+
+  m_load_before.clear();
+  m_load_after.clear();
+  m_hot_ranges.clear();
+
+  for (const auto &sm : server_metrics) {
+    // only assign ranges if this RangeServer is connected
+    RangeServerConnectionPtr rsc;
+    if (m_context->rsc_manager &&
+        (!m_context->rsc_manager->find_server_by_location(sm.get_id(), rsc)
+         || !rsc->connected() || rsc->get_removed() || rsc->is_recovering())) {
+      HT_INFOF("RangeServer %s not connected, skipping", sm.get_id().c_str());
+      continue;
+    }
+
+    const string &location = sm.get_id();
+    RangeMetricsMap range_metrics;
+    rs_metrics.get_range_metrics(location.c_str(), range_metrics);
+
+    double server_load = 0;
+    vector<RangeLoad> &ranges = candidates[location];
+    for (const auto &vv : range_metrics) {
+      RangeLoad range;
+      bool start_row_set;
+      range.load = compute_range_load(vv.second);
+      server_load += range.load;
+      // ranges that can't be moved still count towards server load
+      if (!vv.second.is_moveable())
+        continue;
+      range.table_id = vv.second.get_table_id();
+      range.start_row = vv.second.get_start_row(&start_row_set);
+      range.end_row = vv.second.get_end_row();
+      ranges.push_back(range);
+    }
+    load[location] = server_load;
+
+    auto it = m_rsstats.find(location);
+    if (it != m_rsstats.end() && !m_context->can_accept_ranges(it->second))
+      disk_full.insert(location);
+  }
+
+  m_load_before = load;
+
+  plan_moves(load, candidates, disk_full, m_threshold, m_max_moves,
+             plan->moves, m_hot_ranges);
+
+  m_load_after = load;
+}
+
+
+void BalanceAlgorithmRangeLoad::plan_moves(map<string, double> &load,
+                              map<string, vector<RangeLoad>> &candidates,
+                              const set<string> &disk_full, double threshold,
+                              int32_t max_moves,
+                              vector<RangeMoveSpecPtr> &moves,
+                              vector<RangeLoad> &hot_ranges) {
+  double total_load = 0;
+  for (auto &entry : load)
+    total_load += entry.second;
+
+  if (load.size() < 2 || total_load == 0) {
+    HT_INFOF("No balancing required, num_servers=%u, total_load=%f",
+             (unsigned)load.size(), total_load);
+    return;
+  }
+
+  double mean_load = total_load / load.size();
+  double target_peak = mean_load * (1.0 + threshold);
+
+  // A range carrying more than the mean server load can't be fixed by moving
+  // it, so it is left in place and reported as a split candidate
+  for (auto &entry : candidates) {
+    auto iter = entry.second.begin();
+    while (iter != entry.second.end()) {
+      if (iter->load > mean_load) {
+        HT_INFOF("Hot range %s[%s..%s] on %s has load %f (mean server load %f),"
+                 " should be split", iter->table_id.c_str(),
+                 iter->start_row.c_str(), iter->end_row.c_str(),
+                 entry.first.c_str(), iter->load, mean_load);
+        hot_ranges.push_back(*iter);
+        iter = entry.second.erase(iter);
+      }
+      else
+        ++iter;
+    }
+  }
+
+  HT_INFOF("mean_load=%f, num_servers=%u, threshold=%f, hot_ranges=%u",
+           mean_load, (unsigned)load.size(), threshold,
+           (unsigned)hot_ranges.size());
+
+  map<string, double> load_before = load;
+  int32_t move_count = 0;
+  while (max_moves == 0 || move_count < max_moves) {
+    auto heaviest = load.end();
+    auto lightest = load.end();
+    for (auto it = load.begin(); it != load.end(); ++it) {
+      if (heaviest == load.end() || it->second > heaviest->second)
+        heaviest = it;
+    }
+    for (auto it = load.begin(); it != load.end(); ++it) {
+      if (it == heaviest || disk_full.count(it->first))
+        continue;
+      if (lightest == load.end() || it->second < lightest->second)
+        lightest = it;
+    }
+
+    if (lightest == load.end() || heaviest->second <= target_peak)
+      break;
+
+    // Pick the range that brings the pair closest to equal load; a move of
+    // load less than the gap always lowers the pair's peak
+    double gap = heaviest->second - lightest->second;
+    vector<RangeLoad> &ranges = candidates[heaviest->first];
+    auto best = ranges.end();
+    for (auto it = ranges.begin(); it != ranges.end(); ++it) {
+      if (it->load <= 0 || it->load >= gap)
+        continue;
+      if (best == ranges.end() ||
+          fabs(it->load - gap/2) < fabs(best->load - gap/2))
+        best = it;
+    }
+
+    if (best == ranges.end()) {
+      HT_INFOF("No viable move from %s (load %f) to %s (load %f)",
+               heaviest->first.c_str(), heaviest->second,
+               lightest->first.c_str(), lightest->second);
+      break;
+    }
+
+    RangeMoveSpecPtr move =
+      make_shared<RangeMoveSpec>(heaviest->first.c_str(),
+                                 lightest->first.c_str(),
+                                 best->table_id.c_str(),
+                                 best->start_row.c_str(),
+                                 best->end_row.c_str());
+    HT_DEBUG_OUT << "Added move to plan: " << *(move.get()) << HT_END;
+    moves.push_back(move);
+    move_count++;
+
+    heaviest->second -= best->load;
+    lightest->second += best->load;
+
+    // Moved ranges are not reconsidered, to avoid moving a range twice
+    ranges.erase(best);
+  }
+
+  double peak_before = 0, peak_after = 0;
+  for (auto &entry : load_before)
+    peak_before = std::max(peak_before, entry.second);
+  for (auto &entry : load)
+    peak_after = std::max(peak_after, entry.second);
+  HT_INFOF("Range load balance plan has %d moves, projected peak load "
+           "%f -> %f", (int)move_count, peak_before, peak_after);
+}
+
+
+double
+BalanceAlgorithmRangeLoad::compute_range_load(const RangeMetrics &metrics) {
+  const vector<RangeMeasurement> &measurements = metrics.get_measurements();
+  if (measurements.empty())
+    return 0;
+  double load = 0;
+  for (const auto &measurement : measurements)
+    load += measurement.update_rate + measurement.scan_rate +
+      (measurement.byte_read_rate + measurement.byte_write_rate) / m_bytes_per_op;
+  return load / measurements.size();
+}
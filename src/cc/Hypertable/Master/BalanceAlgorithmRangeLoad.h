@@ -0,0 +1,153 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for BalanceAlgorithmRangeLoad.
+/// This file contains declarations for BalanceAlgorithmRangeLoad, a balance
+/// algorithm that moves ranges according to their measured read/write rates.
+
+#ifndef Hypertable_Master_BalanceAlgorithmRangeLoad_h
+#define Hypertable_Master_BalanceAlgorithmRangeLoad_h
+
+#include "BalanceAlgorithm.h"
+#include "Context.h"
+#include "RangeServerStatistics.h"
+
+#include <Hypertable/Lib/RS_METRICS/RangeMetrics.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup Master
+  /// @{
+
+  /// Balances ranges by per-range access load.
+  /// The load of a range is its average update rate plus scan rate, plus its
+  /// average byte read and write rate expressed in operations (divided by
+  /// <code>Hypertable.LoadBalancer.RangeLoad.BytesPerOp</code>), as recorded
+  /// in <code>sys/RS_METRICS</code>.  The load of a server is the sum of the
+  /// loads of its ranges.  The plan is computed greedily: ranges are moved
+  /// from the most loaded server to the least loaded one, choosing the range
+  /// that brings the pair closest to equal load, until the projected peak
+  /// server load is within <code>Hypertable.LoadBalancer.RangeLoad.Threshold</code>
+  /// of the mean.  Ranges carrying more than the mean server load on their
+  /// own cannot be fixed by moving them; they are reported as hot-spot
+  /// candidates, to be split by the RangeServer (see
+  /// <code>Hypertable.RangeServer.Range.HotSplit.Rate</code>).
+  class BalanceAlgorithmRangeLoad : public BalanceAlgorithm {
+  public:
+
+    /// Projected load of a range.
+    struct RangeLoad {
+      std::string table_id;
+      std::string start_row;
+      std::string end_row;
+      double load {};
+    };
+
+    /// Constructor.
+    /// @param context %Master context
+    /// @param statistics %RangeServer statistics used to detect full disks
+    BalanceAlgorithmRangeLoad(ContextPtr &context,
+                              std::vector<RangeServerStatistics> &statistics);
+
+    /// Computes balance plan.
+    /// @param plan Balance plan to which moves are added
+    /// @param balanced Unused
+    void compute_plan(BalancePlanPtr &plan,
+                      std::vector<RangeServerConnectionPtr> &balanced) override;
+
+    /// Gets projected server loads before and after the computed plan.
+    /// @param before Output map of server location to load before the plan
+    /// @param after Output map of server location to load after the plan
+    void get_projected_loads(std::map<std::string, double> &before,
+                             std::map<std::string, double> &after) const {
+      before = m_load_before;
+      after = m_load_after;
+    }
+
+    /// Gets ranges whose load exceeds the mean server load.
+    /// @return Hot-spot ranges that should be split rather than moved
+    const std::vector<RangeLoad> &get_hot_ranges() const {
+      return m_hot_ranges;
+    }
+
+    /// Computes moves that balance server loads.
+    /// Ranges whose load exceeds the mean server load are removed from
+    /// <code>candidates</code> and added to <code>hot_ranges</code>.  Moves
+    /// are then chosen greedily, as described in the class documentation,
+    /// and <code>load</code> is updated to reflect them.  Servers in
+    /// <code>disk_full</code> are never chosen as a move destination.
+    /// @param load Map of server location to load, updated by the moves
+    /// @param candidates Map of server location to its moveable ranges
+    /// @param disk_full Locations of servers that can't accept ranges
+    /// @param threshold Allowed deviation of peak load above mean load
+    /// @param max_moves Maximum number of moves (0 for unlimited)
+    /// @param moves Vector to which chosen moves are appended
+    /// @param hot_ranges Vector to which hot-spot ranges are appended
+    static void plan_moves(std::map<std::string, double> &load,
+                           std::map<std::string, std::vector<RangeLoad>> &candidates,
+                           const std::set<std::string> &disk_full,
+                           double threshold, int32_t max_moves,
+                           std::vector<RangeMoveSpecPtr> &moves,
+                           std::vector<RangeLoad> &hot_ranges);
+
+  private:
+
+    /// Computes load of a range from its measurements.
+    /// @param metrics %Range metrics
+    /// @return Average load of the range
+    double compute_range_load(const Lib::RS_METRICS::RangeMetrics &metrics);
+
+    /// %Master context
+    ContextPtr m_context;
+
+    /// Map of server location to statistics
+    std::map<std::string, RangeServerStatistics> m_rsstats;
+
+    /// Bytes of read or write traffic equivalent to one operation
+    double m_bytes_per_op {};
+
+    /// Allowed deviation of peak load above mean load (fraction)
+    double m_threshold {};
+
+    /// Maximum number of moves in a plan
+    int32_t m_max_moves {};
+
+    /// Projected server loads before plan
+    std::map<std::string, double> m_load_before;
+
+    /// Projected server loads after plan
+    std::map<std::string, double> m_load_after;
+
+    /// Hot-spot ranges
+    std::vector<RangeLoad> m_hot_ranges;
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_Master_BalanceAlgorithmRangeLoad_h
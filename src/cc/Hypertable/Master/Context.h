@@ -28,6 +28,7 @@
 #ifndef Hypertable_Master_Context_h
 #define Hypertable_Master_Context_h
 
+#include "GcReferenceMap.h"
 #include "HyperspaceMasterFile.h"
 #include "MetricsHandler.h"
 #include "Monitoring.h"
@@ -171,6 +172,10 @@ namespace Hypertable {
     uint32_t gc_interval {};
     time_t next_monitoring_time {};
     time_t next_gc_time {};
+    /// CellStore file references maintained by GcWorker
+    GcReferenceMap gc_references;
+    /// %Mutex serializing garbage collection passes
+    std::mutex gc_mutex;
     std::unique_ptr<OperationProcessor> op;
     std::shared_ptr<OperationTimedBarrier> recovery_barrier_op;
     String cluster_name;               //!< Name of cluster
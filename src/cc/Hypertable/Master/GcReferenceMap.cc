@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for GcReferenceMap.
+/// This file contains type definitions for GcReferenceMap, a class that
+/// tracks which METADATA rows reference each CellStore file so that the
+/// garbage collector can find obsolete files without rescanning METADATA.
+
+#include <Common/Compat.h>
+
+#include "GcReferenceMap.h"
+
+#include <Common/Logger.h>
+
+#include <algorithm>
+#include <iterator>
+
+using namespace Hypertable;
+using namespace std;
+
+void GcReferenceMap::set_row(const String &row, vector<String> &files) {
+  sort(files.begin(), files.end());
+  files.erase(unique(files.begin(), files.end()), files.end());
+
+  vector<const String *> live;
+  live.reserve(files.size());
+  for (auto &file : files) {
+    auto ret = m_refcount.insert(make_pair(file, 0));
+    if (ret.second)
+      m_pending.erase(file);
+    ret.first->second++;
+    live.push_back(&ret.first->first);
+  }
+
+  // Release old references after taking the new ones so that files listed
+  // in both never drop to zero
+  auto iter = m_rows.find(row);
+  if (iter != m_rows.end()) {
+    for (auto file : iter->second)
+      release(file);
+    if (live.empty())
+      m_rows.erase(iter);
+    else
+      iter->second.swap(live);
+  }
+  else if (!live.empty())
+    m_rows[row].swap(live);
+}
+
+void GcReferenceMap::remove_row(const String &row) {
+  auto iter = m_rows.find(row);
+  if (iter == m_rows.end())
+    return;
+  for (auto file : iter->second)
+    release(file);
+  m_rows.erase(iter);
+}
+
+void GcReferenceMap::add_stale(const String &file) {
+  if (m_refcount.count(file) == 0)
+    make_pending(file);
+}
+
+void GcReferenceMap::add_stale_cell(StaleCell &cell) {
+  cell.pass = m_pass;
+  m_stale_cells.push_back(cell);
+}
+
+void GcReferenceMap::take_stale_cells(vector<StaleCell> &cells) {
+  auto iter = stable_partition(m_stale_cells.begin(), m_stale_cells.end(),
+                               [this](const StaleCell &cell) {
+                                 return cell.pass < m_pass; });
+  cells.insert(cells.end(), make_move_iterator(m_stale_cells.begin()),
+               make_move_iterator(iter));
+  m_stale_cells.erase(m_stale_cells.begin(), iter);
+}
+
+void GcReferenceMap::reap_candidates(vector<String> &files) {
+  for (auto iter = m_pending.begin(); iter != m_pending.end(); ) {
+    if (iter->second < m_pass) {
+      HT_ASSERT(m_refcount.count(iter->first) == 0);
+      files.push_back(iter->first);
+      iter = m_pending.erase(iter);
+    }
+    else
+      ++iter;
+  }
+}
+
+void GcReferenceMap::begin_rebuild() {
+  m_rebuild_files.clear();
+  m_rebuild_files.reserve(m_refcount.size());
+  for (auto &entry : m_refcount)
+    m_rebuild_files.push_back(entry.first);
+  m_rows.clear();
+  m_refcount.clear();
+}
+
+void GcReferenceMap::end_rebuild() {
+  for (auto &file : m_rebuild_files)
+    if (m_refcount.count(file) == 0)
+      make_pending(file);
+  m_rebuild_files.clear();
+  m_rebuild_files.shrink_to_fit();
+}
+
+int32_t GcReferenceMap::refcount(const String &file) const {
+  auto iter = m_refcount.find(file);
+  return iter == m_refcount.end() ? 0 : iter->second;
+}
+
+void GcReferenceMap::release(const String *file) {
+  auto iter = m_refcount.find(*file);
+  HT_ASSERT(iter != m_refcount.end() && iter->second > 0);
+  if (--iter->second == 0) {
+    make_pending(iter->first);
+    m_refcount.erase(iter);
+  }
+}
+
+void GcReferenceMap::make_pending(const String &file) {
+  m_pending.insert(make_pair(file, m_pass));
+}
@@ -0,0 +1,188 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for GcReferenceMap.
+/// This file contains type declarations for GcReferenceMap, a class that
+/// tracks which METADATA rows reference each CellStore file so that the
+/// garbage collector can find obsolete files without rescanning METADATA.
+
+#ifndef Hypertable_Master_GcReferenceMap_h
+#define Hypertable_Master_GcReferenceMap_h
+
+#include <Common/String.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup Master
+  /// @{
+
+  /// Reference counts of CellStore files.
+  /// Holds, for every METADATA row, the files listed in the latest
+  /// <code>Files</code> cell of each of its access groups, and for every
+  /// such file the number of rows that list it.  Each file name is stored
+  /// once, as the key of the reference count map, and rows hold pointers to
+  /// those keys.
+  ///
+  /// A file whose count drops to zero, or that is only found in old
+  /// <code>Files</code> versions, is not reported as obsolete right away but
+  /// is put on a pending list tagged with the current pass number.
+  /// reap_candidates() only returns pending files from earlier passes that
+  /// are still unreferenced, so a reference that shows up one pass late
+  /// (e.g. the second half of a split written after the scanner went by)
+  /// revives the file instead of losing it.
+  class GcReferenceMap {
+  public:
+
+    /// Obsolete METADATA cell or row.
+    /// Cells holding old <code>Files</code> versions, and rows in which
+    /// every access group is marked deleted, are removed from METADATA one
+    /// pass after they are found, once the files they list have been
+    /// reaped.  Until then a Master restart finds them again with a full
+    /// scan, so no file is forgotten.
+    class StaleCell {
+    public:
+      /// Row key
+      String row;
+      /// Column qualifier (access group), unused if #whole_row is set
+      String qualifier;
+      /// Cell timestamp, unused if #whole_row is set
+      int64_t timestamp {};
+      /// <i>true</i> if the entire row is to be deleted
+      bool whole_row {};
+      /// Pass in which the cell was found
+      uint64_t pass {};
+    };
+
+    /// Starts a new pass.
+    void begin_pass() { m_pass++; }
+
+    /// Sets live files of a row.
+    /// Replaces the files previously recorded for <code>row</code> with
+    /// <code>files</code>, a list that may contain duplicates.  Files that
+    /// are no longer referenced by any row become pending.
+    /// @param row METADATA row key
+    /// @param files Files listed in the latest <code>Files</code> cells of
+    /// <code>row</code>
+    void set_row(const String &row, std::vector<String> &files);
+
+    /// Removes row.
+    /// Equivalent to set_row() with an empty file list, after which the row
+    /// is forgotten.
+    /// @param row METADATA row key
+    void remove_row(const String &row);
+
+    /// Records a file found in an old <code>Files</code> version.
+    /// The file becomes pending unless some row references it.
+    /// @param file File name
+    void add_stale(const String &file);
+
+    /// Records obsolete METADATA cell or row.
+    /// @param cell Cell to delete after the next reap, #StaleCell::pass is
+    /// set by this method
+    void add_stale_cell(StaleCell &cell);
+
+    /// Returns obsolete METADATA cells that can be deleted.
+    /// Moves cells recorded before the current pass to <code>cells</code>.
+    /// @param cells Receives cells to delete
+    void take_stale_cells(std::vector<StaleCell> &cells);
+
+    /// Returns files that can be deleted.
+    /// Moves every pending file that became pending before the current pass
+    /// and is still unreferenced from the pending list to
+    /// <code>files</code>.
+    /// @param files Receives files to delete
+    void reap_candidates(std::vector<String> &files);
+
+    /// Starts rebuilding the map from a full METADATA scan.
+    /// Clears row and reference state, remembering the files that were
+    /// referenced, and keeps pending files.
+    void begin_rebuild();
+
+    /// Finishes rebuilding the map.
+    /// Files that were referenced before begin_rebuild() and that the scan
+    /// did not find in any row become pending.
+    void end_rebuild();
+
+    /// Returns reference count of file.
+    /// @param file File name
+    /// @return Number of rows whose live files include <code>file</code>
+    int32_t refcount(const String &file) const;
+
+    /// Returns number of referenced files.
+    size_t file_count() const { return m_refcount.size(); }
+
+    /// Returns number of rows.
+    size_t row_count() const { return m_rows.size(); }
+
+    /// Returns number of pending files.
+    size_t pending_count() const { return m_pending.size(); }
+
+    /// Time (nanoseconds since epoch) at which the last successful pass
+    /// started, or 0 if a full scan is required
+    int64_t last_pass_start {};
+
+    /// Number of incremental passes since last full scan
+    uint32_t passes_since_full_scan {};
+
+  private:
+
+    /// Map from file name to reference count
+    typedef std::unordered_map<String, int32_t> RefCountMap;
+
+    /// Map from row to the keys in #m_refcount of its live files
+    typedef std::unordered_map<String, std::vector<const String *>> RowMap;
+
+    /// Decrements reference count of file, making it pending at zero.
+    /// @param file Key in #m_refcount
+    void release(const String *file);
+
+    /// Adds file to pending list if not already there.
+    /// @param file File name
+    void make_pending(const String &file);
+
+    /// Current pass number
+    uint64_t m_pass {};
+
+    /// Reference counts
+    RefCountMap m_refcount;
+
+    /// Live files of each row
+    RowMap m_rows;
+
+    /// Files referenced when begin_rebuild() was called
+    std::vector<String> m_rebuild_files;
+
+    /// Obsolete METADATA cells and rows
+    std::vector<StaleCell> m_stale_cells;
+
+    /// Map from unreferenced file to pass in which it became pending
+    std::unordered_map<String, uint64_t> m_pending;
+  };
+
+  /// @}
+}
+
+#endif // Hypertable_Master_GcReferenceMap_h
@@ -23,8 +23,14 @@
 
 #include "GcWorker.h"
 
+#include <Common/Time.h>
+
 #include <boost/algorithm/string.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 extern "C" {
 #include <unistd.h>
 }
@@ -32,42 +38,117 @@ extern "C" {
 using namespace Hypertable;
 using namespace std;
 
-GcWorker::GcWorker(ContextPtr &context) : m_context(context) {
+namespace {
+
+  /// Maximum number of rows rescanned with one scanner
+  const size_t ROW_BATCH_SIZE = 1000;
+
+}
+
+GcWorker::GcWorker(ContextPtr &context)
+  : m_context(context), m_references(&context->gc_references) {
   m_tables_dir = context->props->get_str("Hypertable.Directory");
   boost::trim_if(m_tables_dir, boost::is_any_of("/"));
   m_tables_dir = String("/") + m_tables_dir + "/tables/";
+  m_full_scan_interval =
+    context->props->get_i32("Hypertable.Master.Gc.FullScanInterval");
+  m_timestamp_margin =
+    (int64_t)context->props->get_i32("Hypertable.Master.Gc.TimestampMargin")
+    * 1000000LL;
+  m_delete_threads =
+    std::max(context->props->get_i32("Hypertable.Master.Gc.DeleteThreads"), 1);
+  m_max_deletes_per_second =
+    context->props->get_i32("Hypertable.Master.Gc.MaxDeletesPerSecond");
 }
 
 void GcWorker::gc() {
+  lock_guard<mutex> lock(m_context->gc_mutex);
   try {
-    CountMap files_map;
-    scan_metadata(files_map);
+    int64_t pass_start = get_ts64();
+    m_references->begin_pass();
+    if (m_references->last_pass_start == 0 ||
+        m_references->passes_since_full_scan >= m_full_scan_interval) {
+      scan_full();
+      m_references->passes_since_full_scan = 0;
+    }
+    else {
+      scan_incremental(m_references->last_pass_start - m_timestamp_margin);
+      m_references->passes_since_full_scan++;
+    }
+    m_references->last_pass_start = pass_start;
     // TODO: scan_directories(files_map); // fsckish, slower
-    reap(files_map);
+    reap();
+    delete_stale_cells();
   }
   catch (Exception &e) {
     HT_ERRORF("Error: caught exception while gc'ing: %s", e.what());
+    // The reference map may be partially updated, rebuild it next time
+    m_references->last_pass_start = 0;
   }
 }
 
 
-void GcWorker::scan_metadata(CountMap &files_map) {
+void GcWorker::scan_full() {
   ScanSpec scan_spec;
 
   scan_spec.columns.clear();
   scan_spec.columns.push_back("Files");
 
-  TableScannerPtr scanner(m_context->metadata_table->create_scanner(scan_spec));
+  HT_DEBUG("MasterGc: scanning metadata...");
 
-  TableMutatorPtr mutator(m_context->metadata_table->create_mutator());
+  m_references->begin_rebuild();
+  scan_rows(scan_spec, nullptr);
+  m_references->end_rebuild();
+
+  HT_INFOF("MasterGc: full scan found %lu files in %lu rows",
+           (Lu)m_references->file_count(), (Lu)m_references->row_count());
+}
+
+void GcWorker::scan_incremental(int64_t since) {
+  StringSet changed_rows;
+
+  {
+    ScanSpecBuilder ssb;
+    ssb.add_column("Files");
+    ssb.set_time_interval(since, TIMESTAMP_MAX);
+    ssb.set_keys_only(true);
+    TableScannerPtr scanner(m_context->metadata_table->create_scanner(ssb.get()));
+    Cell cell;
+    while (scanner->next(cell))
+      changed_rows.insert(cell.row_key);
+  }
+
+  HT_DEBUGF("MasterGc: rescanning %lu changed metadata rows",
+            (Lu)changed_rows.size());
+
+  auto iter = changed_rows.begin();
+  while (iter != changed_rows.end()) {
+    ScanSpecBuilder ssb;
+    ssb.add_column("Files");
+    StringSet batch;
+    for (; iter != changed_rows.end() && batch.size() < ROW_BATCH_SIZE; ++iter) {
+      ssb.add_row(*iter);
+      batch.insert(*iter);
+    }
+    StringSet rows_seen;
+    scan_rows(ssb.get(), &rows_seen);
+    // Rows that no longer have a Files column have been deleted
+    for (auto &row : batch)
+      if (rows_seen.count(row) == 0)
+        m_references->remove_row(row);
+  }
+}
+
+void GcWorker::scan_rows(ScanSpec &scan_spec, StringSet *rows_seen) {
+  TableScannerPtr scanner(m_context->metadata_table->create_scanner(scan_spec));
 
   Cell cell;
   string last_row;
   string last_cq;
   int64_t last_time = 0;
   bool found_valid_files = true;
-
-  HT_DEBUG("MasterGc: scanning metadata...");
+  vector<String> live;
+  vector<String> stale;
 
   while (scanner->next(cell)) {
     if (strcmp("Files", cell.column_family)) {
@@ -77,16 +158,19 @@ void GcWorker::scan_metadata(CountMap &files_map) {
     }
     if (last_row != cell.row_key) {
       // new row
-      if (!found_valid_files)
-        delete_row(last_row, mutator);
+      if (!last_row.empty())
+        finish_row(last_row, live, found_valid_files);
 
       last_row = cell.row_key;
       last_cq = cell.column_qualifier;
       last_time = cell.timestamp;
       found_valid_files = *cell.value != '!';
+      live.clear();
+      if (rows_seen)
+        rows_seen->insert(last_row);
 
       if (found_valid_files)
-        insert_files(files_map, (char *)cell.value, cell.value_len, 1);
+        insert_files(live, (char *)cell.value, cell.value_len);
     }
     else if (last_cq != cell.column_qualifier) {
       // new access group
@@ -96,7 +180,7 @@ void GcWorker::scan_metadata(CountMap &files_map) {
       found_valid_files |= is_valid_files;
 
       if (is_valid_files)
-        insert_files(files_map, (char *)cell.value, cell.value_len, 1);
+        insert_files(live, (char *)cell.value, cell.value_len);
     }
     else {
       // cruft to delete
@@ -105,45 +189,70 @@ void GcWorker::scan_metadata(CountMap &files_map) {
         continue;
       }
       if (cell.value_len == 0 || *cell.value != '!') {
-        insert_files(files_map, (char *)cell.value, cell.value_len);
-        delete_cell(cell, mutator);
+        stale.clear();
+        insert_files(stale, (char *)cell.value, cell.value_len);
+        for (auto &file : stale)
+          m_references->add_stale(file);
+        GcReferenceMap::StaleCell stale_cell;
+        stale_cell.row = cell.row_key;
+        stale_cell.qualifier = cell.column_qualifier;
+        stale_cell.timestamp = cell.timestamp;
+        m_references->add_stale_cell(stale_cell);
       }
     }
   }
-  // for last table
-  if (!found_valid_files)
-    delete_row(last_row, mutator);
-
-  mutator->flush();
+  // for last row
+  if (!last_row.empty())
+    finish_row(last_row, live, found_valid_files);
 }
 
-void GcWorker::delete_row(const std::string &row, TableMutatorPtr &mutator) {
-  KeySpec key;
+void GcWorker::finish_row(const String &row, vector<String> &live,
+                          bool found_valid_files) {
+  if (found_valid_files)
+    m_references->set_row(row, live);
+  else {
+    m_references->remove_row(row);
+    GcReferenceMap::StaleCell stale_cell;
+    stale_cell.row = row;
+    stale_cell.whole_row = true;
+    m_references->add_stale_cell(stale_cell);
+  }
+}
 
-  if (row.empty())
+void GcWorker::delete_stale_cells() {
+  vector<GcReferenceMap::StaleCell> cells;
+  m_references->take_stale_cells(cells);
+  if (cells.empty())
     return;
 
-  key.row = row.c_str();
-  key.row_len = row.length();
-  key.flag = FLAG_DELETE_ROW;
-
-  HT_DEBUGF("MasterGc: Deleting row %s", (char *)key.row);
-
-  mutator->set_delete(key);
-}
+  TableMutatorPtr mutator(m_context->metadata_table->create_mutator());
 
-void GcWorker::delete_cell(const Cell &cell, TableMutatorPtr &mutator) {
-  HT_DEBUG_OUT <<"MasterGc: Deleting cell: ("<< cell.row_key <<", "
-               << cell.column_family <<", "<< cell.column_qualifier <<", "
-               << cell.timestamp <<')'<< HT_END;
+  for (auto &cell : cells) {
+    KeySpec key;
+    key.row = cell.row.c_str();
+    key.row_len = cell.row.length();
+    if (cell.whole_row) {
+      HT_DEBUGF("MasterGc: Deleting row %s", cell.row.c_str());
+      key.flag = FLAG_DELETE_ROW;
+    }
+    else {
+      HT_DEBUG_OUT <<"MasterGc: Deleting cell: ("<< cell.row <<", Files, "
+                   << cell.qualifier <<", "<< cell.timestamp <<')'<< HT_END;
+      key.column_family = "Files";
+      key.column_qualifier = cell.qualifier.c_str();
+      key.column_qualifier_len = cell.qualifier.length();
+      key.timestamp = cell.timestamp;
+      key.flag = FLAG_DELETE_CELL;
+    }
+    mutator->set_delete(key);
+  }
 
-  KeySpec key(cell.row_key, cell.column_family, cell.column_qualifier,
-              cell.timestamp, FLAG_DELETE_CELL);
-  mutator->set_delete(key);
+  mutator->flush();
 }
 
 
-void GcWorker::insert_files(CountMap &map, const char *buf, size_t len, int c) {
+void GcWorker::insert_files(vector<String> &files, const char *buf,
+                            size_t len) {
   const char *p = buf, *pn = p, *endp = p + len - 1;
 
   while (p < endp) {
@@ -153,46 +262,78 @@ void GcWorker::insert_files(CountMap &map, const char *buf, size_t len, int c) {
     if (p == endp)
       break;
 
-    string name(pn, p - pn);
+    if (*pn == '#')
+      ++pn;
+    files.push_back(String(pn, p - pn));
     p += 2;
-    insert_file(map, name.c_str(), c);
     pn = p;
   }
 }
 
-void GcWorker::insert_file(CountMap &map, const char *fname, int c) {
-  if (*fname == '#')
-    ++fname;
-
-  CountMap::InsRet ret = map.insert(fname, c);
-
-  if (!ret.second)
-    (*ret.first).second += c;
-}
-
 /**
  * Currently only stale cs files and range directories are reaped
  * Table directories probably should be obtained when removing
  * rows in METADATA
  */
-void GcWorker::reap(CountMap &files_map) {
-  size_t nf = 0, nf_done = 0, nd = 0, nd_done = 0;
+void GcWorker::reap() {
+  vector<String> files, failed;
+
+  m_references->reap_candidates(files);
+  if (files.empty())
+    return;
+
+  auto start = chrono::steady_clock::now();
+  size_t removed =
+    remove_files(files, m_delete_threads, m_max_deletes_per_second,
+                 [this](const String &name) {
+                   HT_INFOF("MasterGc: removing file %s", name.c_str());
+                   m_context->dfs->remove(m_tables_dir + name);
+                 }, failed);
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+  // Retry failed removals on the next pass
+  for (auto &file : failed)
+    m_references->add_stale(file);
+
+  HT_INFOF("MasterGc: removed %lu/%lu files in %.3f seconds; %lu pending",
+           (Lu)removed, (Lu)files.size(), elapsed.count(),
+           (Lu)m_references->pending_count());
+}
 
-  for (const auto &v : files_map) {
-    if (!v.second) {
-      HT_INFOF("MasterGc: removing file %s", v.first);
+size_t GcWorker::remove_files(const vector<String> &files, int threads,
+                              int max_per_second,
+                              function<void(const String &)> remove,
+                              vector<String> &failed) {
+  atomic<size_t> next(0);
+  atomic<size_t> removed(0);
+  mutex failed_mutex;
+  auto start = chrono::steady_clock::now();
+
+  auto worker = [&]() {
+    for (size_t i = next++; i < files.size(); i = next++) {
+      if (max_per_second > 0)
+        this_thread::sleep_until(start + chrono::microseconds(
+                                   (int64_t)i * 1000000 / max_per_second));
       try {
-        m_context->dfs->remove(m_tables_dir + v.first);
-        ++nf_done;
+        remove(files[i]);
+        removed++;
       }
       catch (Exception &e) {
         HT_WARNF("%s", e.what());
+        lock_guard<mutex> lock(failed_mutex);
+        failed.push_back(files[i]);
       }
-      ++nf;
     }
-  }
-
-  HT_DEBUGF("MasterGc: removed %lu/%lu files; %lu/%lu directories",
-            (Lu)nf_done, (Lu)nf, (Lu)nd_done, (Lu)nd);
+  };
+
+  size_t thread_count = std::min((size_t)std::max(threads, 1), files.size());
+  vector<thread> pool;
+  pool.reserve(thread_count);
+  for (size_t i=1; i<thread_count; i++)
+    pool.emplace_back(worker);
+  worker();
+  for (auto &t : pool)
+    t.join();
+
+  return removed;
 }
-
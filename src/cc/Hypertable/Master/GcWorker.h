@@ -23,30 +23,63 @@
 #define HYPERTABLE_GCWORKER_H
 
 #include <Hypertable/Master/Context.h>
+#include <Hypertable/Master/GcReferenceMap.h>
 
 #include <Hypertable/Lib/Client.h>
 
-#include <Common/CstrHashMap.h>
+#include <functional>
+#include <vector>
 
 namespace Hypertable {
 
-  typedef CstrHashMap<int> CountMap; // filename -> reference count
-
+  /// Garbage collector for CellStore files.
+  /// Each pass brings the GcReferenceMap held in the Context up to date with
+  /// the <code>Files</code> column of METADATA, then deletes the files that
+  /// have been unreferenced for a full pass.  The first pass, and every
+  /// <code>Hypertable.Master.Gc.FullScanInterval</code> passes after that,
+  /// rebuild the map from a scan of the whole column.  The other passes only
+  /// rescan rows with a <code>Files</code> cell written since the previous
+  /// pass started, less <code>Hypertable.Master.Gc.TimestampMargin</code> to
+  /// cover clock skew between the Master and the METADATA RangeServers.
   class GcWorker {
   public:
     GcWorker(ContextPtr &context);
     void gc();
 
+    /// Removes files in parallel.
+    /// Files are claimed one at a time by <code>threads</code> threads.
+    /// When <code>max_per_second</code> is positive, the <i>i</i>th removal
+    /// is not started before <i>i</i>/<code>max_per_second</code> seconds
+    /// have elapsed, which spreads the load on the filesystem evenly.
+    /// @param files Files to remove
+    /// @param threads Number of threads
+    /// @param max_per_second Maximum removal rate, 0 for no limit
+    /// @param remove Function removing one file, throws Exception on error
+    /// @param failed Receives files whose removal failed
+    /// @return Number of files removed
+    static size_t remove_files(const std::vector<String> &files,
+                               int threads, int max_per_second,
+                               std::function<void(const String &)> remove,
+                               std::vector<String> &failed);
+
   private:
-    void scan_metadata(CountMap &files_map);
-    void delete_row(const std::string &row, TableMutatorPtr &mutator);
-    void delete_cell(const Cell &cell, TableMutatorPtr &mutator);
-    void insert_files(CountMap &map, const char *buf, size_t len, int c=0);
-    void insert_file(CountMap &map, const char *fname, int c);
-    void reap(CountMap &files_map);
-
-    ContextPtr m_context;
-    String     m_tables_dir;
+    void scan_full();
+    void scan_incremental(int64_t since);
+    void scan_rows(ScanSpec &scan_spec, StringSet *rows_seen);
+    void finish_row(const String &row, std::vector<String> &live,
+                    bool found_valid_files);
+    void delete_stale_cells();
+    void insert_files(std::vector<String> &files, const char *buf,
+                      size_t len);
+    void reap();
+
+    ContextPtr      m_context;
+    GcReferenceMap *m_references;
+    String          m_tables_dir;
+    uint32_t        m_full_scan_interval;
+    int64_t         m_timestamp_margin;
+    int32_t         m_delete_threads;
+    int32_t         m_max_deletes_per_second;
   };
 
 } // namespace Hypertable
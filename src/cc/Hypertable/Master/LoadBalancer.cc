@@ -23,6 +23,7 @@
 #include "BalanceAlgorithmEvenRanges.h"
 #include "BalanceAlgorithmLoad.h"
 #include "BalanceAlgorithmOffload.h"
+#include "BalanceAlgorithmRangeLoad.h"
 #include "LoadBalancer.h"
 #include "Utility.h"
 
@@ -156,6 +157,8 @@ void LoadBalancer::create_plan(BalancePlanPtr &plan,
       algo = make_shared<BalanceAlgorithmEvenRanges>(m_context, m_statistics);
     else if (name == "load")
       algo = make_shared<BalanceAlgorithmLoad>(m_context, m_statistics);
+    else if (name == "range_load")
+      algo = make_shared<BalanceAlgorithmRangeLoad>(m_context, m_statistics);
     else
       HT_THROWF(Error::MASTER_BALANCE_PREVENTED,
                 "Unrecognized algorithm - %s", name.c_str());
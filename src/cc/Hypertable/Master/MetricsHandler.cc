@@ -79,6 +79,8 @@ void MetricsHandler::handle(Hypertable::EventPtr &event) {
     m_ganglia_collector->update("operations", m_operations.rate(elapsed_secs));
     m_operations.reset();
 
+    m_operation_latency.publish(m_ganglia_collector.get());
+
     try {
       m_ganglia_collector->publish();
     }
@@ -30,6 +30,8 @@
 #include <AsyncComm/Comm.h>
 #include <AsyncComm/DispatchHandler.h>
 
+#include <Hypertable/Master/OperationLatency.h>
+
 #include <Common/MetricsCollectorGanglia.h>
 #include <Common/MetricsProcess.h>
 #include <Common/Properties.h>
@@ -66,8 +68,9 @@ namespace Hypertable {
     void stop_collecting();
 
     /// Collects and publishes metrics.
-    /// This method computes and updates the <code>operations/s</code> and
-    /// general process metrics and publishes them via #m_ganglia_collector.
+    /// This method computes and updates the <code>operations/s</code>,
+    /// operation latency percentile and general process metrics and
+    /// publishes them via #m_ganglia_collector.
     /// After metrics have been collected, the timer is re-registered for
     /// #m_collection_interval milliseconds in the future.
     /// @param event %Comm layer timer event
@@ -79,6 +82,14 @@ namespace Hypertable {
       m_operations.current++;
     }
 
+    /// Returns operation latency histograms.
+    /// The histograms are filled in by OperationProcessor and their interval
+    /// percentiles are published by handle().
+    /// @return Reference to operation latency histograms
+    OperationLatency &operation_latency() {
+      return m_operation_latency;
+    }
+
   private:
 
     /// Comm layer
@@ -99,6 +110,9 @@ namespace Hypertable {
     /// %Master operations
     interval_metric<int64_t> m_operations {};
 
+    /// %Operation queue, block and execute times
+    OperationLatency m_operation_latency;
+
     /// Collection has started
     bool m_started {};
   };
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for OperationLatency.
+/// This file contains type definitions for OperationLatency, a class that
+/// records how long %Master operations spend queued, blocked and executing.
+
+#include <Common/Compat.h>
+
+#include "OperationLatency.h"
+
+#include <iomanip>
+#include <memory>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *phase_name[OperationLatency::PHASE_COUNT] = {
+    "queue", "block", "execute"
+  };
+
+  inline double to_ms(int64_t us) {
+    return (double)us / 1000.0;
+  }
+
+}
+
+OperationLatency::PhaseHistograms &
+OperationLatency::by_name(const String &name) {
+  lock_guard<mutex> lock(m_mutex);
+  auto &histograms = m_by_name[name];
+  if (!histograms)
+    histograms = make_unique<PhaseHistograms>();
+  return *histograms;
+}
+
+void OperationLatency::record(const String &name, Phase phase,
+                              chrono::steady_clock::duration duration) {
+  int64_t us = chrono::duration_cast<chrono::microseconds>(duration).count();
+  m_interval[phase].record(us);
+  by_name(name)[phase].record(us);
+}
+
+void OperationLatency::publish(MetricsCollector *collector) {
+  for (int i=0; i<PHASE_COUNT; i++) {
+    LatencyHistogram::Snapshot snapshot;
+    m_interval[i].collect(snapshot);
+    String prefix = String("operation.") + phase_name[i];
+    collector->update(prefix + ".p50", to_ms(snapshot.percentile(50)));
+    collector->update(prefix + ".p99", to_ms(snapshot.percentile(99)));
+    collector->update(prefix + ".max", to_ms(snapshot.max));
+  }
+}
+
+void OperationLatency::report(std::ostream &out) {
+  lock_guard<mutex> lock(m_mutex);
+  out << fixed << setprecision(3);
+  for (auto &entry : m_by_name) {
+    for (int i=0; i<PHASE_COUNT; i++) {
+      LatencyHistogram::Snapshot snapshot;
+      (*entry.second)[i].collect(snapshot, false);
+      if (snapshot.count == 0)
+        continue;
+      out << entry.first << " " << phase_name[i]
+          << ": count=" << snapshot.count
+          << " mean=" << snapshot.mean() / 1000.0
+          << "ms p50=" << to_ms(snapshot.percentile(50))
+          << "ms p99=" << to_ms(snapshot.percentile(99))
+          << "ms max=" << to_ms(snapshot.max) << "ms\n";
+    }
+  }
+  out.unsetf(ios::floatfield);
+}
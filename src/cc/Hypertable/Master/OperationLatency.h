@@ -0,0 +1,119 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for OperationLatency.
+/// This file contains type declarations for OperationLatency, a class that
+/// records how long %Master operations spend queued, blocked and executing.
+
+#ifndef Hypertable_Master_OperationLatency_h
+#define Hypertable_Master_OperationLatency_h
+
+#include <Common/LatencyHistogram.h>
+#include <Common/MetricsCollector.h>
+#include <Common/String.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+
+namespace Hypertable {
+
+  /// @addtogroup Master
+  /// @{
+
+  /// Latency histograms for %Master operations.
+  /// OperationProcessor records three phases for every run of an operation:
+  ///   - <b>queue</b>: time from the moment all of the operation's
+  ///     dependencies are satisfied until a worker thread picks it up
+  ///   - <b>block</b>: time from the moment a run of the operation reports
+  ///     itself blocked until it is unblocked
+  ///   - <b>execute</b>: time spent in Operation::pre_run(),
+  ///     Operation::execute() and Operation::post_run()
+  ///
+  /// Each phase is kept in a LatencyHistogram of microseconds, once for the
+  /// current metrics interval and once per operation name since startup.  The interval histograms are published as
+  /// percentiles by MetricsHandler; the per-name histograms are written to
+  /// the operation state dump (see ConnectionHandler).
+  class OperationLatency {
+  public:
+
+    /// Operation phase
+    enum Phase {
+      /// Waiting for a worker thread
+      QUEUE = 0,
+      /// Blocked
+      BLOCK,
+      /// Running
+      EXECUTE,
+      /// Number of phases
+      PHASE_COUNT
+    };
+
+    /// Records the duration of a phase.
+    /// @param name %Operation name (see Operation::name())
+    /// @param phase Phase
+    /// @param duration Time spent in <code>phase</code>
+    void record(const String &name, Phase phase,
+                std::chrono::steady_clock::duration duration);
+
+    /// Publishes and resets interval histograms.
+    /// For each phase, publishes the metrics
+    /// <code>operation.<i>phase</i>.p50</code>, <code>.p99</code> and
+    /// <code>.max</code> in milliseconds.
+    /// @param collector Metrics collector
+    void publish(MetricsCollector *collector);
+
+    /// Writes per-operation summary.
+    /// Writes one line per operation name and phase with count, mean, 50th
+    /// and 99th percentile, and maximum, in milliseconds.
+    /// @param out Output stream
+    void report(std::ostream &out);
+
+  private:
+
+    /// Histograms for each phase
+    typedef std::array<LatencyHistogram, PHASE_COUNT> PhaseHistograms;
+
+    /// Returns histograms of an operation name, creating them if necessary.
+    /// @param name %Operation name
+    /// @return Histograms of <code>name</code>
+    PhaseHistograms &by_name(const String &name);
+
+    /// %Mutex protecting #m_by_name
+    std::mutex m_mutex;
+
+    /// Histograms for current metrics interval
+    PhaseHistograms m_interval;
+
+    /// Histograms per operation name since startup, never erased so
+    /// references stay valid after #m_mutex is released
+    std::map<String, std::unique_ptr<PhaseHistograms>> m_by_name;
+  };
+
+  /// @}
+}
+
+#endif // Hypertable_Master_OperationLatency_h
@@ -34,7 +34,6 @@
 #include <Common/Path.h>
 #include <Common/StringExt.h>
 
-#include <boost/graph/topological_sort.hpp>
 #include <boost/graph/graphviz.hpp>
 
 #include <chrono>
@@ -47,10 +46,8 @@ using namespace Hypertable;
 using namespace std;
 
 OperationProcessor::ThreadContext::ThreadContext(ContextPtr &mctx)
-  : master_context(mctx), current_blocked(0), busy_count(0),
-    need_order_recompute(false), shutdown(false), paused(false) {
-  current_iter = current.end();
-  execution_order_iter = execution_order.end();
+  : master_context(mctx), busy_count(0), graph_changed(false),
+    shutdown(false), paused(false) {
 }
 
 OperationProcessor::ThreadContext::~ThreadContext() {
@@ -67,7 +64,6 @@ OperationProcessor::OperationProcessor(ContextPtr &context, size_t thread_count)
     m_graphviz_out = std::make_unique<std::ofstream>(filename.c_str(), ofstream::out|ofstream::app);
   }
 
-  m_context.execution_order_iter = m_context.execution_order.end();
   m_context.op = this;
   Worker worker(m_context);
   for (size_t i=0; i<thread_count; ++i)
@@ -89,12 +85,8 @@ void OperationProcessor::add_operation(OperationPtr operation) {
   if (m_context.op_ids.count(operation->id()) > 0)
     return;
 
-  if (!operation->is_complete() || operation->is_perpetual()) {
+  if (!operation->is_complete() || operation->is_perpetual())
     add_operation_internal(operation);
-    m_context.need_order_recompute = true;
-    m_context.current_iter = m_context.current.end();
-    m_context.cond.notify_all();
-  }
   else if (operation->get_remove_approval_mask() == 0)
     m_context.master_context->response_manager->add_operation(operation);
 
@@ -102,7 +94,6 @@ void OperationProcessor::add_operation(OperationPtr operation) {
 
 void OperationProcessor::add_operations(std::vector<OperationPtr> &operations) {
   std::lock_guard<std::mutex> lock(m_context.mutex);
-  bool added = false;
 
   for (auto & operation : operations) {
 
@@ -112,19 +103,11 @@ void OperationProcessor::add_operations(std::vector<OperationPtr> &operations) {
     if (m_context.op_ids.count(operation->id()) > 0)
       continue;
 
-    if (!operation->is_complete() || operation->is_perpetual()) {
+    if (!operation->is_complete() || operation->is_perpetual())
       add_operation_internal(operation);
-      added = true;
-    }
     else if (operation->get_remove_approval_mask() == 0)
       m_context.master_context->response_manager->add_operation(operation);
   }
-
-  if (added) {
-    m_context.need_order_recompute = true;
-    m_context.current_iter = m_context.current.end();
-    m_context.cond.notify_all();
-  }
 }
 
 void OperationProcessor::add_operation_internal(OperationPtr &operation) {
@@ -139,13 +122,14 @@ void OperationProcessor::add_operation_internal(OperationPtr &operation) {
 
   Vertex v = add_vertex(m_context.graph);
   put(m_context.label, v, operation->graphviz_label());
-  put(m_context.exec_time, v, 0);
   put(m_context.ops, v, operation);
   put(m_context.busy, v, false);
   m_context.live.insert(v);
   m_context.operation_hash[operation->hash_code()]=OperationVertex(operation,v);
   add_dependencies(v, operation);
   HT_ASSERT(m_context.op_ids.insert(operation->id()).second);
+  m_context.graph_changed = true;
+  schedule(v);
 }
 
 OperationPtr OperationProcessor::remove_operation(int64_t hash_code) {
@@ -186,17 +170,13 @@ void OperationProcessor::wait_for_empty() {
 
 void OperationProcessor::wait_for_idle() {
   std::unique_lock<std::mutex> lock(m_context.mutex);
-  while (m_context.busy_count > 0 ||
-         m_context.need_order_recompute ||
-         m_context.execution_order_iter != m_context.execution_order.end())
+  while (m_context.busy_count > 0 || !m_context.ready.empty())
     m_context.idle_cond.wait(lock);
 }
 
 bool OperationProcessor::wait_for_idle(std::chrono::milliseconds max_wait) {
   std::unique_lock<std::mutex> lock(m_context.mutex);
-  while (m_context.busy_count > 0 ||
-         m_context.need_order_recompute ||
-         m_context.execution_order_iter != m_context.execution_order.end()) {
+  while (m_context.busy_count > 0 || !m_context.ready.empty()) {
     if (m_context.idle_cond.wait_for(lock, max_wait) == std::cv_status::timeout)
       return false;
   }
@@ -213,29 +193,31 @@ bool OperationProcessor::empty() {
 
 void OperationProcessor::wake_up() {
   std::lock_guard<std::mutex> lock(m_context.mutex);
-  m_context.need_order_recompute = true;
-  m_context.cond.notify_all();
+  VertexSet blocked;
+  blocked.swap(m_context.blocked);
+  for (auto v : blocked)
+    schedule_blocked(v);
+  reevaluate();
 }
 
 void OperationProcessor::unblock(const String &name) {
   std::lock_guard<std::mutex> lock(m_context.mutex);
   std::pair<DependencyIndex::iterator, DependencyIndex::iterator> bound;
-  bool unblocked_something = false;
+  VertexSet unblocked;
 
   for (bound = m_context.obstruction_index.equal_range(name);
        bound.first != bound.second; ++bound.first)
     if (m_context.ops[bound.first->second]->unblock())
-      unblocked_something = true;
+      unblocked.insert(bound.first->second);
 
   for (bound = m_context.exclusivity_index.equal_range(name);
        bound.first != bound.second; ++bound.first)
     if (m_context.ops[bound.first->second]->unblock())
-      unblocked_something = true;
+      unblocked.insert(bound.first->second);
 
-  if (unblocked_something) {
-    m_context.current_blocked = 0;
-    m_context.need_order_recompute = true;
-    m_context.cond.notify_all();
+  for (auto v : unblocked) {
+    if (m_context.blocked.erase(v))
+      schedule_blocked(v);
   }
 
 }
@@ -263,9 +245,6 @@ void OperationProcessor::activate(const String &name) {
         m_context.perpetual_ops.erase(rm_iter);
         operation->set_state(OperationState::INITIAL);
         add_operation_internal(operation);
-        m_context.need_order_recompute = true;
-        m_context.current_iter = m_context.current.end();
-        m_context.cond.notify_all();
       }
       else
         ++iter;
@@ -279,7 +258,7 @@ void OperationProcessor::activate(const String &name) {
 void OperationProcessor::Worker::operator()() {
   Vertex vertex;
   OperationPtr operation;
-  bool current_needs_loading = true;
+  std::chrono::steady_clock::time_point start_time;
 
   try {
 
@@ -287,45 +266,38 @@ void OperationProcessor::Worker::operator()() {
       {
         std::unique_lock<std::mutex> lock(m_context.mutex);
 
-        if (m_context.shutdown)
-          return;
-
-        while (m_context.current_iter == m_context.current.end()) {
+        while (!m_context.op->next_ready(vertex)) {
 
-          if (m_context.need_order_recompute) {
-            m_context.op->recompute_order();
-            current_needs_loading = true;
-          }
-          else
-            current_needs_loading =
-              m_context.current_active.empty() && m_context.current_blocked == 0;
-
-          if (current_needs_loading &&
-              m_context.execution_order_iter != m_context.execution_order.end()) {
-            if (m_context.op->load_current()) {
-              if (m_context.shutdown)
-                return;
+          if (m_context.busy_count == 0) {
+            if (m_context.op->reevaluate())
               continue;
-            }
-          }
-
-          if (m_context.busy_count == 0)
             m_context.idle_cond.notify_all();
+          }
 
           if (m_context.shutdown)
             return;
 
           m_context.cond.wait(lock);
-
-          if (m_context.shutdown)
-            return;
         }
 
-        vertex = m_context.current_iter->vertex;
-        ++m_context.current_iter;
+        if (m_context.shutdown)
+          return;
+
         operation = m_context.ops[vertex];
         m_context.busy[vertex] = true;
         m_context.busy_count++;
+
+        start_time = std::chrono::steady_clock::now();
+        m_context.op->record_latency(operation, OperationLatency::QUEUE,
+                                     start_time - m_context.timing[vertex].queued);
+
+        if (m_context.op->m_graphviz_out && m_context.graph_changed) {
+          m_context.op->reindex();
+          write_graphviz(*m_context.op->m_graphviz_out, m_context.graph,
+                         make_label_writer(m_context.label));
+          *m_context.op->m_graphviz_out << flush;
+          m_context.graph_changed = false;
+        }
       }
 
       try {
@@ -335,33 +307,40 @@ void OperationProcessor::Worker::operator()() {
           operation->execute();
         operation->post_run();
 
+        auto now = std::chrono::steady_clock::now();
+        m_context.op->record_latency(operation, OperationLatency::EXECUTE,
+                                     now - start_time);
+
         {
           std::lock_guard<std::mutex> lock(m_context.mutex);
           m_context.busy[vertex] = false;
           m_context.busy_count--;
-          m_context.current_active.erase(vertex);
           if (operation->is_complete())
             m_context.op->retire_operation(vertex, operation);
-          else if (operation->is_blocked())
-            m_context.current_blocked++;
+          else if (operation->is_blocked()) {
+            m_context.blocked.insert(vertex);
+            m_context.timing[vertex].blocked = now;
+          }
           else
             m_context.op->update_operation(vertex, operation);
         }
       }
       catch (Exception &e) {
-        std::lock_guard<std::mutex> lock(m_context.mutex);
-        m_context.busy[vertex] = false;
-        m_context.busy_count--;
-        m_context.current_active.erase(vertex);
-        if (e.code() == Error::INDUCED_FAILURE) {
-          m_context.shutdown = true;
-          m_context.cond.notify_all();
-          m_context.master_context->mml_writer->close();
-          break;
+        {
+          std::lock_guard<std::mutex> lock(m_context.mutex);
+          m_context.busy[vertex] = false;
+          m_context.busy_count--;
+          if (e.code() == Error::INDUCED_FAILURE) {
+            m_context.shutdown = true;
+            m_context.cond.notify_all();
+            m_context.master_context->mml_writer->close();
+            break;
+          }
         }
         HT_ERROR_OUT << e << HT_END;
         std::this_thread::sleep_for(std::chrono::milliseconds(5000));
-        m_context.need_order_recompute = true;
+        std::lock_guard<std::mutex> lock(m_context.mutex);
+        m_context.op->schedule(vertex);
       }
 
     }
@@ -554,17 +533,21 @@ void OperationProcessor::add_edge(Vertex v, Vertex u) {
   std::pair<Edge, bool> ep = boost::add_edge(v, u, m_context.graph);
   HT_ASSERT(ep.second);
   put(m_context.permanent, ep.first, false);
+  // v now waits for u
+  m_context.ready.erase(v);
 }
 
 void OperationProcessor::add_edge_permanent(Vertex v, Vertex u) {
   std::pair<Edge, bool> ep = boost::add_edge(v, u, m_context.graph);
   HT_ASSERT(ep.second);
   put(m_context.permanent, ep.first, true);
+  m_context.ready.erase(v);
 }
 
 void OperationProcessor::graphviz_output(String &output) {
   std::lock_guard<std::mutex> lock(m_context.mutex);
   std::ostringstream oss;
+  reindex();
   write_graphviz(oss, m_context.graph, make_label_writer(m_context.label));
   output = oss.str();
 }
@@ -576,8 +559,8 @@ void OperationProcessor::state_description(String &output) {
 
   oss << "Num vertices = " << num_vertices(m_context.graph) << "\n";
   oss << "Busy count = " << m_context.busy_count << "\n";
-  oss << "Active set size = " << m_context.current_active.size() << "\n";
-  oss << "Need order recompute = " << (m_context.need_order_recompute ? "true\n" : "false\n");
+  oss << "Ready count = " << m_context.ready.size() << "\n";
+  oss << "Blocked count = " << m_context.blocked.size() << "\n";
   oss << "Shutdown = " << (m_context.shutdown ? "true\n" : "false\n");
   oss << "Paused = " << (m_context.paused ? "true\n" : "false\n");
   oss << "\n";
@@ -589,7 +572,8 @@ void OperationProcessor::state_description(String &output) {
   for (vp = vertices(m_context.graph); vp.first != vp.second; ++vp.first) {
     vset.insert(*vp.first);
     oss << i << ": " << m_context.ops[*vp.first]->label() << "\n";
-    oss << "  active: " << ((m_context.current_active.count(*vp.first) > 0) ? "true\n" : "false\n");
+    oss << "  busy: " << (m_context.busy[*vp.first] ? "true\n" : "false\n");
+    oss << "  ready: " << ((m_context.ready.count(*vp.first) > 0) ? "true\n" : "false\n");
     oss << "  live: " << ((m_context.live.count(*vp.first) > 0) ? "true\n" : "false\n");
     oss << "  exclusive: " << (m_context.ops[*vp.first]->exclusive() ? "true\n" : "false\n");
     oss << "  perpetual: " << (m_context.ops[*vp.first]->is_perpetual() ? "true\n" : "false\n");
@@ -631,51 +615,44 @@ void OperationProcessor::state_description(String &output) {
     oss << "\n";
   }
   
-  oss << "Current:\n";
-  for (ExecutionList::iterator iter = m_context.current.begin();
-       iter != m_context.current.end(); ++iter) {
-    if (iter == m_context.current_iter)
-      oss << "*";
-    if (vset.count(iter->vertex))
-      oss << m_context.ops[iter->vertex]->label() << "\n";
-    else
-      oss << "[retired]\n" ;
+  oss << "Run queue:\n";
+  for (auto v : m_context.run_queue) {
+    if (m_context.ready.count(v) && vset.count(v))
+      oss << m_context.ops[v]->label() << "\n";
   }
-  if (m_context.current_iter == m_context.current.end())
-    oss << "*\n";
   oss << "\n";
 
-  oss << "Execution order:\n";
-  for (ExecutionList::iterator iter = m_context.execution_order.begin();
-       iter != m_context.execution_order.end(); ++iter) {
-    if (iter == m_context.execution_order_iter)
-      oss << "*";
-    if (vset.count(iter->vertex)) {
-      oss << m_context.ops[iter->vertex]->label() << " (time=";
-      oss << m_context.exec_time[iter->vertex] << ")\n";
-    }
-    else
-      oss << "[retired]\n" ;
+  if (m_context.master_context->metrics_handler) {
+    oss << "Latency:\n";
+    m_context.master_context->metrics_handler->operation_latency().report(oss);
+    oss << "\n";
   }
-  if (m_context.execution_order_iter == m_context.execution_order.end())
-    oss << "*\n";
-  oss << "\n";
 
   oss << "Graphviz:\n";
+  reindex();
   write_graphviz(oss, m_context.graph, make_label_writer(m_context.label));
   output = oss.str();
 }
 
 
 void OperationProcessor::retire_operation(Vertex v, OperationPtr &operation) {
+  GraphTraits::in_edge_iterator in_i, in_end;
+  std::vector<Vertex> waiting;
+
+  // Operations waiting on this one
+  for (boost::tie(in_i, in_end) = in_edges(v, m_context.graph); in_i != in_end; ++in_i)
+    waiting.push_back(source(*in_i, m_context.graph));
+
   m_context.op->purge_from_obstruction_index(v);
   m_context.op->purge_from_dependency_index(v);
   m_context.op->purge_from_exclusivity_index(v);
-  if (in_degree(v, m_context.graph) > 0)
-    m_context.need_order_recompute = true;
   clear_vertex(v, m_context.graph);
   remove_vertex(v, m_context.graph);
   m_context.live.erase(v);
+  m_context.ready.erase(v);
+  m_context.blocked.erase(v);
+  m_context.timing.erase(v);
+  m_context.graph_changed = true;
   m_context.operation_hash.erase(operation->hash_code());
   if (operation->exclusive())
     m_context.exclusive_ops.erase(operation->name());
@@ -692,11 +669,22 @@ void OperationProcessor::retire_operation(Vertex v, OperationPtr &operation) {
       m_context.master_context->response_manager->add_operation(operation);
   }
   m_context.op_ids.erase(operation->id());
+
+  for (auto u : waiting)
+    schedule(u);
+
+  if (num_vertices(m_context.graph) == 0)
+    m_context.idle_cond.notify_all();
 }
 
 
 void OperationProcessor::update_operation(Vertex v, OperationPtr &operation) {
   not_permanent np(m_context);
+  GraphTraits::in_edge_iterator in_i, in_end;
+  std::vector<Vertex> waiting;
+
+  for (boost::tie(in_i, in_end) = in_edges(v, m_context.graph); in_i != in_end; ++in_i)
+    waiting.push_back(source(*in_i, m_context.graph));
 
   m_context.op->purge_from_obstruction_index(v);
   m_context.op->purge_from_dependency_index(v);
@@ -715,113 +703,75 @@ void OperationProcessor::update_operation(Vertex v, OperationPtr &operation) {
     }
   }
 
-  m_context.need_order_recompute = true;
-  m_context.current_iter = m_context.current.end();
-  m_context.cond.notify_all();
-}
-
-
-void OperationProcessor::recompute_order() {
-
-  // re-assign vertex indexes
-  boost::property_map<OperationGraph, boost::vertex_index_t>::type index = get(boost::vertex_index, m_context.graph);
-  int i=0;
-  std::pair<GraphTraits::vertex_iterator, GraphTraits::vertex_iterator> vp;
-  for (vp = vertices(m_context.graph); vp.first != vp.second; ++vp.first)
-    put(index, *vp.first, i++);
-
-  if (m_graphviz_out) {
-    write_graphviz(*m_graphviz_out, m_context.graph, make_label_writer(m_context.label));
-    *m_graphviz_out << flush;
-  }
+  m_context.graph_changed = true;
 
-  m_context.execution_order.clear();
-  try {
-    topological_sort(m_context.graph, std::back_inserter(m_context.execution_order));
-  }
-  catch (std::invalid_argument &) {
-    write_graphviz(std::cout, m_context.graph, make_label_writer(m_context.label));
-  }
+  for (auto u : waiting)
+    schedule(u);
+  schedule(v);
+}
 
-  ExecutionList::iterator iter;
 
-  for (iter = m_context.execution_order.begin(); iter != m_context.execution_order.end(); ++iter) {
-    HT_ASSERT(m_context.live.count(iter->vertex) > 0);
-    //HT_ASSERT(!m_context.ops[*iter]->is_complete());
-    m_context.exec_time[iter->vertex] = 0;
-  }
+void OperationProcessor::schedule(Vertex v) {
+  if (m_context.live.count(v) == 0 || m_context.busy[v] ||
+      m_context.blocked.count(v) > 0 || m_context.ready.count(v) > 0 ||
+      out_degree(v, m_context.graph) > 0)
+    return;
+  m_context.ready.insert(v);
+  m_context.run_queue.push_back(v);
+  m_context.timing[v].queued = std::chrono::steady_clock::now();
+  m_context.cond.notify_one();
+}
 
-  for (iter = m_context.execution_order.begin(); iter != m_context.execution_order.end(); ++iter) {
-    // Walk through the out_edges an calculate the maximum time.
-    if (out_degree (iter->vertex, m_context.graph) > 0) {
-      OperationGraph::out_edge_iterator j, j_end;
-      int maxdist=0;
-      for (boost::tie(j, j_end) = out_edges(iter->vertex, m_context.graph); j != j_end; ++j)
-        maxdist=(std::max)(m_context.exec_time[target(*j, m_context.graph)], maxdist);
-      m_context.exec_time[iter->vertex] = maxdist+1;
-    }
-  }
 
-  // Sort execution order
-  std::vector<struct vertex_info> vvec;
-  for (iter = m_context.execution_order.begin(); iter != m_context.execution_order.end(); ++iter) {
-    iter->taken = m_context.busy[iter->vertex];
-    vvec.push_back(*iter);
-  }
+void OperationProcessor::schedule_blocked(Vertex v) {
+  if (m_context.live.count(v) == 0)
+    return;
+  record_latency(m_context.ops[v], OperationLatency::BLOCK,
+                 std::chrono::steady_clock::now() - m_context.timing[v].blocked);
+  schedule(v);
+}
 
-  std::set<Vertex> vset;
 
-  struct ltvertexinfo ltvi(m_context);
-  std::sort(vvec.begin(), vvec.end(), ltvi);
-  m_context.execution_order.clear();
-  for (size_t i=0; i<vvec.size(); i++) {
-    HT_ASSERT(vset.count(vvec[i].vertex) == 0);
-    vset.insert(vvec[i].vertex);
-    m_context.execution_order.push_back(vvec[i]);
+bool OperationProcessor::next_ready(Vertex &v) {
+  while (!m_context.run_queue.empty()) {
+    v = m_context.run_queue.front();
+    m_context.run_queue.pop_front();
+    // Entries whose vertex has since left the ready set are stale
+    if (m_context.ready.erase(v) > 0)
+      return true;
   }
-
-  m_context.execution_order_iter = m_context.execution_order.begin();
-
-  m_context.need_order_recompute = false;
-  if (m_context.execution_order.empty())
-    m_context.idle_cond.notify_all();
-
+  return false;
 }
 
 
-bool OperationProcessor::load_current() {
-  size_t blocked = 0;
-  size_t retired = 0;
-
-  m_context.current.clear();
-  m_context.current_active.clear();
-  m_context.current_blocked = 0;
-  for (int time_slot = m_context.exec_time[m_context.execution_order_iter->vertex];
-       m_context.execution_order_iter != m_context.execution_order.end() && time_slot == m_context.exec_time[m_context.execution_order_iter->vertex];
-       ++m_context.execution_order_iter) {
-    // If live, add it to the current set
-    if (m_context.live.count(m_context.execution_order_iter->vertex) > 0) {
-      m_context.current.push_back(*m_context.execution_order_iter);
-      m_context.current_active.insert(m_context.execution_order_iter->vertex);
-      if (!m_context.execution_order_iter->taken &&
-          m_context.ops[m_context.execution_order_iter->vertex]->is_blocked())
-        blocked++;
+bool OperationProcessor::reevaluate() {
+  bool scheduled = false;
+  for (auto v : m_context.live) {
+    if (m_context.ready.count(v) > 0)
+      continue;
+    schedule(v);
+    if (m_context.ready.count(v) > 0) {
+      HT_WARNF("Operation %s was ready but not scheduled",
+               m_context.ops[v]->label().c_str());
+      scheduled = true;
     }
-    else
-      retired++;
   }
+  return scheduled;
+}
 
-  //HT_INFOF("current size = %lu, blocked = %lu", m_context.current.size(), blocked);
-
-  m_context.current_iter = m_context.current.begin();
-  while (m_context.current_iter != m_context.current.end() && m_context.current_iter->taken)
-    ++m_context.current_iter;
 
-  if (m_context.current_iter != m_context.current.end() ||
-      blocked != m_context.current.size()) {
-    m_context.cond.notify_all();
-    return true;
-  }
-  return false;
+void OperationProcessor::reindex() {
+  boost::property_map<OperationGraph, boost::vertex_index_t>::type index = get(boost::vertex_index, m_context.graph);
+  int i=0;
+  std::pair<GraphTraits::vertex_iterator, GraphTraits::vertex_iterator> vp;
+  for (vp = vertices(m_context.graph); vp.first != vp.second; ++vp.first)
+    put(index, *vp.first, i++);
 }
 
+
+void OperationProcessor::record_latency(OperationPtr &operation,
+                                        OperationLatency::Phase phase,
+                                        std::chrono::steady_clock::duration duration) {
+  if (m_context.master_context->metrics_handler)
+    m_context.master_context->metrics_handler->operation_latency().record(operation->name(), phase, duration);
+}
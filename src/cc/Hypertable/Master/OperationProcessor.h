@@ -31,6 +31,7 @@
 
 #include <Hypertable/Master/Context.h>
 #include <Hypertable/Master/Operation.h>
+#include <Hypertable/Master/OperationLatency.h>
 #include <Hypertable/Master/ResponseManager.h>
 
 #include <Common/Properties.h>
@@ -57,6 +58,23 @@ namespace Hypertable {
    */
 
   /** Runs a set of operaions with dependency relationships.
+   * Operations are vertices of a graph in which an edge <i>v</i> &rarr;
+   * <i>u</i> means that <i>v</i> must wait for <i>u</i>.  Edges are derived
+   * from the dependencies, obstructions and exclusivities of the operations.
+   * An operation is <i>ready</i> when it has no outgoing edges, and ready
+   * operations are kept in a FIFO run queue from which the worker threads
+   * pull.  The queue is maintained incrementally: when an operation is
+   * retired or its dependencies change, only the operations that were
+   * waiting on it are re-examined, and adding an edge removes its source
+   * from the queue.  This lets any number of independent operations (for
+   * example the per-range operations of a server recovery) run in parallel
+   * without recomputing a global order on every state change.  As a
+   * safety net, all live operations are re-examined whenever the worker
+   * threads go idle and on wake_up().
+   *
+   * The time each run of an operation spends queued, blocked and executing
+   * is recorded in the OperationLatency histograms of the %Master's
+   * MetricsHandler.
    */
   class OperationProcessor {
   public:
@@ -86,10 +104,6 @@ namespace Hypertable {
       typedef boost::vertex_property_tag kind;
     };
 
-    struct execution_time_t {
-      typedef boost::vertex_property_tag kind;
-    };
-
     struct label_t {
       typedef boost::vertex_property_tag kind;
     };
@@ -106,9 +120,8 @@ namespace Hypertable {
       boost::listS, boost::listS, boost::bidirectionalS,
       boost::property<boost::vertex_index_t, std::size_t,
       boost::property<operation_t, OperationPtr,
-      boost::property<execution_time_t, int,
       boost::property<label_t, String,
-      boost::property<busy_t, bool> > > > >,
+      boost::property<busy_t, bool> > > >,
       boost::property<permanent_t, bool> >
     OperationGraph;
 
@@ -119,14 +132,6 @@ namespace Hypertable {
 
     typedef std::set<Vertex> VertexSet;
 
-    struct vertex_info {
-      vertex_info(Vertex v, bool t) : vertex(v), taken(t) { }
-      vertex_info(Vertex v) : vertex(v), taken(false) { }
-      Vertex vertex;
-      bool taken;
-    };
-    typedef std::list<vertex_info> ExecutionList;
-
     typedef std::multimap<const String, Vertex> DependencyIndex;
 
     void add_dependencies(Vertex v, OperationPtr &operation);
@@ -140,6 +145,7 @@ namespace Hypertable {
     void add_edge_permanent(Vertex v, Vertex u);
 
     /** Retires (remove) an operation.
+     * Schedules the operations that were waiting on it.
      * @param v Vertex of operation
      * @param operation Reference to operation smart pointer
      * @note <code>m_context.mutex</code> must be locked when calling this
@@ -148,23 +154,67 @@ namespace Hypertable {
     void retire_operation(Vertex v, OperationPtr &operation);
 
     /** Updates dependency relationship of an operation.
+     * Rebuilds the edges of the operation, adds its sub-operations, and
+     * schedules it and any operation that was waiting on it.
      * @note <code>m_context.mutex</code> must be locked when calling this
      * method
      */
     void update_operation(Vertex v, OperationPtr &operation);
 
-    /** Recomputes operation execution order.
+    /** Adds an operation to the run queue if it is ready.
+     * An operation is ready if it is live, not running, not waiting to be
+     * unblocked, and has no outgoing edges.
+     * @param v Vertex of operation
      * @note <code>m_context.mutex</code> must be locked when calling this
      * method
      */
-    void recompute_order();
+    void schedule(Vertex v);
 
-    /** Loads <code>m_context.current</code> list with operations to be
-     * executed.
+    /** Schedules an operation that was waiting to be unblocked.
+     * Records the time it spent blocked.
+     * @param v Vertex of operation
      * @note <code>m_context.mutex</code> must be locked when calling this
      * method
      */
-    bool load_current();
+    void schedule_blocked(Vertex v);
+
+    /** Removes next ready operation from the run queue.
+     * Skips queue entries that are no longer valid.
+     * @param v Set to vertex of ready operation
+     * @return <i>true</i> if a ready operation was found, <i>false</i> if
+     * the run queue is empty
+     * @note <code>m_context.mutex</code> must be locked when calling this
+     * method
+     */
+    bool next_ready(Vertex &v);
+
+    /** Schedules any ready operation missing from the run queue.
+     * Fallback for the incremental scheduling done by retire_operation(),
+     * update_operation() and unblock(): re-examines every live operation
+     * and adds the ones that are ready to the run queue.  Called by
+     * wake_up() and by the worker threads when they run out of work.
+     * @return <i>true</i> if an operation was added to the run queue,
+     * <i>false</i> otherwise
+     * @note <code>m_context.mutex</code> must be locked when calling this
+     * method
+     */
+    bool reevaluate();
+
+    /** Assigns consecutive vertex indexes.
+     * Required by boost graphviz output for a graph with a
+     * <code>listS</code> vertex list.
+     * @note <code>m_context.mutex</code> must be locked when calling this
+     * method
+     */
+    void reindex();
+
+    /** Records duration of an operation phase.
+     * @param operation %Operation
+     * @param phase Phase
+     * @param duration Time spent in phase
+     */
+    void record_latency(OperationPtr &operation, OperationLatency::Phase phase,
+                        std::chrono::steady_clock::duration duration);
 
     typedef std::set<OperationPtr> PerpetualSet;
     
@@ -177,6 +227,14 @@ namespace Hypertable {
       Vertex vertex;
     };
 
+    /// Phase timestamps of an operation
+    struct OperationTiming {
+      /// Time at which operation entered the run queue
+      std::chrono::steady_clock::time_point queued;
+      /// Time at which operation reported itself blocked
+      std::chrono::steady_clock::time_point blocked;
+    };
+
     class ThreadContext {
     public:
       ThreadContext(ContextPtr &mctx);
@@ -187,26 +245,27 @@ namespace Hypertable {
       OperationProcessor *op;
       ContextPtr &master_context;
       OperationGraph graph;
-      VertexSet current_active;
       std::unordered_map<int64_t, OperationVertex> operation_hash;
-      size_t current_blocked;
       StringSet exclusive_ops;
       std::set<int64_t> op_ids;
-      ExecutionList current;
-      ExecutionList::iterator current_iter;
-      ExecutionList execution_order;
-      ExecutionList::iterator execution_order_iter;
+      /// Run queue, may hold stale entries for vertices not in #ready
+      std::list<Vertex> run_queue;
+      /// Operations that are ready to run
+      VertexSet ready;
+      /// Operations that reported themselves blocked after their last run
+      VertexSet blocked;
+      /// Phase timestamps of live operations
+      std::map<Vertex, OperationTiming> timing;
       DependencyIndex exclusivity_index;
       DependencyIndex dependency_index;
       DependencyIndex obstruction_index;
       PerpetualSet perpetual_ops;
       size_t busy_count;
-      bool need_order_recompute;
+      bool graph_changed;
       bool shutdown;
       bool paused;
       VertexSet live;
       ResponseManager *response_manager;
-      boost::property_map<OperationGraph, execution_time_t>::type exec_time;
       boost::property_map<OperationGraph, operation_t>::type ops;
       boost::property_map<OperationGraph, label_t>::type label;
       boost::property_map<OperationGraph, busy_t>::type busy;
@@ -221,16 +280,6 @@ namespace Hypertable {
       ThreadContext &m_context;
     };
 
-    struct ltvertexinfo {
-      ltvertexinfo(ThreadContext &context) : m_context(context) { }
-      inline bool operator() (const vertex_info &vi1, const vertex_info &vi2) {
-        if (m_context.exec_time[vi1.vertex] == m_context.exec_time[vi2.vertex])
-          return vi1.taken && !vi2.taken;
-        return m_context.exec_time[vi1.vertex] < m_context.exec_time[vi2.vertex];
-      }
-      ThreadContext &m_context;
-    };
-
     class Worker {
     public:
       Worker(ThreadContext &context) : m_context(context) { return; }
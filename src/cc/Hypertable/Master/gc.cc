@@ -78,6 +78,8 @@ main(int ac, char *av[]) {
 
     GcWorker worker(context);
 
+    // Files found to be obsolete are reaped on the following pass
+    worker.gc();
     worker.gc();
 
   }
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Master/BalanceAlgorithmRangeLoad.h>
+
+#include <Common/Error.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  typedef BalanceAlgorithmRangeLoad::RangeLoad RangeLoad;
+
+  /// Synthetic per-server range loads fed to the planner
+  class LoadFixture {
+  public:
+    void add_server(const string &location) {
+      load[location] = 0;
+      candidates[location];
+    }
+
+    void add_range(const string &location, const string &end_row,
+                   double range_load) {
+      RangeLoad range;
+      range.table_id = "2";
+      range.end_row = end_row;
+      range.load = range_load;
+      load[location] += range_load;
+      candidates[location].push_back(range);
+    }
+
+    void plan(double threshold, int32_t max_moves) {
+      BalanceAlgorithmRangeLoad::plan_moves(load, candidates, disk_full,
+                                            threshold, max_moves, moves,
+                                            hot_ranges);
+    }
+
+    void check_move(size_t i, const char *source, const char *dest,
+                    const char *end_row) {
+      HT_ASSERT(i < moves.size());
+      if (moves[i]->source_location != source ||
+          moves[i]->dest_location != dest ||
+          strcmp(moves[i]->range.end_row, end_row)) {
+        cout << "Unexpected move " << i << ": " << *moves[i] << endl;
+        HT_ASSERT(!"unexpected move");
+      }
+    }
+
+    map<string, double> load;
+    map<string, vector<RangeLoad>> candidates;
+    set<string> disk_full;
+    vector<RangeMoveSpecPtr> moves;
+    vector<RangeLoad> hot_ranges;
+  };
+
+  /// Checks the greedy choice of moves from the most to the least loaded
+  /// server and that planning stops when no move lowers the peak.
+  void test_greedy_moves() {
+    LoadFixture fixture;
+    fixture.add_server("rs3");
+    fixture.add_range("rs1", "a", 30);
+    fixture.add_range("rs1", "b", 25);
+    fixture.add_range("rs1", "c", 20);
+    fixture.add_range("rs1", "d", 15);
+    fixture.add_range("rs1", "e", 10);
+    fixture.add_range("rs2", "f", 20);
+
+    // mean load 40, peak target 44
+    fixture.plan(0.1, 0);
+    HT_ASSERT(fixture.hot_ranges.empty());
+    HT_ASSERT(fixture.moves.size() == 3);
+    fixture.check_move(0, "rs1", "rs3", "a");
+    fixture.check_move(1, "rs1", "rs2", "b");
+    fixture.check_move(2, "rs1", "rs3", "e");
+    HT_ASSERT(fixture.load["rs1"] == 35);
+    HT_ASSERT(fixture.load["rs2"] == 45);
+    HT_ASSERT(fixture.load["rs3"] == 40);
+  }
+
+  /// Checks that <code>max_moves</code> limits the plan.
+  void test_max_moves() {
+    LoadFixture fixture;
+    fixture.add_server("rs3");
+    fixture.add_range("rs1", "a", 30);
+    fixture.add_range("rs1", "b", 25);
+    fixture.add_range("rs1", "c", 20);
+    fixture.add_range("rs2", "d", 20);
+
+    fixture.plan(0.1, 1);
+    HT_ASSERT(fixture.moves.size() == 1);
+    fixture.check_move(0, "rs1", "rs3", "a");
+  }
+
+  /// Checks that a range carrying more than the mean server load is
+  /// reported as a split candidate and never moved.
+  void test_hot_range() {
+    LoadFixture fixture;
+    fixture.add_range("rs1", "hot", 80);
+    fixture.add_range("rs1", "cold", 10);
+    fixture.add_range("rs2", "other", 10);
+
+    fixture.plan(0.1, 0);
+    HT_ASSERT(fixture.hot_ranges.size() == 1);
+    HT_ASSERT(fixture.hot_ranges[0].end_row == "hot");
+    HT_ASSERT(fixture.moves.size() == 1);
+    fixture.check_move(0, "rs1", "rs2", "cold");
+    HT_ASSERT(fixture.load["rs1"] == 80);
+  }
+
+  /// Checks that servers that can't accept ranges are not move targets.
+  void test_disk_full() {
+    LoadFixture fixture;
+    fixture.add_server("rs2");
+    fixture.add_server("rs3");
+    fixture.add_range("rs1", "a", 20);
+    fixture.add_range("rs1", "b", 20);
+    fixture.add_range("rs1", "c", 20);
+    fixture.disk_full.insert("rs2");
+
+    fixture.plan(0.1, 0);
+    HT_ASSERT(fixture.moves.size() == 1);
+    HT_ASSERT(fixture.moves[0]->dest_location == "rs3");
+    HT_ASSERT(fixture.load["rs2"] == 0);
+  }
+
+  /// Checks that no moves are planned when load is within the threshold,
+  /// when there is no load and when there is a single server.
+  void test_no_moves() {
+    {
+      LoadFixture fixture;
+      fixture.add_range("rs1", "a", 10);
+      fixture.add_range("rs2", "b", 10);
+      fixture.plan(0.1, 0);
+      HT_ASSERT(fixture.moves.empty());
+    }
+    {
+      LoadFixture fixture;
+      fixture.add_range("rs1", "a", 0);
+      fixture.add_range("rs1", "b", 0);
+      fixture.add_server("rs2");
+      fixture.plan(0.1, 0);
+      HT_ASSERT(fixture.moves.empty());
+    }
+    {
+      LoadFixture fixture;
+      fixture.add_range("rs1", "a", 10);
+      fixture.add_range("rs1", "b", 20);
+      fixture.plan(0.1, 0);
+      HT_ASSERT(fixture.moves.empty());
+      HT_ASSERT(fixture.hot_ranges.empty());
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  init_with_policy<DefaultPolicy>(argc, argv);
+
+  test_greedy_moves();
+  test_max_moves();
+  test_hot_range();
+  test_disk_full();
+  test_no_moves();
+
+  return 0;
+}
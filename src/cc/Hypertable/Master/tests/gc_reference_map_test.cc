@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/Master/GcReferenceMap.h>
+#include <Hypertable/Master/GcWorker.h>
+
+#include <Common/Error.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  const int NUM_ROWS = 100000;
+  const int FILES_PER_ROW = 20;
+
+  String row_key(int row) {
+    return format("2:row%07d", row);
+  }
+
+  String file_name(int row, int generation, int index) {
+    return format("2/default/range%07d/cs%d_%d", row, generation, index);
+  }
+
+  /// Removal of files of one row fails
+  bool is_failing(const String &name) {
+    return name.find("range0000007/") != String::npos;
+  }
+
+  double seconds_since(chrono::steady_clock::time_point start) {
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return elapsed.count();
+  }
+
+  /// Checks that reap candidates are held back for one pass and that a
+  /// late reference revives a pending file.
+  void test_semantics() {
+    GcReferenceMap references;
+    vector<String> files, reaped;
+
+    references.begin_pass();
+    files = { "a", "b", "#c" };
+    references.set_row("r1", files);
+    files = { "b" };
+    references.set_row("r2", files);
+    HT_ASSERT(references.refcount("b") == 2);
+
+    // r1 compacts, dropping "a" and "b"
+    files = { "d" };
+    references.set_row("r1", files);
+    HT_ASSERT(references.refcount("a") == 0);
+    HT_ASSERT(references.refcount("b") == 1);
+    references.reap_candidates(reaped);
+    HT_ASSERT(reaped.empty());
+
+    // next pass: "a" is reaped, "b" is still referenced by r2
+    references.begin_pass();
+    references.reap_candidates(reaped);
+    HT_ASSERT(reaped.size() == 1 && reaped[0] == "a");
+
+    // r2 drops "b" but a split row picks it up before the next pass
+    reaped.clear();
+    files.clear();
+    references.set_row("r2", files);
+    references.begin_pass();
+    files = { "b" };
+    references.set_row("r3", files);
+    references.reap_candidates(reaped);
+    HT_ASSERT(reaped.empty());
+    HT_ASSERT(references.refcount("b") == 1);
+
+    // a stale file nobody references is reaped one pass later
+    references.add_stale("#c");
+    references.add_stale("e");
+    references.begin_pass();
+    references.reap_candidates(reaped);
+    HT_ASSERT(reaped.size() == 1 && reaped[0] == "e");
+
+    // a rebuild that misses a file makes it pending
+    reaped.clear();
+    references.begin_rebuild();
+    files = { "d" };
+    references.set_row("r1", files);
+    references.end_rebuild();
+    HT_ASSERT(references.refcount("b") == 0);
+    references.begin_pass();
+    references.reap_candidates(reaped);
+    sort(reaped.begin(), reaped.end());
+    HT_ASSERT(reaped.size() == 2 && reaped[0] == "#c" && reaped[1] == "b");
+  }
+
+}
+
+int main(int argc, char **argv) {
+  init_with_policy<DefaultPolicy>(argc, argv);
+
+  test_semantics();
+
+  GcReferenceMap references;
+  vector<String> files;
+
+  // Full scan
+  auto start = chrono::steady_clock::now();
+  references.begin_pass();
+  references.begin_rebuild();
+  for (int row=0; row<NUM_ROWS; row++) {
+    files.clear();
+    for (int i=0; i<FILES_PER_ROW; i++)
+      files.push_back(file_name(row, 0, i));
+    references.set_row(row_key(row), files);
+  }
+  references.end_rebuild();
+  double elapsed = seconds_since(start);
+  HT_ASSERT(references.file_count() == (size_t)NUM_ROWS * FILES_PER_ROW);
+  cout << "full scan: " << (int64_t)(references.file_count() / elapsed)
+       << " file references per second" << endl;
+
+  // Incremental pass: every row compacts half of its files into one
+  start = chrono::steady_clock::now();
+  references.begin_pass();
+  for (int row=0; row<NUM_ROWS; row++) {
+    files.clear();
+    for (int i=FILES_PER_ROW/2; i<FILES_PER_ROW; i++)
+      files.push_back(file_name(row, 0, i));
+    files.push_back(file_name(row, 1, 0));
+    references.set_row(row_key(row), files);
+  }
+  elapsed = seconds_since(start);
+  cout << "incremental: " << (int64_t)(NUM_ROWS / elapsed)
+       << " row updates per second" << endl;
+
+  vector<String> reaped;
+  references.reap_candidates(reaped);
+  HT_ASSERT(reaped.empty());
+  references.begin_pass();
+  references.reap_candidates(reaped);
+  HT_ASSERT(reaped.size() == (size_t)NUM_ROWS * (FILES_PER_ROW / 2));
+  HT_ASSERT(references.refcount(reaped.front()) == 0);
+  HT_ASSERT(references.file_count() ==
+            (size_t)NUM_ROWS * (FILES_PER_ROW / 2 + 1));
+
+  // Parallel removal
+  vector<String> failed;
+  atomic<size_t> removed(0);
+  start = chrono::steady_clock::now();
+  size_t count = GcWorker::remove_files(reaped, 8, 0,
+                                        [&removed](const String &name) {
+                                          if (is_failing(name))
+                                            HT_THROW(Error::FSBROKER_IO_ERROR,
+                                                     name);
+                                          removed++;
+                                        }, failed);
+  elapsed = seconds_since(start);
+  HT_ASSERT(count == removed && count + failed.size() == reaped.size());
+  HT_ASSERT(failed.size() == FILES_PER_ROW / 2);
+  HT_ASSERT(all_of(failed.begin(), failed.end(), is_failing));
+  cout << "remove: " << (int64_t)(reaped.size() / elapsed)
+       << " files per second" << endl;
+
+  // Rate limiting
+  reaped.resize(100);
+  failed.clear();
+  start = chrono::steady_clock::now();
+  count = GcWorker::remove_files(reaped, 8, 1000, [](const String &) { },
+                                 failed);
+  elapsed = seconds_since(start);
+  HT_ASSERT(count == reaped.size() && failed.empty());
+  HT_ASSERT(elapsed >= 0.099);
+
+  return 0;
+}
@@ -39,6 +39,7 @@
 
 #include <chrono>
 #include <iostream>
+#include <map>
 #include <set>
 #include <thread>
 
@@ -441,6 +442,87 @@ int main(int argc, char **argv) {
     context->op->add_operations(operations);
     context->op->wait_for_idle();
 
+    /**
+     *  TEST 6 (retired operations release their waiters in order)
+     */
+
+    /*
+     *  X3 -> X2 -> X1, Y -> X1, Y -> X2
+     */
+
+    results.clear();
+    dependencies.clear();
+    exclusivities.clear();
+    obstructions.clear();
+
+    dependencies.insert("c2");
+    operation = make_shared<OperationTest>(context, results, "X3", dependencies, exclusivities, obstructions);
+    context->op->add_operation(operation);
+
+    dependencies.insert("c1");
+    operation = make_shared<OperationTest>(context, results, "Y", dependencies, exclusivities, obstructions);
+    context->op->add_operation(operation);
+    dependencies.clear();
+
+    dependencies.insert("c1");
+    obstructions.insert("c2");
+    operation = make_shared<OperationTest>(context, results, "X2", dependencies, exclusivities, obstructions);
+    context->op->add_operation(operation);
+    dependencies.clear();
+    obstructions.clear();
+
+    obstructions.insert("c1");
+    operation = make_shared<OperationTest>(context, results, "X1", dependencies, exclusivities, obstructions);
+    context->op->add_operation(operation);
+    obstructions.clear();
+
+    context->op->wait_for_empty();
+
+    {
+      std::map<String, size_t> position;
+      for (size_t i=0; i<results.size(); i++)
+        position[results[i]] = i;
+      HT_ASSERT(position.size() == 8);
+      HT_ASSERT(position["X1"] < position["X2[0]"]);
+      HT_ASSERT(position["X2"] < position["X3[0]"]);
+      HT_ASSERT(position["X1"] < position["Y[0]"]);
+      HT_ASSERT(position["X2"] < position["Y[0]"]);
+    }
+
+    /**
+     *  TEST 7 (blocked obstruction holds its waiters until unblocked)
+     */
+
+    results.clear();
+    operation_foo = make_shared<OperationTest>(context, results, "foo", OperationState::STARTED);
+    operation_bar = make_shared<OperationTest>(context, results, "bar", OperationState::STARTED);
+
+    operation_foo->add_obstruction("gate");
+    operation_bar->add_dependency("gate");
+
+    operation = operation_foo;
+    operation->block();
+    context->op->add_operation(operation);
+
+    operation = operation_bar;
+    context->op->add_operation(operation);
+
+    context->op->wait_for_idle();
+    HT_ASSERT(context->op->size() == 2);
+    HT_ASSERT(results.empty());
+
+    // Waking up while still blocked runs foo again but does not release bar
+    context->op->wake_up();
+    context->op->wait_for_idle();
+    HT_ASSERT(context->op->size() == 2);
+    HT_ASSERT(results.empty());
+
+    context->op->unblock("gate");
+    context->op->wait_for_empty();
+    HT_ASSERT(results.size() == 2);
+    HT_ASSERT(results[0] == "foo");
+    HT_ASSERT(results[1] == "bar");
+
     context->start_shutdown();
   }
   catch (Exception &e) {
@@ -43,6 +43,7 @@
 #include <Common/Error.h>
 #include <Common/FailureInducer.h>
 #include <Common/md5.h>
+#include <Common/Time.h>
 
 #include <algorithm>
 #include <cassert>
@@ -457,6 +458,103 @@ void AccessGroup::load_cellstore(CellStorePtr &cellstore) {
   cellstore->purge_indexes();
 }
 
+void AccessGroup::stage_cellstores(const vector<String> &files,
+                                   StagedCellStores &staged) {
+  CellStorePtr cellstore;
+  String cs_file;
+
+  if (m_in_memory)
+    HT_THROWF(Error::NOT_IMPLEMENTED, "Bulk load into IN_MEMORY access "
+              "group %s", m_full_name.c_str());
+
+  try {
+    for (auto &staged_file : files) {
+      cellstore = CellStoreFactory::open(staged_file, 0, 0);
+      CellStoreTrailer *trailer = cellstore->get_trailer();
+      int32_t table_id = boost::any_cast<uint32_t>(trailer->get("table_id"));
+      if (table_id != m_identifier.index())
+        HT_THROWF(Error::RANGESERVER_UNEXPECTED_TABLE_ID,
+                  "CellStore %s belongs to table %d, not %s",
+                  staged_file.c_str(), (int)table_id, m_identifier.id);
+      int64_t revision = boost::any_cast<int64_t>(trailer->get("revision"));
+      if (revision > get_ts64())
+        HT_THROWF(Error::RANGESERVER_CLOCK_SKEW,
+                  "CellStore %s revision %lld is in the future",
+                  staged_file.c_str(), (Lld)revision);
+      cellstore = 0;
+
+      {
+        lock_guard<mutex> lock(m_mutex);
+        cs_file = format("%s/tables/%s/%s/%s/cs%d",
+                         Global::toplevel_dir.c_str(),
+                         m_identifier.id, m_name.c_str(),
+                         m_range_dir.c_str(),
+                         m_next_cs_id++);
+      }
+      Global::dfs->rename(staged_file, cs_file);
+      staged.staged_files.push_back(staged_file);
+      staged.installed_files.push_back(cs_file);
+      staged.cellstores.push_back(CellStoreFactory::open(cs_file,
+                                                         m_start_row.c_str(),
+                                                         m_end_row.c_str()));
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << m_full_name << " " << e << HT_END;
+    unstage_cellstores(staged);
+    throw;
+  }
+}
+
+void AccessGroup::unstage_cellstores(StagedCellStores &staged) {
+  // Hand the files back so the load can be retried
+  staged.cellstores.clear();
+  for (size_t i=0; i<staged.installed_files.size(); i++) {
+    try {
+      Global::dfs->rename(staged.installed_files[i], staged.staged_files[i]);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << "Problem restoring " << staged.staged_files[i] << " "
+                   << e << HT_END;
+    }
+  }
+  staged.staged_files.clear();
+  staged.installed_files.clear();
+}
+
+void AccessGroup::attach_cellstores(StagedCellStores &staged, Hints *hints) {
+  vector<CellStorePtr> &cellstores = staged.cellstores;
+  vector<String> removed_files;
+
+  int64_t total_index_entries = 0;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    for (auto &cs : cellstores) {
+      int64_t revision = boost::any_cast<int64_t>
+        (cs->get_trailer()->get("revision"));
+      if (revision > m_latest_stored_revision)
+        m_latest_stored_revision = revision;
+      m_stores.push_back(cs);
+    }
+    sort_cellstores_by_timestamp();
+    get_merge_info(m_needs_merging, m_end_merge);
+    m_garbage_tracker.update_cellstore_info(m_stores, time(0), false);
+    recompute_compression_ratio(&total_index_entries);
+  }
+
+  for (auto &cs : cellstores) {
+    m_file_tracker.update_live(cs->get_filename(), removed_files,
+                               m_next_cs_id, total_index_entries);
+    cs->purge_indexes();
+  }
+  m_file_tracker.update_files_column();
+
+  HT_INFOF("Attached %d bulk loaded CellStore(s) to %s",
+           (int)cellstores.size(), m_full_name.c_str());
+
+  load_hints(hints);
+}
+
 void AccessGroup::measure_garbage(double *total, double *garbage) {
   ScanContextPtr scan_ctx = make_shared<ScanContext>(m_schema);
   MergeScannerAccessGroupPtr mscanner 
@@ -666,6 +764,12 @@ void AccessGroup::run_compaction(int maintenance_flags, Hints *hints) {
       }
     }
 
+    // Compression dictionaries are only trained for major compactions
+    if (major) {
+      cellstore_props = make_shared<Properties>(*cellstore_props);
+      cellstore_props->set("major-compaction", true);
+    }
+
     cellstore->create(cs_file.c_str(), max_num_entries, cellstore_props, &m_identifier);
 
     if (mscanner) {
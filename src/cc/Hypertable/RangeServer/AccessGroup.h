@@ -132,6 +132,17 @@ namespace Hypertable {
       String files;
     };
 
+    /// Bulk loaded CellStores moved into place but not yet attached
+    class StagedCellStores {
+    public:
+      /// Pathnames the files were staged under
+      std::vector<String> staged_files;
+      /// Pathnames of the files in the range directory
+      std::vector<String> installed_files;
+      /// CellStores opened on #installed_files
+      std::vector<CellStorePtr> cellstores;
+    };
+
     AccessGroup(const TableIdentifier *identifier, SchemaPtr &schema,
                 AccessGroupSpec *ag_spec, const RangeSpec *range,
                 const Hints *hints=nullptr);
@@ -175,6 +186,32 @@ namespace Hypertable {
 
     void load_cellstore(CellStorePtr &cellstore);
 
+    /// Moves bulk loaded CellStores into place.
+    /// Validates each staged file, renames it into this access group's
+    /// range directory as the next <code>cs</code><i>N</i> and opens it.
+    /// Nothing visible to scans or to the METADATA table is changed, so
+    /// the step can be undone with unstage_cellstores().  If an exception
+    /// is thrown, the files already moved are renamed back first.
+    /// @param files Pathnames of staged CellStore files
+    /// @param staged Receives the moved files and opened CellStores
+    void stage_cellstores(const std::vector<String> &files,
+                          StagedCellStores &staged);
+
+    /// Moves files set up by stage_cellstores() back where they came from.
+    /// @param staged Files to move back; cleared on return
+    void unstage_cellstores(StagedCellStores &staged);
+
+    /// Attaches CellStores set up by stage_cellstores().
+    /// Adds them to the set of CellStores and records them in the METADATA
+    /// <i>Files</i> column.  The cell cache must have been compacted
+    /// immediately beforehand so that no cached cell carries a revision
+    /// older than the revisions assigned to the bulk loaded cells; otherwise
+    /// those cells would be skipped on commit log replay because
+    /// #m_latest_stored_revision would be advanced past them.
+    /// @param staged CellStores to attach
+    /// @param hints Hints object populated with new state
+    void attach_cellstores(StagedCellStores &staged, Hints *hints);
+
     void pre_load_cellstores() {
       std::lock_guard<std::mutex> lock(m_mutex);
       m_latest_stored_revision = TIMESTAMP_MIN;
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for AdmissionControl.
+/// This file contains method definitions for AdmissionControl, a class used
+/// to limit the number and size of client requests queued or running in the
+/// range server.
+
+#include <Common/Compat.h>
+
+#include "AdmissionControl.h"
+
+#include <Hypertable/Lib/RangeServer/Protocol.h>
+
+using namespace Hypertable;
+using namespace std;
+
+AdmissionControl::AdmissionControl(PropertiesPtr &props) {
+  m_enabled = props->get_bool("Hypertable.RangeServer.Admission.Enable");
+  m_max_requests[READ] =
+    props->get_i32("Hypertable.RangeServer.Admission.MaxRequests.Read");
+  m_max_requests[UPDATE] =
+    props->get_i32("Hypertable.RangeServer.Admission.MaxRequests.Update");
+  m_max_update_bytes =
+    props->get_i64("Hypertable.RangeServer.Admission.MaxBytes.Update");
+  for (int i=0; i<CLASS_COUNT; i++) {
+    m_requests[i] = 0;
+    m_rejected[i] = 0;
+  }
+}
+
+AdmissionControl::Class AdmissionControl::classify(const EventPtr &event) {
+  if (event->header.flags & CommHeader::FLAGS_BIT_URGENT)
+    return SYSTEM;
+  switch (event->header.command) {
+  case Lib::RangeServer::Protocol::COMMAND_CREATE_SCANNER:
+    return READ;
+  case Lib::RangeServer::Protocol::COMMAND_UPDATE:
+    return UPDATE;
+  case Lib::RangeServer::Protocol::COMMAND_FETCH_SCANBLOCK:
+    return SCAN;
+  default:
+    break;
+  }
+  return OTHER;
+}
+
+bool AdmissionControl::admit(Class cls, size_t bytes) {
+  int64_t requests = ++m_requests[cls];
+  if (!m_enabled)
+    return true;
+  if (m_max_requests[cls] && requests > m_max_requests[cls]) {
+    m_requests[cls]--;
+    m_rejected[cls]++;
+    return false;
+  }
+  if (cls == UPDATE) {
+    int64_t update_bytes = (m_update_bytes += bytes);
+    // A single update larger than the limit is admitted when no other
+    // update is in, otherwise it would never be
+    if (m_max_update_bytes && update_bytes > m_max_update_bytes &&
+        update_bytes > (int64_t)bytes) {
+      m_update_bytes -= bytes;
+      m_requests[cls]--;
+      m_rejected[cls]++;
+      return false;
+    }
+  }
+  return true;
+}
+
+void AdmissionControl::release(Class cls) {
+  m_requests[cls]--;
+}
+
+void AdmissionControl::release_update_bytes(size_t bytes) {
+  if (m_enabled)
+    m_update_bytes -= bytes;
+}
+
+void AdmissionControl::publish(MetricsCollector *collector,
+                               double period_seconds) {
+  if (period_seconds <= 0.0)
+    return;
+  collector->update("requestsRejected.read",
+                    (float)m_rejected[READ].exchange(0) / period_seconds);
+  collector->update("requestsRejected.update",
+                    (float)m_rejected[UPDATE].exchange(0) / period_seconds);
+}
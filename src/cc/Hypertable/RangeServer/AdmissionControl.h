@@ -0,0 +1,169 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for AdmissionControl.
+/// This file contains type declarations for AdmissionControl, a class used to
+/// limit the number and size of client requests queued or running in the
+/// range server.
+
+#ifndef Hypertable_RangeServer_AdmissionControl_h
+#define Hypertable_RangeServer_AdmissionControl_h
+
+#include <AsyncComm/Event.h>
+
+#include <Common/MetricsCollector.h>
+#include <Common/Properties.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Admission control of client requests.
+  /// Incoming requests are put into one of the classes of #Class, in order
+  /// of decreasing priority.  Requests of the READ and UPDATE classes are
+  /// admitted against a limit on the number of requests of the class that are
+  /// queued or running, and updates also against a limit on their total
+  /// payload size.  Requests that would exceed a limit are rejected with
+  /// Error::RANGESERVER_OVERLOADED, which clients retry after a back-off,
+  /// instead of piling up in the application queue.  SYSTEM requests are
+  /// never rejected.  SCAN requests are not rejected either, since that would
+  /// abort the scan, but are carried out at low priority by the application
+  /// queue.
+  class AdmissionControl {
+  public:
+
+    /// Request class.
+    enum Class {
+      SYSTEM = 0, //!< Urgent requests, including all requests on system tables
+      READ,       //!< Create scanner requests
+      UPDATE,     //!< Update requests
+      SCAN,       //!< Fetch scanblock requests of ongoing scans
+      OTHER,      //!< All other requests
+      CLASS_COUNT //!< Number of classes
+    };
+
+    /// Constructor.
+    /// Reads the <code>Hypertable.RangeServer.Admission</code> properties.
+    /// @param props Configuration properties
+    AdmissionControl(PropertiesPtr &props);
+
+    /// Returns class of request.
+    /// @param event MESSAGE event of request
+    /// @return Class of request
+    static Class classify(const EventPtr &event);
+
+    /// Holds the payload bytes of an admitted update.
+    /// The bytes are released when the object is destroyed.  The object is
+    /// passed along with the update into the update pipeline, which holds it
+    /// until the update has been committed and answered, so that updates are
+    /// limited by the memory they hold rather than by how long their request
+    /// handlers run.
+    class UpdateBytes {
+    public:
+      /// Constructor.
+      /// @param admission_control Admission control that admitted the update
+      /// @param bytes Payload size of update
+      UpdateBytes(AdmissionControl *admission_control, size_t bytes)
+        : m_admission_control(admission_control), m_bytes(bytes) { }
+
+      /// Destructor.
+      /// Releases the bytes with release_update_bytes().
+      ~UpdateBytes() { m_admission_control->release_update_bytes(m_bytes); }
+
+      UpdateBytes(const UpdateBytes &) = delete;
+      UpdateBytes &operator=(const UpdateBytes &) = delete;
+
+    private:
+      /// Admission control that admitted the update
+      AdmissionControl *m_admission_control;
+      /// Payload size of update
+      size_t m_bytes;
+    };
+
+    /// Smart pointer to UpdateBytes
+    typedef std::shared_ptr<UpdateBytes> UpdateBytesPtr;
+
+    /// Admits request.
+    /// If the request is admitted, release() must be called with the same
+    /// class once the request has been carried out or dropped.  The payload
+    /// bytes of an admitted UPDATE request must be held by an UpdateBytes
+    /// object until the update has been committed.
+    /// @param cls Class of request
+    /// @param bytes Payload size of request
+    /// @return <i>true</i> if request is admitted, <i>false</i> if it is to be
+    /// rejected with Error::RANGESERVER_OVERLOADED
+    bool admit(Class cls, size_t bytes);
+
+    /// Releases admitted request.
+    /// Payload bytes of updates are released separately by UpdateBytes.
+    /// @param cls Class of request
+    void release(Class cls);
+
+    /// Releases payload bytes of admitted update.
+    /// Called by the UpdateBytes destructor.
+    /// @param bytes Payload size of update
+    void release_update_bytes(size_t bytes);
+
+    /// Publishes admission metrics.
+    /// Publishes the rate of rejected requests of the READ and UPDATE classes
+    /// since the last call as <code>requestsRejected.read</code> and
+    /// <code>requestsRejected.update</code>.
+    /// @param collector Metrics collector
+    /// @param period_seconds Seconds since last call
+    void publish(MetricsCollector *collector, double period_seconds);
+
+  private:
+
+    /// Set to <i>true</i> if requests may be rejected
+    bool m_enabled {};
+
+    /// Maximum number of queued or running requests per class, 0 for no limit
+    std::array<int64_t, CLASS_COUNT> m_max_requests {};
+
+    /// Maximum payload bytes of updates that are queued, running or being
+    /// committed, 0 for no limit
+    int64_t m_max_update_bytes {};
+
+    /// Number of queued or running requests per class
+    std::array<std::atomic<int64_t>, CLASS_COUNT> m_requests;
+
+    /// Payload bytes of updates that are queued, running or being committed
+    std::atomic<int64_t> m_update_bytes {};
+
+    /// Number of rejected requests per class since last publish()
+    std::array<std::atomic<uint64_t>, CLASS_COUNT> m_rejected;
+  };
+
+  /// Smart pointer to AdmissionControl
+  typedef std::shared_ptr<AdmissionControl> AdmissionControlPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_AdmissionControl_h
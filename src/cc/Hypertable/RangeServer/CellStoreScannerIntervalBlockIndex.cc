@@ -34,17 +34,40 @@
 
 #include <Hypertable/Lib/BlockHeaderCellStore.h>
 
+#include <AsyncComm/Clock.h>
 #include <AsyncComm/DispatchHandlerSynchronizer.h>
 #include <AsyncComm/Event.h>
 #include <AsyncComm/Protocol.h>
 
 #include <Common/Error.h>
+#include <Common/RequestTrace.h>
 #include <Common/System.h>
 
 #include <cassert>
+#include <chrono>
 #include <utility>
 
 using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  inline int64_t elapsed_us(ClockT::time_point start) {
+    return chrono::duration_cast<chrono::microseconds>(ClockT::now() - start).count();
+  }
+
+  /// Checks out a block from the block cache, timing the lookup.
+  bool checkout_block(int file_id, uint64_t offset, uint8_t **blockp,
+                      uint32_t *lengthp) {
+    ClockT::time_point start = ClockT::now();
+    bool found = Global::block_cache->checkout(file_id, offset, blockp, lengthp);
+    if (Global::latency_metrics)
+      Global::latency_metrics->record(LatencyMetrics::BLOCK_CACHE_LOOKUP,
+                                      elapsed_us(start));
+    return found;
+  }
+
+}
 
 template <typename IndexT>
 CellStoreScannerIntervalBlockIndex<IndexT>::CellStoreScannerIntervalBlockIndex(CellStorePtr &cellstore,
@@ -225,8 +248,8 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
      * Cache lookup / block read
      */
     if (Global::block_cache == 0 || Global::block_cache->compressed() ||
-        !Global::block_cache->checkout(m_file_id, m_block.offset,
-				       (uint8_t **)&m_block.base, &len)) {
+        !checkout_block(m_file_id, m_block.offset,
+                        (uint8_t **)&m_block.base, &len)) {
       bool second_try {};
       bool checked_out {};
 
@@ -236,15 +259,20 @@ bool CellStoreScannerIntervalBlockIndex<IndexT>::fetch_next_block(bool eob) {
         EventPtr event;
 
 	if (Global::block_cache == 0 || !Global::block_cache->compressed() ||
-            !Global::block_cache->checkout(m_file_id, m_block.offset,
-				           (uint8_t **)&buf.base, &len)) {
+            !checkout_block(m_file_id, m_block.offset,
+                            (uint8_t **)&buf.base, &len)) {
 
 	  /** Read compressed block **/
           DispatchHandlerSynchronizer sync_handler;
+          RequestTrace::Span span(RequestTrace::BLOCK_READ);
+          ClockT::time_point read_start = ClockT::now();
 	  Global::dfs->pread(m_fd, m_block.zlength, m_block.offset, second_try, &sync_handler);
           if (!sync_handler.wait_for_reply(event))
             HT_THROW(Protocol::response_code(event.get()),
                      Protocol::string_format_message(event).c_str());
+          if (Global::latency_metrics)
+            Global::latency_metrics->record(LatencyMetrics::BLOCK_READ,
+                                            elapsed_us(read_start));
           {
             uint32_t length;
             uint64_t off;
@@ -221,6 +221,8 @@ void CellStoreTrailerV7::display(std::ostream &os) {
     os << " 64BIT_INDEX";
   if (flags & MAJOR_COMPACTION)
     os << " MAJOR_COMPACTION";
+  if (flags & COMPRESSION_DICTIONARY)
+    os << " COMPRESSION_DICTIONARY";
   os << " )";
   os << ", alignment=" << alignment;
   os << ", compression_ratio=" << compression_ratio;
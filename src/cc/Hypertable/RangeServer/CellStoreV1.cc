@@ -79,7 +79,7 @@ CellStoreV1::~CellStoreV1() {
   }
 
   if (m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory > 0)
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
 }
 
@@ -246,7 +246,7 @@ void CellStoreV1::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = m_bloom_filter->size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -259,7 +259,7 @@ uint64_t CellStoreV1::purge_indexes() {
     memory_purged = m_index_stats.bloom_filter_memory;
     delete m_bloom_filter;
     m_bloom_filter = 0;
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
     m_index_stats.bloom_filter_memory = 0;
   }
 
@@ -269,7 +269,7 @@ uint64_t CellStoreV1::purge_indexes() {
       m_index_map64.clear();
     else
       m_index_map32.clear();
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     m_index_stats.block_index_memory = 0;
   }
 
@@ -526,7 +526,7 @@ void CellStoreV1::finalize(TableIdentifier *table_identifier) {
   if (m_bloom_filter)
     m_index_stats.bloom_filter_memory = m_bloom_filter->size();
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
 }
 
 
@@ -705,7 +705,7 @@ void CellStoreV1::load_block_index() {
                 << HT_END;
 
   m_index_stats.block_index_memory = sizeof(CellStoreV1) + m_index_map32.memory_used();
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
   m_index_builder.release_fixed_buf();
 
@@ -80,7 +80,7 @@ CellStoreV2::~CellStoreV2() {
   }
 
   if (m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory > 0)
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
 }
 
@@ -273,7 +273,7 @@ void CellStoreV2::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = m_bloom_filter->size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -286,7 +286,7 @@ uint64_t CellStoreV2::purge_indexes() {
     memory_purged = m_index_stats.bloom_filter_memory;
     delete m_bloom_filter;
     m_bloom_filter = 0;
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
     m_index_stats.bloom_filter_memory = 0;
   }
 
@@ -296,7 +296,7 @@ uint64_t CellStoreV2::purge_indexes() {
       m_index_map64.clear();
     else
       m_index_map32.clear();
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     m_index_stats.block_index_memory = 0;
   }
 
@@ -558,7 +558,7 @@ void CellStoreV2::finalize(TableIdentifier *table_identifier) {
   if (m_bloom_filter)
     m_index_stats.bloom_filter_memory = m_bloom_filter->size();
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
 }
 
 
@@ -736,7 +736,7 @@ void CellStoreV2::load_block_index() {
                 << HT_END;
 
   m_index_stats.block_index_memory = sizeof(CellStoreV2) + m_index_map32.memory_used();
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
   m_index_builder.release_fixed_buf();
 
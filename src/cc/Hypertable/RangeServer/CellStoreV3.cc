@@ -83,7 +83,7 @@ CellStoreV3::~CellStoreV3() {
   }
 
   if (m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory > 0)
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
 }
 
@@ -297,7 +297,7 @@ void CellStoreV3::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = m_bloom_filter->size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -310,7 +310,7 @@ uint64_t CellStoreV3::purge_indexes() {
     memory_purged = m_index_stats.bloom_filter_memory;
     delete m_bloom_filter;
     m_bloom_filter = 0;
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
     m_index_stats.bloom_filter_memory = 0;
   }
 
@@ -320,7 +320,7 @@ uint64_t CellStoreV3::purge_indexes() {
       m_index_map64.clear();
     else
       m_index_map32.clear();
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     m_index_stats.block_index_memory = 0;
   }
 
@@ -599,7 +599,7 @@ void CellStoreV3::finalize(TableIdentifier *table_identifier) {
   delete [] m_column_ttl;
   m_column_ttl = 0;
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
 }
 
 
@@ -781,7 +781,7 @@ void CellStoreV3::load_block_index() {
                 << HT_END;
 
   m_index_stats.block_index_memory = sizeof(CellStoreV3) + m_index_map32.memory_used();
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
   m_index_builder.release_fixed_buf();
 
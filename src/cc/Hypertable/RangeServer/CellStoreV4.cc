@@ -84,7 +84,7 @@ CellStoreV4::~CellStoreV4() {
   }
 
   if (m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory > 0)
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
 }
 
@@ -296,7 +296,7 @@ void CellStoreV4::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = m_bloom_filter->total_size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -309,7 +309,7 @@ uint64_t CellStoreV4::purge_indexes() {
     memory_purged = m_index_stats.bloom_filter_memory;
     delete m_bloom_filter;
     m_bloom_filter = 0;
-    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory );
+    Global::memory_tracker->subtract( m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
     m_index_stats.bloom_filter_memory = 0;
   }
 
@@ -319,7 +319,7 @@ uint64_t CellStoreV4::purge_indexes() {
       m_index_map64.clear();
     else
       m_index_map32.clear();
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     m_index_stats.block_index_memory = 0;
   }
 
@@ -622,7 +622,7 @@ void CellStoreV4::finalize(TableIdentifier *table_identifier) {
   delete [] m_column_ttl;
   m_column_ttl = 0;
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
 }
 
 
@@ -805,7 +805,7 @@ void CellStoreV4::load_block_index() {
   }
 
   m_index_stats.block_index_memory = sizeof(CellStoreV4) + m_index_map32.memory_used();
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
   m_index_builder.release_fixed_buf();
 
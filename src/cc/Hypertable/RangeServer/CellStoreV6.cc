@@ -91,7 +91,7 @@ CellStoreV6::~CellStoreV6() {
     HT_ERROR_OUT << e << HT_END;
   }
 
-  Global::memory_tracker->subtract( sizeof(CellStoreV6) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+  Global::memory_tracker->subtract( sizeof(CellStoreV6) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 
 }
 
@@ -407,7 +407,7 @@ void CellStoreV6::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = sizeof(BloomFilterWithChecksum) + m_bloom_filter->total_size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -436,7 +436,7 @@ uint64_t CellStoreV6::purge_indexes() {
     }
   }
 
-  Global::memory_tracker->subtract( memory_purged );
+  Global::memory_tracker->subtract( memory_purged, MemoryTracker::CELLSTORE );
 
   return memory_purged;
 }
@@ -797,7 +797,7 @@ void CellStoreV6::finalize(TableIdentifier *table_identifier) {
   delete [] m_column_ttl;
   m_column_ttl = 0;
 
-  Global::memory_tracker->add( sizeof(CellStoreV6) + sizeof(CellStoreInfo) + m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( sizeof(CellStoreV6) + sizeof(CellStoreInfo) + m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE );
 }
 
 
@@ -890,7 +890,7 @@ CellStoreV6::open(const String &fname, const String &start_row,
   // This is necessary to get m_disk_usage and m_block_count set properly
   load_block_index();
 
-  Global::memory_tracker->add( sizeof(CellStoreV6) + sizeof(CellStoreInfo) );
+  Global::memory_tracker->add( sizeof(CellStoreV6) + sizeof(CellStoreInfo), MemoryTracker::CELLSTORE );
 
 }
 
@@ -904,7 +904,7 @@ CellStoreV6::rescope(const String &start_row, const String &end_row) {
   m_end_row = end_row;
   m_restricted_range = true;
   if (m_index_stats.block_index_memory != 0) {
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     if (m_64bit_index) {
       m_index_map64.rescope(m_start_row, m_end_row);
       m_index_stats.block_index_memory = m_index_map64.memory_used();
@@ -921,7 +921,7 @@ CellStoreV6::rescope(const String &start_row, const String &end_row) {
 		  m_index_map32.fraction_covered());
       m_block_count = m_index_map32.index_entries();
     }
-    Global::memory_tracker->add( m_index_stats.block_index_memory );
+    Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
   }
   else
     load_block_index();
@@ -1023,7 +1023,7 @@ void CellStoreV6::load_block_index() {
 
   m_index_builder.release_fixed_buf();
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 }
 
 
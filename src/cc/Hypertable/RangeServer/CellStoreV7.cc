@@ -31,9 +31,11 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/scoped_array.hpp>
 
+#include "Common/Checksum.h"
 #include "Common/Config.h"
 #include "Common/Error.h"
 #include "Common/Logger.h"
+#include "Common/Serialization.h"
 #include "Common/System.h"
 #include "Common/StringCompressorPrefix.h"
 #include "Common/StringDecompressorPrefix.h"
@@ -61,8 +63,17 @@ using namespace std;
 using namespace Hypertable;
 
 namespace {
-  const uint32_t MAX_APPENDS_OUTSTANDING = 3;
   const uint16_t BLOCK_HEADER_VERSION = 1;
+
+  /// Size of the samples dictionary training is given
+  const size_t DICTIONARY_SAMPLE_SIZE = 4096;
+
+  void swap_buffers(DynamicBuffer &a, DynamicBuffer &b) {
+    std::swap(a.base, b.base);
+    std::swap(a.ptr, b.ptr);
+    std::swap(a.size, b.size);
+    std::swap(a.own, b.own);
+  }
 }
 
 
@@ -79,6 +90,14 @@ CellStoreV7::CellStoreV7(Filesystem *filesys, SchemaPtr &schema)
 }
 
 CellStoreV7::~CellStoreV7() {
+  if (m_write_thread.joinable()) {
+    {
+      lock_guard<mutex> lock(m_write_mutex);
+      m_write_shutdown = true;
+      m_write_cond.notify_all();
+    }
+    m_write_thread.join();
+  }
   try {
     delete m_compressor;
     delete m_bloom_filter;
@@ -91,14 +110,17 @@ CellStoreV7::~CellStoreV7() {
     HT_ERROR_OUT << e << HT_END;
   }
 
-  Global::memory_tracker->subtract( sizeof(CellStoreV7) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory );
+  Global::memory_tracker->subtract( sizeof(CellStoreV7) + sizeof(CellStoreInfo) + m_index_stats.bloom_filter_memory + m_index_stats.block_index_memory + m_dictionary_memory, MemoryTracker::CELLSTORE );
 
 }
 
 
 BlockCompressionCodec *CellStoreV7::create_block_compression_codec() {
-  return CompressorFactory::create_block_codec(
+  BlockCompressionCodec *codec = CompressorFactory::create_block_codec(
       (BlockCompressionCodec::Type)m_trailer.compression_type);
+  if (m_dictionary)
+    codec->set_dictionary(m_dictionary);
+  return codec;
 }
 
 KeyDecompressor *CellStoreV7::create_key_decompressor() {
@@ -240,9 +262,30 @@ CellStoreV7::create(const char *fname, size_t max_entries,
       (BlockCompressionCodec::Type)m_trailer.compression_type,
       m_compressor_args);
 
+  m_dictionary.reset();
+  m_dictionary_pending = m_compressor->get_dictionary_size() > 0 &&
+    props->get_bool("major-compaction", false);
+  m_dictionary_training_size = Config::get_i32("Hypertable.RangeServer"
+      ".CellStore.Dictionary.TrainingSize");
+
+  m_sample_size = Config::get_i32("Hypertable.RangeServer.CellStore"
+                                  ".AdaptiveCompression.SampleSize");
+  m_sample_threshold = Config::get_f64("Hypertable.RangeServer.CellStore"
+                                       ".AdaptiveCompression.Threshold");
+  m_last_block_incompressible = false;
+  m_compression_stats = CompressionStats();
+
+  m_max_outstanding_appends = std::max(1, Config::get_i32("Hypertable."
+      "RangeServer.CellStore.WriteBehind.MaxOutstandingAppends"));
+  m_write_queue_depth = std::max(0, Config::get_i32("Hypertable.RangeServer"
+      ".CellStore.WriteBehind.QueueDepth"));
+
   uint32_t oflags = Filesystem::OPEN_FLAG_DIRECTIO|Filesystem::OPEN_FLAG_OVERWRITE;
   m_fd = m_filesys->create(m_filename, oflags, -1, replication, -1);
 
+  if (m_write_queue_depth)
+    m_write_thread = std::thread(&CellStoreV7::write_behind_loop, this);
+
   m_bloom_filter_mode = props->get<BloomFilterMode>("bloom-filter-mode");
   m_max_approx_items = props->get_i32("max-approx-items");
 
@@ -407,7 +450,7 @@ void CellStoreV7::load_bloom_filter() {
   }
 
   m_index_stats.bloom_filter_memory = sizeof(BloomFilterWithChecksum) + m_bloom_filter->total_size();
-  Global::memory_tracker->add(m_index_stats.bloom_filter_memory);
+  Global::memory_tracker->add(m_index_stats.bloom_filter_memory, MemoryTracker::CELLSTORE);
 
 }
 
@@ -436,7 +479,7 @@ uint64_t CellStoreV7::purge_indexes() {
     }
   }
 
-  Global::memory_tracker->subtract( memory_purged );
+  Global::memory_tracker->subtract( memory_purged, MemoryTracker::CELLSTORE );
 
   return memory_purged;
 }
@@ -444,9 +487,6 @@ uint64_t CellStoreV7::purge_indexes() {
 
 
 void CellStoreV7::add(const Key &key, const ByteString value) {
-  EventPtr event_ptr;
-  DynamicBuffer zbuf;
-
   if (key.revision > m_trailer.revision)
     m_trailer.revision = key.revision;
 
@@ -458,46 +498,23 @@ void CellStoreV7::add(const Key &key, const ByteString value) {
   }
 
   if (m_buffer.fill() > (size_t)m_uncompressed_blocksize) {
-    BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
 
-    m_index_builder.add_entry(m_key_compressor, m_offset);
+    m_index_builder.add_key(m_key_compressor);
 
-    m_uncompressed_data += (float)m_buffer.fill();
-    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
-    m_compressed_data += (float)zbuf.fill();
-    m_buffer.clear();
-
-    uint64_t llval = ((uint64_t)m_trailer.blocksize
-        * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
-    m_uncompressed_blocksize = (int64_t)llval;
-
-    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
-      if (!m_sync_handler.wait_for_reply(event_ptr)) {
-        if (event_ptr->type == Event::MESSAGE)
-          HT_THROWF(Hypertable::Protocol::response_code(event_ptr),
-             "Problem writing to FS file '%s' : %s", m_filename.c_str(),
-             Hypertable::Protocol::string_format_message(event_ptr).c_str());
-        HT_THROWF(event_ptr->error,
-                  "Problem writing to FS file '%s'", m_filename.c_str());
+    if (m_dictionary_pending)
+      hold_block();
+    else
+      flush_buffer();
+
+    {
+      lock_guard<mutex> lock(m_write_mutex);
+      if (m_compressed_data > 0) {
+        uint64_t llval = ((uint64_t)m_trailer.blocksize
+            * (uint64_t)m_uncompressed_data) / (uint64_t)m_compressed_data;
+        m_uncompressed_blocksize = (int64_t)llval;
       }
-      m_outstanding_appends--;
-    }
-
-    if (!HT_IO_ALIGNED(zbuf.fill())) {
-      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
-      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
     }
 
-    size_t zlen = zbuf.fill();
-    StaticBuffer send_buf(zbuf);
-
-    try { m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler); }
-    catch (Exception &e) {
-      HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
-                 m_filename.c_str());
-    }
-    m_outstanding_appends++;
-    m_offset += zlen;
     m_key_compressor->reset();
   }
 
@@ -554,48 +571,350 @@ void CellStoreV7::add(const Key &key, const ByteString value) {
 }
 
 
-void CellStoreV7::finalize(TableIdentifier *table_identifier) {
+void CellStoreV7::compress_block(DynamicBuffer &input,
+                                 BlockHeaderCellStore &header,
+                                 DynamicBuffer &zbuf) {
+
+  if (m_trailer.compression_type == BlockCompressionCodec::NONE) {
+    m_compressor->deflate(input, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+    return;
+  }
+
+  if (m_last_block_incompressible && m_sample_size > 0 &&
+      input.fill() > 2 * (size_t)m_sample_size) {
+    BlockHeaderCellStore sample_header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
+    DynamicBuffer sample(0, false);
+    sample.base = input.base;
+    sample.ptr = input.base + m_sample_size;
+    sample.size = m_sample_size;
+    m_compressor->deflate(sample, m_sample_buffer, sample_header);
+    sample.base = sample.ptr = 0;
+    if (sample_header.get_compression_type() == BlockCompressionCodec::NONE ||
+        sample_header.get_data_zlength() >
+        m_sample_threshold * sample_header.get_data_length()) {
+      m_none_compressor.deflate(input, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+      m_compression_stats.blocks_stored_raw++;
+      m_compression_stats.bytes_stored_raw += input.fill();
+      return;
+    }
+  }
+
+  m_compressor->deflate(input, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+
+  if (header.get_compression_type() == BlockCompressionCodec::NONE) {
+    m_compression_stats.blocks_stored_raw++;
+    m_compression_stats.bytes_stored_raw += input.fill();
+  }
+  else {
+    m_compression_stats.blocks_compressed++;
+    m_compression_stats.bytes_saved +=
+      (int64_t)header.get_data_length() - (int64_t)header.get_data_zlength();
+  }
+
+  m_last_block_incompressible =
+    header.get_compression_type() == BlockCompressionCodec::NONE ||
+    header.get_data_zlength() > m_sample_threshold * header.get_data_length();
+}
+
+
+void CellStoreV7::write_block(DynamicBuffer &input) {
+  BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
+  DynamicBuffer zbuf;
   EventPtr event_ptr;
-  size_t zlen;
-  DynamicBuffer zbuf(0);
-  SerializedKey key;
-  StaticBuffer send_buf;
-  int64_t index_memory = 0;
 
-  if (m_buffer.fill() > 0) {
-    BlockHeaderCellStore header(BLOCK_HEADER_VERSION, DATA_BLOCK_MAGIC);
+  m_index_builder.add_offset(m_offset);
 
-    m_index_builder.add_entry(m_key_compressor, m_offset);
+  compress_block(input, header, zbuf);
 
-    m_uncompressed_data += (float)m_buffer.fill();
-    m_compressor->deflate(m_buffer, zbuf, header, HT_DIRECT_IO_ALIGNMENT);
+  {
+    lock_guard<mutex> lock(m_write_mutex);
+    m_uncompressed_data += (float)input.fill();
     m_compressed_data += (float)zbuf.fill();
+  }
 
-    if (!HT_IO_ALIGNED(zbuf.fill())) {
-      memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
-      zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+  if (m_outstanding_appends >= m_max_outstanding_appends) {
+    if (!m_sync_handler.wait_for_reply(event_ptr)) {
+      if (event_ptr->type == Event::MESSAGE)
+        HT_THROWF(Hypertable::Protocol::response_code(event_ptr),
+           "Problem writing to FS file '%s' : %s", m_filename.c_str(),
+           Hypertable::Protocol::string_format_message(event_ptr).c_str());
+      HT_THROWF(event_ptr->error,
+                "Problem writing to FS file '%s'", m_filename.c_str());
     }
-    zlen = zbuf.fill();
-    send_buf = zbuf;
+    m_outstanding_appends--;
+  }
+
+  if (!HT_IO_ALIGNED(zbuf.fill())) {
+    memset(zbuf.ptr, 0, HT_IO_ALIGNMENT_PADDING(zbuf.fill()));
+    zbuf.ptr += HT_IO_ALIGNMENT_PADDING(zbuf.fill());
+  }
 
-    if (m_outstanding_appends >= MAX_APPENDS_OUTSTANDING) {
-      if (!m_sync_handler.wait_for_reply(event_ptr))
-        HT_THROWF(Protocol::response_code(event_ptr),
-                  "Problem finalizing CellStore file '%s' : %s",
-                  m_filename.c_str(),
-                  Protocol::string_format_message(event_ptr).c_str());
-      m_outstanding_appends--;
+  size_t zlen = zbuf.fill();
+  StaticBuffer send_buf(zbuf);
+
+  try { m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler); }
+  catch (Exception &e) {
+    HT_THROW2F(e.code(), e, "Problem writing to FS file '%s'",
+               m_filename.c_str());
+  }
+  m_outstanding_appends++;
+  m_offset += zlen;
+}
+
+
+void CellStoreV7::flush_buffer() {
+  if (m_write_thread.joinable())
+    enqueue_block();
+  else {
+    write_block(m_buffer);
+    m_buffer.clear();
+  }
+}
+
+
+void CellStoreV7::hold_block() {
+  std::unique_ptr<DynamicBuffer> block(new DynamicBuffer());
+  swap_buffers(*block, m_buffer);
+  m_buffer.reserve(block->size);
+  m_dictionary_block_bytes += block->fill();
+  m_dictionary_blocks.push_back(std::move(block));
+  if (m_dictionary_block_bytes >= (size_t)m_dictionary_training_size)
+    train_dictionary();
+}
+
+
+void CellStoreV7::train_dictionary() {
+  HT_ASSERT(m_buffer.fill() == 0);
+
+  DynamicBuffer samples(m_dictionary_block_bytes);
+  std::vector<size_t> sizes;
+  for (auto &block : m_dictionary_blocks) {
+    for (size_t off=0; off < block->fill(); off += DICTIONARY_SAMPLE_SIZE) {
+      size_t len = std::min(DICTIONARY_SAMPLE_SIZE, block->fill() - off);
+      samples.add_unchecked(block->base + off, len);
+      sizes.push_back(len);
     }
+  }
 
-    m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+  m_dictionary = m_compressor->train_dictionary(samples.base, sizes);
+  samples.free();
+  if (m_dictionary) {
+    m_compressor->set_dictionary(m_dictionary);
+    HT_INFOF("Trained %u byte %s dictionary from %u blocks for CellStore %s",
+             (unsigned)m_dictionary->size(),
+             BlockCompressionCodec::get_compressor_name(m_trailer.compression_type),
+             (unsigned)m_dictionary_blocks.size(), m_filename.c_str());
+  }
+  m_dictionary_pending = false;
 
-    m_outstanding_appends++;
-    m_offset += zlen;
+  // Write the held blocks in order, leaving m_buffer empty
+  for (auto &block : m_dictionary_blocks) {
+    swap_buffers(*block, m_buffer);
+    block->free();
+    flush_buffer();
+  }
+  m_dictionary_blocks.clear();
+  m_dictionary_block_bytes = 0;
+}
+
+
+void CellStoreV7::write_dictionary() {
+  size_t length = m_dictionary->size() + 8;
+  size_t padding = HT_IO_ALIGNMENT_PADDING(length);
+  DynamicBuffer buf(length + padding);
+
+  memset(buf.ptr, 0, padding);
+  buf.ptr += padding;
+  buf.add_unchecked(m_dictionary->data(), m_dictionary->size());
+  Serialization::encode_i32(&buf.ptr, m_dictionary->size());
+  Serialization::encode_i32(&buf.ptr, fletcher32(m_dictionary->data(),
+                                                 m_dictionary->size()));
+
+  size_t zlen = buf.fill();
+  StaticBuffer send_buf(buf);
+  m_filesys->append(m_fd, send_buf, Filesystem::Flags::NONE, &m_sync_handler);
+  m_outstanding_appends++;
+  m_offset += zlen;
+}
+
+
+void CellStoreV7::load_dictionary() {
+  int64_t end = m_trailer.replaced_files_offset;
+  int64_t amount = HT_DIRECT_IO_ALIGNMENT;
+
+  if (end - amount < m_trailer.filter_offset)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE, "Bad compression "
+              "dictionary offset in CellStore '%s'", m_filename.c_str());
+
+  DynamicBuffer buf(amount);
+  if (m_filesys->pread(m_fd, buf.base, amount, end - amount, false) !=
+      (size_t)amount)
+    HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading compression dictionary "
+              "for CellStore '%s'", m_filename.c_str());
+
+  const uint8_t *ptr = buf.base + amount - 8;
+  size_t remaining = 8;
+  uint32_t length = Serialization::decode_i32(&ptr, &remaining);
+  uint32_t checksum = Serialization::decode_i32(&ptr, &remaining);
+
+  int64_t total = length + 8 + HT_IO_ALIGNMENT_PADDING(length + 8);
+  if (length == 0 || end - total < m_trailer.filter_offset)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE, "Bad compression "
+              "dictionary length %u in CellStore '%s'", (unsigned)length,
+              m_filename.c_str());
+
+  if (total > amount) {
+    buf.reserve(total);
+    if (m_filesys->pread(m_fd, buf.base, total, end - total, false) !=
+        (size_t)total)
+      HT_THROWF(Error::FSBROKER_IO_ERROR, "Error loading compression "
+                "dictionary for CellStore '%s'", m_filename.c_str());
+    amount = total;
+  }
+
+  const char *dictionary = (const char *)buf.base + amount - 8 - length;
+  if (fletcher32(dictionary, length) != checksum)
+    HT_THROWF(Error::RANGESERVER_CORRUPT_CELLSTORE, "Compression dictionary "
+              "checksum mismatch in CellStore '%s'", m_filename.c_str());
+
+  m_bytes_read += total;
+  m_dictionary = make_shared<const String>(dictionary, length);
+  m_dictionary_memory = length;
+  Global::memory_tracker->add(m_dictionary_memory, MemoryTracker::CELLSTORE);
+}
+
+
+void CellStoreV7::enqueue_block() {
+  unique_lock<mutex> lock(m_write_mutex);
+
+  m_write_cond.wait(lock, [this](){
+      return m_write_queue.size() < m_write_queue_depth || m_write_error; });
+
+  if (m_write_error)
+    HT_THROW(m_write_error, m_write_error_msg);
+
+  std::unique_ptr<DynamicBuffer> block;
+  if (m_write_free_list.empty())
+    block.reset(new DynamicBuffer());
+  else {
+    block = std::move(m_write_free_list.back());
+    m_write_free_list.pop_back();
+  }
+
+  // Hand off the filled buffer and continue filling the recycled one
+  swap_buffers(*block, m_buffer);
+  m_buffer.clear();
+  m_buffer.reserve(block->size);
+  m_write_queue.push_back(std::move(block));
+  m_write_cond.notify_all();
+}
+
+
+void CellStoreV7::drain_write_behind() {
+  unique_lock<mutex> lock(m_write_mutex);
+
+  m_write_cond.wait(lock, [this](){
+      return (m_write_queue.empty() && !m_write_busy) || m_write_error; });
+
+  m_write_shutdown = true;
+  m_write_cond.notify_all();
+  lock.unlock();
+
+  m_write_thread.join();
+  m_write_free_list.clear();
+
+  if (m_write_error)
+    HT_THROW(m_write_error, m_write_error_msg);
+}
+
+
+void CellStoreV7::write_behind_loop() {
+  unique_lock<mutex> lock(m_write_mutex);
+
+  while (true) {
+
+    m_write_cond.wait(lock, [this](){
+        return !m_write_queue.empty() || m_write_shutdown; });
+
+    if (m_write_shutdown)
+      break;
+
+    std::unique_ptr<DynamicBuffer> block = std::move(m_write_queue.front());
+    m_write_queue.pop_front();
+    m_write_busy = true;
+    lock.unlock();
+
+    int error = Error::OK;
+    String error_msg;
+    try {
+      write_block(*block);
+    }
+    catch (Exception &e) {
+      HT_ERROR_OUT << e << HT_END;
+      error = e.code();
+      error_msg = e.what();
+    }
+
+    block->clear();
+
+    lock.lock();
+    m_write_busy = false;
+    if (error != Error::OK) {
+      m_write_error = error;
+      m_write_error_msg = error_msg;
+      m_write_queue.clear();
+    }
+    else
+      m_write_free_list.push_back(std::move(block));
+    m_write_cond.notify_all();
+    if (m_write_error)
+      break;
   }
+}
+
+
+void CellStoreV7::finalize(TableIdentifier *table_identifier) {
+  EventPtr event_ptr;
+  size_t zlen;
+  DynamicBuffer zbuf(0);
+  SerializedKey key;
+  StaticBuffer send_buf;
+  int64_t index_memory = 0;
+
+  if (m_buffer.fill() > 0) {
+    m_index_builder.add_key(m_key_compressor);
+    if (m_dictionary_pending)
+      hold_block();
+    else
+      flush_buffer();
+  }
+
+  // Fewer than Dictionary.TrainingSize bytes were added
+  if (m_dictionary_pending)
+    train_dictionary();
+
+  if (m_write_thread.joinable())
+    drain_write_behind();
 
   m_key_compressor = 0;
 
   m_buffer.free();
+  m_sample_buffer.free();
+
+  if (m_compression_stats.blocks_stored_raw)
+    HT_INFOF("CellStore %s stored %u of %u blocks uncompressed (incompressible "
+             "with %s)", m_filename.c_str(),
+             m_compression_stats.blocks_stored_raw,
+             m_compression_stats.blocks_stored_raw +
+             m_compression_stats.blocks_compressed,
+             BlockCompressionCodec::get_compressor_name(m_trailer.compression_type));
+
+  if (Global::load_statistics)
+    Global::load_statistics->add_compression_data(
+      m_compression_stats.blocks_compressed,
+      m_compression_stats.blocks_stored_raw,
+      m_compression_stats.bytes_stored_raw,
+      m_compression_stats.bytes_saved);
 
   m_trailer.fix_index_offset = m_offset;
   if (m_uncompressed_data == 0)
@@ -678,6 +997,13 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
     }
   }
 
+  // Write compression dictionary, which ends where replaced files begin
+  if (m_dictionary) {
+    write_dictionary();
+    m_trailer.flags |= CellStoreTrailerV7::COMPRESSION_DICTIONARY;
+    m_dictionary_memory = m_dictionary->size();
+  }
+
   // Write compressed replaced_file lists
   // Coalesce with trailer block if possible
   zbuf.clear();
@@ -799,12 +1125,19 @@ void CellStoreV7::finalize(TableIdentifier *table_identifier) {
   delete [] m_column_ttl;
   m_column_ttl = 0;
 
-  Global::memory_tracker->add( sizeof(CellStoreV7) + sizeof(CellStoreInfo) + m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory );
+  Global::memory_tracker->add( sizeof(CellStoreV7) + sizeof(CellStoreInfo) + m_index_stats.block_index_memory + m_index_stats.bloom_filter_memory + m_dictionary_memory, MemoryTracker::CELLSTORE );
+}
+
+
+void CellStoreV7::IndexBuilder::add_key(KeyCompressorPtr &key_compressor) {
+  size_t key_len = key_compressor->length_uncompressed();
+  m_variable.ensure(key_len);
+  key_compressor->write_uncompressed(m_variable.ptr);
+  m_variable.ptr += key_len;
 }
 
 
-void CellStoreV7::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
-                                          int64_t offset) {
+void CellStoreV7::IndexBuilder::add_offset(int64_t offset) {
 
   // switch to 64-bit offsets if offset being added is >= 2^32
   if (!m_bigint && offset >= 4294967296LL) {
@@ -823,13 +1156,7 @@ void CellStoreV7::IndexBuilder::add_entry(KeyCompressorPtr &key_compressor,
     m_bigint = true;
   }
 
-  // Add key to variable buffer
-  size_t key_len = key_compressor->length_uncompressed();
-  m_variable.ensure(key_len);
-  key_compressor->write_uncompressed(m_variable.ptr);
-  m_variable.ptr += key_len;
-
-    // Serialize offset into fix index buffer
+  // Serialize offset into fix index buffer
   if (m_bigint) {
     m_fixed.ensure(8);
     memcpy(m_fixed.ptr, &offset, 8);
@@ -889,10 +1216,14 @@ CellStoreV7::open(const String &fname, const String &start_row,
               "length=%llu, file='%s'", (unsigned)m_fd, (Lld)m_trailer.fix_index_offset,
            (Lld)m_trailer.var_index_offset, (Llu)m_file_length, fname.c_str());
 
+  // Index blocks are compressed with the dictionary as well
+  if (m_trailer.flags & CellStoreTrailerV7::COMPRESSION_DICTIONARY)
+    load_dictionary();
+
   // This is necessary to get m_disk_usage and m_block_count set properly
   load_block_index();
 
-  Global::memory_tracker->add( sizeof(CellStoreV7) + sizeof(CellStoreInfo) );
+  Global::memory_tracker->add( sizeof(CellStoreV7) + sizeof(CellStoreInfo), MemoryTracker::CELLSTORE );
 
 }
 
@@ -906,7 +1237,7 @@ CellStoreV7::rescope(const String &start_row, const String &end_row) {
   m_end_row = end_row;
   m_restricted_range = true;
   if (m_index_stats.block_index_memory != 0) {
-    Global::memory_tracker->subtract( m_index_stats.block_index_memory );
+    Global::memory_tracker->subtract( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
     if (m_64bit_index) {
       m_index_map64.rescope(m_start_row, m_end_row);
       m_index_stats.block_index_memory = m_index_map64.memory_used();
@@ -923,7 +1254,7 @@ CellStoreV7::rescope(const String &start_row, const String &end_row) {
 		  m_index_map32.fraction_covered());
       m_block_count = m_index_map32.index_entries();
     }
-    Global::memory_tracker->add( m_index_stats.block_index_memory );
+    Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
   }
   else
     load_block_index();
@@ -1025,7 +1356,7 @@ void CellStoreV7::load_block_index() {
 
   m_index_builder.release_fixed_buf();
 
-  Global::memory_tracker->add( m_index_stats.block_index_memory );
+  Global::memory_tracker->add( m_index_stats.block_index_memory, MemoryTracker::CELLSTORE );
 }
 
 
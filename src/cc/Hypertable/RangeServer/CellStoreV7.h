@@ -34,6 +34,8 @@
 #include "KeyCompressor.h"
 
 #include <Hypertable/Lib/BlockCompressionCodec.h>
+#include <Hypertable/Lib/BlockCompressionCodecNone.h>
+#include <Hypertable/Lib/BlockHeaderCellStore.h>
 #include <Hypertable/Lib/SerializedKey.h>
 
 #include <AsyncComm/DispatchHandlerSynchronizer.h>
@@ -42,8 +44,13 @@
 #include <Common/BloomFilterWithChecksum.h>
 #include <Common/DynamicBuffer.h>
 
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace Hypertable {
@@ -63,7 +70,12 @@ namespace Hypertable {
     class IndexBuilder {
     public:
       IndexBuilder() : m_bigint(false) { }
-      void add_entry(KeyCompressorPtr &key_compressor, int64_t offset);
+      void add_entry(KeyCompressorPtr &key_compressor, int64_t offset) {
+        add_key(key_compressor);
+        add_offset(offset);
+      }
+      void add_key(KeyCompressorPtr &key_compressor);
+      void add_offset(int64_t offset);
       DynamicBuffer &fixed_buf() { return m_fixed; }
       DynamicBuffer &variable_buf() { return m_variable; }
       bool big_int() { return m_bigint; }
@@ -76,6 +88,22 @@ namespace Hypertable {
     };
 
   public:
+
+    /** Adaptive compression decisions made while writing a cell store.
+     * Only blocks of cell stores created with a compressor other than
+     * <code>none</code> are counted.
+     */
+    struct CompressionStats {
+      /// Number of data blocks written with the access group codec
+      uint32_t blocks_compressed {};
+      /// Number of data blocks written uncompressed
+      uint32_t blocks_stored_raw {};
+      /// Uncompressed bytes of data blocks written uncompressed
+      uint64_t bytes_stored_raw {};
+      /// Bytes saved by compressing the compressed data blocks
+      int64_t bytes_saved {};
+    };
+
     CellStoreV7(Filesystem *filesys);
     CellStoreV7(Filesystem *filesys, SchemaPtr &schema);
     virtual ~CellStoreV7();
@@ -92,6 +120,15 @@ namespace Hypertable {
     bool may_contain(ScanContext *scan_ctx) override;
     uint64_t disk_usage() override { return m_disk_usage; }
     float compression_ratio() override { return m_trailer.compression_ratio; }
+
+    /** Gets adaptive compression statistics.
+     * @return Compression decisions for the data blocks written by create(),
+     * add() and finalize()
+     */
+    const CompressionStats &get_compression_stats() const {
+      return m_compression_stats;
+    }
+
     void split_row_estimate_data(SplitRowDataMapT &split_row_data) override;
 
     /** Populates <code>scanner</code> with key/value pairs generated from
@@ -156,6 +193,85 @@ namespace Hypertable {
     void load_block_index();
     void load_replaced_files();
 
+    /** Loads compression dictionary into #m_dictionary.
+     * The dictionary is stored immediately before the replaced files list as
+     * zero padding, the dictionary, its length and its fletcher32 checksum.
+     * @throws Exception with code Error::RANGESERVER_CORRUPT_CELLSTORE if the
+     * dictionary length or checksum is invalid
+     */
+    void load_dictionary();
+
+    /** Appends #m_dictionary to the cell store file.
+     * @see load_dictionary() for a description of the format
+     */
+    void write_dictionary();
+
+    /** Compresses an uncompressed block into a data block.
+     * If the previous block turned out to be incompressible, the first
+     * #m_sample_size bytes of <code>input</code> are trial compressed with
+     * #m_compressor and if the sample does not shrink below
+     * #m_sample_threshold of its size, the block is stored uncompressed
+     * with #m_none_compressor, avoiding the cost of compressing the whole
+     * block.  Blocks stored this way carry compression type
+     * BlockCompressionCodec::NONE in their header which every codec is
+     * able to inflate.
+     * @param input Uncompressed block
+     * @param header Block header populated by function
+     * @param zbuf Output buffer to hold serialized block
+     */
+    void compress_block(DynamicBuffer &input, BlockHeaderCellStore &header,
+                        DynamicBuffer &zbuf);
+
+    /** Compresses and appends a data block.
+     * Compresses <code>input</code> with compress_block(), records the
+     * block offset in the index, waits for an append to complete if
+     * #m_max_outstanding_appends appends are already in flight, and then
+     * issues an asynchronous append of the block.  The index key for the
+     * block must already have been added with IndexBuilder::add_key().
+     * @param input Uncompressed block
+     */
+    void write_block(DynamicBuffer &input);
+
+    /** Hands #m_buffer off to the write-behind thread.
+     * Swaps the contents of #m_buffer into a recycled buffer, appends it to
+     * #m_write_queue, and leaves #m_buffer empty.  Blocks while the queue
+     * holds #m_write_queue_depth buffers.
+     * @throws Exception if the write-behind thread encountered an error
+     */
+    void enqueue_block();
+
+    /** Compresses and appends #m_buffer, or hands it to the write-behind
+     * thread if there is one, leaving #m_buffer empty.
+     */
+    void flush_buffer();
+
+    /** Holds #m_buffer back until a compression dictionary is trained.
+     * Moves #m_buffer onto #m_dictionary_blocks and calls train_dictionary()
+     * once #m_dictionary_training_size bytes have been held.  Index keys for
+     * held blocks are added as usual; their offsets are added when they are
+     * written.
+     */
+    void hold_block();
+
+    /** Trains a compression dictionary from the held blocks.
+     * Cuts #m_dictionary_blocks into samples, has #m_compressor train a
+     * dictionary from them and installs it, and then writes the held blocks
+     * in order.  If training fails, the blocks are compressed without a
+     * dictionary.
+     */
+    void train_dictionary();
+
+    /** Waits for the write-behind thread to drain #m_write_queue and then
+     * stops it.  After this call returns, all data blocks have been
+     * handed to the filesystem and the writing thread owns #m_offset,
+     * #m_index_builder and #m_sync_handler again.
+     * @throws Exception if the write-behind thread encountered an error
+     */
+    void drain_write_behind();
+
+    /// Write-behind thread function
+    void write_behind_loop();
+
     typedef BlobHashSet<> BloomFilterItems;
 
     Filesystem *m_filesys;
@@ -175,7 +291,53 @@ namespace Hypertable {
     int m_file_id {};
     float m_uncompressed_data {};
     float m_compressed_data {};
+    /// Codec for blocks that are stored uncompressed
+    BlockCompressionCodecNone m_none_compressor {BlockCompressionCodec::Args()};
+    /// Output buffer for trial compression of block samples
+    DynamicBuffer m_sample_buffer;
+    /// Number of leading block bytes to trial compress (0 disables)
+    int32_t m_sample_size {};
+    /// Maximum sample compression ratio for a block to be compressed
+    double m_sample_threshold {};
+    /// Flag indicating that the previous block did not compress well
+    bool m_last_block_incompressible {};
+    /// Adaptive compression decisions for the blocks written so far
+    CompressionStats m_compression_stats;
     int64_t m_uncompressed_blocksize {};
+    /// Dictionary blocks are compressed with (empty if none)
+    BlockCompressionCodec::DictionaryPtr m_dictionary;
+    /// Memory used by #m_dictionary
+    int64_t m_dictionary_memory {};
+    /// Flag indicating blocks are held back until a dictionary is trained
+    bool m_dictionary_pending {};
+    /// Blocks held back for dictionary training
+    std::vector<std::unique_ptr<DynamicBuffer>> m_dictionary_blocks;
+    /// Number of bytes in #m_dictionary_blocks
+    size_t m_dictionary_block_bytes {};
+    /// Amount of data to hold back for dictionary training
+    int32_t m_dictionary_training_size {};
+    /// Maximum number of appends in flight
+    uint32_t m_max_outstanding_appends {};
+    /// Thread compressing and appending queued blocks
+    std::thread m_write_thread;
+    /// %Mutex protecting write-behind state and compression statistics
+    std::mutex m_write_mutex;
+    /// Signals changes to #m_write_queue and #m_write_busy
+    std::condition_variable m_write_cond;
+    /// Filled blocks waiting to be compressed and appended
+    std::deque<std::unique_ptr<DynamicBuffer>> m_write_queue;
+    /// Emptied blocks available for reuse by enqueue_block()
+    std::vector<std::unique_ptr<DynamicBuffer>> m_write_free_list;
+    /// Maximum number of blocks in #m_write_queue (0 disables write-behind)
+    size_t m_write_queue_depth {};
+    /// Flag indicating write-behind thread is processing a block
+    bool m_write_busy {};
+    /// Flag telling write-behind thread to exit
+    bool m_write_shutdown {};
+    /// Error encountered by write-behind thread
+    int m_write_error {};
+    /// Message for #m_write_error
+    std::string m_write_error_msg;
     BlockCompressionCodec::Args m_compressor_args;
     size_t m_max_entries {};
     BloomFilterMode m_bloom_filter_mode {BLOOM_FILTER_DISABLED};
@@ -23,8 +23,11 @@
 
 #include "ConnectionHandler.h"
 
+#include <Hypertable/RangeServer/Global.h>
 #include <Hypertable/RangeServer/RangeServer.h>
 #include <Hypertable/RangeServer/Request/Handler/AcknowledgeLoad.h>
+#include <Hypertable/RangeServer/Request/Handler/Admitted.h>
+#include <Hypertable/RangeServer/Request/Handler/AttachCellStores.h>
 #include <Hypertable/RangeServer/Request/Handler/CommitLogSync.h>
 #include <Hypertable/RangeServer/Request/Handler/Compact.h>
 #include <Hypertable/RangeServer/Request/Handler/CreateScanner.h>
@@ -42,6 +45,7 @@
 #include <Hypertable/RangeServer/Request/Handler/PhantomLoad.h>
 #include <Hypertable/RangeServer/Request/Handler/PhantomPrepareRanges.h>
 #include <Hypertable/RangeServer/Request/Handler/PhantomUpdate.h>
+#include <Hypertable/RangeServer/Request/Handler/Profile.h>
 #include <Hypertable/RangeServer/Request/Handler/RelinquishRange.h>
 #include <Hypertable/RangeServer/Request/Handler/ReplayFragments.h>
 #include <Hypertable/RangeServer/Request/Handler/SetState.h>
@@ -77,6 +81,7 @@ void ConnectionHandler::handle(EventPtr &event) {
 
   if (event->type == Event::MESSAGE) {
     ApplicationHandler *handler = 0;
+    Request::Handler::Update *update_handler = 0;
 
     //event->display();
 
@@ -96,13 +101,18 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new Request::Handler::Compact(m_comm, m_range_server,
                                             event);
         break;
+      case Lib::RangeServer::Protocol::COMMAND_ATTACH_CELLSTORES:
+        handler = new Request::Handler::AttachCellStores(m_comm, m_range_server,
+                                                     event);
+        break;
       case Lib::RangeServer::Protocol::COMMAND_LOAD_RANGE:
         handler = new Request::Handler::LoadRange(m_comm, m_range_server,
                                               event);
         break;
       case Lib::RangeServer::Protocol::COMMAND_UPDATE:
-        handler = new Request::Handler::Update(m_comm, m_range_server,
-                                           event);
+        update_handler = new Request::Handler::Update(m_comm, m_range_server,
+                                                      event);
+        handler = update_handler;
         break;
       case Lib::RangeServer::Protocol::COMMAND_CREATE_SCANNER:
         handler = new Request::Handler::CreateScanner(m_comm,
@@ -115,6 +125,8 @@ void ConnectionHandler::handle(EventPtr &event) {
       case Lib::RangeServer::Protocol::COMMAND_FETCH_SCANBLOCK:
         handler = new Request::Handler::FetchScanblock(m_comm,
             m_range_server, event);
+        // Keep long scans from starving point reads and updates
+        handler->set_low_priority(true);
         break;
       case Lib::RangeServer::Protocol::COMMAND_DROP_TABLE:
         handler = new Request::Handler::DropTable(m_comm, m_range_server,
@@ -160,6 +172,10 @@ void ConnectionHandler::handle(EventPtr &event) {
         handler = new Request::Handler::Heapcheck(m_comm, m_range_server,
                                               event);
         break;
+      case Lib::RangeServer::Protocol::COMMAND_PROFILE:
+        handler = new Request::Handler::Profile(m_comm, m_range_server,
+                                                event);
+        break;
       case Lib::RangeServer::Protocol::COMMAND_COMMIT_LOG_SYNC:
         handler = new Request::Handler::CommitLogSync(m_comm, m_range_server, event);
         break;
@@ -210,6 +226,28 @@ void ConnectionHandler::handle(EventPtr &event) {
         HT_THROWF(Error::PROTOCOL_ERROR, "Unimplemented command (%llu)",
                   (Llu)event->header.command);
       }
+
+      if (Global::admission_control) {
+        AdmissionControl::Class cls = AdmissionControl::classify(event);
+        if (!Global::admission_control->admit(cls, event->payload_len)) {
+          delete handler;
+          if ((event->header.flags & CommHeader::FLAGS_BIT_IGNORE_RESPONSE) == 0) {
+            ResponseCallback cb(m_comm, event);
+            cb.error(Error::RANGESERVER_OVERLOADED, "Request not admitted");
+          }
+          return;
+        }
+        // Update bytes stay admitted until the update pipeline has committed
+        // and answered the update
+        if (cls == AdmissionControl::UPDATE)
+          update_handler->set_admitted_bytes(
+            std::make_shared<AdmissionControl::UpdateBytes>(
+              Global::admission_control.get(), event->payload_len));
+        handler = new Request::Handler::Admitted(event, handler,
+                                                 Global::admission_control.get(),
+                                                 cls, Global::memory_tracker);
+      }
+
       m_app_queue->add(handler);
     }
     catch (Exception &e) {
@@ -36,20 +36,20 @@ using namespace std;
 using namespace Hypertable;
 
 FragmentData::~FragmentData() {
-  Global::memory_tracker->subtract(m_memory_consumption);
+  Global::memory_tracker->subtract(m_memory_consumption, MemoryTracker::REPLAY);
 }
 
 void FragmentData::add(EventPtr &event) {
   m_data.push_back(event);
   int64_t memory_added = sizeof(Event) + event->payload_len;
-  Global::memory_tracker->add(memory_added);
+  Global::memory_tracker->add(memory_added, MemoryTracker::REPLAY);
   m_memory_consumption += memory_added;
   return;
 }
 
 void FragmentData::clear() {
   m_data.clear();
-  Global::memory_tracker->subtract(m_memory_consumption);
+  Global::memory_tracker->subtract(m_memory_consumption, MemoryTracker::REPLAY);
   m_memory_consumption = 0;
 }
 
@@ -34,7 +34,10 @@ namespace Hypertable {
   FilesystemPtr          Global::dfs;
   FilesystemPtr          Global::log_dfs;
   ApplicationQueuePtr    Global::app_queue;
+  AdmissionControlPtr    Global::admission_control;
+  LatencyMetricsPtr      Global::latency_metrics;
   MaintenanceQueuePtr    Global::maintenance_queue;
+  IndexUpdateQueuePtr    Global::index_update_queue;
   Lib::Master::ClientPtr        Global::master_client;
   RangeLocatorPtr        Global::range_locator = 0;
   PseudoTables          *Global::pseudo_tables = 0;
@@ -54,6 +57,8 @@ namespace Hypertable {
   LocationInitializerPtr Global::location_initializer;
   int64_t                Global::range_split_size = 0;
   int64_t                Global::range_maximum_size = 0;
+  int32_t                Global::range_hot_split_rate = 0;
+  int64_t                Global::range_hot_split_minimum_size = 0;
   int32_t                Global::failover_timeout = 0;
   int32_t                Global::access_group_garbage_compaction_threshold = 0;
   int32_t                Global::access_group_max_mem = 0;
@@ -42,7 +42,10 @@
 #include "Hypertable/Lib/RangeSpec.h"
 #include "Hypertable/Lib/TableIdentifier.h"
 
+#include "AdmissionControl.h"
 #include "FileBlockCache.h"
+#include "IndexUpdateQueue.h"
+#include "LatencyMetrics.h"
 #include "LoadStatistics.h"
 #include "LocationInitializer.h"
 #include "MaintenanceQueue.h"
@@ -64,7 +67,10 @@ namespace Hypertable {
     static Hypertable::FilesystemPtr dfs;
     static Hypertable::FilesystemPtr log_dfs;
     static Hypertable::ApplicationQueuePtr app_queue;
+    static AdmissionControlPtr admission_control;
+    static LatencyMetricsPtr latency_metrics;
     static Hypertable::MaintenanceQueuePtr maintenance_queue;
+    static IndexUpdateQueuePtr index_update_queue;
     static Hypertable::Lib::Master::ClientPtr master_client;
     static Hypertable::RangeLocatorPtr range_locator;
     static Hypertable::PseudoTables *pseudo_tables;
@@ -83,6 +89,8 @@ namespace Hypertable {
     static LocationInitializerPtr location_initializer;
     static int64_t        range_split_size;
     static int64_t        range_maximum_size;
+    static int32_t        range_hot_split_rate;
+    static int64_t        range_hot_split_minimum_size;
     static int32_t        failover_timeout;
     static int32_t        access_group_garbage_compaction_threshold;
     static int32_t        access_group_max_mem;
@@ -41,7 +41,8 @@ GroupCommit::GroupCommit(Apps::RangeServer *range_server) : m_range_server(range
 void
 GroupCommit::add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
                  const TableIdentifier &table, uint32_t count,
-                 StaticBuffer &buffer, uint32_t flags) {
+                 StaticBuffer &buffer, uint32_t flags,
+                 AdmissionControl::UpdateBytesPtr &admitted_bytes) {
   lock_guard<mutex> lock(m_mutex);
   UpdateRequest *request = new UpdateRequest();
   auto expire_time = event->deadline();
@@ -52,6 +53,7 @@ GroupCommit::add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
   request->buffer = buffer;
   request->count = count;
   request->event = event;
+  request->admitted_bytes = admitted_bytes;
 
   auto iter = m_table_map.find(key);
   if (iter == m_table_map.end()) {
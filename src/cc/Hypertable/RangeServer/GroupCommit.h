@@ -67,7 +67,8 @@ namespace Hypertable {
     GroupCommit(Apps::RangeServer *range_server);
     virtual void add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
                      const TableIdentifier &table, uint32_t count,
-                     StaticBuffer &buffer, uint32_t flags);
+                     StaticBuffer &buffer, uint32_t flags,
+                     AdmissionControl::UpdateBytesPtr &admitted_bytes);
     virtual void trigger();
 
   private:
@@ -27,6 +27,8 @@
 #ifndef Hypertable_RangeServer_GroupCommitInterface_h
 #define Hypertable_RangeServer_GroupCommitInterface_h
 
+#include <Hypertable/RangeServer/AdmissionControl.h>
+
 #include <Hypertable/Lib/Schema.h>
 #include <Hypertable/Lib/TableIdentifier.h>
 
@@ -54,9 +56,12 @@ namespace Hypertable {
   public:
 
     /// Adds a batch of updates to the group commit queue.
+    /// <code>admitted_bytes</code> is held until the updates have been
+    /// committed.
     virtual void add(EventPtr &event, uint64_t cluster_id, SchemaPtr &schema,
                      const TableIdentifier &table, uint32_t count,
-                     StaticBuffer &buffer, uint32_t flags) = 0;
+                     StaticBuffer &buffer, uint32_t flags,
+                     AdmissionControl::UpdateBytesPtr &admitted_bytes) = 0;
 
     /// Processes queued updates that are ready to be committed.
     virtual void trigger() = 0;
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for HotSpotDetector.
+/// This file contains the definitions for HotSpotDetector, a class that
+/// detects ranges that should be split because of their access rate.
+
+#include <Common/Compat.h>
+
+#include "HotSpotDetector.h"
+
+#include <algorithm>
+
+using namespace Hypertable;
+using namespace std;
+
+void HotSpotDetector::record_access(const char *row) {
+  if ((m_access_count++ % SAMPLE_INTERVAL) != 0)
+    return;
+  if (m_sample.size() < SAMPLE_SIZE)
+    m_sample.push_back(row);
+  else {
+    m_sample[m_sample_next] = row;
+    m_sample_next = (m_sample_next + 1) % m_sample.size();
+  }
+}
+
+
+bool HotSpotDetector::is_hot(uint64_t ops, time_t now, double threshold,
+                             double *ratep) {
+  bool hot = false;
+  if (m_ops_time && now > m_ops_time) {
+    double rate = (double)(ops - m_ops) / (double)(now - m_ops_time);
+    if (ratep)
+      *ratep = rate;
+    hot = rate >= threshold;
+  }
+  if (now > m_ops_time) {
+    m_ops = ops;
+    m_ops_time = now;
+  }
+  return hot;
+}
+
+
+bool HotSpotDetector::split_row(const String &start_row,
+                                const String &end_row, String &row) {
+  vector<const String *> rows;
+  rows.reserve(m_sample.size());
+  for (const auto &sample : m_sample) {
+    if (sample.compare(start_row) > 0 && sample.compare(end_row) < 0)
+      rows.push_back(&sample);
+  }
+  if (rows.empty())
+    return false;
+  auto median = rows.begin() + rows.size()/2;
+  nth_element(rows.begin(), median, rows.end(),
+              [](const String *lhs, const String *rhs) {
+                return *lhs < *rhs; });
+  row = **median;
+  m_sample.clear();
+  m_sample_next = 0;
+  return true;
+}
@@ -0,0 +1,110 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for HotSpotDetector.
+/// This file contains the type declarations for HotSpotDetector, a class
+/// that detects ranges that should be split because of their access rate.
+
+#ifndef Hypertable_RangeServer_HotSpotDetector_h
+#define Hypertable_RangeServer_HotSpotDetector_h
+
+#include <Common/String.h>
+
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Detects hot ranges and chooses their split row.
+  /// Tracks the access rate of a range between successive calls to
+  /// is_hot() and keeps a fixed-size ring of sampled row accesses, from
+  /// which the split row of a hot range is chosen.  This class is not
+  /// thread-safe; the caller is expected to provide synchronization.
+  class HotSpotDetector {
+  public:
+
+    /// Number of row accesses between samples
+    static constexpr uint64_t SAMPLE_INTERVAL = 16;
+
+    /// Maximum number of sampled rows
+    static constexpr size_t SAMPLE_SIZE = 256;
+
+    /// Records a row access.
+    /// Every #SAMPLE_INTERVAL-th access is copied into the sample ring,
+    /// replacing the oldest sample once the ring holds #SAMPLE_SIZE rows.
+    /// @param row Row key that was accessed
+    void record_access(const char *row);
+
+    /// Checks if access rate has reached threshold.
+    /// Computes the rate of operations per second since the previous call
+    /// and records <code>ops</code> and <code>now</code> as the baseline for
+    /// the next call.  The first call only establishes the baseline.
+    /// @param ops Total number of operations performed on the range
+    /// @param now Current time
+    /// @param threshold Access rate (operations per second) considered hot
+    /// @param ratep Address of variable to hold computed rate
+    /// @return <i>true</i> if rate is at least <code>threshold</code>,
+    /// <i>false</i> otherwise
+    bool is_hot(uint64_t ops, time_t now, double threshold,
+                double *ratep = nullptr);
+
+    /// Chooses split row from access sample.
+    /// Returns the median of the sampled rows that fall strictly inside the
+    /// range boundaries and clears the sample.
+    /// @param start_row Range start row
+    /// @param end_row Range end row
+    /// @param row Output parameter to hold split row
+    /// @return <i>true</i> if a split row was found, <i>false</i> otherwise
+    bool split_row(const String &start_row, const String &end_row,
+                   String &row);
+
+    /// Gets number of sampled rows.
+    /// @return Number of rows in the access sample
+    size_t sample_size() const { return m_sample.size(); }
+
+  private:
+
+    /// Ring of sampled row keys
+    std::vector<String> m_sample;
+
+    /// Index of next ring slot to overwrite once #m_sample is full
+    size_t m_sample_next {};
+
+    /// Number of accesses recorded
+    uint64_t m_access_count {};
+
+    /// Operation count at time of previous is_hot() call
+    uint64_t m_ops {};
+
+    /// Time of previous is_hot() call
+    time_t m_ops_time {};
+  };
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_HotSpotDetector_h
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for IndexUpdateQueue.
+/// This file contains type definitions for IndexUpdateQueue, a class that
+/// buffers index table updates and writes them asynchronously in batches.
+
+#include <Common/Compat.h>
+
+#include "IndexUpdateQueue.h"
+
+#include <Hypertable/RangeServer/IndexUpdater.h>
+
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+#include <algorithm>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  /// Writes index updates to the value and qualifier index tables.
+  class IndexTableSink : public IndexUpdateQueue::Sink {
+  public:
+    bool write(const String &table_id, SchemaPtr &schema, const uint8_t *buf,
+               size_t len) override {
+      bool has_index = false;
+      bool has_qualifier_index = false;
+
+      for (auto cf_spec : schema->get_column_families()) {
+        if (!cf_spec || cf_spec->get_deleted())
+          continue;
+        if (cf_spec->get_value_index())
+          has_index = true;
+        if (cf_spec->get_qualifier_index())
+          has_qualifier_index = true;
+      }
+
+      if (!has_index && !has_qualifier_index)
+        return true;
+
+      IndexUpdaterPtr updater;
+      try {
+        updater = IndexUpdaterFactory::create(table_id, schema, has_index,
+                                              has_qualifier_index);
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << "Problem loading index tables for " << table_id << " - "
+                     << e << HT_END;
+        return false;
+      }
+
+      // The table no longer maps to a name, so it has been dropped
+      if (!updater) {
+        HT_WARNF("Discarding %llu bytes of index updates for table %s",
+                 (Llu)len, table_id.c_str());
+        return true;
+      }
+
+      const uint8_t *ptr = buf;
+      const uint8_t *end = buf + len;
+      SerializedKey serkey;
+      ByteString value;
+      Key key;
+
+      try {
+        while (ptr < end) {
+          serkey.ptr = ptr;
+          key.load(serkey);
+          ptr += key.length;
+          value.ptr = ptr;
+          ptr += value.length();
+          updater->add(key, value);
+        }
+      }
+      catch (Exception &e) {
+        HT_ERROR_OUT << "Problem writing index updates for " << table_id
+                     << " - " << e << HT_END;
+        updater->flush();
+        return false;
+      }
+
+      int32_t error = updater->flush();
+      if (error != Error::OK) {
+        HT_ERRORF("Problem flushing index updates for %s - %s",
+                  table_id.c_str(), Error::get_text(error));
+        return false;
+      }
+      return true;
+    }
+  };
+
+}
+
+
+IndexUpdateQueue::IndexUpdateQueue(size_t flush_size,
+                                   int32_t flush_interval_ms,
+                                   size_t max_memory, SinkPtr sink)
+  : m_flush_size(flush_size), m_flush_interval(flush_interval_ms),
+    m_max_memory(max_memory), m_sink(sink) {
+  if (!m_sink)
+    m_sink = make_shared<IndexTableSink>();
+  m_thread = std::thread(&IndexUpdateQueue::worker_loop, this);
+}
+
+
+IndexUpdateQueue::~IndexUpdateQueue() {
+  shutdown();
+}
+
+
+void IndexUpdateQueue::add(const TableIdentifier &table, SchemaPtr &schema,
+                           const Key &key, const ByteString &value) {
+  size_t value_len = value.length();
+  lock_guard<mutex> lock(m_mutex);
+  unique_ptr<Batch> &batch = m_pending[table.id];
+  if (!batch)
+    batch.reset(new Batch());
+  batch->schema = schema;
+  batch->buf.add(key.serial.ptr, key.length);
+  batch->buf.add(value.ptr, value_len);
+  if (key.revision < batch->earliest_revision)
+    batch->earliest_revision = key.revision;
+  m_pending_bytes += key.length + value_len;
+  if (m_pending_bytes >= m_flush_size)
+    m_cond.notify_all();
+}
+
+
+bool IndexUpdateQueue::has_capacity() {
+  lock_guard<mutex> lock(m_mutex);
+  return m_pending_bytes < m_max_memory || m_shutdown;
+}
+
+
+int64_t IndexUpdateQueue::get_earliest_revision() {
+  lock_guard<mutex> lock(m_mutex);
+  int64_t revision = m_writing_revision;
+  for (auto &entry : m_pending)
+    revision = std::min(revision, entry.second->earliest_revision);
+  return revision;
+}
+
+
+void IndexUpdateQueue::shutdown() {
+  {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_shutdown)
+      return;
+    m_shutdown = true;
+    m_cond.notify_all();
+  }
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+
+void IndexUpdateQueue::worker_loop() {
+  unique_lock<mutex> lock(m_mutex);
+  bool failed = false;
+
+  while (true) {
+    if (failed)
+      m_cond.wait_for(lock, m_flush_interval,
+                      [this]() { return m_shutdown; });
+    else
+      m_cond.wait_for(lock, m_flush_interval, [this]() {
+          return m_shutdown || m_pending_bytes >= m_flush_size; });
+
+    if (m_shutdown)
+      break;
+
+    if (m_pending.empty())
+      continue;
+
+    lock.unlock();
+    failed = !write_pending();
+    lock.lock();
+  }
+}
+
+
+bool IndexUpdateQueue::write_pending() {
+  BatchMap batches;
+  {
+    lock_guard<mutex> lock(m_mutex);
+    batches.swap(m_pending);
+    m_pending_bytes = 0;
+    for (auto &entry : batches)
+      m_writing_revision = std::min(m_writing_revision,
+                                    entry.second->earliest_revision);
+  }
+
+  bool success = true;
+  for (auto &entry : batches) {
+    Batch &batch = *entry.second;
+    if (m_sink->write(entry.first, batch.schema, batch.buf.base,
+                      batch.buf.fill()))
+      continue;
+    success = false;
+    // Put failed batch back so that it is retried on the next flush
+    lock_guard<mutex> lock(m_mutex);
+    size_t len = entry.second->buf.fill();
+    unique_ptr<Batch> &pending = m_pending[entry.first];
+    if (!pending)
+      pending = std::move(entry.second);
+    else {
+      pending->buf.add(entry.second->buf.base, len);
+      pending->earliest_revision = std::min(pending->earliest_revision,
+                                            entry.second->earliest_revision);
+    }
+    m_pending_bytes += len;
+  }
+
+  lock_guard<mutex> lock(m_mutex);
+  m_writing_revision = TIMESTAMP_MAX;
+  return success;
+}
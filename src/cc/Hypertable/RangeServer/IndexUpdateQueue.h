@@ -0,0 +1,201 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for IndexUpdateQueue.
+/// This file contains type declarations for IndexUpdateQueue, a class that
+/// buffers index table updates and writes them asynchronously in batches.
+
+#ifndef Hypertable_RangeServer_IndexUpdateQueue_h
+#define Hypertable_RangeServer_IndexUpdateQueue_h
+
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/Schema.h>
+#include <Hypertable/Lib/TableIdentifier.h>
+
+#include <Common/ByteString.h>
+#include <Common/DynamicBuffer.h>
+#include <Common/String.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Asynchronous index table maintenance.
+  /// When <code>Hypertable.Index.Async</code> is set, clients skip
+  /// synchronous index maintenance and every insert into an indexed column
+  /// is handed to this queue by Range::add() after it has been written to
+  /// the commit log.  Cells are buffered per primary table and written to
+  /// the value and qualifier index tables by a background thread, through an
+  /// IndexUpdater whose mutators group them by destination range.  A batch
+  /// is written once it reaches the flush size or the flush interval
+  /// expires, and is retried until it succeeds.
+  ///
+  /// Buffered cells are not logged separately.  After a crash they are
+  /// regenerated when the commit log is replayed, which calls Range::add()
+  /// again; index cells are idempotent, so writing one twice is harmless.
+  /// To keep that guarantee, the maintenance scheduler does not purge user
+  /// commit log fragments at or past get_earliest_revision(), the earliest
+  /// revision still buffered or being written.
+  class IndexUpdateQueue {
+  public:
+
+    /// Destination of index updates.
+    /// Receives the batches written by the background thread.  The default
+    /// sink writes them to the index tables through an IndexUpdater.
+    class Sink {
+    public:
+      /// Destructor.
+      virtual ~Sink() { }
+
+      /// Writes a batch of primary table cells.
+      /// @param table_id %Table ID of primary table
+      /// @param schema Schema of primary table
+      /// @param buf Serialized key/value pairs
+      /// @param len Length of <code>buf</code>
+      /// @return <i>true</i> on success, <i>false</i> if the batch should be
+      /// retried
+      virtual bool write(const String &table_id, SchemaPtr &schema,
+                         const uint8_t *buf, size_t len) = 0;
+    };
+
+    /// Smart pointer to Sink
+    typedef std::shared_ptr<Sink> SinkPtr;
+
+    /// Constructor.
+    /// Starts the background flush thread.
+    /// @param flush_size Buffered bytes that trigger a flush
+    /// @param flush_interval_ms Maximum time cells stay buffered
+    /// @param max_memory Buffered bytes above which updates to indexed
+    /// tables are rejected
+    /// @param sink Destination of batches, or null for the index tables
+    IndexUpdateQueue(size_t flush_size, int32_t flush_interval_ms,
+                     size_t max_memory, SinkPtr sink = SinkPtr());
+
+    /// Destructor.
+    /// Calls shutdown().
+    ~IndexUpdateQueue();
+
+    /// Adds a primary table cell.
+    /// Copies <code>key</code> and <code>value</code> into the batch for
+    /// <code>table</code>.  Never blocks; callers reject updates when
+    /// has_capacity() returns <i>false</i>.
+    /// @param table %Table identifier of primary table
+    /// @param schema Schema of primary table
+    /// @param key Key of cell
+    /// @param value Value of cell
+    void add(const TableIdentifier &table, SchemaPtr &schema, const Key &key,
+             const ByteString &value);
+
+    /// Checks if buffered updates are below the memory limit.
+    /// Does not wait for the background thread to drain the queue, so that
+    /// a slow index server turns into Error::RANGESERVER_OVERLOADED, which
+    /// clients retry after a back-off, instead of a stalled request handler.
+    /// @return <i>true</i> if there is capacity, <i>false</i> otherwise
+    bool has_capacity();
+
+    /// Returns earliest revision of the updates not yet written.
+    /// Covers both buffered batches and batches being written by the
+    /// background thread.  Never blocks on index table writes.
+    /// @return Earliest revision, or TIMESTAMP_MAX if nothing is pending
+    int64_t get_earliest_revision();
+
+    /// Stops the background thread.
+    /// Updates still buffered are dropped; they are regenerated from the
+    /// commit log when the ranges are next loaded.
+    void shutdown();
+
+  private:
+
+    /// Buffered updates for one primary table
+    struct Batch {
+      /// Schema of primary table
+      SchemaPtr schema;
+      /// Serialized key/value pairs
+      DynamicBuffer buf;
+      /// Earliest revision in #buf
+      int64_t earliest_revision {TIMESTAMP_MAX};
+    };
+
+    /// Map of table ID to batch
+    typedef std::map<String, std::unique_ptr<Batch>> BatchMap;
+
+    /// Background thread function.
+    void worker_loop();
+
+    /// Swaps out and writes pending batches to #m_sink.
+    /// Called only from the background thread.  Batches that fail are put
+    /// back into #m_pending.
+    /// @return <i>true</i> if all batches were written, <i>false</i>
+    /// otherwise
+    bool write_pending();
+
+    /// %Mutex protecting #m_pending, #m_pending_bytes and
+    /// #m_writing_revision
+    std::mutex m_mutex;
+
+    /// Signals worker thread
+    std::condition_variable m_cond;
+
+    /// Pending batches
+    BatchMap m_pending;
+
+    /// Bytes in pending batches
+    size_t m_pending_bytes {};
+
+    /// Earliest revision of the batches being written
+    int64_t m_writing_revision {TIMESTAMP_MAX};
+
+    /// Buffered bytes that trigger a flush
+    size_t m_flush_size;
+
+    /// Flush interval
+    std::chrono::milliseconds m_flush_interval;
+
+    /// Memory limit for buffered updates
+    size_t m_max_memory;
+
+    /// Destination of batches
+    SinkPtr m_sink;
+
+    /// Background flush thread
+    std::thread m_thread;
+
+    /// Set to <i>true</i> by shutdown()
+    bool m_shutdown {};
+  };
+
+  /// Smart pointer to IndexUpdateQueue.
+  typedef std::shared_ptr<IndexUpdateQueue> IndexUpdateQueuePtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_IndexUpdateQueue_h
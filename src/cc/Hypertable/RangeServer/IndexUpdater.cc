@@ -50,7 +50,23 @@ public:
           const String &error_msg, bool eos) { }
   virtual void update_ok(TableMutatorAsync *mutator) { }
   virtual void update_error(TableMutatorAsync *mutator, int error,
-          FailedMutations &failedMutations) { }
+          FailedMutations &failedMutations) {
+    lock_guard<mutex> lock(m_mutex);
+    if (m_error == Error::OK)
+      m_error = error;
+  }
+
+  /// Returns and clears first error seen by update_error().
+  int32_t get_and_clear_error() {
+    lock_guard<mutex> lock(m_mutex);
+    int32_t error = m_error;
+    m_error = Error::OK;
+    return error;
+  }
+
+private:
+  std::mutex m_mutex;
+  int32_t m_error {Error::OK};
 };
 
 IndexUpdater::IndexUpdater(SchemaPtr &primary_schema, TablePtr index_table, 
@@ -74,6 +90,12 @@ IndexUpdater::IndexUpdater(SchemaPtr &primary_schema, TablePtr index_table,
   }
 }
 
+IndexUpdater::~IndexUpdater() {
+  delete m_index_mutator;
+  delete m_qualifier_index_mutator;
+  delete m_cb;
+}
+
 void IndexUpdater::purge(const Key &key, const ByteString &value)
 {
   const uint8_t *vptr = value.ptr;
@@ -122,6 +144,24 @@ void IndexUpdater::add(const Key &key, const ByteString &value) {
 }
 
 
+int32_t IndexUpdater::flush() {
+  try {
+    if (m_index_mutator)
+      m_index_mutator->flush();
+    if (m_qualifier_index_mutator)
+      m_qualifier_index_mutator->flush();
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    m_cb->wait_for_completion();
+    m_cb->get_and_clear_error();
+    return e.code();
+  }
+  m_cb->wait_for_completion();
+  return m_cb->get_and_clear_error();
+}
+
+
 IndexUpdaterPtr IndexUpdaterFactory::create(const String &table_id,
                     SchemaPtr &schema, bool has_index, bool has_qualifier_index)
 {
@@ -43,6 +43,8 @@ namespace Hypertable {
   /// @addtogroup RangeServer
   /// @{
 
+  class IndexUpdaterCallback;
+
   /// Helper class for updating index tables.
   class IndexUpdater {
     friend class IndexUpdaterFactory;
@@ -55,13 +57,7 @@ namespace Hypertable {
                  TablePtr qualifier_index_table);
 
     /// Destructor.
-    ~IndexUpdater() {
-      if (m_index_mutator)
-        delete m_index_mutator;
-      if (m_qualifier_index_mutator)
-        delete m_qualifier_index_mutator;
-      delete m_cb;
-    }
+    ~IndexUpdater();
 
     /// Purges a key from index tables.
     void purge(const Key &key, const ByteString &value);
@@ -69,6 +65,11 @@ namespace Hypertable {
     /// Adds a key to index tables.
     void add(const Key &key, const ByteString &value);
 
+    /// Flushes index updates and waits for them to complete.
+    /// @return Error code of the first update that failed since the last
+    /// call, or Error::OK if all updates succeeded
+    int32_t flush();
+
   private:
 
     /// Mutator for value index table
@@ -78,7 +79,7 @@ namespace Hypertable {
     TableMutatorAsync *m_qualifier_index_mutator;
 
     /// Async mutator callback object
-    ResultCallback *m_cb;
+    IndexUpdaterCallback *m_cb;
     bool m_index_map[256];
     bool m_qualifier_index_map[256];
   };
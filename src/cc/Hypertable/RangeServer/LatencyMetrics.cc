@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Definitions for LatencyMetrics.
+/// This file contains method definitions for LatencyMetrics, a class holding
+/// the latency histograms of the range server.
+
+#include <Common/Compat.h>
+
+#include "LatencyMetrics.h"
+
+#include <Hypertable/Lib/RangeServer/Protocol.h>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *metric_names[LatencyMetrics::METRIC_COUNT] = {
+    "request.update",
+    "request.createScanner",
+    "request.fetchScanblock",
+    "request.destroyScanner",
+    "request.other",
+    "commitLogSync",
+    "blockRead",
+    "blockCacheLookup"
+  };
+
+  inline double to_ms(int64_t us) {
+    return (double)us / 1000.0;
+  }
+
+}
+
+const char *LatencyMetrics::name(Metric metric) {
+  return (metric < METRIC_COUNT) ? metric_names[metric] : "unknown";
+}
+
+LatencyMetrics::Metric LatencyMetrics::request_metric(uint64_t command) {
+  switch (command) {
+  case Lib::RangeServer::Protocol::COMMAND_UPDATE:
+    return REQUEST_UPDATE;
+  case Lib::RangeServer::Protocol::COMMAND_CREATE_SCANNER:
+    return REQUEST_CREATE_SCANNER;
+  case Lib::RangeServer::Protocol::COMMAND_FETCH_SCANBLOCK:
+    return REQUEST_FETCH_SCANBLOCK;
+  case Lib::RangeServer::Protocol::COMMAND_DESTROY_SCANNER:
+    return REQUEST_DESTROY_SCANNER;
+  default:
+    break;
+  }
+  return REQUEST_OTHER;
+}
+
+void LatencyMetrics::collect(vector<StatsLatency> &latencies) {
+  for (int i=0; i<METRIC_COUNT; i++) {
+    LatencyHistogram::Snapshot snapshot;
+    m_histograms[i].collect(snapshot);
+    if (snapshot.count == 0)
+      continue;
+    StatsLatency latency;
+    latency.name = metric_names[i];
+    latency.count = snapshot.count;
+    latency.p50 = snapshot.percentile(50);
+    latency.p90 = snapshot.percentile(90);
+    latency.p99 = snapshot.percentile(99);
+    latency.p999 = snapshot.percentile(99.9);
+    latency.max = snapshot.max;
+    latencies.push_back(latency);
+  }
+}
+
+void LatencyMetrics::publish(MetricsCollector *collector,
+                             const vector<StatsLatency> &latencies) {
+  for (auto &latency : latencies) {
+    string prefix = string("latency.") + latency.name;
+    collector->update(prefix + ".p50", to_ms(latency.p50));
+    collector->update(prefix + ".p99", to_ms(latency.p99));
+    collector->update(prefix + ".p999", to_ms(latency.p999));
+    collector->update(prefix + ".max", to_ms(latency.max));
+  }
+}
@@ -0,0 +1,113 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+/// @file
+/// Declarations for LatencyMetrics.
+/// This file contains type declarations for LatencyMetrics, a class holding
+/// the latency histograms of the range server.
+
+#ifndef Hypertable_RangeServer_LatencyMetrics_h
+#define Hypertable_RangeServer_LatencyMetrics_h
+
+#include <Hypertable/Lib/StatsRangeServer.h>
+
+#include <Common/LatencyHistogram.h>
+#include <Common/MetricsCollector.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Hypertable {
+
+  /// @addtogroup RangeServer
+  /// @{
+
+  /// Latency histograms of the range server.
+  /// Holds a LatencyHistogram, in microseconds, for each metric of #Metric.
+  /// Request latency is measured from the arrival of a request to the
+  /// return of its handler, except for updates, whose latency is measured up
+  /// to the response sent by the update pipeline.  The data path commands
+  /// have a histogram each, all others share the REQUEST_OTHER histogram.
+  /// The histograms are collected into StatsRangeServer::latencies by
+  /// get_statistics(), which also publishes them as metrics.
+  class LatencyMetrics {
+  public:
+
+    /// Metric.
+    enum Metric {
+      REQUEST_UPDATE = 0,         //!< Update requests
+      REQUEST_CREATE_SCANNER,     //!< Create scanner requests
+      REQUEST_FETCH_SCANBLOCK,    //!< Fetch scanblock requests
+      REQUEST_DESTROY_SCANNER,    //!< Destroy scanner requests
+      REQUEST_OTHER,              //!< All other requests
+      COMMIT_LOG_SYNC,            //!< Commit log sync
+      BLOCK_READ,                 //!< CellStore block read from the FS
+      BLOCK_CACHE_LOOKUP,         //!< Block cache lookup
+      METRIC_COUNT                //!< Number of metrics
+    };
+
+    /// Returns name of metric.
+    /// @param metric Metric
+    /// @return Name of <code>metric</code>, used as metric and statistics name
+    static const char *name(Metric metric);
+
+    /// Returns metric of request latency of a command.
+    /// @param command RangeServer protocol command code
+    /// @return Request latency metric of <code>command</code>
+    static Metric request_metric(uint64_t command);
+
+    /// Adds a sample.
+    /// @param metric Metric
+    /// @param us Sample in microseconds
+    void record(Metric metric, int64_t us) {
+      m_histograms[metric].record(us);
+    }
+
+    /// Collects and resets histograms.
+    /// Appends an entry for each metric with samples since the last call.
+    /// @param latencies Vector to which latency percentiles are appended
+    void collect(std::vector<StatsLatency> &latencies);
+
+    /// Publishes collected latency percentiles.
+    /// For each entry of <code>latencies</code>, publishes
+    /// <code>latency.<i>name</i>.p50</code>, <code>.p99</code>,
+    /// <code>.p999</code> and <code>.max</code> in milliseconds.
+    /// @param collector Metrics collector
+    /// @param latencies Latency percentiles returned by collect()
+    static void publish(MetricsCollector *collector,
+                        const std::vector<StatsLatency> &latencies);
+
+  private:
+
+    /// Histograms
+    std::array<LatencyHistogram, METRIC_COUNT> m_histograms;
+  };
+
+  /// Smart pointer to LatencyMetrics
+  typedef std::shared_ptr<LatencyMetrics> LatencyMetricsPtr;
+
+  /// @}
+
+}
+
+#endif // Hypertable_RangeServer_LatencyMetrics_h
@@ -67,6 +67,9 @@ namespace Hypertable {
         period_millis = 0;
         compactions_major = compactions_minor =
           compactions_merging = compactions_gc = 0;
+        cellstore_blocks_compressed = cellstore_blocks_stored_raw = 0;
+        cellstore_bytes_stored_raw = 0;
+        cellstore_bytes_saved = 0;
       }
       uint32_t scan_count;     //!< Scan count
       uint32_t cells_scanned;  //!< Cells scanned
@@ -86,6 +89,14 @@ namespace Hypertable {
       int32_t compactions_minor;
       int32_t compactions_merging;
       int32_t compactions_gc;
+      /// CellStore data blocks written compressed
+      uint32_t cellstore_blocks_compressed;
+      /// CellStore data blocks written uncompressed
+      uint32_t cellstore_blocks_stored_raw;
+      /// Bytes of CellStore data blocks written uncompressed
+      uint64_t cellstore_bytes_stored_raw;
+      /// Bytes saved by compressing CellStore data blocks
+      int64_t cellstore_bytes_saved;
     };
 
     /** Constructor.
@@ -170,6 +181,22 @@ namespace Hypertable {
       m_running.compactions_gc++;
     }
 
+    /** Adds CellStore compression data to #m_running statistics bundle.
+     * @param blocks_compressed Count of data blocks written compressed
+     * @param blocks_stored_raw Count of data blocks written uncompressed
+     * @param bytes_stored_raw Bytes of data blocks written uncompressed
+     * @param bytes_saved Bytes saved by compression
+     */
+    void add_compression_data(uint32_t blocks_compressed,
+                              uint32_t blocks_stored_raw,
+                              uint64_t bytes_stored_raw, int64_t bytes_saved) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_running.cellstore_blocks_compressed += blocks_compressed;
+      m_running.cellstore_blocks_stored_raw += blocks_stored_raw;
+      m_running.cellstore_bytes_stored_raw += bytes_stored_raw;
+      m_running.cellstore_bytes_saved += bytes_saved;
+    }
+
     /** Recomputes statistics.
      * This method first checks to see if #m_compute_period milliseconds have
      * elapsed since the statistics were last computed and if so, it copies
@@ -164,6 +164,7 @@ void MaintenanceScheduler::schedule() {
   if (debug) {
     trace_str += String("low_memory\t") + (low_memory ? "true" : "false") + "\n";
     trace_str += format("Global::memory_tracker->balance()\t%lld\n", (Lld)Global::memory_tracker->balance());
+    trace_str += format("Global::memory_tracker->to_str()\t%s\n", Global::memory_tracker->to_str().c_str());
     trace_str += format("Global::memory_limit\t%lld\n", (Lld)Global::memory_limit);
     trace_str += format("Global::memory_limit_ensure_unused_current\t%lld\n", (Lld)Global::memory_limit_ensure_unused_current);
     trace_str += format("m_query_cache_memory\t%lld\n", (Lld)m_query_cache_memory);
@@ -339,6 +340,14 @@ void MaintenanceScheduler::schedule() {
     if (Global::system_log)
       Global::system_log->purge(revision_system, remove_ok_logs, removed_logs, &trace_str);
 
+    // Index updates not yet written are regenerated from the user log on
+    // replay, so keep the fragments that contain them
+    if (Global::index_update_queue) {
+      int64_t revision = Global::index_update_queue->get_earliest_revision();
+      if (revision < revision_user)
+        revision_user = revision;
+    }
+
     if (Global::user_log)
       Global::user_log->purge(revision_user, remove_ok_logs, removed_logs, &trace_str);
 
@@ -30,8 +30,13 @@
 #include <Hypertable/RangeServer/FileBlockCache.h>
 #include <Hypertable/RangeServer/QueryCache.h>
 
+#include <Common/String.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
-#include <mutex>
+#include <string>
 
 namespace Hypertable {
 
@@ -39,47 +44,146 @@ namespace Hypertable {
   /// @{
 
   /// Tracks range server memory used.
+  /// Memory is charged to the subsystem using it, identified by a #Tag.  The
+  /// block cache and query cache are not charged, their memory used is taken
+  /// from the caches themselves.  Buffers that are allocated in one piece and
+  /// live for the duration of a request or scan are charged with a Charge
+  /// object, which gives the memory back when destroyed.
   class MemoryTracker {
   public:
 
+    /// Subsystem memory is charged to.
+    enum Tag {
+      CELL_CACHE = 0, //!< Cell cache arenas
+      CELLSTORE,      //!< CellStore objects, block indexes and bloom filters
+      REPLAY,         //!< Commit log fragments loaded during recovery
+      UPDATE,         //!< Update request buffers in the update pipeline
+      COMMIT_LOG,     //!< Commit log write buffers of the update pipeline
+      SCANNER,        //!< Scan block buffers, including prefetched blocks
+      RPC,            //!< Payloads of requests queued or running
+      TAG_COUNT       //!< Number of tags
+    };
+
+    /// Returns name of tag.
+    /// @param tag Tag
+    /// @return Name of <code>tag</code>, as used in metrics
+    static const char *tag_name(Tag tag) {
+      static const char *names[TAG_COUNT] = {
+        "cellCache", "cellStore", "replay", "update", "commitLog", "scanner",
+        "rpc"
+      };
+      return (tag < TAG_COUNT) ? names[tag] : "unknown";
+    }
+
     /// Constructor.
     /// @param block_cache Pointer to block cache
     /// @param query_cache Pointer to query cache
     MemoryTracker(FileBlockCache *block_cache, QueryCachePtr query_cache) 
-      : m_block_cache(block_cache), m_query_cache(query_cache) { }
+      : m_block_cache(block_cache), m_query_cache(query_cache) {
+      for (auto &used : m_memory_used)
+        used = 0;
+    }
 
     /// Add to memory used.
     /// @param amount Amount of memory to add
-    void add(int64_t amount) {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_memory_used += amount;
+    /// @param tag Subsystem to charge
+    void add(int64_t amount, Tag tag) {
+      m_memory_used[tag].fetch_add(amount, std::memory_order_relaxed);
     }
 
     /// Subtract to memory used.
     /// @param amount Amount of memory to subtract
-    void subtract(int64_t amount) {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_memory_used -= amount;
+    /// @param tag Subsystem charged
+    void subtract(int64_t amount, Tag tag) {
+      m_memory_used[tag].fetch_sub(amount, std::memory_order_relaxed);
     }
 
     /// Return total range server memory used.
     /// This member function returns the total amount of memory used, computed
-    /// as #m_memory_used plus block cache memory used plus query cache memory
-    /// used.
+    /// as the memory charged to all tags plus block cache memory used plus
+    /// query cache memory used.
     /// @return Total range server memory used
     int64_t balance() {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      return m_memory_used + (m_block_cache ? m_block_cache->memory_used() : 0) +
-        (m_query_cache ? m_query_cache->memory_used() : 0);
+      int64_t total = block_cache_memory() + query_cache_memory();
+      for (auto &used : m_memory_used)
+        total += used.load(std::memory_order_relaxed);
+      return total;
     }
 
-  private:
+    /// Return memory charged to a tag.
+    /// @param tag Tag
+    /// @return Memory charged to <code>tag</code>
+    int64_t balance(Tag tag) {
+      return m_memory_used[tag].load(std::memory_order_relaxed);
+    }
+
+    /// Return block cache memory used.
+    /// @return Block cache memory used
+    int64_t block_cache_memory() {
+      return m_block_cache ? m_block_cache->memory_used() : 0;
+    }
+
+    /// Return query cache memory used.
+    /// @return Query cache memory used
+    int64_t query_cache_memory() {
+      return m_query_cache ? m_query_cache->memory_used() : 0;
+    }
 
-    /// %Mutex to serialize concurrent access
-    std::mutex m_mutex;
+    /// Returns memory used per tag as a string.
+    /// @return Memory used per tag, block cache and query cache memory used,
+    /// as space separated <code>name=bytes</code> pairs
+    std::string to_str() {
+      std::string str;
+      for (int tag=0; tag<TAG_COUNT; tag++)
+        str += format("%s=%lld ", tag_name((Tag)tag),
+                      (long long)balance((Tag)tag));
+      str += format("blockCache=%lld queryCache=%lld",
+                    (long long)block_cache_memory(),
+                    (long long)query_cache_memory());
+      return str;
+    }
+
+    /// Charges memory to a tag for the lifetime of the object.
+    class Charge {
+    public:
+
+      /// Constructor.
+      /// @param tracker Memory tracker, nothing is charged if null
+      /// @param tag Subsystem to charge
+      /// @param amount Initial amount of memory
+      Charge(MemoryTracker *tracker, Tag tag, int64_t amount=0)
+        : m_tracker(tracker), m_tag(tag) {
+        set(amount);
+      }
+
+      /// Destructor, gives back memory charged.
+      ~Charge() { set(0); }
+
+      Charge(const Charge &) = delete;
+      Charge &operator=(const Charge &) = delete;
+
+      /// Changes amount of memory charged.
+      /// @param amount New amount of memory
+      void set(int64_t amount) {
+        if (m_tracker && amount != m_amount)
+          m_tracker->add(amount - m_amount, m_tag);
+        m_amount = amount;
+      }
+
+      /// Returns amount of memory charged.
+      /// @return Amount of memory charged
+      int64_t amount() const { return m_amount; }
+
+    private:
+      MemoryTracker *m_tracker;
+      Tag m_tag;
+      int64_t m_amount {};
+    };
+
+  private:
 
-    /// Current range server memory used
-    int64_t m_memory_used {};
+    /// Memory used per tag
+    std::array<std::atomic<int64_t>, TAG_COUNT> m_memory_used;
 
     /// Pointer to block cache
     FileBlockCache *m_block_cache;
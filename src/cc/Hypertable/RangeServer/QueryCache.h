@@ -70,12 +70,12 @@ namespace Hypertable {
       /// Initializes #tablename to <code>t</code> and #row to <code>r</code>.
       /// This member function assumes that <code>t</code> and <code>r</code>
       /// are pointers to memory that will be valid for the lifetime of the
-      /// cache entry.  Also sets #hash to the fletcher32 checksum of the
+      /// cache entry.  Also sets #hash to the CRC-32C checksum of the
       /// tablename and row for invalidation purposes.
       /// @param t Table name
       /// @param r Row
       RowKey(const char *t, const char *r) : tablename(t), row(r) {
-	hash = fletcher32(t, strlen(t)) ^ fletcher32(r, strlen(r));
+	hash = crc32c(t, strlen(t)) ^ crc32c(r, strlen(r));
       }
       /// Equality operator.
       /// @param other Other key to compare
@@ -173,6 +173,7 @@ void Range::initialize() {
       m_column_family_vector[cf_spec->get_id()] = ag;
   }
 
+  load_indexed_columns(m_schema);
 }
 
 
@@ -435,10 +436,24 @@ void Range::update_schema(SchemaPtr &schema) {
 
   // TODO: remove deleted access groups
   m_schema = schema;
+  load_indexed_columns(m_schema);
   return;
 }
 
 
+void Range::load_indexed_columns(SchemaPtr &schema) {
+  m_indexed_columns.clear();
+  if (!Global::index_update_queue || !m_table.is_user())
+    return;
+  m_indexed_columns.resize(schema->get_max_column_family_id() + 1);
+  for (auto cf_spec : schema->get_column_families()) {
+    if (!cf_spec->get_deleted() &&
+        (cf_spec->get_value_index() || cf_spec->get_qualifier_index()))
+      m_indexed_columns[cf_spec->get_id()] = true;
+  }
+}
+
+
 /**
  * This method must not fail.  The caller assumes that it will succeed.
  */
@@ -469,6 +484,10 @@ void Range::add(const Key &key, const ByteString value) {
       return;
     }
     m_column_family_vector[key.column_family_code]->add(key, value);
+    if (key.flag == FLAG_INSERT &&
+        key.column_family_code < m_indexed_columns.size() &&
+        m_indexed_columns[key.column_family_code])
+      Global::index_update_queue->add(m_table, m_schema, key, value);
   }
 
   if (key.flag == FLAG_INSERT)
@@ -476,6 +495,9 @@ void Range::add(const Key &key, const ByteString value) {
   else
     m_added_deletes[key.flag]++;
 
+  if (Global::range_hot_split_rate)
+    m_hot_spot.record_access(key.row);
+
   if (key.revision > m_revision)
     m_revision = key.revision;
 }
@@ -491,6 +513,8 @@ void Range::create_scanner(ScanContextPtr &scan_ctx, MergeScannerRangePtr &scann
     lock_guard<mutex> lock(m_schema_mutex);
     ag_vector = m_access_group_vector;
     m_scans++;
+    if (Global::range_hot_split_rate && !scan_ctx->start_row.empty())
+      m_hot_spot.record_access(scan_ctx->start_row.c_str());
   }
 
   try {
@@ -642,6 +666,22 @@ Range::get_maintenance_data(ByteArena &arena, time_t now,
   if (!m_unsplittable && size >= m_split_threshold)
     mdata->needs_split = true;
 
+  // Split ranges whose access rate exceeds the hot-split threshold
+  if (Global::range_hot_split_rate) {
+    lock_guard<mutex> lock(m_schema_mutex);
+    double rate = 0;
+    if (m_hot_spot.is_hot(m_scans + m_updates, now,
+                          (double)Global::range_hot_split_rate, &rate) &&
+        !m_unsplittable && !m_is_root &&
+        size >= Global::range_hot_split_minimum_size) {
+      if (!mdata->needs_split)
+        HT_INFOF("Range %s is hot (%.1f ops/s), scheduling split",
+                 m_name.c_str(), rate);
+      mdata->needs_split = true;
+      m_split_by_access = true;
+    }
+  }
+
   mdata->unsplittable = m_unsplittable;
 
   if (size > Global::range_maximum_size) {
@@ -997,8 +1037,20 @@ void Range::split_install_log() {
     for (const auto &ag : ag_vector)
       ag->split_row_estimate_data_cached(split_row_data);
 
-    // Estimate split row from split row data
-    if (!estimate_split_row(split_row_data, split_row)) {
+    // Use the hot-spot access sample if split was triggered by access rate,
+    // otherwise estimate split row from split row data
+    bool by_access = false;
+    {
+      lock_guard<mutex> lock(m_schema_mutex);
+      if (m_split_by_access) {
+        by_access = m_hot_spot.split_row(start_row, end_row, split_row);
+        m_split_by_access = false;
+      }
+    }
+    if (by_access)
+      HT_INFOF("Splitting hot range %s at median of sampled accesses",
+               m_name.c_str());
+    else if (!estimate_split_row(split_row_data, split_row)) {
       if (Global::row_size_unlimited) {
         m_unsplittable = true;
         HT_WARNF("Split attempt aborted for range %s because it is marked unsplittable",
@@ -1525,6 +1577,87 @@ void Range::compact(MaintenanceFlag::Map &subtask_map) {
 
 
 
+void Range::attach_cellstores(const vector<String> &access_groups,
+                              const vector<String> &files) {
+
+  if (!m_initialized)
+    deferred_initialization();
+
+  RangeMaintenanceGuard::Activator activator(m_maintenance_guard);
+  AccessGroupVector ag_vector(0);
+  map<AccessGroup *, vector<String>> attach_map;
+  int state = m_metalog_entity->get_state();
+
+  // Files were cut to the current boundaries, so no split may be under way
+  if (state != RangeState::STEADY)
+    HT_THROWF(Error::RANGESERVER_RANGE_BUSY,
+              "Cannot attach CellStores to %s in state %s", m_name.c_str(),
+              RangeState::get_text(state).c_str());
+
+  HT_ASSERT(access_groups.size() == files.size());
+
+  {
+    lock_guard<mutex> lock(m_schema_mutex);
+    for (size_t i=0; i<files.size(); i++) {
+      auto iter = m_access_group_map.find(access_groups[i]);
+      if (iter == m_access_group_map.end())
+        HT_THROWF(Error::INVALID_ARGUMENT,
+                  "Unrecognized access group name '%s' for %s",
+                  access_groups[i].c_str(), m_name.c_str());
+      attach_map[iter->second.get()].push_back(files[i]);
+    }
+    ag_vector = m_access_group_vector;
+  }
+
+  // Persist cell caches (see AccessGroup::attach_cellstores())
+  {
+    Barrier::ScopedActivator block_updates(m_update_barrier);
+    lock_guard<mutex> lock(m_mutex);
+    for (auto &entry : attach_map)
+      entry.first->stage_compaction();
+  }
+
+  AccessGroup::Hints hints;
+  for (auto &entry : attach_map) {
+    try {
+      entry.first->run_compaction(MaintenanceFlag::COMPACT_MINOR, &hints);
+    }
+    catch (Exception &) {
+      for (auto &unstage : attach_map)
+        unstage.first->unstage_compaction();
+      throw;
+    }
+  }
+
+  // Move every file into place before any access group is modified, so
+  // that a failure leaves the range as it was and the files staged
+  map<AccessGroup *, AccessGroup::StagedCellStores> staged;
+  try {
+    for (auto &entry : attach_map)
+      entry.first->stage_cellstores(entry.second, staged[entry.first]);
+  }
+  catch (Exception &) {
+    for (auto &entry : staged)
+      entry.first->unstage_cellstores(entry.second);
+    throw;
+  }
+
+  for (auto &entry : staged)
+    entry.first->attach_cellstores(entry.second, &hints);
+
+  std::vector<AccessGroup::Hints> all_hints(ag_vector.size());
+  for (size_t i=0; i<ag_vector.size(); i++)
+    ag_vector[i]->load_hints(&all_hints[i]);
+  m_hints_file.set(all_hints);
+  m_hints_file.write(Global::location_initializer->get());
+
+  {
+    lock_guard<mutex> lock(m_mutex);
+    m_maintenance_generation++;
+  }
+}
+
+
 void Range::purge_memory(MaintenanceFlag::Map &subtask_map) {
 
   if (!m_initialized)
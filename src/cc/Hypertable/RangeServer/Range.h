@@ -31,6 +31,7 @@
 #include <Hypertable/RangeServer/AccessGroupHintsFile.h>
 #include <Hypertable/RangeServer/CellList.h>
 #include <Hypertable/RangeServer/CellStore.h>
+#include <Hypertable/RangeServer/HotSpotDetector.h>
 #include <Hypertable/RangeServer/LoadFactors.h>
 #include <Hypertable/RangeServer/LoadMetricsRange.h>
 #include <Hypertable/RangeServer/MaintenanceFlag.h>
@@ -189,6 +190,20 @@ namespace Hypertable {
 
     void compact(MaintenanceFlag::Map &subtask_map);
 
+    /// Attaches bulk loaded CellStores to access groups of this range.
+    /// Flushes the cell cache of each affected access group with a minor
+    /// compaction, moves every file into place with
+    /// AccessGroup::stage_cellstores(), then calls
+    /// AccessGroup::attach_cellstores() on each access group and rewrites
+    /// the hints file.  If any file fails to stage, the files already moved
+    /// are returned to the staging directory and no access group is
+    /// changed, so the request can be retried.  Maintenance is excluded for
+    /// the duration.
+    /// @param access_groups Access group name of each file
+    /// @param files Pathnames of staged CellStore files
+    void attach_cellstores(const std::vector<String> &access_groups,
+                           const std::vector<String> &files);
+
     void purge_memory(MaintenanceFlag::Map &subtask_map);
 
     void schedule_relinquish() { m_relinquish = true; }
@@ -349,6 +364,12 @@ namespace Hypertable {
 
     bool estimate_split_row(CellList::SplitRowDataMapT &split_row_data, String &row);
 
+    /// Records which column families have a value or qualifier index.
+    /// Populates #m_indexed_columns from <code>schema</code>.  Only used when
+    /// index maintenance is asynchronous (see IndexUpdateQueue).
+    /// @param schema %Table schema
+    void load_indexed_columns(SchemaPtr &schema);
+
     void split_install_log();
     void split_compact_and_shrink();
     void split_notify_master();
@@ -375,6 +396,7 @@ namespace Hypertable {
     AccessGroupMap     m_access_group_map;
     AccessGroupVector  m_access_group_vector;
     std::vector<AccessGroupPtr> m_column_family_vector;
+    std::vector<bool> m_indexed_columns;
     RangeMaintenanceGuard m_maintenance_guard;
     int64_t m_revision {TIMESTAMP_MIN};
     int64_t m_latest_revision {TIMESTAMP_MIN};
@@ -398,6 +420,8 @@ namespace Hypertable {
     bool             m_capacity_exceeded_throttle {};
     bool             m_relinquish {};
     bool             m_initialized {};
+    HotSpotDetector  m_hot_spot;
+    bool             m_split_by_access {};
   };
 
   /// Smart pointer to Range
@@ -45,8 +45,10 @@
 #include <Hypertable/RangeServer/MetaLogEntityRemoveOkLogs.h>
 #include <Hypertable/RangeServer/MetaLogEntityTask.h>
 #include <Hypertable/RangeServer/ReplayBuffer.h>
+#include <Hypertable/RangeServer/Request/Handler/PrefetchScanblock.h>
 #include <Hypertable/RangeServer/ScanContext.h>
 
+#include <Hypertable/Lib/BlockHeader.h>
 #include <Hypertable/Lib/ClusterId.h>
 #include <Hypertable/Lib/CommitLog.h>
 #include <Hypertable/Lib/Key.h>
@@ -56,13 +58,16 @@
 #include <Hypertable/Lib/MetaLogWriter.h>
 #include <Hypertable/Lib/PseudoTables.h>
 #include <Hypertable/Lib/RangeServer/Protocol.h>
+#include <Hypertable/Lib/RangeServer/Request/Parameters/Profile.h>
 #include <Hypertable/Lib/RangeServerRecovery/ReceiverPlan.h>
 
 #include <FsBroker/Lib/Client.h>
 
+#include <Common/CpuProfiler.h>
 #include <Common/FailureInducer.h>
 #include <Common/FileUtils.h>
 #include <Common/Random.h>
+#include <Common/RequestTrace.h>
 #include <Common/ScopeGuard.h>
 #include <Common/Status.h>
 #include <Common/StatusPersister.h>
@@ -149,6 +154,9 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
   Global::failover_timeout = props->get_i32("Hypertable.Failover.Timeout");
   Global::range_split_size = cfg.get_i64("Range.SplitSize");
   Global::range_maximum_size = cfg.get_i64("Range.MaximumSize");
+  Global::range_hot_split_rate = cfg.get_i32("Range.HotSplit.Rate");
+  Global::range_hot_split_minimum_size =
+    cfg.get_i64("Range.HotSplit.MinimumSize");
   Global::range_metadata_split_size = cfg.get_i64("Range.MetadataSplitSize",
           Global::range_split_size);
   Global::access_group_garbage_compaction_threshold =
@@ -159,6 +167,7 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
   Global::cellstore_target_size_max = cfg.get_i64("CellStore.TargetSize.Maximum");
   Global::pseudo_tables = PseudoTables::instance();
   m_scanner_buffer_size = cfg.get_i64("Scanner.BufferSize");
+  m_scanner_prefetch_blocks = cfg.get_i32("Scanner.PrefetchBlocks");
   port = cfg.get_i16("Port");
 
   m_control_file_check_interval = cfg.get_i32("ControlFile.CheckInterval");
@@ -191,11 +200,19 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
 
   Global::merge_cellstore_run_length_threshold = cfg.get_i32("CellStore.Merge.RunLengthThreshold");
   Global::ignore_clock_skew_errors = cfg.get_bool("IgnoreClockSkewErrors");
+  BlockHeader::use_crc32c = cfg.get_bool("BlockChecksum.CRC32C");
 
   int64_t interval = (int64_t)cfg.get_i32("Maintenance.Interval");
 
   Global::load_statistics = make_shared<LoadStatistics>(interval);
 
+  Global::admission_control = make_shared<AdmissionControl>(m_props);
+
+  Global::latency_metrics = make_shared<LatencyMetrics>();
+
+  if (cfg.get_bool("Profile.Enable"))
+    CpuProfiler::start(cfg.get_i32("Profile.Frequency"));
+
   m_stats = make_shared<StatsRangeServer>(m_props);
 
   m_namemap = make_shared<NameIdMapper>(m_hyperspace, Global::toplevel_dir);
@@ -364,6 +381,13 @@ Apps::RangeServer::RangeServer(PropertiesPtr &props, ConnectionManagerPtr &conn_
   // Create the maintenance queue
   Global::maintenance_queue = make_shared<MaintenanceQueue>(maintenance_threads);
 
+  // Create the asynchronous index update queue
+  if (props->get_bool("Hypertable.Index.Async"))
+    Global::index_update_queue =
+      make_shared<IndexUpdateQueue>(cfg.get_i64("Index.Async.FlushSize"),
+                                    cfg.get_i32("Index.Async.FlushInterval"),
+                                    cfg.get_i64("Index.Async.MaxMemory"));
+
   /**
    * Listen for incoming connections
    */
@@ -497,6 +521,9 @@ void Apps::RangeServer::shutdown() {
     if (m_update_pipeline_metadata)
       m_update_pipeline_metadata->shutdown();
 
+    if (Global::index_update_queue)
+      Global::index_update_queue->shutdown();
+
     Global::range_locator.reset();
 
     if (Global::rsml_writer) {
@@ -1522,6 +1549,8 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
 
   try {
     DynamicBuffer rbuf;
+    MemoryTracker::Charge rbuf_charge(Global::memory_tracker,
+                                      MemoryTracker::SCANNER);
 
     HT_MAYBE_FAIL("create-scanner-1");
     HT_MAYBE_FAIL_X("create-scanner-user-1", !table.is_system());
@@ -1601,7 +1630,11 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
 
     uint32_t cell_count {};
 
-    more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
+    {
+      RequestTrace::Span span(RequestTrace::SCAN);
+      more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
+    }
+    rbuf_charge.set(rbuf.size);
 
     profile_data.cells_scanned = scanner->get_input_cells();
     profile_data.cells_returned = scanner->get_output_cells();
@@ -1631,6 +1664,8 @@ Apps::RangeServer::create_scanner(Response::Callback::CreateScanner *cb,
     if (more) {
       scan_ctx->deep_copy_specs();
       id = m_scanner_map.put(scanner, range, table, profile_data);
+      if (m_scanner_prefetch_blocks > 0)
+        schedule_scanblock_prefetch(id, cb->event());
     }
     else {
       id = 0;
@@ -1701,13 +1736,11 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
   int error = Error::OK;
   MergeScannerRangePtr scanner;
   RangePtr range;
-  bool more = true;
-  DynamicBuffer rbuf;
   TableInfoPtr table_info;
   TableIdentifierManaged scanner_table;
   SchemaPtr schema;
   ProfileDataScanner profile_data_before;
-  ProfileDataScanner profile_data;
+  ScannerMap::PrefetchedBlock block;
 
   HT_DEBUG_OUT <<"Scanner ID = " << scanner_id << HT_END;
 
@@ -1733,55 +1766,28 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
                 (Lld)schema->get_generation(), (Lld)scanner_table.generation);
     }
 
-    uint32_t cell_count {};
-
-    more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
-
-    profile_data.cells_scanned = scanner->get_input_cells();
-    profile_data.cells_returned = scanner->get_output_cells();
-    profile_data.bytes_scanned = scanner->get_input_bytes();
-    profile_data.bytes_returned = scanner->get_output_bytes();
-    profile_data.disk_read = scanner->get_disk_read();
-
-    int64_t output_cells = scanner->get_output_cells();
+    if (!m_scanner_map.take_prefetched(scanner_id, block))
+      fill_scanblock(scanner_id, scanner, range, profile_data_before, block);
 
-    if (!more) {
+    if (!block.more) {
       m_scanner_map.remove(scanner_id);
       scanner.reset();
     }
-    else
-      m_scanner_map.update_profile_data(scanner_id, profile_data);
-
-    profile_data -= profile_data_before;
+    else if (m_scanner_prefetch_blocks > 0)
+      schedule_scanblock_prefetch(scanner_id, cb->event());
 
-    //HT_INFOF("scanner=%d cell_count=%d %s", (int)scanner_id, (int)cell_count, profile_data.to_string().c_str());
-
-    {
-      lock_guard<LoadStatistics> lock(*Global::load_statistics);
-      Global::load_statistics->add_scan_data(0,
-                                             profile_data.cells_scanned,
-                                             profile_data.cells_returned,
-                                             profile_data.bytes_scanned,
-                                             profile_data.bytes_returned);
-      range->add_read_data(profile_data.cells_scanned,
-                           profile_data.cells_returned,
-                           profile_data.bytes_scanned,
-                           profile_data.bytes_returned,
-                           profile_data.disk_read);
-    }
+    //HT_INFOF("scanner=%d %s", (int)scanner_id, block.profile_data.to_string().c_str());
 
     /**
      *  Send back data
      */
-    {
-      StaticBuffer ext(rbuf);
-      error = cb->response(scanner_id, 0, 0, more, profile_data, ext);
-      if (error != Error::OK)
-        HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
+    error = cb->response(scanner_id, 0, 0, block.more, block.profile_data,
+                         block.data, block.length);
+    if (error != Error::OK)
+      HT_ERRORF("Problem sending OK response - %s", Error::get_text(error));
 
-      HT_DEBUGF("Successfully fetched %u bytes (%lld k/v pairs) of scan data",
-                ext.size-4, (Lld)output_cells);
-    }
+    HT_DEBUGF("Successfully fetched %u bytes (%lld k/v pairs) of scan data",
+              block.length-4, (Lld)block.profile_data.cells_returned);
 
   }
   catch (Hypertable::Exception &e) {
@@ -1791,6 +1797,98 @@ Apps::RangeServer::fetch_scanblock(Response::Callback::CreateScanner *cb,
   }
 }
 
+void Apps::RangeServer::prefetch_scanblock(int32_t scanner_id,
+                                           EventPtr &event) {
+  MergeScannerRangePtr scanner;
+  RangePtr range;
+  TableInfoPtr table_info;
+  TableIdentifierManaged scanner_table;
+  ProfileDataScanner profile_data_before;
+  ScannerMap::PrefetchedBlock block;
+
+  if (!m_scanner_map.needs_prefetch(scanner_id, m_scanner_prefetch_blocks) ||
+      !m_scanner_map.get(scanner_id, scanner, range, scanner_table,
+                         &profile_data_before))
+    return;
+
+  // Leave schema changes and dropped tables to be reported by fetch_scanblock
+  if (!m_context->live_map->lookup(scanner_table.id, table_info) ||
+      table_info->get_schema()->get_generation() != scanner_table.generation)
+    return;
+
+  fill_scanblock(scanner_id, scanner, range, profile_data_before, block);
+  m_scanner_map.add_prefetched(scanner_id, block);
+
+  if (block.more &&
+      m_scanner_map.needs_prefetch(scanner_id, m_scanner_prefetch_blocks))
+    schedule_scanblock_prefetch(scanner_id, event);
+}
+
+void
+Apps::RangeServer::fill_scanblock(int32_t scanner_id,
+                                  MergeScannerRangePtr &scanner,
+                                  RangePtr &range,
+                                  ProfileDataScanner &profile_data_before,
+                                  ScannerMap::PrefetchedBlock &block) {
+  DynamicBuffer rbuf;
+  uint32_t cell_count {};
+  ProfileDataScanner profile_data;
+
+  {
+    RequestTrace::Span span(RequestTrace::SCAN);
+    block.more = FillScanBlock(scanner, rbuf, &cell_count, m_scanner_buffer_size);
+  }
+
+  profile_data.cells_scanned = scanner->get_input_cells();
+  profile_data.cells_returned = scanner->get_output_cells();
+  profile_data.bytes_scanned = scanner->get_input_bytes();
+  profile_data.bytes_returned = scanner->get_output_bytes();
+  profile_data.disk_read = scanner->get_disk_read();
+
+  m_scanner_map.update_profile_data(scanner_id, profile_data);
+
+  profile_data -= profile_data_before;
+
+  {
+    lock_guard<LoadStatistics> lock(*Global::load_statistics);
+    Global::load_statistics->add_scan_data(0,
+                                           profile_data.cells_scanned,
+                                           profile_data.cells_returned,
+                                           profile_data.bytes_scanned,
+                                           profile_data.bytes_returned);
+    range->add_read_data(profile_data.cells_scanned,
+                         profile_data.cells_returned,
+                         profile_data.bytes_scanned,
+                         profile_data.bytes_returned,
+                         profile_data.disk_read);
+  }
+
+  // The block is charged to MemoryTracker::SCANNER until its last reference,
+  // which may be held by the scanner map while prefetched, is dropped
+  int64_t charged = rbuf.size;
+  size_t length;
+  Global::memory_tracker->add(charged, MemoryTracker::SCANNER);
+  block.data.reset(rbuf.release(&length), [charged](uint8_t *data) {
+      Global::memory_tracker->subtract(charged, MemoryTracker::SCANNER);
+      delete [] data;
+    });
+  block.length = length;
+  block.profile_data = profile_data;
+}
+
+void Apps::RangeServer::schedule_scanblock_prefetch(int32_t scanner_id,
+                                                    EventPtr &event) {
+  EventPtr prefetch_event = make_shared<Event>(Event::MESSAGE, event->addr);
+  prefetch_event->header = event->header;
+  prefetch_event->header.gid = scanner_id;
+  // Prefetch is not part of the traced request's critical path
+  prefetch_event->header.set_trace_id(0);
+  prefetch_event->group_id = scanner_id;
+  prefetch_event->arrival_time = ClockT::now();
+  m_app_queue->add(new Request::Handler::PrefetchScanblock(this, prefetch_event,
+                                                           scanner_id));
+}
+
 void
 Apps::RangeServer::load_range(ResponseCallback *cb, const TableIdentifier &table,
                               const RangeSpec &range_spec,
@@ -2117,7 +2215,9 @@ Apps::RangeServer::commit_log_sync(ResponseCallback *cb,
       SchemaPtr schema = table_update->table_info->get_schema();
       // Check for group commit
       if (schema->get_group_commit_interval() > 0) {
-        group_commit_add(cb->event(), cluster_id, schema, table, 0, buffer, 0);
+        AdmissionControl::UpdateBytesPtr admitted_bytes;
+        group_commit_add(cb->event(), cluster_id, schema, table, 0, buffer, 0,
+                         admitted_bytes);
         return;
       }
     }
@@ -2165,7 +2265,8 @@ Apps::RangeServer::commit_log_sync(ResponseCallback *cb,
 void
 Apps::RangeServer::update(Response::Callback::Update *cb, uint64_t cluster_id,
                     const TableIdentifier &table, uint32_t count,
-                    StaticBuffer &buffer, uint32_t flags) {
+                    StaticBuffer &buffer, uint32_t flags,
+                    AdmissionControl::UpdateBytesPtr &admitted_bytes) {
   SchemaPtr schema;
   UpdateRecTable *table_update = new UpdateRecTable();
 
@@ -2179,9 +2280,24 @@ Apps::RangeServer::update(Response::Callback::Update *cb, uint64_t cluster_id,
 
   schema = table_update->table_info->get_schema();
 
+  // Reject updates to indexed tables while the index update queue is full
+  if (Global::index_update_queue && table.is_user()) {
+    for (auto cf_spec : schema->get_column_families()) {
+      if (cf_spec->get_value_index() || cf_spec->get_qualifier_index()) {
+        if (!Global::index_update_queue->has_capacity()) {
+          delete table_update;
+          cb->error(Error::RANGESERVER_OVERLOADED, "Index update queue full");
+          return;
+        }
+        break;
+      }
+    }
+  }
+
   // Check for group commit
   if (schema->get_group_commit_interval() > 0) {
-    group_commit_add(cb->event(), cluster_id, schema, table, count, buffer, flags);
+    group_commit_add(cb->event(), cluster_id, schema, table, count, buffer, flags,
+                     admitted_bytes);
     delete table_update;
     return;
   }
@@ -2200,6 +2316,7 @@ Apps::RangeServer::update(Response::Callback::Update *cb, uint64_t cluster_id,
   request->buffer = buffer;
   request->count = count;
   request->event = cb->event();
+  request->admitted_bytes = admitted_bytes;
 
   table_update->requests.push_back(request);
 
@@ -2364,6 +2481,10 @@ void Apps::RangeServer::dump(ResponseCallback *cb, const char *outfile,
 
     out << str;
 
+    // Spans of traced requests, input to ht_trace_path
+    out << "\nRequest Traces\n";
+    RequestTrace::dump(out);
+
   }
   catch (Hypertable::Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -2469,6 +2590,54 @@ void Apps::RangeServer::heapcheck(ResponseCallback *cb, const char *outfile) {
   cb->response_ok();
 }
 
+void Apps::RangeServer::profile(ResponseCallback *cb, int32_t action,
+                                int32_t frequency, const char *outfile) {
+  typedef Lib::RangeServer::Request::Parameters::Profile Profile;
+
+  HT_INFOF("profile action=%d frequency=%d outfile=%s", (int)action,
+           (int)frequency, outfile);
+
+  try {
+    switch (action) {
+    case Profile::START:
+      if (frequency == 0)
+        frequency = m_props->get_i32("Hypertable.RangeServer.Profile.Frequency");
+      CpuProfiler::start(frequency);
+      break;
+    case Profile::STOP:
+      CpuProfiler::stop();
+      break;
+    case Profile::DUMP:
+      {
+        if (outfile == nullptr || *outfile == 0)
+          HT_THROW(Error::INVALID_ARGUMENT, "No output file given");
+        std::ofstream out(outfile);
+        if (!out)
+          HT_THROWF(Error::LOCAL_IO_ERROR, "Unable to open %s for writing",
+                    outfile);
+        CpuProfiler::write(out);
+        if (!out)
+          HT_THROWF(Error::LOCAL_IO_ERROR, "Error writing %s", outfile);
+        uint64_t samples, dropped;
+        CpuProfiler::get_counts(&samples, &dropped);
+        HT_INFOF("Wrote CPU profile of %llu samples (%llu dropped) to %s",
+                 (Llu)samples, (Llu)dropped, outfile);
+      }
+      break;
+    default:
+      HT_THROWF(Error::INVALID_ARGUMENT, "Invalid profile action %d",
+                (int)action);
+    }
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    cb->error(e.code(), e.what());
+    return;
+  }
+
+  cb->response_ok();
+}
+
 void Apps::RangeServer::set_state(ResponseCallback *cb,
                                   const std::vector<SystemVariable::Spec> &specs,
                                   int64_t generation) {
@@ -2787,6 +2956,17 @@ void
     m_metric_samples = 0;
   }
 
+  m_stats->latencies.clear();
+  Global::latency_metrics->collect(m_stats->latencies);
+
+  m_stats->memory.clear();
+  for (int tag=0; tag<MemoryTracker::TAG_COUNT; tag++) {
+    StatsMemory memory;
+    memory.name = MemoryTracker::tag_name((MemoryTracker::Tag)tag);
+    memory.bytes = Global::memory_tracker->balance((MemoryTracker::Tag)tag);
+    m_stats->memory.push_back(memory);
+  }
+
   cb->response(*m_stats.get());
 
   // Ganglia metrics
@@ -2827,6 +3007,17 @@ void
   m_ganglia_collector->update("compactions.merging", load_stats.compactions_merging);
   m_ganglia_collector->update("compactions.gc", load_stats.compactions_gc);
 
+  m_ganglia_collector->update("cellstore.blocksCompressed",
+                              (int32_t)load_stats.cellstore_blocks_compressed);
+  m_ganglia_collector->update("cellstore.blocksStoredRaw",
+                              (int32_t)load_stats.cellstore_blocks_stored_raw);
+  m_ganglia_collector->update("cellstore.bytesStoredRaw",
+                              (float)load_stats.cellstore_bytes_stored_raw
+                              / period_seconds);
+  m_ganglia_collector->update("cellstore.bytesSaved",
+                              (float)load_stats.cellstore_bytes_saved
+                              / period_seconds);
+
   m_ganglia_collector->update("scanners",
                             m_stats->scanner_count);
   m_ganglia_collector->update("cellstores",
@@ -2835,6 +3026,9 @@ void
                             m_stats->range_count);
   m_ganglia_collector->update("memory.tracked",
                             (float)m_stats->tracked_memory / 1000000000.0);
+  for (auto &memory : m_stats->memory)
+    m_ganglia_collector->update("memory.tracked." + memory.name,
+                                (float)memory.bytes / 1000000000.0);
 
   HT_ASSERT(previous_block_cache_accesses <= m_stats->block_cache_accesses &&
             previous_block_cache_hits <= m_stats->block_cache_hits);
@@ -2874,6 +3068,9 @@ void
   m_ganglia_collector->update("queryCache.waiters", query_cache_waiters);
 
   m_ganglia_collector->update("requestBacklog",(int32_t)m_app_queue->backlog());
+  m_app_queue->publish_queue_wait(m_ganglia_collector.get(), "requestQueueWait");
+  Global::admission_control->publish(m_ganglia_collector.get(), period_seconds);
+  LatencyMetrics::publish(m_ganglia_collector.get(), m_stats->latencies);
 
   try {
     m_ganglia_collector->publish();
@@ -2962,6 +3159,60 @@ Apps::RangeServer::relinquish_range(ResponseCallback *cb,
   }
 }
 
+/// @details
+/// Bulk loaded CellStores are built offline (see ht_bulk_load) against the
+/// range boundaries that were current at the time.  The range must still
+/// exist with exactly the same boundaries, otherwise the files could contain
+/// cells outside of it and the request fails with
+/// Error::RANGESERVER_RANGE_NOT_FOUND so that the client can rebuild.
+void
+Apps::RangeServer::attach_cellstores(ResponseCallback *cb,
+        const TableIdentifier &table, const RangeSpec &range_spec,
+        const vector<String> &access_groups, const vector<String> &files) {
+  TableInfoPtr table_info;
+  RangePtr range;
+  std::stringstream sout;
+
+  sout << "attach_cellstores\n" << table << range_spec;
+  HT_INFOF("%s", sout.str().c_str());
+
+  if (!m_log_replay_barrier->wait(cb->event()->deadline(), table, range_spec))
+    return;
+
+  try {
+    if (!m_context->live_map->lookup(table.id, table_info)) {
+      cb->error(Error::TABLE_NOT_FOUND, table.id);
+      return;
+    }
+
+    if (!table_info->get_range(range_spec, range))
+      HT_THROW(Error::RANGESERVER_RANGE_NOT_FOUND,
+              format("%s[%s..%s]", table.id, range_spec.start_row,
+                  range_spec.end_row));
+
+    if (!table.is_user())
+      HT_THROWF(Error::INVALID_ARGUMENT, "Bulk load into system table %s",
+                table.id);
+
+    // Column family codes in the files are only valid for the schema
+    // generation they were built against
+    if (table.generation != table_info->identifier().generation)
+      HT_THROWF(Error::RANGESERVER_GENERATION_MISMATCH,
+                "Bulk load generation %u != %u", (unsigned)table.generation,
+                (unsigned)table_info->identifier().generation);
+
+    range->attach_cellstores(access_groups, files);
+
+    cb->response_ok();
+  }
+  catch (Hypertable::Exception &e) {
+    int error = 0;
+    HT_ERROR_OUT << e << HT_END;
+    if (cb && (error = cb->error(e.code(), e.what())) != Error::OK)
+      HT_ERRORF("Problem sending error response - %s", Error::get_text(error));
+  }
+}
+
 void Apps::RangeServer::replay_fragments(ResponseCallback *cb, int64_t op_id,
         const String &location, int32_t plan_generation, 
         int32_t type, const vector<int32_t> &fragments,
@@ -3805,7 +4056,8 @@ void
 Apps::RangeServer::group_commit_add(EventPtr &event, uint64_t cluster_id,
                               SchemaPtr &schema, const TableIdentifier &table,
                               uint32_t count, StaticBuffer &buffer,
-                              uint32_t flags) {
+                              uint32_t flags,
+                              AdmissionControl::UpdateBytesPtr &admitted_bytes) {
   lock_guard<mutex> lock(m_mutex);
   if (!m_group_commit) {
     m_group_commit = std::make_shared<GroupCommit>(this);
@@ -3813,5 +4065,6 @@ Apps::RangeServer::group_commit_add(EventPtr &event, uint64_t cluster_id,
     m_group_commit_timer_handler = make_shared<GroupCommitTimerHandler>(m_context->comm, this, m_app_queue);
     m_group_commit_timer_handler->start();
   }
-  m_group_commit->add(event, cluster_id, schema, table, count, buffer, flags);
+  m_group_commit->add(event, cluster_id, schema, table, count, buffer, flags,
+                      admitted_bytes);
 }
@@ -100,12 +100,24 @@ namespace Apps {
     // range server protocol implementations
     void compact(ResponseCallback *, const TableIdentifier &,
                  const char *row, int32_t flags);
+    void attach_cellstores(ResponseCallback *, const TableIdentifier &,
+                           const RangeSpec &,
+                           const std::vector<String> &access_groups,
+                           const std::vector<String> &files);
     void create_scanner(Response::Callback::CreateScanner *,
                         const TableIdentifier &,
                         const  RangeSpec &, const ScanSpec &,
                         QueryCache::Key *);
     void destroy_scanner(ResponseCallback *cb, int32_t scanner_id);
     void fetch_scanblock(Response::Callback::CreateScanner *, int32_t scanner_id);
+
+    /// Fills next scan block of a scanner ahead of its fetch_scanblock()
+    /// request.  Called by Request::Handler::PrefetchScanblock; does nothing
+    /// if the scanner has been destroyed or already holds
+    /// <code>Hypertable.RangeServer.Scanner.PrefetchBlocks</code> blocks.
+    /// @param scanner_id Scanner ID
+    /// @param event Event of the prefetch handler
+    void prefetch_scanblock(int32_t scanner_id, EventPtr &event);
     void load_range(ResponseCallback *, const TableIdentifier &,
                     const RangeSpec &, const RangeState &,
                     bool needs_compaction);
@@ -115,10 +127,14 @@ namespace Apps {
                        const char *);
 
     /** Inserts data into a table.
+     * <code>admitted_bytes</code>, if set, holds the payload bytes admitted
+     * by AdmissionControl and is kept with the update until it has been
+     * committed and answered.
      */
     void update(Response::Callback::Update *cb, uint64_t cluster_id,
                 const TableIdentifier &table, uint32_t count,
-                StaticBuffer &buffer, uint32_t flags);
+                StaticBuffer &buffer, uint32_t flags,
+                AdmissionControl::UpdateBytesPtr &admitted_bytes);
     void batch_update(std::vector<UpdateRecTable *> &updates,
                       ClockT::time_point expire_time);
 
@@ -145,6 +161,18 @@ namespace Apps {
                           const RangeSpec &);
     void heapcheck(ResponseCallback *, const char *);
 
+    /// Controls CPU profiler.
+    /// Starts or stops the CpuProfiler, or writes the folded stacks it has
+    /// counted to <code>outfile</code>.
+    /// @param cb Response callback
+    /// @param action Profiler action
+    /// (Lib::RangeServer::Request::Parameters::Profile::Action)
+    /// @param frequency Sampling frequency for START, 0 for
+    /// <code>Hypertable.RangeServer.Profile.Frequency</code>
+    /// @param outfile Output file for DUMP
+    void profile(ResponseCallback *cb, int32_t action, int32_t frequency,
+                 const char *outfile);
+
     void metadata_sync(ResponseCallback *, const char *, uint32_t flags, std::vector<const char *> columns);
 
     void replay_fragments(ResponseCallback *, int64_t op_id,
@@ -242,7 +270,31 @@ namespace Apps {
 
     void group_commit_add(EventPtr &event, uint64_t cluster_id,
                           SchemaPtr &schema, const TableIdentifier &table,
-                          uint32_t count, StaticBuffer &buffer, uint32_t flags);
+                          uint32_t count, StaticBuffer &buffer, uint32_t flags,
+                          AdmissionControl::UpdateBytesPtr &admitted_bytes);
+
+    /// Fills scan block from an outstanding scanner.
+    /// Updates the scanner's accumulated profile data in #m_scanner_map and
+    /// the server and range load statistics.
+    /// @param scanner_id Scanner ID
+    /// @param scanner Scanner
+    /// @param range %Range being scanned
+    /// @param profile_data_before Accumulated profile data of the scanner
+    /// before this block
+    /// @param block Receives scan block and its profile data
+    void fill_scanblock(int32_t scanner_id, MergeScannerRangePtr &scanner,
+                        RangePtr &range,
+                        ProfileDataScanner &profile_data_before,
+                        ScannerMap::PrefetchedBlock &block);
+
+    /// Schedules prefetch of the next scan block of a scanner.
+    /// Adds a Request::Handler::PrefetchScanblock handler to the application
+    /// queue with the scanner ID as group ID, the group ID of the scanner's
+    /// fetch_scanblock() and destroy_scanner() requests, so the prefetch
+    /// runs in series with them.
+    /// @param scanner_id Scanner ID
+    /// @param event Event of request that returned the previous block
+    void schedule_scanblock_prefetch(int32_t scanner_id, EventPtr &event);
 
     /** Performs a "test and set" operation on #m_get_statistics_outstanding
      * @param value New value for #m_get_statistics_outstanding
@@ -328,6 +380,8 @@ namespace Apps {
     GroupCommitTimerHandlerPtr m_group_commit_timer_handler;
     QueryCachePtr m_query_cache;
     int64_t m_scanner_buffer_size {};
+    /// Maximum number of scan blocks prefetched per scanner
+    int32_t m_scanner_prefetch_blocks {};
     time_t m_last_metrics_update {};
     time_t m_next_metrics_update {};
     double m_loadavg_accum {};
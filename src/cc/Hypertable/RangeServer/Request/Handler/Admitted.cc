@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "Admitted.h"
+
+#include <Hypertable/RangeServer/Global.h>
+
+#include <Hypertable/Lib/RangeServer/Protocol.h>
+
+#include <chrono>
+
+using namespace Hypertable;
+using namespace Hypertable::RangeServer::Request::Handler;
+using namespace std;
+
+Admitted::~Admitted() {
+  delete m_handler;
+  m_admission_control->release(m_class);
+}
+
+void Admitted::run() {
+  m_handler->run();
+  // Updates are timed up to their response by the update pipeline
+  if (Global::latency_metrics &&
+      m_event->header.command != Lib::RangeServer::Protocol::COMMAND_UPDATE) {
+    auto elapsed = ClockT::now() - m_event->arrival_time;
+    Global::latency_metrics->record(LatencyMetrics::request_metric(m_event->header.command),
+      chrono::duration_cast<chrono::microseconds>(elapsed).count());
+  }
+}
@@ -0,0 +1,77 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_RangeServer_Request_Handler_Admitted_h
+#define Hypertable_RangeServer_Request_Handler_Admitted_h
+
+#include <Hypertable/RangeServer/AdmissionControl.h>
+#include <Hypertable/RangeServer/MemoryTracker.h>
+
+#include <AsyncComm/ApplicationHandler.h>
+#include <AsyncComm/Event.h>
+
+namespace Hypertable {
+namespace RangeServer {
+namespace Request {
+namespace Handler {
+
+  /// @addtogroup RangeServerRequestHandler
+  /// @{
+
+  /// Wraps the handler of a request admitted by AdmissionControl.
+  /// Takes ownership of the wrapped handler and releases the request from
+  /// AdmissionControl when destroyed, which happens once the handler has run
+  /// or has been dropped by the application queue because it expired.  The
+  /// payload bytes of updates are not released here but by the
+  /// AdmissionControl::UpdateBytes object handed to the Update handler.
+  /// <code>event</code> is the event the wrapped handler was created from, so
+  /// that the wrapper has the same group ID and urgency.  The latency of the
+  /// request, from its arrival to the return of the wrapped handler, is
+  /// recorded in Global::latency_metrics.  The request payload is charged
+  /// to MemoryTracker::RPC while the request is queued or running.
+  class Admitted : public ApplicationHandler {
+  public:
+    Admitted(EventPtr &event, ApplicationHandler *handler,
+             AdmissionControl *admission_control,
+             AdmissionControl::Class cls, MemoryTracker *memory_tracker)
+      : ApplicationHandler(event), m_handler(handler),
+        m_admission_control(admission_control), m_class(cls),
+        m_memory_charge(memory_tracker, MemoryTracker::RPC,
+                        event->payload_len) {
+      m_low_priority = handler->is_low_priority();
+    }
+
+    virtual ~Admitted();
+
+    virtual void run();
+
+  private:
+    ApplicationHandler *m_handler;
+    AdmissionControl *m_admission_control;
+    AdmissionControl::Class m_class;
+    MemoryTracker::Charge m_memory_charge;
+  };
+
+  /// @}
+
+}}}}
+
+#endif // Hypertable_RangeServer_Request_Handler_Admitted_h
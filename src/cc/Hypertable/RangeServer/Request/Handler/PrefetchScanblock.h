@@ -0,0 +1,61 @@
+/* -*- c++ -*-
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef Hypertable_RangeServer_Request_Handler_PrefetchScanblock_h
+#define Hypertable_RangeServer_Request_Handler_PrefetchScanblock_h
+
+#include <AsyncComm/ApplicationHandler.h>
+#include <AsyncComm/Event.h>
+
+namespace Hypertable {
+namespace Apps { class RangeServer; }
+namespace RangeServer {
+namespace Request {
+namespace Handler {
+
+  /// @addtogroup RangeServerRequestHandler
+  /// @{
+
+  /// Fills the next scan block of a scanner ahead of its fetch_scanblock
+  /// request.  <code>event</code> carries the scanner ID as its group ID so
+  /// that the handler runs in series with the scanner's requests.  Like
+  /// fetch_scanblock requests, prefetches are carried out at low priority.
+  class PrefetchScanblock : public ApplicationHandler {
+  public:
+    PrefetchScanblock(Apps::RangeServer *rs, EventPtr &event,
+                      int32_t scanner_id)
+      : ApplicationHandler(event), m_range_server(rs),
+        m_scanner_id(scanner_id) {
+      m_low_priority = true;
+    }
+
+    virtual void run();
+
+  private:
+    Apps::RangeServer *m_range_server;
+    int32_t m_scanner_id;
+  };
+
+  /// @}
+
+}}}}
+
+#endif // Hypertable_RangeServer_Request_Handler_PrefetchScanblock_h
@@ -53,7 +53,8 @@ void Update::run() {
     mods.own = false;
 
     m_range_server->update(&cb, params.cluster_id(), params.table(),
-                           params.count(), mods, params.flags());
+                           params.count(), mods, params.flags(),
+                           m_admitted_bytes);
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -22,6 +22,8 @@
 #ifndef Hypertable_RangeServer_Request_Handler_Update_h
 #define Hypertable_RangeServer_Request_Handler_Update_h
 
+#include <Hypertable/RangeServer/AdmissionControl.h>
+
 #include <AsyncComm/ApplicationHandler.h>
 #include <AsyncComm/Comm.h>
 #include <AsyncComm/Event.h>
@@ -42,9 +44,17 @@ namespace Handler {
 
     virtual void run();
 
+    /// Sets payload bytes admitted by AdmissionControl.
+    /// The bytes are handed to the update pipeline with the update.
+    /// @param admitted_bytes Admitted payload bytes
+    void set_admitted_bytes(AdmissionControl::UpdateBytesPtr admitted_bytes) {
+      m_admitted_bytes = admitted_bytes;
+    }
+
   private:
     Comm *m_comm;
     Apps::RangeServer *m_range_server;
+    AdmissionControl::UpdateBytesPtr m_admitted_bytes;
   };
 
   /// @}
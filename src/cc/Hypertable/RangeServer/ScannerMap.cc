@@ -123,6 +123,36 @@ void ScannerMap::update_profile_data(int32_t id, ProfileDataScanner &profile_dat
     iter->second.profile_data = profile_data;
 }
 
+bool ScannerMap::needs_prefetch(int32_t id, size_t max_blocks) {
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_scanner_map.find(id);
+  if (iter == m_scanner_map.end())
+    return false;
+  auto &prefetched = iter->second.prefetched;
+  if (prefetched.size() >= max_blocks)
+    return false;
+  return prefetched.empty() || prefetched.back().more;
+}
+
+void ScannerMap::add_prefetched(int32_t id, PrefetchedBlock &block) {
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_scanner_map.find(id);
+  if (iter == m_scanner_map.end())
+    HT_WARNF("Unable to locate scanner ID %u in scanner map", (unsigned)id);
+  else
+    iter->second.prefetched.push_back(block);
+}
+
+bool ScannerMap::take_prefetched(int32_t id, PrefetchedBlock &block) {
+  lock_guard<mutex> lock(m_mutex);
+  auto iter = m_scanner_map.find(id);
+  if (iter == m_scanner_map.end() || iter->second.prefetched.empty())
+    return false;
+  block = iter->second.prefetched.front();
+  iter->second.prefetched.pop_front();
+  return true;
+}
+
 
 int64_t ScannerMap::get_timestamp_millis() {
   return get_ts64() / 1000000LL;
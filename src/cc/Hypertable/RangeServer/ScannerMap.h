@@ -32,7 +32,10 @@
 
 #include <Hypertable/Lib/ProfileDataScanner.h>
 
+#include <boost/shared_array.hpp>
+
 #include <atomic>
+#include <deque>
 #include <mutex>
 #include <unordered_map>
 
@@ -46,6 +49,19 @@ namespace Hypertable {
 
   public:
 
+    /// Scan block filled ahead of a fetch_scanblock request.
+    class PrefetchedBlock {
+    public:
+      /// Encoded cells, as filled by FillScanBlock()
+      boost::shared_array<uint8_t> data;
+      /// Length of #data
+      uint32_t length {};
+      /// <i>true</i> if the scanner has more data after this block
+      bool more {};
+      /// Profile data for this block
+      ProfileDataScanner profile_data;
+    };
+
     /**
      * This method computes a unique scanner ID and puts the given scanner
      * and range pointers into a map using the scanner ID as the key.
@@ -110,6 +126,28 @@ namespace Hypertable {
      */
     void update_profile_data(int32_t id, ProfileDataScanner &profile_data);
 
+    /** Checks if another block should be prefetched for a scanner.
+     * @param id Scanner ID
+     * @param max_blocks Maximum number of prefetched blocks per scanner
+     * @return <i>true</i> if the scanner exists, holds fewer than
+     * <code>max_blocks</code> prefetched blocks and the last of them is not
+     * the end of the scan
+     */
+    bool needs_prefetch(int32_t id, size_t max_blocks);
+
+    /** Adds prefetched block to the end of a scanner's block queue.
+     * @param id Scanner ID
+     * @param block Prefetched block
+     */
+    void add_prefetched(int32_t id, PrefetchedBlock &block);
+
+    /** Removes first prefetched block of a scanner.
+     * @param id Scanner ID
+     * @param block Receives prefetched block
+     * @return <i>true</i> if a block was available, <i>false</i> otherwise
+     */
+    bool take_prefetched(int32_t id, PrefetchedBlock &block);
+
   private:
 
     /** Returns the number of milliseconds since the epoch.
@@ -135,6 +173,8 @@ namespace Hypertable {
       TableIdentifierManaged table;
       /// Accumulated profile data
       ProfileDataScanner profile_data;
+      /// Blocks filled ahead of fetch_scanblock requests, in scan order
+      std::deque<PrefetchedBlock> prefetched;
     };
 
     /// Scanner map
@@ -208,6 +208,8 @@ void TimerHandler::pause_app_queue() {
     Global::maintenance_queue->size();
   HT_INFOF("Application queue PAUSED due to %s",
            m_low_memory_mode ? "low memory" : "log size threshold exceeded");
+  if (m_low_memory_mode)
+    HT_INFOF("Memory used: %s", Global::memory_tracker->to_str().c_str());
   m_pause_time = std::chrono::steady_clock::now();
 }
 
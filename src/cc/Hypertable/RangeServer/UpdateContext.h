@@ -27,6 +27,8 @@
 
 #include <AsyncComm/Clock.h>
 
+#include <Common/RequestTrace.h>
+
 #include <vector>
 
 namespace Hypertable {
@@ -43,13 +45,31 @@ namespace Hypertable {
     /// @param xt Expiration time
     UpdateContext(std::vector<UpdateRecTable *> &updates,
                   std::chrono::fast_clock::time_point xt) :
-      updates(updates), expire_time(xt) { }
+      updates(updates), expire_time(xt) {
+      for (auto u : updates)
+        for (auto request : u->requests)
+          if (request->event && request->event->header.trace_id)
+            traced = true;
+    }
 
     /// Destructor.
     ~UpdateContext() {
       for (auto u : updates)
         delete u;
     }
+
+    /// Records a pipeline stage span for each traced request.
+    /// @param stage Pipeline stage
+    /// @param start Start time of stage (microseconds since the epoch)
+    /// @param end End time of stage (microseconds since the epoch)
+    void record_trace(RequestTrace::Stage stage, int64_t start, int64_t end) {
+      for (auto u : updates)
+        for (auto request : u->requests)
+          if (request->event)
+            RequestTrace::record(request->event->header.trace_id, stage,
+                                 start, end);
+    }
+
     std::vector<UpdateRecTable *> updates;
     std::chrono::fast_clock::time_point expire_time;
     int64_t auto_revision;
@@ -60,6 +80,14 @@ namespace Hypertable {
     uint32_t total_added {};
     uint32_t total_syncs {};
     uint64_t total_bytes_added {};
+    /// Set if any of the requests is traced (see RequestTrace)
+    bool traced {};
+    /// Time commit log write completed, if #traced
+    int64_t commit_end {};
+    /// Memory of request buffers charged to MemoryTracker::UPDATE
+    int64_t update_memory {};
+    /// Memory of commit log buffers charged to MemoryTracker::COMMIT_LOG
+    int64_t commit_log_memory {};
   };
 
   /// @}
@@ -65,6 +65,10 @@ UpdatePipeline::UpdatePipeline(RangeServerContextPtr &context, QueryCachePtr &qu
 }
 
 void UpdatePipeline::add(UpdateContext *uc) {
+  for (auto table_update : uc->updates)
+    for (auto request : table_update->requests)
+      uc->update_memory += request->buffer.size;
+  Global::memory_tracker->add(uc->update_memory, MemoryTracker::UPDATE);
   lock_guard<mutex> lock(m_qualify_queue_mutex);
   m_qualify_queue.push_back(uc);
   m_qualify_queue_cond.notify_all();
@@ -115,6 +119,8 @@ void UpdatePipeline::qualify_and_transform() {
       queue.pop_front();
     }
 
+    int64_t trace_start = uc->traced ? RequestTrace::now() : 0;
+
     rulist = 0;
     transfer_bufp = 0;
     go_buf_reset_offset = 0;
@@ -503,6 +509,19 @@ void UpdatePipeline::qualify_and_transform() {
 
     uc->last_revision = m_last_revision;
 
+    uc->commit_log_memory = uc->root_buf.size;
+    for (auto table_update : uc->updates) {
+      uc->commit_log_memory += table_update->go_buf.size;
+      for (auto &entry : table_update->range_map)
+        uc->commit_log_memory += entry.second->transfer_buf.size;
+    }
+    Global::memory_tracker->add(uc->commit_log_memory,
+                                MemoryTracker::COMMIT_LOG);
+
+    if (uc->traced)
+      uc->record_trace(RequestTrace::UPDATE_QUALIFY, trace_start,
+                       RequestTrace::now());
+
     // Enqueue update
     {
       lock_guard<std::mutex> lock(m_commit_queue_mutex);
@@ -536,6 +555,8 @@ void UpdatePipeline::commit() {
       m_commit_queue_count--;
     }
 
+    int64_t trace_start = uc->traced ? RequestTrace::now() : 0;
+
     committed_transfer_data = 0;
     log_needs_syncing = false;
 
@@ -594,6 +615,12 @@ void UpdatePipeline::commit() {
 
     }
 
+    if (uc->traced) {
+      uc->commit_end = RequestTrace::now();
+      uc->record_trace(RequestTrace::UPDATE_COMMIT, trace_start,
+                       uc->commit_end);
+    }
+
     bool do_sync = false;
     if (log_needs_syncing) {
       if (m_commit_queue_count > 0 && coalesce_amount < m_update_coalesce_limit) {
@@ -609,6 +636,7 @@ void UpdatePipeline::commit() {
     if (do_sync) {
       size_t retry_count {};
       uc->total_syncs++;
+      ClockT::time_point sync_start = ClockT::now();
 
       while (true) {
 
@@ -631,6 +659,10 @@ void UpdatePipeline::commit() {
         else
           break;
       }
+
+      if (Global::latency_metrics)
+        Global::latency_metrics->record(LatencyMetrics::COMMIT_LOG_SYNC,
+          chrono::duration_cast<chrono::microseconds>(ClockT::now() - sync_start).count());
     }
 
     // Enqueue update
@@ -640,6 +672,10 @@ void UpdatePipeline::commit() {
       while (!coalesce_queue.empty()) {
         uc = coalesce_queue.front();
         coalesce_queue.pop_front();
+        // Covers waiting for coalesced updates and the log sync
+        if (uc->traced)
+          uc->record_trace(RequestTrace::UPDATE_SYNC, uc->commit_end,
+                           RequestTrace::now());
         m_response_queue.push_back(uc);
       }
       coalesce_amount = 0;
@@ -666,6 +702,8 @@ void UpdatePipeline::add_and_respond() {
       m_response_queue.pop_front();
     }
 
+    int64_t trace_start = uc->traced ? RequestTrace::now() : 0;
+
     /**
      *  Insert updates into Ranges
      */
@@ -813,6 +851,23 @@ void UpdatePipeline::add_and_respond() {
       Global::load_statistics->add_update_data(uc->total_updates, uc->total_added, uc->total_bytes_added, uc->total_syncs);
     }
 
+    if (Global::latency_metrics) {
+      ClockT::time_point now = ClockT::now();
+      for (auto table_update : uc->updates)
+        for (auto request : table_update->requests)
+          if (request->event)
+            Global::latency_metrics->record(LatencyMetrics::request_metric(request->event->header.command),
+              chrono::duration_cast<chrono::microseconds>(now - request->event->arrival_time).count());
+    }
+
+    if (uc->traced)
+      uc->record_trace(RequestTrace::UPDATE_RESPOND, trace_start,
+                       RequestTrace::now());
+
+    Global::memory_tracker->subtract(uc->update_memory, MemoryTracker::UPDATE);
+    Global::memory_tracker->subtract(uc->commit_log_memory,
+                                     MemoryTracker::COMMIT_LOG);
+    // Also releases the update bytes admitted by AdmissionControl
     delete uc;
 
     // For testing
@@ -27,6 +27,8 @@
 #ifndef Hypertable_RangeServer_UpdateRequest_h
 #define Hypertable_RangeServer_UpdateRequest_h
 
+#include <Hypertable/RangeServer/AdmissionControl.h>
+
 #include <AsyncComm/Event.h>
 
 #include <Common/StaticBuffer.h>
@@ -63,6 +65,9 @@ namespace Hypertable {
     std::vector<SendBackRec> send_back_vector;
     /// Error code that applies to entire buffer
     uint32_t error {};
+    /// Payload bytes admitted by AdmissionControl, held until the request is
+    /// deleted along with its UpdateContext
+    AdmissionControl::UpdateBytesPtr admitted_bytes;
   };
 
   /// @}
@@ -0,0 +1,423 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/RangeServer/CellStoreV7.h>
+#include <Hypertable/RangeServer/Config.h>
+#include <Hypertable/RangeServer/Global.h>
+
+#include <FsBroker/Lib/Client.h>
+
+#include <Hypertable/Lib/Client.h>
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/LoadDataEscape.h>
+#include <Hypertable/Lib/RangeServer/Client.h>
+#include <Hypertable/Lib/TableSplit.h>
+
+#include <AsyncComm/Comm.h>
+#include <AsyncComm/ConnectionManager.h>
+
+#include <Common/ByteString.h>
+#include <Common/DynamicBuffer.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+#include <Common/Stopwatch.h>
+#include <Common/System.h>
+#include <Common/Time.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Config;
+using namespace std;
+
+namespace {
+
+  struct AppPolicy : Config::Policy {
+    static void init_options() {
+      cmdline_desc("Usage: %s [options] <table> <input-file>\n\n"
+        "Bulk loads <input-file> into <table> without going through the\n"
+        "commit log or the cell caches of the range servers.  CellStore\n"
+        "files aligned to the table's current range boundaries are written\n"
+        "into a staging directory and then attached to the ranges.  Each\n"
+        "input line has the form <row> TAB <column> TAB <value>, preceded\n"
+        "by a <timestamp> field (nanoseconds since the epoch) if the first\n"
+        "line is a '#timestamp' header.\n"
+        "Lines must be sorted by row in byte order, e.g. with\n"
+        "'LC_ALL=C sort -t$'\\t' -k1,1'.  Cells within a row may appear in\n"
+        "any order.\n\nOptions").add_options()
+        ("namespace", str()->default_value("/"),
+         "Namespace containing <table>")
+        ("staging-dir", str(), "FS directory in which CellStores are built "
+         "(default <Hypertable.Directory>/tmp/bulk/<table-id>)")
+        ("no-escape", "Row, qualifier and value are not escaped")
+        ("build-only", "Build the CellStores but do not attach them")
+        ;
+      cmdline_hidden_desc().add_options()
+        ("table", str(), "")
+        ("input-file", str(), "");
+      cmdline_positional_desc().add("table", 1).add("input-file", 1);
+    }
+    static void init() {
+      if (!has("input-file")) {
+        HT_ERROR_OUT << "table and input-file required" << HT_END;
+        cout << cmdline_desc() << endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  };
+
+  typedef Meta::list<AppPolicy, FsClientPolicy, DefaultCommPolicy> Policies;
+
+  /// Builds range-aligned CellStores from sorted input and attaches them.
+  class BulkLoader {
+  public:
+
+    BulkLoader(NamespacePtr &ns, const String &table_name,
+               const String &staging_dir, bool escape)
+      : m_staging_dir(staging_dir), m_escape(escape) {
+      TablePtr table = ns->open_table(table_name);
+      table->get(m_table_id, m_schema);
+      ns->get_table_splits(table_name, m_splits);
+      HT_ASSERT(!m_splits.empty());
+      m_outputs.resize(m_splits.size());
+      m_revision = get_ts64();
+    }
+
+    /// Reads and writes all cells of <code>in</code>
+    void build(istream &in) {
+      String line;
+      vector<char *> fields;
+      bool have_timestamp = false;
+      int64_t line_number = 0;
+
+      Global::dfs->mkdirs(m_staging_dir);
+
+      while (getline(in, line)) {
+        line_number++;
+        if (line.empty())
+          continue;
+        if (line_number == 1 && line[0] == '#') {
+          have_timestamp = boost::starts_with(line, "#timestamp");
+          continue;
+        }
+        split_fields((char *)line.c_str(), fields);
+        size_t first = have_timestamp ? 1 : 0;
+        if (fields.size() != first + 3)
+          HT_THROWF(Error::HQL_BAD_LOAD_FILE_FORMAT,
+                    "Wrong number of fields on line %lld", (Lld)line_number);
+        int64_t timestamp = AUTO_ASSIGN;
+        if (have_timestamp)
+          timestamp = strtoll(fields[0], 0, 10);
+        add_cell(fields[first], fields[first+1], fields[first+2], timestamp,
+                 line_number);
+      }
+      flush_row();
+      finish_range();
+    }
+
+    /// Attaches the CellStores of every range to it
+    void attach(Lib::RangeServer::Client &client) {
+      for (size_t i=0; i<m_splits.size(); i++) {
+        if (m_outputs[i].empty())
+          continue;
+        vector<String> access_groups, files;
+        for (auto &entry : m_outputs[i]) {
+          access_groups.push_back(entry.first);
+          files.push_back(entry.second);
+        }
+        RangeSpec range(m_splits[i].start_row, m_splits[i].end_row);
+        CommAddress addr;
+        addr.set_proxy(m_splits[i].location);
+        client.attach_cellstores(addr, m_table_id, range, access_groups,
+                                 files);
+        HT_INFOF("Attached %d CellStore(s) to %s[%s..%s] on %s",
+                 (int)files.size(), m_table_id.id, m_splits[i].start_row,
+                 m_splits[i].end_row, m_splits[i].location);
+      }
+    }
+
+    void display_stats(ostream &out, double elapsed) {
+      out << "  Elapsed time:  " << elapsed << " s\n"
+          << "  Cells loaded:  " << m_cell_count << "\n"
+          << "  Rows loaded:  " << m_row_count << "\n"
+          << "  Ranges:  " << m_range_count << "\n"
+          << "  CellStores:  " << m_file_count << "\n"
+          << "  Cells/s:  " << (elapsed > 0 ? m_cell_count / elapsed : 0.0)
+          << "\n" << flush;
+    }
+
+  private:
+
+    void split_fields(char *ptr, vector<char *> &fields) {
+      fields.clear();
+      fields.push_back(ptr);
+      while ((ptr = strchr(ptr, '\t')) != 0) {
+        *ptr++ = 0;
+        fields.push_back(ptr);
+      }
+    }
+
+    void add_cell(const char *row, char *column, const char *value,
+                  int64_t timestamp, int64_t line_number) {
+      const char *buf;
+      size_t len;
+
+      if (m_escape) {
+        m_row_escaper.unescape(row, strlen(row), &buf, &len);
+        row = buf;
+      }
+
+      if (*row == 0)
+        HT_THROWF(Error::HQL_BAD_LOAD_FILE_FORMAT, "Empty row key on line %lld",
+                  (Lld)line_number);
+
+      if (m_last_row.empty() || strcmp(row, m_last_row.c_str())) {
+        if (!m_last_row.empty() && strcmp(row, m_last_row.c_str()) < 0)
+          HT_THROWF(Error::HQL_BAD_LOAD_FILE_FORMAT, "Input not sorted by "
+                    "row at line %lld ('%s' < '%s')", (Lld)line_number, row,
+                    m_last_row.c_str());
+        flush_row();
+        m_last_row = row;
+        while (strcmp(row, m_splits[m_split].end_row) > 0) {
+          finish_range();
+          m_split++;
+        }
+      }
+
+      char *qualifier = strchr(column, ':');
+      if (qualifier)
+        *qualifier++ = 0;
+      else
+        qualifier = (char *)"";
+      ColumnFamilySpec *cf_spec = m_schema->get_column_family(column);
+      if (cf_spec == 0 || cf_spec->get_deleted())
+        HT_THROWF(Error::BAD_SCHEMA, "Unknown column family '%s' on line %lld",
+                  column, (Lld)line_number);
+      if (cf_spec->get_option_counter())
+        HT_THROWF(Error::NOT_IMPLEMENTED, "Bulk load of counter column '%s'",
+                  column);
+      if (m_escape) {
+        m_qualifier_escaper.unescape(qualifier, strlen(qualifier), &buf, &len);
+        qualifier = (char *)buf;
+      }
+
+      // Every cell gets its own revision so that duplicates resolve to the
+      // last one in the input
+      int64_t revision = m_revision + m_cell_count++;
+      if (timestamp == AUTO_ASSIGN)
+        timestamp = revision;
+
+      CellRef cell;
+      cell.ag = cf_spec->get_access_group();
+      cell.key_offset = m_row_buf.fill();
+      create_key_and_append(m_row_buf, FLAG_INSERT, m_last_row.c_str(),
+                            cf_spec->get_id(), qualifier, timestamp, revision,
+                            !cf_spec->get_option_time_order_desc());
+      cell.value_offset = m_row_buf.fill();
+      len = strlen(value);
+      if (m_escape)
+        m_value_escaper.unescape(value, len, &buf, &len);
+      else
+        buf = value;
+      append_as_byte_string(m_row_buf, buf, len);
+      m_row_cells.push_back(cell);
+    }
+
+    /// Sorts the cells of the current row and appends them to the
+    /// CellStores of their access groups
+    void flush_row() {
+      if (m_row_cells.empty())
+        return;
+      const uint8_t *base = m_row_buf.base;
+      sort(m_row_cells.begin(), m_row_cells.end(),
+           [base](const CellRef &a, const CellRef &b) {
+             return SerializedKey(base + a.key_offset) <
+               SerializedKey(base + b.key_offset); });
+      Key key;
+      for (auto &cell : m_row_cells) {
+        key.load(SerializedKey(base + cell.key_offset));
+        get_cellstore(cell.ag)->add(key, ByteString(base + cell.value_offset));
+      }
+      m_row_cells.clear();
+      m_row_buf.clear();
+      m_row_count++;
+    }
+
+    CellStorePtr &get_cellstore(const String &ag) {
+      CellStorePtr &cellstore = m_cellstores[ag];
+      if (!cellstore) {
+        String filename = format("%s/r%u-%s", m_staging_dir.c_str(),
+                                 (unsigned)m_split, ag.c_str());
+        cellstore = make_shared<CellStoreV7>(Global::dfs.get(), m_schema);
+        cellstore->create(filename.c_str(), 0, get_properties(ag),
+                          &m_table_id);
+        m_outputs[m_split][ag] = filename;
+        m_file_count++;
+      }
+      return cellstore;
+    }
+
+    /// Returns CellStore properties for an access group, derived the same
+    /// way AccessGroup::update_schema() does
+    PropertiesPtr &get_properties(const String &ag) {
+      PropertiesPtr &props = m_props[ag];
+      if (!props) {
+        AccessGroupSpec *ag_spec = m_schema->get_access_group(ag);
+        if (ag_spec->get_option_in_memory())
+          HT_THROWF(Error::NOT_IMPLEMENTED, "Bulk load into IN_MEMORY access "
+                    "group '%s'", ag.c_str());
+        props = make_shared<Properties>();
+        props->set("compressor", ag_spec->get_option_compressor());
+        props->set("blocksize", ag_spec->get_option_blocksize());
+        if (ag_spec->get_option_replication() != -1)
+          props->set("replication", (int32_t)ag_spec->get_option_replication());
+        if (!ag_spec->get_option_bloom_filter().empty())
+          AccessGroupOptions::parse_bloom_filter(ag_spec->get_option_bloom_filter(),
+                                                 props);
+      }
+      return props;
+    }
+
+    void finish_range() {
+      if (m_cellstores.empty())
+        return;
+      for (auto &entry : m_cellstores)
+        entry.second->finalize(&m_table_id);
+      m_cellstores.clear();
+      m_range_count++;
+    }
+
+    /// Location of a buffered cell within #m_row_buf
+    struct CellRef {
+      String ag;
+      size_t key_offset;
+      size_t value_offset;
+    };
+
+    TableIdentifierManaged m_table_id;
+    SchemaPtr m_schema;
+    TableSplitsContainer m_splits;
+    String m_staging_dir;
+    bool m_escape;
+
+    /// Index into #m_splits of current range
+    size_t m_split {};
+
+    /// Staged file of each access group, per range
+    vector<map<String, String>> m_outputs;
+
+    /// CellStores being written for current range
+    map<String, CellStorePtr> m_cellstores;
+
+    /// CellStore properties per access group
+    map<String, PropertiesPtr> m_props;
+
+    /// Revision assigned to first cell
+    int64_t m_revision {};
+
+    String m_last_row;
+    DynamicBuffer m_row_buf;
+    vector<CellRef> m_row_cells;
+    LoadDataEscape m_row_escaper;
+    LoadDataEscape m_qualifier_escaper;
+    LoadDataEscape m_value_escaper;
+
+    int64_t m_cell_count {};
+    int64_t m_row_count {};
+    int64_t m_range_count {};
+    int64_t m_file_count {};
+  };
+
+} // local namespace
+
+
+int main(int argc, char **argv) {
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    String table_name = get_str("table");
+    String input_file = get_str("input-file");
+    int timeout = get_i32("timeout");
+
+    ConnectionManagerPtr conn_mgr = make_shared<ConnectionManager>();
+    FsBroker::Lib::ClientPtr dfs =
+      std::make_shared<FsBroker::Lib::Client>(conn_mgr, properties);
+    if (!dfs->wait_for_connection(timeout)) {
+      cerr << "error: timed out waiting for FS broker" << endl;
+      quick_exit(EXIT_FAILURE);
+    }
+    Global::dfs = dfs;
+    Global::memory_tracker = new MemoryTracker(0, 0);
+    Global::toplevel_dir = properties->get_str("Hypertable.Directory");
+    boost::trim_if(Global::toplevel_dir, boost::is_any_of("/"));
+    Global::toplevel_dir = String("/") + Global::toplevel_dir;
+
+    ClientPtr client = make_shared<Hypertable::Client>(System::install_dir);
+    NamespacePtr ns = client->open_namespace(get_str("namespace"));
+
+    String staging_dir;
+    {
+      TableIdentifierManaged table_id;
+      SchemaPtr schema;
+      ns->open_table(table_name)->get(table_id, schema);
+      if (!table_id.is_user())
+        HT_THROWF(Error::INVALID_ARGUMENT, "Cannot bulk load system table %s",
+                  table_name.c_str());
+      staging_dir = has("staging-dir") ? get_str("staging-dir") :
+        format("%s/tmp/bulk/%s/%lld", Global::toplevel_dir.c_str(),
+               table_id.id, (Lld)get_ts64());
+    }
+
+    ifstream in(input_file.c_str());
+    if (!in)
+      HT_THROWF(Error::FILE_NOT_FOUND, "Unable to open %s",
+                input_file.c_str());
+
+    Stopwatch stopwatch;
+    BulkLoader loader(ns, table_name, staging_dir, !has("no-escape"));
+    loader.build(in);
+
+    if (has("build-only"))
+      cout << "CellStores written to " << staging_dir << endl;
+    else {
+      Lib::RangeServer::Client rs_client(Comm::instance(), timeout);
+      loader.attach(rs_client);
+    }
+    stopwatch.stop();
+
+    cout << "\nBulk load complete:\n\n";
+    loader.display_stats(cout, stopwatch.elapsed());
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    quick_exit(EXIT_FAILURE);
+  }
+  quick_exit(EXIT_SUCCESS);
+}
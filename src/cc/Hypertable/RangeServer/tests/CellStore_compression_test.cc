@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include "../CellStoreFactory.h"
+#include "../CellStoreV7.h"
+#include "../Global.h"
+
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/Schema.h>
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <FsBroker/Lib/Client.h>
+
+#include <AsyncComm/ConnectionManager.h>
+
+#include <Common/Config.h>
+#include <Common/Init.h>
+#include <Common/DynamicBuffer.h>
+#include <Common/InetAddr.h>
+#include <Common/Random.h>
+#include <Common/System.h>
+#include <Common/Usage.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: CellStore_compression_test",
+    "",
+    "  This program tests adaptive compression of CellStore data blocks.",
+    "  It writes one cell store with incompressible values and one with",
+    "  compressible values, checks the compression statistics of each and",
+    "  scans them back.",
+    (const char *)0
+  };
+
+  const char *schema_str =
+  "<Schema>\n"
+  "  <AccessGroup name=\"default\">\n"
+  "    <ColumnFamily id=\"1\">\n"
+  "      <Name>data</Name>\n"
+  "    </ColumnFamily>\n"
+  "  </AccessGroup>\n"
+  "</Schema>";
+
+  const size_t CELL_COUNT = 2000;
+  const size_t VALUE_SIZE = 1000;
+
+  /** Fills <code>value</code> with <code>VALUE_SIZE</code> bytes.
+   * @param value Buffer to hold vint length and value bytes
+   * @param row Row number
+   * @param random Fill with random bytes if <i>true</i>, otherwise with text
+   */
+  void make_value(DynamicBuffer &value, size_t row, bool random) {
+    value.clear();
+    value.ensure(VALUE_SIZE + 8);
+    Serialization::encode_vi32(&value.ptr, VALUE_SIZE);
+    for (size_t i=0; i<VALUE_SIZE; i++) {
+      if (random)
+        value.ptr[i] = (uint8_t)Random::number32();
+      else
+        value.ptr[i] = "All work and no play makes jack a dull boy. "[(i+row)%44];
+    }
+    value.ptr += VALUE_SIZE;
+  }
+
+  CellStoreV7::CompressionStats
+  write_cellstore(const String &csname, SchemaPtr &schema, bool random) {
+    TableIdentifier table_id("0");
+    PropertiesPtr cs_props = make_shared<Properties>();
+    cs_props->set("blocksize", (int32_t)65536);
+    cs_props->set("compressor", String("zlib"));
+
+    auto cs = make_shared<CellStoreV7>(Global::dfs.get(), schema);
+    cs->create(csname.c_str(), CELL_COUNT, cs_props, &table_id);
+
+    DynamicBuffer keybuf;
+    DynamicBuffer value;
+    SerializedKey serkey;
+    Key key;
+    char rowbuf[32];
+    for (size_t i=0; i<CELL_COUNT; i++) {
+      sprintf(rowbuf, "row%06d", (int)i);
+      keybuf.clear();
+      serkey.ptr = keybuf.ptr;
+      create_key_and_append(keybuf, FLAG_INSERT, rowbuf, 1, "", i+1, i+1);
+      key.load(serkey);
+      make_value(value, i, random);
+      cs->add(key, ByteString(value.base));
+    }
+    cs->finalize(&table_id);
+    return cs->get_compression_stats();
+  }
+
+  void check_scan(const String &csname, SchemaPtr &schema, bool random) {
+    CellStorePtr cs = CellStoreFactory::open(csname, "", Key::END_ROW_MARKER);
+    RangeSpec range;
+    range.start_row = "";
+    range.end_row = Key::END_ROW_MARKER;
+    ScanSpecBuilder ssbuilder;
+    ssbuilder.add_row_interval("", true, Key::END_ROW_MARKER, true);
+    ScanContextPtr scan_ctx = make_shared<ScanContext>(TIMESTAMP_MAX,
+        &(ssbuilder.get()), &range, schema);
+    CellListScannerPtr scanner(cs->create_scanner(scan_ctx.get()));
+
+    Key key;
+    ByteString bsvalue;
+    DynamicBuffer expected;
+    char rowbuf[32];
+    size_t count = 0;
+    while (scanner->get(key, bsvalue)) {
+      sprintf(rowbuf, "row%06d", (int)count);
+      HT_ASSERT(!strcmp(key.row, rowbuf));
+      HT_ASSERT(bsvalue.length() == VALUE_SIZE);
+      if (!random) {
+        make_value(expected, count, false);
+        HT_ASSERT(!memcmp(bsvalue.ptr, expected.base, bsvalue.length()));
+      }
+      count++;
+      scanner->forward();
+    }
+    HT_ASSERT(count == CELL_COUNT);
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  try {
+    struct sockaddr_in addr;
+
+    Config::init(argc, argv);
+
+    if (Config::has("help"))
+      Usage::dump_and_exit(usage);
+
+    System::initialize(System::locate_install_dir(argv[0]));
+    ReactorFactory::initialize(2);
+
+    uint16_t port = Config::properties->get_i16("FsBroker.Port");
+    InetAddr::initialize(&addr, "localhost", port);
+
+    ConnectionManagerPtr conn_mgr = make_shared<ConnectionManager>();
+    FsBroker::Lib::ClientPtr client =
+      make_shared<FsBroker::Lib::Client>(conn_mgr, addr, 15000);
+    Global::dfs = client;
+
+    if (!client->wait_for_connection(15000)) {
+      HT_ERROR("Unable to connect to DFS");
+      return 1;
+    }
+
+    Global::memory_tracker = new MemoryTracker(0, 0);
+    Global::load_statistics = make_shared<LoadStatistics>(0);
+
+    String testdir = "/CellStore_compression_test";
+    client->mkdirs(testdir);
+
+    SchemaPtr schema(Schema::new_instance(schema_str));
+
+    // Incompressible values: after the first block has shown that the data
+    // does not compress, blocks are sampled and stored raw
+    CellStoreV7::CompressionStats random_stats =
+      write_cellstore(testdir + "/random", schema, true);
+    uint32_t random_blocks =
+      random_stats.blocks_compressed + random_stats.blocks_stored_raw;
+    HT_ASSERT(random_blocks > 2);
+    HT_ASSERT(random_stats.blocks_compressed <= 1);
+    HT_ASSERT(random_stats.blocks_stored_raw >= random_blocks - 1);
+    HT_ASSERT(random_stats.bytes_stored_raw >=
+              (uint64_t)(random_blocks - 1) * 65536);
+    check_scan(testdir + "/random", schema, true);
+
+    // Compressible values: every block is compressed
+    CellStoreV7::CompressionStats text_stats =
+      write_cellstore(testdir + "/text", schema, false);
+    HT_ASSERT(text_stats.blocks_compressed > 2);
+    HT_ASSERT(text_stats.blocks_stored_raw == 0);
+    HT_ASSERT(text_stats.bytes_stored_raw == 0);
+    HT_ASSERT(text_stats.bytes_saved >
+              (int64_t)(CELL_COUNT * VALUE_SIZE) / 2);
+    check_scan(testdir + "/text", schema, false);
+
+    // Both files are accounted for in the server load statistics
+    LoadStatistics::Bundle load_stats;
+    Global::load_statistics->recompute(&load_stats);
+    HT_ASSERT(load_stats.cellstore_blocks_compressed ==
+              random_stats.blocks_compressed + text_stats.blocks_compressed);
+    HT_ASSERT(load_stats.cellstore_blocks_stored_raw ==
+              random_stats.blocks_stored_raw);
+    HT_ASSERT(load_stats.cellstore_bytes_stored_raw ==
+              random_stats.bytes_stored_raw);
+    HT_ASSERT(load_stats.cellstore_bytes_saved ==
+              random_stats.bytes_saved + text_stats.bytes_saved);
+
+    client->rmdir(testdir);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    return 1;
+  }
+  return 0;
+}
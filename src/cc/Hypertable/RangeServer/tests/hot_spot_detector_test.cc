@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/RangeServer/HotSpotDetector.h>
+
+#include <Hypertable/Lib/Key.h>
+
+#include <Common/Logger.h>
+#include <Common/String.h>
+#include <Common/Usage.h>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: hot_spot_detector_test",
+    "",
+    "  This program feeds synthetic access load to a HotSpotDetector and",
+    "  checks the hot-range split trigger and the chosen split row.",
+    (const char *)0
+  };
+
+  String row_key(uint64_t i) {
+    return format("row%05d", (int)i);
+  }
+
+  /// Records <code>count</code> accesses of successive rows starting at
+  /// row <code>first</code>.
+  void record(HotSpotDetector &detector, uint64_t first, uint64_t count) {
+    for (uint64_t i=first; i<first+count; i++)
+      detector.record_access(row_key(i).c_str());
+  }
+
+  void check_split_row(HotSpotDetector &detector, const String &start_row,
+                       const String &end_row, const String &expected) {
+    String row;
+    if (!detector.split_row(start_row, end_row, row) || row != expected) {
+      cout << "Expected split row " << expected << ", got " << row << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  /// Checks that the split trigger fires once the operation rate between
+  /// two maintenance passes reaches the threshold.
+  void test_trigger() {
+    HotSpotDetector detector;
+    double rate = 0;
+
+    // first pass only sets the baseline
+    HT_ASSERT(!detector.is_hot(1000000, 1000, 100, &rate));
+
+    // 1900 ops in 10 seconds
+    HT_ASSERT(detector.is_hot(1001900, 1010, 100, &rate));
+    HT_ASSERT(rate == 190);
+
+    // no time has passed, baseline unchanged
+    HT_ASSERT(!detector.is_hot(1002000, 1010, 100, &rate));
+
+    // 100 ops in 10 seconds
+    HT_ASSERT(!detector.is_hot(1002000, 1020, 100, &rate));
+    HT_ASSERT(rate == 10);
+
+    // exactly at threshold
+    HT_ASSERT(detector.is_hot(1003000, 1030, 100, &rate));
+  }
+
+  /// Checks sampling and the median split row.
+  void test_split_row() {
+    const uint64_t interval = HotSpotDetector::SAMPLE_INTERVAL;
+    const uint64_t size = HotSpotDetector::SAMPLE_SIZE;
+    HotSpotDetector detector;
+
+    // every interval'th access is sampled: rows 0, 16, ... 4080
+    record(detector, 0, interval * size);
+    HT_ASSERT(detector.sample_size() == size);
+    check_split_row(detector, "", Key::END_ROW_MARKER,
+                    row_key(interval * (size/2)));
+
+    // sample is cleared after a split row has been chosen
+    HT_ASSERT(detector.sample_size() == 0);
+    String row;
+    HT_ASSERT(!detector.split_row("", Key::END_ROW_MARKER, row));
+
+    // only samples strictly inside the range are considered
+    record(detector, 0, interval * size);
+    HT_ASSERT(!detector.split_row(row_key(5000), row_key(6000), row));
+    HT_ASSERT(detector.sample_size() == size);
+    check_split_row(detector, row_key(2000), row_key(3000), row_key(2512));
+
+    // sample ring keeps only the most recent accesses
+    record(detector, 0, 2 * interval * size);
+    HT_ASSERT(detector.sample_size() == size);
+    check_split_row(detector, "", Key::END_ROW_MARKER,
+                    row_key(interval * size + interval * (size/2)));
+  }
+
+  /// Checks that the split row follows skewed access rather than the
+  /// middle of the key space.
+  void test_skewed_access() {
+    HotSpotDetector detector;
+    // one access to each of 1000 rows, then 3000 accesses to rows 900-999
+    record(detector, 0, 1000);
+    for (int i=0; i<30; i++)
+      record(detector, 900, 100);
+    String row;
+    HT_ASSERT(detector.split_row("", Key::END_ROW_MARKER, row));
+    HT_ASSERT(row >= row_key(900) && row < row_key(1000));
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  if (argc != 1)
+    Usage::dump_and_exit(usage);
+
+  test_trigger();
+  test_split_row();
+  test_skewed_access();
+
+  return 0;
+}
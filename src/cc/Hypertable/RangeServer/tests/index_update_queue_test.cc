@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+
+#include <Hypertable/RangeServer/IndexUpdateQueue.h>
+
+#include <Hypertable/Lib/Key.h>
+#include <Hypertable/Lib/SerializedKey.h>
+
+#include <Common/DynamicBuffer.h>
+#include <Common/Logger.h>
+#include <Common/Usage.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+  const char *usage[] = {
+    "usage: index_update_queue_test",
+    "",
+    "  This program tests batching, retry, overload rejection and revision",
+    "  tracking of the IndexUpdateQueue, using a sink that records batches",
+    "  instead of writing them to index tables.",
+    (const char *)0
+  };
+
+  /// Sink that records the cells written per table.
+  class FakeSink : public IndexUpdateQueue::Sink {
+  public:
+    bool write(const String &table_id, SchemaPtr &schema, const uint8_t *buf,
+               size_t len) override {
+      unique_lock<mutex> lock(m_mutex);
+      m_writes++;
+      m_cond.notify_all();
+      m_cond.wait(lock, [this]() { return !m_blocked; });
+      if (m_failures > 0) {
+        m_failures--;
+        m_cond.notify_all();
+        return false;
+      }
+      const uint8_t *ptr = buf;
+      const uint8_t *end = buf + len;
+      SerializedKey serkey;
+      ByteString value;
+      Key key;
+      while (ptr < end) {
+        serkey.ptr = ptr;
+        key.load(serkey);
+        ptr += key.length;
+        value.ptr = ptr;
+        ptr += value.length();
+        m_cells[table_id].push_back(key.row);
+      }
+      m_batches++;
+      m_cond.notify_all();
+      return true;
+    }
+
+    /// Blocks or unblocks writes
+    void set_blocked(bool blocked) {
+      lock_guard<mutex> lock(m_mutex);
+      m_blocked = blocked;
+      m_cond.notify_all();
+    }
+
+    /// Makes the next <code>count</code> writes fail
+    void set_failures(int count) {
+      lock_guard<mutex> lock(m_mutex);
+      m_failures = count;
+    }
+
+    /// Waits until <code>count</code> batches have been written
+    bool wait_for_batches(int count) {
+      unique_lock<mutex> lock(m_mutex);
+      return m_cond.wait_for(lock, chrono::seconds(10),
+                             [this, count]() { return m_batches >= count; });
+    }
+
+    /// Waits until <code>count</code> write attempts have been started
+    bool wait_for_writes(int count) {
+      unique_lock<mutex> lock(m_mutex);
+      return m_cond.wait_for(lock, chrono::seconds(10),
+                             [this, count]() { return m_writes >= count; });
+    }
+
+    int batches() {
+      lock_guard<mutex> lock(m_mutex);
+      return m_batches;
+    }
+
+    vector<String> cells(const String &table_id) {
+      lock_guard<mutex> lock(m_mutex);
+      return m_cells[table_id];
+    }
+
+  private:
+    mutex m_mutex;
+    condition_variable m_cond;
+    map<String, vector<String>> m_cells;
+    int m_batches {};
+    int m_writes {};
+    int m_failures {};
+    bool m_blocked {};
+  };
+
+  typedef shared_ptr<FakeSink> FakeSinkPtr;
+
+  /// Adds a cell with a 10 byte value.
+  /// @return Serialized size of cell
+  size_t add_cell(IndexUpdateQueue &queue, const char *table_id,
+                  const String &row, int64_t revision) {
+    TableIdentifier table(table_id);
+    SchemaPtr schema;
+    DynamicBuffer keybuf;
+    create_key_and_append(keybuf, FLAG_INSERT, row.c_str(), 1, "", revision,
+                          revision);
+    SerializedKey serkey(keybuf.base);
+    Key key(serkey);
+    uint8_t valbuf[16];
+    uint8_t *ptr = valbuf;
+    Serialization::encode_vi32(&ptr, 10);
+    memset(ptr, 'v', 10);
+    queue.add(table, schema, key, ByteString(valbuf));
+    return key.length + (ptr - valbuf) + 10;
+  }
+
+  /// Returns serialized size of the cells added by add_cell().
+  size_t cell_size() {
+    IndexUpdateQueue queue(1000000, 60000, 1000000,
+                           make_shared<FakeSink>());
+    return add_cell(queue, "2", "row00", 1);
+  }
+
+  /// Waits for the earliest pending revision to become <code>revision</code>.
+  /// The background thread clears the revision of the batches it wrote
+  /// after the sink has returned, so it is polled.
+  bool wait_for_earliest_revision(IndexUpdateQueue &queue, int64_t revision) {
+    for (int i=0; i<1000; i++) {
+      if (queue.get_earliest_revision() == revision)
+        return true;
+      this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  /// Checks that cells are held until the flush size is reached and are
+  /// written in one batch per table.
+  void test_batching() {
+    FakeSinkPtr sink = make_shared<FakeSink>();
+    IndexUpdateQueue queue(10 * cell_size(), 60000, 1000000, sink);
+    for (int i=0; i<5; i++)
+      add_cell(queue, "2", format("row%02d", i), i + 1);
+    for (int i=5; i<9; i++)
+      add_cell(queue, "3", format("row%02d", i), i + 1);
+    this_thread::sleep_for(chrono::milliseconds(200));
+    HT_ASSERT(sink->batches() == 0);
+
+    // tenth cell reaches flush size
+    add_cell(queue, "3", "row09", 10);
+    HT_ASSERT(sink->wait_for_batches(2));
+    HT_ASSERT(sink->cells("2").size() == 5);
+    HT_ASSERT(sink->cells("3").size() == 5);
+    HT_ASSERT(sink->cells("3")[4] == "row09");
+    HT_ASSERT(wait_for_earliest_revision(queue, TIMESTAMP_MAX));
+  }
+
+  /// Checks that cells are written once the flush interval expires.
+  void test_flush_interval() {
+    FakeSinkPtr sink = make_shared<FakeSink>();
+    IndexUpdateQueue queue(1000000, 100, 1000000, sink);
+    add_cell(queue, "2", "row00", 1);
+    HT_ASSERT(sink->wait_for_batches(1));
+    HT_ASSERT(sink->cells("2").size() == 1);
+  }
+
+  /// Checks that failed batches are retried, merged with cells added in
+  /// the meantime, and written exactly once.
+  void test_retry() {
+    FakeSinkPtr sink = make_shared<FakeSink>();
+    sink->set_failures(1000000);
+    IndexUpdateQueue queue(1000000, 50, 1000000, sink);
+    add_cell(queue, "2", "row00", 5);
+    HT_ASSERT(sink->wait_for_writes(2));
+    add_cell(queue, "2", "row01", 6);
+    HT_ASSERT(sink->batches() == 0);
+    HT_ASSERT(queue.get_earliest_revision() == 5);
+
+    sink->set_failures(0);
+    HT_ASSERT(sink->wait_for_batches(1));
+    vector<String> cells = sink->cells("2");
+    sort(cells.begin(), cells.end());
+    HT_ASSERT(cells.size() == 2);
+    HT_ASSERT(cells[0] == "row00" && cells[1] == "row01");
+    HT_ASSERT(sink->batches() == 1);
+    HT_ASSERT(wait_for_earliest_revision(queue, TIMESTAMP_MAX));
+  }
+
+  /// Checks that the queue reports no capacity once buffered cells exceed
+  /// the memory limit, without waiting, and recovers after a flush.
+  void test_overload() {
+    FakeSinkPtr sink = make_shared<FakeSink>();
+    size_t size = cell_size();
+    IndexUpdateQueue queue(8 * size, 60000, 4 * size, sink);
+    int i = 0;
+    for (; i<4; i++) {
+      HT_ASSERT(queue.has_capacity());
+      add_cell(queue, "2", format("row%02d", i), i + 1);
+    }
+    auto start = chrono::steady_clock::now();
+    HT_ASSERT(!queue.has_capacity());
+    HT_ASSERT(chrono::steady_clock::now() - start < chrono::milliseconds(100));
+
+    // cells are still accepted, e.g. from commit log replay
+    for (; i<8; i++)
+      add_cell(queue, "2", format("row%02d", i), i + 1);
+    HT_ASSERT(sink->wait_for_batches(1));
+    HT_ASSERT(sink->cells("2").size() == 8);
+    HT_ASSERT(queue.has_capacity());
+  }
+
+  /// Checks that get_earliest_revision() covers buffered cells and cells
+  /// being written.
+  void test_earliest_revision() {
+    FakeSinkPtr sink = make_shared<FakeSink>();
+    sink->set_blocked(true);
+    IndexUpdateQueue queue(3 * cell_size(), 60000, 1000000, sink);
+    HT_ASSERT(queue.get_earliest_revision() == TIMESTAMP_MAX);
+    add_cell(queue, "2", "row00", 7);
+    add_cell(queue, "3", "row01", 3);
+    HT_ASSERT(queue.get_earliest_revision() == 3);
+
+    // third cell triggers a flush that blocks in the sink
+    add_cell(queue, "2", "row02", 9);
+    HT_ASSERT(sink->wait_for_writes(1));
+    HT_ASSERT(queue.get_earliest_revision() == 3);
+    add_cell(queue, "2", "row03", 11);
+    HT_ASSERT(queue.get_earliest_revision() == 3);
+
+    // after the write only the cell added meanwhile is pending
+    sink->set_blocked(false);
+    HT_ASSERT(sink->wait_for_batches(2));
+    HT_ASSERT(wait_for_earliest_revision(queue, 11));
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+
+  if (argc != 1)
+    Usage::dump_and_exit(usage);
+
+  test_batching();
+  test_flush_interval();
+  test_retry();
+  test_overload();
+  test_earliest_revision();
+
+  return 0;
+}
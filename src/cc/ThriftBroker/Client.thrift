@@ -864,6 +864,10 @@ service ClientService {
   CellsSerialized scanner_get_cells_serialized(1:Scanner scanner) throws (1:ClientException e),
   CellsSerialized next_cells_serialized(1:Scanner scanner) throws (1:ClientException e),
 
+  // Same as next_cells_serialized, but the buffer is encoded in the
+  // columnar layout read by ColumnarCellsReader
+  CellsSerialized next_cells_columnar(1:Scanner scanner) throws (1:ClientException e),
+
   /**
    * Iterate over rows of a scanner
    *
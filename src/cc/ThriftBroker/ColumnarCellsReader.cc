@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+#include <Common/Compat.h>
+
+#include "ColumnarCellsReader.h"
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+
+using namespace Hypertable;
+
+namespace {
+
+  /// Returns start of next section of <code>len</code> bytes and advances
+  /// <code>*ptr</code> past it and its alignment padding
+  const uint8_t *section(const uint8_t *base, const uint8_t **ptr,
+                         const uint8_t *end, size_t len) {
+    const uint8_t *start = *ptr;
+    if ((size_t)(end - start) < len)
+      HT_THROW(Error::SERIALIZATION_INPUT_OVERRUN,
+               "Truncated columnar cells buffer");
+    size_t offset = (start - base) + len;
+    offset += (8 - (offset & 7)) & 7;
+    *ptr = base + offset;
+    if (*ptr > end)
+      *ptr = end;
+    return start;
+  }
+
+  /// Checks that every dictionary entry is a non-empty run of bytes that
+  /// ends in a NUL terminator inside the string section
+  void check_dictionary(const uint8_t *offsets, const uint8_t *strings,
+                        uint32_t count) {
+    const uint8_t *ptr = offsets;
+    size_t remaining = 4*((size_t)count+1);
+    uint32_t previous = Serialization::decode_i32(&ptr, &remaining);
+    if (count > 0 && previous != 0)
+      HT_THROW(Error::BAD_FORMAT, "Corrupt columnar cells dictionary");
+    for (uint32_t i=0; i<count; i++) {
+      uint32_t offset = Serialization::decode_i32(&ptr, &remaining);
+      if (offset <= previous || strings[offset-1] != 0)
+        HT_THROWF(Error::BAD_FORMAT, "Corrupt columnar cells dictionary "
+                  "entry %u", (unsigned)i);
+      previous = offset;
+    }
+  }
+
+}
+
+
+void ColumnarCellsReader::init(const uint8_t *buf, uint32_t len) {
+  const uint8_t *ptr = buf;
+  const uint8_t *end = buf + len;
+  size_t remaining = len;
+
+  int32_t version = Serialization::decode_i32(&ptr, &remaining);
+  if (version != SerializedCellsVersion::COLUMNAR_VERSION)
+    HT_THROWF(Error::SERIALIZATION_VERSION_MISMATCH,
+              "Columnar cells version %d (expected %d)", (int)version,
+              (int)SerializedCellsVersion::COLUMNAR_VERSION);
+  m_flags = Serialization::decode_i32(&ptr, &remaining);
+  m_cell_count = Serialization::decode_i32(&ptr, &remaining);
+  m_row_count = Serialization::decode_i32(&ptr, &remaining);
+  m_family_count = Serialization::decode_i32(&ptr, &remaining);
+  m_qualifier_count = Serialization::decode_i32(&ptr, &remaining);
+  section(buf, &ptr, end, 0);
+
+  size_t n = m_cell_count;
+
+  m_row_offsets = section(buf, &ptr, end, 4*((size_t)m_row_count+1));
+  m_row_strings = section(buf, &ptr, end, get_u32(m_row_offsets, m_row_count));
+  m_family_offsets = section(buf, &ptr, end, 4*((size_t)m_family_count+1));
+  m_family_strings = section(buf, &ptr, end,
+                             get_u32(m_family_offsets, m_family_count));
+  m_qualifier_offsets = section(buf, &ptr, end, 4*((size_t)m_qualifier_count+1));
+  m_qualifier_strings = section(buf, &ptr, end,
+                                get_u32(m_qualifier_offsets, m_qualifier_count));
+  m_row_ids = section(buf, &ptr, end, 4*n);
+  m_family_ids = section(buf, &ptr, end, 4*n);
+  m_qualifier_ids = section(buf, &ptr, end, 4*n);
+  m_timestamp_deltas = section(buf, &ptr, end, 8*n);
+  m_cell_flags = section(buf, &ptr, end, n);
+  m_value_offsets = section(buf, &ptr, end, 4*(n+1));
+  m_values = section(buf, &ptr, end, get_u32(m_value_offsets, m_cell_count));
+
+  // Validate offsets and ids so that accessors never step outside the buffer
+  check_dictionary(m_row_offsets, m_row_strings, m_row_count);
+  check_dictionary(m_family_offsets, m_family_strings, m_family_count);
+  check_dictionary(m_qualifier_offsets, m_qualifier_strings,
+                   m_qualifier_count);
+  for (uint32_t i=0; i<m_cell_count; i++) {
+    if (get_u32(m_row_ids, i) >= m_row_count ||
+        get_u32(m_family_ids, i) >= m_family_count ||
+        get_u32(m_qualifier_ids, i) >= m_qualifier_count ||
+        get_u32(m_value_offsets, i) > get_u32(m_value_offsets, i+1))
+      HT_THROWF(Error::BAD_FORMAT, "Corrupt columnar cells buffer at cell %u",
+                (unsigned)i);
+  }
+
+  m_timestamps.resize(m_cell_count);
+  const uint8_t *deltas = m_timestamp_deltas;
+  remaining = 8*n;
+  uint64_t timestamp = 0;
+  for (uint32_t i=0; i<m_cell_count; i++) {
+    timestamp += (uint64_t)Serialization::decode_i64(&deltas, &remaining);
+    m_timestamps[i] = (int64_t)timestamp;
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef HYPERTABLE_COLUMNARCELLSREADER_H
+#define HYPERTABLE_COLUMNARCELLSREADER_H
+
+#include "Common/Serialization.h"
+
+#include "Hypertable/Lib/Cell.h"
+
+#include "SerializedCellsFlag.h"
+
+#include <vector>
+
+namespace Hypertable {
+
+  /** Random access reader for batches encoded by ColumnarCellsWriter.
+   * The reader does not copy the buffer; it must outlive the reader.
+   * Besides per-cell accessors, the raw streams are exposed so that they
+   * can be wrapped directly as arrays: row_ids(), family_ids() and
+   * qualifier_ids() are little-endian uint32 arrays of cell_count()
+   * entries, timestamp_deltas() is a little-endian int64 array whose
+   * running sum gives the timestamps, cell_flags() is a uint8 array and
+   * value_offsets() is a uint32 array of cell_count()+1 offsets into
+   * values().
+   */
+  class ColumnarCellsReader {
+  public:
+
+    ColumnarCellsReader(const void *buf, uint32_t len) {
+      init((const uint8_t *)buf, len);
+    }
+
+    uint32_t cell_count() const { return m_cell_count; }
+
+    const char *row(uint32_t i) const { return row_entry(row_id(i)); }
+    const char *column_family(uint32_t i) const {
+      return family_entry(get_u32(m_family_ids, i));
+    }
+    const char *column_qualifier(uint32_t i) const {
+      return qualifier_entry(get_u32(m_qualifier_ids, i));
+    }
+    int64_t timestamp(uint32_t i) const { return m_timestamps[i]; }
+    const void *value(uint32_t i) const {
+      return m_values + get_u32(m_value_offsets, i);
+    }
+    uint32_t value_len(uint32_t i) const {
+      return get_u32(m_value_offsets, i+1) - get_u32(m_value_offsets, i);
+    }
+    uint8_t cell_flag(uint32_t i) const { return m_cell_flags[i]; }
+
+    void get(uint32_t i, Cell &cell) const {
+      cell.row_key = row(i);
+      cell.column_family = column_family(i);
+      cell.column_qualifier = column_qualifier(i);
+      cell.timestamp = timestamp(i);
+      cell.revision = TIMESTAMP_NULL;
+      cell.value = (const uint8_t *)value(i);
+      cell.value_len = value_len(i);
+      cell.flag = cell_flag(i);
+    }
+
+    uint32_t row_id(uint32_t i) const { return get_u32(m_row_ids, i); }
+
+    uint32_t row_count() const { return m_row_count; }
+    const char *row_entry(uint32_t id) const {
+      return (const char *)m_row_strings + get_u32(m_row_offsets, id);
+    }
+    uint32_t family_count() const { return m_family_count; }
+    const char *family_entry(uint32_t id) const {
+      return (const char *)m_family_strings + get_u32(m_family_offsets, id);
+    }
+    uint32_t qualifier_count() const { return m_qualifier_count; }
+    const char *qualifier_entry(uint32_t id) const {
+      return (const char *)m_qualifier_strings + get_u32(m_qualifier_offsets, id);
+    }
+
+    const uint8_t *row_ids() const { return m_row_ids; }
+    const uint8_t *family_ids() const { return m_family_ids; }
+    const uint8_t *qualifier_ids() const { return m_qualifier_ids; }
+    const uint8_t *timestamp_deltas() const { return m_timestamp_deltas; }
+    const uint8_t *cell_flags() const { return m_cell_flags; }
+    const uint8_t *value_offsets() const { return m_value_offsets; }
+    const uint8_t *values() const { return m_values; }
+    uint32_t values_length() const { return get_u32(m_value_offsets, m_cell_count); }
+
+    uint32_t flags() const { return m_flags; }
+    bool eos() const { return (m_flags & SerializedCellsFlag::EOS) > 0; }
+
+  private:
+    void init(const uint8_t *buf, uint32_t len);
+
+    static uint32_t get_u32(const uint8_t *base, uint32_t i) {
+      const uint8_t *ptr = base + 4*(size_t)i;
+      size_t remaining = 4;
+      return Serialization::decode_i32(&ptr, &remaining);
+    }
+
+    uint32_t m_flags {};
+    uint32_t m_cell_count {};
+    uint32_t m_row_count {};
+    uint32_t m_family_count {};
+    uint32_t m_qualifier_count {};
+    const uint8_t *m_row_offsets {};
+    const uint8_t *m_row_strings {};
+    const uint8_t *m_family_offsets {};
+    const uint8_t *m_family_strings {};
+    const uint8_t *m_qualifier_offsets {};
+    const uint8_t *m_qualifier_strings {};
+    const uint8_t *m_row_ids {};
+    const uint8_t *m_family_ids {};
+    const uint8_t *m_qualifier_ids {};
+    const uint8_t *m_timestamp_deltas {};
+    const uint8_t *m_cell_flags {};
+    const uint8_t *m_value_offsets {};
+    const uint8_t *m_values {};
+    std::vector<int64_t> m_timestamps;
+  };
+
+}
+
+#endif // HYPERTABLE_COLUMNARCELLSREADER_H
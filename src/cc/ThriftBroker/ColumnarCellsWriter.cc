@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+#include "Common/Compat.h"
+#include "Common/Error.h"
+#include "Common/Logger.h"
+#include "Common/Serialization.h"
+
+#include "ColumnarCellsWriter.h"
+#include "SerializedCellsReader.h"
+
+using namespace Hypertable;
+
+namespace {
+
+  void append_i32(DynamicBuffer &buf, uint32_t ival) {
+    buf.ensure(4);
+    Serialization::encode_i32(&buf.ptr, ival);
+  }
+
+  void pad(DynamicBuffer &buf) {
+    size_t padding = (8 - (buf.fill() & 7)) & 7;
+    buf.ensure(padding);
+    memset(buf.ptr, 0, padding);
+    buf.ptr += padding;
+  }
+
+  void append_section(DynamicBuffer &dst, const DynamicBuffer &src) {
+    dst.ensure(src.fill());
+    if (src.fill()) {
+      memcpy(dst.ptr, src.base, src.fill());
+      dst.ptr += src.fill();
+    }
+    pad(dst);
+  }
+
+}
+
+
+void ColumnarCellsWriter::add(const char *row, const char *column_family,
+                              const char *column_qualifier, int64_t timestamp,
+                              const void *value, int32_t value_length,
+                              uint8_t cell_flag) {
+  size_t row_length = strlen(row);
+
+  if (row_length == 0)
+    HT_THROW(Error::INVALID_ARGUMENT,
+             "Attempt to add empty row key to columnar cells buffer");
+
+  if (!value && value_length)
+    value_length = 0;
+
+  if (m_rows.size() == 0 || row_length != m_previous_row.length() ||
+      memcmp(row, m_previous_row.data(), row_length)) {
+    m_rows.append(row, row_length);
+    m_previous_row.assign(row, row_length);
+  }
+  append_i32(m_row_ids, m_rows.size() - 1);
+
+  append_i32(m_family_ids, m_families.lookup(column_family ? column_family : "",
+      column_family ? strlen(column_family) : 0));
+
+  append_i32(m_qualifier_ids,
+      m_qualifiers.lookup(column_qualifier ? column_qualifier : "",
+                          column_qualifier ? strlen(column_qualifier) : 0));
+
+  // Differences are taken modulo 2^64 so that sentinel timestamps such as
+  // TIMESTAMP_NULL round trip through a plain running sum
+  m_timestamps.ensure(8);
+  Serialization::encode_i64(&m_timestamps.ptr,
+      (uint64_t)timestamp - (uint64_t)m_previous_timestamp);
+  m_previous_timestamp = timestamp;
+
+  m_cell_flags.ensure(1);
+  *m_cell_flags.ptr++ = cell_flag;
+
+  if (m_value_offsets.empty())
+    append_i32(m_value_offsets, 0);
+  m_values.ensure(value_length);
+  if (value_length) {
+    memcpy(m_values.ptr, value, value_length);
+    m_values.ptr += value_length;
+  }
+  append_i32(m_value_offsets, m_values.fill());
+
+  m_cell_count++;
+}
+
+
+size_t ColumnarCellsWriter::add_serialized(const uint8_t *buf, size_t len) {
+  SerializedCellsReader reader((void *)buf, len);
+  size_t count = 0;
+  while (reader.next()) {
+    add(reader.row(), reader.column_family(), reader.column_qualifier(),
+        reader.timestamp(), reader.value(), reader.value_len(),
+        reader.cell_flag());
+    count++;
+  }
+  if (reader.eos())
+    m_flag |= SerializedCellsFlag::EOS;
+  return count;
+}
+
+
+void ColumnarCellsWriter::finalize(uint32_t flag) {
+  m_buf.clear();
+  m_buf.reserve(32 + m_values.fill() + m_value_offsets.fill() +
+                m_cell_count * 21);
+
+  Serialization::encode_i32(&m_buf.ptr,
+                            SerializedCellsVersion::COLUMNAR_VERSION);
+  Serialization::encode_i32(&m_buf.ptr, m_flag | flag);
+  Serialization::encode_i32(&m_buf.ptr, m_cell_count);
+  Serialization::encode_i32(&m_buf.ptr, m_rows.size());
+  Serialization::encode_i32(&m_buf.ptr, m_families.size());
+  Serialization::encode_i32(&m_buf.ptr, m_qualifiers.size());
+  pad(m_buf);
+
+  m_rows.encode(m_buf);
+  m_families.encode(m_buf);
+  m_qualifiers.encode(m_buf);
+  append_section(m_buf, m_row_ids);
+  append_section(m_buf, m_family_ids);
+  append_section(m_buf, m_qualifier_ids);
+  append_section(m_buf, m_timestamps);
+  append_section(m_buf, m_cell_flags);
+  if (m_value_offsets.empty())
+    append_i32(m_value_offsets, 0);
+  append_section(m_buf, m_value_offsets);
+  append_section(m_buf, m_values);
+}
+
+
+void ColumnarCellsWriter::clear() {
+  m_rows.clear();
+  m_families.clear();
+  m_qualifiers.clear();
+  m_row_ids.clear();
+  m_family_ids.clear();
+  m_qualifier_ids.clear();
+  m_timestamps.clear();
+  m_cell_flags.clear();
+  m_value_offsets.clear();
+  m_values.clear();
+  m_buf.clear();
+  m_previous_row.clear();
+  m_previous_timestamp = 0;
+  m_cell_count = 0;
+  m_flag = 0;
+}
+
+
+uint32_t ColumnarCellsWriter::Dictionary::lookup(const char *str, size_t len) {
+  auto iter = m_ids.find(std::string(str, len));
+  if (iter != m_ids.end())
+    return iter->second;
+  uint32_t id = append(str, len);
+  m_ids[std::string(str, len)] = id;
+  return id;
+}
+
+
+uint32_t ColumnarCellsWriter::Dictionary::append(const char *str, size_t len) {
+  if (m_offsets.empty())
+    append_i32(m_offsets, 0);
+  m_strings.ensure(len + 1);
+  memcpy(m_strings.ptr, str, len);
+  m_strings.ptr += len;
+  *m_strings.ptr++ = 0;
+  append_i32(m_offsets, m_strings.fill());
+  return m_count++;
+}
+
+
+void ColumnarCellsWriter::Dictionary::encode(DynamicBuffer &dst) {
+  if (m_offsets.empty())
+    append_i32(m_offsets, 0);
+  append_section(dst, m_offsets);
+  append_section(dst, m_strings);
+}
+
+
+void ColumnarCellsWriter::Dictionary::clear() {
+  m_ids.clear();
+  m_offsets.clear();
+  m_strings.clear();
+  m_count = 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef HYPERTABLE_COLUMNARCELLSWRITER_H
+#define HYPERTABLE_COLUMNARCELLSWRITER_H
+
+#include "Common/DynamicBuffer.h"
+
+#include "Hypertable/Lib/Cell.h"
+#include "Hypertable/Lib/KeySpec.h"
+
+#include "SerializedCellsFlag.h"
+
+#include <string>
+#include <unordered_map>
+
+namespace Hypertable {
+
+  /** Encodes cells into a columnar batch.
+   * Where SerializedCellsWriter lays cells out one after the other, this
+   * class keeps each key component in its own stream so that a batch can
+   * be handed to array-oriented consumers (e.g. numpy) without walking it
+   * cell by cell.  The encoded batch has the following layout, with all
+   * integers little-endian and every section starting on an 8-byte
+   * boundary:
+   * <pre>
+   *   i32 version (SerializedCellsVersion::COLUMNAR_VERSION)
+   *   u32 flags (SerializedCellsFlag::EOS etc.)
+   *   u32 cell count (N)
+   *   u32 row dictionary size (R)
+   *   u32 column family dictionary size (F)
+   *   u32 column qualifier dictionary size (Q)
+   *   u32 offsets[R+1], row strings     (NUL-terminated)
+   *   u32 offsets[F+1], family strings  (NUL-terminated)
+   *   u32 offsets[Q+1], qualifier strings (NUL-terminated)
+   *   u32 row ids[N]
+   *   u32 family ids[N]
+   *   u32 qualifier ids[N]
+   *   i64 timestamps[N] (first absolute, then deltas to the previous one)
+   *   u8  cell flags[N]
+   *   u32 value offsets[N+1], value bytes
+   * </pre>
+   * Column families and qualifiers are dictionary coded over the whole
+   * batch.  Row keys are run-length dictionary coded: a new row
+   * dictionary entry is added each time the row changes, which for
+   * scanner output (sorted by row) yields one entry per distinct row.
+   */
+  class ColumnarCellsWriter {
+  public:
+
+    ColumnarCellsWriter() { }
+
+    void add(const Cell &cell) {
+      add(cell.row_key, cell.column_family, cell.column_qualifier,
+          cell.timestamp, cell.value, cell.value_len, cell.flag);
+    }
+
+    /** Adds a cell to the batch.
+     * @param row Row key (must not be empty)
+     * @param column_family Column family or 0
+     * @param column_qualifier Column qualifier or 0
+     * @param timestamp Cell timestamp
+     * @param value Pointer to value data
+     * @param value_length Length of value data
+     * @param cell_flag Cell flag (e.g. FLAG_INSERT)
+     */
+    void add(const char *row, const char *column_family,
+             const char *column_qualifier, int64_t timestamp,
+             const void *value, int32_t value_length,
+             uint8_t cell_flag = FLAG_INSERT);
+
+    /** Adds every cell in a SerializedCellsWriter encoded buffer.
+     * If the buffer carries the SerializedCellsFlag::EOS flag it is
+     * carried over to the flags passed to finalize().
+     * @param buf Serialized cells buffer
+     * @param len Length of buffer
+     * @return Number of cells added
+     */
+    size_t add_serialized(const uint8_t *buf, size_t len);
+
+    /** Assembles the encoded batch.
+     * @param flag Flags to store in the header
+     */
+    void finalize(uint32_t flag = 0);
+
+    uint8_t *get_buffer() { return m_buf.base; }
+    int32_t get_buffer_length() { return m_buf.fill(); }
+
+    /// Returns the number of cells added since the last clear()
+    uint32_t cell_count() const { return m_cell_count; }
+
+    bool empty() const { return m_cell_count == 0; }
+
+    void clear();
+
+  private:
+
+    /// String dictionary with NUL-terminated entries
+    class Dictionary {
+    public:
+      uint32_t lookup(const char *str, size_t len);
+      uint32_t append(const char *str, size_t len);
+      uint32_t size() const { return m_count; }
+      void encode(DynamicBuffer &dst);
+      void clear();
+    private:
+      std::unordered_map<std::string, uint32_t> m_ids;
+      DynamicBuffer m_offsets;
+      DynamicBuffer m_strings;
+      uint32_t m_count {};
+    };
+
+    Dictionary m_rows;
+    Dictionary m_families;
+    Dictionary m_qualifiers;
+    DynamicBuffer m_row_ids;
+    DynamicBuffer m_family_ids;
+    DynamicBuffer m_qualifier_ids;
+    DynamicBuffer m_timestamps;
+    DynamicBuffer m_cell_flags;
+    DynamicBuffer m_value_offsets;
+    DynamicBuffer m_values;
+    DynamicBuffer m_buf;
+    std::string m_previous_row;
+    int64_t m_previous_timestamp {};
+    uint32_t m_cell_count {};
+    uint32_t m_flag {};
+  };
+
+}
+
+#endif // HYPERTABLE_COLUMNARCELLSWRITER_H
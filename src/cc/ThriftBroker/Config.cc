@@ -55,10 +55,18 @@ void init_thrift_broker_options() {
     ("pidfile", str(), "File to contain the process id")
     ("log-api", boo()->default_value(false), "Enable or disable API logging")
     ("workers", i32()->default_value(50), "Worker threads")
+    ("nonblocking", boo()->default_value(false), "Serve connections from "
+        "event-driven I/O threads and dispatch requests to a pool of "
+        "--workers threads instead of running one thread per connection "
+        "(not supported on Windows)")
+    ("io-threads", i32()->default_value(4), "Number of I/O threads in "
+        "nonblocking mode")
     ;
   alias("port", "ThriftBroker.Port");
   alias("log-api", "ThriftBroker.API.Logging");
   alias("workers", "ThriftBroker.Workers");
+  alias("nonblocking", "ThriftBroker.NonBlocking");
+  alias("io-threads", "ThriftBroker.IOThreads");
   // hidden aliases
   alias("thrift-timeout", "ThriftBroker.Timeout");
 }
@@ -35,7 +35,9 @@ namespace Hypertable {
 
   namespace SerializedCellsVersion {
     enum {
-      SCVERSION        = 0x01
+      SCVERSION        = 0x01,
+      /// Columnar encoding written by ColumnarCellsWriter
+      COLUMNAR_VERSION = 0x02
     };
   }
 }
@@ -25,6 +25,7 @@
 
 #include <Common/Compat.h>
 
+#include <ThriftBroker/ColumnarCellsWriter.h>
 #include <ThriftBroker/Config.h>
 #include <ThriftBroker/MetricsHandler.h>
 #include <ThriftBroker/SerializedCellsReader.h>
@@ -49,8 +50,12 @@
 #include <Common/System.h>
 #include <Common/Time.h>
 
+#include <concurrency/PlatformThreadFactory.h>
 #include <concurrency/ThreadManager.h>
 #include <protocol/TBinaryProtocol.h>
+#ifndef _WIN32
+#include <server/TNonblockingServer.h>
+#endif
 #include <server/TThreadedServer.h>
 #include <transport/TBufferTransports.h>
 #include <transport/TServerSocket.h>
@@ -1423,6 +1428,33 @@ public:
     scanner_get_cells_serialized(result, scanner_id);
   }
 
+  void next_cells_columnar(CellsSerialized &result,
+          const Scanner scanner_id) override {
+    LOG_API_START("scanner="<< scanner_id);
+
+    try {
+      ColumnarCellsWriter writer;
+      Hypertable::Cell cell;
+      uint32_t flag = SerializedCellsFlag::EOB;
+      size_t amount = 0;
+
+      TableScanner *scanner = get_scanner(scanner_id, scanner_info);
+
+      while (amount < m_context.next_threshold) {
+        if (!scanner->next(cell)) {
+          flag = SerializedCellsFlag::EOS;
+          break;
+        }
+        writer.add(cell);
+        amount += strlen(cell.row_key) + cell.value_len + 8 + 4 + 1;
+      }
+      writer.finalize(flag);
+
+      result = String((char *)writer.get_buffer(), writer.get_buffer_length());
+    } RETHROW("scanner="<< scanner_id);
+    LOG_API_FINISH_E("result.size="<< result.size());
+  }
+
   void scanner_get_row(ThriftCells &result, const Scanner scanner_id) override {
     LOG_API_START("scanner="<< scanner_id <<" result.size="<< result.size());
     try {
@@ -3189,23 +3221,59 @@ int main(int argc, char **argv) {
     boost::shared_ptr<HqlServiceIfFactory> hql_service_factory(new ThriftBrokerIfFactory());
     boost::shared_ptr<TProcessorFactory> hql_service_processor_factory(new HqlServiceProcessorFactory(hql_service_factory));
 
-    boost::shared_ptr<TServerTransport> serverTransport;
-
-    int timeout_ms = 0;
-    if (has("thrift-timeout"))
-      timeout_ms = get_i32("thrift-timeout");
-    else if (has("timeout"))
-      timeout_ms = get_i32("timeout");
-    TServerSocket* serverSocket = new TServerSocket(port, timeout_ms, 0);
-    serverSocket->setTcpSendBuffer(4*32768);
-    serverSocket->setTcpRecvBuffer(4*32768);
-    serverSocket->setKeepAlive(true);
-    serverTransport.reset( serverSocket );
+    boost::shared_ptr<TServer> server;
+    bool nonblocking = get_bool("ThriftBroker.NonBlocking");
 
-    boost::shared_ptr<TTransportFactory> transportFactory(new TFramedTransportFactory());
+#ifdef _WIN32
+    // TNonblockingServer needs libevent, which the Windows build lacks
+    if (nonblocking) {
+      HT_WARN("Nonblocking server not supported on Windows, using threaded "
+              "server");
+      nonblocking = false;
+    }
+#else
+    if (nonblocking) {
+      // Connections are multiplexed over a few libevent I/O threads and
+      // requests are handed to a bounded worker pool; idle connections
+      // no longer cost a thread.  Clients must use framed transport,
+      // which all of our client libraries already do.
+      int32_t workers = std::max(1, get_i32("ThriftBroker.Workers"));
+      int32_t io_threads = std::max(1, get_i32("ThriftBroker.IOThreads"));
+      boost::shared_ptr<ThreadManager> thread_manager =
+        ThreadManager::newSimpleThreadManager(workers);
+      thread_manager->threadFactory(
+        boost::shared_ptr<PlatformThreadFactory>(new PlatformThreadFactory()));
+      thread_manager->start();
+      TNonblockingServer *nb_server =
+        new TNonblockingServer(hql_service_processor_factory,
+                               protocolFactory, port, thread_manager);
+      nb_server->setNumIOThreads(io_threads);
+      server.reset(nb_server);
+      HT_INFOF("Using nonblocking server with %d I/O threads and %d workers",
+               (int)io_threads, (int)workers);
+    }
+#endif
 
-    TThreadedServer server(hql_service_processor_factory, serverTransport,
-                           transportFactory, protocolFactory);
+    if (!nonblocking) {
+      boost::shared_ptr<TServerTransport> serverTransport;
+
+      int timeout_ms = 0;
+      if (has("thrift-timeout"))
+        timeout_ms = get_i32("thrift-timeout");
+      else if (has("timeout"))
+        timeout_ms = get_i32("timeout");
+      TServerSocket* serverSocket = new TServerSocket(port, timeout_ms, 0);
+      serverSocket->setTcpSendBuffer(4*32768);
+      serverSocket->setTcpRecvBuffer(4*32768);
+      serverSocket->setKeepAlive(true);
+      serverTransport.reset( serverSocket );
+
+      boost::shared_ptr<TTransportFactory> transportFactory(new TFramedTransportFactory());
+
+      server.reset(new TThreadedServer(hql_service_processor_factory,
+                                       serverTransport, transportFactory,
+                                       protocolFactory));
+    }
 
     #ifdef _WIN32
     server_launch_event.set_event();
@@ -3213,7 +3281,7 @@ int main(int argc, char **argv) {
 
     HT_INFO("Starting the server...");
 
-    server.serve();
+    server->serve();
     
     g_metrics_handler->start_collecting();
     g_metrics_handler.reset();
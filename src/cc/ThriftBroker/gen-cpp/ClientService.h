@@ -256,6 +256,8 @@ class ClientServiceIf {
   virtual void scanner_get_cells_serialized(CellsSerialized& _return, const Scanner scanner) = 0;
   virtual void next_cells_serialized(CellsSerialized& _return, const Scanner scanner) = 0;
 
+  virtual void next_cells_columnar(CellsSerialized& _return, const Scanner scanner) = 0;
+
   /**
    * Iterate over rows of a scanner
    * 
@@ -1098,6 +1100,9 @@ class ClientServiceNull : virtual public ClientServiceIf {
   void next_cells_serialized(CellsSerialized& /* _return */, const Scanner /* scanner */) {
     return;
   }
+  void next_cells_columnar(CellsSerialized& /* _return */, const Scanner /* scanner */) {
+    return;
+  }
   void scanner_get_row(std::vector<Cell> & /* _return */, const Scanner /* scanner */) {
     return;
   }
@@ -5966,6 +5971,118 @@ class ClientService_next_cells_serialized_presult {
 
 };
 
+typedef struct _ClientService_next_cells_columnar_args__isset {
+  _ClientService_next_cells_columnar_args__isset() : scanner(false) {}
+  bool scanner :1;
+} _ClientService_next_cells_columnar_args__isset;
+
+class ClientService_next_cells_columnar_args {
+ public:
+
+  ClientService_next_cells_columnar_args(const ClientService_next_cells_columnar_args&);
+  ClientService_next_cells_columnar_args& operator=(const ClientService_next_cells_columnar_args&);
+  ClientService_next_cells_columnar_args() : scanner(0) {
+  }
+
+  virtual ~ClientService_next_cells_columnar_args() throw();
+  Scanner scanner;
+
+  _ClientService_next_cells_columnar_args__isset __isset;
+
+  void __set_scanner(const Scanner val);
+
+  bool operator == (const ClientService_next_cells_columnar_args & rhs) const
+  {
+    if (!(scanner == rhs.scanner))
+      return false;
+    return true;
+  }
+  bool operator != (const ClientService_next_cells_columnar_args &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ClientService_next_cells_columnar_args & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+
+class ClientService_next_cells_columnar_pargs {
+ public:
+
+
+  virtual ~ClientService_next_cells_columnar_pargs() throw();
+  const Scanner* scanner;
+
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _ClientService_next_cells_columnar_result__isset {
+  _ClientService_next_cells_columnar_result__isset() : success(false), e(false) {}
+  bool success :1;
+  bool e :1;
+} _ClientService_next_cells_columnar_result__isset;
+
+class ClientService_next_cells_columnar_result {
+ public:
+
+  ClientService_next_cells_columnar_result(const ClientService_next_cells_columnar_result&);
+  ClientService_next_cells_columnar_result& operator=(const ClientService_next_cells_columnar_result&);
+  ClientService_next_cells_columnar_result() : success() {
+  }
+
+  virtual ~ClientService_next_cells_columnar_result() throw();
+  CellsSerialized success;
+  ClientException e;
+
+  _ClientService_next_cells_columnar_result__isset __isset;
+
+  void __set_success(const CellsSerialized& val);
+
+  void __set_e(const ClientException& val);
+
+  bool operator == (const ClientService_next_cells_columnar_result & rhs) const
+  {
+    if (!(success == rhs.success))
+      return false;
+    if (!(e == rhs.e))
+      return false;
+    return true;
+  }
+  bool operator != (const ClientService_next_cells_columnar_result &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator < (const ClientService_next_cells_columnar_result & ) const;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+  uint32_t write(::apache::thrift::protocol::TProtocol* oprot) const;
+
+};
+
+typedef struct _ClientService_next_cells_columnar_presult__isset {
+  _ClientService_next_cells_columnar_presult__isset() : success(false), e(false) {}
+  bool success :1;
+  bool e :1;
+} _ClientService_next_cells_columnar_presult__isset;
+
+class ClientService_next_cells_columnar_presult {
+ public:
+
+
+  virtual ~ClientService_next_cells_columnar_presult() throw();
+  CellsSerialized* success;
+  ClientException e;
+
+  _ClientService_next_cells_columnar_presult__isset __isset;
+
+  uint32_t read(::apache::thrift::protocol::TProtocol* iprot);
+
+};
+
 typedef struct _ClientService_scanner_get_row_args__isset {
   _ClientService_scanner_get_row_args__isset() : scanner(false) {}
   bool scanner :1;
@@ -15962,6 +16079,9 @@ class ClientServiceClient : virtual public ClientServiceIf {
   void next_cells_serialized(CellsSerialized& _return, const Scanner scanner);
   void send_next_cells_serialized(const Scanner scanner);
   void recv_next_cells_serialized(CellsSerialized& _return);
+  void next_cells_columnar(CellsSerialized& _return, const Scanner scanner);
+  void send_next_cells_columnar(const Scanner scanner);
+  void recv_next_cells_columnar(CellsSerialized& _return);
   void scanner_get_row(std::vector<Cell> & _return, const Scanner scanner);
   void send_scanner_get_row(const Scanner scanner);
   void recv_scanner_get_row(std::vector<Cell> & _return);
@@ -16273,6 +16393,7 @@ class ClientServiceProcessor : public ::apache::thrift::TDispatchProcessor {
   void process_next_cells_as_arrays(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_scanner_get_cells_serialized(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_next_cells_serialized(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
+  void process_next_cells_columnar(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_scanner_get_row(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_next_row(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
   void process_scanner_get_row_as_arrays(int32_t seqid, ::apache::thrift::protocol::TProtocol* iprot, ::apache::thrift::protocol::TProtocol* oprot, void* callContext);
@@ -16402,6 +16523,7 @@ class ClientServiceProcessor : public ::apache::thrift::TDispatchProcessor {
     processMap_["next_cells_as_arrays"] = &ClientServiceProcessor::process_next_cells_as_arrays;
     processMap_["scanner_get_cells_serialized"] = &ClientServiceProcessor::process_scanner_get_cells_serialized;
     processMap_["next_cells_serialized"] = &ClientServiceProcessor::process_next_cells_serialized;
+    processMap_["next_cells_columnar"] = &ClientServiceProcessor::process_next_cells_columnar;
     processMap_["scanner_get_row"] = &ClientServiceProcessor::process_scanner_get_row;
     processMap_["next_row"] = &ClientServiceProcessor::process_next_row;
     processMap_["scanner_get_row_as_arrays"] = &ClientServiceProcessor::process_scanner_get_row_as_arrays;
@@ -16896,6 +17018,16 @@ class ClientServiceMultiface : virtual public ClientServiceIf {
     return;
   }
 
+  void next_cells_columnar(CellsSerialized& _return, const Scanner scanner) {
+    size_t sz = ifaces_.size();
+    size_t i = 0;
+    for (; i < (sz - 1); ++i) {
+      ifaces_[i]->next_cells_columnar(_return, scanner);
+    }
+    ifaces_[i]->next_cells_columnar(_return, scanner);
+    return;
+  }
+
   void scanner_get_row(std::vector<Cell> & _return, const Scanner scanner) {
     size_t sz = ifaces_.size();
     size_t i = 0;
@@ -17844,6 +17976,9 @@ class ClientServiceConcurrentClient : virtual public ClientServiceIf {
   void next_cells_serialized(CellsSerialized& _return, const Scanner scanner);
   int32_t send_next_cells_serialized(const Scanner scanner);
   void recv_next_cells_serialized(CellsSerialized& _return, const int32_t seqid);
+  void next_cells_columnar(CellsSerialized& _return, const Scanner scanner);
+  int32_t send_next_cells_columnar(const Scanner scanner);
+  void recv_next_cells_columnar(CellsSerialized& _return, const int32_t seqid);
   void scanner_get_row(std::vector<Cell> & _return, const Scanner scanner);
   int32_t send_scanner_get_row(const Scanner scanner);
   void recv_scanner_get_row(std::vector<Cell> & _return, const int32_t seqid);
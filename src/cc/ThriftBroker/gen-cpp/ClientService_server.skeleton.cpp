@@ -397,6 +397,11 @@ class ClientServiceHandler : virtual public ClientServiceIf {
     printf("next_cells_serialized\n");
   }
 
+  void next_cells_columnar(CellsSerialized& _return, const Scanner scanner) {
+    // Your implementation goes here
+    printf("next_cells_columnar\n");
+  }
+
   /**
    * Iterate over rows of a scanner
    * 
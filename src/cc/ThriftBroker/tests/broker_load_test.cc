@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <Common/Compat.h>
+
+#include <ThriftBroker/Client.h>
+#include <ThriftBroker/gen-cpp/HqlService.h>
+
+#include <Common/Stopwatch.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+namespace {
+
+  const char *usage[] = {
+    "usage: broker_load_test [options]",
+    "",
+    "Opens a large number of connections to a running ThriftBroker and drives",
+    "a stream of namespace_exists() requests across all of them, reporting",
+    "requests/sec and, if --broker-pid is given, the broker's resident set",
+    "size and thread count.  Run it once against a broker started normally",
+    "and once against one started with --nonblocking to compare the two",
+    "server modes.  Large connection counts require a raised file descriptor",
+    "limit (ulimit -n) on both sides.",
+    "",
+    "Exits with status 1 if a round opens no connections, completes no",
+    "requests, or sees request errors.",
+    "",
+    "options:",
+    "  --host <host>           Broker host (default: localhost)",
+    "  --port <port>           Broker port (default: 15867)",
+    "  --connections <n,...>   Connection counts to test (default: 1000,5000)",
+    "  --threads <n>           Client threads issuing requests (default: 16)",
+    "  --duration <sec>        Seconds to run each round (default: 10)",
+    "  --broker-pid <pid>      Broker pid, for RSS and thread count",
+    (const char *)0
+  };
+
+  void print_usage() {
+    for (size_t i=0; usage[i]; i++)
+      cout << usage[i] << "\n";
+    cout << flush;
+  }
+
+  /// Reads a field such as VmRSS or Threads from /proc/<pid>/status
+  string proc_status_field(int pid, const char *field) {
+    ostringstream path;
+    path << "/proc/" << pid << "/status";
+    ifstream in(path.str().c_str());
+    string line;
+    size_t len = strlen(field);
+    while (getline(in, line)) {
+      if (line.compare(0, len, field) == 0 && line.size() > len &&
+          line[len] == ':') {
+        size_t start = line.find_first_not_of(" \t", len+1);
+        return start == string::npos ? string() : line.substr(start);
+      }
+    }
+    return "n/a";
+  }
+
+  /// Runs one round and returns <i>false</i> if it failed
+  bool run_round(const string &host, int port, size_t connections,
+                 size_t threads, int duration, int broker_pid) {
+    vector<unique_ptr<Thrift::Client>> clients;
+    clients.reserve(connections);
+
+    Stopwatch connect_timer;
+    try {
+      for (size_t i=0; i<connections; i++)
+        clients.push_back(unique_ptr<Thrift::Client>(new Thrift::Client(host, port)));
+    }
+    catch (std::exception &e) {
+      cout << "Only opened " << clients.size() << " of " << connections
+           << " connections: " << e.what() << endl;
+      if (clients.empty())
+        return false;
+    }
+    connect_timer.stop();
+
+    atomic<bool> done(false);
+    atomic<uint64_t> requests(0);
+    atomic<uint64_t> errors(0);
+    vector<thread> workers;
+
+    if (threads > clients.size())
+      threads = clients.size();
+
+    Stopwatch run_timer;
+    for (size_t t=0; t<threads; t++) {
+      workers.push_back(thread([&, t]() {
+            uint64_t count = 0;
+            size_t i = t;
+            while (!done) {
+              try {
+                clients[i]->namespace_exists("sys");
+                count++;
+              }
+              catch (std::exception &) {
+                errors++;
+              }
+              // Each thread owns every threads'th connection
+              i += threads;
+              if (i >= clients.size())
+                i = t;
+            }
+            requests += count;
+          }));
+    }
+
+    this_thread::sleep_for(chrono::seconds(duration));
+    string rss, broker_threads;
+    if (broker_pid) {
+      rss = proc_status_field(broker_pid, "VmRSS");
+      broker_threads = proc_status_field(broker_pid, "Threads");
+    }
+    done = true;
+    for (auto &w : workers)
+      w.join();
+    run_timer.stop();
+
+    cout << "connections=" << clients.size()
+         << " connect_time=" << connect_timer.elapsed() << "s"
+         << " requests=" << requests
+         << " errors=" << errors
+         << " req/s=" << (uint64_t)(requests / run_timer.elapsed());
+    if (broker_pid)
+      cout << " broker_rss=" << rss << " broker_threads=" << broker_threads;
+    cout << endl;
+
+    return requests > 0 && errors == 0;
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  string host = "localhost";
+  int port = 15867;
+  vector<size_t> connection_counts;
+  size_t threads = 16;
+  int duration = 10;
+  int broker_pid = 0;
+
+  for (int i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+      print_usage();
+      return 0;
+    }
+    if (i+1 == argc) {
+      print_usage();
+      return 1;
+    }
+    if (!strcmp(argv[i], "--host"))
+      host = argv[++i];
+    else if (!strcmp(argv[i], "--port"))
+      port = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--connections")) {
+      istringstream in(argv[++i]);
+      string count;
+      while (getline(in, count, ','))
+        connection_counts.push_back(strtoul(count.c_str(), 0, 10));
+    }
+    else if (!strcmp(argv[i], "--threads"))
+      threads = strtoul(argv[++i], 0, 10);
+    else if (!strcmp(argv[i], "--duration"))
+      duration = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--broker-pid"))
+      broker_pid = atoi(argv[++i]);
+    else {
+      print_usage();
+      return 1;
+    }
+  }
+
+  if (connection_counts.empty()) {
+    connection_counts.push_back(1000);
+    connection_counts.push_back(5000);
+  }
+  if (threads == 0)
+    threads = 1;
+
+  bool ok = true;
+  for (size_t count : connection_counts)
+    if (!run_round(host, port, count, threads, duration, broker_pid))
+      ok = false;
+
+  return ok ? 0 : 1;
+}
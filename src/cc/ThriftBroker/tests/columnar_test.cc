@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Hypertable. If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include <Common/Compat.h>
+
+#include <ThriftBroker/ColumnarCellsReader.h>
+#include <ThriftBroker/ColumnarCellsWriter.h>
+#include <ThriftBroker/SerializedCellsReader.h>
+#include <ThriftBroker/SerializedCellsWriter.h>
+
+#include <Common/Error.h>
+#include <Common/Logger.h>
+#include <Common/Stopwatch.h>
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Hypertable;
+using namespace std;
+
+/**
+ * Round trips cells through SerializedCellsWriter and ColumnarCellsWriter
+ * and checks that ColumnarCellsReader returns them unchanged.
+ */
+
+namespace {
+
+  struct TestCell {
+    string row;
+    string family;
+    string qualifier;
+    int64_t timestamp;
+    string value;
+    uint8_t flag;
+  };
+
+  void generate(vector<TestCell> &cells) {
+    const char *families[] = { "a", "b", "tag" };
+    char buf[64];
+    for (int r=0; r<500; r++) {
+      sprintf(buf, "row%06d", r);
+      string row = buf;
+      for (int c=0; c<6; c++) {
+        TestCell cell;
+        cell.row = row;
+        cell.family = families[c % 3];
+        sprintf(buf, "q%d", c / 3);
+        cell.qualifier = (c == 5) ? "" : buf;
+        cell.timestamp = 1400000000000000000LL + r*1000 - c;
+        sprintf(buf, "value-%d-%d", r, c);
+        cell.value = (c == 4) ? "" : buf;
+        cell.flag = FLAG_INSERT;
+        cells.push_back(cell);
+      }
+    }
+    // Extreme timestamps must survive delta coding
+    cells[7].timestamp = TIMESTAMP_MIN;
+    cells[8].timestamp = TIMESTAMP_MAX;
+    cells[9].timestamp = AUTO_ASSIGN;
+  }
+
+  void verify(const vector<TestCell> &cells, ColumnarCellsReader &reader) {
+    HT_ASSERT(reader.cell_count() == cells.size());
+    HT_ASSERT(reader.family_count() == 3);
+    HT_ASSERT(reader.row_count() == 500);
+    for (uint32_t i=0; i<reader.cell_count(); i++) {
+      const TestCell &expected = cells[i];
+      HT_ASSERT(expected.row == reader.row(i));
+      HT_ASSERT(expected.family == reader.column_family(i));
+      HT_ASSERT(expected.qualifier == reader.column_qualifier(i));
+      HT_ASSERT(expected.timestamp == reader.timestamp(i));
+      HT_ASSERT(expected.value.length() == reader.value_len(i));
+      HT_ASSERT(!memcmp(expected.value.data(), reader.value(i),
+                        expected.value.length()));
+      HT_ASSERT(expected.flag == reader.cell_flag(i));
+    }
+  }
+
+}
+
+
+int main(int argc, char **argv) {
+  vector<TestCell> cells;
+  generate(cells);
+
+  // Direct encoding
+  {
+    ColumnarCellsWriter writer;
+    for (auto &cell : cells)
+      writer.add(cell.row.c_str(), cell.family.c_str(),
+                 cell.qualifier.c_str(), cell.timestamp,
+                 cell.value.data(), cell.value.length(), cell.flag);
+    writer.finalize();
+    HT_ASSERT((writer.get_buffer_length() & 7) == 0);
+    ColumnarCellsReader reader(writer.get_buffer(), writer.get_buffer_length());
+    verify(cells, reader);
+    HT_ASSERT(!reader.eos());
+  }
+
+  // Conversion from row-oriented serialized cells
+  SerializedCellsWriter scw(0, true);
+  for (auto &cell : cells)
+    scw.add(cell.row.c_str(), cell.family.c_str(), cell.qualifier.c_str(),
+            cell.timestamp, (const void *)cell.value.data(),
+            cell.value.length(), cell.flag);
+  scw.finalize(SerializedCellsFlag::EOS);
+
+  ColumnarCellsWriter writer;
+  HT_ASSERT(writer.add_serialized(scw.get_buffer(), scw.get_buffer_length())
+            == cells.size());
+  writer.finalize();
+  {
+    ColumnarCellsReader reader(writer.get_buffer(), writer.get_buffer_length());
+    verify(cells, reader);
+    HT_ASSERT(reader.eos());
+  }
+
+  // Empty batch
+  {
+    ColumnarCellsWriter empty;
+    empty.finalize();
+    ColumnarCellsReader reader(empty.get_buffer(), empty.get_buffer_length());
+    HT_ASSERT(reader.cell_count() == 0);
+  }
+
+  // Formats must not be mistaken for each other
+  try {
+    SerializedCellsReader reader(writer.get_buffer(), writer.get_buffer_length());
+    HT_ASSERT(!"row-oriented reader accepted columnar buffer");
+  }
+  catch (Exception &e) {
+    HT_ASSERT(e.code() == Error::SERIALIZATION_VERSION_MISMATCH);
+  }
+
+  // Truncated buffers are rejected
+  try {
+    ColumnarCellsReader reader(writer.get_buffer(),
+                               writer.get_buffer_length() / 2);
+    HT_ASSERT(!"truncated buffer accepted");
+  }
+  catch (Exception &e) {
+    HT_ASSERT(e.code() == Error::SERIALIZATION_INPUT_OVERRUN);
+  }
+
+  // Dictionary strings missing their NUL terminator are rejected
+  {
+    std::string corrupt((const char *)writer.get_buffer(),
+                        writer.get_buffer_length());
+    ColumnarCellsReader reader(writer.get_buffer(),
+                               writer.get_buffer_length());
+    const char *last = reader.row_entry(reader.row_count() - 1);
+    corrupt[(last + strlen(last)) - (const char *)writer.get_buffer()] = 'x';
+    try {
+      ColumnarCellsReader bad(corrupt.data(), corrupt.length());
+      HT_ASSERT(!"unterminated dictionary string accepted");
+    }
+    catch (Exception &e) {
+      HT_ASSERT(e.code() == Error::BAD_FORMAT);
+    }
+  }
+
+  if (argc > 1 && !strcmp(argv[1], "--benchmark")) {
+    const int iterations = 200;
+    Stopwatch row_timer;
+    size_t checksum = 0;
+    for (int i=0; i<iterations; i++) {
+      SerializedCellsReader reader(scw.get_buffer(), scw.get_buffer_length());
+      while (reader.next())
+        checksum += reader.value_len() + strlen(reader.row());
+    }
+    row_timer.stop();
+    Stopwatch columnar_timer;
+    for (int i=0; i<iterations; i++) {
+      ColumnarCellsReader reader(writer.get_buffer(), writer.get_buffer_length());
+      checksum += reader.values_length() + reader.row_count();
+    }
+    columnar_timer.stop();
+    cout << "serialized bytes=" << scw.get_buffer_length()
+         << " columnar bytes=" << writer.get_buffer_length()
+         << " row-oriented walk=" << row_timer.elapsed_millis() << "ms"
+         << " columnar open=" << columnar_timer.elapsed_millis() << "ms"
+         << " (" << checksum << ")" << endl;
+  }
+
+  return 0;
+}
@@ -18,13 +18,16 @@
  */
 
 #include "Common/Compat.h"
+#include "Common/Logger.h"
 #include "Common/System.h"
 
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include "ThriftBroker/Client.h"
 #include "ThriftBroker/gen-cpp/HqlService.h"
 #include "ThriftBroker/ThriftHelper.h"
+#include "ThriftBroker/ColumnarCellsReader.h"
 #include "ThriftBroker/SerializedCellsReader.h"
 #include "ThriftBroker/SerializedCellsWriter.h"
 
@@ -33,7 +36,8 @@ using namespace Hypertable::ThriftGen;
 
 /**
  * This test demonstrates the use of the
- * SerializedCellsReader/SerializedCellsWriter APIs.
+ * SerializedCellsReader/SerializedCellsWriter APIs and of the columnar
+ * scanner interface read with ColumnarCellsReader.
  *
  * It assumes that there's a namespace "test" with a table "thrift_test".
  *
@@ -120,6 +124,38 @@ void test_reader(Thrift::Client *client) {
   client->namespace_close(ns);
 }
 
+void test_columnar_reader(Thrift::Client *client) {
+  ScanSpec scanspec;
+  Namespace ns = client->namespace_open("test");
+  Scanner scanner = client->scanner_open(ns, "thrift_test", scanspec);
+
+  std::string raw_results;
+  size_t count = 0;
+  std::string previous_row;
+
+  do {
+    client->next_cells_columnar(raw_results, scanner);
+
+    ColumnarCellsReader reader(raw_results.data(), raw_results.length());
+    for (uint32_t i=0; i<reader.cell_count(); i++) {
+      HT_ASSERT(strcmp(reader.column_family(i), "col") == 0);
+      HT_ASSERT(previous_row.compare(reader.row(i)) <= 0);
+      previous_row = reader.row(i);
+      count++;
+    }
+
+    // reached end of stream?
+    if (reader.eos())
+      break;
+  } while (true);
+
+  // every row written by test_writer() comes back at least once
+  HT_ASSERT(count >= 10000);
+
+  client->scanner_close(scanner);
+  client->namespace_close(ns);
+}
+
 int main() {
   try {
     // connect to the local ThriftBroker
@@ -130,6 +166,9 @@ int main() {
 
     // then fetch them using the SerializedCellsReader
     test_reader(client);
+
+    // and once more in the columnar layout
+    test_columnar_reader(client);
   }
   catch (Thrift::TException &ex) {
     std::cout << "Caught an exception! Next steps: " << std::endl
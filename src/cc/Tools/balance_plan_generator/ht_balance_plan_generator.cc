@@ -22,6 +22,7 @@
 #include <Common/Compat.h>
 
 #include <Hypertable/Master/BalanceAlgorithmLoad.h>
+#include <Hypertable/Master/BalanceAlgorithmRangeLoad.h>
 
 #include <Hypertable/Lib/Config.h>
 #include <Hypertable/Lib/Client.h>
@@ -38,6 +39,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
+#include <map>
 
 extern "C" {
 #include <poll.h>
@@ -72,7 +75,11 @@ namespace {
         ("rs-metrics-loaded",  boo()->zero_tokens()->default_value(false),
          "If true then assume RS_METRICS is already loaded in namespace/table")
         ("load-balancer", str()->default_value("basic-distribute-load"),
-         "Type of load balancer to be used.")
+         "Type of load balancer to be used (basic-distribute-load or "
+         "range-load).")
+        ("simulate", boo()->zero_tokens()->default_value(false),
+         "Print projected per-server load and peak load before and after "
+         "the plan (range-load only)")
         ("verbose,v", boo()->zero_tokens()->default_value(false),
          "Show more verbose output")
         ("balance-plan-file,b",  str()->default_value(""),
@@ -87,7 +94,7 @@ namespace {
 typedef Meta::list<AppPolicy, DefaultCommPolicy> Policies;
 
 void generate_balance_plan(PropertiesPtr &props, const String &load_balancer,
-    ContextPtr &context, BalancePlanPtr &plan);
+    ContextPtr &context, BalancePlanPtr &plan, bool simulate);
 void create_table(String &ns, String &tablename, String &rs_metrics_file);
 
 int main(int argc, char **argv) {
@@ -125,7 +132,8 @@ int main(int argc, char **argv) {
     ContextPtr context = std::make_shared<Context>(properties);
     context->rsc_manager.reset();
     context->rs_metrics_table = rs_metrics;
-    generate_balance_plan(context->props, load_balancer, context, plan);
+    generate_balance_plan(context->props, load_balancer, context, plan,
+                          get_bool("simulate"));
     ostream *oo;
 
     if (balance_plan_file.size() == 0)
@@ -159,18 +167,43 @@ int main(int argc, char **argv) {
 }
 
 void generate_balance_plan(PropertiesPtr &props, const String &load_balancer,
-    ContextPtr &context, BalancePlanPtr &plan) {
+    ContextPtr &context, BalancePlanPtr &plan, bool simulate) {
+
+  std::vector<RangeServerStatistics> range_server_stats;
+  // TODO fill this vector; otherwise disk usage is not taken into account
+  std::vector<RangeServerConnectionPtr> balanced;
+
+  if (load_balancer == "range-load") {
+    BalanceAlgorithmRangeLoad balancer(context, range_server_stats);
+    balancer.compute_plan(plan, balanced);
+    if (simulate) {
+      map<string, double> before, after;
+      double peak_before = 0, peak_after = 0;
+      balancer.get_projected_loads(before, after);
+      for (auto &entry : before) {
+        cout << "Server: " << entry.first << " load " << entry.second
+             << " -> " << after[entry.first] << endl;
+        peak_before = std::max(peak_before, entry.second);
+        peak_after = std::max(peak_after, after[entry.first]);
+      }
+      for (auto &range : balancer.get_hot_ranges())
+        cout << "HotRange: " << range.table_id << "[" << range.start_row
+             << ".." << range.end_row << "] load " << range.load << endl;
+      cout << "PeakLoad: " << peak_before << " -> " << peak_after << endl;
+    }
+    return;
+  }
 
   if (load_balancer != "basic-distribute-load")
     HT_THROW(Error::NOT_IMPLEMENTED,
-             (String)"Only 'basic-distribute-load' balancer is supported. '" + load_balancer
-             + "' balancer not supported.");
+             (String)"Only 'basic-distribute-load' and 'range-load' balancers "
+             "are supported. '" + load_balancer + "' balancer not supported.");
 
-  std::vector<RangeServerStatistics> range_server_stats;
-  // TODO fill this vector; otherwise disk usage is not taken into account
+  if (simulate)
+    HT_THROW(Error::NOT_IMPLEMENTED,
+             "--simulate is only supported with the 'range-load' balancer");
 
   BalanceAlgorithmLoad balancer(context, range_server_stats);
-  std::vector<RangeServerConnectionPtr> balanced;
   balancer.compute_plan(plan, balanced);
 }
 
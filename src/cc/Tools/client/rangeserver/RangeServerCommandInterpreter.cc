@@ -375,6 +375,10 @@ int RangeServerCommandInterpreter::execute_line(const String &line) {
     else if (state.command == COMMAND_HEAPCHECK) {
       m_range_server->heapcheck(m_addr, state.output_file);
     }
+    else if (state.command == COMMAND_PROFILE) {
+      m_range_server->profile(m_addr, state.profile_action,
+                              state.profile_frequency, state.output_file);
+    }
     else if (state.command == COMMAND_COMPACT) {
       if (table)
         m_range_server->compact(m_addr, *table, state.str, 0);
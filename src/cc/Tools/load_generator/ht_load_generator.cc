@@ -34,6 +34,7 @@
 #include <Common/Stopwatch.h>
 #include <Common/String.h>
 #include <Common/Init.h>
+#include <Common/RequestTrace.h>
 #include <Common/Usage.h>
 
 #include <boost/algorithm/string.hpp>
@@ -107,6 +108,8 @@ namespace {
          "Generate load via Thrift interface instead of C++ client library")
         ("version", "Show version information and exit")
         ("overwrite-delete-flag", str(), "Force delete flag (DELETE_ROW, DELETE_CELL, DELETE_COLUMN_FAMILY)")
+        ("trace-file", str(), "Write spans of traced requests to this file "
+         "when done, for ht_trace_path (see Hypertable.Request.Trace.Sampling)")
         ;
       alias("delete-percentage", "DataGenerator.DeletePercentage");
       alias("max-bytes", "DataGenerator.MaxBytes");
@@ -251,6 +254,11 @@ int main(int argc, char **argv) {
       std::cout << cmdline_desc() << std::flush;
       quick_exit(EXIT_FAILURE);
     }
+
+    if (has("trace-file")) {
+      std::ofstream out(get_str("trace-file"));
+      RequestTrace::dump(out);
+    }
   }
   catch (Exception &e) {
     HT_ERROR_OUT << e << HT_END;
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2007-2016 Hypertable, Inc.
+ *
+ * This file is part of Hypertable.
+ *
+ * Hypertable is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; version 3 of the
+ * License, or any later version.
+ *
+ * Hypertable is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <Common/Compat.h>
+#include <Common/Config.h>
+#include <Common/Init.h>
+#include <Common/Logger.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace Hypertable;
+using namespace Hypertable::Config;
+using namespace std;
+
+namespace {
+
+  const char *usage =
+    "\nusage: ht_trace_path [options] <dump-file> ...\n\n"
+    "description:\n"
+    "  This program reads the request trace spans (lines starting with\n"
+    "  \"TRACE \") from the given dump files, which are range server dump\n"
+    "  files and client trace dumps, and prints the critical path of the\n"
+    "  slowest traced requests.  Each span is printed with its start time\n"
+    "  relative to the start of the request, its duration and the dump file\n"
+    "  it came from.  Spans recorded on different hosts are subject to clock\n"
+    "  skew, so network time is computed from durations only, as the client\n"
+    "  RPC time minus the time spent in the server.\n\n"
+    "options";
+
+  struct AppPolicy : Policy {
+    static void init_options() {
+      cmdline_desc(usage).add_options()
+        ("trace-id", str(), "Only print trace with this (hexadecimal) ID")
+        ("slowest", i32()->default_value(10),
+         "Number of slowest traces to print")
+        ;
+      cmdline_hidden_desc().add_options()("files", strs(), "");
+      cmdline_positional_desc().add("files", -1);
+    }
+    static void init() {
+      if (!has("files")) {
+        cout << cmdline_desc() << endl;
+        quick_exit(EXIT_FAILURE);
+      }
+    }
+  };
+
+  typedef Meta::list<AppPolicy, DefaultPolicy> Policies;
+
+  struct Span {
+    string stage;
+    int64_t start;
+    int64_t end;
+    size_t file;
+    int64_t duration() const { return end - start; }
+  };
+
+  struct Trace {
+    vector<Span> spans;
+    /// Total request time, the client span if there is one
+    int64_t total {};
+  };
+
+  /// Returns <i>true</i> if spans of <code>stage</code> are on the server
+  /// and are not nested in another server span
+  bool is_server_stage(const string &stage) {
+    return stage == "QUEUE_WAIT" || stage == "HANDLER" ||
+      stage.compare(0, 7, "UPDATE_") == 0;
+  }
+
+  void load(const string &fname, size_t file, map<uint64_t, Trace> &traces) {
+    ifstream in(fname);
+    if (!in)
+      HT_FATALF("Unable to open '%s'", fname.c_str());
+    string line;
+    while (getline(in, line)) {
+      if (line.compare(0, 6, "TRACE ") != 0)
+        continue;
+      char stage[32];
+      uint64_t id;
+      Span span;
+      if (sscanf(line.c_str(), "TRACE %" SCNx64 " %31s %" SCNd64 " %" SCNd64,
+                 &id, stage, &span.start, &span.end) != 4) {
+        HT_WARNF("Skipping malformed line in %s: %s", fname.c_str(),
+                 line.c_str());
+        continue;
+      }
+      span.stage = stage;
+      span.file = file;
+      traces[id].spans.push_back(span);
+    }
+  }
+
+  inline double to_ms(int64_t us) { return (double)us / 1000.0; }
+
+  void print(uint64_t id, Trace &trace, const vector<string> &files) {
+    sort(trace.spans.begin(), trace.spans.end(),
+         [](const Span &a, const Span &b) {
+           return a.file == b.file ? a.start < b.start : a.file < b.file;
+         });
+    printf("Trace %016" PRIx64 " total %.3f ms\n", id, to_ms(trace.total));
+    int64_t client_rpc {}, server {};
+    for (auto &span : trace.spans) {
+      // Offsets are relative to the first span of the same file, times
+      // of different hosts are not comparable
+      int64_t base {};
+      for (auto &s : trace.spans)
+        if (s.file == span.file) {
+          base = s.start;
+          break;
+        }
+      printf("  %10.3f %10.3f  %-15s %s\n", to_ms(span.start - base),
+             to_ms(span.duration()), span.stage.c_str(),
+             files[span.file].c_str());
+      if (span.stage == "CLIENT_RPC")
+        client_rpc += span.duration();
+      else if (is_server_stage(span.stage))
+        server += span.duration();
+    }
+    if (client_rpc)
+      printf("  network and unaccounted %.3f ms\n",
+             to_ms(max(client_rpc - server, (int64_t)0)));
+    printf("\n");
+  }
+
+}
+
+/// @defgroup trace_path trace_path
+/// @ingroup Tools
+/// Request trace critical path tool.
+
+int main(int argc, char **argv) {
+
+  try {
+    init_with_policies<Policies>(argc, argv);
+
+    vector<string> files = get_strs("files");
+    map<uint64_t, Trace> traces;
+    for (size_t i=0; i<files.size(); i++)
+      load(files[i], i, traces);
+
+    for (auto &entry : traces) {
+      Trace &trace = entry.second;
+      int64_t start {}, end {};
+      for (auto &span : trace.spans) {
+        if (span.stage.compare(0, 7, "CLIENT_") == 0)
+          trace.total += span.duration();
+        if (start == 0 || span.start < start)
+          start = span.start;
+        end = max(end, span.end);
+      }
+      // Server-side trace only
+      if (trace.total == 0)
+        trace.total = end - start;
+    }
+
+    if (has("trace-id")) {
+      uint64_t id = strtoull(get_str("trace-id").c_str(), 0, 16);
+      auto iter = traces.find(id);
+      if (iter == traces.end()) {
+        cout << "Trace " << get_str("trace-id") << " not found" << endl;
+        quick_exit(EXIT_FAILURE);
+      }
+      print(iter->first, iter->second, files);
+      quick_exit(EXIT_SUCCESS);
+    }
+
+    vector<pair<uint64_t, Trace *>> slowest;
+    for (auto &entry : traces)
+      slowest.push_back(make_pair(entry.first, &entry.second));
+    sort(slowest.begin(), slowest.end(),
+         [](const pair<uint64_t, Trace *> &a,
+            const pair<uint64_t, Trace *> &b) {
+           return a.second->total > b.second->total;
+         });
+    size_t count = min(slowest.size(), (size_t)get_i32("slowest"));
+    for (size_t i=0; i<count; i++)
+      print(slowest[i].first, *slowest[i].second, files);
+  }
+  catch (Exception &e) {
+    HT_ERROR_OUT << e << HT_END;
+    quick_exit(EXIT_FAILURE);
+  }
+
+  quick_exit(EXIT_SUCCESS);
+}
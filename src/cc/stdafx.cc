@@ -25,6 +25,7 @@
 
 #pragma comment( lib, "sigar.lib" )
 #pragma comment( lib, "zlib.lib" )
+#pragma comment( lib, "zstd.lib" )
 #pragma comment( lib, "advapi32.lib" )
 #pragma comment( lib, "shell32.lib" )
 #pragma comment( lib, "ws2_32.lib" )
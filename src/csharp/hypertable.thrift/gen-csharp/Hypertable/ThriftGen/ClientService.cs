@@ -375,6 +375,11 @@ namespace Hypertable.ThriftGen
       IAsyncResult Begin_next_cells_serialized(AsyncCallback callback, object state, long scanner);
       byte[] End_next_cells_serialized(IAsyncResult asyncResult);
       #endif
+      byte[] next_cells_columnar(long scanner);
+      #if SILVERLIGHT
+      IAsyncResult Begin_next_cells_columnar(AsyncCallback callback, object state, long scanner);
+      byte[] End_next_cells_columnar(IAsyncResult asyncResult);
+      #endif
       /// <summary>
       /// Iterate over rows of a scanner
       /// 
@@ -4134,6 +4139,71 @@ namespace Hypertable.ThriftGen
       }
 
       
+      #if SILVERLIGHT
+      public IAsyncResult Begin_next_cells_columnar(AsyncCallback callback, object state, long scanner)
+      {
+        return send_next_cells_columnar(callback, state, scanner);
+      }
+
+      public byte[] End_next_cells_columnar(IAsyncResult asyncResult)
+      {
+        oprot_.Transport.EndFlush(asyncResult);
+        return recv_next_cells_columnar();
+      }
+
+      #endif
+
+      public byte[] next_cells_columnar(long scanner)
+      {
+        #if !SILVERLIGHT
+        send_next_cells_columnar(scanner);
+        return recv_next_cells_columnar();
+
+        #else
+        var asyncResult = Begin_next_cells_columnar(null, null, scanner);
+        return End_next_cells_columnar(asyncResult);
+
+        #endif
+      }
+      #if SILVERLIGHT
+      public IAsyncResult send_next_cells_columnar(AsyncCallback callback, object state, long scanner)
+      #else
+      public void send_next_cells_columnar(long scanner)
+      #endif
+      {
+        oprot_.WriteMessageBegin(new TMessage("next_cells_columnar", TMessageType.Call, seqid_));
+        next_cells_columnar_args args = new next_cells_columnar_args();
+        args.Scanner = scanner;
+        args.Write(oprot_);
+        oprot_.WriteMessageEnd();
+        #if SILVERLIGHT
+        return oprot_.Transport.BeginFlush(callback, state);
+        #else
+        oprot_.Transport.Flush();
+        #endif
+      }
+
+      public byte[] recv_next_cells_columnar()
+      {
+        TMessage msg = iprot_.ReadMessageBegin();
+        if (msg.Type == TMessageType.Exception) {
+          TApplicationException x = TApplicationException.Read(iprot_);
+          iprot_.ReadMessageEnd();
+          throw x;
+        }
+        next_cells_columnar_result result = new next_cells_columnar_result();
+        result.Read(iprot_);
+        iprot_.ReadMessageEnd();
+        if (result.__isset.success) {
+          return result.Success;
+        }
+        if (result.__isset.e) {
+          throw result.E;
+        }
+        throw new TApplicationException(TApplicationException.ExceptionType.MissingResult, "next_cells_columnar failed: unknown result");
+      }
+
+      
       #if SILVERLIGHT
       public IAsyncResult Begin_scanner_get_row(AsyncCallback callback, object state, long scanner)
       {
@@ -10151,6 +10221,7 @@ namespace Hypertable.ThriftGen
         processMap_["next_cells_as_arrays"] = next_cells_as_arrays_Process;
         processMap_["scanner_get_cells_serialized"] = scanner_get_cells_serialized_Process;
         processMap_["next_cells_serialized"] = next_cells_serialized_Process;
+        processMap_["next_cells_columnar"] = next_cells_columnar_Process;
         processMap_["scanner_get_row"] = scanner_get_row_Process;
         processMap_["next_row"] = next_row_Process;
         processMap_["scanner_get_row_as_arrays"] = scanner_get_row_as_arrays_Process;
@@ -10965,6 +11036,23 @@ namespace Hypertable.ThriftGen
         oprot.Transport.Flush();
       }
 
+      public void next_cells_columnar_Process(int seqid, TProtocol iprot, TProtocol oprot)
+      {
+        next_cells_columnar_args args = new next_cells_columnar_args();
+        args.Read(iprot);
+        iprot.ReadMessageEnd();
+        next_cells_columnar_result result = new next_cells_columnar_result();
+        try {
+          result.Success = iface_.next_cells_columnar(args.Scanner);
+        } catch (ClientException e) {
+          result.E = e;
+        }
+        oprot.WriteMessageBegin(new TMessage("next_cells_columnar", TMessageType.Reply, seqid)); 
+        result.Write(oprot);
+        oprot.WriteMessageEnd();
+        oprot.Transport.Flush();
+      }
+
       public void scanner_get_row_Process(int seqid, TProtocol iprot, TProtocol oprot)
       {
         scanner_get_row_args args = new scanner_get_row_args();
@@ -23177,6 +23265,263 @@ namespace Hypertable.ThriftGen
     }
 
 
+    #if !SILVERLIGHT
+    [Serializable]
+    #endif
+    public partial class next_cells_columnar_args : TBase
+    {
+      private long _scanner;
+
+      public long Scanner
+      {
+        get
+        {
+          return _scanner;
+        }
+        set
+        {
+          __isset.scanner = true;
+          this._scanner = value;
+        }
+      }
+
+
+      public Isset __isset;
+      #if !SILVERLIGHT
+      [Serializable]
+      #endif
+      public struct Isset {
+        public bool scanner;
+      }
+
+      public next_cells_columnar_args() {
+      }
+
+      public void Read (TProtocol iprot)
+      {
+        iprot.IncrementRecursionDepth();
+        try
+        {
+          TField field;
+          iprot.ReadStructBegin();
+          while (true)
+          {
+            field = iprot.ReadFieldBegin();
+            if (field.Type == TType.Stop) { 
+              break;
+            }
+            switch (field.ID)
+            {
+              case 1:
+                if (field.Type == TType.I64) {
+                  Scanner = iprot.ReadI64();
+                } else { 
+                  TProtocolUtil.Skip(iprot, field.Type);
+                }
+                break;
+              default: 
+                TProtocolUtil.Skip(iprot, field.Type);
+                break;
+            }
+            iprot.ReadFieldEnd();
+          }
+          iprot.ReadStructEnd();
+        }
+        finally
+        {
+          iprot.DecrementRecursionDepth();
+        }
+      }
+
+      public void Write(TProtocol oprot) {
+        oprot.IncrementRecursionDepth();
+        try
+        {
+          TStruct struc = new TStruct("next_cells_columnar_args");
+          oprot.WriteStructBegin(struc);
+          TField field = new TField();
+          if (__isset.scanner) {
+            field.Name = "scanner";
+            field.Type = TType.I64;
+            field.ID = 1;
+            oprot.WriteFieldBegin(field);
+            oprot.WriteI64(Scanner);
+            oprot.WriteFieldEnd();
+          }
+          oprot.WriteFieldStop();
+          oprot.WriteStructEnd();
+        }
+        finally
+        {
+          oprot.DecrementRecursionDepth();
+        }
+      }
+
+      public override string ToString() {
+        StringBuilder __sb = new StringBuilder("next_cells_columnar_args(");
+        bool __first = true;
+        if (__isset.scanner) {
+          if(!__first) { __sb.Append(", "); }
+          __first = false;
+          __sb.Append("Scanner: ");
+          __sb.Append(Scanner);
+        }
+        __sb.Append(")");
+        return __sb.ToString();
+      }
+
+    }
+
+
+    #if !SILVERLIGHT
+    [Serializable]
+    #endif
+    public partial class next_cells_columnar_result : TBase
+    {
+      private byte[] _success;
+      private ClientException _e;
+
+      public byte[] Success
+      {
+        get
+        {
+          return _success;
+        }
+        set
+        {
+          __isset.success = true;
+          this._success = value;
+        }
+      }
+
+      public ClientException E
+      {
+        get
+        {
+          return _e;
+        }
+        set
+        {
+          __isset.e = true;
+          this._e = value;
+        }
+      }
+
+
+      public Isset __isset;
+      #if !SILVERLIGHT
+      [Serializable]
+      #endif
+      public struct Isset {
+        public bool success;
+        public bool e;
+      }
+
+      public next_cells_columnar_result() {
+      }
+
+      public void Read (TProtocol iprot)
+      {
+        iprot.IncrementRecursionDepth();
+        try
+        {
+          TField field;
+          iprot.ReadStructBegin();
+          while (true)
+          {
+            field = iprot.ReadFieldBegin();
+            if (field.Type == TType.Stop) { 
+              break;
+            }
+            switch (field.ID)
+            {
+              case 0:
+                if (field.Type == TType.String) {
+                  Success = iprot.ReadBinary();
+                } else { 
+                  TProtocolUtil.Skip(iprot, field.Type);
+                }
+                break;
+              case 1:
+                if (field.Type == TType.Struct) {
+                  E = new ClientException();
+                  E.Read(iprot);
+                } else { 
+                  TProtocolUtil.Skip(iprot, field.Type);
+                }
+                break;
+              default: 
+                TProtocolUtil.Skip(iprot, field.Type);
+                break;
+            }
+            iprot.ReadFieldEnd();
+          }
+          iprot.ReadStructEnd();
+        }
+        finally
+        {
+          iprot.DecrementRecursionDepth();
+        }
+      }
+
+      public void Write(TProtocol oprot) {
+        oprot.IncrementRecursionDepth();
+        try
+        {
+          TStruct struc = new TStruct("next_cells_columnar_result");
+          oprot.WriteStructBegin(struc);
+          TField field = new TField();
+
+          if (this.__isset.success) {
+            if (Success != null) {
+              field.Name = "Success";
+              field.Type = TType.String;
+              field.ID = 0;
+              oprot.WriteFieldBegin(field);
+              oprot.WriteBinary(Success);
+              oprot.WriteFieldEnd();
+            }
+          } else if (this.__isset.e) {
+            if (E != null) {
+              field.Name = "E";
+              field.Type = TType.Struct;
+              field.ID = 1;
+              oprot.WriteFieldBegin(field);
+              E.Write(oprot);
+              oprot.WriteFieldEnd();
+            }
+          }
+          oprot.WriteFieldStop();
+          oprot.WriteStructEnd();
+        }
+        finally
+        {
+          oprot.DecrementRecursionDepth();
+        }
+      }
+
+      public override string ToString() {
+        StringBuilder __sb = new StringBuilder("next_cells_columnar_result(");
+        bool __first = true;
+        if (Success != null && __isset.success) {
+          if(!__first) { __sb.Append(", "); }
+          __first = false;
+          __sb.Append("Success: ");
+          __sb.Append(Success);
+        }
+        if (E != null && __isset.e) {
+          if(!__first) { __sb.Append(", "); }
+          __first = false;
+          __sb.Append("E: ");
+          __sb.Append(E== null ? "<null>" : E.ToString());
+        }
+        __sb.Append(")");
+        return __sb.ToString();
+      }
+
+    }
+
+
     #if !SILVERLIGHT
     [Serializable]
     #endif
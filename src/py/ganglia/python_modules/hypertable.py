@@ -362,6 +362,19 @@ def metric_init(params):
              'description': 'Operation rate',
              'groups': 'hypertable Master'}
         descriptors.append(d);
+
+        for phase in ['queue', 'block', 'execute']:
+            for stat in ['p50', 'p99', 'max']:
+                d = {'name': 'ht.master.operation.%s.%s' % (phase, stat),
+                     'call_back': metric_callback,
+                     'time_max': 90,
+                     'value_type': 'float',
+                     'units': 'ms',
+                     'slope': 'both',
+                     'format': '%f',
+                     'description': 'Operation %s time (%s)' % (phase, stat),
+                     'groups': 'hypertable Master'}
+                descriptors.append(d);
         
         d = {'name': 'ht.master.cpu.sys',
              'call_back': metric_callback,
@@ -553,6 +566,47 @@ def metric_init(params):
              'description': 'Request backlog',
              'groups': 'hypertable RangeServer'}
         descriptors.append(d);
+
+        for lane in ['', '.urgent', '.low']:
+            for stat in ['p50', 'p99', 'max']:
+                d = {'name': 'ht.rangeserver.requestQueueWait%s.%s' % (lane, stat),
+                     'call_back': metric_callback,
+                     'time_max': 90,
+                     'value_type': 'float',
+                     'units': 'ms',
+                     'slope': 'both',
+                     'format': '%f',
+                     'description': 'Request queue wait time (%s%s)' % (stat, lane.replace('.', ', ')),
+                     'groups': 'hypertable RangeServer'}
+                descriptors.append(d);
+
+        for cls in ['read', 'update']:
+            d = {'name': 'ht.rangeserver.requestsRejected.%s' % cls,
+                 'call_back': metric_callback,
+                 'time_max': 90,
+                 'value_type': 'float',
+                 'units': 'requests/s',
+                 'slope': 'both',
+                 'format': '%f',
+                 'description': 'Rejected %s requests per second' % cls,
+                 'groups': 'hypertable RangeServer'}
+            descriptors.append(d);
+
+        for metric in ['request.update', 'request.createScanner',
+                       'request.fetchScanblock', 'request.destroyScanner',
+                       'request.other', 'commitLogSync', 'blockRead',
+                       'blockCacheLookup']:
+            for stat in ['p50', 'p99', 'p999', 'max']:
+                d = {'name': 'ht.rangeserver.latency.%s.%s' % (metric, stat),
+                     'call_back': metric_callback,
+                     'time_max': 90,
+                     'value_type': 'float',
+                     'units': 'ms',
+                     'slope': 'both',
+                     'format': '%f',
+                     'description': 'Latency of %s (%s)' % (metric, stat),
+                     'groups': 'hypertable RangeServer'}
+                descriptors.append(d);
         
         d = {'name': 'ht.rangeserver.compactions.major',
              'call_back': metric_callback,
@@ -598,6 +652,50 @@ def metric_init(params):
              'groups': 'hypertable RangeServer'}
         descriptors.append(d);
         
+        d = {'name': 'ht.rangeserver.cellstore.blocksCompressed',
+             'call_back': metric_callback,
+             'time_max': 90,
+             'value_type': 'uint',
+             'units': 'blocks',
+             'slope': 'both',
+             'format': '%u',
+             'description': 'CellStore blocks written compressed',
+             'groups': 'hypertable RangeServer'}
+        descriptors.append(d);
+        
+        d = {'name': 'ht.rangeserver.cellstore.blocksStoredRaw',
+             'call_back': metric_callback,
+             'time_max': 90,
+             'value_type': 'uint',
+             'units': 'blocks',
+             'slope': 'both',
+             'format': '%u',
+             'description': 'CellStore blocks written uncompressed',
+             'groups': 'hypertable RangeServer'}
+        descriptors.append(d);
+        
+        d = {'name': 'ht.rangeserver.cellstore.bytesStoredRaw',
+             'call_back': metric_callback,
+             'time_max': 90,
+             'value_type': 'float',
+             'units': 'bytes/s',
+             'slope': 'both',
+             'format': '%f',
+             'description': 'CellStore bytes written uncompressed per second',
+             'groups': 'hypertable RangeServer'}
+        descriptors.append(d);
+        
+        d = {'name': 'ht.rangeserver.cellstore.bytesSaved',
+             'call_back': metric_callback,
+             'time_max': 90,
+             'value_type': 'float',
+             'units': 'bytes/s',
+             'slope': 'both',
+             'format': '%f',
+             'description': 'CellStore bytes saved by compression per second',
+             'groups': 'hypertable RangeServer'}
+        descriptors.append(d);
+        
         d = {'name': 'ht.rangeserver.scanners',
              'call_back': metric_callback,
              'time_max': 90,
@@ -685,6 +783,19 @@ def metric_init(params):
              'description': 'Tracked memory',
              'groups': 'hypertable RangeServer'}
         descriptors.append(d);
+
+        for tag in ['cellCache', 'cellStore', 'replay', 'update', 'commitLog',
+                    'scanner', 'rpc']:
+            d = {'name': 'ht.rangeserver.memory.tracked.%s' % tag,
+                 'call_back': metric_callback,
+                 'time_max': 90,
+                 'value_type': 'float',
+                 'units': 'GB',
+                 'slope': 'both',
+                 'format': '%f',
+                 'description': 'Tracked memory (%s)' % tag,
+                 'groups': 'hypertable RangeServer'}
+            descriptors.append(d);
         
         d = {'name': 'ht.rangeserver.cpu.sys',
              'call_back': metric_callback,
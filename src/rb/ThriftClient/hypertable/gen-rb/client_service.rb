@@ -652,6 +652,22 @@ module Hypertable
           raise ::Thrift::ApplicationException.new(::Thrift::ApplicationException::MISSING_RESULT, 'next_cells_serialized failed: unknown result')
         end
 
+        def next_cells_columnar(scanner)
+          send_next_cells_columnar(scanner)
+          return recv_next_cells_columnar()
+        end
+
+        def send_next_cells_columnar(scanner)
+          send_message('next_cells_columnar', Next_cells_columnar_args, :scanner => scanner)
+        end
+
+        def recv_next_cells_columnar()
+          result = receive_message(Next_cells_columnar_result)
+          return result.success unless result.success.nil?
+          raise result.e unless result.e.nil?
+          raise ::Thrift::ApplicationException.new(::Thrift::ApplicationException::MISSING_RESULT, 'next_cells_columnar failed: unknown result')
+        end
+
         def scanner_get_row(scanner)
           send_scanner_get_row(scanner)
           return recv_scanner_get_row()
@@ -2419,6 +2435,17 @@ module Hypertable
           write_result(result, oprot, 'next_cells_serialized', seqid)
         end
 
+        def process_next_cells_columnar(seqid, iprot, oprot)
+          args = read_args(iprot, Next_cells_columnar_args)
+          result = Next_cells_columnar_result.new()
+          begin
+            result.success = @handler.next_cells_columnar(args.scanner)
+          rescue ::Hypertable::ThriftGen::ClientException => e
+            result.e = e
+          end
+          write_result(result, oprot, 'next_cells_columnar', seqid)
+        end
+
         def process_scanner_get_row(seqid, iprot, oprot)
           args = read_args(iprot, Scanner_get_row_args)
           result = Scanner_get_row_result.new()
@@ -4752,6 +4779,40 @@ module Hypertable
         ::Thrift::Struct.generate_accessors self
       end
 
+      class Next_cells_columnar_args
+        include ::Thrift::Struct, ::Thrift::Struct_Union
+        SCANNER = 1
+
+        FIELDS = {
+          SCANNER => {:type => ::Thrift::Types::I64, :name => 'scanner'}
+        }
+
+        def struct_fields; FIELDS; end
+
+        def validate
+        end
+
+        ::Thrift::Struct.generate_accessors self
+      end
+
+      class Next_cells_columnar_result
+        include ::Thrift::Struct, ::Thrift::Struct_Union
+        SUCCESS = 0
+        E = 1
+
+        FIELDS = {
+          SUCCESS => {:type => ::Thrift::Types::STRING, :name => 'success', :binary => true},
+          E => {:type => ::Thrift::Types::STRUCT, :name => 'e', :class => ::Hypertable::ThriftGen::ClientException}
+        }
+
+        def struct_fields; FIELDS; end
+
+        def validate
+        end
+
+        ::Thrift::Struct.generate_accessors self
+      end
+
       class Scanner_get_row_args
         include ::Thrift::Struct, ::Thrift::Struct_Union
         SCANNER = 1
@@ -0,0 +1,57 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+
+. $HT_HOME/bin/ht-env.sh
+
+function dump_and_compare {
+  echo "use '/'; select * from BulkLoad;" | $HT_HOME/bin/ht shell --batch \
+      | LC_ALL=C sort > dump.tsv
+  diff expected.tsv dump.tsv > /dev/null
+  if [ $? -ne 0 ]; then
+    echo "error: BulkLoad contents differ from the input ($1)"
+    diff expected.tsv dump.tsv | head -20
+    $HT_HOME/bin/ht stop-servers
+    exit 1
+  fi
+}
+
+$HT_HOME/bin/ht start-test-servers --clear --no-thriftbroker
+
+# 'seed' is written through the commit log and is still in the cell cache
+# when the CellStores are attached
+$HT_HOME/bin/ht shell --batch < $SCRIPT_DIR/create-table.hql
+
+awk 'BEGIN { for (i=0; i<5000; i++) {
+               printf("row%05d\ta\tva%05d\n", i, i);
+               printf("row%05d\tb:q\tvb%05d\n", i, i); } }' > data.tsv
+(cat data.tsv; printf "seed\ta\tcached\n") | LC_ALL=C sort > expected.tsv
+
+$HT_HOME/bin/ht_bulk_load BulkLoad data.tsv
+if [ $? -ne 0 ]; then
+  echo "error: ht_bulk_load failed"
+  $HT_HOME/bin/ht stop-servers
+  exit 1
+fi
+
+# Every staged file was moved into a range directory
+STAGED=`find $HT_HOME/fs/local/hypertable/tmp/bulk -type f 2>/dev/null | wc -l`
+if [ $STAGED -ne 0 ]; then
+  echo "error: $STAGED staged CellStore(s) left behind"
+  $HT_HOME/bin/ht stop-servers
+  exit 1
+fi
+
+dump_and_compare "after attach"
+
+# The attached files must be in the Files column and the cached cell must
+# survive commit log replay
+$HT_HOME/bin/ht stop-servers
+$HT_HOME/bin/ht start-test-servers --no-thriftbroker
+
+dump_and_compare "after restart"
+
+$HT_HOME/bin/ht stop-servers
+
+exit 0
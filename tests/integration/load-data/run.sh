@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+
+HT_HOME=${INSTALL_DIR:-"$HOME/hypertable/current"}
+SCRIPT_DIR=`dirname $0`
+ROWS=50000
+
+. $HT_HOME/bin/ht-env.sh
+
+function fail {
+  echo "error: $1"
+  $HT_HOME/bin/ht stop-servers
+  exit 1
+}
+
+# Loads $1 into LoadTest with $2 threads and compares the table with the
+# input
+function load_and_compare {
+  echo "use '/'; drop table if exists LoadTest; create table LoadTest (a, b);" \
+      | $HT_HOME/bin/ht shell --batch
+  echo "use '/'; load data infile '$1' into table LoadTest;" \
+      | $HT_HOME/bin/ht shell --batch \
+          --Hypertable.HqlInterpreter.LoadData.Threads=$2
+  if [ $? -ne 0 ]; then
+    fail "LOAD DATA INFILE '$1' with $2 threads failed"
+  fi
+  echo "use '/'; select * from LoadTest;" | $HT_HOME/bin/ht shell --batch \
+      | LC_ALL=C sort > dump.tsv
+  ROW_COUNT=`cut -f1 dump.tsv | uniq | wc -l`
+  if [ $ROW_COUNT -ne $ROWS ]; then
+    fail "loaded $ROW_COUNT rows from '$1' with $2 threads, expected $ROWS"
+  fi
+  diff expected.tsv dump.tsv > /dev/null
+  if [ $? -ne 0 ]; then
+    echo "error: LoadTest contents differ from '$1' ($2 threads)"
+    diff expected.tsv dump.tsv | head -20
+    fail "contents differ"
+  fi
+}
+
+# Small ranges so that the parallel load spreads over several ranges while
+# the table is being loaded
+$HT_HOME/bin/ht start-test-servers --clear --no-thriftbroker \
+    --Hypertable.RangeServer.Range.SplitSize=1M
+
+# Rows are written in shuffled order so that every chunk of the file
+# covers many ranges; each row has one cell per column family
+awk -v rows=$ROWS 'BEGIN { srand(7); for (i=0; i<rows; i++) order[i] = i;
+    for (i=rows-1; i>0; i--) { j = int(rand() * (i+1));
+                               t = order[i]; order[i] = order[j]; order[j] = t; }
+    for (i=0; i<rows; i++) {
+      printf("row%06d\ta\tvalue a of row %06d with some padding\n", order[i], order[i]);
+      printf("row%06d\tb:q\tvalue b of row %06d with some padding\n", order[i], order[i]); } }' \
+    > data.tsv
+LC_ALL=C sort data.tsv > expected.tsv
+(printf "#row\tcolumn\tvalue\n"; cat data.tsv) > data-header.tsv
+gzip -c data.tsv > data.tsv.gz
+
+load_and_compare data.tsv 1
+load_and_compare data.tsv 4
+load_and_compare data-header.tsv 4
+# Compressed input is parsed on one thread and applied by four mutators
+load_and_compare data.tsv.gz 4
+
+$HT_HOME/bin/ht stop-servers
+
+exit 0